@@ -0,0 +1,310 @@
+/**
+ * \date 2023
+ * \copyright Allied Vision Technologies.  All Rights Reserved.
+ *
+ * \copyright Redistribution of this file, in original or modified form, without
+ *            prior written consent of Allied Vision Technologies is prohibited.
+ *
+ * \warning THIS SOFTWARE IS PROVIDED BY THE AUTHOR "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF TITLE,
+ * NON-INFRINGEMENT, MERCHANTABILITY AND FITNESS FOR A PARTICULAR  PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \brief Implementation of ::VmbC::Examples::AcquisitionDaemon
+ */
+
+#include <sstream>
+#include <vector>
+
+#include "AcquisitionDaemon.h"
+#include "Tracing.h"
+#include "VmbException.h"
+
+namespace VmbC
+{
+    namespace Examples
+    {
+        namespace
+        {
+            /**
+             * \brief interval for checking, if the daemon should stop
+             */
+            constexpr std::chrono::milliseconds StopCheckInterval { 100 };
+
+            /**
+             * \brief requests with longer lines are rejected
+             */
+            constexpr size_t MaxRequestSize = 1024;
+
+            std::vector<VmbCameraInfo_t> ListCameras()
+            {
+                VmbUint32_t count = 0;
+                VmbError_t error = VmbCamerasList(nullptr, 0, &count, sizeof(VmbCameraInfo_t));
+                if (error != VmbErrorSuccess)
+                {
+                    throw VmbException::ForOperation(error, "VmbCamerasList");
+                }
+                std::vector<VmbCameraInfo_t> cameras(count);
+                if (count != 0)
+                {
+                    error = VmbCamerasList(cameras.data(), count, &count, sizeof(VmbCameraInfo_t));
+                    if (error != VmbErrorSuccess)
+                    {
+                        throw VmbException::ForOperation(error, "VmbCamerasList");
+                    }
+                    cameras.resize(count);
+                }
+                return cameras;
+            }
+
+            std::string GetInUseReply(std::string const& cameraId, unsigned const otherClients)
+            {
+                std::ostringstream reply;
+                reply << "ERROR camera " << cameraId << " is in use by " << otherClients << " other client(s)";
+                return reply.str();
+            }
+        }
+
+        AcquisitionDaemon::AcquisitionDaemon(Settings const& settings)
+            : m_settings(settings),
+            m_acquisitionManager(m_discardingSink)
+        /* 启动VmbC并绑定本机端口。采集不转换帧，只把帧缓冲区导出到共享内存，由客户端各自转换。
+        m_server 在最后创建，因为它会立即在其他线程中使用其他成员。 */
+        {
+            m_acquisitionManager.SetConversionEnabled(false);
+            auto sharedMemory = settings.m_sharedMemory;
+            sharedMemory.m_retainedFrames = settings.m_retainedFrames;
+            m_acquisitionManager.EnableSharedFrameExport(sharedMemory);
+            m_acquisitionManager.SetChunkMetadata(settings.m_chunkMetadata);
+            if (!settings.m_pipe.m_path.empty())
+            {
+                m_pipeSink.reset(new RawPipeSink(settings.m_pipe));
+                m_acquisitionManager.AddRawFrameSink(*m_pipeSink);
+            }
+            m_server.reset(new ConnectionServer(settings.m_port,
+                                                [this](Socket const& connection, std::atomic<bool> const& stop) { ServeClient(connection, stop); },
+                                                "AcquisitionDaemon"));
+        }
+
+        AcquisitionDaemon::~AcquisitionDaemon()
+        {
+            m_server.reset();
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_acquisitionManager.StopAcquisition();
+            if (m_pipeSink)
+            {
+                m_acquisitionManager.RemoveRawFrameSink(*m_pipeSink);
+            }
+        }
+
+        bool AcquisitionDaemon::WaitForShutdown(std::chrono::milliseconds const timeout)
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            return m_shutdownCondition.wait_for(lock, timeout, [this]() { return m_shutdown; });
+        }
+
+        bool AcquisitionDaemon::GetPipeStatistics(RawPipeSink::Statistics& statistics) const
+        {
+            if (!m_pipeSink)
+            {
+                return false;
+            }
+            statistics = m_pipeSink->GetStatistics();
+            return true;
+        }
+
+        void AcquisitionDaemon::ServeClient(Socket const& connection, std::atomic<bool> const& stop)
+        /* 逐行读取请求并回复一行。连接关闭（包括客户端崩溃）时自动解除附加，采集继续运行。 */
+        {
+            ASYNCHRONOUSGRAB_TRACE_THREAD_NAME("AcquisitionDaemon client");
+
+            bool attached = false;
+            std::string data;
+            char buffer[256];
+            bool connected = true;
+            while (connected && !stop)
+            {
+                if (!connection.WaitReadable(StopCheckInterval))
+                {
+                    continue;
+                }
+                auto const received = connection.Receive(buffer, sizeof(buffer));
+                if (received <= 0)
+                {
+                    break;
+                }
+                data.append(buffer, static_cast<size_t>(received));
+
+                size_t end;
+                while (connected && (end = data.find('\n')) != std::string::npos)
+                {
+                    std::string request = data.substr(0, end);
+                    data.erase(0, end + 1);
+                    if (!request.empty() && request.back() == '\r')
+                    {
+                        request.pop_back();
+                    }
+
+                    std::string const reply = Execute(request, attached) + "\n";
+                    connected = connection.SendAll(reply.data(), reply.size()) && request != "DETACH";
+                }
+                connected = connected && data.size() <= MaxRequestSize;
+            }
+
+            if (attached)
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                --m_attachedClients;
+            }
+        }
+
+        std::string AcquisitionDaemon::Execute(std::string const& request, bool& attached)
+        /* 在 m_mutex 下执行一个请求，因此多个客户端的请求不会同时启动或停止采集。
+        只有在没有其他客户端附加时才切换到另一台相机或停止采集，以免中断其他客户端正在观看的采集；SHUTDOWN 总是停止。 */
+        {
+            std::istringstream stream(request);
+            std::string command;
+            stream >> command;
+            std::string argument;
+            std::getline(stream >> std::ws, argument);
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+            unsigned const otherClients = m_attachedClients - (attached ? 1 : 0);
+            try
+            {
+                if (command == "CAMERAS")
+                {
+                    std::string reply = "OK";
+                    for (auto const& camera : ListCameras())
+                    {
+                        reply += ' ';
+                        reply += camera.cameraIdString;
+                    }
+                    return reply;
+                }
+                if (command == "START")
+                {
+                    if (argument.empty())
+                    {
+                        return "ERROR camera id missing";
+                    }
+                    if (!m_acquisitionManager.IsAcquisitionActive() || argument != m_cameraId)
+                    {
+                        if (m_acquisitionManager.IsAcquisitionActive() && otherClients != 0)
+                        {
+                            return GetInUseReply(m_cameraId, otherClients);
+                        }
+
+                        VmbCameraInfo_t cameraInfo;
+                        VmbError_t const error = VmbCameraInfoQuery(argument.c_str(), &cameraInfo, sizeof(cameraInfo));
+                        if (error != VmbErrorSuccess)
+                        {
+                            throw VmbException::ForOperation(error, "VmbCameraInfoQuery");
+                        }
+                        m_cameraId.clear();
+                        m_acquisitionManager.StartAcquisition(cameraInfo);
+                        m_cameraId = argument;
+                    }
+                    if (!attached)
+                    {
+                        attached = true;
+                        ++m_attachedClients;
+                    }
+                    return "OK " + m_settings.m_sharedMemory.m_name;
+                }
+                if (command == "ATTACH")
+                {
+                    if (!m_acquisitionManager.IsAcquisitionActive())
+                    {
+                        return "ERROR no acquisition running";
+                    }
+                    if (!attached)
+                    {
+                        attached = true;
+                        ++m_attachedClients;
+                    }
+                    return "OK " + m_settings.m_sharedMemory.m_name + " " + m_cameraId;
+                }
+                if (command == "STATUS")
+                {
+                    return GetStatus();
+                }
+                if (command == "STOP")
+                {
+                    if (m_acquisitionManager.IsAcquisitionActive() && otherClients != 0)
+                    {
+                        return GetInUseReply(m_cameraId, otherClients);
+                    }
+                    m_acquisitionManager.StopAcquisition();
+                    m_cameraId.clear();
+                    return "OK";
+                }
+                if (command == "DETACH")
+                {
+                    if (attached)
+                    {
+                        attached = false;
+                        --m_attachedClients;
+                    }
+                    return "OK";
+                }
+                if (command == "SHUTDOWN")
+                {
+                    m_acquisitionManager.StopAcquisition();
+                    m_cameraId.clear();
+                    m_shutdown = true;
+                    m_shutdownCondition.notify_all();
+                    return "OK";
+                }
+                return "ERROR unknown request " + command;
+            }
+            catch (VmbException const& ex)
+            {
+                return std::string("ERROR ") + ex.what();
+            }
+        }
+
+        std::string AcquisitionDaemon::GetStatus()
+        {
+            std::ostringstream reply;
+            reply << "OK camera=" << (m_cameraId.empty() ? "-" : m_cameraId)
+                  << " clients=" << m_attachedClients;
+            if (m_acquisitionManager.IsAcquisitionActive())
+            {
+                auto const statistics = m_acquisitionManager.GetStatistics();
+                reply << " received=" << statistics.m_framesReceived
+                      << " incomplete=" << statistics.m_framesIncomplete
+                      << " missing=" << statistics.m_framesMissing;
+                if (m_acquisitionManager.GetChunkMetadataFields() != 0)
+                {
+                    reply << " without_metadata=" << statistics.m_framesWithoutMetadata;
+                }
+            }
+            SharedFrameExport::Statistics sharedExport;
+            if (m_acquisitionManager.GetSharedExportStatistics(sharedExport))
+            {
+                reply << " published=" << sharedExport.m_framesPublished
+                      << " readers=" << sharedExport.m_readers
+                      << " held=" << sharedExport.m_framesHeld
+                      << " reclaimed=" << sharedExport.m_framesReclaimed
+                      << " waiting=" << sharedExport.m_framesWaiting;
+            }
+            RawPipeSink::Statistics pipe;
+            if (GetPipeStatistics(pipe))
+            {
+                reply << " piped=" << pipe.m_framesWritten
+                      << " pipe_dropped=" << pipe.m_framesDropped
+                      << " pipe_skipped=" << pipe.m_framesSkipped
+                      << " pipe_reader=" << (pipe.m_readerConnected ? 1 : 0);
+            }
+            return reply.str();
+        }
+    }
+}
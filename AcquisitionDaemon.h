@@ -0,0 +1,206 @@
+/**
+ * \date 2023
+ * \copyright Allied Vision Technologies.  All Rights Reserved.
+ *
+ * \copyright Redistribution of this file, in original or modified form, without
+ *            prior written consent of Allied Vision Technologies is prohibited.
+ *
+ * \warning THIS SOFTWARE IS PROVIDED BY THE AUTHOR "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF TITLE,
+ * NON-INFRINGEMENT, MERCHANTABILITY AND FITNESS FOR A PARTICULAR  PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \brief Definition of a process keeping the acquisition running for attachable viewers
+ */
+
+#ifndef ASYNCHRONOUSGRAB_C_ACQUISITION_DAEMON_H
+#define ASYNCHRONOUSGRAB_C_ACQUISITION_DAEMON_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include <VmbC/VmbC.h>
+
+#include "AcquisitionManager.h"
+#include "ConnectionServer.h"
+#include "FrameSink.h"
+#include "RawPipeSink.h"
+#include "SharedFrameExport.h"
+#include "Socket.h"
+#include "VmbLibraryLifetime.h"
+
+namespace VmbC
+{
+    namespace Examples
+    {
+        /**
+         * \brief Keeps the camera open and the frame buffers allocated in a
+         *        long-lived process independent of the viewers.
+         *
+         * The frames are not converted, but exported via SharedFrameExport
+         * and, if Settings::m_pipe is set, written to a pipe by RawPipeSink;
+         * clients, e.g. the gui via AcquisitionManager::StartRemote, map the
+         * buffers and convert the frames themselves. Clients control the
+         * daemon via DaemonClient over a TCP connection of the loopback
+         * interface with one line per request and one line per reply:
+         *
+         * - `CAMERAS`: `OK <camera id>...`
+         * - `START <camera id>`: open the camera, if it is not open yet, and
+         *   attach; `OK <shared memory name>`; another camera is only closed,
+         *   if no other client is attached
+         * - `ATTACH`: attach to the running acquisition; `OK <shared memory
+         *   name> <camera id>`
+         * - `STATUS`: `OK camera=<camera id> clients=<n> received=<n> ...`
+         * - `STOP`: stop the acquisition, if no other client is attached
+         * - `DETACH`: `OK` and close the connection
+         * - `SHUTDOWN`: stop the acquisition even with other clients
+         *   attached, who see the shared memory closed, and let
+         *   WaitForShutdown return
+         *
+         * Failed requests are answered with `ERROR <message>`. Closing the
+         * connection, e.g. by a crashing viewer, detaches the client; the
+         * acquisition keeps running until the last attached client requests
+         * STOP.
+         */
+        class AcquisitionDaemon
+        {
+        public:
+            static constexpr VmbUint16_t DefaultPort = 5561;
+
+            struct Settings
+            {
+                VmbUint16_t m_port { DefaultPort };
+
+                /**
+                 * \brief the export of the frames; m_retainedFrames is
+                 *        replaced by the value below
+                 */
+                SharedFrameExport::Settings m_sharedMemory;
+
+                /**
+                 * \brief the number of the most recent frames kept for the
+                 *        clients; since the daemon does not convert the frames,
+                 *        they would be requeued right after being published
+                 *        otherwise
+                 */
+                VmbUint32_t m_retainedFrames { AcquisitionManager::BufferCount / 2 };
+
+                /**
+                 * \brief write the raw frames to a pipe in addition, if
+                 *        m_pipe.m_path is not empty
+                 */
+                RawPipeSink::Settings m_pipe;
+
+                /**
+                 * \brief the MetadataField values read from the chunk data of
+                 *        the frames and exported with them; 0 leaves the
+                 *        chunk mode of the cameras unchanged
+                 */
+                VmbUint32_t m_chunkMetadata { 0 };
+            };
+
+            /**
+             * \brief start VmbC and listen for clients on the loopback interface
+             * \throws VmbException, if VmbC cannot be started or the port
+             *                      cannot be bound
+             */
+            AcquisitionDaemon(Settings const& settings);
+
+            /**
+             * \brief disconnects the clients and stops the acquisition
+             */
+            ~AcquisitionDaemon();
+
+            AcquisitionDaemon(AcquisitionDaemon const&) = delete;
+            AcquisitionDaemon& operator=(AcquisitionDaemon const&) = delete;
+
+            VmbUint16_t GetPort() const noexcept
+            {
+                return m_server->GetPort();
+            }
+
+            /**
+             * \brief wait until a client requested SHUTDOWN
+             * \return false, if the timeout expired before
+             */
+            bool WaitForShutdown(std::chrono::milliseconds timeout);
+
+            /**
+             * \return false, if the frames are not written to a pipe
+             */
+            bool GetPipeStatistics(RawPipeSink::Statistics& statistics) const;
+        private:
+            /**
+             * \brief receives the converted frames; never called, since the
+             *        conversion is disabled
+             */
+            class DiscardingFrameSink : public ConvertedFrameSink
+            {
+            public:
+                void ConvertedFrameReceived(Image const&, VmbFrame_t const&) override
+                {
+                }
+            };
+
+            Settings const m_settings;
+            VmbLibraryLifetime m_libraryLife;
+            DiscardingFrameSink m_discardingSink;
+
+            /**
+             * \brief registered as raw frame sink of m_acquisitionManager;
+             *        null, if the frames are not written to a pipe
+             */
+            std::unique_ptr<RawPipeSink> m_pipeSink;
+
+            /**
+             * \name State guarded by m_mutex
+             */
+            ///@{
+            AcquisitionManager m_acquisitionManager;
+            std::string m_cameraId;
+            unsigned m_attachedClients { 0 };
+            bool m_shutdown { false };
+            ///@}
+
+            std::mutex m_mutex;
+
+            /**
+             * \brief notified when m_shutdown is set
+             */
+            std::condition_variable m_shutdownCondition;
+
+            /**
+             * \brief serves the control connections; created last
+             */
+            std::unique_ptr<ConnectionServer> m_server;
+
+            /**
+             * \brief answer the requests of a connection until it is closed
+             *        or stop is set
+             */
+            void ServeClient(Socket const& connection, std::atomic<bool> const& stop);
+
+            /**
+             * \brief execute a request
+             * \param[in,out] attached true, if the client sending the request
+             *                         is attached
+             * \return the reply without the line break
+             */
+            std::string Execute(std::string const& request, bool& attached);
+
+            std::string GetStatus();
+        };
+    }
+}
+
+#endif
@@ -18,16 +18,18 @@
  * \brief Implementation of ::VmbC::Examples::AcquisitionManager
  */
 
+#include <algorithm>
 #include <cstdlib>
 #include <cstring>
 #include <limits>
 #include <string>
 
 #include "AcquisitionManager.h"
+#include "FrameQueue.h"
+#include "ProcessStatistics.h"
+#include "Tracing.h"
 #include "VmbException.h"
 
-#include "UI/MainWindow.h"
-
 namespace VmbC
 {
     namespace Examples
@@ -83,9 +85,77 @@ namespace VmbC
         3.调用m_imageTranscoder对象的Start()函数，开始图像转码。 
         */
         {
-            StopAcquisition(); // if a camera is open, close it first
+            PrepareAcquisition();
             m_openCamera.reset(new CameraAccessLifetime(cameraInfo, *this));
+            if (m_conversionEnabled)
+            {
+                m_imageTranscoder.Start();
+            }
+            m_frameBuffers.Set(BufferCount);
+        }
+
+        void AcquisitionManager::StartPlayback(PlaybackCamera::Settings const& settings)
+        /* 
+        brief：开始回放录制的文件
+        与StartAcquisition相同，只是帧由PlaybackCamera通过FrameCallback交付，而不是由VmbC交付。
+        回放的帧不通过VmbCaptureFrameQueue重新入队，因此必须先启动转码器，否则在启动之前交付的帧会丢失。
+         */
+        {
+            PrepareAcquisition();
             m_imageTranscoder.Start();
+            try
+            {
+                // context[0] holds this object like the frames filled by AcquisitionContext
+                m_playback.reset(new PlaybackCamera(settings, &AcquisitionManager::FrameCallback, this, BufferCount));
+            }
+            catch (...)
+            {
+                m_imageTranscoder.Stop();
+                throw;
+            }
+            m_startupTimings.m_cameraOpened = m_startupTimings.m_acquisitionStarted = Clock::now();
+            m_frameBuffers.Set(BufferCount);
+        }
+
+        void AcquisitionManager::StartRemote(RemoteCamera::Settings const& settings)
+        /* 
+        brief：处理另一个进程（例如AcquisitionDaemon）通过共享内存导出的帧
+        与StartPlayback相同，帧由RemoteCamera通过FrameCallback交付；帧引用共享内存中的缓冲区，只在本进程中转换，
+        因此多个客户端同时观看时，采集进程不需要为每个客户端额外转换。
+         */
+        {
+            PrepareAcquisition();
+            m_imageTranscoder.Start();
+            try
+            {
+                m_remote.reset(new RemoteCamera(settings, &AcquisitionManager::FrameCallback, this));
+            }
+            catch (...)
+            {
+                m_imageTranscoder.Stop();
+                throw;
+            }
+            m_startupTimings.m_cameraOpened = m_startupTimings.m_acquisitionStarted = Clock::now();
+            m_frameBuffers.Set(RemoteCamera::DefaultFrameCount);
+        }
+
+        void AcquisitionManager::PrepareAcquisition() noexcept
+        /* 
+        brief：停止当前的采集并重置当前采集的统计信息
+         */
+        {
+            StopAcquisition(); // if a camera is open, close it first
+            m_startupTimings.m_startRequested = Clock::now();
+            m_firstFrameTicks.store(0, std::memory_order_relaxed);
+            m_statisticsBase.m_framesReceived = m_framesReceived.Get();
+            m_statisticsBase.m_framesIncomplete = m_framesIncomplete.Get();
+            m_statisticsBase.m_framesMissing = m_framesMissing.Get();
+            m_statisticsBase.m_framesWithoutMetadata = m_framesWithoutMetadata.Get();
+            m_statisticsBase.m_transcoder = m_imageTranscoder.GetStatistics();
+            for (auto& slot : m_receiveTimes)
+            {
+                slot.m_frameId.store(~VmbUint64_t(0), std::memory_order_relaxed);
+            }
         }
 
         void AcquisitionManager::StopAcquisition() noexcept
@@ -93,23 +163,42 @@ namespace VmbC
         brief：停止图像采集
         这是AcquisitionManager类的成员函数，用于停止图像采集。它执行以下操作：
         1.调用m_imageTranscoder对象的Stop()函数，停止图像转码。
-        2.通过调用m_openCamera的reset()函数，将其重置为空指针。 
+        2.通过调用m_openCamera的reset()函数，将其重置为空指针；回放时销毁PlaybackCamera，处理其他进程的帧时销毁RemoteCamera。
          */
         {
             m_imageTranscoder.Stop();
+            m_playback.reset();
+            m_remote.reset();
             m_openCamera.reset();
+            m_enabledChunkFields.store(0, std::memory_order_relaxed);
+            m_frameBuffers.Set(0);
         }
 
-        AcquisitionManager::AcquisitionManager(MainWindow& renderWindow)
+        AcquisitionManager::AcquisitionManager(ConvertedFrameSink& renderWindow)
         /*
         brief：AcquisitionManager的类构造函数
-        这是AcquisitionManager类的构造函数，接受一个MainWindow对象的引用作为参数。它执行以下操作：
+        这是AcquisitionManager类的构造函数，接受一个ConvertedFrameSink对象（例如MainWindow使用的PixmapFrameSink）的引用作为参数。它执行以下操作：
         初始化m_renderWindow成员变量为传入的renderWindow对象。
         初始化m_imageTranscoder对象，将当前的AcquisitionManager对象(*this)作为参数传递给它。 
+        在m_metrics中注册采集相关的指标以及进程的CPU时间和内存占用（在读取指标时计算）。
          */
             : m_renderWindow(renderWindow),
-            m_imageTranscoder(*this)
+            m_rawSinks(FrameSinkGraph::Settings()),
+            m_framesReceived(m_metrics.AddCounter("vmb_frames_received_total", "Frames delivered by VmbC")),
+            m_framesIncomplete(m_metrics.AddCounter("vmb_frames_incomplete_total", "Frames delivered with a status other than complete")),
+            m_framesMissing(m_metrics.AddCounter("vmb_frames_missing_total", "Frames never delivered detected via gaps in the frame IDs")),
+            m_framesWithoutMetadata(m_metrics.AddCounter("vmb_frames_without_metadata_total", "Frames without readable chunk data while chunk metadata is enabled")),
+            m_frameLatency(m_metrics.AddHistogram("vmb_frame_latency_seconds", "Time from the frame callback until the converted frame is passed to the sink",
+                                                  Histogram::ExponentialBuckets(0.001, 2.0, 12))),
+            m_frameBuffers(m_metrics.AddGauge("vmb_frame_buffers", "Frame buffers announced for the current acquisition")),
+            m_imageTranscoder(*this, m_metrics)
         {
+            m_metrics.AddCallback("process_cpu_seconds_total", "Total user and system CPU time spent in seconds",
+                                  MetricsRegistry::Type::Counter,
+                                  []() { return std::chrono::duration<double>(GetProcessCpuTime()).count(); });
+            m_metrics.AddCallback("process_resident_memory_bytes", "Resident memory size in bytes",
+                                  MetricsRegistry::Type::Gauge,
+                                  []() { return static_cast<double>(GetResidentSetSize()); });
         }
 
         AcquisitionManager::~AcquisitionManager()
@@ -124,25 +213,146 @@ namespace VmbC
             m_openCamera.reset();
         }
 
-        void AcquisitionManager::ConvertedFrameReceived(QPixmap image)
+        void AcquisitionManager::ConvertedFrameReceived(Image const& image, VmbFrame_t const& frame)
         /* 
         brief：转换接受到的帧
         这是AcquisitionManager类的成员函数，用于接收转换后的图像帧。它执行以下操作：
-        1. 将接收到的image参数传递给m_renderWindow对象的RenderImage()函数，以在窗口中渲染图像。
+        1. 将接收到的image参数传递给m_renderWindow对象的ConvertedFrameReceived()函数，以在窗口中渲染图像。
+        2. 再传递给通过AddConvertedFrameSink注册的其他对象。
+         */
+        {
+            m_renderWindow.ConvertedFrameReceived(image, frame);
+            {
+                std::lock_guard<std::mutex> lock(m_convertedSinkMutex);
+                for (auto sink : m_convertedSinks)
+                {
+                    sink->ConvertedFrameReceived(image, frame);
+                }
+            }
+
+            Clock::time_point receiveTime;
+            if (GetReceiveTime(frame.frameID, receiveTime))
+            {
+                m_frameLatency.Observe(std::chrono::duration<double>(Clock::now() - receiveTime).count());
+            }
+        }
+
+        void AcquisitionManager::AddRawFrameSink(RawFrameSink& sink)
+        /* 
+        brief：注册接收未转换帧的对象
+         */
+        {
+            AddRawFrameSink(sink, FrameSinkGraph::EdgeSettings());
+        }
+
+        void AcquisitionManager::AddRawFrameSink(RawFrameSink& sink, FrameSinkGraph::EdgeSettings const& settings)
+        /* 
+        brief：按优先级和队列设置注册接收未转换帧的对象
+        没有队列的对象在帧回调中直接调用；有队列的对象由m_rawSinks中该边的线程调用，帧回调只复制帧。
+         */
+        {
+            m_rawSinks.AddSink(sink, settings);
+        }
+
+        void AcquisitionManager::RemoveRawFrameSink(RawFrameSink& sink) noexcept
+        /* 
+        brief：注销接收未转换帧的对象
+        由于m_rawSinks在调用这些对象时持有自己的锁，并等待边的线程结束，函数返回后不会再调用该对象。
+         */
+        {
+            m_rawSinks.RemoveSink(sink);
+        }
+
+        void AcquisitionManager::AddConvertedFrameSink(ConvertedFrameSink& sink)
+        /* 
+        brief：注册接收转换后的帧的其他对象（例如视频编码）
+         */
+        {
+            std::lock_guard<std::mutex> lock(m_convertedSinkMutex);
+            m_convertedSinks.push_back(&sink);
+        }
+
+        void AcquisitionManager::RemoveConvertedFrameSink(ConvertedFrameSink& sink) noexcept
+        /* 
+        brief：注销接收转换后的帧的对象
+        ConvertedFrameReceived在调用这些对象时持有m_convertedSinkMutex，函数返回后不会再调用该对象。
+         */
+        {
+            std::lock_guard<std::mutex> lock(m_convertedSinkMutex);
+            m_convertedSinks.erase(std::remove(m_convertedSinks.begin(), m_convertedSinks.end(), &sink), m_convertedSinks.end());
+        }
+
+        bool AcquisitionManager::GetSharedExportStatistics(SharedFrameExport::Statistics& statistics) const noexcept
+        {
+            auto const sharedExport = m_sharedExport.load(std::memory_order_acquire);
+            if (sharedExport == nullptr)
+            {
+                return false;
+            }
+            statistics = sharedExport->GetStatistics();
+            return true;
+        }
+
+        bool AcquisitionManager::GetFirstFrameTime(Clock::time_point& time) const noexcept
+        /* 
+        brief：获取当前采集收到第一帧的时间
+        如果采集开始后尚未收到任何帧，返回false。
          */
         {
-            m_renderWindow.RenderImage(image);
+            auto const ticks = m_firstFrameTicks.load(std::memory_order_acquire);
+            if (ticks == 0)
+            {
+                return false;
+            }
+            time = Clock::time_point(Clock::duration(ticks));
+            return true;
         }
 
-        void AcquisitionManager::SetOutputSize(QSize size)
+        AcquisitionManager::Statistics AcquisitionManager::GetStatistics() const noexcept
         /* 
-        brief：设定输出图像大小
-        这是AcquisitionManager类的成员函数，用于设置输出图像的大小。它执行以下操作：
-        1. 将指定的size参数传递给m_imageTranscoder对象的SetOutputSize()函数，以设置输出图像的尺寸。
+        brief：读取当前采集的统计计数器
+        计数器只在帧回调中以原子操作更新，因此可以在任意线程（例如GUI定时器）中读取，不需要加锁。
+        指标是累计值，这里减去采集开始时记录的值；队列深度和质量等级是当前值，不做减法。
+         */
+        {
+            auto const transcoder = m_imageTranscoder.GetStatistics();
+            auto const& transcoderBase = m_statisticsBase.m_transcoder;
+
+            Statistics result;
+            result.m_framesReceived = m_framesReceived.Get() - m_statisticsBase.m_framesReceived;
+            result.m_framesIncomplete = m_framesIncomplete.Get() - m_statisticsBase.m_framesIncomplete;
+            result.m_framesMissing = m_framesMissing.Get() - m_statisticsBase.m_framesMissing;
+            result.m_framesWithoutMetadata = m_framesWithoutMetadata.Get() - m_statisticsBase.m_framesWithoutMetadata;
+            result.m_transcoder.m_framesConverted = transcoder.m_framesConverted - transcoderBase.m_framesConverted;
+            result.m_transcoder.m_framesDropped = transcoder.m_framesDropped - transcoderBase.m_framesDropped;
+            result.m_transcoder.m_conversionTime = transcoder.m_conversionTime - transcoderBase.m_conversionTime;
+            result.m_transcoder.m_queueDepth = transcoder.m_queueDepth;
+            result.m_transcoder.m_framesSkipped = transcoder.m_framesSkipped - transcoderBase.m_framesSkipped;
+            result.m_transcoder.m_qualityChanges = transcoder.m_qualityChanges - transcoderBase.m_qualityChanges;
+            result.m_transcoder.m_qualityLevel = transcoder.m_qualityLevel;
+            result.m_transcoder.m_qualityLevels = transcoder.m_qualityLevels;
+            return result;
+        }
 
+        bool AcquisitionManager::GetReceiveTime(VmbUint64_t const frameId, Clock::time_point& time) const noexcept
+        /* 
+        brief：获取某一帧被VmbC交付的时间
+        时间保存在按帧ID取模的固定槽位中；写入时最后写帧ID，读取时在读取时间前后都检查帧ID，
+        这样即使槽位同时被新的帧覆盖也不会返回错误的时间。
          */
         {
-            m_imageTranscoder.SetOutputSize(size);
+            auto const& slot = m_receiveTimes[frameId % ReceiveTimeSlots];
+            if (slot.m_frameId.load(std::memory_order_acquire) != frameId)
+            {
+                return false;
+            }
+            auto const ticks = slot.m_ticks.load(std::memory_order_acquire);
+            if (slot.m_frameId.load(std::memory_order_acquire) != frameId)
+            {
+                return false;
+            }
+            time = Clock::time_point(Clock::duration(ticks));
+            return true;
         }
 
         void VMB_CALL AcquisitionManager::FrameCallback(VmbHandle_t /* cameraHandle */, VmbHandle_t const streamHandle, VmbFrame_t* frame)
@@ -157,6 +367,9 @@ namespace VmbC
         {
             if (frame != nullptr)
             {
+                ASYNCHRONOUSGRAB_TRACE_THREAD_NAME("VmbC frame callback");
+                ASYNCHRONOUSGRAB_TRACE_SCOPE("FrameCallback", frame->frameID);
+
                 AcquisitionContext context(*frame);
                 if (context.m_acquisitionManager != nullptr)
                 {
@@ -170,9 +383,65 @@ namespace VmbC
         brief：接受帧数据
         这是AcquisitionManager类的成员函数，用于接收帧数据。它执行以下操作：
         调用m_imageTranscoder对象的PostImage()函数，传递streamHandle、&AcquisitionManager::FrameCallback（函数指针）和frame作为参数。通过这样做，将帧数据提交给m_imageTranscoder对象进行处理。
+        禁用转换时（例如在AcquisitionDaemon中），帧在交给原始帧接收者和共享内存导出之后直接重新入队。
+        启用块元数据时，先从帧的块数据中读取一次元数据，存入帧旁边的FrameMetadata，之后所有接收者都通过GetFrameMetadata读取，不再访问相机特性。
          */
         {
-            m_imageTranscoder.PostImage(streamHandle, &AcquisitionManager::FrameCallback, frame);
+            auto const receiveTicks = Clock::now().time_since_epoch().count();
+            if (m_firstFrameTicks.load(std::memory_order_relaxed) == 0)
+            {
+                Clock::rep expected = 0;
+                m_firstFrameTicks.compare_exchange_strong(expected, receiveTicks, std::memory_order_release);
+            }
+
+            if (frame != nullptr)
+            {
+                bool const firstFrame = m_framesReceived.Get() == m_statisticsBase.m_framesReceived;
+                m_framesReceived.Increment();
+                if (frame->receiveStatus != VmbFrameStatusComplete)
+                {
+                    m_framesIncomplete.Increment();
+                }
+
+                // frame IDs are consecutive; a gap means the frame was lost before reaching us
+                auto const lastFrameId = m_lastFrameId.exchange(frame->frameID, std::memory_order_relaxed);
+                if (!firstFrame && frame->frameID > lastFrameId + 1)
+                {
+                    m_framesMissing.Increment(frame->frameID - lastFrameId - 1);
+                }
+
+                auto& slot = m_receiveTimes[frame->frameID % ReceiveTimeSlots];
+                slot.m_frameId.store(~VmbUint64_t(0), std::memory_order_relaxed);
+                slot.m_ticks.store(receiveTicks, std::memory_order_release);
+                slot.m_frameId.store(frame->frameID, std::memory_order_release);
+
+                // the metadata is stored in the Frame owning the buffer; read once before any sink sees the frame
+                auto const chunkFields = m_enabledChunkFields.load(std::memory_order_relaxed);
+                auto const metadata = static_cast<FrameMetadata*>(frame->context[FrameMetadataContextIndex]);
+                if (chunkFields != 0 && metadata != nullptr)
+                {
+                    ASYNCHRONOUSGRAB_TRACE_SCOPE("ReadChunkMetadata", frame->frameID);
+                    if (!ReadChunkMetadata(*frame, chunkFields, *metadata))
+                    {
+                        m_framesWithoutMetadata.Increment();
+                    }
+                }
+
+                if (auto const sharedExport = m_sharedExport.load(std::memory_order_acquire))
+                {
+                    sharedExport->Publish(*frame);
+                }
+
+                m_rawSinks.FrameReceived(*frame);
+            }
+            if (m_conversionEnabled)
+            {
+                m_imageTranscoder.PostImage(streamHandle, &AcquisitionManager::FrameCallback, frame);
+            }
+            else if (frame != nullptr)
+            {
+                QueueFrame(streamHandle, frame, &AcquisitionManager::FrameCallback);
+            }
         }
 
         AcquisitionManager::CameraAccessLifetime::CameraAccessLifetime(VmbCameraInfo_t const& camInfo, AcquisitionManager& acquisitionManager)
@@ -190,6 +459,7 @@ namespace VmbC
             {
                 throw VmbException::ForOperation(error, "VmbCameraOpen");
             }
+            acquisitionManager.m_startupTimings.m_cameraOpened = Clock::now();
 
             // refresh camera info to get streams
             VmbCameraInfo_t refreshedCameraInfo;
@@ -246,6 +516,14 @@ namespace VmbC
                     printf("GVSPAdjustPacketSize: %lld\n", packetSize);
                 }
 
+                // the chunks enlarge the payload, so they are enabled before StreamLifetime reads its size
+                if (acquisitionManager.m_chunkMetadataFields != 0)
+                {
+                    auto const enabled = EnableChunkMetadata(m_cameraHandle, acquisitionManager.m_chunkMetadataFields);
+                    m_chunkMode = enabled != 0;
+                    acquisitionManager.m_enabledChunkFields.store(enabled, std::memory_order_relaxed);
+                }
+
                 try
                 {
                     /*
@@ -261,6 +539,10 @@ namespace VmbC
                  */
                 catch (...)
                 {
+                    if (m_chunkMode)
+                    {
+                        DisableChunkMetadata(m_cameraHandle);
+                    }
                     VmbCameraClose(m_cameraHandle);
                     throw;
                 }
@@ -281,6 +563,10 @@ namespace VmbC
          */
         {
             m_streamLife.reset(); // close stream first
+            if (m_chunkMode)
+            {
+                DisableChunkMetadata(m_cameraHandle);
+            }
             VmbCameraClose(m_cameraHandle);
         }
 
@@ -374,14 +660,23 @@ namespace VmbC
 
         AcquisitionManager::AcquisitionLifetime::AcquisitionLifetime(VmbHandle_t const camHandle, size_t payloadSize, size_t nBufferAlignment, AcquisitionManager& acquisitionManager)
         /* brief：实现了相机帧的获取和处理过程 */
-            : m_camHandle(camHandle)//初始化m_camHandle
+            : m_acquisitionManager(acquisitionManager),
+            m_camHandle(camHandle),//初始化m_camHandle
+            m_timeLapse(acquisitionManager.m_timeLapse)
         {
+            /* 启用共享内存导出时，帧缓冲区分配在共享内存区域中，相机直接写入其中。 */
+            if (acquisitionManager.m_sharedExportEnabled)
+            {
+                m_sharedExport.reset(new SharedFrameExport(acquisitionManager.m_sharedExportSettings, BufferCount, payloadSize, nBufferAlignment));
+            }
+
             m_frames.reserve(BufferCount);
             /* 循环创建帧对象 */
-            for (size_t count = BufferCount; count > 0; --count)
+            for (VmbUint32_t index = 0; index != BufferCount; ++index)
             {
-                auto frame = std::unique_ptr<Frame>(new Frame(payloadSize, nBufferAlignment));
                 /* 创建指定playloadSize和nBufferAlignment的Frame对象 */
+                auto frame = m_sharedExport ? std::unique_ptr<Frame>(new Frame(m_sharedExport->GetBuffer(index), payloadSize))
+                                            : std::unique_ptr<Frame>(new Frame(payloadSize, nBufferAlignment));
                 m_frames.emplace_back(std::move(frame));
             }
 
@@ -391,6 +686,9 @@ namespace VmbC
                 AcquisitionContext context(&acquisitionManager);
                 /* 使用 AcquisitionContext 将 acquisitionManager 填充到帧的上下文中。 */
                 context.FillFrame(frame->m_frame);
+                // requeued via VmbCaptureFrameQueue; exported frames only after all readers released them
+                SetFrameQueue(frame->m_frame, m_sharedExport.get());
+                SetFrameMetadata(frame->m_frame, &frame->m_metadata);
 
                 error = VmbFrameAnnounce(camHandle, &(frame->m_frame), sizeof(frame->m_frame));
                 /* 调用 VmbFrameAnnounce 将帧通告给相机。 */
@@ -418,6 +716,12 @@ namespace VmbC
                 throw VmbException::ForOperation(error, "VmbCaptureStart");
             }
 
+            if (m_sharedExport)
+            {
+                m_sharedExport->Start(camHandle, &AcquisitionManager::FrameCallback);
+                acquisitionManager.m_sharedExport = m_sharedExport.get();
+            }
+
             size_t numberEnqueued = 0;
 
             for (auto& frame : m_frames)
@@ -436,6 +740,7 @@ namespace VmbC
             if (numberEnqueued == 0)
             /* 表示没有帧成功加入帧队列。 */
             {
+                acquisitionManager.m_sharedExport = nullptr;
                 VmbCaptureEnd(camHandle);
                 throw VmbException("Non of the frames could be enqueued using VmbCaptureFrameQueue", error);
             }
@@ -443,23 +748,35 @@ namespace VmbC
             try
             /* 
             执行 AcquisitionStart 命令：
-            1. 调用 RunCommand 执行 AcquisitionStart 命令。
-            2. 如果执行失败，调用 VmbCaptureEnd 结束相机捕获。
-            3. 抛出相应的异常。 
+            1. 启用延时摄影时，先把相机切换为软件触发（必须在开始采集之前设置）。
+            2. 调用 RunCommand 执行 AcquisitionStart 命令。
+            3. 如果执行失败，恢复触发设置并调用 VmbCaptureEnd 结束相机捕获。
+            4. 抛出相应的异常。 
             */
             {
+                m_timeLapse.Configure(camHandle);
                 RunCommand(camHandle, "AcquisitionStart");
             }
             catch (VmbException const&)
             {
+                m_timeLapse.Restore();
+                acquisitionManager.m_sharedExport = nullptr;
                 VmbCaptureEnd(camHandle);
                 throw;
             }
+            acquisitionManager.m_startupTimings.m_acquisitionStarted = Clock::now();
+            m_timeLapse.Start();
         }
 
         AcquisitionManager::AcquisitionLifetime::~AcquisitionLifetime()
-        /* 出现异常时进行相应的清理 */
+        /* 出现异常时进行相应的清理；延时摄影的触发在停止采集之前结束，触发设置在停止采集之后恢复。
+        共享内存导出在停止采集之前停止，不再把读取者释放的帧重新入队；撤销所有帧之后不会再有回调，才清除AcquisitionManager中的指针。 */
         {
+            m_timeLapse.Stop();
+            if (m_sharedExport)
+            {
+                m_sharedExport->Stop();
+            }
             try
             {
                 RunCommand(m_camHandle, "AcquisitionStop");
@@ -471,6 +788,8 @@ namespace VmbC
             VmbCaptureEnd(m_camHandle);
             VmbCaptureQueueFlush(m_camHandle);
             VmbFrameRevokeAll(m_camHandle);
+            m_acquisitionManager.m_sharedExport = nullptr;
+            m_timeLapse.Restore();
         }
 
         AcquisitionManager::Frame::Frame(size_t payloadSize, size_t bufferAlignment)
@@ -505,11 +824,26 @@ namespace VmbC
             m_frame.bufferSize = static_cast<VmbUint32_t>(payloadSize);
         }
 
+        AcquisitionManager::Frame::Frame(void* const buffer, size_t const payloadSize)
+            : m_ownsBuffer(false)
+        {
+            if (payloadSize > (std::numeric_limits<VmbUint32_t>::max)())
+            {
+                throw VmbException("payload size outside of allowed range");
+            }
+            m_frame.buffer = buffer;
+            m_frame.bufferSize = static_cast<VmbUint32_t>(payloadSize);
+        }
+
         AcquisitionManager::Frame::~Frame()
-        /*释放帧缓冲区的内存 
+        /*释放帧缓冲区的内存（不属于该帧的缓冲区除外）
         a. 如果是 Windows 操作系统（_WIN32 宏定义已设置），使用 _aligned_free 函数释放内存块。
         b. 如果是其他操作系统，使用 std::free 函数释放内存块。 */
         {
+            if (!m_ownsBuffer)
+            {
+                return;
+            }
 #ifdef _WIN32
             _aligned_free(m_frame.buffer);
 #else
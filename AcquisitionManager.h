@@ -17,24 +17,31 @@
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  *
  * \brief Definition of a class responsible for managing the acquisition and
- *        scheduling transformation and transfering converted frames to the
- *        gui.
+ *        scheduling transformation and transfering converted frames to a
+ *        sink, e.g. the gui.
  */
 
 #ifndef ASYNCHRONOUSGRAB_C_ACQUISITION_MANAGER_H
 #define ASYNCHRONOUSGRAB_C_ACQUISITION_MANAGER_H
 
+#include <array>
+#include <atomic>
+#include <chrono>
 #include <memory>
+#include <mutex>
 #include <vector>
 
-#include <QPixmap>
-#include <QSize>
-
 #include <VmbC/VmbC.h>
 
+#include "FrameMetadata.h"
+#include "FrameSink.h"
+#include "FrameSinkGraph.h"
 #include "ImageTranscoder.h"
-
-class MainWindow;
+#include "MetricsRegistry.h"
+#include "PlaybackCamera.h"
+#include "RemoteCamera.h"
+#include "SharedFrameExport.h"
+#include "TimeLapseTrigger.h"
 
 namespace VmbC
 {
@@ -45,7 +52,7 @@ namespace VmbC
         /**
          * \brief Responsible for starting/stoping the acquisition, scheduling
          *        the transformation of frames received during the acquisition
-         *        and transfering the results to the qt window
+         *        and transfering the results to a ConvertedFrameSink, e.g. the qt window
          * 负责启动/停止采集、调度
          * 采集过程中接收到的帧的变换
          * 并将结果传输到qt窗口。
@@ -55,12 +62,57 @@ namespace VmbC
         public:
             static constexpr VmbUint32_t BufferCount = 10;
 
+            using Clock = std::chrono::steady_clock;
+
+            /**
+             * \brief points in time recorded during the last call of
+             *        StartAcquisition
+             */
+            struct StartupTimings
+            {
+                Clock::time_point m_startRequested;
+                Clock::time_point m_cameraOpened;
+                Clock::time_point m_acquisitionStarted;
+            };
+
+            /**
+             * \brief counters of the current acquisition; see GetMetrics for
+             *        values accumulated over the lifetime of the object
+             */
+            struct Statistics
+            {
+                /**
+                 * \brief number of frames delivered by VmbC 
+                 */
+                VmbUint64_t m_framesReceived;
+
+                /**
+                 * \brief number of frames delivered with a status other than
+                 *        VmbFrameStatusComplete
+                 */
+                VmbUint64_t m_framesIncomplete;
+
+                /**
+                 * \brief number of frames never delivered detected via gaps in
+                 *        the frame IDs
+                 */
+                VmbUint64_t m_framesMissing;
+
+                /**
+                 * \brief number of frames without readable chunk data while
+                 *        chunk metadata is enabled
+                 */
+                VmbUint64_t m_framesWithoutMetadata;
+
+                ImageTranscoder::Statistics m_transcoder;
+            };
+
             /**
              * \return true, if currently an acquisition is running 
              */
             bool IsAcquisitionActive() const noexcept
             {
-                return static_cast<bool>(m_openCamera);
+                return static_cast<bool>(m_openCamera) || static_cast<bool>(m_playback) || static_cast<bool>(m_remote);
             }
 
             /**
@@ -68,28 +120,327 @@ namespace VmbC
              */
             void StartAcquisition(VmbCameraInfo_t const& cameraInfo);
 
+            /**
+             * \brief replay a recording through the frame callback instead of
+             *        acquiring from a camera
+             * \throws VmbException, if the recording cannot be opened
+             */
+            void StartPlayback(PlaybackCamera::Settings const& settings);
+
+            /**
+             * \brief process the frames another process, e.g. AcquisitionDaemon,
+             *        exports via shared memory instead of acquiring from a camera
+             * \throws VmbException, if the shared memory cannot be opened
+             */
+            void StartRemote(RemoteCamera::Settings const& settings);
+
+            /**
+             * \return true, if the process exporting the frames processed
+             *         since StartRemote stopped its acquisition
+             */
+            bool IsRemoteClosed() const noexcept
+            {
+                return m_remote && m_remote->IsClosed();
+            }
+
             /**
              * \brief stop the acquistion that is currently running
              */
             void StopAcquisition() noexcept;
 
-            AcquisitionManager(MainWindow& renderWindow);
+            AcquisitionManager(ConvertedFrameSink& renderWindow);
 
             ~AcquisitionManager();
 
             /**
              * \brief notifies this object about a frame available for rendering 
              */
-            void ConvertedFrameReceived(QPixmap image);
+            void ConvertedFrameReceived(Image const& image, VmbFrame_t const& frame);
+
+            /**
+             * \brief register a sink receiving every frame delivered by VmbC 
+             *        directly in the frame callback with priority 0
+             * \throws VmbException, if the sink is registered already
+             */
+            void AddRawFrameSink(RawFrameSink& sink);
+
+            /**
+             * \brief register a sink with a priority and optionally its own
+             *        queue, see FrameSinkGraph
+             * \throws VmbException, if the settings are invalid or the sink
+             *                      is registered already
+             */
+            void AddRawFrameSink(RawFrameSink& sink, FrameSinkGraph::EdgeSettings const& settings);
+
+            /**
+             * \brief get the counters of the raw frame sinks in the order
+             *        they are served
+             */
+            FrameSinkGraph::Statistics GetRawSinkStatistics() const
+            {
+                return m_rawSinks.GetStatistics();
+            }
+
+            /**
+             * \brief unregister a sink; the sink is not called anymore after
+             *        this function returns
+             */
+            void RemoveRawFrameSink(RawFrameSink& sink) noexcept;
+
+            /**
+             * \brief register a sink receiving the converted frames in
+             *        addition to the render window
+             */
+            void AddConvertedFrameSink(ConvertedFrameSink& sink);
+
+            /**
+             * \brief unregister a sink; the sink is not called anymore after
+             *        this function returns
+             */
+            void RemoveConvertedFrameSink(ConvertedFrameSink& sink) noexcept;
+
+            /**
+             * \brief enable or disable the conversion of the frames in the
+             *        following acquisitions; without conversion the frames are
+             *        only passed to the raw frame sinks and the shared memory
+             *        export and requeued immediately
+             */
+            void SetConversionEnabled(bool enabled) noexcept
+            {
+                m_conversionEnabled = enabled;
+            }
+
+            /**
+             * \brief let the conversion lower the quality of the preview
+             *        under load, see ImageTranscoder::SetAdaptiveQuality;
+             *        only while no acquisition is running
+             * \throws VmbException, if an acquisition is running or the
+             *                      settings are invalid
+             */
+            void SetAdaptivePreview(ImageTranscoder::AdaptiveQualitySettings const& settings)
+            {
+                m_imageTranscoder.SetAdaptiveQuality(settings);
+            }
+
+            /**
+             * \brief get the parameters of a quality level of the adaptive
+             *        preview
+             */
+            ImageTranscoder::QualityLevel GetPreviewQualityLevel(unsigned level) const noexcept
+            {
+                return m_imageTranscoder.GetQualityLevel(level);
+            }
+
+            /**
+             * \brief acquire single frames at the given interval via software
+             *        triggering in the following acquisitions; zero to let
+             *        the camera run freely; not used for playback
+             */
+            void SetTimeLapseInterval(Clock::duration interval) noexcept
+            {
+                m_timeLapse.SetInterval(interval);
+            }
+
+            /**
+             * \brief get the triggers and the idle cpu usage of the current
+             *        time-lapse acquisition
+             */
+            TimeLapseTrigger::Statistics GetTimeLapseStatistics() const noexcept
+            {
+                return m_timeLapse.GetStatistics();
+            }
+
+            /**
+             * \brief activate the chunk mode of the cameras of the following
+             *        acquisitions and read the given MetadataField values of
+             *        every frame before passing it on, see GetFrameMetadata;
+             *        0 leaves the chunk mode unchanged; not used for playback
+             */
+            void SetChunkMetadata(VmbUint32_t fields) noexcept
+            {
+                m_chunkMetadataFields = fields;
+            }
+
+            /**
+             * \brief get the MetadataField values the camera of the current
+             *        acquisition provides
+             */
+            VmbUint32_t GetChunkMetadataFields() const noexcept
+            {
+                return m_enabledChunkFields.load(std::memory_order_relaxed);
+            }
+
+            /**
+             * \brief allocate the frame buffers of the following acquisitions
+             *        in a named shared memory region and publish every frame
+             *        received to other processes; not used for playback
+             */
+            void EnableSharedFrameExport(SharedFrameExport::Settings const& settings)
+            {
+                m_sharedExportSettings = settings;
+                m_sharedExportEnabled = true;
+            }
+
+            /**
+             * \brief get the counters of the shared memory export of the
+             *        current acquisition
+             * \return false, if no frames are exported
+             */
+            bool GetSharedExportStatistics(SharedFrameExport::Statistics& statistics) const noexcept;
+
+            /**
+             * \brief get the timings recorded during the last successful call of
+             *        StartAcquisition
+             */
+            StartupTimings const& GetStartupTimings() const noexcept
+            {
+                return m_startupTimings;
+            }
+
+            /**
+             * \brief get the time the first frame of the current acquisition was
+             *        received
+             * \return false, if no frame was received since the acquisition was started
+             */
+            bool GetFirstFrameTime(Clock::time_point& time) const noexcept;
+
+            /**
+             * \brief read the counters of the current acquisition; may be called
+             *        from any thread, but not concurrently with StartAcquisition
+             */
+            Statistics GetStatistics() const noexcept;
+
+            /**
+             * \brief get the registry containing the cumulative metrics of the
+             *        acquisition and the conversion
+             */
+            MetricsRegistry& GetMetrics() noexcept
+            {
+                return m_metrics;
+            }
 
             /**
-             * \brief informs this object about the change of the desired output
-             *        size 
+             * \brief get the time a frame was delivered by VmbC
+             * 
+             * Only the times of the last ReceiveTimeSlots frames are available.
+             * 
+             * \return false, if the time is not available anymore
              */
-            void SetOutputSize(QSize size);
+            bool GetReceiveTime(VmbUint64_t frameId, Clock::time_point& time) const noexcept;
 
         private:
-            MainWindow& m_renderWindow;
+            ConvertedFrameSink& m_renderWindow;
+
+            /**
+             * \brief the metrics of this object and m_imageTranscoder; needs
+             *        to be constructed before any of the metrics members
+             */
+            MetricsRegistry m_metrics;
+
+            /**
+             * \brief the sinks receiving the unconverted frames
+             */
+            FrameSinkGraph m_rawSinks;
+
+            /**
+             * \brief the additional sinks receiving the converted frames;
+             *        guarded by m_convertedSinkMutex
+             */
+            std::vector<ConvertedFrameSink*> m_convertedSinks;
+
+            std::mutex m_convertedSinkMutex;
+
+            StartupTimings m_startupTimings;
+
+            /**
+             * \brief triggers the camera in time-lapse mode; configured and
+             *        started by AcquisitionLifetime
+             */
+            TimeLapseTrigger m_timeLapse;
+
+            /**
+             * \brief only changed while no acquisition is running
+             */
+            bool m_conversionEnabled { true };
+
+            SharedFrameExport::Settings m_sharedExportSettings;
+            bool m_sharedExportEnabled { false };
+
+            /**
+             * \brief the fields requested via SetChunkMetadata
+             */
+            VmbUint32_t m_chunkMetadataFields { 0 };
+
+            /**
+             * \brief the fields read from the frames of the current
+             *        acquisition; set by CameraAccessLifetime before frames
+             *        may be received
+             */
+            std::atomic<VmbUint32_t> m_enabledChunkFields { 0 };
+
+            /**
+             * \brief the export of the current acquisition; set by
+             *        AcquisitionLifetime while frames may be received
+             */
+            std::atomic<SharedFrameExport*> m_sharedExport { nullptr };
+
+            /**
+             * \brief ticks of Clock at the reception of the first frame of the
+             *        acquisition; 0, if no frame was received yet
+             */
+            std::atomic<Clock::rep> m_firstFrameTicks { 0 };
+
+            /**
+             * \name Metrics
+             * \brief metrics owned by m_metrics updated in the frame callback
+             *        without locking
+             */
+            ///@{
+            Counter& m_framesReceived;
+            Counter& m_framesIncomplete;
+            Counter& m_framesMissing;
+            Counter& m_framesWithoutMetadata;
+            Histogram& m_frameLatency;
+            Gauge& m_frameBuffers;
+            ///@}
+
+            /**
+             * \brief the cumulative counters at the start of the current
+             *        acquisition
+             */
+            Statistics m_statisticsBase {};
+
+            /**
+             * \brief the ID of the last frame received for detecting gaps
+             */
+            std::atomic<VmbUint64_t> m_lastFrameId { 0 };
+
+            /**
+             * \brief number of frames the receive time is remembered for; must
+             *        exceed the number of frames in flight
+             */
+            static constexpr size_t ReceiveTimeSlots = 64;
+
+            /**
+             * \brief receive time of a frame; m_frameId is written last and
+             *        checked before and after reading m_ticks
+             */
+            struct ReceiveTime
+            {
+                std::atomic<VmbUint64_t> m_frameId { ~VmbUint64_t(0) };
+                std::atomic<Clock::rep> m_ticks { 0 };
+            };
+
+            /**
+             * \brief receive times indexed by frame ID modulo ReceiveTimeSlots
+             */
+            std::array<ReceiveTime, ReceiveTimeSlots> m_receiveTimes;
+
+            /**
+             * \brief stop the current acquisition and reset the statistics
+             *        for a new one
+             */
+            void PrepareAcquisition() noexcept;
 
             class StreamLifetime;
 
@@ -114,6 +465,12 @@ namespace VmbC
                  */
                 VmbHandle_t m_cameraHandle {};
                 std::unique_ptr<StreamLifetime> m_streamLife;
+
+                /**
+                 * \brief set, if the chunk mode was activated for the
+                 *        acquisition
+                 */
+                bool m_chunkMode { false };
             };
 
             class AcquisitionLifetime;
@@ -138,6 +495,12 @@ namespace VmbC
             struct Frame
             {
                 Frame(size_t payloadSize, size_t bufferAlignment);
+
+                /**
+                 * \brief use a buffer owned by someone else, e.g. the shared
+                 *        memory export
+                 */
+                Frame(void* buffer, size_t payloadSize);
                 ~Frame();
             
             //这样可以防止通过复制或移动操作对图像帧进行意外的内存管理。
@@ -148,6 +511,13 @@ namespace VmbC
                 Frame& operator=(Frame&& other) = delete;
 
                 VmbFrame_t m_frame;
+                bool m_ownsBuffer { true };
+
+                /**
+                 * \brief the metadata of the frame currently in the buffer;
+                 *        referenced by the context of m_frame
+                 */
+                FrameMetadata m_metadata {};
             };
 
             /**
@@ -160,8 +530,16 @@ namespace VmbC
                 ~AcquisitionLifetime();
 
             private:
+                AcquisitionManager& m_acquisitionManager;
+
+                /**
+                 * \brief the region containing the frame buffers; null, if
+                 *        the frames are not exported
+                 */
+                std::unique_ptr<SharedFrameExport> m_sharedExport;
                 std::vector<std::unique_ptr<Frame>> m_frames;
                 VmbHandle_t m_camHandle;
+                TimeLapseTrigger& m_timeLapse;
             };
 
             /**
@@ -170,7 +548,18 @@ namespace VmbC
             std::unique_ptr<CameraAccessLifetime> m_openCamera;
 
             /**
-             * \brief Object used for transforming frames to QPixmaps 
+             * \brief the recording currently replayed; alternative to m_openCamera
+             */
+            std::unique_ptr<PlaybackCamera> m_playback;
+
+            /**
+             * \brief the frames of another process currently processed;
+             *        alternative to m_openCamera
+             */
+            std::unique_ptr<RemoteCamera> m_remote;
+
+            /**
+             * \brief Object used for transforming frames to a displayable format 
              */
             ImageTranscoder m_imageTranscoder;
 
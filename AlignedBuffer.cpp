@@ -0,0 +1,75 @@
+/**
+ * \date 2023
+ * \copyright Allied Vision Technologies.  All Rights Reserved.
+ *
+ * \copyright Redistribution of this file, in original or modified form, without
+ *            prior written consent of Allied Vision Technologies is prohibited.
+ *
+ * \warning THIS SOFTWARE IS PROVIDED BY THE AUTHOR "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF TITLE,
+ * NON-INFRINGEMENT, MERCHANTABILITY AND FITNESS FOR A PARTICULAR  PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \brief Implementation of ::VmbC::Examples::AlignedBuffer
+ */
+
+#include <cstdlib>
+#include <utility>
+
+#include "AlignedBuffer.h"
+#include "VmbException.h"
+
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+
+namespace VmbC
+{
+    namespace Examples
+    {
+        AlignedBuffer::AlignedBuffer(size_t const size, size_t const alignment)
+            : m_size(AlignUp(size, alignment))
+        /* 分配按 alignment 对齐的内存，大小向上取整为 alignment 的整数倍（aligned_alloc 的要求）。 */
+        {
+#ifdef _WIN32
+            m_data = static_cast<unsigned char*>(_aligned_malloc(m_size, alignment));
+#else
+            m_data = static_cast<unsigned char*>(aligned_alloc(alignment, m_size));
+#endif
+            if (m_data == nullptr)
+            {
+                throw VmbException("Unable to allocate aligned memory", VmbErrorResources);
+            }
+        }
+
+        AlignedBuffer::~AlignedBuffer()
+        {
+#ifdef _WIN32
+            _aligned_free(m_data);
+#else
+            free(m_data);
+#endif
+        }
+
+        AlignedBuffer::AlignedBuffer(AlignedBuffer&& other) noexcept
+            : m_data(other.m_data),
+            m_size(other.m_size)
+        {
+            other.m_data = nullptr;
+            other.m_size = 0;
+        }
+
+        AlignedBuffer& AlignedBuffer::operator=(AlignedBuffer&& other) noexcept
+        {
+            std::swap(m_data, other.m_data);
+            std::swap(m_size, other.m_size);
+            return *this;
+        }
+    }
+}
@@ -0,0 +1,85 @@
+/**
+ * \date 2023
+ * \copyright Allied Vision Technologies.  All Rights Reserved.
+ *
+ * \copyright Redistribution of this file, in original or modified form, without
+ *            prior written consent of Allied Vision Technologies is prohibited.
+ *
+ * \warning THIS SOFTWARE IS PROVIDED BY THE AUTHOR "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF TITLE,
+ * NON-INFRINGEMENT, MERCHANTABILITY AND FITNESS FOR A PARTICULAR  PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \brief Definition of a buffer with a given memory alignment
+ */
+
+#ifndef ASYNCHRONOUSGRAB_C_ALIGNED_BUFFER_H
+#define ASYNCHRONOUSGRAB_C_ALIGNED_BUFFER_H
+
+#include <cstddef>
+
+namespace VmbC
+{
+    namespace Examples
+    {
+        /**
+         * \brief Owner of a block of memory with a given alignment, e.g. for
+         *        unbuffered file io
+         */
+        class AlignedBuffer
+        {
+        public:
+            AlignedBuffer() noexcept = default;
+
+            /**
+             * \param[in] size the size in bytes; rounded up to a multiple of alignment
+             * \param[in] alignment a power of 2
+             * \throws VmbException, if the memory cannot be allocated
+             */
+            AlignedBuffer(size_t size, size_t alignment);
+
+            ~AlignedBuffer();
+
+            AlignedBuffer(AlignedBuffer const&) = delete;
+            AlignedBuffer& operator=(AlignedBuffer const&) = delete;
+
+            AlignedBuffer(AlignedBuffer&& other) noexcept;
+            AlignedBuffer& operator=(AlignedBuffer&& other) noexcept;
+
+            unsigned char* GetData() noexcept
+            {
+                return m_data;
+            }
+
+            unsigned char const* GetData() const noexcept
+            {
+                return m_data;
+            }
+
+            size_t GetSize() const noexcept
+            {
+                return m_size;
+            }
+
+            /**
+             * \brief round a value up to the next multiple of alignment
+             * \param[in] alignment a power of 2
+             */
+            static size_t AlignUp(size_t value, size_t alignment) noexcept
+            {
+                return (value + alignment - 1) & ~(alignment - 1);
+            }
+        private:
+            unsigned char* m_data { nullptr };
+            size_t m_size { 0 };
+        };
+    }
+}
+
+#endif
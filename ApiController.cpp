@@ -33,7 +33,7 @@ namespace VmbC
 
         enum { NUM_FRAMES = 3, };
 
-        ApiController::ApiController(MainWindow& mainWindow)
+        ApiController::ApiController()
         /* 一个控制器类，用于管理相机、系统和接口的列表，并提供版本信息查询功能。 */
             : m_libraryLife {}
         {
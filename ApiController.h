@@ -23,8 +23,6 @@
 #ifndef ASYNCHRONOUSGRAB_C_API_CONTROLLER_H
 #define ASYNCHRONOUSGRAB_C_API_CONTROLLER_H
 
-#include <QObject>
-
 #include <memory>
 #include <string>
 #include <vector>
@@ -35,8 +33,6 @@
 #include "ModuleData.h"
 #include "VmbLibraryLifetime.h"
 
-class MainWindow;
-
 namespace VmbC
 {
     namespace Examples
@@ -47,7 +43,7 @@ namespace VmbC
         class ApiController
         {
         public:
-            ApiController(MainWindow& mainWindow);
+            ApiController();
 
             /**
              * \brief Gets all cameras known to Vmb for a given interface
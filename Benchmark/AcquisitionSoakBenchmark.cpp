@@ -0,0 +1,225 @@
+/**
+ * \date 2023
+ * \copyright Allied Vision Technologies.  All Rights Reserved.
+ *
+ * \copyright Redistribution of this file, in original or modified form, without
+ *            prior written consent of Allied Vision Technologies is prohibited.
+ *
+ * \warning THIS SOFTWARE IS PROVIDED BY THE AUTHOR "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF TITLE,
+ * NON-INFRINGEMENT, MERCHANTABILITY AND FITNESS FOR A PARTICULAR  PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \brief Implementation of ::VmbC::Examples::AcquisitionSoakBenchmark
+ */
+
+#include <algorithm>
+#include <ostream>
+#include <thread>
+
+#include "AcquisitionSoakBenchmark.h"
+#include "ProcessStatistics.h"
+#include "VmbException.h"
+
+namespace VmbC
+{
+    namespace Examples
+    {
+        namespace
+        {
+            using Clock = AcquisitionManager::Clock;
+
+            double ToMilliseconds(Clock::duration duration)
+            {
+                return std::chrono::duration<double, std::milli>(duration).count();
+            }
+
+            /**
+             * \brief get the median of a member of the cycle results in the range [begin, end)
+             */
+            template<typename T, typename Iter>
+            T Median(Iter begin, Iter end, T AcquisitionSoakBenchmark::CycleResult::* member)
+            {
+                std::vector<T> values;
+                values.reserve(std::distance(begin, end));
+                for (auto pos = begin; pos != end; ++pos)
+                {
+                    values.push_back((*pos).*member);
+                }
+                if (values.empty())
+                {
+                    return T{};
+                }
+                auto const middle = values.begin() + values.size() / 2;
+                std::nth_element(values.begin(), middle, values.end());
+                return *middle;
+            }
+        }
+
+        AcquisitionSoakBenchmark::AcquisitionSoakBenchmark(VmbCameraInfo_t const& cameraInfo, Settings const& settings)
+            : m_cameraInfo(cameraInfo),
+            m_settings(settings),
+            m_acquisitionManager(*this)
+        {
+        }
+
+        void AcquisitionSoakBenchmark::ConvertedFrameReceived(Image const&, VmbFrame_t const&)
+        {
+        }
+
+        AcquisitionSoakBenchmark::CycleResult AcquisitionSoakBenchmark::RunCycle()
+        /* 
+        brief：执行一次开始/停止采集的循环
+        记录打开相机、开始采集、收到第一帧以及停止采集所需的时间和当前进程的内存占用。
+         */
+        {
+            CycleResult result {};
+
+            m_acquisitionManager.StartAcquisition(m_cameraInfo);
+            auto const& timings = m_acquisitionManager.GetStartupTimings();
+
+            result.m_openLatency = ToMilliseconds(timings.m_cameraOpened - timings.m_startRequested);
+            result.m_startLatency = ToMilliseconds(timings.m_acquisitionStarted - timings.m_cameraOpened);
+
+            // wait for the first frame
+            Clock::time_point const deadline = Clock::now() + m_settings.m_firstFrameTimeout;
+            Clock::time_point firstFrame;
+            while (!(result.m_frameReceived = m_acquisitionManager.GetFirstFrameTime(firstFrame))
+                   && Clock::now() < deadline)
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+
+            if (result.m_frameReceived)
+            {
+                result.m_firstFrameLatency = ToMilliseconds(firstFrame - timings.m_acquisitionStarted);
+            }
+
+            auto const stopBegin = Clock::now();
+            m_acquisitionManager.StopAcquisition();
+            result.m_stopLatency = ToMilliseconds(Clock::now() - stopBegin);
+
+            result.m_residentSetSize = GetResidentSetSize();
+            return result;
+        }
+
+        bool AcquisitionSoakBenchmark::Run(std::ostream& log, std::ostream* csv)
+        {
+            m_results.clear();
+            m_results.reserve(m_settings.m_cycles);
+
+            if (csv != nullptr)
+            {
+                *csv << "cycle;open_ms;start_ms;first_frame_ms;stop_ms;rss_bytes;frame_received\n";
+            }
+
+            size_t const progressInterval = (std::max)(m_settings.m_cycles / 20, size_t(1));
+
+            for (size_t cycle = 0; cycle != m_settings.m_cycles; ++cycle)
+            {
+                try
+                {
+                    m_results.push_back(RunCycle());
+                }
+                catch (VmbException const& ex)
+                {
+                    log << "cycle " << cycle << " failed: " << ex.what() << '\n';
+                    return false;
+                }
+
+                auto const& result = m_results.back();
+                if (csv != nullptr)
+                {
+                    *csv << cycle << ';'
+                        << result.m_openLatency << ';'
+                        << result.m_startLatency << ';'
+                        << result.m_firstFrameLatency << ';'
+                        << result.m_stopLatency << ';'
+                        << result.m_residentSetSize << ';'
+                        << (result.m_frameReceived ? 1 : 0) << '\n';
+                }
+
+                if ((cycle + 1) % progressInterval == 0)
+                {
+                    log << "cycle " << (cycle + 1) << '/' << m_settings.m_cycles
+                        << ": first frame " << result.m_firstFrameLatency << " ms, rss "
+                        << (result.m_residentSetSize / 1024) << " KiB" << std::endl;
+                }
+            }
+
+            return Evaluate(log);
+        }
+
+        bool AcquisitionSoakBenchmark::Evaluate(std::ostream& log) const
+        /* 
+        brief：比较运行开始（预热之后）和结束时的中位数
+        延迟的增长超过比例阈值（并且超过容差），或者内存增长超过阈值时，基准测试失败。
+         */
+        {
+            bool passed = true;
+
+            auto const missingFrames = std::count_if(m_results.begin(), m_results.end(),
+                                                     [](CycleResult const& result) { return !result.m_frameReceived; });
+            if (missingFrames != 0)
+            {
+                log << "FAIL: no frame received within the timeout in " << missingFrames << " cycles\n";
+                passed = false;
+            }
+
+            if (m_results.size() <= m_settings.m_warmupCycles + 1)
+            {
+                log << "not enough cycles for comparing the start and the end of the run\n";
+                return passed;
+            }
+
+            size_t const measured = m_results.size() - m_settings.m_warmupCycles;
+            size_t const window = (std::max)((std::min)(m_settings.m_windowSize, measured / 2), size_t(1));
+
+            auto const firstBegin = m_results.begin() + m_settings.m_warmupCycles;
+            auto const firstEnd = firstBegin + window;
+            auto const lastBegin = m_results.end() - window;
+            auto const lastEnd = m_results.end();
+
+            struct LatencyMetric
+            {
+                char const* m_name;
+                double CycleResult::* m_member;
+            };
+
+            LatencyMetric const metrics[] =
+            {
+                { "open", &CycleResult::m_openLatency },
+                { "start", &CycleResult::m_startLatency },
+                { "first frame", &CycleResult::m_firstFrameLatency },
+                { "stop", &CycleResult::m_stopLatency },
+            };
+
+            for (auto const& metric : metrics)
+            {
+                double const begin = Median(firstBegin, firstEnd, metric.m_member);
+                double const end = Median(lastBegin, lastEnd, metric.m_member);
+                bool const exceeded = (end - begin > m_settings.m_latencyToleranceMs)
+                    && (end > begin * m_settings.m_maxLatencyGrowth);
+
+                log << (exceeded ? "FAIL: " : "ok:   ") << metric.m_name << " latency median "
+                    << begin << " ms -> " << end << " ms\n";
+                passed = passed && !exceeded;
+            }
+
+            size_t const rssBegin = Median(firstBegin, firstEnd, &CycleResult::m_residentSetSize);
+            size_t const rssEnd = Median(lastBegin, lastEnd, &CycleResult::m_residentSetSize);
+            bool const memoryExceeded = (rssEnd > rssBegin) && (rssEnd - rssBegin > m_settings.m_maxMemoryGrowth);
+
+            log << (memoryExceeded ? "FAIL: " : "ok:   ") << "resident set size median "
+                << (rssBegin / 1024) << " KiB -> " << (rssEnd / 1024) << " KiB\n";
+
+            return passed && !memoryExceeded;
+        }
+    }
+}
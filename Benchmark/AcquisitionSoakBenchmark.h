@@ -0,0 +1,140 @@
+/**
+ * \date 2023
+ * \copyright Allied Vision Technologies.  All Rights Reserved.
+ *
+ * \copyright Redistribution of this file, in original or modified form, without
+ *            prior written consent of Allied Vision Technologies is prohibited.
+ *
+ * \warning THIS SOFTWARE IS PROVIDED BY THE AUTHOR "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF TITLE,
+ * NON-INFRINGEMENT, MERCHANTABILITY AND FITNESS FOR A PARTICULAR  PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \brief Definition of a benchmark starting and stopping the acquisition
+ *        of a camera in a loop
+ */
+
+#ifndef ASYNCHRONOUSGRAB_C_ACQUISITION_SOAK_BENCHMARK_H
+#define ASYNCHRONOUSGRAB_C_ACQUISITION_SOAK_BENCHMARK_H
+
+#include <chrono>
+#include <iosfwd>
+#include <vector>
+
+#include <VmbC/VmbC.h>
+
+#include "AcquisitionManager.h"
+
+namespace VmbC
+{
+    namespace Examples
+    {
+        /**
+         * \brief Repeatedly starts and stops the acquisition of a camera and
+         *        checks, if the latencies or the memory usage of the process
+         *        grow over time.
+         *
+         * Meant to be run against a simulated camera, since thousands of
+         * cycles are required to detect a slow growth.
+         */
+        class AcquisitionSoakBenchmark : private ConvertedFrameSink
+        {
+        public:
+            struct Settings
+            {
+                /**
+                 * \brief the number of start/stop cycles to execute 
+                 */
+                size_t m_cycles { 2000 };
+
+                /**
+                 * \brief the number of cycles executed before the reference
+                 *        values are taken
+                 */
+                size_t m_warmupCycles { 20 };
+
+                /**
+                 * \brief the number of cycles at the start and the end of the
+                 *        run the medians are compared for
+                 */
+                size_t m_windowSize { 100 };
+
+                /**
+                 * \brief the time to wait for the first frame of a cycle
+                 */
+                std::chrono::milliseconds m_firstFrameTimeout { 5000 };
+
+                /**
+                 * \brief the maximum allowed ratio of the median latency at the
+                 *        end of the run and the median at the start of the run
+                 */
+                double m_maxLatencyGrowth { 1.5 };
+
+                /**
+                 * \brief latency increases below this value are never
+                 *        reported to avoid failures caused by noise
+                 */
+                double m_latencyToleranceMs { 2.0 };
+
+                /**
+                 * \brief the maximum allowed growth of the resident set size in bytes
+                 */
+                size_t m_maxMemoryGrowth { 16 * 1024 * 1024 };
+            };
+
+            /**
+             * \brief the measurements of a single start/stop cycle; latencies
+             *        are in milliseconds
+             */
+            struct CycleResult
+            {
+                double m_openLatency;
+                double m_startLatency;
+                double m_firstFrameLatency;
+                double m_stopLatency;
+                size_t m_residentSetSize;
+                bool m_frameReceived;
+            };
+
+            AcquisitionSoakBenchmark(VmbCameraInfo_t const& cameraInfo, Settings const& settings);
+
+            /**
+             * \brief execute the benchmark
+             * \param[in] log the stream to write progress info and the summary to
+             * \param[in] csv if not null, the results of every cycle are written to this stream
+             * \return true, if no threshold was exceeded
+             */
+            bool Run(std::ostream& log, std::ostream* csv);
+
+            std::vector<CycleResult> const& GetResults() const noexcept
+            {
+                return m_results;
+            }
+        private:
+            VmbCameraInfo_t const& m_cameraInfo;
+            Settings m_settings;
+            AcquisitionManager m_acquisitionManager;
+            std::vector<CycleResult> m_results;
+
+            /**
+             * \brief converted frames are not of interest for this benchmark 
+             */
+            void ConvertedFrameReceived(Image const& image, VmbFrame_t const& frame) override;
+
+            CycleResult RunCycle();
+
+            /**
+             * \brief compare the values at the start and the end of the run
+             */
+            bool Evaluate(std::ostream& log) const;
+        };
+    }
+}
+
+#endif
@@ -0,0 +1,576 @@
+/**
+ * \date 2023
+ * \copyright Allied Vision Technologies.  All Rights Reserved.
+ *
+ * \copyright Redistribution of this file, in original or modified form, without
+ *            prior written consent of Allied Vision Technologies is prohibited.
+ *
+ * \warning THIS SOFTWARE IS PROVIDED BY THE AUTHOR "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF TITLE,
+ * NON-INFRINGEMENT, MERCHANTABILITY AND FITNESS FOR A PARTICULAR  PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \brief Entry point of the benchmarks for the AsynchronousGrab example
+ */
+
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+
+#include <VmbC/VmbC.h>
+
+#include "AcquisitionSoakBenchmark.h"
+#include "CompressionBenchmark.h"
+#include "FanOutBenchmark.h"
+#include "FrameSyncBenchmark.h"
+#include "MetricsEndpointBenchmark.h"
+#include "SharedMemoryBenchmark.h"
+#include "SinkGraphBenchmark.h"
+#include "StorageBenchmark.h"
+#include "TracingOverheadBenchmark.h"
+#include "VmbException.h"
+#include "VmbLibraryLifetime.h"
+#include "WorkQueueBenchmark.h"
+
+using VmbC::Examples::AcquisitionSoakBenchmark;
+using VmbC::Examples::CompressionBenchmark;
+using VmbC::Examples::FanOutBenchmark;
+using VmbC::Examples::FrameSyncBenchmark;
+using VmbC::Examples::MetricsEndpointBenchmark;
+using VmbC::Examples::SharedMemoryBenchmark;
+using VmbC::Examples::SinkGraphBenchmark;
+using VmbC::Examples::StorageBenchmark;
+using VmbC::Examples::TracingOverheadBenchmark;
+using VmbC::Examples::VmbException;
+using VmbC::Examples::VmbLibraryLifetime;
+using VmbC::Examples::WorkQueueBenchmark;
+
+namespace
+{
+    void PrintUsage()
+    {
+        std::cout
+            << "Usage: AsynchronousGrabBenchmark <benchmark> [options]\n"
+            << "\n"
+            << "Benchmarks:\n"
+            << "  soak <cameraId>             start and stop the acquisition of a camera in a loop;\n"
+            << "                              use the id of a simulated camera\n"
+            << "    --cycles <n>              number of start/stop cycles (default 2000)\n"
+            << "    --warmup <n>              cycles ignored for the reference values (default 20)\n"
+            << "    --window <n>              cycles compared at start and end of the run (default 100)\n"
+            << "    --frame-timeout <ms>      time to wait for the first frame of a cycle (default 5000)\n"
+            << "    --max-latency-growth <x>  maximum ratio of end/start median latencies (default 1.5)\n"
+            << "    --max-rss-growth <MiB>    maximum growth of the resident set size (default 16)\n"
+            << "    --csv <file>              write the results of every cycle to a file\n"
+            << "  trace-overhead              measure the overhead of the pipeline tracing\n"
+            << "    --iterations <n>          number of events recorded (default 10000000)\n"
+            << "    --events-per-frame <n>    trace events recorded per frame (default 8)\n"
+            << "    --fps <x>                 frame rate the overhead is calculated for (default 1000)\n"
+            << "    --max-overhead <percent>  maximum overhead relative to the frame period (default 1)\n"
+            << "  metrics <cameraId>          acquire images while scraping the Prometheus metrics endpoint\n"
+            << "    --port <port>             port of the endpoint on 127.0.0.1 (default 9464)\n"
+            << "    --duration <s>            duration of the acquisition (default 10)\n"
+            << "    --interval <ms>           time between two scrapes (default 1000)\n"
+            << "  compression                 measure the lossless compression of recorded frames\n"
+            << "    --input <file>            take the frames from a recording instead of generating them\n"
+            << "    --frames <n>              frames per generated format or frames read (default 8)\n"
+            << "    --width <n>               width of the generated frames (default 2048)\n"
+            << "    --height <n>              height of the generated frames (default 1536)\n"
+            << "    --noise <x>               noise of the generated frames in 8 bit LSB (default 1.5)\n"
+            << "    --threads <n>             threads compressing in parallel (default 4)\n"
+            << "  storage <directory>         measure the recording bandwidth of the disk of a directory\n"
+            << "    --frame-size <KiB>        size of the synthetic frames (default 6144)\n"
+            << "    --duration <s>            duration of the measurement (default 20)\n"
+            << "    --warmup <s>              time ignored at the start (default 2)\n"
+            << "    --margin <percent>        throughput kept in reserve for the camera limits (default 20)\n"
+            << "    --ring <MiB>              size of the staging ring (default 256)\n"
+            << "    --queue-depth <n>         maximum number of writes in flight (default 4)\n"
+            << "    --max-write <MiB>         maximum size of a single write (default 8)\n"
+            << "    --keep                    keep the test file\n"
+            << "  shared-memory [name]        read the frames exported by a running acquisition\n"
+            << "                              (default /AsynchronousGrabFrames)\n"
+            << "    --duration <s>            duration of the measurement (default 10)\n"
+            << "    --hold <ms>               time each frame is held before releasing it (default 0)\n"
+            << "  fan-out                     send synthetic frames to subscribers over the loopback interface\n"
+            << "    --subscribers <n>         subscribers reading every frame (default 4)\n"
+            << "    --frame-size <KiB>        size of the frames (default 2048)\n"
+            << "    --fps <x>                 frame rate (default 100)\n"
+            << "    --duration <s>            duration of the measurement (default 10)\n"
+            << "    --slow-delay <ms>         time the slow subscriber takes per frame (default 50)\n"
+            << "    --max-drop <percent>      maximum frames lost by the other subscribers (default 1)\n"
+            << "    --no-zerocopy             send without MSG_ZEROCOPY\n"
+            << "  work-queue                  distribute synthetic frames to 1..n workers over the loopback interface\n"
+            << "    --workers <n>             maximum number of workers (default 4)\n"
+            << "    --processing-time <ms>    time a worker takes per frame (default 20)\n"
+            << "    --credits <n>             frames a worker accepts at a time (default 2)\n"
+            << "    --frame-size <KiB>        size of the frames (default 256)\n"
+            << "    --duration <s>            duration of the measurement per number of workers (default 3)\n"
+            << "    --min-scaling <percent>   minimum fraction of linear scaling (default 80)\n"
+            << "  frame-sync                  match the frames of simulated cameras by timestamp\n"
+            << "    --cameras <n>             number of cameras (default 3)\n"
+            << "    --fps <x>                 frame rate (default 50)\n"
+            << "    --duration <s>            duration of the measurement (default 10)\n"
+            << "    --jitter <us>             maximum random transfer latency (default 2000)\n"
+            << "    --drift <ppm>             maximum deviation of the camera clocks (default 20)\n"
+            << "    --loss <percent>          frames lost by each camera (default 1)\n"
+            << "    --counter                 match the frame IDs instead of the timestamps\n"
+            << "  sink-graph                  pass synthetic frames to a recording, an analysis and a preview sink\n"
+            << "    --fps <x>                 frame rate (default 100)\n"
+            << "    --frame-size <KiB>        size of the frames (default 4096)\n"
+            << "    --duration <s>            duration of the measurement (default 10)\n"
+            << "    --recording-time <ms>     time the recording takes per frame (default 2)\n"
+            << "    --analysis-time <ms>      time the analysis takes per frame (default 15)\n"
+            << "    --preview-time <ms>       time the preview takes per frame (default 50)\n"
+            << "    --budget <MiB>            memory of the frame copies (default 64)\n";
+    }
+
+    /**
+     * \brief simple parser for the "--name value" options and "--name"
+     *        flags following the positional arguments
+     */
+    class Options
+    {
+    public:
+        Options(int argc, char* argv[], int first)
+            : m_argc(argc), m_argv(argv), m_first(first)
+        {
+        }
+
+        char const* Get(char const* name) const
+        {
+            for (int i = m_first; i + 1 < m_argc; ++i)
+            {
+                if (std::strcmp(m_argv[i], name) == 0)
+                {
+                    return m_argv[i + 1];
+                }
+            }
+            return nullptr;
+        }
+
+        bool Has(char const* name) const
+        {
+            for (int i = m_first; i < m_argc; ++i)
+            {
+                if (std::strcmp(m_argv[i], name) == 0)
+                {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        template<typename T>
+        void Get(char const* name, T& value) const
+        {
+            auto const str = Get(name);
+            if (str != nullptr)
+            {
+                value = static_cast<T>(std::strtod(str, nullptr));
+            }
+        }
+    private:
+        int m_argc;
+        char** m_argv;
+        int m_first;
+    };
+
+    /**
+     * \brief query the info of the camera with a given id
+     */
+    VmbCameraInfo_t QueryCameraInfo(char const* cameraId)
+    {
+        VmbCameraInfo_t cameraInfo;
+        VmbError_t const error = VmbCameraInfoQuery(cameraId, &cameraInfo, sizeof(cameraInfo));
+        if (error != VmbErrorSuccess)
+        {
+            throw VmbException::ForOperation(error, "VmbCameraInfoQuery");
+        }
+        return cameraInfo;
+    }
+
+    int RunSoakBenchmark(int argc, char* argv[])
+    {
+        if (argc < 3)
+        {
+            PrintUsage();
+            return EXIT_FAILURE;
+        }
+
+        Options const options(argc, argv, 3);
+
+        AcquisitionSoakBenchmark::Settings settings;
+        options.Get("--cycles", settings.m_cycles);
+        options.Get("--warmup", settings.m_warmupCycles);
+        options.Get("--window", settings.m_windowSize);
+        options.Get("--max-latency-growth", settings.m_maxLatencyGrowth);
+
+        double timeoutMs = static_cast<double>(settings.m_firstFrameTimeout.count());
+        options.Get("--frame-timeout", timeoutMs);
+        settings.m_firstFrameTimeout = std::chrono::milliseconds(static_cast<long long>(timeoutMs));
+
+        double maxRssGrowthMiB = static_cast<double>(settings.m_maxMemoryGrowth) / (1024 * 1024);
+        options.Get("--max-rss-growth", maxRssGrowthMiB);
+        settings.m_maxMemoryGrowth = static_cast<size_t>(maxRssGrowthMiB * 1024 * 1024);
+
+        std::unique_ptr<std::ofstream> csv;
+        if (auto const csvPath = options.Get("--csv"))
+        {
+            csv.reset(new std::ofstream(csvPath));
+        }
+
+        VmbLibraryLifetime libraryLife;
+
+        VmbCameraInfo_t const cameraInfo = QueryCameraInfo(argv[2]);
+
+        AcquisitionSoakBenchmark benchmark(cameraInfo, settings);
+        bool const passed = benchmark.Run(std::cout, csv.get());
+
+        std::cout << (passed ? "PASSED" : "FAILED") << std::endl;
+        return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    int RunMetricsEndpointBenchmark(int argc, char* argv[])
+    {
+        if (argc < 3)
+        {
+            PrintUsage();
+            return EXIT_FAILURE;
+        }
+
+        Options const options(argc, argv, 3);
+
+        MetricsEndpointBenchmark::Settings settings;
+        options.Get("--port", settings.m_port);
+
+        double durationSeconds = std::chrono::duration<double>(settings.m_duration).count();
+        options.Get("--duration", durationSeconds);
+        settings.m_duration = std::chrono::milliseconds(static_cast<long long>(durationSeconds * 1000));
+
+        double intervalMs = static_cast<double>(settings.m_scrapeInterval.count());
+        options.Get("--interval", intervalMs);
+        settings.m_scrapeInterval = std::chrono::milliseconds(static_cast<long long>(intervalMs));
+
+        VmbLibraryLifetime libraryLife;
+        VmbCameraInfo_t const cameraInfo = QueryCameraInfo(argv[2]);
+
+        MetricsEndpointBenchmark benchmark(cameraInfo, settings);
+        bool const passed = benchmark.Run(std::cout);
+
+        std::cout << (passed ? "PASSED" : "FAILED") << std::endl;
+        return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    int RunCompressionBenchmark(int argc, char* argv[])
+    {
+        Options const options(argc, argv, 2);
+
+        CompressionBenchmark::Settings settings;
+        if (auto const input = options.Get("--input"))
+        {
+            settings.m_fileName = input;
+        }
+        options.Get("--frames", settings.m_frames);
+        options.Get("--width", settings.m_width);
+        options.Get("--height", settings.m_height);
+        options.Get("--noise", settings.m_noise);
+        options.Get("--threads", settings.m_threads);
+
+        CompressionBenchmark benchmark(settings);
+        bool const passed = benchmark.Run(std::cout);
+
+        std::cout << (passed ? "PASSED" : "FAILED") << std::endl;
+        return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    int RunStorageBenchmark(int argc, char* argv[])
+    {
+        if (argc < 3)
+        {
+            PrintUsage();
+            return EXIT_FAILURE;
+        }
+
+        Options const options(argc, argv, 3);
+
+        StorageBenchmark::Settings settings;
+        settings.m_directory = argv[2];
+
+        double frameSizeKiB = static_cast<double>(settings.m_frameSize) / 1024;
+        options.Get("--frame-size", frameSizeKiB);
+        settings.m_frameSize = static_cast<size_t>(frameSizeKiB * 1024);
+
+        double durationSeconds = std::chrono::duration<double>(settings.m_duration).count();
+        options.Get("--duration", durationSeconds);
+        settings.m_duration = std::chrono::milliseconds(static_cast<long long>(durationSeconds * 1000));
+
+        double warmupSeconds = std::chrono::duration<double>(settings.m_warmup).count();
+        options.Get("--warmup", warmupSeconds);
+        settings.m_warmup = std::chrono::milliseconds(static_cast<long long>(warmupSeconds * 1000));
+
+        double marginPercent = settings.m_margin * 100;
+        options.Get("--margin", marginPercent);
+        settings.m_margin = marginPercent / 100;
+
+        double ringMiB = static_cast<double>(settings.m_recording.m_ringSize >> 20);
+        options.Get("--ring", ringMiB);
+        settings.m_recording.m_ringSize = static_cast<size_t>(ringMiB * 1024 * 1024);
+
+        double maxWriteMiB = static_cast<double>(settings.m_recording.m_maxWriteSize >> 20);
+        options.Get("--max-write", maxWriteMiB);
+        settings.m_recording.m_maxWriteSize = static_cast<size_t>(maxWriteMiB * 1024 * 1024);
+
+        options.Get("--queue-depth", settings.m_recording.m_queueDepth);
+        settings.m_keepFile = options.Has("--keep");
+
+        StorageBenchmark benchmark(settings);
+        bool const passed = benchmark.Run(std::cout);
+
+        std::cout << (passed ? "PASSED" : "FAILED") << std::endl;
+        return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    int RunSharedMemoryBenchmark(int argc, char* argv[])
+    {
+        bool const hasName = argc >= 3 && std::strncmp(argv[2], "--", 2) != 0;
+        Options const options(argc, argv, hasName ? 3 : 2);
+
+        SharedMemoryBenchmark::Settings settings;
+        if (hasName)
+        {
+            settings.m_name = argv[2];
+        }
+
+        double durationSeconds = std::chrono::duration<double>(settings.m_duration).count();
+        options.Get("--duration", durationSeconds);
+        settings.m_duration = std::chrono::milliseconds(static_cast<long long>(durationSeconds * 1000));
+
+        double holdMs = static_cast<double>(settings.m_holdTime.count());
+        options.Get("--hold", holdMs);
+        settings.m_holdTime = std::chrono::milliseconds(static_cast<long long>(holdMs));
+
+        SharedMemoryBenchmark benchmark(settings);
+        bool const passed = benchmark.Run(std::cout);
+
+        std::cout << (passed ? "PASSED" : "FAILED") << std::endl;
+        return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    int RunFanOutBenchmark(int argc, char* argv[])
+    {
+        Options const options(argc, argv, 2);
+
+        FanOutBenchmark::Settings settings;
+        options.Get("--subscribers", settings.m_fastSubscribers);
+        options.Get("--fps", settings.m_frameRate);
+
+        double frameSizeKiB = static_cast<double>(settings.m_frameSize) / 1024;
+        options.Get("--frame-size", frameSizeKiB);
+        settings.m_frameSize = static_cast<size_t>(frameSizeKiB * 1024);
+
+        double durationSeconds = std::chrono::duration<double>(settings.m_duration).count();
+        options.Get("--duration", durationSeconds);
+        settings.m_duration = std::chrono::milliseconds(static_cast<long long>(durationSeconds * 1000));
+
+        double slowDelayMs = static_cast<double>(settings.m_slowDelay.count());
+        options.Get("--slow-delay", slowDelayMs);
+        settings.m_slowDelay = std::chrono::milliseconds(static_cast<long long>(slowDelayMs));
+
+        double maxDropPercent = settings.m_maxDropRate * 100;
+        options.Get("--max-drop", maxDropPercent);
+        settings.m_maxDropRate = maxDropPercent / 100;
+
+        settings.m_zeroCopy = !options.Has("--no-zerocopy");
+
+        FanOutBenchmark benchmark(settings);
+        bool const passed = benchmark.Run(std::cout);
+
+        std::cout << (passed ? "PASSED" : "FAILED") << std::endl;
+        return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    int RunWorkQueueBenchmark(int argc, char* argv[])
+    {
+        Options const options(argc, argv, 2);
+
+        WorkQueueBenchmark::Settings settings;
+        options.Get("--workers", settings.m_maxWorkers);
+        options.Get("--credits", settings.m_credits);
+
+        double processingTimeMs = static_cast<double>(settings.m_processingTime.count());
+        options.Get("--processing-time", processingTimeMs);
+        settings.m_processingTime = std::chrono::milliseconds(static_cast<long long>(processingTimeMs));
+
+        double frameSizeKiB = static_cast<double>(settings.m_frameSize) / 1024;
+        options.Get("--frame-size", frameSizeKiB);
+        settings.m_frameSize = static_cast<size_t>(frameSizeKiB * 1024);
+
+        double durationSeconds = std::chrono::duration<double>(settings.m_duration).count();
+        options.Get("--duration", durationSeconds);
+        settings.m_duration = std::chrono::milliseconds(static_cast<long long>(durationSeconds * 1000));
+
+        double minEfficiencyPercent = settings.m_minEfficiency * 100;
+        options.Get("--min-scaling", minEfficiencyPercent);
+        settings.m_minEfficiency = minEfficiencyPercent / 100;
+
+        WorkQueueBenchmark benchmark(settings);
+        bool const passed = benchmark.Run(std::cout);
+
+        std::cout << (passed ? "PASSED" : "FAILED") << std::endl;
+        return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    int RunFrameSyncBenchmark(int argc, char* argv[])
+    {
+        Options const options(argc, argv, 2);
+
+        FrameSyncBenchmark::Settings settings;
+        options.Get("--cameras", settings.m_cameras);
+        options.Get("--fps", settings.m_frameRate);
+        options.Get("--drift", settings.m_drift);
+        settings.m_counter = options.Has("--counter");
+
+        double durationSeconds = std::chrono::duration<double>(settings.m_duration).count();
+        options.Get("--duration", durationSeconds);
+        settings.m_duration = std::chrono::milliseconds(static_cast<long long>(durationSeconds * 1000));
+
+        double jitterUs = static_cast<double>(settings.m_jitter.count());
+        options.Get("--jitter", jitterUs);
+        settings.m_jitter = std::chrono::microseconds(static_cast<long long>(jitterUs));
+
+        double lossPercent = settings.m_loss * 100;
+        options.Get("--loss", lossPercent);
+        settings.m_loss = lossPercent / 100;
+
+        FrameSyncBenchmark benchmark(settings);
+        bool const passed = benchmark.Run(std::cout);
+
+        std::cout << (passed ? "PASSED" : "FAILED") << std::endl;
+        return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    int RunSinkGraphBenchmark(int argc, char* argv[])
+    {
+        Options const options(argc, argv, 2);
+
+        SinkGraphBenchmark::Settings settings;
+        options.Get("--fps", settings.m_frameRate);
+
+        double frameSizeKiB = static_cast<double>(settings.m_frameSize) / 1024;
+        options.Get("--frame-size", frameSizeKiB);
+        settings.m_frameSize = static_cast<size_t>(frameSizeKiB * 1024);
+
+        double durationSeconds = std::chrono::duration<double>(settings.m_duration).count();
+        options.Get("--duration", durationSeconds);
+        settings.m_duration = std::chrono::milliseconds(static_cast<long long>(durationSeconds * 1000));
+
+        double recordingMs = static_cast<double>(settings.m_recordingTime.count());
+        options.Get("--recording-time", recordingMs);
+        settings.m_recordingTime = std::chrono::milliseconds(static_cast<long long>(recordingMs));
+
+        double analysisMs = static_cast<double>(settings.m_analysisTime.count());
+        options.Get("--analysis-time", analysisMs);
+        settings.m_analysisTime = std::chrono::milliseconds(static_cast<long long>(analysisMs));
+
+        double previewMs = static_cast<double>(settings.m_previewTime.count());
+        options.Get("--preview-time", previewMs);
+        settings.m_previewTime = std::chrono::milliseconds(static_cast<long long>(previewMs));
+
+        double budgetMiB = static_cast<double>(settings.m_memoryBudget) / (1024 * 1024);
+        options.Get("--budget", budgetMiB);
+        settings.m_memoryBudget = static_cast<size_t>(budgetMiB * 1024 * 1024);
+
+        SinkGraphBenchmark benchmark(settings);
+        bool const passed = benchmark.Run(std::cout);
+
+        std::cout << (passed ? "PASSED" : "FAILED") << std::endl;
+        return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    int RunTracingOverheadBenchmark(int argc, char* argv[])
+    {
+        Options const options(argc, argv, 2);
+
+        TracingOverheadBenchmark::Settings settings;
+        options.Get("--iterations", settings.m_iterations);
+        options.Get("--events-per-frame", settings.m_eventsPerFrame);
+        options.Get("--fps", settings.m_framesPerSecond);
+        options.Get("--max-overhead", settings.m_maxOverheadPercent);
+
+        TracingOverheadBenchmark benchmark(settings);
+        bool const passed = benchmark.Run(std::cout);
+
+        std::cout << (passed ? "PASSED" : "FAILED") << std::endl;
+        return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc < 2)
+    {
+        PrintUsage();
+        return EXIT_FAILURE;
+    }
+
+    try
+    {
+        if (std::strcmp(argv[1], "soak") == 0)
+        {
+            return RunSoakBenchmark(argc, argv);
+        }
+        if (std::strcmp(argv[1], "trace-overhead") == 0)
+        {
+            return RunTracingOverheadBenchmark(argc, argv);
+        }
+        if (std::strcmp(argv[1], "metrics") == 0)
+        {
+            return RunMetricsEndpointBenchmark(argc, argv);
+        }
+        if (std::strcmp(argv[1], "compression") == 0)
+        {
+            return RunCompressionBenchmark(argc, argv);
+        }
+        if (std::strcmp(argv[1], "storage") == 0)
+        {
+            return RunStorageBenchmark(argc, argv);
+        }
+        if (std::strcmp(argv[1], "shared-memory") == 0)
+        {
+            return RunSharedMemoryBenchmark(argc, argv);
+        }
+        if (std::strcmp(argv[1], "fan-out") == 0)
+        {
+            return RunFanOutBenchmark(argc, argv);
+        }
+        if (std::strcmp(argv[1], "work-queue") == 0)
+        {
+            return RunWorkQueueBenchmark(argc, argv);
+        }
+        if (std::strcmp(argv[1], "frame-sync") == 0)
+        {
+            return RunFrameSyncBenchmark(argc, argv);
+        }
+        if (std::strcmp(argv[1], "sink-graph") == 0)
+        {
+            return RunSinkGraphBenchmark(argc, argv);
+        }
+    }
+    catch (VmbException const& ex)
+    {
+        std::cerr << ex.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    PrintUsage();
+    return EXIT_FAILURE;
+}
@@ -0,0 +1,278 @@
+/**
+ * \date 2023
+ * \copyright Allied Vision Technologies.  All Rights Reserved.
+ *
+ * \copyright Redistribution of this file, in original or modified form, without
+ *            prior written consent of Allied Vision Technologies is prohibited.
+ *
+ * \warning THIS SOFTWARE IS PROVIDED BY THE AUTHOR "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF TITLE,
+ * NON-INFRINGEMENT, MERCHANTABILITY AND FITNESS FOR A PARTICULAR  PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \brief Implementation of ::VmbC::Examples::CompressionBenchmark
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iomanip>
+#include <ostream>
+#include <random>
+#include <thread>
+
+#include "CompressionBenchmark.h"
+#include "LosslessCodec.h"
+#include "RecordingReader.h"
+#include "VmbException.h"
+
+namespace VmbC
+{
+    namespace Examples
+    {
+        namespace
+        {
+            using Clock = std::chrono::steady_clock;
+
+            struct GeneratedFormat
+            {
+                VmbPixelFormat_t m_pixelFormat;
+                unsigned m_channels;
+                unsigned m_bits;
+                bool m_bayer;
+                bool m_packed;
+            };
+
+            constexpr GeneratedFormat GeneratedFormats[] =
+            {
+                { VmbPixelFormatMono8, 1, 8, false, false },
+                { VmbPixelFormatMono12, 1, 12, false, false },
+                { VmbPixelFormatMono12p, 1, 12, false, true },
+                { VmbPixelFormatBayerRG8, 1, 8, true, false },
+                { VmbPixelFormatBayerRG12, 1, 12, true, false },
+                { VmbPixelFormatRgb8, 3, 8, false, false },
+            };
+
+            double MegabytesPerSecond(VmbUint64_t const bytes, Clock::duration const duration) noexcept
+            {
+                double const seconds = std::chrono::duration<double>(duration).count();
+                return (seconds > 0) ? static_cast<double>(bytes) / (1024.0 * 1024.0) / seconds : 0.0;
+            }
+        }
+
+        CompressionBenchmark::CompressionBenchmark(Settings const& settings)
+            : m_settings(settings)
+        {
+        }
+
+        void CompressionBenchmark::GenerateFrames()
+        /* 生成平滑的图案（正弦和水平渐变）加上高斯噪声，模拟传感器数据；Bayer格式的四个像素和RGB的三个通道使用不同的增益。
+        12位打包格式按PFNC布局把两个样本写入三个字节。 */
+        {
+            std::mt19937 random(1);
+            std::normal_distribution<double> noise(0.0, m_settings.m_noise / 255.0);
+            VmbUint32_t const width = m_settings.m_width & ~VmbUint32_t(1);
+            VmbUint32_t const height = m_settings.m_height;
+            double const gains[] = { 0.6, 1.0, 0.8 };
+
+            for (auto const& format : GeneratedFormats)
+            {
+                std::vector<Frame> frames(m_settings.m_frames);
+                size_t const samples = size_t(width) * format.m_channels;
+                size_t const rowSize = format.m_packed ? samples / 2 * 3 : samples * (format.m_bits > 8 ? 2 : 1);
+                double const maxValue = static_cast<double>((1u << format.m_bits) - 1);
+                std::vector<VmbUint16_t> row(samples);
+
+                for (size_t index = 0; index != frames.size(); ++index)
+                {
+                    auto& frame = frames[index];
+                    frame.m_buffer.resize(rowSize * height);
+                    for (VmbUint32_t y = 0; y != height; ++y)
+                    {
+                        for (size_t i = 0; i != samples; ++i)
+                        {
+                            size_t const x = i / format.m_channels;
+                            size_t const colour = format.m_bayer ? (x & 1) + (y & 1) : i % format.m_channels;
+                            double value = 0.5 + 0.3 * std::sin(0.013 * x + 0.1 * index) * std::cos(0.011 * y) + 0.15 * x / width;
+                            value = value * gains[colour] + noise(random);
+                            row[i] = static_cast<VmbUint16_t>((std::min)((std::max)(value, 0.0), 1.0) * maxValue + 0.5);
+                        }
+
+                        unsigned char* const target = frame.m_buffer.data() + y * rowSize;
+                        for (size_t i = 0; i != samples; ++i)
+                        {
+                            if (format.m_packed)
+                            {
+                                if (i % 2 == 1)
+                                {
+                                    unsigned char* const pair = target + i / 2 * 3;
+                                    pair[0] = static_cast<unsigned char>(row[i - 1]);
+                                    pair[1] = static_cast<unsigned char>((row[i - 1] >> 8) | ((row[i] & 0x0F) << 4));
+                                    pair[2] = static_cast<unsigned char>(row[i] >> 4);
+                                }
+                            }
+                            else if (format.m_bits > 8)
+                            {
+                                target[2 * i] = static_cast<unsigned char>(row[i]);
+                                target[2 * i + 1] = static_cast<unsigned char>(row[i] >> 8);
+                            }
+                            else
+                            {
+                                target[i] = static_cast<unsigned char>(row[i]);
+                            }
+                        }
+                    }
+
+                    std::memset(&frame.m_frame, 0, sizeof(frame.m_frame));
+                    frame.m_frame.buffer = frame.m_buffer.data();
+                    frame.m_frame.bufferSize = static_cast<VmbUint32_t>(frame.m_buffer.size());
+                    frame.m_frame.imageData = frame.m_buffer.data();
+                    frame.m_frame.pixelFormat = format.m_pixelFormat;
+                    frame.m_frame.width = width;
+                    frame.m_frame.height = height;
+                    frame.m_frame.frameID = index;
+                }
+                m_formats.push_back(std::move(frames));
+            }
+        }
+
+        void CompressionBenchmark::ReadFrames()
+        /* 从录制文件中读取最多m_frames帧（压缩的帧先解码），复制到自己的缓冲区并按像素格式分组。 */
+        {
+            RecordingReader const reader(m_settings.m_fileName);
+            std::vector<unsigned char> decompressed;
+            size_t const count = (std::min)(reader.GetFrameCount(), m_settings.m_frames);
+            for (size_t index = 0; index != count; ++index)
+            {
+                VmbFrame_t const recorded = reader.GetFrame(index, decompressed);
+                auto group = std::find_if(m_formats.begin(), m_formats.end(),
+                                          [&recorded](std::vector<Frame> const& frames) { return frames.front().m_frame.pixelFormat == recorded.pixelFormat; });
+                if (group == m_formats.end())
+                {
+                    m_formats.emplace_back();
+                    group = m_formats.end() - 1;
+                }
+
+                group->emplace_back();
+                auto& frame = group->back();
+                auto const source = static_cast<unsigned char const*>(recorded.buffer);
+                frame.m_buffer.assign(source, source + recorded.bufferSize);
+                frame.m_frame = recorded;
+                frame.m_frame.buffer = frame.m_buffer.data();
+                frame.m_frame.imageData = frame.m_buffer.data() + (recorded.imageData - source);
+            }
+        }
+
+        bool CompressionBenchmark::MeasureFormat(std::vector<Frame> const& frames, std::ostream& log) const
+        /* 先用一个线程逐帧压缩并解码，验证结果与原始数据完全相同，测量压缩比以及压缩和解码的速率；
+        然后用m_threads个线程（各自使用自己的LosslessCodec）同时压缩所有帧，测量总吞吐量。 */
+        {
+            LosslessCodec codec;
+            std::vector<unsigned char> compressed;
+            std::vector<unsigned char> restored;
+            VmbUint64_t inputBytes = 0;
+            VmbUint64_t outputBytes = 0;
+            VmbUint64_t restoredBytes = 0;
+            VmbUint64_t pixels = 0;
+            size_t storedUncompressed = 0;
+            Clock::duration compressionTime {};
+            Clock::duration decompressionTime {};
+            bool lossless = true;
+
+            for (auto const& frame : frames)
+            {
+                auto const start = Clock::now();
+                size_t const size = codec.Compress(frame.m_frame, compressed);
+                compressionTime += Clock::now() - start;
+
+                inputBytes += frame.m_frame.bufferSize;
+                pixels += VmbUint64_t(frame.m_frame.width) * frame.m_frame.height;
+                if (size == 0)
+                {
+                    ++storedUncompressed;
+                    outputBytes += frame.m_frame.bufferSize;
+                    continue;
+                }
+                outputBytes += size;
+
+                restored.assign(frame.m_frame.bufferSize, 0);
+                VmbFrame_t target = frame.m_frame;
+                target.buffer = restored.data();
+                target.imageData = restored.data() + (frame.m_frame.imageData - frame.m_buffer.data());
+                auto const decompressionStart = Clock::now();
+                codec.Decompress(compressed.data(), size, target);
+                decompressionTime += Clock::now() - decompressionStart;
+                restoredBytes += restored.size();
+                lossless = lossless && std::memcmp(restored.data(), frame.m_buffer.data(), restored.size()) == 0;
+            }
+
+            unsigned const threadCount = (std::max)(m_settings.m_threads, 1u);
+            std::vector<std::thread> threads;
+            auto const parallelStart = Clock::now();
+            for (unsigned i = 0; i != threadCount; ++i)
+            {
+                threads.emplace_back([&frames]()
+                {
+                    LosslessCodec threadCodec;
+                    std::vector<unsigned char> output;
+                    for (auto const& frame : frames)
+                    {
+                        threadCodec.Compress(frame.m_frame, output);
+                    }
+                });
+            }
+            for (auto& thread : threads)
+            {
+                thread.join();
+            }
+            auto const parallelTime = Clock::now() - parallelStart;
+
+            double const seconds = std::chrono::duration<double>(compressionTime).count();
+            log << "0x" << std::hex << std::setw(8) << std::setfill('0') << frames.front().m_frame.pixelFormat << std::dec << std::setfill(' ')
+                << std::fixed << std::setprecision(2)
+                << "  frames " << frames.size()
+                << "  ratio " << (outputBytes == 0 ? 0.0 : static_cast<double>(inputBytes) / static_cast<double>(outputBytes))
+                << "  compress " << std::setprecision(1) << MegabytesPerSecond(inputBytes, compressionTime) << " MB/s"
+                << " (" << (seconds > 0 ? static_cast<double>(pixels) / 1e6 / seconds : 0.0) << " MP/s)"
+                << "  decompress " << MegabytesPerSecond(restoredBytes, decompressionTime) << " MB/s"
+                << "  " << threadCount << " threads " << MegabytesPerSecond(inputBytes * threadCount, parallelTime) << " MB/s"
+                << "  uncompressed " << storedUncompressed
+                << (lossless ? "" : "  MISMATCH") << "\n";
+            log.unsetf(std::ios::floatfield);
+            return lossless;
+        }
+
+        bool CompressionBenchmark::Run(std::ostream& log)
+        {
+            if (m_settings.m_fileName.empty())
+            {
+                GenerateFrames();
+                log << "generated frames " << (m_settings.m_width & ~VmbUint32_t(1)) << "x" << m_settings.m_height
+                    << ", noise " << m_settings.m_noise << " LSB\n";
+            }
+            else
+            {
+                ReadFrames();
+                log << "frames of " << m_settings.m_fileName << "\n";
+            }
+
+            bool passed = true;
+            for (auto const& frames : m_formats)
+            {
+                passed = MeasureFormat(frames, log) && passed;
+            }
+            if (m_formats.empty())
+            {
+                log << "no frames\n";
+            }
+            return passed;
+        }
+    }
+}
@@ -0,0 +1,120 @@
+/**
+ * \date 2023
+ * \copyright Allied Vision Technologies.  All Rights Reserved.
+ *
+ * \copyright Redistribution of this file, in original or modified form, without
+ *            prior written consent of Allied Vision Technologies is prohibited.
+ *
+ * \warning THIS SOFTWARE IS PROVIDED BY THE AUTHOR "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF TITLE,
+ * NON-INFRINGEMENT, MERCHANTABILITY AND FITNESS FOR A PARTICULAR  PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \brief Definition of a benchmark measuring the lossless compression of recorded frames
+ */
+
+#ifndef ASYNCHRONOUSGRAB_C_COMPRESSION_BENCHMARK_H
+#define ASYNCHRONOUSGRAB_C_COMPRESSION_BENCHMARK_H
+
+#include <cstddef>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+#include <VmbC/VmbC.h>
+
+namespace VmbC
+{
+    namespace Examples
+    {
+        /**
+         * \brief Measures the compression ratio and throughput of
+         *        LosslessCodec per pixel format and verifies that the frames
+         *        are restored exactly
+         *
+         * The frames are either taken from a recording or generated: a
+         * smooth pattern with sensor noise in several mono, Bayer and RGB
+         * formats.
+         */
+        class CompressionBenchmark
+        {
+        public:
+            struct Settings
+            {
+                /**
+                 * \brief the recording providing the frames; empty to use
+                 *        generated frames
+                 */
+                std::string m_fileName;
+
+                /**
+                 * \brief the size of the generated frames
+                 */
+                ///@{
+                VmbUint32_t m_width { 2048 };
+                VmbUint32_t m_height { 1536 };
+                ///@}
+
+                /**
+                 * \brief the number of frames generated per pixel format or
+                 *        the maximum number of frames read from the recording
+                 */
+                size_t m_frames { 8 };
+
+                /**
+                 * \brief the standard deviation of the noise of the generated
+                 *        frames in units of the least significant bit of an
+                 *        8 bit sample
+                 */
+                double m_noise { 1.5 };
+
+                /**
+                 * \brief the number of threads compressing in parallel for
+                 *        the throughput measurement
+                 */
+                unsigned m_threads { 4 };
+            };
+
+            CompressionBenchmark(Settings const& settings);
+
+            /**
+             * \return true, if every frame was restored exactly
+             */
+            bool Run(std::ostream& log);
+        private:
+            struct Frame
+            {
+                VmbFrame_t m_frame;
+                std::vector<unsigned char> m_buffer;
+            };
+
+            Settings m_settings;
+
+            /**
+             * \brief frames grouped by pixel format
+             */
+            std::vector<std::vector<Frame>> m_formats;
+
+            void GenerateFrames();
+
+            /**
+             * \throws VmbException, if the recording cannot be read
+             */
+            void ReadFrames();
+
+            /**
+             * \brief compress and restore the frames of one pixel format
+             * \return true, if every frame was restored exactly
+             */
+            bool MeasureFormat(std::vector<Frame> const& frames, std::ostream& log) const;
+        };
+    }
+}
+
+#endif
@@ -0,0 +1,308 @@
+/**
+ * \date 2023
+ * \copyright Allied Vision Technologies.  All Rights Reserved.
+ *
+ * \copyright Redistribution of this file, in original or modified form, without
+ *            prior written consent of Allied Vision Technologies is prohibited.
+ *
+ * \warning THIS SOFTWARE IS PROVIDED BY THE AUTHOR "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF TITLE,
+ * NON-INFRINGEMENT, MERCHANTABILITY AND FITNESS FOR A PARTICULAR  PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \brief Implementation of ::VmbC::Examples::FanOutBenchmark
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <iomanip>
+#include <list>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "FanOutBenchmark.h"
+#include "FrameStreamClient.h"
+#include "FrameStreamServer.h"
+#include "Percentile.h"
+#include "VmbException.h"
+
+namespace VmbC
+{
+    namespace Examples
+    {
+        namespace
+        {
+            using Clock = FrameStreamServer::Clock;
+
+            constexpr std::chrono::milliseconds ReportInterval { 1000 };
+
+            /**
+             * \brief time the subscribers may take to receive the frames
+             *        queued at the end of the run
+             */
+            constexpr std::chrono::milliseconds DrainTime { 500 };
+
+            /**
+             * \brief a subscriber connected by the benchmark and the results
+             *        of its thread
+             */
+            struct Subscriber
+            {
+                std::string m_name;
+                std::chrono::milliseconds m_delay { 0 };
+                std::thread m_thread;
+
+                /**
+                 * \brief set after the stream header was received
+                 */
+                std::atomic<bool> m_connected { false };
+
+                VmbUint64_t m_framesReceived { 0 };
+                VmbUint64_t m_framesSkipped { 0 };
+                VmbUint64_t m_firstFrameId { 0 };
+                VmbUint64_t m_lastFrameId { 0 };
+                VmbUint64_t m_errors { 0 };
+                std::string m_error;
+            };
+
+            /**
+             * \brief write the frame ID to the start, the middle and the end
+             *        of a frame buffer
+             */
+            void MarkFrame(std::vector<unsigned char>& buffer, VmbUint64_t const frameId) noexcept
+            {
+                size_t const size = sizeof(frameId);
+                std::memcpy(buffer.data(), &frameId, size);
+                std::memcpy(buffer.data() + (buffer.size() / 2 & ~(size - 1)), &frameId, size);
+                std::memcpy(buffer.data() + buffer.size() - size, &frameId, size);
+            }
+
+            bool CheckFrame(FrameStreamClient::Frame const& frame) noexcept
+            {
+                auto const& buffer = frame.m_buffer;
+                VmbUint64_t const frameId = frame.m_header.m_frameId;
+                size_t const size = sizeof(frameId);
+                return buffer.size() >= 2 * size
+                    && std::memcmp(buffer.data(), &frameId, size) == 0
+                    && std::memcmp(buffer.data() + (buffer.size() / 2 & ~(size - 1)), &frameId, size) == 0
+                    && std::memcmp(buffer.data() + buffer.size() - size, &frameId, size) == 0;
+            }
+
+            void Receive(Subscriber& subscriber, VmbUint16_t const port, std::atomic<bool> const& stop)
+            /* 订阅者线程：接收帧直到 stop 被设置，检查帧ID递增、跳过的帧数与ID间隔一致以及缓冲区中的标记。 */
+            {
+                try
+                {
+                    FrameStreamClient client("127.0.0.1", port);
+                    subscriber.m_connected = true;
+                    FrameStreamClient::Frame frame;
+                    while (!stop)
+                    {
+                        if (!client.WaitForFrame(std::chrono::milliseconds(100)))
+                        {
+                            continue;
+                        }
+                        if (!client.ReadFrame(frame))
+                        {
+                            subscriber.m_error = "connection closed";
+                            break;
+                        }
+
+                        VmbUint64_t const frameId = frame.m_header.m_frameId;
+                        if (subscriber.m_framesReceived == 0)
+                        {
+                            subscriber.m_firstFrameId = frameId;
+                        }
+                        else if (frameId != subscriber.m_lastFrameId + 1 + frame.m_header.m_framesSkipped)
+                        {
+                            ++subscriber.m_errors;
+                        }
+                        if (!CheckFrame(frame))
+                        {
+                            ++subscriber.m_errors;
+                        }
+                        ++subscriber.m_framesReceived;
+                        subscriber.m_lastFrameId = frameId;
+
+                        if (subscriber.m_delay.count() != 0)
+                        {
+                            std::this_thread::sleep_for(subscriber.m_delay);
+                        }
+                    }
+                    subscriber.m_framesSkipped = client.GetFramesSkipped();
+                }
+                catch (VmbException const& ex)
+                {
+                    subscriber.m_error = ex.what();
+                }
+                subscriber.m_connected = true;
+            }
+
+            void Start(Subscriber& subscriber, VmbUint16_t const port, std::atomic<bool> const& stop)
+            {
+                subscriber.m_thread = std::thread(Receive, std::ref(subscriber), port, std::cref(stop));
+                while (!subscriber.m_connected)
+                {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                }
+            }
+
+            void PrintStatistics(std::ostream& log, FrameStreamServer::Statistics const& statistics)
+            {
+                log << "received " << statistics.m_framesReceived << "  dropped " << statistics.m_framesDropped << '\n';
+                for (auto const& subscriber : statistics.m_subscribers)
+                {
+                    log << "  " << std::left << std::setw(22) << subscriber.m_peer << std::right
+                        << " sent " << std::setw(6) << subscriber.m_framesSent
+                        << "  dropped " << std::setw(5) << subscriber.m_framesDropped
+                        << "  " << std::setw(7) << subscriber.m_throughput / (1024.0 * 1024.0) << " MB/s"
+                        << "  queued " << subscriber.m_queuedFrames
+                        << "  lag " << std::chrono::duration<double, std::milli>(subscriber.m_lag).count() << " ms"
+                        << (subscriber.m_zeroCopy ? "  zerocopy" : "")
+                        << (subscriber.m_sendsCopied != 0 ? " (copied " + std::to_string(subscriber.m_sendsCopied) + ")" : "")
+                        << '\n';
+                }
+            }
+        }
+
+        FanOutBenchmark::FanOutBenchmark(Settings const& settings)
+            : m_settings(settings)
+        {
+        }
+
+        bool FanOutBenchmark::Run(std::ostream& log)
+        /* 以固定帧率在当前线程中调用 FrameReceived，就像VmbC回调线程一样，并记录其耗时：
+        慢订阅者和迟到的订阅者都不能阻塞它。结束后等待 DrainTime 让订阅者接收完队列中的帧，再比较各订阅者的结果。 */
+        {
+            FrameStreamServer::Settings serverSettings;
+            serverSettings.m_port = 0;
+            serverSettings.m_zeroCopy = m_settings.m_zeroCopy;
+            FrameStreamServer server(serverSettings);
+            log << "sending " << m_settings.m_frameSize << " byte frames at " << m_settings.m_frameRate << " fps to "
+                << m_settings.m_fastSubscribers << " fast, 1 slow (" << m_settings.m_slowDelay.count() << " ms per frame)"
+                << " and 1 late subscriber on port " << server.GetPort() << '\n';
+
+            std::atomic<bool> stop { false };
+            std::list<Subscriber> subscribers;
+            for (unsigned i = 0; i != m_settings.m_fastSubscribers; ++i)
+            {
+                subscribers.emplace_back();
+                subscribers.back().m_name = "fast " + std::to_string(i + 1);
+                Start(subscribers.back(), server.GetPort(), stop);
+            }
+            subscribers.emplace_back();
+            subscribers.back().m_name = "slow";
+            subscribers.back().m_delay = m_settings.m_slowDelay;
+            Start(subscribers.back(), server.GetPort(), stop);
+            // give the server time to send the stream headers, so no subscriber starts late by accident
+            std::this_thread::sleep_for(std::chrono::milliseconds(200));
+
+            std::vector<unsigned char> buffer((std::max)(m_settings.m_frameSize, size_t(64)));
+            VmbFrame_t frame;
+            std::memset(&frame, 0, sizeof(frame));
+            frame.buffer = buffer.data();
+            frame.bufferSize = static_cast<VmbUint32_t>(buffer.size());
+            frame.imageData = buffer.data();
+            frame.pixelFormat = VmbPixelFormatMono8;
+            frame.width = 2048;
+            frame.height = static_cast<VmbUint32_t>(buffer.size() / frame.width);
+            frame.receiveStatus = VmbFrameStatusComplete;
+
+            auto const interval = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / m_settings.m_frameRate));
+            auto const start = Clock::now();
+            auto const end = start + m_settings.m_duration;
+            auto nextFrame = start;
+            auto nextReport = start + ReportInterval;
+            std::vector<Clock::duration> callTimes;
+            bool lateStarted = false;
+            VmbUint64_t lastFrameId = 0;
+            for (VmbUint64_t frameId = 1; nextFrame < end; ++frameId)
+            {
+                lastFrameId = frameId;
+                std::this_thread::sleep_until(nextFrame);
+                nextFrame += interval;
+
+                frame.frameID = frameId;
+                frame.timestamp = static_cast<VmbUint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count());
+                MarkFrame(buffer, frameId);
+                auto const callStart = Clock::now();
+                server.FrameReceived(frame);
+                callTimes.push_back(Clock::now() - callStart);
+
+                if (!lateStarted && callStart - start >= m_settings.m_lateJoin)
+                {
+                    lateStarted = true;
+                    subscribers.emplace_back();
+                    subscribers.back().m_name = "late";
+                    subscribers.back().m_thread = std::thread(Receive, std::ref(subscribers.back()), server.GetPort(), std::cref(stop));
+                }
+                if (callStart >= nextReport)
+                {
+                    nextReport += ReportInterval;
+                    PrintStatistics(log, server.GetStatistics());
+                }
+            }
+            double const seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+            std::this_thread::sleep_for(DrainTime);
+            auto const statistics = server.GetStatistics();
+            stop = true;
+            for (auto& subscriber : subscribers)
+            {
+                subscriber.m_thread.join();
+            }
+
+            log << "final statistics of the server: ";
+            PrintStatistics(log, statistics);
+            std::sort(callTimes.begin(), callTimes.end());
+            auto const percentile = [&callTimes](double p)
+            {
+                return std::chrono::duration<double, std::micro>(Percentile(callTimes, p)).count();
+            };
+            log << std::fixed << std::setprecision(1)
+                << "frames sent " << statistics.m_framesReceived << " (" << static_cast<double>(statistics.m_framesReceived) / seconds << " fps)"
+                << "  FrameReceived p50 " << percentile(0.5) << " us  p99 " << percentile(0.99) << " us  max " << percentile(1.0) << " us\n";
+
+            bool passed = true;
+            for (auto const& subscriber : subscribers)
+            {
+                // frames missing at the end count as lost, too
+                VmbUint64_t const expected = (subscriber.m_framesReceived == 0) ? 0 : lastFrameId - subscriber.m_firstFrameId + 1;
+                double const dropRate = (expected == 0) ? 1.0 : 1.0 - static_cast<double>(subscriber.m_framesReceived) / static_cast<double>(expected);
+                log << std::setw(8) << subscriber.m_name
+                    << ": frames " << subscriber.m_framesReceived
+                    << " (IDs " << subscriber.m_firstFrameId << ".." << subscriber.m_lastFrameId << ")"
+                    << "  skipped " << subscriber.m_framesSkipped
+                    << "  lost " << dropRate * 100.0 << " %"
+                    << "  errors " << subscriber.m_errors
+                    << (subscriber.m_error.empty() ? "" : "  " + subscriber.m_error) << '\n';
+
+                if (subscriber.m_errors != 0 || !subscriber.m_error.empty() || subscriber.m_framesReceived == 0)
+                {
+                    passed = false;
+                }
+                else if (subscriber.m_delay.count() == 0 && dropRate > m_settings.m_maxDropRate)
+                {
+                    log << subscriber.m_name << " lost more than " << m_settings.m_maxDropRate * 100.0 << " % of the frames\n";
+                    passed = false;
+                }
+                else if (subscriber.m_delay.count() != 0 && subscriber.m_framesSkipped == 0 && m_settings.m_slowDelay > interval)
+                {
+                    log << subscriber.m_name << " was sent frames faster than it received them\n";
+                    passed = false;
+                }
+            }
+            log.unsetf(std::ios::floatfield);
+            return passed;
+        }
+    }
+}
@@ -0,0 +1,95 @@
+/**
+ * \date 2023
+ * \copyright Allied Vision Technologies.  All Rights Reserved.
+ *
+ * \copyright Redistribution of this file, in original or modified form, without
+ *            prior written consent of Allied Vision Technologies is prohibited.
+ *
+ * \warning THIS SOFTWARE IS PROVIDED BY THE AUTHOR "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF TITLE,
+ * NON-INFRINGEMENT, MERCHANTABILITY AND FITNESS FOR A PARTICULAR  PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \brief Definition of a benchmark sending frames to several subscribers via TCP
+ */
+
+#ifndef ASYNCHRONOUSGRAB_C_FAN_OUT_BENCHMARK_H
+#define ASYNCHRONOUSGRAB_C_FAN_OUT_BENCHMARK_H
+
+#include <chrono>
+#include <cstddef>
+#include <iosfwd>
+
+namespace VmbC
+{
+    namespace Examples
+    {
+        /**
+         * \brief Sends synthetic frames via FrameStreamServer to subscribers
+         *        connected over the loopback interface.
+         *
+         * Besides the fast subscribers reading every frame immediately, a
+         * slow subscriber taking m_slowDelay per frame and a subscriber
+         * joining late are connected. Every subscriber checks the frame IDs
+         * and markers written into the frame buffers; the benchmark fails,
+         * if data is corrupted, the fast subscribers lose more than
+         * m_maxDropRate of the frames or the slow subscriber is not limited
+         * to the frames it is able to receive.
+         */
+        class FanOutBenchmark
+        {
+        public:
+            struct Settings
+            {
+                /**
+                 * \brief the number of subscribers reading every frame
+                 *        immediately
+                 */
+                unsigned m_fastSubscribers { 4 };
+
+                size_t m_frameSize { 2 << 20 };
+                double m_frameRate { 100.0 };
+                std::chrono::milliseconds m_duration { 10000 };
+
+                /**
+                 * \brief the time the slow subscriber takes per frame
+                 */
+                std::chrono::milliseconds m_slowDelay { 50 };
+
+                /**
+                 * \brief the time after the start the late subscriber connects
+                 */
+                std::chrono::milliseconds m_lateJoin { 2000 };
+
+                /**
+                 * \brief the maximum fraction of frames a fast subscriber may lose
+                 */
+                double m_maxDropRate { 0.01 };
+
+                /**
+                 * \brief send with MSG_ZEROCOPY, if supported
+                 */
+                bool m_zeroCopy { true };
+            };
+
+            FanOutBenchmark(Settings const& settings);
+
+            /**
+             * \return true, if all subscribers received intact frames and
+             *         the fast ones did not lose more than allowed
+             * \throws VmbException, if the server cannot be started
+             */
+            bool Run(std::ostream& log);
+        private:
+            Settings m_settings;
+        };
+    }
+}
+
+#endif
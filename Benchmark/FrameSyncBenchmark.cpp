@@ -0,0 +1,237 @@
+/**
+ * \date 2023
+ * \copyright Allied Vision Technologies.  All Rights Reserved.
+ *
+ * \copyright Redistribution of this file, in original or modified form, without
+ *            prior written consent of Allied Vision Technologies is prohibited.
+ *
+ * \warning THIS SOFTWARE IS PROVIDED BY THE AUTHOR "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF TITLE,
+ * NON-INFRINGEMENT, MERCHANTABILITY AND FITNESS FOR A PARTICULAR  PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \brief Implementation of ::VmbC::Examples::FrameSyncBenchmark
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <iomanip>
+#include <memory>
+#include <ostream>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "FrameSetSynchronizer.h"
+#include "FrameSyncBenchmark.h"
+#include "VmbException.h"
+
+namespace VmbC
+{
+    namespace Examples
+    {
+        namespace
+        {
+            using Clock = FrameSetSynchronizer::Clock;
+
+            /**
+             * \brief the part of the transfer latency added per camera index
+             */
+            constexpr std::chrono::microseconds LatencyStep { 300 };
+
+            constexpr size_t FrameSize = 64 << 10;
+
+            /**
+             * \brief time for delivering the last sets after the cameras
+             *        stopped
+             */
+            constexpr std::chrono::milliseconds DrainTime { 200 };
+
+            /**
+             * \brief checks that the frames of every set belong to the same
+             *        trigger
+             */
+            class SetChecker : public FrameSetSynchronizer::FrameSetSink
+            {
+            public:
+                void FrameSetReceived(FrameSetSynchronizer::FrameSet const& set) override
+                {
+                    VmbUint64_t const trigger = set.m_frames.front().frameID;
+                    bool valid = trigger > m_lastTrigger;
+                    for (auto const& frame : set.m_frames)
+                    {
+                        VmbUint64_t marker;
+                        std::memcpy(&marker, frame.buffer, sizeof(marker));
+                        valid = valid && frame.frameID == trigger && marker == trigger;
+                    }
+                    if (!valid)
+                    {
+                        ++m_errors;
+                    }
+                    m_lastTrigger = trigger;
+                    ++m_sets;
+                }
+
+                std::atomic<VmbUint64_t> m_sets { 0 };
+                std::atomic<VmbUint64_t> m_errors { 0 };
+            private:
+                VmbUint64_t m_lastTrigger { 0 };
+            };
+
+            struct Camera
+            {
+                /**
+                 * \brief the camera clock in nanoseconds is
+                 *        host time * (1 + m_drift) + m_offset
+                 */
+                ///@{
+                double m_drift { 0.0 };
+                VmbInt64_t m_offset { 0 };
+                ///@}
+                std::chrono::microseconds m_latency {};
+                std::thread m_thread;
+            };
+
+            void Simulate(Camera const& camera, unsigned const index, FrameSyncBenchmark::Settings const& settings,
+                          Clock::time_point const start, Clock::duration const period, VmbUint64_t const triggers,
+                          RawFrameSink& sink, std::vector<std::atomic<unsigned>>& received)
+            /* 相机线程：在每次触发时间加上传输延迟之后调用 FrameReceived。随机抖动小于帧周期，因此每台相机的帧按顺序到达。 */
+            {
+                std::mt19937 random(index + 1);
+                std::uniform_int_distribution<long long> jitter(0, settings.m_jitter.count());
+                std::uniform_real_distribution<double> loss(0.0, 1.0);
+
+                std::vector<unsigned char> buffer(FrameSize);
+                VmbFrame_t frame;
+                std::memset(&frame, 0, sizeof(frame));
+                frame.buffer = buffer.data();
+                frame.bufferSize = static_cast<VmbUint32_t>(buffer.size());
+                frame.imageData = buffer.data();
+                frame.pixelFormat = VmbPixelFormatMono8;
+                frame.width = 256;
+                frame.height = static_cast<VmbUint32_t>(buffer.size() / frame.width);
+                frame.receiveStatus = VmbFrameStatusComplete;
+
+                for (VmbUint64_t trigger = 1; trigger <= triggers; ++trigger)
+                {
+                    auto const triggerTime = start + period * static_cast<Clock::rep>(trigger);
+                    std::this_thread::sleep_until(triggerTime + camera.m_latency + std::chrono::microseconds(jitter(random)));
+                    if (loss(random) < settings.m_loss)
+                    {
+                        continue;
+                    }
+
+                    double const hostTime = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(triggerTime.time_since_epoch()).count());
+                    frame.frameID = trigger;
+                    frame.timestamp = static_cast<VmbUint64_t>(hostTime * (1.0 + camera.m_drift)) + static_cast<VmbUint64_t>(camera.m_offset);
+                    std::memcpy(buffer.data(), &trigger, sizeof(trigger));
+                    sink.FrameReceived(frame);
+                    ++received[trigger - 1];
+                }
+            }
+        }
+
+        FrameSyncBenchmark::FrameSyncBenchmark(Settings const& settings)
+            : m_settings(settings)
+        {
+        }
+
+        bool FrameSyncBenchmark::Run(std::ostream& log)
+        /* 每台相机的时钟偏移取随机的数百秒，远大于帧周期，不估计偏移就无法匹配；容差取帧周期的四分之一。
+        结束后统计所有相机都收到的触发数，与交付的组数比较。 */
+        {
+            if (m_settings.m_cameras < 2 || m_settings.m_frameRate <= 0.0)
+            {
+                throw VmbException("the benchmark needs at least two cameras and a positive frame rate", VmbErrorBadParameter);
+            }
+            auto const period = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / m_settings.m_frameRate));
+            if (m_settings.m_jitter + LatencyStep * static_cast<long long>(m_settings.m_cameras) >= period)
+            {
+                throw VmbException("the jitter and the latency differences need to be less than the frame period", VmbErrorBadParameter);
+            }
+            auto const triggers = static_cast<VmbUint64_t>(std::chrono::duration<double>(m_settings.m_duration).count() * m_settings.m_frameRate);
+
+            FrameSetSynchronizer::Settings settings;
+            settings.m_streamCount = m_settings.m_cameras;
+            settings.m_mode = m_settings.m_counter
+                ? FrameSetSynchronizer::MatchMode::Counter
+                : FrameSetSynchronizer::MatchMode::Timestamp;
+            settings.m_tolerance = m_settings.m_counter
+                ? 0
+                : std::chrono::duration_cast<std::chrono::nanoseconds>(period / 4).count();
+
+            SetChecker checker;
+            FrameSetSynchronizer synchronizer(settings, checker);
+
+            log << std::fixed << std::setprecision(1)
+                << "matching the frames of " << m_settings.m_cameras << " cameras at " << m_settings.m_frameRate << " fps by "
+                << (m_settings.m_counter ? "frame ID" : "timestamp")
+                << ", jitter " << m_settings.m_jitter.count() << " us, drift " << m_settings.m_drift << " ppm, loss "
+                << m_settings.m_loss * 100.0 << " %\n";
+
+            std::mt19937 random(1);
+            std::uniform_real_distribution<double> drift(-m_settings.m_drift * 1e-6, m_settings.m_drift * 1e-6);
+            std::uniform_int_distribution<VmbInt64_t> offset(100000000000LL, 900000000000LL);
+            std::vector<std::unique_ptr<Camera>> cameras;
+            std::vector<std::atomic<unsigned>> received(triggers);
+            for (auto& count : received)
+            {
+                count = 0;
+            }
+
+            auto const start = Clock::now() + std::chrono::milliseconds(100);
+            for (unsigned index = 0; index != m_settings.m_cameras; ++index)
+            {
+                cameras.emplace_back(new Camera);
+                Camera& camera = *cameras.back();
+                camera.m_drift = drift(random);
+                camera.m_offset = offset(random);
+                camera.m_latency = LatencyStep * static_cast<long long>(index + 1);
+                camera.m_thread = std::thread(Simulate, std::cref(camera), index, std::cref(m_settings), start, period, triggers,
+                                              std::ref(synchronizer.GetInput(index)), std::ref(received));
+            }
+            for (auto& camera : cameras)
+            {
+                camera->m_thread.join();
+            }
+            std::this_thread::sleep_for(DrainTime);
+
+            auto const complete = static_cast<VmbUint64_t>(std::count_if(received.begin(), received.end(),
+                [this](std::atomic<unsigned> const& count) { return count == m_settings.m_cameras; }));
+            auto const statistics = synchronizer.GetStatistics();
+
+            log << "triggers " << triggers << "  received by all cameras " << complete
+                << "  sets " << checker.m_sets << "  wrong sets " << checker.m_errors
+                << "  spread average " << statistics.m_averageSpread / 1000.0 << " us, maximum "
+                << static_cast<double>(statistics.m_maxSpread) / 1000.0 << " us\n";
+            for (size_t index = 0; index != statistics.m_streams.size(); ++index)
+            {
+                auto const& stream = statistics.m_streams[index];
+                log << "  camera " << index << ": received " << stream.m_framesReceived << "  matched " << stream.m_framesMatched
+                    << "  unmatched " << stream.m_framesUnmatched << "  late " << stream.m_framesLate
+                    << "  dropped " << stream.m_framesDropped << '\n';
+            }
+            log.unsetf(std::ios::floatfield);
+
+            bool passed = true;
+            if (checker.m_errors != 0)
+            {
+                log << "sets with frames of different triggers or out of order\n";
+                passed = false;
+            }
+            if (static_cast<double>(checker.m_sets) < m_settings.m_minSets * static_cast<double>(complete))
+            {
+                log << "less than " << m_settings.m_minSets * 100.0 << " % of the complete triggers delivered as sets\n";
+                passed = false;
+            }
+            return passed;
+        }
+    }
+}
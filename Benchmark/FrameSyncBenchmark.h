@@ -0,0 +1,95 @@
+/**
+ * \date 2023
+ * \copyright Allied Vision Technologies.  All Rights Reserved.
+ *
+ * \copyright Redistribution of this file, in original or modified form, without
+ *            prior written consent of Allied Vision Technologies is prohibited.
+ *
+ * \warning THIS SOFTWARE IS PROVIDED BY THE AUTHOR "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF TITLE,
+ * NON-INFRINGEMENT, MERCHANTABILITY AND FITNESS FOR A PARTICULAR  PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \brief Definition of a benchmark matching the frames of simulated cameras
+ */
+
+#ifndef ASYNCHRONOUSGRAB_C_FRAME_SYNC_BENCHMARK_H
+#define ASYNCHRONOUSGRAB_C_FRAME_SYNC_BENCHMARK_H
+
+#include <chrono>
+#include <iosfwd>
+
+namespace VmbC
+{
+    namespace Examples
+    {
+        /**
+         * \brief Passes the frames of simulated cameras triggered by a common
+         *        signal to FrameSetSynchronizer and checks the sets.
+         *
+         * Every camera has its own clock with a random offset and a drift
+         * of up to m_drift, and a transfer latency growing with the index
+         * of the camera plus a random jitter; m_loss of its frames are lost.
+         * The frame ID is the index of the trigger, so a set is correct, if
+         * the frame IDs of its frames are equal; in MatchMode::Counter the
+         * synchronizer uses the frame ID itself. The benchmark fails, if a
+         * set is wrong or out of order, or less than m_minSets of the
+         * triggers received by all cameras were delivered as sets.
+         */
+        class FrameSyncBenchmark
+        {
+        public:
+            struct Settings
+            {
+                unsigned m_cameras { 3 };
+                double m_frameRate { 50.0 };
+                std::chrono::milliseconds m_duration { 10000 };
+
+                /**
+                 * \brief the maximum random part of the transfer latency
+                 */
+                std::chrono::microseconds m_jitter { 2000 };
+
+                /**
+                 * \brief the maximum deviation of the camera clocks from the
+                 *        host clock in parts per million
+                 */
+                double m_drift { 20.0 };
+
+                /**
+                 * \brief the fraction of the frames lost by each camera
+                 */
+                double m_loss { 0.01 };
+
+                /**
+                 * \brief match the frame IDs instead of the timestamps
+                 */
+                bool m_counter { false };
+
+                /**
+                 * \brief the minimum fraction of the complete triggers
+                 *        delivered as sets
+                 */
+                double m_minSets { 0.99 };
+            };
+
+            FrameSyncBenchmark(Settings const& settings);
+
+            /**
+             * \return true, if all sets were correct and complete enough
+             * \throws VmbException, if the settings are invalid
+             */
+            bool Run(std::ostream& log);
+        private:
+            Settings m_settings;
+        };
+    }
+}
+
+#endif
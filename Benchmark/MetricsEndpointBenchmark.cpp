@@ -0,0 +1,202 @@
+/**
+ * \date 2023
+ * \copyright Allied Vision Technologies.  All Rights Reserved.
+ *
+ * \copyright Redistribution of this file, in original or modified form, without
+ *            prior written consent of Allied Vision Technologies is prohibited.
+ *
+ * \warning THIS SOFTWARE IS PROVIDED BY THE AUTHOR "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF TITLE,
+ * NON-INFRINGEMENT, MERCHANTABILITY AND FITNESS FOR A PARTICULAR  PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \brief Implementation of ::VmbC::Examples::MetricsEndpointBenchmark
+ */
+
+#include <algorithm>
+#include <cstdlib>
+#include <ostream>
+#include <thread>
+
+#include "MetricsEndpointBenchmark.h"
+#include "MetricsServer.h"
+#include "Socket.h"
+#include "VmbException.h"
+
+namespace VmbC
+{
+    namespace Examples
+    {
+        namespace
+        {
+            using Clock = AcquisitionManager::Clock;
+
+            /**
+             * \brief the metrics that need to be present in every scrape 
+             */
+            char const* const RequiredMetrics[] = {
+                "vmb_frames_received_total",
+                "vmb_frames_incomplete_total",
+                "vmb_frames_missing_total",
+                "vmb_frame_latency_seconds_count",
+                "vmb_frame_buffers",
+                "vmb_transcoder_frames_converted_total",
+                "vmb_transcoder_frames_dropped_total",
+                "vmb_transcoder_conversion_seconds_sum",
+                "vmb_transcoder_cpu_seconds_total",
+                "vmb_transcoder_queue_depth",
+                "process_cpu_seconds_total",
+                "process_resident_memory_bytes",
+            };
+
+            /**
+             * \brief find the value of a sample without labels in a response in the
+             *        Prometheus text format
+             * \return false, if the sample is not present
+             */
+            bool FindSample(std::string const& text, std::string const& name, double& value)
+            {
+                std::string const prefix = name + ' ';
+                size_t lineStart = 0;
+                while (lineStart < text.size())
+                {
+                    if (text.compare(lineStart, prefix.size(), prefix) == 0)
+                    {
+                        value = std::strtod(text.c_str() + lineStart + prefix.size(), nullptr);
+                        return true;
+                    }
+                    auto const lineEnd = text.find('\n', lineStart);
+                    if (lineEnd == std::string::npos)
+                    {
+                        break;
+                    }
+                    lineStart = lineEnd + 1;
+                }
+                return false;
+            }
+
+            double ToMilliseconds(Clock::duration duration)
+            {
+                return std::chrono::duration<double, std::milli>(duration).count();
+            }
+        }
+
+        MetricsEndpointBenchmark::MetricsEndpointBenchmark(VmbCameraInfo_t const& cameraInfo, Settings const& settings)
+            : m_cameraInfo(cameraInfo),
+            m_settings(settings),
+            m_acquisitionManager(*this)
+        {
+        }
+
+        void MetricsEndpointBenchmark::ConvertedFrameReceived(Image const&, VmbFrame_t const&)
+        {
+        }
+
+        std::string MetricsEndpointBenchmark::HttpGet(VmbUint16_t const port, std::string const& path)
+        /* 最简单的HTTP客户端：发送GET请求，读取到连接关闭为止，检查状态行并返回响应体。 */
+        {
+            Socket connection = Socket::ConnectLocal(port);
+            std::string const request = "GET " + path + " HTTP/1.1\r\nHost: 127.0.0.1\r\nConnection: close\r\n\r\n";
+            if (!connection.SendAll(request.data(), request.size()))
+            {
+                throw VmbException("unable to send the HTTP request");
+            }
+
+            connection.SetReceiveTimeout(std::chrono::milliseconds(5000));
+            std::string response;
+            char buffer[4096];
+            long received;
+            while ((received = connection.Receive(buffer, sizeof(buffer))) > 0)
+            {
+                response.append(buffer, static_cast<size_t>(received));
+            }
+
+            if (response.compare(0, 12, "HTTP/1.1 200") != 0)
+            {
+                throw VmbException("unexpected HTTP response: " + response.substr(0, response.find("\r\n")));
+            }
+            auto const bodyStart = response.find("\r\n\r\n");
+            return (bodyStart == std::string::npos) ? std::string() : response.substr(bodyStart + 4);
+        }
+
+        bool MetricsEndpointBenchmark::Run(std::ostream& log)
+        /* 
+        brief：在采集过程中定期通过HTTP读取指标
+        检查所有必需的指标是否存在、接收帧数是否增加，并比较开始和结束时的读取耗时：
+        读取耗时只应取决于指标数量，不应随着已处理的帧数增长。
+         */
+        {
+            MetricsServer server(m_acquisitionManager.GetMetrics(), m_settings.m_port);
+            log << "serving metrics at http://127.0.0.1:" << server.GetPort() << "/metrics\n";
+
+            m_acquisitionManager.StartAcquisition(m_cameraInfo);
+
+            bool passed = true;
+            double firstScrapeMs = -1.0;
+            double lastScrapeMs = 0.0;
+            double framesReceived = 0.0;
+
+            auto const end = Clock::now() + m_settings.m_duration;
+            while (Clock::now() < end)
+            {
+                std::this_thread::sleep_for(m_settings.m_scrapeInterval);
+
+                auto const scrapeStart = Clock::now();
+                std::string body;
+                try
+                {
+                    body = HttpGet(server.GetPort(), "/metrics");
+                }
+                catch (VmbException const& ex)
+                {
+                    log << "scrape failed: " << ex.what() << '\n';
+                    passed = false;
+                    break;
+                }
+                lastScrapeMs = ToMilliseconds(Clock::now() - scrapeStart);
+                if (firstScrapeMs < 0)
+                {
+                    firstScrapeMs = lastScrapeMs;
+                }
+
+                for (auto const name : RequiredMetrics)
+                {
+                    double value;
+                    if (!FindSample(body, name, value))
+                    {
+                        log << "metric " << name << " missing\n";
+                        passed = false;
+                    }
+                }
+                FindSample(body, "vmb_frames_received_total", framesReceived);
+
+                log << "scrape: " << lastScrapeMs << " ms, " << body.size() << " bytes, "
+                    << framesReceived << " frames received\n";
+            }
+
+            m_acquisitionManager.StopAcquisition();
+
+            if (framesReceived <= 0)
+            {
+                log << "no frames received\n";
+                passed = false;
+            }
+
+            if (firstScrapeMs >= 0
+                && lastScrapeMs > m_settings.m_scrapeToleranceMs
+                && lastScrapeMs > firstScrapeMs * m_settings.m_maxScrapeGrowth)
+            {
+                log << "scrape duration grew from " << firstScrapeMs << " ms to " << lastScrapeMs << " ms\n";
+                passed = false;
+            }
+
+            return passed;
+        }
+    }
+}
@@ -0,0 +1,107 @@
+/**
+ * \date 2023
+ * \copyright Allied Vision Technologies.  All Rights Reserved.
+ *
+ * \copyright Redistribution of this file, in original or modified form, without
+ *            prior written consent of Allied Vision Technologies is prohibited.
+ *
+ * \warning THIS SOFTWARE IS PROVIDED BY THE AUTHOR "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF TITLE,
+ * NON-INFRINGEMENT, MERCHANTABILITY AND FITNESS FOR A PARTICULAR  PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \brief Benchmark checking the metrics endpoint during an acquisition
+ */
+
+#ifndef ASYNCHRONOUSGRAB_C_METRICS_ENDPOINT_BENCHMARK_H
+#define ASYNCHRONOUSGRAB_C_METRICS_ENDPOINT_BENCHMARK_H
+
+#include <chrono>
+#include <iosfwd>
+#include <string>
+
+#include <VmbC/VmbC.h>
+
+#include "AcquisitionManager.h"
+#include "MetricsServer.h"
+
+namespace VmbC
+{
+    namespace Examples
+    {
+        /**
+         * \brief Runs the acquisition of a camera while scraping the metrics
+         *        endpoint via HTTP and checks the exposed values and the
+         *        scrape duration.
+         *
+         * Meant to be run against a simulated camera; while the benchmark is
+         * running the endpoint can also be queried with any HTTP client, e.g.
+         * curl http://127.0.0.1:9464/metrics
+         */
+        class MetricsEndpointBenchmark : private ConvertedFrameSink
+        {
+        public:
+            struct Settings
+            {
+                /**
+                 * \brief the port to serve the metrics on 
+                 */
+                VmbUint16_t m_port { MetricsServer::DefaultPort };
+
+                /**
+                 * \brief the duration of the acquisition 
+                 */
+                std::chrono::milliseconds m_duration { 10000 };
+
+                /**
+                 * \brief the time between two scrapes 
+                 */
+                std::chrono::milliseconds m_scrapeInterval { 1000 };
+
+                /**
+                 * \brief the maximum allowed ratio of the scrape duration at the
+                 *        end and at the start of the acquisition
+                 */
+                double m_maxScrapeGrowth { 2.0 };
+
+                /**
+                 * \brief scrape durations below this value are never reported
+                 *        to avoid failures caused by noise
+                 */
+                double m_scrapeToleranceMs { 1.0 };
+            };
+
+            MetricsEndpointBenchmark(VmbCameraInfo_t const& cameraInfo, Settings const& settings);
+
+            /**
+             * \brief execute the benchmark
+             * \return true, if the metrics were served as expected
+             */
+            bool Run(std::ostream& log);
+
+            /**
+             * \brief get the body of the response to a GET request for a
+             *        path on the local host
+             * \throws VmbException, if the request fails
+             */
+            static std::string HttpGet(VmbUint16_t port, std::string const& path);
+        private:
+            VmbCameraInfo_t const& m_cameraInfo;
+            Settings m_settings;
+            AcquisitionManager m_acquisitionManager;
+
+            /**
+             * \brief converted frames are not of interest for this benchmark 
+             */
+            void ConvertedFrameReceived(Image const& image, VmbFrame_t const& frame) override;
+        };
+    }
+}
+
+#endif
@@ -0,0 +1,46 @@
+/**
+ * \date 2023
+ * \copyright Allied Vision Technologies.  All Rights Reserved.
+ *
+ * \copyright Redistribution of this file, in original or modified form, without
+ *            prior written consent of Allied Vision Technologies is prohibited.
+ *
+ * \warning THIS SOFTWARE IS PROVIDED BY THE AUTHOR "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF TITLE,
+ * NON-INFRINGEMENT, MERCHANTABILITY AND FITNESS FOR A PARTICULAR  PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \brief Definition of the percentile of the benchmark measurements
+ */
+
+#ifndef ASYNCHRONOUSGRAB_C_PERCENTILE_H
+#define ASYNCHRONOUSGRAB_C_PERCENTILE_H
+
+#include <cstddef>
+#include <vector>
+
+namespace VmbC
+{
+    namespace Examples
+    {
+        /**
+         * \brief get a percentile of measurements by the nearest rank
+         * \param[in] sortedValues the measurements sorted ascending; not empty
+         * \param[in] fraction the percentile as fraction, e.g. 0.99 for p99
+         *                     and 1.0 for the maximum
+         */
+        template<class T>
+        T const& Percentile(std::vector<T> const& sortedValues, double const fraction) noexcept
+        {
+            return sortedValues[static_cast<size_t>(fraction * static_cast<double>(sortedValues.size() - 1) + 0.5)];
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,101 @@
+/**
+ * \date 2023
+ * \copyright Allied Vision Technologies.  All Rights Reserved.
+ *
+ * \copyright Redistribution of this file, in original or modified form, without
+ *            prior written consent of Allied Vision Technologies is prohibited.
+ *
+ * \warning THIS SOFTWARE IS PROVIDED BY THE AUTHOR "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF TITLE,
+ * NON-INFRINGEMENT, MERCHANTABILITY AND FITNESS FOR A PARTICULAR  PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \brief Implementation of ::VmbC::Examples::SharedMemoryBenchmark
+ */
+
+#include <algorithm>
+#include <iomanip>
+#include <ostream>
+#include <thread>
+#include <vector>
+
+#include "Percentile.h"
+#include "SharedFrameReader.h"
+#include "SharedMemoryBenchmark.h"
+
+namespace VmbC
+{
+    namespace Examples
+    {
+        SharedMemoryBenchmark::SharedMemoryBenchmark(Settings const& settings)
+            : m_settings(settings)
+        {
+        }
+
+        bool SharedMemoryBenchmark::Run(std::ostream& log)
+        /* 作为外部读取者依次取得每一帧：记录从发布到唤醒的延迟，按8字节读取整个帧缓冲区（计入访问共享页面的开销），
+        可选地持有一段时间后释放，模拟读取者的处理时间。 */
+        {
+            using Clock = SharedFrameReader::Clock;
+
+            SharedFrameReader reader(m_settings.m_name);
+            log << "reading frames of " << m_settings.m_name << " for " << m_settings.m_duration.count() << " ms"
+                << ", holding each frame " << m_settings.m_holdTime.count() << " ms\n";
+
+            std::vector<Clock::duration> latencies;
+            VmbUint64_t bytesRead = 0;
+            VmbUint64_t checksum = 0;
+            SharedFrameReader::FrameReference frame;
+            auto const start = Clock::now();
+            auto const end = start + m_settings.m_duration;
+            for (auto now = start; now < end && !reader.IsClosed(); now = Clock::now())
+            {
+                if (!reader.WaitForFrame(frame, std::chrono::duration_cast<std::chrono::milliseconds>(end - now)))
+                {
+                    continue;
+                }
+                latencies.push_back(Clock::now() - frame.GetPublishTime());
+
+                auto const& data = frame.GetFrame();
+                auto const words = static_cast<VmbUint64_t const*>(data.buffer);
+                for (size_t i = 0; i != data.bufferSize / sizeof(VmbUint64_t); ++i)
+                {
+                    checksum += words[i];
+                }
+                bytesRead += data.bufferSize;
+
+                if (m_settings.m_holdTime.count() != 0)
+                {
+                    std::this_thread::sleep_for(m_settings.m_holdTime);
+                }
+            }
+            frame.Release();
+            double const seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+            log << std::fixed << std::setprecision(1)
+                << "frames " << latencies.size() << " (" << static_cast<double>(latencies.size()) / seconds << " fps)"
+                << "  skipped " << reader.GetFramesSkipped()
+                << "  read " << static_cast<double>(bytesRead) / (1024.0 * 1024.0) / seconds << " MB/s"
+                << (reader.IsClosed() ? "  export stopped" : "") << "\n";
+            if (!latencies.empty())
+            {
+                std::sort(latencies.begin(), latencies.end());
+                auto const percentile = [&latencies](double p)
+                {
+                    return std::chrono::duration<double, std::micro>(Percentile(latencies, p)).count();
+                };
+                log << "latency from publication  p50 " << percentile(0.5) << " us  p99 " << percentile(0.99)
+                    << " us  max " << percentile(1.0) << " us\n";
+            }
+            log << "checksum " << std::hex << checksum << std::dec << "\n";
+            log.unsetf(std::ios::floatfield);
+            return !latencies.empty();
+        }
+    }
+}
@@ -0,0 +1,71 @@
+/**
+ * \date 2023
+ * \copyright Allied Vision Technologies.  All Rights Reserved.
+ *
+ * \copyright Redistribution of this file, in original or modified form, without
+ *            prior written consent of Allied Vision Technologies is prohibited.
+ *
+ * \warning THIS SOFTWARE IS PROVIDED BY THE AUTHOR "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF TITLE,
+ * NON-INFRINGEMENT, MERCHANTABILITY AND FITNESS FOR A PARTICULAR  PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \brief Definition of a benchmark reading the frames exported via shared memory
+ */
+
+#ifndef ASYNCHRONOUSGRAB_C_SHARED_MEMORY_BENCHMARK_H
+#define ASYNCHRONOUSGRAB_C_SHARED_MEMORY_BENCHMARK_H
+
+#include <chrono>
+#include <iosfwd>
+#include <string>
+
+namespace VmbC
+{
+    namespace Examples
+    {
+        /**
+         * \brief Attaches to the frames exported via shared memory by a
+         *        running acquisition, e.g. of AsynchronousGrabQt started
+         *        with --shared-memory, as an external reader.
+         *
+         * Measures the frames received and skipped and the latency from
+         * the publication of a frame until the reader woke up with it;
+         * every frame buffer is read completely to include the cost of
+         * accessing the shared pages.
+         */
+        class SharedMemoryBenchmark
+        {
+        public:
+            struct Settings
+            {
+                std::string m_name { "/AsynchronousGrabFrames" };
+                std::chrono::milliseconds m_duration { 10000 };
+
+                /**
+                 * \brief the time each frame is held before releasing it,
+                 *        simulating the processing of a reader
+                 */
+                std::chrono::milliseconds m_holdTime { 0 };
+            };
+
+            SharedMemoryBenchmark(Settings const& settings);
+
+            /**
+             * \return true, if frames were received
+             * \throws VmbException, if the shared memory cannot be opened
+             */
+            bool Run(std::ostream& log);
+        private:
+            Settings m_settings;
+        };
+    }
+}
+
+#endif
@@ -0,0 +1,222 @@
+/**
+ * \date 2023
+ * \copyright Allied Vision Technologies.  All Rights Reserved.
+ *
+ * \copyright Redistribution of this file, in original or modified form, without
+ *            prior written consent of Allied Vision Technologies is prohibited.
+ *
+ * \warning THIS SOFTWARE IS PROVIDED BY THE AUTHOR "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF TITLE,
+ * NON-INFRINGEMENT, MERCHANTABILITY AND FITNESS FOR A PARTICULAR  PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \brief Implementation of ::VmbC::Examples::SinkGraphBenchmark
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <iomanip>
+#include <ostream>
+#include <thread>
+#include <vector>
+
+#include "FrameSinkGraph.h"
+#include "SinkGraphBenchmark.h"
+#include "VmbException.h"
+
+namespace VmbC
+{
+    namespace Examples
+    {
+        namespace
+        {
+            using Clock = FrameSinkGraph::Clock;
+
+            /**
+             * \brief time for delivering the queued frames after the last
+             *        frame was received
+             */
+            constexpr std::chrono::milliseconds DrainTime { 500 };
+
+            /**
+             * \brief sleeps for the processing time per frame and checks the
+             *        frame ID written to the start of the buffer
+             */
+            class SimulatedSink : public RawFrameSink
+            {
+            public:
+                SimulatedSink(std::chrono::milliseconds processingTime)
+                    : m_processingTime(processingTime)
+                {
+                }
+
+                void FrameReceived(VmbFrame_t const& frame) override
+                {
+                    VmbUint64_t marker;
+                    std::memcpy(&marker, frame.buffer, sizeof(marker));
+                    if (marker != frame.frameID || frame.frameID <= m_lastFrameId)
+                    {
+                        ++m_errors;
+                    }
+                    else if (frame.frameID != m_lastFrameId + 1)
+                    {
+                        m_gaps += frame.frameID - m_lastFrameId - 1;
+                    }
+                    m_lastFrameId = frame.frameID;
+                    ++m_frames;
+                    std::this_thread::sleep_for(m_processingTime);
+                }
+
+                std::atomic<VmbUint64_t> m_frames { 0 };
+
+                /**
+                 * \brief frames left out and frames out of order or with
+                 *        wrong data
+                 */
+                ///@{
+                std::atomic<VmbUint64_t> m_gaps { 0 };
+                std::atomic<VmbUint64_t> m_errors { 0 };
+                ///@}
+            private:
+                std::chrono::milliseconds const m_processingTime;
+                VmbUint64_t m_lastFrameId { 0 };
+            };
+
+            char const* GetPolicyName(FrameSinkGraph::DropPolicy const policy)
+            {
+                switch (policy)
+                {
+                case FrameSinkGraph::DropPolicy::DropNewest:
+                    return "drop newest";
+                case FrameSinkGraph::DropPolicy::Block:
+                    return "block";
+                default:
+                    return "drop oldest";
+                }
+            }
+
+            double ToMilliseconds(Clock::duration const duration)
+            {
+                return std::chrono::duration<double, std::milli>(duration).count();
+            }
+        }
+
+        SinkGraphBenchmark::SinkGraphBenchmark(Settings const& settings)
+            : m_settings(settings)
+        {
+        }
+
+        bool SinkGraphBenchmark::Run(std::ostream& log)
+        /* 在当前线程中按帧率调用 FrameReceived，模拟VmbC回调线程；帧的开头写入帧ID，接收者据此检查顺序和内容。
+        录制队列能容纳的帧数多于内存预算，因此录制只能通过驱逐分析和预览的帧跟上。 */
+        {
+            if (m_settings.m_frameRate <= 0.0 || m_settings.m_frameSize < sizeof(VmbUint64_t))
+            {
+                throw VmbException("the benchmark needs a positive frame rate and frames of at least 8 bytes", VmbErrorBadParameter);
+            }
+            auto const period = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / m_settings.m_frameRate));
+            auto const frames = static_cast<VmbUint64_t>(std::chrono::duration<double>(m_settings.m_duration).count() * m_settings.m_frameRate);
+
+            FrameSinkGraph::Settings settings;
+            settings.m_memoryBudget = m_settings.m_memoryBudget;
+            FrameSinkGraph graph(settings);
+
+            SimulatedSink recording(m_settings.m_recordingTime);
+            SimulatedSink analysis(m_settings.m_analysisTime);
+            SimulatedSink preview(m_settings.m_previewTime);
+            {
+                FrameSinkGraph::EdgeSettings edge;
+                edge.m_name = "recording";
+                edge.m_priority = 100;
+                edge.m_queueDepth = 64;
+                edge.m_dropPolicy = FrameSinkGraph::DropPolicy::Block;
+                edge.m_maxBlockTime = std::chrono::milliseconds(1000);
+                graph.AddSink(recording, edge);
+
+                edge.m_name = "analysis";
+                edge.m_priority = 50;
+                edge.m_queueDepth = 4;
+                edge.m_dropPolicy = FrameSinkGraph::DropPolicy::DropNewest;
+                graph.AddSink(analysis, edge);
+
+                edge.m_name = "preview";
+                edge.m_priority = 10;
+                edge.m_queueDepth = 2;
+                edge.m_dropPolicy = FrameSinkGraph::DropPolicy::DropOldest;
+                graph.AddSink(preview, edge);
+            }
+
+            log << std::fixed << std::setprecision(1)
+                << "passing " << frames << " frames of " << m_settings.m_frameSize / 1024 << " KiB at " << m_settings.m_frameRate
+                << " fps to recording (" << m_settings.m_recordingTime.count() << " ms), analysis (" << m_settings.m_analysisTime.count()
+                << " ms) and preview (" << m_settings.m_previewTime.count() << " ms), memory budget "
+                << m_settings.m_memoryBudget / (1024 * 1024) << " MiB\n";
+
+            std::vector<unsigned char> buffer(m_settings.m_frameSize);
+            VmbFrame_t frame;
+            std::memset(&frame, 0, sizeof(frame));
+            frame.buffer = buffer.data();
+            frame.bufferSize = static_cast<VmbUint32_t>(buffer.size());
+            frame.imageData = buffer.data();
+            frame.pixelFormat = VmbPixelFormatMono8;
+            frame.width = 1024;
+            frame.height = static_cast<VmbUint32_t>(buffer.size() / frame.width);
+            frame.receiveStatus = VmbFrameStatusComplete;
+
+            Clock::duration maxCallTime {};
+            auto const start = Clock::now();
+            for (VmbUint64_t frameId = 1; frameId <= frames; ++frameId)
+            {
+                std::this_thread::sleep_until(start + period * static_cast<Clock::rep>(frameId));
+                frame.frameID = frameId;
+                std::memcpy(buffer.data(), &frameId, sizeof(frameId));
+                auto const callStart = Clock::now();
+                graph.FrameReceived(frame);
+                maxCallTime = (std::max)(maxCallTime, Clock::now() - callStart);
+            }
+            std::this_thread::sleep_for(DrainTime);
+
+            auto const statistics = graph.GetStatistics();
+            log << "received " << statistics.m_framesReceived << "  copied " << statistics.m_framesCopied
+                << "  buffers " << statistics.m_buffers << " (" << statistics.m_allocatedBytes / (1024.0 * 1024.0) << " MiB)"
+                << "  longest FrameReceived " << ToMilliseconds(maxCallTime) << " ms\n";
+            for (auto const& edge : statistics.m_edges)
+            {
+                log << "  " << std::left << std::setw(10) << edge.m_name << std::right
+                    << " priority " << edge.m_priority << "  queue " << edge.m_queueDepth << " (" << GetPolicyName(edge.m_dropPolicy) << ")"
+                    << "  delivered " << edge.m_framesDelivered << " of " << edge.m_framesOffered
+                    << "  dropped " << edge.m_framesDropped << "  evicted " << edge.m_framesEvicted
+                    << "  max queued " << edge.m_maxQueued
+                    << "  queue time " << ToMilliseconds(edge.m_averageQueueTime) << "/" << ToMilliseconds(edge.m_maxQueueTime) << " ms"
+                    << "  sink time " << ToMilliseconds(edge.m_averageDeliveryTime) << " ms"
+                    << "  blocked " << ToMilliseconds(edge.m_blockedTime) << " ms\n";
+            }
+            log.unsetf(std::ios::floatfield);
+
+            bool passed = true;
+            if (recording.m_frames != frames || recording.m_gaps != 0 || recording.m_errors != 0)
+            {
+                log << "the recording missed " << frames - recording.m_frames << " frames or received them out of order\n";
+                passed = false;
+            }
+            if (analysis.m_errors != 0 || preview.m_errors != 0)
+            {
+                log << "frames with wrong data or out of order\n";
+                passed = false;
+            }
+            if (preview.m_frames == 0)
+            {
+                log << "the preview received no frame\n";
+                passed = false;
+            }
+            return passed;
+        }
+    }
+}
@@ -0,0 +1,80 @@
+/**
+ * \date 2023
+ * \copyright Allied Vision Technologies.  All Rights Reserved.
+ *
+ * \copyright Redistribution of this file, in original or modified form, without
+ *            prior written consent of Allied Vision Technologies is prohibited.
+ *
+ * \warning THIS SOFTWARE IS PROVIDED BY THE AUTHOR "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF TITLE,
+ * NON-INFRINGEMENT, MERCHANTABILITY AND FITNESS FOR A PARTICULAR  PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \brief Definition of a benchmark passing frames to sinks of different priority
+ */
+
+#ifndef ASYNCHRONOUSGRAB_C_SINK_GRAPH_BENCHMARK_H
+#define ASYNCHRONOUSGRAB_C_SINK_GRAPH_BENCHMARK_H
+
+#include <chrono>
+#include <cstddef>
+#include <iosfwd>
+
+namespace VmbC
+{
+    namespace Examples
+    {
+        /**
+         * \brief Passes synthetic frames to a FrameSinkGraph with a
+         *        recording, an analysis and a preview sink of decreasing
+         *        priority and prints the counters of the edges.
+         *
+         * The recording edge uses DropPolicy::Block, the analysis edge
+         * DropPolicy::DropNewest and the preview edge DropPolicy::DropOldest;
+         * every sink sleeps for its processing time per frame. The memory
+         * budget is smaller than the recording queue, so the recording only
+         * keeps up by evicting the frames of the other edges. The benchmark
+         * fails, if the recording misses a frame or receives it out of
+         * order, or the preview receives no frame at all.
+         */
+        class SinkGraphBenchmark
+        {
+        public:
+            struct Settings
+            {
+                double m_frameRate { 100.0 };
+                size_t m_frameSize { 4 << 20 };
+                std::chrono::milliseconds m_duration { 10000 };
+
+                /**
+                 * \brief the time the sinks take per frame
+                 */
+                ///@{
+                std::chrono::milliseconds m_recordingTime { 2 };
+                std::chrono::milliseconds m_analysisTime { 15 };
+                std::chrono::milliseconds m_previewTime { 50 };
+                ///@}
+
+                size_t m_memoryBudget { 64 << 20 };
+            };
+
+            SinkGraphBenchmark(Settings const& settings);
+
+            /**
+             * \return true, if the recording received every frame in order
+             * \throws VmbException, if the settings are invalid
+             */
+            bool Run(std::ostream& log);
+        private:
+            Settings m_settings;
+        };
+    }
+}
+
+#endif
@@ -0,0 +1,215 @@
+/**
+ * \date 2023
+ * \copyright Allied Vision Technologies.  All Rights Reserved.
+ *
+ * \copyright Redistribution of this file, in original or modified form, without
+ *            prior written consent of Allied Vision Technologies is prohibited.
+ *
+ * \warning THIS SOFTWARE IS PROVIDED BY THE AUTHOR "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF TITLE,
+ * NON-INFRINGEMENT, MERCHANTABILITY AND FITNESS FOR A PARTICULAR  PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \brief Implementation of ::VmbC::Examples::StorageBenchmark
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <iomanip>
+#include <ostream>
+#include <random>
+#include <vector>
+
+#include "AlignedBuffer.h"
+#include "Percentile.h"
+#include "RecordingFormat.h"
+#include "StorageBenchmark.h"
+
+namespace VmbC
+{
+    namespace Examples
+    {
+        namespace
+        {
+            struct StorageFormat
+            {
+                char const* m_name;
+                double m_bytesPerPixel;
+            };
+
+            constexpr StorageFormat StorageFormats[] =
+            {
+                { "Mono8 / BayerRG8", 1.0 },
+                { "Mono10p", 1.25 },
+                { "Mono12p / BayerRG12p", 1.5 },
+                { "Mono10/12/16 / BayerRG12", 2.0 },
+                { "Rgb8 / Bgr8", 3.0 },
+                { "Bgra8", 4.0 },
+            };
+
+            double MegabytesPerSecond(VmbUint64_t const bytes, StorageBenchmark::Clock::duration const duration) noexcept
+            {
+                double const seconds = std::chrono::duration<double>(duration).count();
+                return (seconds > 0) ? static_cast<double>(bytes) / (1024.0 * 1024.0) / seconds : 0.0;
+            }
+
+            double Milliseconds(StorageBenchmark::Clock::duration const duration) noexcept
+            {
+                return std::chrono::duration<double, std::milli>(duration).count();
+            }
+        }
+
+        StorageBenchmark::StorageBenchmark(Settings const& settings)
+            : m_settings(settings)
+        {
+        }
+
+        bool StorageBenchmark::Run(std::ostream& log)
+        /* 用随机数据填充一个合成帧（避免文件系统压缩或去重），通过RecordingSink反复写入：生产者在环形缓冲区满时调用WaitForSpace等待而不是丢帧，
+        因此磁盘始终满负荷运行。每秒采样一次已写入的字节数，预热之后最慢的一秒作为可持续吞吐量；写入线程报告每次写操作的延迟，用于计算百分位数。
+        最后按各像素格式每像素的字节数和记录头的开销，计算在保留余量后磁盘可以承受的最大 MP × fps。 */
+        {
+            std::string fileName = m_settings.m_directory;
+            if (!fileName.empty() && fileName.back() != '/' && fileName.back() != '\\')
+            {
+                fileName += '/';
+            }
+            fileName += "AsynchronousGrabStorageTest.vmbrec";
+
+            AlignedBuffer buffer(m_settings.m_frameSize, RecordingFormat::BlockSize);
+            std::mt19937 random(1);
+            for (size_t offset = 0; offset + sizeof(VmbUint32_t) <= buffer.GetSize(); offset += sizeof(VmbUint32_t))
+            {
+                VmbUint32_t const value = random();
+                std::memcpy(buffer.GetData() + offset, &value, sizeof(value));
+            }
+
+            VmbFrame_t frame;
+            std::memset(&frame, 0, sizeof(frame));
+            frame.buffer = buffer.GetData();
+            frame.bufferSize = static_cast<VmbUint32_t>(m_settings.m_frameSize);
+            frame.imageData = buffer.GetData();
+            frame.pixelFormat = VmbPixelFormatMono8;
+            frame.width = frame.bufferSize;
+            frame.height = 1;
+            frame.receiveStatus = VmbFrameStatusComplete;
+
+            std::vector<Clock::duration> latencies;
+            latencies.reserve(1 << 20);
+            size_t writeSizeSum = 0;
+
+            auto settings = m_settings.m_recording;
+            settings.m_fileName = fileName;
+            settings.m_compressionThreads = 0;
+            settings.m_writeCompleted = [&latencies, &writeSizeSum](Clock::duration latency, size_t size)
+            {
+                if (latencies.size() != latencies.capacity())
+                {
+                    latencies.push_back(latency);
+                    writeSizeSum += size;
+                }
+            };
+
+            log << "writing " << m_settings.m_frameSize / 1024 << " KiB frames to " << fileName
+                << " for " << std::chrono::duration<double>(m_settings.m_duration).count() << " s"
+                << ", ring " << (settings.m_ringSize >> 20) << " MiB, queue depth " << settings.m_queueDepth
+                << ", preallocation " << (settings.m_preallocationSize >> 20) << " MiB\n";
+
+            RecordingSink sink(settings);
+            auto const statistics = sink.GetStatistics();
+            log << "io_uring " << (statistics.m_usesIoUring ? "yes" : "no")
+                << ", direct I/O " << (statistics.m_usesDirectIo ? "yes" : "no") << "\n";
+
+            auto const start = Clock::now();
+            auto const warmupEnd = start + m_settings.m_warmup;
+            auto const end = warmupEnd + m_settings.m_duration;
+            auto nextSample = warmupEnd;
+            auto sampleTime = warmupEnd;
+            VmbUint64_t sampleBytes = 0;
+            VmbUint64_t warmupBytes = 0;
+            std::vector<double> rates;
+
+            for (auto now = start; now < end; now = Clock::now())
+            {
+                if (now >= nextSample)
+                {
+                    VmbUint64_t const bytes = sink.GetStatistics().m_bytesWritten;
+                    if (nextSample == warmupEnd)
+                    {
+                        warmupBytes = bytes;
+                    }
+                    else
+                    {
+                        rates.push_back(MegabytesPerSecond(bytes - sampleBytes, now - sampleTime));
+                    }
+                    sampleBytes = bytes;
+                    sampleTime = now;
+                    nextSample = now + std::chrono::seconds(1);
+                }
+
+                if (!sink.WaitForSpace(frame.bufferSize))
+                {
+                    break;
+                }
+                frame.timestamp = static_cast<VmbUint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(now - start).count());
+                sink.FrameReceived(frame);
+                ++frame.frameID;
+            }
+            auto const measured = sink.GetStatistics();
+            auto const measuredTime = Clock::now() - warmupEnd;
+            sink.Stop();
+
+            auto const result = sink.GetStatistics();
+            if (!m_settings.m_keepFile)
+            {
+                std::remove(fileName.c_str());
+            }
+
+            double const averageRate = MegabytesPerSecond(measured.m_bytesWritten - warmupBytes, measuredTime);
+            double const sustainedRate = rates.empty() ? averageRate : *std::min_element(rates.begin(), rates.end());
+            log << std::fixed << std::setprecision(1)
+                << "frames " << result.m_framesRecorded << "  dropped " << result.m_framesDropped
+                << "  ring high-water " << (result.m_ringSize == 0 ? 0 : 100 * result.m_ringHighWaterMark / result.m_ringSize) << "%"
+                << (result.m_writeFailed ? "  WRITE FAILED" : "") << "\n"
+                << "throughput average " << averageRate << " MB/s  sustained (slowest second) " << sustainedRate << " MB/s";
+            if (!rates.empty())
+            {
+                log << "  fastest second " << *std::max_element(rates.begin(), rates.end()) << " MB/s";
+            }
+            log << "\n";
+
+            if (!latencies.empty())
+            {
+                std::sort(latencies.begin(), latencies.end());
+                log << std::setprecision(2)
+                    << "write latency (" << latencies.size() << " writes of " << writeSizeSum / latencies.size() / 1024 << " KiB)"
+                    << "  p50 " << Milliseconds(Percentile(latencies, 0.5)) << " ms"
+                    << "  p90 " << Milliseconds(Percentile(latencies, 0.9)) << " ms"
+                    << "  p99 " << Milliseconds(Percentile(latencies, 0.99)) << " ms"
+                    << "  p99.9 " << Milliseconds(Percentile(latencies, 0.999)) << " ms"
+                    << "  max " << Milliseconds(latencies.back()) << " ms\n";
+            }
+
+            // the record header and the block padding are written with every frame
+            double const efficiency = static_cast<double>(m_settings.m_frameSize) / static_cast<double>(RecordingFormat::GetRecordSize(m_settings.m_frameSize));
+            double const usableBytes = sustainedRate * 1024.0 * 1024.0 * (1.0 - m_settings.m_margin) * efficiency;
+            log << std::setprecision(0)
+                << "maximum camera configuration with " << m_settings.m_margin * 100 << "% margin:\n";
+            for (auto const& format : StorageFormats)
+            {
+                log << "  " << std::left << std::setw(26) << format.m_name << std::right << std::setprecision(1)
+                    << std::setw(8) << usableBytes / format.m_bytesPerPixel / 1e6 << " MP x fps\n";
+            }
+            log.unsetf(std::ios::floatfield);
+
+            return !result.m_writeFailed && result.m_framesRecorded != 0;
+        }
+    }
+}
@@ -0,0 +1,105 @@
+/**
+ * \date 2023
+ * \copyright Allied Vision Technologies.  All Rights Reserved.
+ *
+ * \copyright Redistribution of this file, in original or modified form, without
+ *            prior written consent of Allied Vision Technologies is prohibited.
+ *
+ * \warning THIS SOFTWARE IS PROVIDED BY THE AUTHOR "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF TITLE,
+ * NON-INFRINGEMENT, MERCHANTABILITY AND FITNESS FOR A PARTICULAR  PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \brief Definition of a benchmark of the storage bandwidth available for recordings
+ */
+
+#ifndef ASYNCHRONOUSGRAB_C_STORAGE_BENCHMARK_H
+#define ASYNCHRONOUSGRAB_C_STORAGE_BENCHMARK_H
+
+#include <chrono>
+#include <cstddef>
+#include <iosfwd>
+#include <string>
+
+#include "RecordingSink.h"
+
+namespace VmbC
+{
+    namespace Examples
+    {
+        /**
+         * \brief Measures whether a disk can sustain the frames of cameras
+         *        by recording synthetic frames with RecordingSink
+         *
+         * The frames pass the same staging ring, alignment, queue depth and
+         * preallocation as a recording of the GUI; the producer waits for
+         * space in the ring instead of dropping frames, so the disk runs at
+         * its limit. The benchmark reports the throughput sustained in
+         * every second after a warm-up, percentiles of the write latency
+         * and the largest camera configuration in megapixels times frames
+         * per second the disk supports with a safety margin per pixel
+         * format.
+         */
+        class StorageBenchmark
+        {
+        public:
+            using Clock = std::chrono::steady_clock;
+
+            struct Settings
+            {
+                /**
+                 * \brief the directory on the disk to test
+                 */
+                std::string m_directory { "." };
+
+                /**
+                 * \brief the buffer size of the synthetic frames
+                 */
+                size_t m_frameSize { size_t(6) << 20 };
+
+                Clock::duration m_duration { std::chrono::seconds(20) };
+
+                /**
+                 * \brief the time at the start ignored for the results,
+                 *        e.g. while the ring is filled the first time
+                 */
+                Clock::duration m_warmup { std::chrono::seconds(2) };
+
+                /**
+                 * \brief the fraction of the sustained throughput kept in
+                 *        reserve for the camera configurations
+                 */
+                double m_margin { 0.2 };
+
+                /**
+                 * \brief keep the test file instead of removing it
+                 */
+                bool m_keepFile { false };
+
+                /**
+                 * \brief the ring size, queue depth and preallocation of
+                 *        the recording; the file name is ignored
+                 */
+                RecordingSink::Settings m_recording;
+            };
+
+            StorageBenchmark(Settings const& settings);
+
+            /**
+             * \return true, if all frames were written successfully
+             * \throws VmbException, if the test file cannot be created
+             */
+            bool Run(std::ostream& log);
+        private:
+            Settings m_settings;
+        };
+    }
+}
+
+#endif
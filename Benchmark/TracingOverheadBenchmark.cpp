@@ -0,0 +1,80 @@
+/**
+ * \date 2023
+ * \copyright Allied Vision Technologies.  All Rights Reserved.
+ *
+ * \copyright Redistribution of this file, in original or modified form, without
+ *            prior written consent of Allied Vision Technologies is prohibited.
+ *
+ * \warning THIS SOFTWARE IS PROVIDED BY THE AUTHOR "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF TITLE,
+ * NON-INFRINGEMENT, MERCHANTABILITY AND FITNESS FOR A PARTICULAR  PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \brief Implementation of ::VmbC::Examples::TracingOverheadBenchmark
+ */
+
+#include <chrono>
+#include <ostream>
+
+#include "Tracing.h"
+#include "TracingOverheadBenchmark.h"
+
+namespace VmbC
+{
+    namespace Examples
+    {
+        TracingOverheadBenchmark::TracingOverheadBenchmark(Settings const& settings)
+            : m_settings(settings)
+        {
+        }
+
+        double TracingOverheadBenchmark::MeasureScope(bool tracingEnabled) const
+        {
+            Tracing::SetEnabled(tracingEnabled);
+
+            auto const begin = std::chrono::steady_clock::now();
+            for (size_t i = 0; i != m_settings.m_iterations; ++i)
+            {
+                ASYNCHRONOUSGRAB_TRACE_SCOPE("TracingOverheadBenchmark", i);
+            }
+            auto const end = std::chrono::steady_clock::now();
+
+            Tracing::SetEnabled(true);
+
+            return std::chrono::duration<double, std::nano>(end - begin).count() / static_cast<double>(m_settings.m_iterations);
+        }
+
+        bool TracingOverheadBenchmark::Run(std::ostream& log)
+        /* 
+        brief：测量记录单个事件的平均耗时，并计算在给定帧率下每帧事件数对应的开销占帧周期的百分比。
+         */
+        {
+#if ASYNCHRONOUSGRAB_ENABLE_TRACING
+            ASYNCHRONOUSGRAB_TRACE_THREAD_NAME("TracingOverheadBenchmark");
+
+            double const disabledNs = MeasureScope(false);
+            double const enabledNs = MeasureScope(true);
+
+            double const framePeriodNs = 1e9 / m_settings.m_framesPerSecond;
+            double const overheadPercent = 100.0 * enabledNs * static_cast<double>(m_settings.m_eventsPerFrame) / framePeriodNs;
+            bool const passed = overheadPercent < m_settings.m_maxOverheadPercent;
+
+            log << "cost per event (tracing disabled at runtime): " << disabledNs << " ns\n"
+                << "cost per event (tracing enabled):             " << enabledNs << " ns\n"
+                << (passed ? "ok:   " : "FAIL: ") << m_settings.m_eventsPerFrame << " events per frame at "
+                << m_settings.m_framesPerSecond << " fps: " << overheadPercent << " % of the frame period (limit "
+                << m_settings.m_maxOverheadPercent << " %)\n";
+            return passed;
+#else
+            log << "tracing is disabled at compile time (ASYNCHRONOUSGRAB_ENABLE_TRACING=0); no overhead\n";
+            return true;
+#endif
+        }
+    }
+}
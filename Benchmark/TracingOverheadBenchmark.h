@@ -0,0 +1,82 @@
+/**
+ * \date 2023
+ * \copyright Allied Vision Technologies.  All Rights Reserved.
+ *
+ * \copyright Redistribution of this file, in original or modified form, without
+ *            prior written consent of Allied Vision Technologies is prohibited.
+ *
+ * \warning THIS SOFTWARE IS PROVIDED BY THE AUTHOR "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF TITLE,
+ * NON-INFRINGEMENT, MERCHANTABILITY AND FITNESS FOR A PARTICULAR  PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \brief Definition of a benchmark measuring the overhead of the tracing
+ */
+
+#ifndef ASYNCHRONOUSGRAB_C_TRACING_OVERHEAD_BENCHMARK_H
+#define ASYNCHRONOUSGRAB_C_TRACING_OVERHEAD_BENCHMARK_H
+
+#include <cstddef>
+#include <iosfwd>
+
+namespace VmbC
+{
+    namespace Examples
+    {
+        /**
+         * \brief Measures the cost of recording trace events and checks that
+         *        the overhead of the pipeline instrumentation stays below a
+         *        threshold at a given frame rate
+         */
+        class TracingOverheadBenchmark
+        {
+        public:
+            struct Settings
+            {
+                /**
+                 * \brief the number of events recorded for the measurement 
+                 */
+                size_t m_iterations { 10000000 };
+
+                /**
+                 * \brief the number of trace events recorded per frame by the
+                 *        instrumentation of the pipeline
+                 */
+                size_t m_eventsPerFrame { 8 };
+
+                /**
+                 * \brief the frame rate the overhead is calculated for 
+                 */
+                double m_framesPerSecond { 1000.0 };
+
+                /**
+                 * \brief the maximum overhead in percent of the frame period
+                 */
+                double m_maxOverheadPercent { 1.0 };
+            };
+
+            TracingOverheadBenchmark(Settings const& settings);
+
+            /**
+             * \return true, if the overhead is below the threshold 
+             */
+            bool Run(std::ostream& log);
+        private:
+            Settings m_settings;
+
+            /**
+             * \brief measure the average time in nanoseconds required for a
+             *        single trace scope
+             */
+            double MeasureScope(bool tracingEnabled) const;
+        };
+    }
+}
+
+#endif
@@ -0,0 +1,360 @@
+/**
+ * \date 2023
+ * \copyright Allied Vision Technologies.  All Rights Reserved.
+ *
+ * \copyright Redistribution of this file, in original or modified form, without
+ *            prior written consent of Allied Vision Technologies is prohibited.
+ *
+ * \warning THIS SOFTWARE IS PROVIDED BY THE AUTHOR "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF TITLE,
+ * NON-INFRINGEMENT, MERCHANTABILITY AND FITNESS FOR A PARTICULAR  PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \brief Implementation of ::VmbC::Examples::WorkQueueBenchmark
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <iomanip>
+#include <list>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "VmbException.h"
+#include "WorkQueueBenchmark.h"
+#include "WorkQueueServer.h"
+#include "WorkQueueWorker.h"
+
+namespace VmbC
+{
+    namespace Examples
+    {
+        namespace
+        {
+            using Clock = WorkQueueServer::Clock;
+
+            /**
+             * \brief time at the start of each step not included in the rate
+             */
+            constexpr std::chrono::milliseconds WarmupTime { 500 };
+
+            /**
+             * \brief time the workers may take to return the results pending
+             *        at the end of a step
+             */
+            constexpr std::chrono::milliseconds DrainTimeout { 2000 };
+
+            /**
+             * \brief the frames are offered this many times faster than the
+             *        workers are able to process them
+             */
+            constexpr double OverloadFactor = 1.5;
+
+            /**
+             * \brief the result returned by the workers
+             */
+            struct Result
+            {
+                VmbUint64_t m_frameId;
+
+                /**
+                 * \brief 1, if the markers of the frame were intact
+                 */
+                VmbUint32_t m_valid;
+                VmbUint32_t m_reserved;
+            };
+
+            /**
+             * \brief a worker started by the benchmark and the results of its
+             *        thread
+             */
+            struct Worker
+            {
+                std::thread m_thread;
+
+                /**
+                 * \brief set after the credits were granted
+                 */
+                std::atomic<bool> m_connected { false };
+
+                VmbUint64_t m_framesProcessed { 0 };
+                std::string m_error;
+            };
+
+            /**
+             * \brief checks the order and the content of the results
+             */
+            class ResultChecker : public WorkQueueServer::ResultSink
+            {
+            public:
+                void ResultReceived(VmbUint64_t const frameId, std::vector<unsigned char> const& data, bool const lost) override
+                {
+                    if (frameId <= m_lastFrameId)
+                    {
+                        ++m_orderErrors;
+                    }
+                    m_lastFrameId = frameId;
+
+                    Result result;
+                    if (lost)
+                    {
+                        ++m_lost;
+                    }
+                    else if (data.size() != sizeof(result))
+                    {
+                        ++m_contentErrors;
+                    }
+                    else
+                    {
+                        std::memcpy(&result, data.data(), sizeof(result));
+                        if (result.m_frameId != frameId || result.m_valid != 1)
+                        {
+                            ++m_contentErrors;
+                        }
+                    }
+                }
+
+                std::atomic<VmbUint64_t> m_lastFrameId { 0 };
+                std::atomic<VmbUint64_t> m_orderErrors { 0 };
+                std::atomic<VmbUint64_t> m_contentErrors { 0 };
+                std::atomic<VmbUint64_t> m_lost { 0 };
+            };
+
+            struct Step
+            {
+                unsigned m_workers { 0 };
+                double m_resultRate { 0.0 };
+                double m_efficiency { 0.0 };
+            };
+
+            /**
+             * \brief write the frame ID to the start, the middle and the end
+             *        of a frame buffer
+             */
+            void MarkFrame(std::vector<unsigned char>& buffer, VmbUint64_t const frameId) noexcept
+            {
+                size_t const size = sizeof(frameId);
+                std::memcpy(buffer.data(), &frameId, size);
+                std::memcpy(buffer.data() + (buffer.size() / 2 & ~(size - 1)), &frameId, size);
+                std::memcpy(buffer.data() + buffer.size() - size, &frameId, size);
+            }
+
+            bool CheckFrame(FrameStreamClient::Frame const& frame) noexcept
+            {
+                auto const& buffer = frame.m_buffer;
+                VmbUint64_t const frameId = frame.m_header.m_frameId;
+                size_t const size = sizeof(frameId);
+                return buffer.size() >= 2 * size
+                    && std::memcmp(buffer.data(), &frameId, size) == 0
+                    && std::memcmp(buffer.data() + (buffer.size() / 2 & ~(size - 1)), &frameId, size) == 0
+                    && std::memcmp(buffer.data() + buffer.size() - size, &frameId, size) == 0;
+            }
+
+            void Process(Worker& worker, VmbUint16_t const port, unsigned const credits,
+                         std::chrono::milliseconds const processingTime, std::atomic<bool> const& stop)
+            /* 工作线程：接收帧，检查标记，等待 processingTime 模拟处理算法，然后返回结果，直到 stop 被设置。 */
+            {
+                try
+                {
+                    WorkQueueWorker client("127.0.0.1", port, credits);
+                    worker.m_connected = true;
+                    FrameStreamClient::Frame frame;
+                    while (!stop)
+                    {
+                        if (!client.WaitForFrame(std::chrono::milliseconds(100)))
+                        {
+                            continue;
+                        }
+                        if (!client.ReadFrame(frame))
+                        {
+                            worker.m_error = "connection closed";
+                            break;
+                        }
+
+                        Result result {};
+                        result.m_frameId = frame.m_header.m_frameId;
+                        result.m_valid = CheckFrame(frame) ? 1 : 0;
+                        std::this_thread::sleep_for(processingTime);
+                        client.SendResult(result.m_frameId, &result, sizeof(result));
+                        ++worker.m_framesProcessed;
+                    }
+                }
+                catch (VmbException const& ex)
+                {
+                    worker.m_error = ex.what();
+                }
+                worker.m_connected = true;
+            }
+
+            void PrintStatistics(std::ostream& log, WorkQueueServer::Statistics const& statistics)
+            {
+                log << "  received " << statistics.m_framesReceived << "  dropped " << statistics.m_framesDropped
+                    << "  delivered " << statistics.m_resultsDelivered << "  lost " << statistics.m_framesLost << '\n';
+                for (auto const& worker : statistics.m_workers)
+                {
+                    log << "    " << std::left << std::setw(22) << worker.m_peer << std::right
+                        << " sent " << std::setw(5) << worker.m_framesSent
+                        << "  results " << std::setw(5) << worker.m_results
+                        << "  " << std::setw(6) << worker.m_resultRate << " /s"
+                        << "  turnaround " << std::chrono::duration<double, std::milli>(worker.m_averageTurnaround).count() << " ms\n";
+                }
+            }
+        }
+
+        WorkQueueBenchmark::WorkQueueBenchmark(Settings const& settings)
+            : m_settings(settings)
+        {
+        }
+
+        bool WorkQueueBenchmark::Run(std::ostream& log)
+        /* 对每个工作进程数量使用新的服务器：启动工作线程并等待它们授予信用，然后在当前线程中以超过总处理能力的帧率调用 FrameReceived。
+        结果速率在预热之后测量；结束时停止提供帧，等待未完成的结果交付，再检查顺序和内容。 */
+        {
+            if (m_settings.m_maxWorkers == 0 || m_settings.m_processingTime.count() <= 0)
+            {
+                throw VmbException("the number of workers and the processing time need to be positive", VmbErrorBadParameter);
+            }
+
+            double const workerRate = 1000.0 / static_cast<double>(m_settings.m_processingTime.count());
+            log << std::fixed << std::setprecision(1)
+                << "distributing " << m_settings.m_frameSize << " byte frames to 1.." << m_settings.m_maxWorkers
+                << " workers taking " << m_settings.m_processingTime.count() << " ms per frame with "
+                << m_settings.m_credits << " credits each\n";
+
+            std::vector<unsigned char> buffer((std::max)(m_settings.m_frameSize, size_t(64)));
+            VmbFrame_t frame;
+            std::memset(&frame, 0, sizeof(frame));
+            frame.buffer = buffer.data();
+            frame.bufferSize = static_cast<VmbUint32_t>(buffer.size());
+            frame.imageData = buffer.data();
+            frame.pixelFormat = VmbPixelFormatMono8;
+            frame.width = 1024;
+            frame.height = static_cast<VmbUint32_t>(buffer.size() / frame.width);
+            frame.receiveStatus = VmbFrameStatusComplete;
+
+            bool passed = true;
+            std::vector<Step> steps;
+            for (unsigned workerCount = 1; workerCount <= m_settings.m_maxWorkers; ++workerCount)
+            {
+                ResultChecker checker;
+                WorkQueueServer::Settings serverSettings;
+                serverSettings.m_port = 0;
+                WorkQueueServer server(serverSettings, &checker);
+
+                std::atomic<bool> stop { false };
+                std::list<Worker> workers;
+                for (unsigned i = 0; i != workerCount; ++i)
+                {
+                    workers.emplace_back();
+                    workers.back().m_thread = std::thread(Process, std::ref(workers.back()), server.GetPort(), m_settings.m_credits,
+                                                          m_settings.m_processingTime, std::cref(stop));
+                }
+                for (auto& worker : workers)
+                {
+                    while (!worker.m_connected)
+                    {
+                        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                    }
+                }
+                // wait until the server accepted all workers and received their credits
+                auto const connectDeadline = Clock::now() + DrainTimeout;
+                while (Clock::now() < connectDeadline)
+                {
+                    auto const statistics = server.GetStatistics();
+                    if (statistics.m_workers.size() == workerCount
+                        && std::all_of(statistics.m_workers.begin(), statistics.m_workers.end(),
+                                       [](WorkQueueServer::WorkerStatistics const& worker) { return worker.m_credits != 0; }))
+                    {
+                        break;
+                    }
+                    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+                }
+
+                auto const interval = std::chrono::duration_cast<Clock::duration>(
+                    std::chrono::duration<double>(1.0 / (OverloadFactor * workerRate * workerCount)));
+                auto const start = Clock::now();
+                auto const measureStart = start + WarmupTime;
+                auto const end = measureStart + m_settings.m_duration;
+                auto nextFrame = start;
+                bool measuring = false;
+                VmbUint64_t resultsAtStart = 0;
+                for (VmbUint64_t frameId = 1; nextFrame < end; ++frameId)
+                {
+                    std::this_thread::sleep_until(nextFrame);
+                    nextFrame += interval;
+                    if (!measuring && Clock::now() >= measureStart)
+                    {
+                        measuring = true;
+                        resultsAtStart = server.GetStatistics().m_resultsDelivered;
+                    }
+
+                    frame.frameID = frameId;
+                    frame.timestamp = static_cast<VmbUint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count());
+                    MarkFrame(buffer, frameId);
+                    server.FrameReceived(frame);
+                }
+                auto statistics = server.GetStatistics();
+                double const seconds = std::chrono::duration<double>(Clock::now() - measureStart).count();
+                VmbUint64_t const results = statistics.m_resultsDelivered - resultsAtStart;
+
+                auto const drainDeadline = Clock::now() + DrainTimeout;
+                while (statistics.m_pendingResults != 0 && Clock::now() < drainDeadline)
+                {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+                    statistics = server.GetStatistics();
+                }
+                stop = true;
+                for (auto& worker : workers)
+                {
+                    worker.m_thread.join();
+                }
+
+                Step step;
+                step.m_workers = workerCount;
+                step.m_resultRate = static_cast<double>(results) / seconds;
+                step.m_efficiency = steps.empty()
+                    ? 1.0
+                    : step.m_resultRate / (workerCount * steps.front().m_resultRate);
+                steps.push_back(step);
+
+                log << workerCount << " worker(s): " << step.m_resultRate << " results/s"
+                    << " (" << step.m_resultRate / (workerCount * workerRate) * 100.0 << " % of the worker capacity)"
+                    << "  efficiency " << step.m_efficiency * 100.0 << " %"
+                    << "  order errors " << checker.m_orderErrors
+                    << "  content errors " << checker.m_contentErrors << '\n';
+                PrintStatistics(log, statistics);
+
+                for (auto const& worker : workers)
+                {
+                    if (!worker.m_error.empty())
+                    {
+                        log << "  worker failed: " << worker.m_error << '\n';
+                        passed = false;
+                    }
+                }
+                if (checker.m_orderErrors != 0 || checker.m_contentErrors != 0 || checker.m_lost != 0
+                    || statistics.m_pendingResults != 0 || results == 0)
+                {
+                    log << "  results missing, lost, out of order or wrong\n";
+                    passed = false;
+                }
+                if (step.m_efficiency < m_settings.m_minEfficiency)
+                {
+                    log << "  scaling below " << m_settings.m_minEfficiency * 100.0 << " % of linear\n";
+                    passed = false;
+                }
+            }
+            log.unsetf(std::ios::floatfield);
+            return passed;
+        }
+    }
+}
@@ -0,0 +1,91 @@
+/**
+ * \date 2023
+ * \copyright Allied Vision Technologies.  All Rights Reserved.
+ *
+ * \copyright Redistribution of this file, in original or modified form, without
+ *            prior written consent of Allied Vision Technologies is prohibited.
+ *
+ * \warning THIS SOFTWARE IS PROVIDED BY THE AUTHOR "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF TITLE,
+ * NON-INFRINGEMENT, MERCHANTABILITY AND FITNESS FOR A PARTICULAR  PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \brief Definition of a benchmark distributing frames to a pool of workers
+ */
+
+#ifndef ASYNCHRONOUSGRAB_C_WORK_QUEUE_BENCHMARK_H
+#define ASYNCHRONOUSGRAB_C_WORK_QUEUE_BENCHMARK_H
+
+#include <chrono>
+#include <cstddef>
+#include <iosfwd>
+
+namespace VmbC
+{
+    namespace Examples
+    {
+        /**
+         * \brief Distributes synthetic frames via WorkQueueServer to 1 to
+         *        m_maxWorkers workers connected over the loopback interface
+         *        and measures the rate of results.
+         *
+         * The workers check the frame ID markers of every frame, wait
+         * m_processingTime to simulate an algorithm and return the frame ID
+         * and the outcome of the check as result. The frames are offered
+         * faster than the workers can process them, so the result rate is
+         * limited by the workers. The benchmark fails, if a result is
+         * delivered out of order, lost or wrong, or the rate with n workers
+         * is less than m_minEfficiency times n times the rate of a single
+         * worker.
+         */
+        class WorkQueueBenchmark
+        {
+        public:
+            struct Settings
+            {
+                unsigned m_maxWorkers { 4 };
+
+                /**
+                 * \brief the time a worker takes per frame
+                 */
+                std::chrono::milliseconds m_processingTime { 20 };
+
+                /**
+                 * \brief the number of frames a worker accepts at a time
+                 */
+                unsigned m_credits { 2 };
+
+                size_t m_frameSize { 256 << 10 };
+
+                /**
+                 * \brief the duration of the measurement per number of workers
+                 */
+                std::chrono::milliseconds m_duration { 3000 };
+
+                /**
+                 * \brief the minimum fraction of linear scaling
+                 */
+                double m_minEfficiency { 0.8 };
+            };
+
+            WorkQueueBenchmark(Settings const& settings);
+
+            /**
+             * \return true, if all results were delivered in order and the
+             *         result rate scaled with the number of workers
+             * \throws VmbException, if the server cannot be started
+             */
+            bool Run(std::ostream& log);
+        private:
+            Settings m_settings;
+        };
+    }
+}
+
+#endif
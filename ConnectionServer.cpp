@@ -0,0 +1,107 @@
+/**
+ * \date 2023
+ * \copyright Allied Vision Technologies.  All Rights Reserved.
+ *
+ * \copyright Redistribution of this file, in original or modified form, without
+ *            prior written consent of Allied Vision Technologies is prohibited.
+ *
+ * \warning THIS SOFTWARE IS PROVIDED BY THE AUTHOR "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF TITLE,
+ * NON-INFRINGEMENT, MERCHANTABILITY AND FITNESS FOR A PARTICULAR  PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \brief Implementation of ::VmbC::Examples::ConnectionServer
+ */
+
+#include <chrono>
+#include <functional>
+#include <utility>
+
+#include "ConnectionServer.h"
+#include "Tracing.h"
+
+namespace VmbC
+{
+    namespace Examples
+    {
+        namespace
+        {
+            /**
+             * \brief interval for checking, if the server should stop
+             */
+            constexpr std::chrono::milliseconds StopCheckInterval { 100 };
+        }
+
+        ConnectionServer::ConnectionServer(VmbUint16_t const port, Handler handler, char const* const threadName)
+            : m_handler(std::move(handler)),
+            m_threadName(threadName),
+            m_listenSocket(Socket::Listen(port)),
+            m_port(m_listenSocket.GetLocalPort()),
+            m_thread(&ConnectionServer::Serve, this)
+        /* 绑定本机端口并启动后台线程。m_thread 必须最后初始化，因为线程会立即使用其他成员。 */
+        {
+        }
+
+        ConnectionServer::~ConnectionServer()
+        {
+            m_stop = true;
+            m_thread.join();
+        }
+
+        void ConnectionServer::Serve()
+        /* 后台线程：以 StopCheckInterval 为间隔等待新连接。与HttpServer不同，连接可能一直保持，
+        因此每个连接由自己的线程服务；已关闭的连接的线程在这里回收，停止时等待所有连接的线程结束。 */
+        {
+            ASYNCHRONOUSGRAB_TRACE_THREAD_NAME(m_threadName);
+
+            while (!m_stop)
+            {
+                for (auto pos = m_connections.begin(); pos != m_connections.end();)
+                {
+                    if (pos->m_finished.load(std::memory_order_acquire))
+                    {
+                        pos->m_thread.join();
+                        pos = m_connections.erase(pos);
+                    }
+                    else
+                    {
+                        ++pos;
+                    }
+                }
+
+                if (!m_listenSocket.WaitReadable(StopCheckInterval))
+                {
+                    continue;
+                }
+
+                Socket socket = m_listenSocket.Accept();
+                if (socket.IsValid())
+                {
+                    m_connections.emplace_back();
+                    auto& connection = m_connections.back();
+                    connection.m_socket = std::move(socket);
+                    connection.m_thread = std::thread(&ConnectionServer::ServeConnection, this, std::ref(connection));
+                }
+            }
+
+            for (auto& connection : m_connections)
+            {
+                connection.m_thread.join();
+            }
+            m_connections.clear();
+        }
+
+        void ConnectionServer::ServeConnection(Connection& connection)
+        {
+            m_handler(connection.m_socket, m_stop);
+            connection.m_socket.Close();
+            connection.m_finished.store(true, std::memory_order_release);
+        }
+    }
+}
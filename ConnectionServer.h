@@ -0,0 +1,116 @@
+/**
+ * \date 2023
+ * \copyright Allied Vision Technologies.  All Rights Reserved.
+ *
+ * \copyright Redistribution of this file, in original or modified form, without
+ *            prior written consent of Allied Vision Technologies is prohibited.
+ *
+ * \warning THIS SOFTWARE IS PROVIDED BY THE AUTHOR "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF TITLE,
+ * NON-INFRINGEMENT, MERCHANTABILITY AND FITNESS FOR A PARTICULAR  PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \brief Definition of a TCP server serving each connection in its own thread
+ */
+
+#ifndef ASYNCHRONOUSGRAB_C_CONNECTION_SERVER_H
+#define ASYNCHRONOUSGRAB_C_CONNECTION_SERVER_H
+
+#include <atomic>
+#include <functional>
+#include <list>
+#include <thread>
+
+#include <VmbC/VmbC.h>
+
+#include "Socket.h"
+
+namespace VmbC
+{
+    namespace Examples
+    {
+        /**
+         * \brief TCP server accepting connections of the loopback interface
+         *        in a background thread and serving each of them in its own
+         *        thread.
+         *
+         * Unlike HttpServer the connections may stay open for a long time,
+         * e.g. control sessions or streams.
+         */
+        class ConnectionServer
+        {
+        public:
+            /**
+             * \brief function serving a connection until it is closed or
+             *        stop is set; called by the thread of the connection,
+             *        which closes the connection after it returns
+             */
+            using Handler = std::function<void(Socket const& connection, std::atomic<bool> const& stop)>;
+
+            /**
+             * \brief start listening on a port of the loopback interface
+             * \param[in] port the port to listen on; 0 chooses a free port
+             * \param[in] threadName the name of the background thread in
+             *                       traces
+             * \throws VmbException, if the port cannot be bound
+             */
+            ConnectionServer(VmbUint16_t port, Handler handler, char const* threadName);
+
+            /**
+             * \brief stops accepting connections, sets the stop flag passed
+             *        to the handlers and waits for all connections to be
+             *        served
+             */
+            ~ConnectionServer();
+
+            ConnectionServer(ConnectionServer const&) = delete;
+            ConnectionServer& operator=(ConnectionServer const&) = delete;
+
+            /**
+             * \brief get the port the server is listening on
+             */
+            VmbUint16_t GetPort() const noexcept
+            {
+                return m_port;
+            }
+        private:
+            struct Connection
+            {
+                Socket m_socket;
+                std::thread m_thread;
+                std::atomic<bool> m_finished { false };
+            };
+
+            Handler m_handler;
+            char const* m_threadName;
+
+            /**
+             * \brief the connections; only accessed by m_thread
+             */
+            std::list<Connection> m_connections;
+
+            Socket m_listenSocket;
+            VmbUint16_t m_port;
+            std::atomic<bool> m_stop { false };
+            std::thread m_thread;
+
+            /**
+             * \brief accept connections and join the threads of the closed ones
+             */
+            void Serve();
+
+            /**
+             * \brief the function of the thread of a connection
+             */
+            void ServeConnection(Connection& connection);
+        };
+    }
+}
+
+#endif
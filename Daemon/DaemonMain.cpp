@@ -0,0 +1,240 @@
+/**
+ * \date 2023
+ * \copyright Allied Vision Technologies.  All Rights Reserved.
+ *
+ * \copyright Redistribution of this file, in original or modified form, without
+ *            prior written consent of Allied Vision Technologies is prohibited.
+ *
+ * \warning THIS SOFTWARE IS PROVIDED BY THE AUTHOR "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF TITLE,
+ * NON-INFRINGEMENT, MERCHANTABILITY AND FITNESS FOR A PARTICULAR  PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \brief Entry point of the acquisition daemon of the AsynchronousGrab example
+ */
+
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+#include <VmbC/VmbC.h>
+
+#include "AcquisitionDaemon.h"
+#include "DaemonClient.h"
+#include "FrameMetadata.h"
+#include "VmbException.h"
+
+using VmbC::Examples::AcquisitionDaemon;
+using VmbC::Examples::AcquisitionManager;
+using VmbC::Examples::DaemonClient;
+using VmbC::Examples::MetadataAll;
+using VmbC::Examples::RawPipeSink;
+using VmbC::Examples::VmbException;
+
+namespace
+{
+    void PrintUsage()
+    {
+        std::cout
+            << "Usage: AsynchronousGrabDaemon [options]             run the daemon until SHUTDOWN or Ctrl+C\n"
+            << "       AsynchronousGrabDaemon [options] <request>   send a request to a running daemon\n"
+            << "\n"
+            << "Options:\n"
+            << "  --port <port>             control port on 127.0.0.1 (default " << AcquisitionDaemon::DefaultPort << ")\n"
+            << "  --shared-memory <name>    name of the shared memory the frames are exported to\n"
+            << "                            (default /AsynchronousGrabFrames)\n"
+            << "  --reader-timeout <ms>     time a client may hold a frame (default 1000)\n"
+            << "  --retain <frames>         most recent frames kept for the clients (default "
+            << AcquisitionDaemon::Settings().m_retainedFrames << ", at most " << AcquisitionManager::BufferCount - 2 << ")\n"
+            << "  --pipe <path>             write the frames to a named pipe, created if missing, or - for the\n"
+            << "                            standard output\n"
+            << "  --pipe-format <format>    raw (image data only) or framed (header per frame, default)\n"
+            << "  --pipe-pixel-format <pf>  convert to Mono8, Mono16, RGB8, BGR8, RGBA8 or BGRA8 before writing\n"
+            << "  --pipe-block              wait for the reader instead of dropping frames, if it falls behind\n"
+            << "  --chunk-metadata          activate the chunk mode and export exposure time, gain, line status,\n"
+            << "                            frame ID, timestamp and counter with every frame\n"
+            << "\n"
+            << "Requests:\n"
+            << "  cameras                   list the cameras\n"
+            << "  start <cameraId>          start the acquisition of a camera\n"
+            << "  status                    print the state and the counters of the acquisition\n"
+            << "  stop                      stop the acquisition for all clients\n"
+            << "  shutdown                  stop the acquisition and terminate the daemon\n";
+    }
+
+    struct PixelFormatName
+    {
+        char const* m_name;
+        VmbPixelFormat_t m_pixelFormat;
+    };
+
+    /**
+     * \brief the output pixel formats of the pipe
+     */
+    constexpr PixelFormatName PipePixelFormats[] = {
+        { "Mono8", VmbPixelFormatMono8 },
+        { "Mono16", VmbPixelFormatMono16 },
+        { "RGB8", VmbPixelFormatRgb8 },
+        { "BGR8", VmbPixelFormatBgr8 },
+        { "RGBA8", VmbPixelFormatRgba8 },
+        { "BGRA8", VmbPixelFormatBgra8 }
+    };
+
+    bool ParsePixelFormat(char const* name, VmbPixelFormat_t& pixelFormat)
+    {
+        for (auto const& entry : PipePixelFormats)
+        {
+            if (std::strcmp(entry.m_name, name) == 0)
+            {
+                pixelFormat = entry.m_pixelFormat;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    std::atomic<bool> g_interrupted { false };
+
+    void OnInterrupt(int)
+    {
+        g_interrupted = true;
+    }
+
+    int RunDaemon(AcquisitionDaemon::Settings const& settings)
+    {
+        AcquisitionDaemon daemon(settings);
+        // the standard output may carry the frames
+        std::ostream& log = (settings.m_pipe.m_path == "-") ? std::cerr : std::cout;
+        log << "Listening on 127.0.0.1:" << daemon.GetPort()
+            << ", exporting the frames to " << settings.m_sharedMemory.m_name << std::endl;
+
+        // leave the loop on Ctrl+C to remove the shared memory on the way out
+        std::signal(SIGINT, &OnInterrupt);
+        std::signal(SIGTERM, &OnInterrupt);
+        VmbUint32_t pipeWidth = 0;
+        VmbUint32_t pipeHeight = 0;
+        std::string pipeError;
+        while (!g_interrupted && !daemon.WaitForShutdown(std::chrono::milliseconds(200)))
+        {
+            // report the format of the frames, so a rawvideo reader can be set up
+            RawPipeSink::Statistics pipe;
+            if (daemon.GetPipeStatistics(pipe))
+            {
+                if (pipe.m_width != pipeWidth || pipe.m_height != pipeHeight)
+                {
+                    pipeWidth = pipe.m_width;
+                    pipeHeight = pipe.m_height;
+                    log << "Writing " << pipeWidth << "x" << pipeHeight << " frames of pixel format 0x"
+                        << std::hex << pipe.m_pixelFormat << std::dec << " to " << settings.m_pipe.m_path << std::endl;
+                }
+                if (pipe.m_error != pipeError)
+                {
+                    pipeError = pipe.m_error;
+                    log << pipeError << std::endl;
+                }
+            }
+        }
+        log << "Shutting down" << std::endl;
+        return EXIT_SUCCESS;
+    }
+
+    int SendRequest(VmbUint16_t const port, std::string request, char const* argument)
+    {
+        for (auto& c : request)
+        {
+            c = static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+        }
+        if (argument != nullptr)
+        {
+            request = request + " " + argument;
+        }
+
+        DaemonClient client(port);
+        std::cout << client.Request(request) << std::endl;
+        return EXIT_SUCCESS;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    AcquisitionDaemon::Settings settings;
+    char const* request = nullptr;
+    char const* argument = nullptr;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--port") == 0 && i + 1 < argc)
+        {
+            settings.m_port = static_cast<VmbUint16_t>(std::strtoul(argv[++i], nullptr, 10));
+        }
+        else if (std::strcmp(argv[i], "--shared-memory") == 0 && i + 1 < argc)
+        {
+            settings.m_sharedMemory.m_name = argv[++i];
+        }
+        else if (std::strcmp(argv[i], "--reader-timeout") == 0 && i + 1 < argc)
+        {
+            settings.m_sharedMemory.m_readerTimeout = std::chrono::milliseconds(std::strtoul(argv[++i], nullptr, 10));
+        }
+        else if (std::strcmp(argv[i], "--retain") == 0 && i + 1 < argc
+                 && std::strtoul(argv[i + 1], nullptr, 10) + 2 <= AcquisitionManager::BufferCount)
+        {
+            // the camera needs at least 2 buffers to fill while the others are retained
+            settings.m_retainedFrames = static_cast<VmbUint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        }
+        else if (std::strcmp(argv[i], "--pipe") == 0 && i + 1 < argc)
+        {
+            settings.m_pipe.m_path = argv[++i];
+        }
+        else if (std::strcmp(argv[i], "--pipe-format") == 0 && i + 1 < argc
+                 && (std::strcmp(argv[i + 1], "raw") == 0 || std::strcmp(argv[i + 1], "framed") == 0))
+        {
+            settings.m_pipe.m_format = (std::strcmp(argv[++i], "raw") == 0) ? RawPipeSink::Format::RawVideo : RawPipeSink::Format::Framed;
+        }
+        else if (std::strcmp(argv[i], "--pipe-pixel-format") == 0 && i + 1 < argc
+                 && ParsePixelFormat(argv[i + 1], settings.m_pipe.m_pixelFormat))
+        {
+            ++i;
+        }
+        else if (std::strcmp(argv[i], "--pipe-block") == 0)
+        {
+            settings.m_pipe.m_fullPolicy = RawPipeSink::FullPolicy::Block;
+        }
+        else if (std::strcmp(argv[i], "--chunk-metadata") == 0)
+        {
+            settings.m_chunkMetadata = MetadataAll;
+        }
+        else if (std::strncmp(argv[i], "--", 2) == 0)
+        {
+            PrintUsage();
+            return EXIT_FAILURE;
+        }
+        else if (request == nullptr)
+        {
+            request = argv[i];
+        }
+        else
+        {
+            argument = argv[i];
+        }
+    }
+
+    try
+    {
+        return (request == nullptr) ? RunDaemon(settings) : SendRequest(settings.m_port, request, argument);
+    }
+    catch (VmbException const& ex)
+    {
+        std::cerr << ex.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+}
@@ -0,0 +1,126 @@
+/**
+ * \date 2023
+ * \copyright Allied Vision Technologies.  All Rights Reserved.
+ *
+ * \copyright Redistribution of this file, in original or modified form, without
+ *            prior written consent of Allied Vision Technologies is prohibited.
+ *
+ * \warning THIS SOFTWARE IS PROVIDED BY THE AUTHOR "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF TITLE,
+ * NON-INFRINGEMENT, MERCHANTABILITY AND FITNESS FOR A PARTICULAR  PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \brief Implementation of ::VmbC::Examples::DaemonClient
+ */
+
+#include <chrono>
+#include <sstream>
+
+#include "DaemonClient.h"
+#include "VmbException.h"
+
+namespace VmbC
+{
+    namespace Examples
+    {
+        namespace
+        {
+            /**
+             * \brief time the daemon may take to reply; starting an
+             *        acquisition includes opening the camera
+             */
+            constexpr std::chrono::milliseconds ReplyTimeout { 30000 };
+        }
+
+        DaemonClient::DaemonClient(VmbUint16_t const port)
+            : m_connection(Socket::ConnectLocal(port))
+        {
+            m_connection.SetReceiveTimeout(ReplyTimeout);
+        }
+
+        std::vector<std::string> DaemonClient::GetCameras()
+        {
+            std::istringstream reply(Request("CAMERAS"));
+            std::vector<std::string> cameras;
+            std::string camera;
+            while (reply >> camera)
+            {
+                cameras.push_back(camera);
+            }
+            return cameras;
+        }
+
+        std::string DaemonClient::Start(std::string const& cameraId)
+        {
+            return Request("START " + cameraId);
+        }
+
+        std::string DaemonClient::Attach(std::string& cameraId)
+        {
+            std::istringstream reply(Request("ATTACH"));
+            std::string name;
+            reply >> name >> cameraId;
+            return name;
+        }
+
+        void DaemonClient::Stop()
+        {
+            Request("STOP");
+        }
+
+        std::string DaemonClient::GetStatus()
+        {
+            return Request("STATUS");
+        }
+
+        void DaemonClient::Shutdown()
+        {
+            Request("SHUTDOWN");
+        }
+
+        void DaemonClient::Detach()
+        {
+            Request("DETACH");
+        }
+
+        std::string DaemonClient::Request(std::string const& request)
+        /* 发送一行请求并读取一行回复；"OK"之后的内容作为结果返回，"ERROR"的消息作为异常抛出。 */
+        {
+            std::string const line = request + "\n";
+            if (!m_connection.SendAll(line.data(), line.size()))
+            {
+                throw VmbException("the connection to the acquisition daemon was lost");
+            }
+
+            size_t end;
+            char buffer[1024];
+            while ((end = m_received.find('\n')) == std::string::npos)
+            {
+                auto const received = m_connection.Receive(buffer, sizeof(buffer));
+                if (received <= 0)
+                {
+                    throw VmbException("the acquisition daemon did not reply to " + request);
+                }
+                m_received.append(buffer, static_cast<size_t>(received));
+            }
+            std::string reply = m_received.substr(0, end);
+            m_received.erase(0, end + 1);
+
+            if (reply.compare(0, 6, "ERROR ") == 0)
+            {
+                throw VmbException(reply.substr(6));
+            }
+            if (reply.compare(0, 2, "OK") != 0)
+            {
+                throw VmbException("unexpected reply of the acquisition daemon: " + reply);
+            }
+            return reply.size() > 3 ? reply.substr(3) : std::string();
+        }
+    }
+}
@@ -0,0 +1,109 @@
+/**
+ * \date 2023
+ * \copyright Allied Vision Technologies.  All Rights Reserved.
+ *
+ * \copyright Redistribution of this file, in original or modified form, without
+ *            prior written consent of Allied Vision Technologies is prohibited.
+ *
+ * \warning THIS SOFTWARE IS PROVIDED BY THE AUTHOR "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF TITLE,
+ * NON-INFRINGEMENT, MERCHANTABILITY AND FITNESS FOR A PARTICULAR  PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \brief Definition of the control connection to the acquisition daemon
+ */
+
+#ifndef ASYNCHRONOUSGRAB_C_DAEMON_CLIENT_H
+#define ASYNCHRONOUSGRAB_C_DAEMON_CLIENT_H
+
+#include <string>
+#include <vector>
+
+#include <VmbC/VmbC.h>
+
+#include "Socket.h"
+
+namespace VmbC
+{
+    namespace Examples
+    {
+        /**
+         * \brief Control connection to an AcquisitionDaemon of the local host.
+         *
+         * The client is attached to the acquisition of the daemon after a
+         * successful Start or Attach until Detach is called or the object is
+         * destroyed; the frames are read via RemoteCamera.
+         */
+        class DaemonClient
+        {
+        public:
+            /**
+             * \throws VmbException, if the daemon cannot be reached
+             */
+            DaemonClient(VmbUint16_t port);
+
+            DaemonClient(DaemonClient const&) = delete;
+            DaemonClient& operator=(DaemonClient const&) = delete;
+
+            /**
+             * \brief get the IDs of the cameras the daemon can open
+             */
+            std::vector<std::string> GetCameras();
+
+            /**
+             * \brief start the acquisition of a camera, if it is not running
+             *        yet, and attach to it
+             * \return the name of the shared memory the frames are exported to
+             */
+            std::string Start(std::string const& cameraId);
+
+            /**
+             * \brief attach to the running acquisition
+             * \param[out] cameraId the ID of the camera acquiring
+             * \return the name of the shared memory the frames are exported to
+             */
+            std::string Attach(std::string& cameraId);
+
+            /**
+             * \brief stop the acquisition, if no other client is attached
+             */
+            void Stop();
+
+            /**
+             * \brief get the state and the counters of the daemon as
+             *        space-separated key=value pairs
+             */
+            std::string GetStatus();
+
+            /**
+             * \brief stop the acquisition and terminate the daemon
+             */
+            void Shutdown();
+
+            void Detach();
+
+            /**
+             * \brief send a request line and read the reply
+             * \return the reply without the leading "OK"
+             * \throws VmbException, if the daemon replied with an error or
+             *                      the connection was lost
+             */
+            std::string Request(std::string const& request);
+        private:
+            Socket m_connection;
+
+            /**
+             * \brief data received after the last reply
+             */
+            std::string m_received;
+        };
+    }
+}
+
+#endif
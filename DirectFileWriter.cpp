@@ -0,0 +1,491 @@
+/**
+ * \date 2023
+ * \copyright Allied Vision Technologies.  All Rights Reserved.
+ *
+ * \copyright Redistribution of this file, in original or modified form, without
+ *            prior written consent of Allied Vision Technologies is prohibited.
+ *
+ * \warning THIS SOFTWARE IS PROVIDED BY THE AUTHOR "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF TITLE,
+ * NON-INFRINGEMENT, MERCHANTABILITY AND FITNESS FOR A PARTICULAR  PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \brief Implementation of ::VmbC::Examples::DirectFileWriter
+ */
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <vector>
+
+#include "AlignedBuffer.h"
+#include "DirectFileWriter.h"
+#include "VmbException.h"
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#define ASYNCHRONOUSGRAB_HAVE_IO_URING 1
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#endif
+#endif
+
+namespace VmbC
+{
+    namespace Examples
+    {
+#ifdef ASYNCHRONOUSGRAB_HAVE_IO_URING
+        /**
+         * \brief Minimal io_uring instance used via the raw system calls
+         *        submitting vectored writes
+         */
+        class DirectFileWriter::IoUring
+        {
+        public:
+            /**
+             * \return null, if io_uring is not supported by the kernel
+             */
+            static std::unique_ptr<IoUring> Create(unsigned entries) noexcept
+            {
+                std::unique_ptr<IoUring> result(new IoUring(entries));
+                if (!result->Setup(entries))
+                {
+                    result.reset();
+                }
+                return result;
+            }
+
+            ~IoUring()
+            {
+                if (m_sqes != MAP_FAILED)
+                {
+                    munmap(m_sqes, m_sqesSize);
+                }
+                if (m_cqRing != MAP_FAILED && m_cqRing != m_sqRing)
+                {
+                    munmap(m_cqRing, m_cqRingSize);
+                }
+                if (m_sqRing != MAP_FAILED)
+                {
+                    munmap(m_sqRing, m_sqRingSize);
+                }
+                if (m_fd >= 0)
+                {
+                    close(m_fd);
+                }
+            }
+
+            /**
+             * \brief submit a write; at most entries writes may be in flight
+             */
+            bool SubmitWrite(int file, void const* data, size_t size, VmbUint64_t offset, VmbUint64_t token) noexcept
+            {
+                unsigned const slot = m_freeSlots.back();
+                m_freeSlots.pop_back();
+                m_slots[slot] = Slot{ token, size };
+                m_iovecs[slot].iov_base = const_cast<void*>(data);
+                m_iovecs[slot].iov_len = size;
+
+                unsigned const tail = *m_sqTail; // only written by this thread
+                unsigned const index = tail & *m_sqMask;
+                io_uring_sqe& sqe = m_sqes[index];
+                std::memset(&sqe, 0, sizeof(sqe));
+                sqe.opcode = IORING_OP_WRITEV;
+                sqe.fd = file;
+                sqe.addr = reinterpret_cast<VmbUint64_t>(&m_iovecs[slot]);
+                sqe.len = 1;
+                sqe.off = offset;
+                sqe.user_data = slot;
+                m_sqArray[index] = index;
+                __atomic_store_n(m_sqTail, tail + 1, __ATOMIC_RELEASE);
+
+                int submitted;
+                do
+                {
+                    submitted = static_cast<int>(syscall(__NR_io_uring_enter, m_fd, 1, 0, 0, nullptr, 0));
+                } while (submitted < 0 && errno == EINTR);
+
+                if (submitted != 1)
+                {
+                    // take the entry back; the kernel did not consume it
+                    __atomic_store_n(m_sqTail, tail, __ATOMIC_RELEASE);
+                    m_freeSlots.push_back(slot);
+                    return false;
+                }
+                return true;
+            }
+
+            /**
+             * \brief get the next completion
+             * \return false, if wait is false and no write has finished or
+             *         waiting failed
+             */
+            bool Reap(bool wait, Completion& completion) noexcept
+            {
+                unsigned const head = *m_cqHead; // only written by this thread
+                unsigned tail = __atomic_load_n(m_cqTail, __ATOMIC_ACQUIRE);
+                while (head == tail)
+                {
+                    if (!wait)
+                    {
+                        return false;
+                    }
+                    if (syscall(__NR_io_uring_enter, m_fd, 0, 1, IORING_ENTER_GETEVENTS, nullptr, 0) < 0 && errno != EINTR)
+                    {
+                        return false;
+                    }
+                    tail = __atomic_load_n(m_cqTail, __ATOMIC_ACQUIRE);
+                }
+
+                io_uring_cqe const& cqe = m_cqes[head & *m_cqMask];
+                unsigned const slot = static_cast<unsigned>(cqe.user_data);
+                completion.m_token = m_slots[slot].m_token;
+                completion.m_success = (cqe.res >= 0) && (static_cast<size_t>(cqe.res) == m_slots[slot].m_size);
+                m_freeSlots.push_back(slot);
+                __atomic_store_n(m_cqHead, head + 1, __ATOMIC_RELEASE);
+                return true;
+            }
+
+            /**
+             * \brief report the writes in flight as failed
+             */
+            void Abandon(std::deque<Completion>& completions) const
+            {
+                std::vector<bool> free(m_slots.size(), false);
+                for (auto const slot : m_freeSlots)
+                {
+                    free[slot] = true;
+                }
+                for (size_t slot = 0; slot != m_slots.size(); ++slot)
+                {
+                    if (!free[slot])
+                    {
+                        completions.push_back(Completion{ m_slots[slot].m_token, false });
+                    }
+                }
+            }
+        private:
+            struct Slot
+            {
+                VmbUint64_t m_token;
+                size_t m_size;
+            };
+
+            int m_fd { -1 };
+            void* m_sqRing { MAP_FAILED };
+            size_t m_sqRingSize { 0 };
+            void* m_cqRing { MAP_FAILED };
+            size_t m_cqRingSize { 0 };
+            io_uring_sqe* m_sqes { static_cast<io_uring_sqe*>(MAP_FAILED) };
+            size_t m_sqesSize { 0 };
+
+            unsigned* m_sqTail { nullptr };
+            unsigned* m_sqMask { nullptr };
+            unsigned* m_sqArray { nullptr };
+            unsigned* m_cqHead { nullptr };
+            unsigned* m_cqTail { nullptr };
+            unsigned* m_cqMask { nullptr };
+            io_uring_cqe* m_cqes { nullptr };
+
+            /**
+             * \brief io vectors referenced by the submitted writes; one per slot
+             */
+            std::vector<iovec> m_iovecs;
+            std::vector<Slot> m_slots;
+            std::vector<unsigned> m_freeSlots;
+
+            IoUring(unsigned entries)
+                : m_iovecs(entries),
+                m_slots(entries)
+            {
+                m_freeSlots.reserve(entries);
+                for (unsigned slot = entries; slot != 0; --slot)
+                {
+                    m_freeSlots.push_back(slot - 1);
+                }
+            }
+
+            /**
+             * \brief create the io_uring instance and map its rings
+             */
+            bool Setup(unsigned entries) noexcept
+            /* 通过系统调用创建 io_uring 并映射提交队列、完成队列和SQE数组。
+            内核不支持 io_uring（或被安全策略禁止）时返回false，调用者改用同步的 pwrite。 */
+            {
+                io_uring_params params;
+                std::memset(&params, 0, sizeof(params));
+                m_fd = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+                if (m_fd < 0)
+                {
+                    return false;
+                }
+
+                m_sqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+                m_cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+                bool const singleMapping = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+                if (singleMapping)
+                {
+                    m_sqRingSize = (std::max)(m_sqRingSize, m_cqRingSize);
+                }
+
+                m_sqRing = mmap(nullptr, m_sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_fd, IORING_OFF_SQ_RING);
+                if (m_sqRing == MAP_FAILED)
+                {
+                    return false;
+                }
+                m_cqRing = singleMapping ? m_sqRing
+                                         : mmap(nullptr, m_cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_fd, IORING_OFF_CQ_RING);
+                if (m_cqRing == MAP_FAILED)
+                {
+                    return false;
+                }
+                m_sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+                m_sqes = static_cast<io_uring_sqe*>(mmap(nullptr, m_sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_fd, IORING_OFF_SQES));
+                if (m_sqes == MAP_FAILED)
+                {
+                    return false;
+                }
+
+                auto const sqRing = static_cast<unsigned char*>(m_sqRing);
+                auto const cqRing = static_cast<unsigned char*>(m_cqRing);
+                m_sqTail = reinterpret_cast<unsigned*>(sqRing + params.sq_off.tail);
+                m_sqMask = reinterpret_cast<unsigned*>(sqRing + params.sq_off.ring_mask);
+                m_sqArray = reinterpret_cast<unsigned*>(sqRing + params.sq_off.array);
+                m_cqHead = reinterpret_cast<unsigned*>(cqRing + params.cq_off.head);
+                m_cqTail = reinterpret_cast<unsigned*>(cqRing + params.cq_off.tail);
+                m_cqMask = reinterpret_cast<unsigned*>(cqRing + params.cq_off.ring_mask);
+                m_cqes = reinterpret_cast<io_uring_cqe*>(cqRing + params.cq_off.cqes);
+                return true;
+            }
+        };
+#else
+        /**
+         * \brief placeholder for systems without io_uring
+         */
+        class DirectFileWriter::IoUring
+        {
+        public:
+            static std::unique_ptr<IoUring> Create(unsigned) noexcept
+            {
+                return nullptr;
+            }
+
+            template<typename File>
+            bool SubmitWrite(File, void const*, size_t, VmbUint64_t, VmbUint64_t) noexcept
+            {
+                return false;
+            }
+
+            bool Reap(bool, Completion&) noexcept
+            {
+                return false;
+            }
+
+            void Abandon(std::deque<Completion>&) const
+            {
+            }
+        };
+#endif
+
+        DirectFileWriter::DirectFileWriter(std::string const& fileName, VmbUint64_t const preallocationSize, unsigned const queueDepth)
+            : m_queueDepth((std::max)(queueDepth, 1u)),
+            m_preallocationSize(AlignedBuffer::AlignUp(static_cast<size_t>((std::max)(preallocationSize, VmbUint64_t(Alignment))), Alignment))
+        /* 创建文件并尽量绕过页缓存（O_DIRECT / FILE_FLAG_NO_BUFFERING）；
+        文件系统不支持时（例如tmpfs）退回普通的写入方式。
+        在Linux上尝试创建io_uring，使多个写操作可以同时进行。 */
+        {
+#ifdef _WIN32
+            m_file = CreateFileA(fileName.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS,
+                                 FILE_ATTRIBUTE_NORMAL | FILE_FLAG_NO_BUFFERING | FILE_FLAG_WRITE_THROUGH, nullptr);
+            m_directIo = true;
+            if (m_file == INVALID_HANDLE_VALUE)
+            {
+                throw VmbException("unable to create " + fileName);
+            }
+#else
+            m_file = open(fileName.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC | O_DIRECT, 0644);
+            m_directIo = (m_file >= 0);
+            if (m_file < 0 && errno == EINVAL)
+            {
+                // the file system does not support O_DIRECT
+                m_file = open(fileName.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+            }
+            if (m_file < 0)
+            {
+                throw VmbException("unable to create " + fileName + ": " + std::strerror(errno));
+            }
+            m_ioUring = IoUring::Create(m_queueDepth);
+#endif
+            Preallocate(m_preallocationSize);
+        }
+
+        DirectFileWriter::~DirectFileWriter()
+        {
+            while (m_inFlight != 0)
+            {
+                Reap(true);
+            }
+            m_ioUring.reset();
+#ifdef _WIN32
+            CloseHandle(m_file);
+#else
+            close(m_file);
+#endif
+        }
+
+        bool DirectFileWriter::UsesIoUring() const noexcept
+        {
+            return static_cast<bool>(m_ioUring);
+        }
+
+        void DirectFileWriter::Preallocate(VmbUint64_t const end) noexcept
+        /* 按 m_preallocationSize 的步长预先为文件分配空间，避免写入时文件系统逐块分配。
+        不支持预分配的文件系统上忽略错误，文件随写入自动增长。 */
+        {
+            if (end <= m_allocatedSize)
+            {
+                return;
+            }
+            VmbUint64_t const newSize = (end + m_preallocationSize - 1) / m_preallocationSize * m_preallocationSize;
+#ifdef _WIN32
+            LARGE_INTEGER size;
+            size.QuadPart = static_cast<LONGLONG>(newSize);
+            if (SetFilePointerEx(m_file, size, nullptr, FILE_BEGIN))
+            {
+                SetEndOfFile(m_file);
+            }
+#else
+            fallocate(m_file, 0, static_cast<off_t>(m_allocatedSize), static_cast<off_t>(newSize - m_allocatedSize));
+#endif
+            m_allocatedSize = newSize;
+        }
+
+        void DirectFileWriter::Write(void const* const data, size_t const size, VmbUint64_t const offset, VmbUint64_t const token)
+        {
+            Preallocate(offset + size);
+
+            while (m_ioUring && m_inFlight >= m_queueDepth)
+            {
+                Reap(true);
+            }
+            if (m_ioUring)
+            {
+                if (m_ioUring->SubmitWrite(m_file, data, size, offset, token))
+                {
+                    ++m_inFlight;
+                }
+                else
+                {
+                    m_completions.push_back(Completion{ token, false });
+                }
+                return;
+            }
+
+            // synchronous fallback
+            auto pos = static_cast<char const*>(data);
+            size_t remaining = size;
+            VmbUint64_t fileOffset = offset;
+            while (remaining != 0)
+            {
+#ifdef _WIN32
+                OVERLAPPED overlapped {};
+                overlapped.Offset = static_cast<DWORD>(fileOffset);
+                overlapped.OffsetHigh = static_cast<DWORD>(fileOffset >> 32);
+                DWORD written = 0;
+                if (!WriteFile(m_file, pos, static_cast<DWORD>(remaining), &written, &overlapped) || written == 0)
+                {
+                    break;
+                }
+#else
+                ssize_t const written = pwrite(m_file, pos, remaining, static_cast<off_t>(fileOffset));
+                if (written < 0 && errno == EINTR)
+                {
+                    continue;
+                }
+                if (written <= 0)
+                {
+                    break;
+                }
+#endif
+                pos += written;
+                fileOffset += written;
+                remaining -= static_cast<size_t>(written);
+            }
+            m_completions.push_back(Completion{ token, remaining == 0 });
+        }
+
+        void DirectFileWriter::Reap(bool const wait)
+        /* io_uring_enter 失败时不再等待：正在进行的写操作报告为失败，关闭 io_uring，之后的写操作使用同步的 pwrite，
+        并记录错误由 Finish 报告；否则析构函数和 Finish 中等待写操作完成的循环不会结束。 */
+        {
+            if (m_inFlight == 0)
+            {
+                return;
+            }
+            Completion completion;
+            if (m_ioUring->Reap(wait, completion))
+            {
+                --m_inFlight;
+                m_completions.push_back(completion);
+            }
+            else if (wait)
+            {
+                m_ioUring->Abandon(m_completions);
+                m_ioUring.reset();
+                m_inFlight = 0;
+                m_writeFailed = true;
+            }
+        }
+
+        bool DirectFileWriter::PopCompletion(Completion& completion, bool const wait)
+        {
+            if (m_completions.empty())
+            {
+                Reap(wait);
+                if (m_completions.empty())
+                {
+                    return false;
+                }
+            }
+            completion = m_completions.front();
+            m_completions.pop_front();
+            return true;
+        }
+
+        bool DirectFileWriter::Finish(VmbUint64_t const fileSize)
+        /* 等待所有写操作完成，然后把文件截断为实际写入的大小（去掉预分配但未使用的空间）并刷新到磁盘。 */
+        {
+            while (m_inFlight != 0)
+            {
+                Reap(true);
+            }
+#ifdef _WIN32
+            LARGE_INTEGER size;
+            size.QuadPart = static_cast<LONGLONG>(fileSize);
+            bool const finished = SetFilePointerEx(m_file, size, nullptr, FILE_BEGIN)
+                && SetEndOfFile(m_file)
+                && FlushFileBuffers(m_file);
+#else
+            bool const finished = ftruncate(m_file, static_cast<off_t>(fileSize)) == 0
+                && fdatasync(m_file) == 0;
+#endif
+            return finished && !m_writeFailed;
+        }
+    }
+}
@@ -0,0 +1,180 @@
+/**
+ * \date 2023
+ * \copyright Allied Vision Technologies.  All Rights Reserved.
+ *
+ * \copyright Redistribution of this file, in original or modified form, without
+ *            prior written consent of Allied Vision Technologies is prohibited.
+ *
+ * \warning THIS SOFTWARE IS PROVIDED BY THE AUTHOR "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF TITLE,
+ * NON-INFRINGEMENT, MERCHANTABILITY AND FITNESS FOR A PARTICULAR  PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \brief Definition of a writer for unbuffered, preallocated files
+ */
+
+#ifndef ASYNCHRONOUSGRAB_C_DIRECT_FILE_WRITER_H
+#define ASYNCHRONOUSGRAB_C_DIRECT_FILE_WRITER_H
+
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <string>
+
+#include <VmbC/VmbC.h>
+
+namespace VmbC
+{
+    namespace Examples
+    {
+        /**
+         * \brief Writes aligned blocks to a preallocated file bypassing the
+         *        page cache.
+         *
+         * On Linux the writes are submitted via io_uring with up to a given
+         * number of writes in flight; if io_uring is not available, the
+         * writes are executed synchronously via pwrite. The file is opened
+         * with O_DIRECT (FILE_FLAG_NO_BUFFERING on Windows), if the file
+         * system supports it.
+         *
+         * Data, sizes and offsets passed to Write need to be multiples of
+         * Alignment. The buffers must not be modified until the completion
+         * of the write was reported. The object must only be used by a
+         * single thread.
+         */
+        class DirectFileWriter
+        {
+        public:
+            static constexpr size_t Alignment = 4096;
+
+            struct Completion
+            {
+                /**
+                 * \brief the value passed to Write
+                 */
+                VmbUint64_t m_token;
+
+                /**
+                 * \brief false, if the data was not written completely
+                 */
+                bool m_success;
+            };
+
+            /**
+             * \param[in] fileName the file to create; an existing file is overwritten
+             * \param[in] preallocationSize the size of the space reserved for
+             *                              the file in advance and the
+             *                              increment used to extend it
+             * \param[in] queueDepth the maximum number of writes in flight
+             * \throws VmbException, if the file cannot be created
+             */
+            DirectFileWriter(std::string const& fileName, VmbUint64_t preallocationSize, unsigned queueDepth);
+
+            /**
+             * \brief waits for all writes and closes the file without truncating it
+             */
+            ~DirectFileWriter();
+
+            DirectFileWriter(DirectFileWriter const&) = delete;
+            DirectFileWriter& operator=(DirectFileWriter const&) = delete;
+
+            /**
+             * \brief start writing data to a given offset of the file; blocks
+             *        while the maximum number of writes is in flight
+             * \param[in] token a value identifying the write in the completion
+             */
+            void Write(void const* data, size_t size, VmbUint64_t offset, VmbUint64_t token);
+
+            /**
+             * \brief get the completion of a finished write
+             * \param[in] wait if true, block until a write finishes, if writes are in flight
+             * \return false, if no completion is available
+             */
+            bool PopCompletion(Completion& completion, bool wait);
+
+            /**
+             * \brief get the number of writes submitted that were not returned
+             *        by PopCompletion yet
+             */
+            size_t GetPendingCount() const noexcept
+            {
+                return m_inFlight + m_completions.size();
+            }
+
+            /**
+             * \brief wait for all writes and set the final size of the file,
+             *        removing the unused preallocated space
+             * \return false, if the file could not be truncated or waiting
+             *         for the io_uring writes failed
+             */
+            bool Finish(VmbUint64_t fileSize);
+
+            /**
+             * \return true, if the writes are submitted via io_uring
+             */
+            bool UsesIoUring() const noexcept;
+
+            /**
+             * \return true, if the file bypasses the page cache
+             */
+            bool UsesDirectIo() const noexcept
+            {
+                return m_directIo;
+            }
+        private:
+            class IoUring;
+
+#ifdef _WIN32
+            void* m_file;
+#else
+            int m_file;
+#endif
+            bool m_directIo { false };
+            unsigned m_queueDepth;
+            VmbUint64_t m_preallocationSize;
+
+            /**
+             * \brief the size of the space allocated for the file so far
+             */
+            VmbUint64_t m_allocatedSize { 0 };
+
+            /**
+             * \brief the number of io_uring writes submitted but not reaped yet
+             */
+            size_t m_inFlight { 0 };
+
+            /**
+             * \brief set, if waiting for the io_uring writes failed; the
+             *        writes in flight were reported as failed
+             */
+            bool m_writeFailed { false };
+
+            std::unique_ptr<IoUring> m_ioUring;
+
+            /**
+             * \brief completions reaped but not yet returned by PopCompletion
+             */
+            std::deque<Completion> m_completions;
+
+            /**
+             * \brief reserve space for the file, if a write ends after the
+             *        allocated space
+             */
+            void Preallocate(VmbUint64_t end) noexcept;
+
+            /**
+             * \brief move completions from the completion queue of io_uring to
+             *        m_completions
+             */
+            void Reap(bool wait);
+        };
+    }
+}
+
+#endif
@@ -0,0 +1,75 @@
+/**
+ * \date 2023
+ * \copyright Allied Vision Technologies.  All Rights Reserved.
+ *
+ * \copyright Redistribution of this file, in original or modified form, without
+ *            prior written consent of Allied Vision Technologies is prohibited.
+ *
+ * \warning THIS SOFTWARE IS PROVIDED BY THE AUTHOR "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF TITLE,
+ * NON-INFRINGEMENT, MERCHANTABILITY AND FITNESS FOR A PARTICULAR  PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \brief Implementation of the copy of frames to the slot buffers of the sinks
+ */
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+
+#include "AlignedBuffer.h"
+#include "FrameCopy.h"
+#include "FrameMetadata.h"
+#include "VmbException.h"
+
+namespace VmbC
+{
+    namespace Examples
+    {
+        bool CopyToSlot(AlignedBuffer& buffer, void const* const data, size_t const size) noexcept
+        /* 分配失败时旧的缓冲区已被释放，调用者按丢帧处理。 */
+        {
+            try
+            {
+                if (buffer.GetSize() < size)
+                {
+                    buffer = AlignedBuffer();
+                    buffer = AlignedBuffer(size, SlotAlignment);
+                }
+            }
+            catch (VmbException const&)
+            {
+                return false;
+            }
+            std::memcpy(buffer.GetData(), data, size);
+            return true;
+        }
+
+        bool CopyFrameToSlot(VmbFrame_t const& frame, AlignedBuffer& buffer, VmbFrame_t& copy, FrameMetadata& metadata) noexcept
+        {
+            if (!CopyToSlot(buffer, frame.buffer, frame.bufferSize))
+            {
+                return false;
+            }
+            copy = frame;
+            copy.buffer = buffer.GetData();
+            copy.imageData = (frame.imageData == nullptr)
+                ? nullptr
+                : buffer.GetData() + (frame.imageData - static_cast<VmbUint8_t const*>(frame.buffer));
+            std::fill(std::begin(copy.context), std::end(copy.context), nullptr);
+            auto const frameMetadata = GetFrameMetadata(frame);
+            if (frameMetadata != nullptr)
+            {
+                metadata = *frameMetadata;
+                SetFrameMetadata(copy, &metadata);
+            }
+            return true;
+        }
+    }
+}
@@ -0,0 +1,62 @@
+/**
+ * \date 2023
+ * \copyright Allied Vision Technologies.  All Rights Reserved.
+ *
+ * \copyright Redistribution of this file, in original or modified form, without
+ *            prior written consent of Allied Vision Technologies is prohibited.
+ *
+ * \warning THIS SOFTWARE IS PROVIDED BY THE AUTHOR "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF TITLE,
+ * NON-INFRINGEMENT, MERCHANTABILITY AND FITNESS FOR A PARTICULAR  PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \brief Definition of the copy of frames to the slot buffers of the sinks
+ */
+
+#ifndef ASYNCHRONOUSGRAB_C_FRAME_COPY_H
+#define ASYNCHRONOUSGRAB_C_FRAME_COPY_H
+
+#include <cstddef>
+
+#include <VmbC/VmbC.h>
+
+namespace VmbC
+{
+    namespace Examples
+    {
+        class AlignedBuffer;
+        struct FrameMetadata;
+
+        /**
+         * \brief the alignment of the slot buffers the sinks copy frames to
+         *        in the frame callback; MSG_ZEROCOPY and vmsplice pin whole
+         *        pages
+         */
+        constexpr size_t SlotAlignment = 4096;
+
+        /**
+         * \brief copy data to a slot buffer; a buffer smaller than size is
+         *        replaced by one aligned to SlotAlignment
+         * \return false, if the memory cannot be allocated; the buffer is
+         *         empty then
+         */
+        bool CopyToSlot(AlignedBuffer& buffer, void const* data, size_t size) noexcept;
+
+        /**
+         * \brief copy the buffer of a frame to a slot buffer and set copy to
+         *        the frame with buffer and imageData pointing into the slot
+         *        buffer, the context cleared and the FrameMetadata of the
+         *        frame, if any, copied to metadata
+         * \return false, if the memory cannot be allocated
+         */
+        bool CopyFrameToSlot(VmbFrame_t const& frame, AlignedBuffer& buffer, VmbFrame_t& copy, FrameMetadata& metadata) noexcept;
+    }
+}
+
+#endif
@@ -0,0 +1,167 @@
+/**
+ * \date 2023
+ * \copyright Allied Vision Technologies.  All Rights Reserved.
+ *
+ * \copyright Redistribution of this file, in original or modified form, without
+ *            prior written consent of Allied Vision Technologies is prohibited.
+ *
+ * \warning THIS SOFTWARE IS PROVIDED BY THE AUTHOR "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF TITLE,
+ * NON-INFRINGEMENT, MERCHANTABILITY AND FITNESS FOR A PARTICULAR  PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \brief Implementation of the functions reading ::VmbC::Examples::FrameMetadata from chunk data
+ */
+
+#include "FrameMetadata.h"
+
+namespace VmbC
+{
+    namespace Examples
+    {
+        namespace
+        {
+            /**
+             * \brief a chunk of the SFNC the metadata is read from
+             */
+            struct Chunk
+            {
+                MetadataField m_field;
+
+                /**
+                 * \brief the value of ChunkSelector enabling the chunk
+                 */
+                char const* m_selector;
+
+                /**
+                 * \brief the feature providing the value of the chunk
+                 */
+                char const* m_feature;
+                bool m_isFloat;
+            };
+
+            constexpr Chunk Chunks[] =
+            {
+                { MetadataExposureTime, "ExposureTime", "ChunkExposureTime", true },
+                { MetadataGain, "Gain", "ChunkGain", true },
+                { MetadataLineStatus, "LineStatusAll", "ChunkLineStatusAll", false },
+                { MetadataFrameId, "FrameID", "ChunkFrameID", false },
+                { MetadataTimestamp, "Timestamp", "ChunkTimestamp", false },
+                { MetadataCounter, "CounterValue", "ChunkCounterValue", false }
+            };
+
+            struct ChunkReadContext
+            {
+                VmbUint32_t m_fields;
+                FrameMetadata* m_metadata;
+            };
+
+            VmbError_t VMB_CALL ReadChunks(VmbHandle_t const featureAccessHandle, void* const userContext)
+            /* 在VmbChunkDataAccess中调用：句柄只访问这一帧的块数据，读取不经过相机。单个块读取失败时只清除其标志。 */
+            {
+                auto const& context = *static_cast<ChunkReadContext const*>(userContext);
+                FrameMetadata& metadata = *context.m_metadata;
+                for (auto const& chunk : Chunks)
+                {
+                    if ((context.m_fields & chunk.m_field) == 0)
+                    {
+                        continue;
+                    }
+
+                    VmbError_t error;
+                    VmbInt64_t value = 0;
+                    double floatValue = 0.0;
+                    if (chunk.m_isFloat)
+                    {
+                        error = VmbFeatureFloatGet(featureAccessHandle, chunk.m_feature, &floatValue);
+                    }
+                    else
+                    {
+                        error = VmbFeatureIntGet(featureAccessHandle, chunk.m_feature, &value);
+                    }
+                    if (error != VmbErrorSuccess)
+                    {
+                        continue;
+                    }
+
+                    switch (chunk.m_field)
+                    {
+                    case MetadataExposureTime:
+                        metadata.m_exposureTime = floatValue;
+                        break;
+                    case MetadataGain:
+                        metadata.m_gain = floatValue;
+                        break;
+                    case MetadataLineStatus:
+                        metadata.m_lineStatus = value;
+                        break;
+                    case MetadataFrameId:
+                        metadata.m_frameId = static_cast<VmbUint64_t>(value);
+                        break;
+                    case MetadataTimestamp:
+                        metadata.m_timestamp = static_cast<VmbUint64_t>(value);
+                        break;
+                    default:
+                        metadata.m_counter = value;
+                        break;
+                    }
+                    metadata.m_fields |= chunk.m_field;
+                }
+                return VmbErrorSuccess;
+            }
+        }
+
+        VmbUint32_t EnableChunkMetadata(VmbHandle_t const cameraHandle, VmbUint32_t const fields) noexcept
+        /* 有些相机只在块模式启用后才提供 ChunkSelector 和 ChunkEnable，因此先启用块模式再逐个选择块。
+        相机不支持的块跳过；一个块都不能启用时关闭块模式，负载大小保持不变。 */
+        {
+            if (fields == 0 || VmbFeatureBoolSet(cameraHandle, "ChunkModeActive", VmbBoolTrue) != VmbErrorSuccess)
+            {
+                return 0;
+            }
+
+            VmbUint32_t enabled = 0;
+            for (auto const& chunk : Chunks)
+            {
+                if ((fields & chunk.m_field) != 0
+                    && VmbFeatureEnumSet(cameraHandle, "ChunkSelector", chunk.m_selector) == VmbErrorSuccess
+                    && VmbFeatureBoolSet(cameraHandle, "ChunkEnable", VmbBoolTrue) == VmbErrorSuccess)
+                {
+                    enabled |= chunk.m_field;
+                }
+            }
+            if (enabled == 0)
+            {
+                DisableChunkMetadata(cameraHandle);
+            }
+            return enabled;
+        }
+
+        void DisableChunkMetadata(VmbHandle_t const cameraHandle) noexcept
+        {
+            VmbFeatureBoolSet(cameraHandle, "ChunkModeActive", VmbBoolFalse);
+        }
+
+        bool ReadChunkMetadata(VmbFrame_t const& frame, VmbUint32_t const fields, FrameMetadata& metadata) noexcept
+        {
+            metadata = FrameMetadata {};
+            if (!frame.chunkDataPresent || fields == 0)
+            {
+                return false;
+            }
+            ChunkReadContext context { fields, &metadata };
+            if (VmbChunkDataAccess(&frame, &ReadChunks, &context) != VmbErrorSuccess)
+            {
+                metadata.m_fields = 0;
+                return false;
+            }
+            return metadata.m_fields != 0;
+        }
+    }
+}
@@ -0,0 +1,144 @@
+/**
+ * \date 2023
+ * \copyright Allied Vision Technologies.  All Rights Reserved.
+ *
+ * \copyright Redistribution of this file, in original or modified form, without
+ *            prior written consent of Allied Vision Technologies is prohibited.
+ *
+ * \warning THIS SOFTWARE IS PROVIDED BY THE AUTHOR "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF TITLE,
+ * NON-INFRINGEMENT, MERCHANTABILITY AND FITNESS FOR A PARTICULAR  PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \brief Definition of the metadata read from the chunk data of the frames
+ */
+
+#ifndef ASYNCHRONOUSGRAB_C_FRAME_METADATA_H
+#define ASYNCHRONOUSGRAB_C_FRAME_METADATA_H
+
+#include <cstddef>
+
+#include <VmbC/VmbC.h>
+
+namespace VmbC
+{
+    namespace Examples
+    {
+        /**
+         * \brief bits of FrameMetadata::m_fields
+         */
+        enum MetadataField : VmbUint32_t
+        {
+            /**
+             * \brief ChunkExposureTime in microseconds
+             */
+            MetadataExposureTime = 1,
+
+            /**
+             * \brief ChunkGain in dB
+             */
+            MetadataGain = 2,
+
+            /**
+             * \brief ChunkLineStatusAll, one bit per line
+             */
+            MetadataLineStatus = 4,
+
+            /**
+             * \brief ChunkFrameID of the camera
+             */
+            MetadataFrameId = 8,
+
+            /**
+             * \brief ChunkTimestamp of the camera
+             */
+            MetadataTimestamp = 16,
+
+            /**
+             * \brief ChunkCounterValue, e.g. a counter of the trigger signals
+             */
+            MetadataCounter = 32,
+
+            MetadataAll = 63
+        };
+
+        /**
+         * \brief The state of the camera at the capture of a frame, read from
+         *        the chunk data of the frame.
+         *
+         * The record is filled once per frame by AcquisitionManager before
+         * the frame is passed to any sink and stored next to the frame;
+         * GetFrameMetadata finds it via the frame. Only the members flagged
+         * in m_fields are valid. The layout is stored in recordings and in
+         * the shared memory export.
+         */
+        struct FrameMetadata
+        {
+            /**
+             * \brief the valid members; MetadataField bits
+             */
+            VmbUint32_t m_fields;
+            VmbUint32_t m_reserved;
+            double m_exposureTime;
+            double m_gain;
+            VmbInt64_t m_lineStatus;
+            VmbUint64_t m_frameId;
+            VmbUint64_t m_timestamp;
+            VmbInt64_t m_counter;
+        };
+
+        static_assert(sizeof(FrameMetadata) == 56, "unexpected padding of the frame metadata");
+
+        /**
+         * \brief the index of the frame context entry pointing to the
+         *        FrameMetadata of the frame; null for frames without metadata,
+         *        e.g. copies kept by a sink
+         */
+        constexpr size_t FrameMetadataContextIndex = 3;
+
+        inline void SetFrameMetadata(VmbFrame_t& frame, FrameMetadata* metadata) noexcept
+        {
+            frame.context[FrameMetadataContextIndex] = metadata;
+        }
+
+        /**
+         * \return the metadata of a frame delivered by AcquisitionManager;
+         *         null, if the frame does not have any
+         */
+        inline FrameMetadata const* GetFrameMetadata(VmbFrame_t const& frame) noexcept
+        {
+            auto const metadata = static_cast<FrameMetadata const*>(frame.context[FrameMetadataContextIndex]);
+            return (metadata != nullptr && metadata->m_fields != 0) ? metadata : nullptr;
+        }
+
+        /**
+         * \brief activate the chunk mode of a camera with the chunks of the
+         *        given fields; chunks the camera does not support are left
+         *        out; needs to be called before reading the payload size
+         * \return the fields enabled; 0, if the camera does not support chunk
+         *         data
+         */
+        VmbUint32_t EnableChunkMetadata(VmbHandle_t cameraHandle, VmbUint32_t fields) noexcept;
+
+        /**
+         * \brief turn off the chunk mode of a camera; errors are ignored
+         */
+        void DisableChunkMetadata(VmbHandle_t cameraHandle) noexcept;
+
+        /**
+         * \brief read the chunks of the given fields from the chunk data of a
+         *        frame; does not access the camera
+         * \return false, if the frame does not contain chunk data; m_fields
+         *         is 0 then
+         */
+        bool ReadChunkMetadata(VmbFrame_t const& frame, VmbUint32_t fields, FrameMetadata& metadata) noexcept;
+    }
+}
+
+#endif
@@ -0,0 +1,80 @@
+/**
+ * \date 2023
+ * \copyright Allied Vision Technologies.  All Rights Reserved.
+ *
+ * \copyright Redistribution of this file, in original or modified form, without
+ *            prior written consent of Allied Vision Technologies is prohibited.
+ *
+ * \warning THIS SOFTWARE IS PROVIDED BY THE AUTHOR "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF TITLE,
+ * NON-INFRINGEMENT, MERCHANTABILITY AND FITNESS FOR A PARTICULAR  PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \brief Definition of the interface for returning frames not owned by VmbC
+ */
+
+#ifndef ASYNCHRONOUSGRAB_C_FRAME_QUEUE_H
+#define ASYNCHRONOUSGRAB_C_FRAME_QUEUE_H
+
+#include <cstddef>
+
+#include <VmbC/VmbC.h>
+
+namespace VmbC
+{
+    namespace Examples
+    {
+        /**
+         * \brief Owner of frames that are not announced to VmbC, e.g. frames
+         *        replayed from a recording.
+         *
+         * Such frames store the queue in VmbFrame_t::context[FrameQueueContextIndex];
+         * QueueFrame returns them to the queue instead of VmbC.
+         */
+        class FrameQueue
+        {
+        public:
+            virtual ~FrameQueue() = default;
+
+            /**
+             * \brief return a frame after processing it; may be called from
+             *        any thread
+             */
+            virtual void QueueFrame(VmbFrame_t const& frame) noexcept = 0;
+        };
+
+        /**
+         * \brief the index of the frame context entry holding the FrameQueue;
+         *        null for frames announced to VmbC
+         */
+        constexpr size_t FrameQueueContextIndex = 1;
+
+        inline void SetFrameQueue(VmbFrame_t& frame, FrameQueue* queue) noexcept
+        {
+            frame.context[FrameQueueContextIndex] = queue;
+        }
+
+        /**
+         * \brief hand a frame back to its owner after processing, i.e. to its
+         *        FrameQueue or via VmbCaptureFrameQueue
+         */
+        inline VmbError_t QueueFrame(VmbHandle_t streamHandle, VmbFrame_t const* frame, VmbFrameCallback callback) noexcept
+        {
+            auto const queue = static_cast<FrameQueue*>(frame->context[FrameQueueContextIndex]);
+            if (queue != nullptr)
+            {
+                queue->QueueFrame(*frame);
+                return VmbErrorSuccess;
+            }
+            return VmbCaptureFrameQueue(streamHandle, frame, callback);
+        }
+    }
+}
+
+#endif
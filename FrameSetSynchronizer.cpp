@@ -0,0 +1,364 @@
+/**
+ * \date 2023
+ * \copyright Allied Vision Technologies.  All Rights Reserved.
+ *
+ * \copyright Redistribution of this file, in original or modified form, without
+ *            prior written consent of Allied Vision Technologies is prohibited.
+ *
+ * \warning THIS SOFTWARE IS PROVIDED BY THE AUTHOR "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF TITLE,
+ * NON-INFRINGEMENT, MERCHANTABILITY AND FITNESS FOR A PARTICULAR  PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \brief Implementation of ::VmbC::Examples::FrameSetSynchronizer
+ */
+
+#include <algorithm>
+#include <limits>
+
+#include "FrameCopy.h"
+#include "FrameSetSynchronizer.h"
+#include "Tracing.h"
+#include "VmbException.h"
+
+namespace VmbC
+{
+    namespace Examples
+    {
+        namespace
+        {
+            /**
+             * \brief the maximum interval for checking, if pending frames
+             *        exceeded m_maxWait or the synchronizer should stop
+             */
+            constexpr std::chrono::milliseconds StopCheckInterval { 100 };
+
+            constexpr VmbUint64_t NanosecondsPerSecond = 1000000000;
+        }
+
+        FrameSetSynchronizer::FrameSetSynchronizer(Settings const& settings, FrameSetSink& sink)
+            : m_settings(settings),
+            m_sink(sink),
+            m_streams(settings.m_streamCount)
+        /* 槽的缓冲区在第一次使用时按帧大小分配，之后内存占用固定为每个流 m_slotsPerStream 帧。 */
+        {
+            if (settings.m_streamCount < 2)
+            {
+                throw VmbException("the frame set synchronizer needs at least two streams", VmbErrorBadParameter);
+            }
+            if (settings.m_slotsPerStream == 0 || settings.m_maxQueuedSets == 0 || settings.m_offsetWindow == 0
+                || settings.m_timestampFrequency == 0 || settings.m_tolerance < 0
+                || settings.m_maxWait <= std::chrono::milliseconds::zero())
+            {
+                throw VmbException("invalid settings of the frame set synchronizer", VmbErrorBadParameter);
+            }
+
+            for (size_t index = 0; index != m_streams.size(); ++index)
+            {
+                auto& stream = m_streams[index];
+                stream.m_input.reset(new Input(*this, index));
+                stream.m_slots.resize(settings.m_slotsPerStream);
+                stream.m_freeSlots.reserve(settings.m_slotsPerStream);
+                for (size_t slot = settings.m_slotsPerStream; slot != 0; --slot)
+                {
+                    stream.m_freeSlots.push_back(slot - 1);
+                }
+                stream.m_offsetSamples.reserve(settings.m_offsetWindow);
+            }
+            m_thread = std::thread(&FrameSetSynchronizer::Deliver, this);
+        }
+
+        FrameSetSynchronizer::~FrameSetSynchronizer()
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_stop = true;
+            }
+            m_condition.notify_all();
+            m_thread.join();
+        }
+
+        RawFrameSink& FrameSetSynchronizer::GetInput(size_t const stream)
+        {
+            if (stream >= m_streams.size())
+            {
+                throw VmbException("invalid stream index of the frame set synchronizer", VmbErrorBadParameter);
+            }
+            return *m_streams[stream].m_input;
+        }
+
+        FrameSetSynchronizer::Statistics FrameSetSynchronizer::GetStatistics() const
+        {
+            Statistics statistics;
+            std::lock_guard<std::mutex> lock(m_mutex);
+            statistics.m_setsDelivered = m_setsDelivered;
+            if (m_setsDelivered != 0)
+            {
+                statistics.m_averageSpread = m_spreadSum / static_cast<double>(m_setsDelivered);
+            }
+            statistics.m_maxSpread = m_maxSpread;
+            for (auto const& stream : m_streams)
+            {
+                statistics.m_streams.push_back(stream.m_statistics);
+                statistics.m_streams.back().m_framesPending = stream.m_pending.size();
+                statistics.m_streams.back().m_clockOffset = stream.m_clockOffset;
+            }
+            return statistics;
+        }
+
+        void FrameSetSynchronizer::FrameReceived(size_t const streamIndex, VmbFrame_t const& frame)
+        /* 在各相机的VmbC回调线程中调用。先记录接收时间，估计时钟偏移时接收时间越早越准确。
+        没有空闲槽时让出该流最早的等待帧：它等待得最久，最可能已经没有匹配的帧；所有槽都在交付中时丢弃新帧。
+        复制在锁外进行，只有复制完成的帧参与匹配。 */
+        {
+            auto const received = Clock::now();
+            Stream& stream = m_streams[streamIndex];
+
+            size_t index;
+            VmbInt64_t key;
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                if (m_stop)
+                {
+                    return;
+                }
+                ++stream.m_statistics.m_framesReceived;
+                if (!ComputeKey(stream, frame, received, key))
+                {
+                    ++stream.m_statistics.m_framesUnmatched;
+                    return;
+                }
+
+                // a partner was matched with or discarded after later frames of another stream
+                for (auto const& other : m_streams)
+                {
+                    if (&other != &stream && other.m_hasLastKey && other.m_lastKey >= key - m_settings.m_tolerance)
+                    {
+                        ++stream.m_statistics.m_framesLate;
+                        return;
+                    }
+                }
+
+                if (stream.m_freeSlots.empty())
+                {
+                    if (stream.m_pending.empty())
+                    {
+                        ++stream.m_statistics.m_framesDropped;
+                        return;
+                    }
+                    DiscardPending(stream);
+                }
+                index = stream.m_freeSlots.back();
+                stream.m_freeSlots.pop_back();
+            }
+
+            ASYNCHRONOUSGRAB_TRACE_SCOPE("CopySyncFrame", frame.frameID);
+            Slot& slot = stream.m_slots[index];
+            bool const copied = CopyFrameToSlot(frame, slot.m_buffer, slot.m_frame, slot.m_metadata);
+            slot.m_key = key;
+            slot.m_received = received;
+
+            bool queued;
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                if (!copied)
+                {
+                    ++stream.m_statistics.m_framesDropped;
+                    stream.m_freeSlots.push_back(index);
+                    return;
+                }
+                stream.m_pending.push_back(index);
+                auto const sets = m_queuedSets.size();
+                Match(received);
+                queued = m_queuedSets.size() != sets;
+            }
+            if (queued)
+            {
+                m_condition.notify_all();
+            }
+        }
+
+        bool FrameSetSynchronizer::ComputeKey(Stream& stream, VmbFrame_t const& frame, Clock::time_point const received, VmbInt64_t& key)
+        /* 计数模式直接使用计数值。时间戳先换算为纳秒：分开计算整秒和余数，避免大时间戳相乘溢出或在double中丢失精度。
+        接收时间与拍摄时间之差由相机时钟偏移和传输延迟组成；传输延迟只会让差值变大，
+        因此最近 m_offsetWindow 帧中的最小值最接近偏移本身，窗口有限使估计能跟随时钟漂移。 */
+        {
+            if (m_settings.m_mode == MatchMode::Counter)
+            {
+                VmbUint64_t counter = frame.frameID;
+                if (m_settings.m_counterReader != nullptr && !m_settings.m_counterReader(frame, counter))
+                {
+                    return false;
+                }
+                key = static_cast<VmbInt64_t>(counter);
+                return true;
+            }
+
+            VmbUint64_t const frequency = m_settings.m_timestampFrequency;
+            VmbInt64_t const cameraTime = static_cast<VmbInt64_t>((frame.timestamp / frequency) * NanosecondsPerSecond
+                + (frame.timestamp % frequency) * NanosecondsPerSecond / frequency);
+            if (!m_settings.m_estimateClockOffsets)
+            {
+                key = cameraTime;
+                return true;
+            }
+
+            VmbInt64_t const hostTime = std::chrono::duration_cast<std::chrono::nanoseconds>(received.time_since_epoch()).count();
+            VmbInt64_t const sample = hostTime - cameraTime;
+            if (stream.m_offsetSamples.size() < m_settings.m_offsetWindow)
+            {
+                stream.m_offsetSamples.push_back(sample);
+            }
+            else
+            {
+                stream.m_offsetSamples[stream.m_nextOffsetSample] = sample;
+                stream.m_nextOffsetSample = (stream.m_nextOffsetSample + 1) % m_settings.m_offsetWindow;
+            }
+            stream.m_clockOffset = *std::min_element(stream.m_offsetSamples.begin(), stream.m_offsetSamples.end());
+            key = cameraTime + stream.m_clockOffset;
+            return true;
+        }
+
+        void FrameSetSynchronizer::Match(Clock::time_point const now)
+        /* 每个流的等待帧按键递增。所有流都有等待帧时，取各流最早帧中最晚的键：
+        其他流比它早超过容差的最早帧不可能再与该流后续的帧匹配，作为未匹配丢弃；
+        否则各流的最早帧相差不超过容差，组成一组。交付队列已满时整组丢弃，与槽不足时相同计为丢弃。
+        最后丢弃等待超过 m_maxWait 的帧，使某个相机丢帧时其他相机的槽不会被一直占用。 */
+        {
+            for (;;)
+            {
+                VmbInt64_t latest = (std::numeric_limits<VmbInt64_t>::min)();
+                bool complete = true;
+                for (auto const& stream : m_streams)
+                {
+                    if (stream.m_pending.empty())
+                    {
+                        complete = false;
+                        break;
+                    }
+                    latest = (std::max)(latest, stream.m_slots[stream.m_pending.front()].m_key);
+                }
+                if (!complete)
+                {
+                    break;
+                }
+
+                bool discarded = false;
+                for (auto& stream : m_streams)
+                {
+                    if (stream.m_slots[stream.m_pending.front()].m_key < latest - m_settings.m_tolerance)
+                    {
+                        DiscardPending(stream);
+                        discarded = true;
+                    }
+                }
+                if (discarded)
+                {
+                    continue;
+                }
+
+                QueuedSet set;
+                set.m_key = latest;
+                set.m_spread = 0;
+                set.m_slots.reserve(m_streams.size());
+                for (auto& stream : m_streams)
+                {
+                    set.m_spread = (std::max)(set.m_spread, latest - stream.m_slots[stream.m_pending.front()].m_key);
+                    set.m_slots.push_back(PopPending(stream));
+                }
+                if (m_queuedSets.size() >= m_settings.m_maxQueuedSets)
+                {
+                    for (size_t index = 0; index != m_streams.size(); ++index)
+                    {
+                        ++m_streams[index].m_statistics.m_framesDropped;
+                        m_streams[index].m_freeSlots.push_back(set.m_slots[index]);
+                    }
+                    continue;
+                }
+                for (auto& stream : m_streams)
+                {
+                    ++stream.m_statistics.m_framesMatched;
+                }
+                m_queuedSets.push_back(std::move(set));
+            }
+
+            for (auto& stream : m_streams)
+            {
+                while (!stream.m_pending.empty()
+                       && now - stream.m_slots[stream.m_pending.front()].m_received > m_settings.m_maxWait)
+                {
+                    DiscardPending(stream);
+                }
+            }
+        }
+
+        void FrameSetSynchronizer::DiscardPending(Stream& stream)
+        {
+            ++stream.m_statistics.m_framesUnmatched;
+            stream.m_freeSlots.push_back(PopPending(stream));
+        }
+
+        size_t FrameSetSynchronizer::PopPending(Stream& stream)
+        {
+            size_t const index = stream.m_pending.front();
+            stream.m_pending.pop_front();
+            stream.m_lastKey = stream.m_slots[index].m_key;
+            stream.m_hasLastKey = true;
+            return index;
+        }
+
+        void FrameSetSynchronizer::Deliver()
+        /* 交付线程：回调在锁外进行，不阻塞VmbC回调线程；交付期间组中的槽保持占用，回调返回后才归还。
+        没有新组时以 StopCheckInterval 为上限等待，并检查等待超时的帧：停止接收帧的相机不会调用 FrameReceived 来触发检查。 */
+        {
+            ASYNCHRONOUSGRAB_TRACE_THREAD_NAME("FrameSet delivery");
+
+            auto const checkInterval = (std::min)(std::chrono::duration_cast<Clock::duration>(m_settings.m_maxWait) / 2,
+                                                  std::chrono::duration_cast<Clock::duration>(StopCheckInterval));
+
+            FrameSet set;
+            set.m_frames.resize(m_streams.size());
+
+            std::unique_lock<std::mutex> lock(m_mutex);
+            while (!m_stop)
+            {
+                if (m_queuedSets.empty())
+                {
+                    m_condition.wait_for(lock, checkInterval);
+                    Match(Clock::now());
+                    continue;
+                }
+
+                QueuedSet queued = std::move(m_queuedSets.front());
+                m_queuedSets.pop_front();
+                lock.unlock();
+
+                for (size_t index = 0; index != m_streams.size(); ++index)
+                {
+                    set.m_frames[index] = m_streams[index].m_slots[queued.m_slots[index]].m_frame;
+                }
+                set.m_key = queued.m_key;
+                set.m_spread = queued.m_spread;
+                {
+                    ASYNCHRONOUSGRAB_TRACE_SCOPE("DeliverFrameSet", set.m_frames[0].frameID);
+                    m_sink.FrameSetReceived(set);
+                }
+
+                lock.lock();
+                for (size_t index = 0; index != m_streams.size(); ++index)
+                {
+                    m_streams[index].m_freeSlots.push_back(queued.m_slots[index]);
+                }
+                ++m_setsDelivered;
+                m_spreadSum += static_cast<double>(queued.m_spread);
+                m_maxSpread = (std::max)(m_maxSpread, queued.m_spread);
+            }
+        }
+    }
+}
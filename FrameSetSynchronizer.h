@@ -0,0 +1,391 @@
+/**
+ * \date 2023
+ * \copyright Allied Vision Technologies.  All Rights Reserved.
+ *
+ * \copyright Redistribution of this file, in original or modified form, without
+ *            prior written consent of Allied Vision Technologies is prohibited.
+ *
+ * \warning THIS SOFTWARE IS PROVIDED BY THE AUTHOR "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF TITLE,
+ * NON-INFRINGEMENT, MERCHANTABILITY AND FITNESS FOR A PARTICULAR  PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \brief Definition of a class grouping the frames of several cameras by capture time
+ */
+
+#ifndef ASYNCHRONOUSGRAB_C_FRAME_SET_SYNCHRONIZER_H
+#define ASYNCHRONOUSGRAB_C_FRAME_SET_SYNCHRONIZER_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <VmbC/VmbC.h>
+
+#include "AlignedBuffer.h"
+#include "FrameMetadata.h"
+#include "FrameSink.h"
+
+namespace VmbC
+{
+    namespace Examples
+    {
+        /**
+         * \brief Groups the frames of several cameras captured at the same
+         *        time into sets, e.g. for stereo or multi-view inspection.
+         *
+         * Every camera is acquired by its own AcquisitionManager with
+         * GetInput(i) registered as raw frame sink. FrameReceived copies the
+         * frame into a free slot of a fixed pool of the stream and matches
+         * the oldest pending frames of all streams:
+         *
+         * - MatchMode::Timestamp: the camera timestamps are moved to the
+         *   clock of the host by a per-stream offset, the minimum of the
+         *   difference between reception and capture time over the last
+         *   frames, i.e. the offset seen by the frames transferred fastest;
+         *   different minimum transfer latencies of the cameras remain as a
+         *   constant difference of the times.
+         *   Frames whose times differ by at most m_tolerance form a set.
+         *   With m_estimateClockOffsets false the timestamps are compared as
+         *   they are, e.g. for cameras synchronized via PTP.
+         * - MatchMode::Counter: frames with the same counter, by default
+         *   the frame ID, which matches for cameras triggered by the same
+         *   signal after all of them were started.
+         *
+         * A pending frame older than every possible partner is discarded as
+         * unmatched; so are frames still pending after m_maxWait, e.g.
+         * because another camera lost its partner, and the oldest pending
+         * frame of a stream without free slot. Frames arriving after a
+         * partner was already matched or discarded, e.g. after m_maxWait,
+         * are discarded as late. Complete sets are passed to
+         * the FrameSetSink by a thread of the synchronizer; the VmbC
+         * callback threads never wait for the sink.
+         */
+        class FrameSetSynchronizer
+        {
+        public:
+            using Clock = std::chrono::steady_clock;
+
+            enum class MatchMode
+            {
+                Timestamp,
+                Counter
+            };
+
+            /**
+             * \brief a set of frames, one per stream in the order of the
+             *        streams; the frames and their FrameMetadata point to
+             *        the slots of the synchronizer and are only valid until
+             *        the sink returns
+             */
+            struct FrameSet
+            {
+                std::vector<VmbFrame_t> m_frames;
+
+                /**
+                 * \brief the latest matching key of the frames: the time in
+                 *        nanoseconds of the host clock or the camera clocks,
+                 *        or the counter
+                 */
+                VmbInt64_t m_key { 0 };
+
+                /**
+                 * \brief the difference between the latest and the earliest
+                 *        key of the frames
+                 */
+                VmbInt64_t m_spread { 0 };
+            };
+
+            class FrameSetSink
+            {
+            public:
+                virtual ~FrameSetSink() = default;
+
+                /**
+                 * \brief called by a thread of the synchronizer in the order
+                 *        of the keys
+                 */
+                virtual void FrameSetReceived(FrameSet const& set) = 0;
+            };
+
+            /**
+             * \brief reads the counter of a frame for MatchMode::Counter
+             * \return false, if the frame has no counter; it is discarded
+             */
+            using CounterReader = bool (*)(VmbFrame_t const& frame, VmbUint64_t& counter);
+
+            struct Settings
+            {
+                size_t m_streamCount { 2 };
+                MatchMode m_mode { MatchMode::Timestamp };
+
+                /**
+                 * \brief the maximum difference of the keys within a set;
+                 *        nanoseconds for MatchMode::Timestamp, 0 for exact
+                 *        counters; needs to be less than half the frame
+                 *        period
+                 */
+                VmbInt64_t m_tolerance { 1000000 };
+
+                /**
+                 * \brief the ticks per second of the camera timestamps, e.g.
+                 *        GevTimestampTickFrequency; 1000000000 for nanoseconds
+                 */
+                VmbUint64_t m_timestampFrequency { 1000000000 };
+
+                bool m_estimateClockOffsets { true };
+
+                /**
+                 * \brief the number of recent frames the clock offset of a
+                 *        stream is estimated from
+                 */
+                size_t m_offsetWindow { 128 };
+
+                /**
+                 * \brief reads the counter for MatchMode::Counter; null uses
+                 *        the frame ID
+                 */
+                CounterReader m_counterReader { nullptr };
+
+                /**
+                 * \brief the number of frames of a stream pending or in sets
+                 *        being delivered
+                 */
+                size_t m_slotsPerStream { 8 };
+
+                /**
+                 * \brief frames pending longer are discarded as unmatched; must
+                 *        be positive
+                 */
+                std::chrono::milliseconds m_maxWait { 500 };
+
+                /**
+                 * \brief the number of complete sets waiting for the sink;
+                 *        further sets are discarded
+                 */
+                size_t m_maxQueuedSets { 4 };
+            };
+
+            struct StreamStatistics
+            {
+                VmbUint64_t m_framesReceived { 0 };
+                VmbUint64_t m_framesMatched { 0 };
+
+                /**
+                 * \brief frames without partners in the other streams
+                 */
+                VmbUint64_t m_framesUnmatched { 0 };
+
+                /**
+                 * \brief frames arriving after a partner was already matched
+                 *        or discarded
+                 */
+                VmbUint64_t m_framesLate { 0 };
+
+                /**
+                 * \brief frames discarded, because no slot was free or the
+                 *        set queue was full
+                 */
+                VmbUint64_t m_framesDropped { 0 };
+                size_t m_framesPending { 0 };
+
+                /**
+                 * \brief the estimated offset from the camera clock to the
+                 *        host clock in nanoseconds
+                 */
+                VmbInt64_t m_clockOffset { 0 };
+            };
+
+            struct Statistics
+            {
+                VmbUint64_t m_setsDelivered { 0 };
+
+                /**
+                 * \brief the average and the maximum FrameSet::m_spread of
+                 *        the sets delivered
+                 */
+                ///@{
+                double m_averageSpread { 0.0 };
+                VmbInt64_t m_maxSpread { 0 };
+                ///@}
+                std::vector<StreamStatistics> m_streams;
+            };
+
+            /**
+             * \brief start the delivery thread
+             * \throws VmbException, if the settings are invalid
+             */
+            FrameSetSynchronizer(Settings const& settings, FrameSetSink& sink);
+
+            /**
+             * \brief stops the delivery; the inputs need to be unregistered
+             *        before
+             */
+            ~FrameSetSynchronizer();
+
+            FrameSetSynchronizer(FrameSetSynchronizer const&) = delete;
+            FrameSetSynchronizer& operator=(FrameSetSynchronizer const&) = delete;
+
+            /**
+             * \brief the sink to register with the AcquisitionManager of a
+             *        stream
+             */
+            RawFrameSink& GetInput(size_t stream);
+
+            Statistics GetStatistics() const;
+        private:
+            class Input : public RawFrameSink
+            {
+            public:
+                Input(FrameSetSynchronizer& synchronizer, size_t stream) noexcept
+                    : m_synchronizer(synchronizer),
+                    m_stream(stream)
+                {
+                }
+
+                void FrameReceived(VmbFrame_t const& frame) override
+                {
+                    m_synchronizer.FrameReceived(m_stream, frame);
+                }
+            private:
+                FrameSetSynchronizer& m_synchronizer;
+                size_t const m_stream;
+            };
+
+            struct Slot
+            {
+                AlignedBuffer m_buffer;
+
+                /**
+                 * \brief the frame with buffer and imageData pointing into
+                 *        m_buffer and the metadata referring to m_metadata
+                 */
+                VmbFrame_t m_frame {};
+                FrameMetadata m_metadata {};
+                VmbInt64_t m_key { 0 };
+                Clock::time_point m_received;
+            };
+
+            struct Stream
+            {
+                std::unique_ptr<Input> m_input;
+                std::vector<Slot> m_slots;
+
+                /**
+                 * \name State guarded by m_mutex
+                 */
+                ///@{
+                std::vector<size_t> m_freeSlots;
+
+                /**
+                 * \brief the slots waiting for partners ordered by key
+                 */
+                std::deque<size_t> m_pending;
+
+                /**
+                 * \brief the differences between reception and capture time
+                 *        of the last frames in nanoseconds; a ring of
+                 *        m_offsetWindow entries
+                 */
+                std::vector<VmbInt64_t> m_offsetSamples;
+                size_t m_nextOffsetSample { 0 };
+                VmbInt64_t m_clockOffset { 0 };
+
+                /**
+                 * \brief the key of the last frame matched or discarded; the
+                 *        later frames of the other streams cannot match keys
+                 *        up to m_lastKey + m_tolerance anymore
+                 */
+                VmbInt64_t m_lastKey { 0 };
+                bool m_hasLastKey { false };
+
+                StreamStatistics m_statistics;
+                ///@}
+            };
+
+            /**
+             * \brief a set matched, but not delivered yet
+             */
+            struct QueuedSet
+            {
+                std::vector<size_t> m_slots;
+                VmbInt64_t m_key;
+                VmbInt64_t m_spread;
+            };
+
+            Settings const m_settings;
+            FrameSetSink& m_sink;
+
+            std::vector<Stream> m_streams;
+
+            mutable std::mutex m_mutex;
+
+            /**
+             * \brief notified when sets are queued or m_stop is set
+             */
+            std::condition_variable m_condition;
+
+            /**
+             * \name State guarded by m_mutex
+             */
+            ///@{
+            std::deque<QueuedSet> m_queuedSets;
+
+            VmbUint64_t m_setsDelivered { 0 };
+            double m_spreadSum { 0.0 };
+            VmbInt64_t m_maxSpread { 0 };
+            bool m_stop { false };
+            ///@}
+
+            std::thread m_thread;
+
+            void FrameReceived(size_t stream, VmbFrame_t const& frame);
+
+            /**
+             * \brief compute the key of a frame and update the clock offset;
+             *        m_mutex needs to be locked
+             * \return false, if the frame has no counter
+             */
+            bool ComputeKey(Stream& stream, VmbFrame_t const& frame, Clock::time_point received, VmbInt64_t& key);
+
+            /**
+             * \brief form the sets of the pending frames and discard the
+             *        frames that cannot be matched anymore; m_mutex needs to
+             *        be locked
+             */
+            void Match(Clock::time_point now);
+
+            /**
+             * \brief discard the oldest pending frame of a stream as
+             *        unmatched; m_mutex needs to be locked
+             */
+            void DiscardPending(Stream& stream);
+
+            /**
+             * \brief remove the oldest pending frame of a stream and update
+             *        Stream::m_lastKey; m_mutex needs to be locked
+             * \return the slot of the frame
+             */
+            size_t PopPending(Stream& stream);
+
+            /**
+             * \brief pass the queued sets to the sink and discard pending
+             *        frames after m_maxWait
+             */
+            void Deliver();
+        };
+    }
+}
+
+#endif
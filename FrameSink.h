@@ -0,0 +1,72 @@
+/**
+ * \date 2023
+ * \copyright Allied Vision Technologies.  All Rights Reserved.
+ *
+ * \copyright Redistribution of this file, in original or modified form, without
+ *            prior written consent of Allied Vision Technologies is prohibited.
+ *
+ * \warning THIS SOFTWARE IS PROVIDED BY THE AUTHOR "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF TITLE,
+ * NON-INFRINGEMENT, MERCHANTABILITY AND FITNESS FOR A PARTICULAR  PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \brief Definition of the interfaces used for passing frames out of the
+ *        acquisition
+ */
+
+#ifndef ASYNCHRONOUSGRAB_C_FRAME_SINK_H
+#define ASYNCHRONOUSGRAB_C_FRAME_SINK_H
+
+#include <VmbC/VmbC.h>
+
+namespace VmbC
+{
+    namespace Examples
+    {
+        class Image;
+
+        /**
+         * \brief Receiver of the frames delivered by VmbC before they are
+         *        scheduled for conversion.
+         *
+         * Called from the VmbC callback thread; implementations must not
+         * block and must not keep references to the frame data after
+         * returning.
+         */
+        class RawFrameSink
+        {
+        public:
+            virtual ~RawFrameSink() = default;
+
+            virtual void FrameReceived(VmbFrame_t const& frame) = 0;
+        };
+
+        /**
+         * \brief Receiver of the frames converted by ImageTranscoder, e.g. the gui.
+         *
+         * Called from the conversion thread; the image is only valid until
+         * the function returns.
+         */
+        class ConvertedFrameSink
+        {
+        public:
+            virtual ~ConvertedFrameSink() = default;
+
+            /**
+             * \param[in] image the converted image
+             * \param[in] frame the frame the image was converted from; with
+             *                  the adaptive quality of ImageTranscoder it
+             *                  describes the decimated pixels
+             */
+            virtual void ConvertedFrameReceived(Image const& image, VmbFrame_t const& frame) = 0;
+        };
+    }
+}
+
+#endif
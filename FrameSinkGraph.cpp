@@ -0,0 +1,418 @@
+/**
+ * \date 2023
+ * \copyright Allied Vision Technologies.  All Rights Reserved.
+ *
+ * \copyright Redistribution of this file, in original or modified form, without
+ *            prior written consent of Allied Vision Technologies is prohibited.
+ *
+ * \warning THIS SOFTWARE IS PROVIDED BY THE AUTHOR "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF TITLE,
+ * NON-INFRINGEMENT, MERCHANTABILITY AND FITNESS FOR A PARTICULAR  PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \brief Implementation of ::VmbC::Examples::FrameSinkGraph
+ */
+
+#include <algorithm>
+
+#include "FrameCopy.h"
+#include "FrameSinkGraph.h"
+#include "Tracing.h"
+#include "VmbException.h"
+
+namespace VmbC
+{
+    namespace Examples
+    {
+        FrameSinkGraph::FrameSinkGraph(Settings const& settings)
+            : m_settings(settings)
+        /* 复制帧的缓冲区在需要时按帧大小分配，总大小不超过 m_memoryBudget。 */
+        {
+            if (settings.m_memoryBudget == 0)
+            {
+                throw VmbException("the memory budget of the frame sink graph needs to be positive", VmbErrorBadParameter);
+            }
+        }
+
+        FrameSinkGraph::~FrameSinkGraph()
+        {
+            std::lock_guard<std::mutex> edgeLock(m_edgeMutex);
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                for (auto& edge : m_edges)
+                {
+                    edge.m_stop = true;
+                    edge.m_condition.notify_all();
+                }
+            }
+            for (auto& edge : m_edges)
+            {
+                if (edge.m_thread.joinable())
+                {
+                    edge.m_thread.join();
+                }
+            }
+        }
+
+        void FrameSinkGraph::AddSink(RawFrameSink& sink, EdgeSettings const& settings)
+        /* 边按优先级降序插入 m_order，优先级相同时按添加顺序。有队列的边在插入之后启动自己的线程。 */
+        {
+            if (settings.m_maxBlockTime.count() < 0)
+            {
+                throw VmbException("the block time of a frame sink graph edge must not be negative", VmbErrorBadParameter);
+            }
+
+            std::lock_guard<std::mutex> edgeLock(m_edgeMutex);
+            Edge* edge;
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                if (std::any_of(m_edges.begin(), m_edges.end(), [&sink](Edge const& e) { return &e.m_sink == &sink; }))
+                {
+                    throw VmbException("the sink was added to the frame sink graph already", VmbErrorBadParameter);
+                }
+                m_edges.emplace_back(sink, settings);
+                edge = &m_edges.back();
+                edge->m_statistics.m_name = settings.m_name;
+                edge->m_statistics.m_priority = settings.m_priority;
+                edge->m_statistics.m_queueDepth = settings.m_queueDepth;
+                edge->m_statistics.m_dropPolicy = settings.m_dropPolicy;
+
+                auto const position = std::upper_bound(m_order.begin(), m_order.end(), settings.m_priority,
+                    [](int priority, Edge const* e) { return priority > e->m_settings.m_priority; });
+                m_order.insert(position, edge);
+                m_accepting.reserve(m_order.size());
+            }
+            if (settings.m_queueDepth != 0)
+            {
+                edge->m_thread = std::thread(&FrameSinkGraph::Deliver, this, std::ref(*edge));
+            }
+        }
+
+        void FrameSinkGraph::RemoveSink(RawFrameSink& sink) noexcept
+        /* FrameReceived在服务所有边期间持有m_edgeMutex，因此直接调用的接收者在函数返回后不会再被调用；
+        有队列的边先停止线程并等待正在进行的调用结束，剩余的帧释放而不交付。 */
+        {
+            std::lock_guard<std::mutex> edgeLock(m_edgeMutex);
+            auto const pos = std::find_if(m_edges.begin(), m_edges.end(), [&sink](Edge const& e) { return &e.m_sink == &sink; });
+            if (pos == m_edges.end())
+            {
+                return;
+            }
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                pos->m_stop = true;
+                while (!pos->m_queue.empty())
+                {
+                    Release(pos->m_queue.front().m_slot);
+                    pos->m_queue.pop_front();
+                }
+            }
+            pos->m_condition.notify_all();
+            m_releaseCondition.notify_all();
+            if (pos->m_thread.joinable())
+            {
+                pos->m_thread.join();
+            }
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_order.erase(std::remove(m_order.begin(), m_order.end(), &*pos), m_order.end());
+            m_edges.erase(pos);
+        }
+
+        void FrameSinkGraph::FrameReceived(VmbFrame_t const& frame)
+        /* 按优先级顺序服务各边：直接调用的接收者在当前线程中调用并计时；遇到第一个有队列的边时，
+        为所有有队列的边复制一次帧。 */
+        {
+            std::lock_guard<std::mutex> edgeLock(m_edgeMutex);
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                ++m_framesReceived;
+            }
+
+            bool queued = false;
+            for (auto const edge : m_order)
+            {
+                if (edge->m_settings.m_queueDepth != 0)
+                {
+                    if (!queued)
+                    {
+                        queued = true;
+                        QueueFrame(frame);
+                    }
+                    continue;
+                }
+
+                auto const begin = Clock::now();
+                edge->m_sink.FrameReceived(frame);
+                auto const end = Clock::now();
+
+                std::lock_guard<std::mutex> lock(m_mutex);
+                ++edge->m_statistics.m_framesOffered;
+                RecordDelivery(*edge, Clock::duration::zero(), end - begin);
+            }
+        }
+
+        void FrameSinkGraph::QueueFrame(VmbFrame_t const& frame)
+        /* 先按各边的丢帧策略处理已满的队列，确定接受该帧的边；然后取得一个槽，在锁外复制帧，
+        最后把槽加入接受的边的队列，每个边持有一个引用。 */
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            auto const now = Clock::now();
+
+            m_accepting.clear();
+            for (auto const edge : m_order)
+            {
+                auto const depth = edge->m_settings.m_queueDepth;
+                if (depth == 0)
+                {
+                    continue;
+                }
+                auto& statistics = edge->m_statistics;
+                ++statistics.m_framesOffered;
+                if (edge->m_queue.size() >= depth)
+                {
+                    switch (edge->m_settings.m_dropPolicy)
+                    {
+                    case DropPolicy::DropOldest:
+                        PopOldest(*edge);
+                        ++statistics.m_framesDropped;
+                        break;
+                    case DropPolicy::DropNewest:
+                        ++statistics.m_framesDropped;
+                        continue;
+                    case DropPolicy::Block:
+                        {
+                            auto const waitStart = Clock::now();
+                            bool const space = m_releaseCondition.wait_until(lock, waitStart + edge->m_settings.m_maxBlockTime,
+                                [edge, depth]() { return edge->m_queue.size() < depth || edge->m_stop; });
+                            statistics.m_blockedTime += Clock::now() - waitStart;
+                            if (!space || edge->m_stop)
+                            {
+                                ++statistics.m_framesDropped;
+                                continue;
+                            }
+                        }
+                        break;
+                    }
+                }
+                m_accepting.push_back(edge);
+            }
+            if (m_accepting.empty())
+            {
+                return;
+            }
+
+            size_t index;
+            if (!AcquireSlot(lock, frame.bufferSize, index))
+            {
+                for (auto const edge : m_accepting)
+                {
+                    ++edge->m_statistics.m_framesDropped;
+                }
+                return;
+            }
+            lock.unlock();
+
+            // the slot is not referenced by any edge and not free, so it is copied without holding the lock
+            Slot& slot = m_slots[index];
+            bool copied;
+            {
+                ASYNCHRONOUSGRAB_TRACE_SCOPE("CopyGraphFrame", frame.frameID);
+                copied = CopyFrameToSlot(frame, slot.m_buffer, slot.m_frame, slot.m_metadata);
+            }
+
+            lock.lock();
+            if (!copied)
+            {
+                // the buffer was released by the failed allocation
+                m_allocatedBytes -= AlignedBuffer::AlignUp(frame.bufferSize, SlotAlignment);
+                m_freeSlots.push_back(index);
+                for (auto const edge : m_accepting)
+                {
+                    ++edge->m_statistics.m_framesDropped;
+                }
+                return;
+            }
+            ++m_framesCopied;
+            for (auto const edge : m_accepting)
+            {
+                if (edge->m_stop)
+                {
+                    ++edge->m_statistics.m_framesDropped;
+                    continue;
+                }
+                edge->m_queue.push_back({ index, now });
+                ++slot.m_references;
+                auto& statistics = edge->m_statistics;
+                statistics.m_maxQueued = (std::max)(statistics.m_maxQueued, edge->m_queue.size());
+                edge->m_condition.notify_one();
+            }
+            if (slot.m_references == 0)
+            {
+                m_freeSlots.push_back(index);
+            }
+        }
+
+        bool FrameSinkGraph::AcquireSlot(std::unique_lock<std::mutex>& lock, size_t const size, size_t& index)
+        /* 依次尝试：足够大的空闲槽；预算允许时新建槽，或者把较小的空闲槽重新分配为所需的大小；
+        驱逐优先级低于接受该帧的最高优先级边的边中最旧的帧（从优先级最低的边开始）；
+        最后在有阻塞策略的边时等待释放。槽的缓冲区在锁外分配，这里只预先记入 m_allocatedBytes。 */
+        {
+            int const priority = m_accepting.front()->m_settings.m_priority;
+            auto const allocation = AlignedBuffer::AlignUp(size, SlotAlignment);
+            bool block = false;
+            auto deadline = Clock::now();
+            for (auto const edge : m_accepting)
+            {
+                if (edge->m_settings.m_dropPolicy == DropPolicy::Block)
+                {
+                    block = true;
+                    deadline = (std::max)(deadline, Clock::now() + Clock::duration(edge->m_settings.m_maxBlockTime));
+                }
+            }
+
+            while (true)
+            {
+                auto const fitting = std::find_if(m_freeSlots.begin(), m_freeSlots.end(),
+                    [this, size](size_t slot) { return m_slots[slot].m_buffer.GetSize() >= size; });
+                if (fitting != m_freeSlots.end())
+                {
+                    index = *fitting;
+                    m_freeSlots.erase(fitting);
+                    return true;
+                }
+                if (m_allocatedBytes + allocation <= m_settings.m_memoryBudget)
+                {
+                    m_allocatedBytes += allocation;
+                    index = m_slots.size();
+                    m_slots.emplace_back();
+                    return true;
+                }
+                if (!m_freeSlots.empty())
+                {
+                    auto const smaller = m_slots[m_freeSlots.back()].m_buffer.GetSize();
+                    if (m_allocatedBytes - smaller + allocation <= m_settings.m_memoryBudget)
+                    {
+                        index = m_freeSlots.back();
+                        m_freeSlots.pop_back();
+                        m_slots[index].m_buffer = AlignedBuffer();
+                        m_allocatedBytes += allocation - smaller;
+                        return true;
+                    }
+                }
+
+                auto const victim = std::find_if(m_order.rbegin(), m_order.rend(),
+                    [priority](Edge const* edge) { return edge->m_settings.m_priority < priority && !edge->m_queue.empty(); });
+                if (victim != m_order.rend())
+                {
+                    PopOldest(**victim);
+                    ++(*victim)->m_statistics.m_framesEvicted;
+                    continue;
+                }
+
+                auto const now = Clock::now();
+                if (!block || now >= deadline)
+                {
+                    return false;
+                }
+                m_releaseCondition.wait_until(lock, deadline);
+                auto const waited = Clock::now() - now;
+                for (auto const edge : m_accepting)
+                {
+                    if (edge->m_settings.m_dropPolicy == DropPolicy::Block)
+                    {
+                        edge->m_statistics.m_blockedTime += waited;
+                    }
+                }
+            }
+        }
+
+        void FrameSinkGraph::PopOldest(Edge& edge)
+        {
+            Release(edge.m_queue.front().m_slot);
+            edge.m_queue.pop_front();
+        }
+
+        void FrameSinkGraph::Release(size_t const index)
+        {
+            if (--m_slots[index].m_references == 0)
+            {
+                m_freeSlots.push_back(index);
+                m_releaseCondition.notify_all();
+            }
+        }
+
+        void FrameSinkGraph::RecordDelivery(Edge& edge, Clock::duration const queueTime, Clock::duration const deliveryTime)
+        {
+            auto& statistics = edge.m_statistics;
+            ++statistics.m_framesDelivered;
+            edge.m_queueTimeSum += queueTime;
+            edge.m_deliveryTimeSum += deliveryTime;
+            statistics.m_maxQueueTime = (std::max)(statistics.m_maxQueueTime, queueTime);
+            statistics.m_maxDeliveryTime = (std::max)(statistics.m_maxDeliveryTime, deliveryTime);
+        }
+
+        void FrameSinkGraph::Deliver(Edge& edge)
+        /* 边的线程：取出队列中最旧的帧，在锁外调用接收者，之后释放槽的引用。
+        取出帧后通知 m_releaseCondition，让等待队列空间的 FrameReceived 继续。 */
+        {
+            ASYNCHRONOUSGRAB_TRACE_THREAD_NAME("FrameSinkGraph");
+
+            std::unique_lock<std::mutex> lock(m_mutex);
+            while (true)
+            {
+                edge.m_condition.wait(lock, [&edge]() { return edge.m_stop || !edge.m_queue.empty(); });
+                if (edge.m_stop)
+                {
+                    return;
+                }
+                auto const entry = edge.m_queue.front();
+                edge.m_queue.pop_front();
+                m_releaseCondition.notify_all();
+                Slot& slot = m_slots[entry.m_slot];
+                lock.unlock();
+
+                auto const begin = Clock::now();
+                {
+                    ASYNCHRONOUSGRAB_TRACE_SCOPE("DeliverGraphFrame", slot.m_frame.frameID);
+                    edge.m_sink.FrameReceived(slot.m_frame);
+                }
+                auto const end = Clock::now();
+
+                lock.lock();
+                RecordDelivery(edge, begin - entry.m_queued, end - begin);
+                Release(entry.m_slot);
+            }
+        }
+
+        FrameSinkGraph::Statistics FrameSinkGraph::GetStatistics() const
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            Statistics result;
+            result.m_framesReceived = m_framesReceived;
+            result.m_framesCopied = m_framesCopied;
+            result.m_buffers = m_slots.size();
+            result.m_allocatedBytes = m_allocatedBytes;
+            result.m_edges.reserve(m_order.size());
+            for (auto const edge : m_order)
+            {
+                result.m_edges.push_back(edge->m_statistics);
+                auto& statistics = result.m_edges.back();
+                statistics.m_framesQueued = edge->m_queue.size();
+                if (statistics.m_framesDelivered != 0)
+                {
+                    auto const delivered = static_cast<Clock::rep>(statistics.m_framesDelivered);
+                    statistics.m_averageQueueTime = edge->m_queueTimeSum / delivered;
+                    statistics.m_averageDeliveryTime = edge->m_deliveryTimeSum / delivered;
+                }
+            }
+            return result;
+        }
+    }
+}
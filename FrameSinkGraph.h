@@ -0,0 +1,386 @@
+/**
+ * \date 2023
+ * \copyright Allied Vision Technologies.  All Rights Reserved.
+ *
+ * \copyright Redistribution of this file, in original or modified form, without
+ *            prior written consent of Allied Vision Technologies is prohibited.
+ *
+ * \warning THIS SOFTWARE IS PROVIDED BY THE AUTHOR "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF TITLE,
+ * NON-INFRINGEMENT, MERCHANTABILITY AND FITNESS FOR A PARTICULAR  PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \brief Definition of a graph passing the raw frames to sinks of different priority
+ */
+
+#ifndef ASYNCHRONOUSGRAB_C_FRAME_SINK_GRAPH_H
+#define ASYNCHRONOUSGRAB_C_FRAME_SINK_GRAPH_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <list>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <VmbC/VmbC.h>
+
+#include "AlignedBuffer.h"
+#include "FrameMetadata.h"
+#include "FrameSink.h"
+
+namespace VmbC
+{
+    namespace Examples
+    {
+        /**
+         * \brief Passes the raw frames to a set of sinks of different
+         *        importance, e.g. recording, analysis and network output.
+         *
+         * Every sink is an edge of the graph with its own EdgeSettings. The
+         * edges are served in the order of descending m_priority:
+         *
+         * - Edges with m_queueDepth 0 call the sink directly in the thread
+         *   calling FrameReceived, like AcquisitionManager did for all raw
+         *   sinks; such sinks need to copy the frame themselves.
+         * - The other edges receive a copy of the frame in a queue of
+         *   m_queueDepth frames served by a thread of the edge; a slow sink
+         *   only fills its own queue. The frame is copied once for all
+         *   queued edges, at the position of the queued edge of the highest
+         *   priority. A full queue is handled according to m_dropPolicy.
+         *
+         * The copies share a pool of buffers limited by m_memoryBudget. If
+         * the budget is used up, the oldest frames queued for edges of lower
+         * priority than the receiving edges are evicted, so a slow preview
+         * does not cost the recording frames; only if no such frame is left,
+         * edges with DropPolicy::Block wait for a buffer and the others drop
+         * the frame.
+         *
+         * The sinks of queued edges receive a VmbFrame_t referring to the
+         * copy; the metadata of the frame is copied, too, and the other
+         * context pointers are null. Per edge the frames offered, delivered,
+         * dropped and evicted, the queue occupancy and the time spent
+         * waiting and in the sink are counted for tuning the settings.
+         */
+        class FrameSinkGraph : public RawFrameSink
+        {
+        public:
+            using Clock = std::chrono::steady_clock;
+
+            /**
+             * \brief the handling of a frame offered to a queued edge whose
+             *        queue is full
+             */
+            enum class DropPolicy
+            {
+                /**
+                 * \brief drop the oldest queued frame; for sinks only
+                 *        interested in the most recent frames, e.g. a display
+                 */
+                DropOldest,
+
+                /**
+                 * \brief drop the new frame, keeping the sequence of the
+                 *        queued frames without gaps
+                 */
+                DropNewest,
+
+                /**
+                 * \brief let FrameReceived wait up to m_maxBlockTime for the
+                 *        sink, e.g. for a recording that must not lose frames;
+                 *        delays the frames of all edges of lower priority
+                 */
+                Block,
+            };
+
+            struct Settings
+            {
+                /**
+                 * \brief the maximum memory of the frame copies of all queued
+                 *        edges
+                 */
+                size_t m_memoryBudget { 256 << 20 };
+            };
+
+            struct EdgeSettings
+            {
+                /**
+                 * \brief the name of the edge in the statistics
+                 */
+                std::string m_name;
+
+                /**
+                 * \brief edges of higher priority receive the frames first
+                 *        and may evict the frames queued for edges of lower
+                 *        priority
+                 */
+                int m_priority { 0 };
+
+                /**
+                 * \brief the number of frames queued for the sink; 0 calls
+                 *        the sink directly
+                 */
+                size_t m_queueDepth { 0 };
+
+                DropPolicy m_dropPolicy { DropPolicy::DropOldest };
+
+                /**
+                 * \brief the maximum time FrameReceived waits for a frame,
+                 *        if m_dropPolicy is DropPolicy::Block
+                 */
+                std::chrono::milliseconds m_maxBlockTime { 100 };
+            };
+
+            struct EdgeStatistics
+            {
+                std::string m_name;
+                int m_priority { 0 };
+                size_t m_queueDepth { 0 };
+                DropPolicy m_dropPolicy { DropPolicy::DropOldest };
+
+                VmbUint64_t m_framesOffered { 0 };
+                VmbUint64_t m_framesDelivered { 0 };
+
+                /**
+                 * \brief frames not delivered because of a full queue or a
+                 *        lack of memory
+                 */
+                VmbUint64_t m_framesDropped { 0 };
+
+                /**
+                 * \brief queued frames removed to make room for the frames of
+                 *        edges of higher priority
+                 */
+                VmbUint64_t m_framesEvicted { 0 };
+
+                /**
+                 * \brief the frames currently queued and the maximum since
+                 *        the edge was added
+                 */
+                ///@{
+                size_t m_framesQueued { 0 };
+                size_t m_maxQueued { 0 };
+                ///@}
+
+                /**
+                 * \brief the time from queueing a frame until the sink is
+                 *        called
+                 */
+                ///@{
+                Clock::duration m_averageQueueTime {};
+                Clock::duration m_maxQueueTime {};
+                ///@}
+
+                /**
+                 * \brief the time spent in RawFrameSink::FrameReceived
+                 */
+                ///@{
+                Clock::duration m_averageDeliveryTime {};
+                Clock::duration m_maxDeliveryTime {};
+                ///@}
+
+                /**
+                 * \brief the total time FrameReceived waited for this edge
+                 *        due to DropPolicy::Block
+                 */
+                Clock::duration m_blockedTime {};
+            };
+
+            struct Statistics
+            {
+                VmbUint64_t m_framesReceived { 0 };
+
+                /**
+                 * \brief frames copied for the queued edges
+                 */
+                VmbUint64_t m_framesCopied { 0 };
+
+                /**
+                 * \brief the buffers of the frame copies and their total size
+                 */
+                ///@{
+                size_t m_buffers { 0 };
+                size_t m_allocatedBytes { 0 };
+                ///@}
+
+                /**
+                 * \brief the edges in the order they are served
+                 */
+                std::vector<EdgeStatistics> m_edges;
+            };
+
+            /**
+             * \throws VmbException, if the memory budget is 0
+             */
+            FrameSinkGraph(Settings const& settings);
+
+            /**
+             * \brief stops the threads of the edges; frames still queued
+             *        are discarded
+             */
+            ~FrameSinkGraph();
+
+            FrameSinkGraph(FrameSinkGraph const&) = delete;
+            FrameSinkGraph& operator=(FrameSinkGraph const&) = delete;
+
+            /**
+             * \brief add an edge passing the frames to a sink
+             * \throws VmbException, if the sink was added already or the
+             *                      block time is negative
+             */
+            void AddSink(RawFrameSink& sink, EdgeSettings const& settings);
+
+            /**
+             * \brief remove the edge of a sink; the sink is not called
+             *        anymore after this function returns, frames still
+             *        queued for it are discarded
+             */
+            void RemoveSink(RawFrameSink& sink) noexcept;
+
+            void FrameReceived(VmbFrame_t const& frame) override;
+
+            Statistics GetStatistics() const;
+        private:
+            struct Slot
+            {
+                AlignedBuffer m_buffer;
+                VmbFrame_t m_frame {};
+                FrameMetadata m_metadata {};
+
+                /**
+                 * \brief the number of edges the frame is queued for or being
+                 *        delivered to; guarded by m_mutex
+                 */
+                size_t m_references { 0 };
+            };
+
+            struct QueueEntry
+            {
+                size_t m_slot;
+                Clock::time_point m_queued;
+            };
+
+            struct Edge
+            {
+                Edge(RawFrameSink& sink, EdgeSettings const& settings)
+                    : m_sink(sink),
+                    m_settings(settings)
+                {
+                }
+
+                RawFrameSink& m_sink;
+                EdgeSettings const m_settings;
+                std::thread m_thread;
+
+                /**
+                 * \brief notified when a frame is queued or m_stop is set
+                 */
+                std::condition_variable m_condition;
+
+                /**
+                 * \name State guarded by m_mutex
+                 */
+                ///@{
+                std::deque<QueueEntry> m_queue;
+                bool m_stop { false };
+                EdgeStatistics m_statistics;
+                Clock::duration m_queueTimeSum {};
+                Clock::duration m_deliveryTimeSum {};
+                ///@}
+            };
+
+            Settings const m_settings;
+
+            /**
+             * \brief held while the edges are served and while edges are
+             *        added or removed; locked before m_mutex
+             */
+            std::mutex m_edgeMutex;
+
+            /**
+             * \brief the edges sorted by descending priority; modified with
+             *        m_edgeMutex and m_mutex locked
+             */
+            std::vector<Edge*> m_order;
+
+            /**
+             * \brief the queued edges accepting the current frame; only used
+             *        by FrameReceived
+             */
+            std::vector<Edge*> m_accepting;
+
+            mutable std::mutex m_mutex;
+
+            /**
+             * \brief notified when a frame is taken from a queue or a buffer
+             *        is released
+             */
+            std::condition_variable m_releaseCondition;
+
+            /**
+             * \name State guarded by m_mutex
+             */
+            ///@{
+            std::list<Edge> m_edges;
+
+            /**
+             * \brief the buffers of the frame copies; a deque, since the
+             *        threads of the edges keep references to the slots
+             */
+            std::deque<Slot> m_slots;
+            std::vector<size_t> m_freeSlots;
+            size_t m_allocatedBytes { 0 };
+            VmbUint64_t m_framesReceived { 0 };
+            VmbUint64_t m_framesCopied { 0 };
+            ///@}
+
+            /**
+             * \brief copy the frame once and queue it for the queued edges;
+             *        m_edgeMutex needs to be locked
+             */
+            void QueueFrame(VmbFrame_t const& frame);
+
+            /**
+             * \brief get a slot with a buffer of at least size bytes for the
+             *        edges in m_accepting, evicting frames of edges of lower
+             *        priority or waiting, if necessary
+             * \return false, if no slot could be made available
+             */
+            bool AcquireSlot(std::unique_lock<std::mutex>& lock, size_t size, size_t& index);
+
+            /**
+             * \brief remove the oldest frame from the queue of an edge;
+             *        m_mutex needs to be locked
+             */
+            void PopOldest(Edge& edge);
+
+            /**
+             * \brief release a reference to a slot; m_mutex needs to be
+             *        locked
+             */
+            void Release(size_t index);
+
+            /**
+             * \brief count a frame passed to the sink of an edge; m_mutex
+             *        needs to be locked
+             */
+            void RecordDelivery(Edge& edge, Clock::duration queueTime, Clock::duration deliveryTime);
+
+            /**
+             * \brief pass the queued frames of an edge to its sink
+             */
+            void Deliver(Edge& edge);
+        };
+    }
+}
+
+#endif
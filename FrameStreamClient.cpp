@@ -0,0 +1,128 @@
+/**
+ * \date 2023
+ * \copyright Allied Vision Technologies.  All Rights Reserved.
+ *
+ * \copyright Redistribution of this file, in original or modified form, without
+ *            prior written consent of Allied Vision Technologies is prohibited.
+ *
+ * \warning THIS SOFTWARE IS PROVIDED BY THE AUTHOR "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF TITLE,
+ * NON-INFRINGEMENT, MERCHANTABILITY AND FITNESS FOR A PARTICULAR  PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \brief Implementation of ::VmbC::Examples::FrameStreamClient
+ */
+
+#include <cstring>
+
+#include "FrameStreamClient.h"
+#include "VmbException.h"
+
+namespace VmbC
+{
+    namespace Examples
+    {
+        namespace
+        {
+            /**
+             * \brief time a frame started may take to arrive completely
+             */
+            constexpr std::chrono::milliseconds ReceiveTimeout { 10000 };
+
+            /**
+             * \brief frames with larger buffers are considered invalid data
+             */
+            constexpr VmbUint64_t MaxBufferSize = VmbUint64_t(1) << 30;
+        }
+
+        VmbFrame_t FrameStreamClient::Frame::GetFrame() noexcept
+        {
+            VmbFrame_t frame;
+            std::memset(&frame, 0, sizeof(frame));
+            frame.buffer = m_buffer.data();
+            frame.bufferSize = static_cast<VmbUint32_t>(m_header.m_bufferSize);
+            frame.imageData = m_buffer.data() + m_header.m_imageOffset;
+            frame.receiveStatus = m_header.m_receiveStatus;
+            frame.receiveFlags = m_header.m_receiveFlags;
+            frame.frameID = m_header.m_frameId;
+            frame.timestamp = m_header.m_timestamp;
+            frame.width = m_header.m_width;
+            frame.height = m_header.m_height;
+            frame.offsetX = m_header.m_offsetX;
+            frame.offsetY = m_header.m_offsetY;
+            frame.pixelFormat = m_header.m_pixelFormat;
+            return frame;
+        }
+
+        FrameStreamClient::FrameStreamClient(std::string const& host, VmbUint16_t const port)
+            : FrameStreamClient(host, port, FrameStreamFormat::Magic, FrameStreamFormat::Version)
+        {
+        }
+
+        FrameStreamClient::FrameStreamClient(std::string const& host, VmbUint16_t const port, char const (&magic)[8], VmbUint32_t const version)
+            : m_connection(Socket::Connect(host, port))
+        /* 服务器在接受连接后立即发送流头；帧头可能比本版本已知的更长，多出的部分在读取帧时跳过。 */
+        {
+            m_connection.SetReceiveTimeout(ReceiveTimeout);
+
+            FrameStreamFormat::StreamHeader header {};
+            if (!m_connection.ReceiveAll(&header, sizeof(header)))
+            {
+                throw VmbException("no frame stream received from " + host + ":" + std::to_string(port));
+            }
+            if (std::memcmp(header.m_magic, magic, sizeof(header.m_magic)) != 0
+                || header.m_version != version
+                || header.m_frameHeaderSize < sizeof(FrameStreamFormat::FrameHeader))
+            {
+                throw VmbException(host + ":" + std::to_string(port) + " does not send a supported frame stream", VmbErrorInvalidValue);
+            }
+            m_frameHeaderSize = header.m_frameHeaderSize;
+        }
+
+        bool FrameStreamClient::WaitForFrame(std::chrono::milliseconds const timeout) const noexcept
+        {
+            return m_connection.WaitReadable(timeout);
+        }
+
+        bool FrameStreamClient::ReadFrame(Frame& frame)
+        {
+            if (!m_connection.ReceiveAll(&frame.m_header, sizeof(frame.m_header)))
+            {
+                return false;
+            }
+            char extension[64];
+            for (size_t remaining = m_frameHeaderSize - sizeof(frame.m_header); remaining != 0;)
+            {
+                size_t const size = (remaining < sizeof(extension)) ? remaining : sizeof(extension);
+                if (!m_connection.ReceiveAll(extension, size))
+                {
+                    return false;
+                }
+                remaining -= size;
+            }
+
+            auto const& header = frame.m_header;
+            if (header.m_magic != FrameStreamFormat::FrameMagic
+                || header.m_bufferSize > MaxBufferSize
+                || header.m_imageOffset > header.m_bufferSize)
+            {
+                throw VmbException("invalid frame header received", VmbErrorInvalidValue);
+            }
+            m_framesSkipped += header.m_framesSkipped;
+
+            frame.m_buffer.resize(static_cast<size_t>(header.m_bufferSize));
+            return m_connection.ReceiveAll(frame.m_buffer.data(), frame.m_buffer.size());
+        }
+
+        void FrameStreamClient::Close() noexcept
+        {
+            m_connection.Close();
+        }
+    }
+}
@@ -0,0 +1,122 @@
+/**
+ * \date 2023
+ * \copyright Allied Vision Technologies.  All Rights Reserved.
+ *
+ * \copyright Redistribution of this file, in original or modified form, without
+ *            prior written consent of Allied Vision Technologies is prohibited.
+ *
+ * \warning THIS SOFTWARE IS PROVIDED BY THE AUTHOR "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF TITLE,
+ * NON-INFRINGEMENT, MERCHANTABILITY AND FITNESS FOR A PARTICULAR  PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \brief Definition of a client receiving the frames of a FrameStreamServer
+ */
+
+#ifndef ASYNCHRONOUSGRAB_C_FRAME_STREAM_CLIENT_H
+#define ASYNCHRONOUSGRAB_C_FRAME_STREAM_CLIENT_H
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include <VmbC/VmbC.h>
+
+#include "FrameStreamFormat.h"
+#include "Socket.h"
+
+namespace VmbC
+{
+    namespace Examples
+    {
+        /**
+         * \brief Subscriber of the frames sent by a FrameStreamServer, e.g.
+         *        of a processing node on another host.
+         *
+         * An object may only be used by one thread at a time.
+         */
+        class FrameStreamClient
+        {
+        public:
+            /**
+             * \brief a frame received including a copy of its buffer
+             */
+            struct Frame
+            {
+                FrameStreamFormat::FrameHeader m_header {};
+                std::vector<unsigned char> m_buffer;
+
+                /**
+                 * \brief the frame with buffer and imageData pointing into
+                 *        m_buffer; the context members are null
+                 */
+                VmbFrame_t GetFrame() noexcept;
+            };
+
+            /**
+             * \brief connect to a server and read the stream header
+             * \throws VmbException, if the server cannot be reached or does
+             *                      not send a frame stream
+             */
+            FrameStreamClient(std::string const& host, VmbUint16_t port);
+
+            FrameStreamClient(FrameStreamClient const&) = delete;
+            FrameStreamClient& operator=(FrameStreamClient const&) = delete;
+
+            /**
+             * \brief wait until the next frame starts to arrive
+             * \return false, if the timeout elapsed before
+             */
+            bool WaitForFrame(std::chrono::milliseconds timeout) const noexcept;
+
+            /**
+             * \brief receive the next frame blocking until it is complete;
+             *        use WaitForFrame to wait longer than 10 s for a frame
+             * \param[out] frame the frame; the buffer is reused
+             * \return false, if the server closed the connection or the
+             *         frame did not arrive within 10 s
+             * \throws VmbException, if the data received is no valid frame
+             */
+            bool ReadFrame(Frame& frame);
+
+            /**
+             * \brief the number of frames the server left out for this client
+             *        so far
+             */
+            VmbUint64_t GetFramesSkipped() const noexcept
+            {
+                return m_framesSkipped;
+            }
+
+            void Close() noexcept;
+        protected:
+            /**
+             * \brief connect to a server sending frames with a different
+             *        stream header, e.g. WorkQueueServer
+             */
+            FrameStreamClient(std::string const& host, VmbUint16_t port, char const (&magic)[8], VmbUint32_t version);
+
+            Socket const& GetConnection() const noexcept
+            {
+                return m_connection;
+            }
+        private:
+            Socket m_connection;
+
+            /**
+             * \brief the size of the frame headers sent by the server
+             */
+            VmbUint32_t m_frameHeaderSize { 0 };
+
+            VmbUint64_t m_framesSkipped { 0 };
+        };
+    }
+}
+
+#endif
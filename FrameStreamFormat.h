@@ -0,0 +1,117 @@
+/**
+ * \date 2023
+ * \copyright Allied Vision Technologies.  All Rights Reserved.
+ *
+ * \copyright Redistribution of this file, in original or modified form, without
+ *            prior written consent of Allied Vision Technologies is prohibited.
+ *
+ * \warning THIS SOFTWARE IS PROVIDED BY THE AUTHOR "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF TITLE,
+ * NON-INFRINGEMENT, MERCHANTABILITY AND FITNESS FOR A PARTICULAR  PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \brief Layout of the frame stream sent to subscribers over TCP
+ */
+
+#ifndef ASYNCHRONOUSGRAB_C_FRAME_STREAM_FORMAT_H
+#define ASYNCHRONOUSGRAB_C_FRAME_STREAM_FORMAT_H
+
+#include <VmbC/VmbC.h>
+
+namespace VmbC
+{
+    namespace Examples
+    {
+        /**
+         * \brief Layout of the data sent by FrameStreamServer.
+         *
+         * A connection starts with a StreamHeader followed by one message per
+         * frame: a FrameHeader immediately followed by FrameHeader::m_bufferSize
+         * bytes of the frame buffer, including chunk data, if any. Subscribers
+         * connecting during an acquisition receive the frames starting with
+         * the next frame received; frames a subscriber falls behind on are
+         * left out, which shows as a gap of the frame IDs. All values are
+         * stored in the byte order of the sending system.
+         */
+        namespace FrameStreamFormat
+        {
+            constexpr char Magic[8] = { 'V', 'M', 'B', 'S', 'T', 'R', 'M', '\0' };
+
+            constexpr VmbUint32_t Version = 1;
+
+            /**
+             * \brief magic value of a FrameHeader; "FRAM"
+             */
+            constexpr VmbUint32_t FrameMagic = 0x4D415246;
+
+            struct StreamHeader
+            {
+                char m_magic[8];
+                VmbUint32_t m_version;
+
+                /**
+                 * \brief the size of the FrameHeader; newer versions may
+                 *        append members
+                 */
+                VmbUint32_t m_frameHeaderSize;
+            };
+
+            struct FrameHeader
+            {
+                VmbUint32_t m_magic;
+                VmbUint32_t m_pixelFormat;
+                VmbUint64_t m_bufferSize;
+                VmbUint64_t m_frameId;
+                VmbUint64_t m_timestamp;
+                VmbUint32_t m_width;
+                VmbUint32_t m_height;
+                VmbUint32_t m_offsetX;
+                VmbUint32_t m_offsetY;
+                VmbInt32_t m_receiveStatus;
+                VmbUint32_t m_receiveFlags;
+
+                /**
+                 * \brief offset of VmbFrame_t::imageData from the start of the
+                 *        frame buffer
+                 */
+                VmbUint32_t m_imageOffset;
+
+                /**
+                 * \brief the number of frames the server left out for this
+                 *        subscriber since the previous message
+                 */
+                VmbUint32_t m_framesSkipped;
+            };
+
+            /**
+             * \brief describe a frame in a header; m_framesSkipped is set to 0
+             */
+            inline void FillFrameHeader(FrameHeader& header, VmbFrame_t const& frame) noexcept
+            {
+                header.m_magic = FrameMagic;
+                header.m_pixelFormat = frame.pixelFormat;
+                header.m_bufferSize = frame.bufferSize;
+                header.m_frameId = frame.frameID;
+                header.m_timestamp = frame.timestamp;
+                header.m_width = frame.width;
+                header.m_height = frame.height;
+                header.m_offsetX = frame.offsetX;
+                header.m_offsetY = frame.offsetY;
+                header.m_receiveStatus = frame.receiveStatus;
+                header.m_receiveFlags = frame.receiveFlags;
+                header.m_imageOffset = (frame.imageData == nullptr)
+                    ? 0
+                    : static_cast<VmbUint32_t>(frame.imageData - static_cast<VmbUint8_t const*>(frame.buffer));
+                header.m_framesSkipped = 0;
+            }
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,429 @@
+/**
+ * \date 2023
+ * \copyright Allied Vision Technologies.  All Rights Reserved.
+ *
+ * \copyright Redistribution of this file, in original or modified form, without
+ *            prior written consent of Allied Vision Technologies is prohibited.
+ *
+ * \warning THIS SOFTWARE IS PROVIDED BY THE AUTHOR "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF TITLE,
+ * NON-INFRINGEMENT, MERCHANTABILITY AND FITNESS FOR A PARTICULAR  PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \brief Implementation of ::VmbC::Examples::FrameStreamServer
+ */
+
+#include <cstring>
+#include <iterator>
+
+#include "FrameCopy.h"
+#include "FrameStreamServer.h"
+#include "Tracing.h"
+#include "VmbException.h"
+
+namespace VmbC
+{
+    namespace Examples
+    {
+        namespace
+        {
+            /**
+             * \brief interval for checking, if the server should stop or a
+             *        subscriber disconnected
+             */
+            constexpr std::chrono::milliseconds StopCheckInterval { 100 };
+
+            /**
+             * \brief interval for checking for completed MSG_ZEROCOPY sends
+             *        while no frame is queued
+             */
+            constexpr std::chrono::milliseconds CompletionCheckInterval { 1 };
+        }
+
+        FrameStreamServer::FrameStreamServer(Settings const& settings)
+            : m_settings(settings),
+            m_slots(settings.m_slotCount),
+            m_listenSocket(Socket::Listen(settings.m_port, settings.m_loopbackOnly)),
+            m_port(m_listenSocket.GetLocalPort())
+        /* 槽的缓冲区在第一次使用时按帧大小分配。线程在最后启动，因为它会立即使用其他成员。 */
+        {
+            if (settings.m_slotCount == 0 || settings.m_maxLag == 0 || settings.m_maxSubscribers == 0)
+            {
+                throw VmbException("the slot count, the lag and the number of subscribers of the frame stream need to be positive", VmbErrorBadParameter);
+            }
+
+            m_freeSlots.reserve(settings.m_slotCount);
+            for (size_t slot = settings.m_slotCount; slot != 0; --slot)
+            {
+                m_freeSlots.push_back(slot - 1);
+            }
+            m_thread = std::thread(&FrameStreamServer::Serve, this);
+        }
+
+        FrameStreamServer::~FrameStreamServer()
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_stop = true;
+            }
+            m_condition.notify_all();
+            m_thread.join();
+        }
+
+        void FrameStreamServer::FrameReceived(VmbFrame_t const& frame)
+        /* 在VmbC回调线程中调用：没有订阅者时什么都不做。先在锁内取得空闲槽，没有空闲槽时从积压最多的订阅者的队列中丢弃帧，
+        直到有槽被释放；仍然没有时丢弃这一帧，从不等待订阅者线程。复制在锁外进行，此时槽只被本函数引用，
+        复制完成后才放入所有订阅者的队列，因此每帧只复制一次。 */
+        {
+            size_t index;
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                bool joined = false;
+                for (auto const& subscriber : m_subscribers)
+                {
+                    joined = joined || subscriber.m_joined;
+                }
+                if (!joined || m_stop)
+                {
+                    return;
+                }
+                ++m_framesReceived;
+
+                while (m_freeSlots.empty() && DropLaggingFrame())
+                {
+                }
+                if (m_freeSlots.empty())
+                {
+                    ++m_framesDropped;
+                    for (auto& subscriber : m_subscribers)
+                    {
+                        if (subscriber.m_joined)
+                        {
+                            ++subscriber.m_skipped;
+                            ++subscriber.m_framesDropped;
+                        }
+                    }
+                    return;
+                }
+                index = m_freeSlots.back();
+                m_freeSlots.pop_back();
+                m_slots[index].m_references = 1;
+            }
+
+            ASYNCHRONOUSGRAB_TRACE_SCOPE("CopyStreamFrame", frame.frameID);
+            Slot& slot = m_slots[index];
+            bool const copied = CopyToSlot(slot.m_buffer, frame.buffer, frame.bufferSize);
+
+            FrameStreamFormat::FillFrameHeader(slot.m_header, frame);
+            slot.m_received = Clock::now();
+
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                if (!copied)
+                {
+                    ++m_framesDropped;
+                }
+                for (auto& subscriber : m_subscribers)
+                {
+                    if (!subscriber.m_joined)
+                    {
+                        continue;
+                    }
+                    if (!copied)
+                    {
+                        ++subscriber.m_skipped;
+                        ++subscriber.m_framesDropped;
+                        continue;
+                    }
+                    if (subscriber.m_queue.size() >= m_settings.m_maxLag)
+                    {
+                        ReleaseSlot(subscriber.m_queue.front());
+                        subscriber.m_queue.pop_front();
+                        ++subscriber.m_skipped;
+                        ++subscriber.m_framesDropped;
+                    }
+                    subscriber.m_queue.push_back(index);
+                    ++slot.m_references;
+                }
+                ReleaseSlot(index);
+            }
+            m_condition.notify_all();
+        }
+
+        FrameStreamServer::Statistics FrameStreamServer::GetStatistics() const
+        {
+            Statistics statistics;
+            statistics.m_framesReceived = m_framesReceived.load(std::memory_order_relaxed);
+            statistics.m_framesDropped = m_framesDropped.load(std::memory_order_relaxed);
+
+            auto const now = Clock::now();
+            std::lock_guard<std::mutex> lock(m_mutex);
+            for (auto const& subscriber : m_subscribers)
+            {
+                if (subscriber.m_finished.load(std::memory_order_relaxed))
+                {
+                    continue;
+                }
+                SubscriberStatistics entry;
+                entry.m_peer = subscriber.m_peer;
+                entry.m_framesSent = subscriber.m_framesSent.load(std::memory_order_relaxed);
+                entry.m_framesDropped = subscriber.m_framesDropped.load(std::memory_order_relaxed);
+                entry.m_bytesSent = subscriber.m_bytesSent.load(std::memory_order_relaxed);
+                double const connectedTime = std::chrono::duration<double>(now - subscriber.m_connected).count();
+                if (connectedTime > 0)
+                {
+                    entry.m_throughput = static_cast<double>(entry.m_bytesSent) / connectedTime;
+                }
+                entry.m_queuedFrames = subscriber.m_queue.size();
+                if (!subscriber.m_queue.empty())
+                {
+                    entry.m_lag = now - m_slots[subscriber.m_queue.front()].m_received;
+                }
+                entry.m_zeroCopy = subscriber.m_zeroCopy.load(std::memory_order_relaxed);
+                entry.m_sendsCopied = subscriber.m_sendsCopied.load(std::memory_order_relaxed);
+                statistics.m_subscribers.push_back(std::move(entry));
+            }
+            return statistics;
+        }
+
+        void FrameStreamServer::Serve()
+        /* 后台线程：以 StopCheckInterval 为间隔等待新订阅者，每个订阅者由自己的线程服务。
+        FrameReceived 在锁内遍历订阅者列表，因此已结束的订阅者在锁内移出列表，但在锁外等待其线程结束，
+        因为订阅者线程结束前还需要锁来释放它引用的槽。 */
+        {
+            ASYNCHRONOUSGRAB_TRACE_THREAD_NAME("FrameStream server");
+
+            while (!m_stop)
+            {
+                std::list<Subscriber> finished;
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    for (auto pos = m_subscribers.begin(); pos != m_subscribers.end();)
+                    {
+                        auto const next = std::next(pos);
+                        if (pos->m_finished.load(std::memory_order_acquire))
+                        {
+                            finished.splice(finished.end(), m_subscribers, pos);
+                        }
+                        pos = next;
+                    }
+                }
+                for (auto& subscriber : finished)
+                {
+                    subscriber.m_thread.join();
+                }
+
+                if (!m_listenSocket.WaitReadable(StopCheckInterval))
+                {
+                    continue;
+                }
+
+                Socket connection = m_listenSocket.Accept();
+                if (!connection.IsValid())
+                {
+                    continue;
+                }
+
+                std::lock_guard<std::mutex> lock(m_mutex);
+                if (m_subscribers.size() >= m_settings.m_maxSubscribers)
+                {
+                    continue;
+                }
+                m_subscribers.emplace_back();
+                auto& subscriber = m_subscribers.back();
+                subscriber.m_peer = connection.GetPeerName();
+                subscriber.m_zeroCopy = m_settings.m_zeroCopy && connection.EnableZeroCopy();
+                subscriber.m_connection = std::move(connection);
+                subscriber.m_connected = Clock::now();
+                subscriber.m_thread = std::thread(&FrameStreamServer::ServeSubscriber, this, std::ref(subscriber));
+            }
+
+            for (auto& subscriber : m_subscribers)
+            {
+                subscriber.m_thread.join();
+            }
+            m_subscribers.clear();
+        }
+
+        void FrameStreamServer::ServeSubscriber(Subscriber& subscriber)
+        /* 发送流头后才标记为已加入，因此迟到的订阅者从下一帧开始接收，且流头一定在第一帧之前。
+        队列为空时检查订阅者是否断开；有尚未完成的零拷贝发送时以 CompletionCheckInterval 为间隔回收完成的槽，
+        否则槽会一直被占用直到下一帧。结束时释放队列中和仍在发送的槽：即使内核仍在发送，
+        重用这些槽也只会影响已关闭的连接。 */
+        {
+            ASYNCHRONOUSGRAB_TRACE_THREAD_NAME("FrameStream subscriber");
+
+            auto const& connection = subscriber.m_connection;
+            connection.SetSendTimeout(m_settings.m_sendTimeout);
+            connection.SetNoDelay();
+
+            FrameStreamFormat::StreamHeader streamHeader {};
+            std::memcpy(streamHeader.m_magic, FrameStreamFormat::Magic, sizeof(streamHeader.m_magic));
+            streamHeader.m_version = FrameStreamFormat::Version;
+            streamHeader.m_frameHeaderSize = sizeof(FrameStreamFormat::FrameHeader);
+            bool connected = connection.SendAll(&streamHeader, sizeof(streamHeader));
+
+            ZeroCopySends sends;
+            std::unique_lock<std::mutex> lock(m_mutex);
+            subscriber.m_joined = connected;
+            while (connected && !m_stop)
+            {
+                if (subscriber.m_queue.empty())
+                {
+                    m_condition.wait_for(lock,
+                                         sends.m_pending.empty() ? StopCheckInterval : CompletionCheckInterval,
+                                         [this, &subscriber]() { return m_stop || !subscriber.m_queue.empty(); });
+                }
+
+                if (!subscriber.m_queue.empty())
+                {
+                    size_t const slot = subscriber.m_queue.front();
+                    subscriber.m_queue.pop_front();
+                    VmbUint32_t const skipped = subscriber.m_skipped;
+                    subscriber.m_skipped = 0;
+                    lock.unlock();
+                    connected = SendFrame(subscriber, slot, skipped, sends);
+                }
+                else
+                {
+                    lock.unlock();
+                    char data[64];
+                    connected = !connection.WaitReadable(std::chrono::milliseconds(0)) || connection.Receive(data, sizeof(data)) > 0;
+                }
+                ReleaseCompleted(subscriber, sends, std::chrono::milliseconds(0));
+                lock.lock();
+            }
+
+            subscriber.m_connection.Close();
+            subscriber.m_joined = false;
+            for (size_t const slot : subscriber.m_queue)
+            {
+                ReleaseSlot(slot);
+            }
+            subscriber.m_queue.clear();
+            for (auto const& pending : sends.m_pending)
+            {
+                ReleaseSlot(pending.m_slot);
+            }
+            subscriber.m_finished.store(true, std::memory_order_release);
+        }
+
+        bool FrameStreamServer::SendFrame(Subscriber& subscriber, size_t const slot, VmbUint32_t const skipped, ZeroCopySends& sends)
+        /* 帧头包含该订阅者跳过的帧数，每个订阅者不同，因此单独复制发送；缓冲区直接从槽发送。
+        零拷贝发送失败时（例如内核为未完成的发送锁定的内存达到上限，ENOBUFS）先回收已完成的发送，
+        其余部分改为普通发送，不会因此断开连接。只要有一次零拷贝调用成功，槽就要等到内核报告完成后才能释放。 */
+        {
+            ASYNCHRONOUSGRAB_TRACE_SCOPE("SendStreamFrame", m_slots[slot].m_header.m_frameId);
+
+            auto const& connection = subscriber.m_connection;
+            Slot const& data = m_slots[slot];
+            FrameStreamFormat::FrameHeader header = data.m_header;
+            header.m_framesSkipped = skipped;
+
+            unsigned char const* buffer = data.m_buffer.GetData();
+            size_t remaining = static_cast<size_t>(header.m_bufferSize);
+            bool sentZeroCopy = false;
+            VmbUint32_t lastCall = 0;
+
+            bool success = connection.SendAll(&header, sizeof(header));
+            while (success && subscriber.m_zeroCopy && remaining != 0)
+            {
+                long const sent = connection.SendZeroCopy(buffer, remaining);
+                if (sent <= 0)
+                {
+                    ReleaseCompleted(subscriber, sends, std::chrono::milliseconds(0));
+                    break;
+                }
+                lastCall = sends.m_calls++;
+                sentZeroCopy = true;
+                buffer += sent;
+                remaining -= static_cast<size_t>(sent);
+            }
+            success = success && (remaining == 0 || connection.SendAll(buffer, remaining));
+
+            if (sentZeroCopy)
+            {
+                sends.m_pending.push_back({ slot, lastCall });
+            }
+            else
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                ReleaseSlot(slot);
+            }
+
+            if (success)
+            {
+                ++subscriber.m_framesSent;
+                subscriber.m_bytesSent += sizeof(header) + header.m_bufferSize;
+            }
+            return success;
+        }
+
+        void FrameStreamServer::ReleaseCompleted(Subscriber& subscriber, ZeroCopySends& sends, std::chrono::milliseconds timeout)
+        /* 内核按顺序完成零拷贝调用，并可能把多个调用合并为一个通知，因此只记录最后完成的编号，
+        之后释放调用编号不超过它的槽。编号会回绕，所以按差值的符号比较。
+        内核报告数据仍被复制时（例如回环接口），零拷贝只会让槽被占用到对方接收为止，因此之后改为普通发送。 */
+        {
+            VmbUint32_t last;
+            bool copied;
+            while (!sends.m_pending.empty() && subscriber.m_connection.ReceiveZeroCopyCompletion(last, copied, timeout))
+            {
+                if (copied)
+                {
+                    subscriber.m_sendsCopied += last - sends.m_completed;
+                    subscriber.m_zeroCopy = false;
+                }
+                sends.m_completed = last;
+                timeout = std::chrono::milliseconds(0);
+            }
+
+            if (sends.m_pending.empty()
+                || static_cast<VmbInt32_t>(sends.m_pending.front().m_call - sends.m_completed) > 0)
+            {
+                return;
+            }
+            std::lock_guard<std::mutex> lock(m_mutex);
+            while (!sends.m_pending.empty()
+                   && static_cast<VmbInt32_t>(sends.m_pending.front().m_call - sends.m_completed) <= 0)
+            {
+                ReleaseSlot(sends.m_pending.front().m_slot);
+                sends.m_pending.pop_front();
+            }
+        }
+
+        bool FrameStreamServer::DropLaggingFrame()
+        {
+            Subscriber* lagging = nullptr;
+            for (auto& subscriber : m_subscribers)
+            {
+                if (!subscriber.m_queue.empty() && (lagging == nullptr || subscriber.m_queue.size() > lagging->m_queue.size()))
+                {
+                    lagging = &subscriber;
+                }
+            }
+            if (lagging == nullptr)
+            {
+                return false;
+            }
+            ReleaseSlot(lagging->m_queue.front());
+            lagging->m_queue.pop_front();
+            ++lagging->m_skipped;
+            ++lagging->m_framesDropped;
+            return true;
+        }
+
+        void FrameStreamServer::ReleaseSlot(size_t const slot) noexcept
+        {
+            if (--m_slots[slot].m_references == 0)
+            {
+                m_freeSlots.push_back(slot);
+            }
+        }
+    }
+}
@@ -0,0 +1,339 @@
+/**
+ * \date 2023
+ * \copyright Allied Vision Technologies.  All Rights Reserved.
+ *
+ * \copyright Redistribution of this file, in original or modified form, without
+ *            prior written consent of Allied Vision Technologies is prohibited.
+ *
+ * \warning THIS SOFTWARE IS PROVIDED BY THE AUTHOR "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF TITLE,
+ * NON-INFRINGEMENT, MERCHANTABILITY AND FITNESS FOR A PARTICULAR  PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \brief Definition of a server sending the raw frames to subscribers via TCP
+ */
+
+#ifndef ASYNCHRONOUSGRAB_C_FRAME_STREAM_SERVER_H
+#define ASYNCHRONOUSGRAB_C_FRAME_STREAM_SERVER_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <list>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <VmbC/VmbC.h>
+
+#include "AlignedBuffer.h"
+#include "FrameSink.h"
+#include "FrameStreamFormat.h"
+#include "Socket.h"
+
+namespace VmbC
+{
+    namespace Examples
+    {
+        /**
+         * \brief Sends the raw frames of an acquisition to any number of
+         *        subscribers connected via TCP, e.g. processing nodes using
+         *        FrameStreamClient; see FrameStreamFormat for the protocol.
+         *
+         * FrameReceived copies each frame once into a free slot of a fixed
+         * pool and appends the slot to the send queue of every subscriber;
+         * the slot is reused after the last subscriber sent it. Every
+         * subscriber is served by its own thread, which sends the frame
+         * buffers straight from the slots with MSG_ZEROCOPY where the system
+         * supports it, so the data is not copied again per subscriber. If
+         * the kernel reports copying the data anyway, e.g. for subscribers of
+         * the local host, the subscriber is switched to ordinary sends, which
+         * release the slots earlier.
+         *
+         * A subscriber falling behind by more than m_maxLag frames loses the
+         * oldest frame of its queue; if no slot is free, the oldest frame
+         * queued for the subscriber lagging most is dropped. Neither blocks
+         * the VmbC callback thread or the other subscribers. Subscribers may
+         * connect at any time and receive the frames starting with the next
+         * one.
+         */
+        class FrameStreamServer : public RawFrameSink
+        {
+        public:
+            using Clock = std::chrono::steady_clock;
+
+            static constexpr VmbUint16_t DefaultPort = 5562;
+
+            struct Settings
+            {
+                /**
+                 * \brief the port to listen on; 0 chooses a free port
+                 */
+                VmbUint16_t m_port { DefaultPort };
+
+                /**
+                 * \brief if false, subscribers of other hosts are accepted
+                 */
+                bool m_loopbackOnly { true };
+
+                /**
+                 * \brief the number of frame copies shared by the subscribers
+                 */
+                size_t m_slotCount { 16 };
+
+                /**
+                 * \brief the maximum number of frames queued per subscriber
+                 */
+                size_t m_maxLag { 4 };
+
+                /**
+                 * \brief the maximum number of subscribers served at the same time
+                 */
+                unsigned m_maxSubscribers { 16 };
+
+                /**
+                 * \brief subscribers not receiving data for this time are
+                 *        disconnected
+                 */
+                std::chrono::milliseconds m_sendTimeout { 5000 };
+
+                /**
+                 * \brief send with MSG_ZEROCOPY, if supported
+                 */
+                bool m_zeroCopy { true };
+            };
+
+            struct SubscriberStatistics
+            {
+                /**
+                 * \brief address and port of the subscriber
+                 */
+                std::string m_peer;
+                VmbUint64_t m_framesSent { 0 };
+
+                /**
+                 * \brief frames left out, because the subscriber lagged behind
+                 */
+                VmbUint64_t m_framesDropped { 0 };
+                VmbUint64_t m_bytesSent { 0 };
+
+                /**
+                 * \brief the average data rate since the subscriber connected
+                 *        in bytes per second
+                 */
+                double m_throughput { 0.0 };
+
+                /**
+                 * \brief the frames waiting to be sent and the age of the
+                 *        oldest of them
+                 */
+                ///@{
+                size_t m_queuedFrames { 0 };
+                Clock::duration m_lag {};
+                ///@}
+
+                /**
+                 * \brief true, while the frames are sent with MSG_ZEROCOPY
+                 */
+                bool m_zeroCopy { false };
+
+                /**
+                 * \brief MSG_ZEROCOPY sends the kernel copied anyway, e.g. on
+                 *        the loopback interface; the subscriber is sent the
+                 *        following frames without MSG_ZEROCOPY
+                 */
+                VmbUint64_t m_sendsCopied { 0 };
+            };
+
+            struct Statistics
+            {
+                VmbUint64_t m_framesReceived { 0 };
+
+                /**
+                 * \brief frames not sent to any subscriber, because no slot
+                 *        could be freed
+                 */
+                VmbUint64_t m_framesDropped { 0 };
+                std::vector<SubscriberStatistics> m_subscribers;
+            };
+
+            /**
+             * \brief start listening for subscribers
+             * \throws VmbException, if the settings are invalid or the port
+             *                      cannot be bound
+             */
+            FrameStreamServer(Settings const& settings);
+
+            /**
+             * \brief disconnects the subscribers
+             */
+            ~FrameStreamServer();
+
+            FrameStreamServer(FrameStreamServer const&) = delete;
+            FrameStreamServer& operator=(FrameStreamServer const&) = delete;
+
+            void FrameReceived(VmbFrame_t const& frame) override;
+
+            VmbUint16_t GetPort() const noexcept
+            {
+                return m_port;
+            }
+
+            Statistics GetStatistics() const;
+        private:
+            struct Slot
+            {
+                AlignedBuffer m_buffer;
+                FrameStreamFormat::FrameHeader m_header {};
+                Clock::time_point m_received;
+
+                /**
+                 * \brief the number of subscribers that still need the slot
+                 */
+                unsigned m_references { 0 };
+            };
+
+            struct Subscriber
+            {
+                Socket m_connection;
+                std::string m_peer;
+                Clock::time_point m_connected;
+                std::thread m_thread;
+                std::atomic<bool> m_finished { false };
+
+                /**
+                 * \brief true, while the frames are sent with MSG_ZEROCOPY
+                 */
+                std::atomic<bool> m_zeroCopy { false };
+
+                /**
+                 * \name State guarded by m_mutex of the server
+                 */
+                ///@{
+                /**
+                 * \brief false until the stream header was sent
+                 */
+                bool m_joined { false };
+                std::deque<size_t> m_queue;
+
+                /**
+                 * \brief frames left out since the last frame sent
+                 */
+                VmbUint32_t m_skipped { 0 };
+                ///@}
+
+                std::atomic<VmbUint64_t> m_framesSent { 0 };
+                std::atomic<VmbUint64_t> m_framesDropped { 0 };
+                std::atomic<VmbUint64_t> m_bytesSent { 0 };
+                std::atomic<VmbUint64_t> m_sendsCopied { 0 };
+            };
+
+            /**
+             * \brief the MSG_ZEROCOPY sends of a subscriber; only accessed by
+             *        the thread of the subscriber
+             */
+            struct ZeroCopySends
+            {
+                /**
+                 * \brief a slot sent, but not completed yet
+                 */
+                struct Pending
+                {
+                    size_t m_slot;
+
+                    /**
+                     * \brief the number of the last SendZeroCopy call for the slot
+                     */
+                    VmbUint32_t m_call;
+                };
+
+                std::deque<Pending> m_pending;
+
+                /**
+                 * \brief the number of SendZeroCopy calls sending data
+                 */
+                VmbUint32_t m_calls { 0 };
+
+                /**
+                 * \brief the number of the last call completed
+                 */
+                VmbUint32_t m_completed { ~VmbUint32_t(0) };
+            };
+
+            Settings const m_settings;
+
+            std::vector<Slot> m_slots;
+
+            mutable std::mutex m_mutex;
+
+            /**
+             * \brief notified when frames are queued or m_stop is set
+             */
+            std::condition_variable m_condition;
+
+            /**
+             * \name State guarded by m_mutex
+             */
+            ///@{
+            std::vector<size_t> m_freeSlots;
+            std::list<Subscriber> m_subscribers;
+            ///@}
+
+            std::atomic<bool> m_stop { false };
+            std::atomic<VmbUint64_t> m_framesReceived { 0 };
+            std::atomic<VmbUint64_t> m_framesDropped { 0 };
+
+            Socket m_listenSocket;
+            VmbUint16_t m_port;
+            std::thread m_thread;
+
+            /**
+             * \brief accept subscribers and join the threads of the closed ones
+             */
+            void Serve();
+
+            /**
+             * \brief send the frames queued for a subscriber until it
+             *        disconnects or the server is destroyed
+             */
+            void ServeSubscriber(Subscriber& subscriber);
+
+            /**
+             * \brief send the header and the buffer of a frame; the reference
+             *        of the subscriber to the slot is released after sending
+             *        or, for MSG_ZEROCOPY, after the send completed
+             * \return false, if the connection failed
+             */
+            bool SendFrame(Subscriber& subscriber, size_t slot, VmbUint32_t skipped, ZeroCopySends& sends);
+
+            /**
+             * \brief release the slots of completed MSG_ZEROCOPY sends
+             * \param[in] timeout the time to wait for the first completion
+             */
+            void ReleaseCompleted(Subscriber& subscriber, ZeroCopySends& sends, std::chrono::milliseconds timeout);
+
+            /**
+             * \brief drop the oldest frame queued for the subscriber with the
+             *        longest queue to free a slot; m_mutex needs to be locked
+             * \return false, if no frame is queued
+             */
+            bool DropLaggingFrame();
+
+            /**
+             * \brief release a reference of a slot; m_mutex needs to be locked
+             */
+            void ReleaseSlot(size_t slot) noexcept;
+        };
+    }
+}
+
+#endif
@@ -0,0 +1,273 @@
+/**
+ * \date 2023
+ * \copyright Allied Vision Technologies.  All Rights Reserved.
+ *
+ * \copyright Redistribution of this file, in original or modified form, without
+ *            prior written consent of Allied Vision Technologies is prohibited.
+ *
+ * \warning THIS SOFTWARE IS PROVIDED BY THE AUTHOR "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF TITLE,
+ * NON-INFRINGEMENT, MERCHANTABILITY AND FITNESS FOR A PARTICULAR  PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \brief Implementation of ::VmbC::Examples::HistoryBuffer
+ */
+
+#include <algorithm>
+#include <cstring>
+
+#include "HistoryBuffer.h"
+#include "Tracing.h"
+#include "VmbException.h"
+
+namespace VmbC
+{
+    namespace Examples
+    {
+        namespace
+        {
+            /**
+             * \brief the alignment of the entries in the slab and the space
+             *        reserved for the entry header; since the slab size and
+             *        all entry sizes are multiples of this, an entry header
+             *        always fits in front of the end of the slab
+             */
+            constexpr size_t EntryAlignment = 256;
+        }
+
+        HistoryBuffer::HistoryBuffer(Settings const& settings)
+            : m_slab(AlignedBuffer::AlignUp((std::max)(settings.m_capacity, EntryAlignment), EntryAlignment), EntryAlignment),
+            m_duration(settings.m_duration)
+        {
+            static_assert(sizeof(Entry) <= EntryAlignment, "the entry header needs to fit into the space reserved");
+        }
+
+        HistoryBuffer::~HistoryBuffer()
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_stopDump = true;
+            }
+            m_condition.notify_all();
+            if (m_dumpThread.joinable())
+            {
+                m_dumpThread.join();
+            }
+        }
+
+        bool HistoryBuffer::MakeSpace(VmbUint64_t const padding, VmbUint64_t const size, Clock::time_point const now)
+        /* 从最旧的一端丢弃条目，直到新帧（包括缓冲区末尾的填充）可以放入，并且最旧的帧不超过设定的时长。
+        转存期间尚未写入文件的条目不会被丢弃；这时如果空间不足，由调用者丢弃新帧。 */
+        {
+            VmbUint64_t const slabSize = m_slab.GetSize();
+            while (m_tail != m_head)
+            {
+                Entry const& oldest = GetEntry(m_tail);
+                bool const full = m_head + padding + size - m_tail > slabSize;
+                bool const expired = m_duration != Clock::duration::zero()
+                    && now - Clock::time_point(Clock::duration(oldest.m_receiveTime)) > m_duration;
+                if ((!full && !expired && !oldest.m_padding) || (m_dumping && m_tail == m_dumpPosition))
+                {
+                    break;
+                }
+                if (!oldest.m_padding)
+                {
+                    --m_frameCount;
+                }
+                m_tail += oldest.m_size;
+            }
+            return m_head + padding + size - m_tail <= slabSize;
+        }
+
+        void HistoryBuffer::FrameReceived(VmbFrame_t const& frame)
+        /* 在VmbC回调线程中调用：在预先分配的内存块中为帧预留连续的空间（必要时先丢弃最旧的帧），
+        然后在不持有锁的情况下复制帧数据，最后再公开新的条目。预留的空间在公开之前不会被转存线程读取，
+        因此复制期间转存线程和GUI线程不会被阻塞。每一帧都不会分配内存。 */
+        {
+            ASYNCHRONOUSGRAB_TRACE_SCOPE("StoreHistory", frame.frameID);
+
+            auto const now = Clock::now();
+            VmbUint64_t const slabSize = m_slab.GetSize();
+            VmbUint64_t const size = EntryAlignment + AlignedBuffer::AlignUp(frame.bufferSize, EntryAlignment);
+
+            VmbUint64_t position;
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                size_t const offset = static_cast<size_t>(m_head % slabSize);
+                VmbUint64_t const padding = (offset + size > slabSize) ? slabSize - offset : 0;
+                if (size > slabSize || !MakeSpace(padding, size, now))
+                {
+                    m_framesDropped.fetch_add(1, std::memory_order_relaxed);
+                    return;
+                }
+                if (padding != 0)
+                {
+                    Entry& paddingEntry = GetEntry(m_head);
+                    paddingEntry.m_size = padding;
+                    paddingEntry.m_receiveTime = now.time_since_epoch().count();
+                    paddingEntry.m_padding = true;
+                    m_head += padding;
+                }
+                position = m_head;
+            }
+
+            Entry& entry = GetEntry(position);
+            unsigned char* const data = reinterpret_cast<unsigned char*>(&entry) + EntryAlignment;
+            std::memcpy(data, frame.buffer, frame.bufferSize);
+            entry.m_size = size;
+            entry.m_receiveTime = now.time_since_epoch().count();
+            entry.m_padding = false;
+            entry.m_frame = frame;
+            entry.m_frame.buffer = data;
+            entry.m_frame.imageData = (frame.imageData == nullptr)
+                ? nullptr
+                : data + (frame.imageData - static_cast<VmbUint8_t const*>(frame.buffer));
+            std::memset(entry.m_frame.context, 0, sizeof(entry.m_frame.context));
+            auto const metadata = GetFrameMetadata(frame);
+            entry.m_metadata = (metadata == nullptr) ? FrameMetadata {} : *metadata;
+            SetFrameMetadata(entry.m_frame, &entry.m_metadata);
+
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_head = position + size;
+                ++m_frameCount;
+                m_newestTime = now;
+            }
+            m_framesStored.fetch_add(1, std::memory_order_relaxed);
+            m_condition.notify_all();
+        }
+
+        void HistoryBuffer::Dump(DumpSettings const& settings)
+        /* 记录触发时间并固定当前最旧的条目，使其在写入文件之前不会被丢弃，然后在后台线程中转存。
+        上一次转存的线程可能仍在完成文件（写入索引），因此在启动新线程之前等待它结束。 */
+        {
+            auto const triggerTime = Clock::now();
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                if (m_dumping)
+                {
+                    throw VmbException("a dump of the history is in progress already");
+                }
+                m_dumping = true;
+                m_stopDump = false;
+                m_dumpPosition = m_tail;
+                m_dumpEnd = triggerTime + settings.m_postTriggerDuration;
+            }
+
+            std::unique_ptr<RecordingSink> sink;
+            try
+            {
+                sink.reset(new RecordingSink(settings.m_recording));
+            }
+            catch (...)
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_dumping = false;
+                throw;
+            }
+
+            if (m_dumpThread.joinable())
+            {
+                m_dumpThread.join();
+            }
+            m_dumpThread = std::thread(&HistoryBuffer::WriteDump, this, std::move(sink), settings);
+        }
+
+        void HistoryBuffer::WriteDump(std::unique_ptr<RecordingSink> sink, DumpSettings settings)
+        /* 转存线程：按顺序把条目交给 RecordingSink，每写入一个条目就释放它，使采集线程可以继续使用这部分空间。
+        与实时录制不同，这里在 RecordingSink 的环形缓冲区已满时等待，而不是丢弃帧。
+        追上最新的帧后等待新帧，直到触发后的时长结束；之后接收的帧不再写入。 */
+        {
+            ASYNCHRONOUSGRAB_TRACE_THREAD_NAME("HistoryDump");
+
+            std::unique_lock<std::mutex> lock(m_mutex);
+            while (true)
+            {
+                if (m_dumpPosition == m_head)
+                {
+                    if (m_stopDump || Clock::now() >= m_dumpEnd)
+                    {
+                        break;
+                    }
+                    m_condition.wait_until(lock, m_dumpEnd, [this]() { return m_stopDump || m_dumpPosition != m_head; });
+                    continue;
+                }
+
+                Entry const& entry = GetEntry(m_dumpPosition);
+                VmbUint64_t const next = m_dumpPosition + entry.m_size;
+                if (!entry.m_padding)
+                {
+                    if (Clock::time_point(Clock::duration(entry.m_receiveTime)) > m_dumpEnd)
+                    {
+                        break;
+                    }
+                    lock.unlock();
+                    if (sink->WaitForSpace(entry.m_frame.bufferSize))
+                    {
+                        sink->FrameReceived(entry.m_frame);
+                    }
+                    lock.lock();
+                }
+                m_dumpPosition = next;
+            }
+            m_dumping = false;
+            lock.unlock();
+
+            sink->Stop();
+            auto const statistics = sink->GetStatistics();
+
+            DumpResult result;
+            result.m_fileName = sink->GetFileName();
+            result.m_framesWritten = statistics.m_framesRecorded;
+            result.m_writeFailed = statistics.m_writeFailed;
+            if (settings.m_finished)
+            {
+                settings.m_finished(result);
+            }
+        }
+
+        void HistoryBuffer::Clear()
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_tail = m_dumping ? m_dumpPosition : m_head;
+            m_frameCount = 0;
+            for (VmbUint64_t position = m_tail; position != m_head; position += GetEntry(position).m_size)
+            {
+                if (!GetEntry(position).m_padding)
+                {
+                    ++m_frameCount;
+                }
+            }
+        }
+
+        HistoryBuffer::Statistics HistoryBuffer::GetStatistics() const
+        {
+            Statistics result;
+            result.m_framesStored = m_framesStored.load(std::memory_order_relaxed);
+            result.m_framesDropped = m_framesDropped.load(std::memory_order_relaxed);
+            result.m_capacity = m_slab.GetSize();
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+            result.m_framesInHistory = m_frameCount;
+            result.m_bytesInHistory = static_cast<size_t>(m_head - m_tail);
+            result.m_dumping = m_dumping;
+
+            VmbUint64_t oldest = m_tail;
+            while (oldest != m_head && GetEntry(oldest).m_padding)
+            {
+                oldest += GetEntry(oldest).m_size;
+            }
+            if (oldest != m_head)
+            {
+                result.m_historyDuration = m_newestTime - Clock::time_point(Clock::duration(GetEntry(oldest).m_receiveTime));
+            }
+            return result;
+        }
+    }
+}
@@ -0,0 +1,240 @@
+/**
+ * \date 2023
+ * \copyright Allied Vision Technologies.  All Rights Reserved.
+ *
+ * \copyright Redistribution of this file, in original or modified form, without
+ *            prior written consent of Allied Vision Technologies is prohibited.
+ *
+ * \warning THIS SOFTWARE IS PROVIDED BY THE AUTHOR "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF TITLE,
+ * NON-INFRINGEMENT, MERCHANTABILITY AND FITNESS FOR A PARTICULAR  PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \brief Definition of a ring of recent raw frames kept in memory
+ */
+
+#ifndef ASYNCHRONOUSGRAB_C_HISTORY_BUFFER_H
+#define ASYNCHRONOUSGRAB_C_HISTORY_BUFFER_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include <VmbC/VmbC.h>
+
+#include "AlignedBuffer.h"
+#include "FrameMetadata.h"
+#include "FrameSink.h"
+#include "RecordingSink.h"
+
+namespace VmbC
+{
+    namespace Examples
+    {
+        /**
+         * \brief Keeps copies of the most recent raw frames in memory to be
+         *        able to record the frames preceding an event.
+         *
+         * The frames are copied into a slab allocated once; the oldest frames
+         * are discarded when the slab is full or when they are older than
+         * the configured duration. Dump writes the frames kept plus the
+         * frames received during a given time after the call to a recording
+         * in a background thread; the acquisition continues meanwhile.
+         */
+        class HistoryBuffer : public RawFrameSink
+        {
+        public:
+            using Clock = std::chrono::steady_clock;
+
+            struct Settings
+            {
+                /**
+                 * \brief the size of the slab; limits the bytes kept
+                 */
+                size_t m_capacity { size_t(1) << 30 };
+
+                /**
+                 * \brief the maximum age of the frames kept; zero to only
+                 *        limit the history by m_capacity
+                 */
+                Clock::duration m_duration { std::chrono::seconds(10) };
+            };
+
+            struct DumpResult
+            {
+                std::string m_fileName;
+
+                /**
+                 * \brief the frames written, including the ones received after
+                 *        the dump was requested
+                 */
+                VmbUint64_t m_framesWritten { 0 };
+                bool m_writeFailed { false };
+            };
+
+            struct DumpSettings
+            {
+                RecordingSink::Settings m_recording;
+
+                /**
+                 * \brief the time after the call to Dump the frames received
+                 *        are added to the recording
+                 */
+                Clock::duration m_postTriggerDuration { std::chrono::seconds(5) };
+
+                /**
+                 * \brief called from the background thread after the file was
+                 *        completed; may be empty
+                 */
+                std::function<void(DumpResult const&)> m_finished;
+            };
+
+            struct Statistics
+            {
+                VmbUint64_t m_framesStored { 0 };
+
+                /**
+                 * \brief frames not kept, because the frames ahead of them
+                 *        were not written by a running dump yet
+                 */
+                VmbUint64_t m_framesDropped { 0 };
+                size_t m_framesInHistory { 0 };
+                size_t m_bytesInHistory { 0 };
+                size_t m_capacity { 0 };
+
+                /**
+                 * \brief the time between the oldest and the newest frame kept
+                 */
+                Clock::duration m_historyDuration {};
+                bool m_dumping { false };
+            };
+
+            /**
+             * \brief allocate the slab
+             * \throws VmbException, if the slab cannot be allocated
+             */
+            HistoryBuffer(Settings const& settings);
+
+            /**
+             * \brief waits for a running dump to complete
+             */
+            ~HistoryBuffer();
+
+            HistoryBuffer(HistoryBuffer const&) = delete;
+            HistoryBuffer& operator=(HistoryBuffer const&) = delete;
+
+            void FrameReceived(VmbFrame_t const& frame) override;
+
+            /**
+             * \brief start writing the frames kept and the frames received
+             *        during DumpSettings::m_postTriggerDuration to a recording
+             *
+             * While dumping, frames are only discarded after they were
+             * written; if the disk is too slow, new frames are dropped
+             * instead.
+             *
+             * \throws VmbException, if a dump is running already or the
+             *                      recording cannot be created
+             */
+            void Dump(DumpSettings const& settings);
+
+            /**
+             * \brief discard the frames kept that are not part of a running dump
+             */
+            void Clear();
+
+            Statistics GetStatistics() const;
+        private:
+            /**
+             * \brief the header preceding the data of each frame in the slab
+             */
+            struct Entry
+            {
+                /**
+                 * \brief the size of the entry including the header and the
+                 *        alignment; a padding entry fills the end of the slab
+                 *        if the next frame does not fit
+                 */
+                VmbUint64_t m_size;
+                Clock::rep m_receiveTime;
+                bool m_padding;
+
+                /**
+                 * \brief the frame with the buffer members referring to the slab
+                 *        and the metadata to m_metadata
+                 */
+                VmbFrame_t m_frame;
+                FrameMetadata m_metadata;
+            };
+
+            AlignedBuffer m_slab;
+            Clock::duration const m_duration;
+
+            mutable std::mutex m_mutex;
+            std::condition_variable m_condition;
+
+            /**
+             * \name State guarded by m_mutex
+             * \brief positions in the slab counted in bytes since the start
+             */
+            ///@{
+            VmbUint64_t m_head { 0 };
+            VmbUint64_t m_tail { 0 };
+
+            /**
+             * \brief the next entry to be written by the dump; entries
+             *        starting at this position are not discarded
+             */
+            VmbUint64_t m_dumpPosition { 0 };
+            bool m_dumping { false };
+            bool m_stopDump { false };
+            Clock::time_point m_dumpEnd;
+            size_t m_frameCount { 0 };
+
+            /**
+             * \brief the receive time of the newest frame
+             */
+            Clock::time_point m_newestTime;
+            ///@}
+
+            std::atomic<VmbUint64_t> m_framesStored { 0 };
+            std::atomic<VmbUint64_t> m_framesDropped { 0 };
+
+            std::thread m_dumpThread;
+
+            Entry& GetEntry(VmbUint64_t position) noexcept
+            {
+                return *reinterpret_cast<Entry*>(m_slab.GetData() + position % m_slab.GetSize());
+            }
+
+            Entry const& GetEntry(VmbUint64_t position) const noexcept
+            {
+                return *reinterpret_cast<Entry const*>(m_slab.GetData() + position % m_slab.GetSize());
+            }
+
+            /**
+             * \brief discard entries at the tail until a frame of the given
+             *        size fits and the oldest frame is young enough;
+             *        requires m_mutex
+             * \return false, if the frame does not fit because of a running dump
+             */
+            bool MakeSpace(VmbUint64_t padding, VmbUint64_t size, Clock::time_point now);
+
+            void WriteDump(std::unique_ptr<RecordingSink> sink, DumpSettings settings);
+        };
+    }
+}
+
+#endif
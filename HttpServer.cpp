@@ -0,0 +1,166 @@
+/**
+ * \date 2023
+ * \copyright Allied Vision Technologies.  All Rights Reserved.
+ *
+ * \copyright Redistribution of this file, in original or modified form, without
+ *            prior written consent of Allied Vision Technologies is prohibited.
+ *
+ * \warning THIS SOFTWARE IS PROVIDED BY THE AUTHOR "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF TITLE,
+ * NON-INFRINGEMENT, MERCHANTABILITY AND FITNESS FOR A PARTICULAR  PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \brief Implementation of ::VmbC::Examples::HttpServer
+ */
+
+#include <chrono>
+#include <cstring>
+#include <sstream>
+
+#include "HttpServer.h"
+
+namespace VmbC
+{
+    namespace Examples
+    {
+        namespace
+        {
+            /**
+             * \brief interval for checking, if the server should stop
+             */
+            constexpr std::chrono::milliseconds StopCheckInterval { 100 };
+
+            /**
+             * \brief time a client may take to send its request
+             */
+            constexpr std::chrono::milliseconds RequestTimeout { 1000 };
+
+            /**
+             * \brief requests with longer headers are rejected
+             */
+            constexpr size_t MaxRequestSize = 8192;
+
+            char const* GetReasonPhrase(int status) noexcept
+            {
+                switch (status)
+                {
+                case 200:
+                    return "OK";
+                case 400:
+                    return "Bad Request";
+                case 404:
+                    return "Not Found";
+                case 405:
+                    return "Method Not Allowed";
+                case 503:
+                    return "Service Unavailable";
+                default:
+                    return "Internal Server Error";
+                }
+            }
+        }
+
+        HttpServer::HttpServer(VmbUint16_t const port, Handler handler)
+            : m_handler(std::move(handler)),
+            m_listenSocket(Socket::Listen(port)),
+            m_port(m_listenSocket.GetLocalPort()),
+            m_thread(&HttpServer::Serve, this)
+        /* 绑定本机端口并启动后台线程。m_thread 必须最后初始化，因为线程会立即使用其他成员。 */
+        {
+        }
+
+        HttpServer::~HttpServer()
+        {
+            m_stop = true;
+            m_thread.join();
+        }
+
+        bool HttpServer::ReadRequest(Socket const& connection, Request& request)
+        /* 读取请求头直到空行，只解析请求行中的方法和路径；请求体和其余的头部被忽略。 */
+        {
+            connection.SetReceiveTimeout(RequestTimeout);
+
+            std::string data;
+            char buffer[1024];
+            while (data.find("\r\n\r\n") == std::string::npos)
+            {
+                if (data.size() > MaxRequestSize)
+                {
+                    return false;
+                }
+                auto const received = connection.Receive(buffer, sizeof(buffer));
+                if (received <= 0)
+                {
+                    return false;
+                }
+                data.append(buffer, static_cast<size_t>(received));
+            }
+
+            std::istringstream requestLine(data.substr(0, data.find("\r\n")));
+            requestLine >> request.m_method >> request.m_path;
+            return !request.m_method.empty() && !request.m_path.empty();
+        }
+
+        bool HttpServer::SendResponse(Socket const& connection, Response const& response)
+        {
+            std::ostringstream header;
+            header << "HTTP/1.1 " << response.m_status << ' ' << GetReasonPhrase(response.m_status) << "\r\n"
+                   << "Content-Type: " << response.m_contentType << "\r\n"
+                   << "Content-Length: " << response.m_body.size() << "\r\n"
+                   << "Connection: close\r\n"
+                   << "\r\n";
+            std::string const headerText = header.str();
+            return connection.SendAll(headerText.data(), headerText.size())
+                && connection.SendAll(response.m_body.data(), response.m_body.size());
+        }
+
+        void HttpServer::Serve()
+        /* 后台线程：以 StopCheckInterval 为间隔等待新连接，以便析构时能及时退出。
+        每个连接读取一个请求，调用处理函数生成响应，发送后关闭连接。 */
+        {
+            while (!m_stop)
+            {
+                if (!m_listenSocket.WaitReadable(StopCheckInterval))
+                {
+                    continue;
+                }
+
+                Socket connection = m_listenSocket.Accept();
+                if (!connection.IsValid())
+                {
+                    continue;
+                }
+
+                Request request;
+                Response response;
+                if (!ReadRequest(connection, request))
+                {
+                    response.m_status = 400;
+                }
+                else if (request.m_method != "GET")
+                {
+                    response.m_status = 405;
+                }
+                else
+                {
+                    try
+                    {
+                        m_handler(request, response);
+                    }
+                    catch (std::exception const& ex)
+                    {
+                        response.m_status = 500;
+                        response.m_body = ex.what();
+                    }
+                }
+                SendResponse(connection, response);
+            }
+        }
+    }
+}
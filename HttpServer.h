@@ -0,0 +1,113 @@
+/**
+ * \date 2023
+ * \copyright Allied Vision Technologies.  All Rights Reserved.
+ *
+ * \copyright Redistribution of this file, in original or modified form, without
+ *            prior written consent of Allied Vision Technologies is prohibited.
+ *
+ * \warning THIS SOFTWARE IS PROVIDED BY THE AUTHOR "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF TITLE,
+ * NON-INFRINGEMENT, MERCHANTABILITY AND FITNESS FOR A PARTICULAR  PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \brief Definition of a minimal HTTP server running in a background thread
+ */
+
+#ifndef ASYNCHRONOUSGRAB_C_HTTP_SERVER_H
+#define ASYNCHRONOUSGRAB_C_HTTP_SERVER_H
+
+#include <atomic>
+#include <functional>
+#include <string>
+#include <thread>
+
+#include <VmbC/VmbC.h>
+
+#include "Socket.h"
+
+namespace VmbC
+{
+    namespace Examples
+    {
+        /**
+         * \brief Minimal HTTP/1.1 server answering GET requests in a
+         *        background thread.
+         *
+         * Connections are served one after the other and closed after the
+         * response, which is sufficient for infrequent requests such as
+         * metric scrapes.
+         */
+        class HttpServer
+        {
+        public:
+            struct Request
+            {
+                std::string m_method;
+                std::string m_path;
+            };
+
+            struct Response
+            {
+                int m_status { 200 };
+                std::string m_contentType { "text/plain; charset=utf-8" };
+                std::string m_body;
+            };
+
+            /**
+             * \brief function filling the response for a request; called by
+             *        the background thread
+             */
+            using Handler = std::function<void(Request const&, Response&)>;
+
+            /**
+             * \brief start listening on a port of the loopback interface
+             * \param[in] port the port to listen on; 0 chooses a free port
+             * \throws VmbException, if the port cannot be bound
+             */
+            HttpServer(VmbUint16_t port, Handler handler);
+
+            /**
+             * \brief stops the background thread
+             */
+            ~HttpServer();
+
+            HttpServer(HttpServer const&) = delete;
+            HttpServer& operator=(HttpServer const&) = delete;
+
+            /**
+             * \brief get the port the server is listening on
+             */
+            VmbUint16_t GetPort() const noexcept
+            {
+                return m_port;
+            }
+
+            /**
+             * \brief read the request line of a connection
+             * \return false, if the request could not be read
+             */
+            static bool ReadRequest(Socket const& connection, Request& request);
+
+            /**
+             * \brief send a complete response including the headers
+             */
+            static bool SendResponse(Socket const& connection, Response const& response);
+        private:
+            Handler m_handler;
+            Socket m_listenSocket;
+            VmbUint16_t m_port;
+            std::atomic<bool> m_stop { false };
+            std::thread m_thread;
+
+            void Serve();
+        };
+    }
+}
+
+#endif
@@ -72,6 +72,23 @@ namespace VmbC
         /* 用于将当前图像对象转换为另一个图像对象。
         它接受另一个图像对象作为参数，并将当前图像对象转换为与参数图像对象相同的像素格式和尺寸。
         转换过程使用 Vimba API 提供的函数进行图像转换和重新分配内存。 */
+        {
+            Transform(conversionSource, nullptr, 0);
+        }
+
+        void Image::Convert(Image const& conversionSource, VmbDebayerMode_t const debayerMode)
+        /* 与上面的转换相同，但通过 VmbSetDebayerMode 指定 Bayer 格式的插值算法，例如预览降级时使用开销较小的2x2插值。 */
+        {
+            VmbTransformInfo parameter;
+            auto const error = VmbSetDebayerMode(debayerMode, &parameter);
+            if (error != VmbErrorSuccess)
+            {
+                throw VmbException::ForOperation(error, "VmbSetDebayerMode");
+            }
+            Transform(conversionSource, &parameter, 1);
+        }
+
+        void Image::Transform(Image const& conversionSource, VmbTransformInfo const* parameters, VmbUint32_t const parameterCount)
         {
             if (&conversionSource == this)
             {
@@ -105,7 +122,7 @@ namespace VmbC
                 m_capacity = requiredCapacity;
             }
 
-            error = VmbImageTransform(&conversionSource.m_image, &m_image, nullptr, 0);
+            error = VmbImageTransform(&conversionSource.m_image, &m_image, parameters, parameterCount);
             if (error != VmbErrorSuccess)
             {
                 throw VmbException::ForOperation(error, "VmbImageTransform");
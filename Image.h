@@ -62,6 +62,8 @@ namespace VmbC
 
             int GetHeight() const noexcept { return m_image.ImageInfo.Height; }
 
+            VmbPixelFormat_t GetPixelFormat() const noexcept { return m_pixelFormat; }
+
             /**
              * \brief gets the bytes used for one image line for use in the transformation target/QImage constructor.
              * 
@@ -85,7 +87,19 @@ namespace VmbC
              * \brief convert the data of conversionImage to the pixel format of this image
              */
             void Convert(Image const& conversionSource);
+
+            /**
+             * \brief convert the data of a Bayer image to the pixel format of
+             *        this image using the given demosaicing algorithm
+             */
+            void Convert(Image const& conversionSource, VmbDebayerMode_t debayerMode);
         private:
+            /**
+             * \brief resize the buffer of this image for conversionSource and
+             *        pass the transformation parameters to VmbImageTransform
+             */
+            void Transform(Image const& conversionSource, VmbTransformInfo const* parameters, VmbUint32_t parameterCount);
+
             bool m_dataOwned{true};
             VmbImage m_image;
             VmbPixelFormat_t m_pixelFormat;
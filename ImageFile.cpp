@@ -0,0 +1,359 @@
+/**
+ * \date 2023
+ * \copyright Allied Vision Technologies.  All Rights Reserved.
+ *
+ * \copyright Redistribution of this file, in original or modified form, without
+ *            prior written consent of Allied Vision Technologies is prohibited.
+ *
+ * \warning THIS SOFTWARE IS PROVIDED BY THE AUTHOR "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF TITLE,
+ * NON-INFRINGEMENT, MERCHANTABILITY AND FITNESS FOR A PARTICULAR  PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \brief Implementation of the functions writing PNG and TIFF files
+ */
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <fstream>
+
+#include "ImageFile.h"
+#include "VmbException.h"
+
+namespace VmbC
+{
+    namespace Examples
+    {
+        namespace ImageFile
+        {
+            namespace
+            {
+                /**
+                 * \brief the maximum amount of data in a stored deflate block
+                 */
+                constexpr size_t MaxStoredBlockSize = 65535;
+
+                /**
+                 * \brief the maximum amount of data written to a single IDAT chunk
+                 */
+                constexpr size_t MaxChunkSize = size_t(1) << 20;
+
+                class Crc32
+                {
+                public:
+                    void Update(unsigned char const* data, size_t size) noexcept
+                    {
+                        static std::array<VmbUint32_t, 256> const table = CreateTable();
+                        VmbUint32_t crc = m_value;
+                        for (size_t i = 0; i != size; ++i)
+                        {
+                            crc = table[(crc ^ data[i]) & 0xff] ^ (crc >> 8);
+                        }
+                        m_value = crc;
+                    }
+
+                    VmbUint32_t GetValue() const noexcept
+                    {
+                        return m_value ^ 0xffffffffu;
+                    }
+                private:
+                    VmbUint32_t m_value { 0xffffffffu };
+
+                    static std::array<VmbUint32_t, 256> CreateTable() noexcept
+                    {
+                        std::array<VmbUint32_t, 256> table;
+                        for (VmbUint32_t n = 0; n != 256; ++n)
+                        {
+                            VmbUint32_t c = n;
+                            for (int k = 0; k != 8; ++k)
+                            {
+                                c = (c & 1) ? (0xedb88320u ^ (c >> 1)) : (c >> 1);
+                            }
+                            table[n] = c;
+                        }
+                        return table;
+                    }
+                };
+
+                VmbUint32_t Adler32(unsigned char const* data, size_t size) noexcept
+                {
+                    // 5552 is the largest number of bytes that can be summed up without overflowing 32 bits
+                    constexpr size_t BlockSize = 5552;
+                    VmbUint32_t a = 1;
+                    VmbUint32_t b = 0;
+                    while (size != 0)
+                    {
+                        size_t const count = (std::min)(size, BlockSize);
+                        for (size_t i = 0; i != count; ++i)
+                        {
+                            a += data[i];
+                            b += a;
+                        }
+                        a %= 65521;
+                        b %= 65521;
+                        data += count;
+                        size -= count;
+                    }
+                    return (b << 16) | a;
+                }
+
+                bool IsLittleEndian() noexcept
+                {
+                    VmbUint16_t const value = 1;
+                    unsigned char first;
+                    std::memcpy(&first, &value, 1);
+                    return first == 1;
+                }
+
+                void PutBigEndian32(unsigned char* target, VmbUint32_t value) noexcept
+                {
+                    target[0] = static_cast<unsigned char>(value >> 24);
+                    target[1] = static_cast<unsigned char>(value >> 16);
+                    target[2] = static_cast<unsigned char>(value >> 8);
+                    target[3] = static_cast<unsigned char>(value);
+                }
+
+                void AppendLittleEndian(std::vector<unsigned char>& target, VmbUint32_t value, size_t bytes)
+                {
+                    for (size_t i = 0; i != bytes; ++i)
+                    {
+                        target.push_back(static_cast<unsigned char>(value >> (8 * i)));
+                    }
+                }
+
+                class Output
+                {
+                public:
+                    Output(std::string const& fileName)
+                        : m_fileName(fileName),
+                        m_stream(fileName, std::ios::binary | std::ios::trunc)
+                    {
+                        if (!m_stream)
+                        {
+                            throw VmbException("unable to create " + fileName);
+                        }
+                    }
+
+                    void Write(void const* data, size_t size)
+                    {
+                        if (!m_stream.write(static_cast<char const*>(data), static_cast<std::streamsize>(size)))
+                        {
+                            throw VmbException("unable to write " + m_fileName);
+                        }
+                    }
+
+                    void Close()
+                    {
+                        m_stream.close();
+                        if (!m_stream)
+                        {
+                            throw VmbException("unable to write " + m_fileName);
+                        }
+                    }
+                private:
+                    std::string m_fileName;
+                    std::ofstream m_stream;
+                };
+
+                void WritePngChunk(Output& output, char const* type, unsigned char const* data, size_t size)
+                {
+                    unsigned char header[8];
+                    PutBigEndian32(header, static_cast<VmbUint32_t>(size));
+                    std::memcpy(header + 4, type, 4);
+                    Crc32 crc;
+                    crc.Update(header + 4, 4);
+                    crc.Update(data, size);
+                    unsigned char trailer[4];
+                    PutBigEndian32(trailer, crc.GetValue());
+
+                    output.Write(header, sizeof(header));
+                    output.Write(data, size);
+                    output.Write(trailer, sizeof(trailer));
+                }
+
+                void WritePng(Output& output, Raster const& raster)
+                /* 不依赖zlib：图像数据以不压缩的deflate块（stored block）保存，每行前加上过滤类型0，
+                   因此文件大小约等于原始数据大小。16位样本按PNG的要求以大端字节序保存，有效位数写入sBIT块。 */
+                {
+                    static unsigned char const signature[] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n' };
+                    output.Write(signature, sizeof(signature));
+
+                    unsigned char header[13];
+                    PutBigEndian32(header, raster.m_width);
+                    PutBigEndian32(header + 4, raster.m_height);
+                    header[8] = static_cast<unsigned char>(raster.m_bitsPerSample);
+                    header[9] = (raster.m_channels == 1) ? 0 : 2; // greyscale / truecolour
+                    header[10] = 0; // deflate
+                    header[11] = 0; // adaptive filtering
+                    header[12] = 0; // no interlace
+                    WritePngChunk(output, "IHDR", header, sizeof(header));
+
+                    if (raster.m_significantBits < raster.m_bitsPerSample)
+                    {
+                        unsigned char significantBits[3];
+                        std::fill_n(significantBits, raster.m_channels, static_cast<unsigned char>(raster.m_significantBits));
+                        WritePngChunk(output, "sBIT", significantBits, raster.m_channels);
+                    }
+
+                    size_t const rowSize = raster.GetRowSize();
+                    std::vector<unsigned char> filtered(raster.m_height * (rowSize + 1));
+                    for (VmbUint32_t y = 0; y != raster.m_height; ++y)
+                    {
+                        unsigned char* const target = filtered.data() + y * (rowSize + 1);
+                        unsigned char const* const source = raster.m_data.data() + y * rowSize;
+                        target[0] = 0; // filter type None
+                        if (raster.m_bitsPerSample == 8)
+                        {
+                            std::memcpy(target + 1, source, rowSize);
+                        }
+                        else
+                        {
+                            for (size_t i = 0; i != rowSize / 2; ++i)
+                            {
+                                VmbUint16_t sample;
+                                std::memcpy(&sample, source + 2 * i, sizeof(sample));
+                                target[1 + 2 * i] = static_cast<unsigned char>(sample >> 8);
+                                target[2 + 2 * i] = static_cast<unsigned char>(sample);
+                            }
+                        }
+                    }
+
+                    size_t const blocks = (std::max)((filtered.size() + MaxStoredBlockSize - 1) / MaxStoredBlockSize, size_t(1));
+                    std::vector<unsigned char> stream;
+                    stream.reserve(2 + filtered.size() + 5 * blocks + 4);
+                    stream.push_back(0x78); // deflate with a 32 KiB window
+                    stream.push_back(0x01); // no dictionary, fastest compression; header is a multiple of 31
+                    for (size_t offset = 0, block = 0; block != blocks; ++block)
+                    {
+                        size_t const size = (std::min)(filtered.size() - offset, MaxStoredBlockSize);
+                        stream.push_back((block + 1 == blocks) ? 1 : 0); // BFINAL, BTYPE stored
+                        AppendLittleEndian(stream, static_cast<VmbUint32_t>(size), 2);
+                        AppendLittleEndian(stream, static_cast<VmbUint32_t>(~size & 0xffff), 2);
+                        stream.insert(stream.end(), filtered.begin() + offset, filtered.begin() + offset + size);
+                        offset += size;
+                    }
+                    unsigned char adler[4];
+                    PutBigEndian32(adler, Adler32(filtered.data(), filtered.size()));
+                    stream.insert(stream.end(), adler, adler + sizeof(adler));
+
+                    for (size_t offset = 0; offset < stream.size(); offset += MaxChunkSize)
+                    {
+                        WritePngChunk(output, "IDAT", stream.data() + offset, (std::min)(stream.size() - offset, MaxChunkSize));
+                    }
+                    WritePngChunk(output, "IEND", nullptr, 0);
+                }
+
+                enum TiffType : VmbUint16_t
+                {
+                    TiffShort = 3,
+                    TiffLong = 4
+                };
+
+                void AppendTiffEntry(std::vector<unsigned char>& directory, VmbUint16_t tag, TiffType type, VmbUint32_t count, VmbUint32_t value)
+                {
+                    AppendLittleEndian(directory, tag, 2);
+                    AppendLittleEndian(directory, type, 2);
+                    AppendLittleEndian(directory, count, 4);
+                    // values fitting into the entry are left aligned; for little endian files this is the same as writing 4 bytes
+                    AppendLittleEndian(directory, value, 4);
+                }
+
+                void WriteTiff(Output& output, Raster const& raster)
+                /* 基线TIFF（小端字节序）：文件头之后依次是每个通道的位数（RGB时）、一个不压缩的条带以及图像文件目录（IFD），
+                   目录项按标签升序排列。16位样本按系统字节序（小端）保存，读取软件按位深度显示。 */
+                {
+                    size_t const imageSize = raster.m_data.size();
+                    if (imageSize > 0xffff0000u)
+                    {
+                        throw VmbException("image too large for a TIFF file", VmbErrorInvalidValue);
+                    }
+
+                    std::vector<unsigned char> header { 'I', 'I', 42, 0 };
+                    VmbUint32_t const bitsPerSampleOffset = 8;
+                    VmbUint32_t const imageOffset = bitsPerSampleOffset + ((raster.m_channels == 1) ? 0 : 8);
+                    VmbUint32_t const directoryOffset = imageOffset + ((static_cast<VmbUint32_t>(imageSize) + 1) & ~1u);
+                    AppendLittleEndian(header, directoryOffset, 4);
+                    if (raster.m_channels != 1)
+                    {
+                        for (unsigned c = 0; c != 4; ++c)
+                        {
+                            AppendLittleEndian(header, (c < raster.m_channels) ? raster.m_bitsPerSample : 0, 2);
+                        }
+                    }
+
+                    std::vector<unsigned char> directory;
+                    VmbUint16_t const entries = 10;
+                    AppendLittleEndian(directory, entries, 2);
+                    AppendTiffEntry(directory, 256, TiffLong, 1, raster.m_width); // ImageWidth
+                    AppendTiffEntry(directory, 257, TiffLong, 1, raster.m_height); // ImageLength
+                    AppendTiffEntry(directory, 258, TiffShort, raster.m_channels, // BitsPerSample
+                                    (raster.m_channels == 1) ? raster.m_bitsPerSample : bitsPerSampleOffset);
+                    AppendTiffEntry(directory, 259, TiffShort, 1, 1); // Compression: none
+                    AppendTiffEntry(directory, 262, TiffShort, 1, (raster.m_channels == 1) ? 1 : 2); // PhotometricInterpretation: BlackIsZero / RGB
+                    AppendTiffEntry(directory, 273, TiffLong, 1, imageOffset); // StripOffsets
+                    AppendTiffEntry(directory, 277, TiffShort, 1, raster.m_channels); // SamplesPerPixel
+                    AppendTiffEntry(directory, 278, TiffLong, 1, raster.m_height); // RowsPerStrip
+                    AppendTiffEntry(directory, 279, TiffLong, 1, static_cast<VmbUint32_t>(imageSize)); // StripByteCounts
+                    AppendTiffEntry(directory, 284, TiffShort, 1, 1); // PlanarConfiguration: interleaved
+                    AppendLittleEndian(directory, 0, 4); // no further directory
+
+                    output.Write(header.data(), header.size());
+                    if (raster.m_bitsPerSample == 16 && !IsLittleEndian())
+                    {
+                        std::vector<unsigned char> swapped(raster.m_data);
+                        for (size_t i = 0; i + 1 < swapped.size(); i += 2)
+                        {
+                            std::swap(swapped[i], swapped[i + 1]);
+                        }
+                        output.Write(swapped.data(), swapped.size());
+                    }
+                    else
+                    {
+                        output.Write(raster.m_data.data(), imageSize);
+                    }
+                    if ((imageSize & 1) != 0)
+                    {
+                        unsigned char const padding = 0;
+                        output.Write(&padding, 1);
+                    }
+                    output.Write(directory.data(), directory.size());
+                }
+            }
+
+            char const* GetExtension(Format format) noexcept
+            {
+                return (format == Format::Png) ? ".png" : ".tiff";
+            }
+
+            void Write(std::string const& fileName, Raster const& raster, Format format)
+            {
+                if (raster.m_width == 0 || raster.m_height == 0
+                    || (raster.m_channels != 1 && raster.m_channels != 3)
+                    || (raster.m_bitsPerSample != 8 && raster.m_bitsPerSample != 16)
+                    || raster.m_significantBits == 0 || raster.m_significantBits > raster.m_bitsPerSample
+                    || raster.m_data.size() != raster.GetRowSize() * raster.m_height)
+                {
+                    throw VmbException("invalid image for " + fileName, VmbErrorBadParameter);
+                }
+
+                Output output(fileName);
+                if (format == Format::Png)
+                {
+                    WritePng(output, raster);
+                }
+                else
+                {
+                    WriteTiff(output, raster);
+                }
+                output.Close();
+            }
+        }
+    }
+}
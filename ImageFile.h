@@ -0,0 +1,97 @@
+/**
+ * \date 2023
+ * \copyright Allied Vision Technologies.  All Rights Reserved.
+ *
+ * \copyright Redistribution of this file, in original or modified form, without
+ *            prior written consent of Allied Vision Technologies is prohibited.
+ *
+ * \warning THIS SOFTWARE IS PROVIDED BY THE AUTHOR "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF TITLE,
+ * NON-INFRINGEMENT, MERCHANTABILITY AND FITNESS FOR A PARTICULAR  PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \brief Definition of functions writing still images to PNG and TIFF files
+ */
+
+#ifndef ASYNCHRONOUSGRAB_C_IMAGE_FILE_H
+#define ASYNCHRONOUSGRAB_C_IMAGE_FILE_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include <VmbC/VmbC.h>
+
+namespace VmbC
+{
+    namespace Examples
+    {
+        /**
+         * \brief Writing of uncompressed still images without external
+         *        libraries.
+         *
+         * PNG files use stored (uncompressed) deflate blocks, TIFF files a
+         * single uncompressed strip; both keep 16 bit samples.
+         */
+        namespace ImageFile
+        {
+            enum class Format
+            {
+                Png,
+                Tiff
+            };
+
+            /**
+             * \brief image data with interleaved samples and without padding
+             *        between the rows
+             */
+            struct Raster
+            {
+                VmbUint32_t m_width { 0 };
+                VmbUint32_t m_height { 0 };
+
+                /**
+                 * \brief 1 for grey, 3 for RGB
+                 */
+                unsigned m_channels { 1 };
+
+                /**
+                 * \brief 8 or 16; 16 bit samples are stored as VmbUint16_t
+                 *        in the byte order of the system
+                 */
+                unsigned m_bitsPerSample { 8 };
+
+                /**
+                 * \brief the number of bits of the sensor data; the samples
+                 *        are aligned to the most significant bit
+                 */
+                unsigned m_significantBits { 8 };
+
+                std::vector<unsigned char> m_data;
+
+                size_t GetRowSize() const noexcept
+                {
+                    return size_t(m_width) * m_channels * (m_bitsPerSample / 8);
+                }
+            };
+
+            /**
+             * \return the file extension including the dot
+             */
+            char const* GetExtension(Format format) noexcept;
+
+            /**
+             * \throws VmbException, if the file cannot be written
+             */
+            void Write(std::string const& fileName, Raster const& raster, Format format);
+        }
+    }
+}
+
+#endif
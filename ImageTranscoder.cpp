@@ -20,33 +20,48 @@
  */
 
 #include <algorithm>
+#include <cstring>
 #include <limits>
 #include <thread>
 #include <type_traits>
 
 #include "AcquisitionManager.h"
+#include "FrameQueue.h"
 #include "Image.h"
 #include "ImageTranscoder.h"
+#include "MetricsRegistry.h"
+#include "ProcessStatistics.h"
+#include "Tracing.h"
 #include "VmbException.h"
 
-#include <QImage>
-#include <QPixmap>
-
 #include <VmbC/VmbC.h>
 
 namespace VmbC
 {
     namespace Examples
     {
-        ImageTranscoder::ImageTranscoder(AcquisitionManager& manager)
-            : m_acquisitionManager(manager)
+        ImageTranscoder::ImageTranscoder(AcquisitionManager& manager, MetricsRegistry& metrics)
+            : m_acquisitionManager(manager),
+            m_framesConverted(metrics.AddCounter("vmb_transcoder_frames_converted_total", "Frames converted to the display format")),
+            m_framesDropped(metrics.AddCounter("vmb_transcoder_frames_dropped_total", "Frames replaced by a newer frame before their conversion started")),
+            m_conversionTime(metrics.AddHistogram("vmb_transcoder_conversion_seconds", "Wall clock time of VmbImageTransform per frame",
+                                                  Histogram::ExponentialBuckets(0.0005, 2.0, 12))),
+            m_queueDepth(metrics.AddGauge("vmb_transcoder_queue_depth", "Frames waiting for or in conversion")),
+            m_framesSkipped(metrics.AddCounter("vmb_transcoder_frames_skipped_total", "Frames left out by the frame interval of the adaptive quality")),
+            m_qualityChanges(metrics.AddCounter("vmb_transcoder_quality_changes_total", "Changes of the adaptive quality level")),
+            m_qualityLevelGauge(metrics.AddGauge("vmb_transcoder_quality_level", "Current adaptive quality level; 0 is the best quality")),
+            m_levels(1, ImageTranscoder::QualityLevel{ 1, 1, false })
         /* 用于图像转码和处理。
         接受一个 AcquisitionManager 对象作为参数，并将其保存为成员变量。
         图像转码器，它接受图像帧并对其进行转码处理。
         转码器使用任务队列和线程来实现异步处理。
         转码器的启动和停止操作确保了正确的转码过程，并允许在需要时中止转码任务。
+        转码器的指标注册到 metrics 中，之后只通过原子操作更新。
          */
         {
+            metrics.AddCallback("vmb_transcoder_cpu_seconds_total", "CPU time of the transcoder thread spent converting frames",
+                                MetricsRegistry::Type::Counter,
+                                [this]() { return m_conversionCpuNanoseconds.load(std::memory_order_relaxed) * 1e-9; });
         }
 
         void ImageTranscoder::PostImage(VmbHandle_t const streamHandle, VmbFrameCallback callback, VmbFrame_t const* frame)
@@ -70,8 +85,23 @@ namespace VmbC
                         {
                             message->m_canceled = true;
                         }
+                        else if (++m_framesSinceConverted < m_levels[m_qualityLevel.load(std::memory_order_relaxed)].m_frameInterval)
+                        {
+                            // the message is destroyed after releasing the lock, reenqueuing the frame
+                            m_framesSkipped.Increment();
+                        }
                         else
                         {
+                            m_framesSinceConverted = 0;
+                            if (m_task)
+                            {
+                                // the old task is destroyed and its frame reenqueued without conversion
+                                m_framesDropped.Increment();
+                            }
+                            else
+                            {
+                                m_queueDepth.Add(1);
+                            }
                             m_task = std::move(message);
                             notify = true;
                         }
@@ -80,7 +110,7 @@ namespace VmbC
                 else
                 {
                     // try to renequeue the frame we won't pass to the image transformation
-                    VmbCaptureFrameQueue(streamHandle, frame, callback);
+                    QueueFrame(streamHandle, frame, callback);
                 }
             }
 
@@ -93,7 +123,7 @@ namespace VmbC
         void ImageTranscoder::Start()
         /* 用于启动转码器。
         它检查转码器是否已经在运行，如果是，则抛出异常。
-        否则，将转码器标记为未终止状态，并启动一个新的线程来执行转码任务。 */
+        否则，将转码器标记为未终止状态，从最佳质量等级开始新的负载测量，并启动一个新的线程来执行转码任务。 */
         {
             {
                 std::lock_guard<std::mutex> lock(m_inputMutex);
@@ -102,6 +132,20 @@ namespace VmbC
                     throw VmbException("ImageTranscoder is still running");
                 }
                 m_terminated = false;
+                m_queueDepth.Set(0);
+
+                m_qualityLevel = 0;
+                m_qualityLevelGauge.Set(0);
+                m_framesSinceConverted = 0;
+                m_windowStart = Clock::now();
+                m_windowConverted = 0;
+                m_windowDroppedBase = m_framesDropped.Get();
+                m_windowSkippedBase = m_framesSkipped.Get();
+                m_windowBusyTime = Clock::duration::zero();
+                m_windowLatency = Clock::duration::zero();
+                m_stableWindows = 0;
+                m_requiredStableWindows = m_adaptiveSettings.m_stableWindows;
+                m_windowsSinceRaise = 0;
             }
             m_thread = std::thread(&ImageTranscoder::TranscodeLoop, std::ref(*this));
         }
@@ -129,15 +173,6 @@ namespace VmbC
             m_thread.join();
         }
 
-        void ImageTranscoder::SetOutputSize(QSize size)
-        /* 用于设置输出图像的大小。
-        它使用互斥锁保护共享的输出大小变量，将新的大小值存储在 m_outputSize 成员变量中。 
-        */
-        {
-            std::lock_guard<std::mutex> lock(m_sizeMutex);
-            m_outputSize = size;
-        }
-
         ImageTranscoder::~ImageTranscoder()
         /* 
         如果转码器尚未终止，则调用 Stop() 方法停止转码器。
@@ -158,6 +193,8 @@ namespace VmbC
         如果在转码过程中接收到终止信号，取消当前任务并终止转码循环。
          */
         {
+            ASYNCHRONOUSGRAB_TRACE_THREAD_NAME("ImageTranscoder");
+
             std::unique_lock<std::mutex> lock(m_inputMutex);
 
             while (true)
@@ -171,7 +208,12 @@ namespace VmbC
                 如果在转码过程中接收到终止信号，则将当前任务标记为已取消，并立即返回。
                  */
                 {
+                    ASYNCHRONOUSGRAB_TRACE_NAMED_SCOPE(waitScope, "WaitForFrame");
                     m_inputCondition.wait(lock, [this]() { return m_terminated || m_task; }); // wait for frame/termination
+                    if (m_task)
+                    {
+                        ASYNCHRONOUSGRAB_TRACE_SET_FRAME(waitScope, m_task->m_frame.frameID);
+                    }
                 }
 
                 if (m_terminated)
@@ -200,6 +242,7 @@ namespace VmbC
                         {
                             // todo?
                         }
+                        m_queueDepth.Add(-1);
                     }
 
                     lock.lock();
@@ -228,68 +271,414 @@ namespace VmbC
             }
 
             /**
-             * \brief helper class for determining the image formats to use in the conversion 
+             * \brief the format matching QImage::Format_RGB32 on little endian
+             *        systems and QImage::Format_RGBX8888 otherwise
+             */
+            static const VmbPixelFormat_t TransformFormat = IsLittleEndian() ? VmbPixelFormatBgra8 : VmbPixelFormatRgba8;
+
+            /**
+             * \brief the quality levels from the best to the cheapest; the
+             *        decimation is limited to the maximum of the settings
              */
-            class ImageFormats
-            /* 用于确定在图像转换中使用的图像格式。 */
+            constexpr ImageTranscoder::QualityLevel QualityLadder[] =
             {
-            public:
+                { 1, 1, false },
+                { 1, 1, true },
+                { 1, 2, true },
+                { 2, 2, true },
+                { 2, 4, true },
+                { 3, 4, true },
+            };
+
+            /**
+             * \brief the quality is raised only, if the average latency and
+             *        the drop rate stay below these fractions of the limits
+             */
+            ///@{
+            constexpr double RaiseLatencyFraction = 0.5;
+            constexpr double RaiseDropRateFraction = 0.25;
+            ///@}
+
+            /**
+             * \brief the quality is raised only, if the transcoder thread is
+             *        predicted to be busy for less than this fraction of the
+             *        time at the better level
+             */
+            constexpr double RaiseUtilization = 0.7;
+
+            /**
+             * \brief the assumed cost of the demosaicing modes other than
+             *        VmbDebayerMode2x2 relative to VmbDebayerMode2x2
+             */
+            constexpr double FullDebayerCost = 2.0;
+
+            /**
+             * \brief the limit for doubling the windows required for raising
+             *        the quality after failed attempts
+             */
+            constexpr unsigned MaxStableWindows = 64;
 
-                ImageFormats()
-                /* 通过调用 IsLittleEndian() 函数来确定当前系统的字节序，并根据字节序设置适当的图像格式。 */
-                    : ImageFormats(IsLittleEndian())
+            bool IsBayer(VmbPixelFormat_t const pixelFormat) noexcept
+            {
+                switch (pixelFormat)
                 {
+                case VmbPixelFormatBayerGR8:
+                case VmbPixelFormatBayerRG8:
+                case VmbPixelFormatBayerGB8:
+                case VmbPixelFormatBayerBG8:
+                case VmbPixelFormatBayerGR10:
+                case VmbPixelFormatBayerRG10:
+                case VmbPixelFormatBayerGB10:
+                case VmbPixelFormatBayerBG10:
+                case VmbPixelFormatBayerGR12:
+                case VmbPixelFormatBayerRG12:
+                case VmbPixelFormatBayerGB12:
+                case VmbPixelFormatBayerBG12:
+                case VmbPixelFormatBayerGR16:
+                case VmbPixelFormatBayerRG16:
+                case VmbPixelFormatBayerGB16:
+                case VmbPixelFormatBayerBG16:
+                case VmbPixelFormatBayerGR12Packed:
+                case VmbPixelFormatBayerRG12Packed:
+                case VmbPixelFormatBayerGB12Packed:
+                case VmbPixelFormatBayerBG12Packed:
+                case VmbPixelFormatBayerGR12p:
+                case VmbPixelFormatBayerRG12p:
+                case VmbPixelFormatBayerGB12p:
+                case VmbPixelFormatBayerBG12p:
+                    return true;
+                default:
+                    return false;
                 }
+            }
 
-                QImage::Format const QtImageFormat;//用于存储用于转换的Qt图像格式（QImage::Format）
-                VmbPixelFormat_t const VmbTransformFormat;//用于存储用于转换的Vimba图像格式（VmbPixelFormat_t）
+            /**
+             * \return the size of a pixel of the unpacked formats supported
+             *         by Decimate; 0 for other formats
+             */
+            size_t GetBytesPerPixel(VmbPixelFormat_t const pixelFormat) noexcept
+            {
+                switch (pixelFormat)
+                {
+                case VmbPixelFormatMono8:
+                case VmbPixelFormatBayerGR8:
+                case VmbPixelFormatBayerRG8:
+                case VmbPixelFormatBayerGB8:
+                case VmbPixelFormatBayerBG8:
+                    return 1;
+                case VmbPixelFormatMono10:
+                case VmbPixelFormatMono12:
+                case VmbPixelFormatMono14:
+                case VmbPixelFormatMono16:
+                case VmbPixelFormatBayerGR10:
+                case VmbPixelFormatBayerRG10:
+                case VmbPixelFormatBayerGB10:
+                case VmbPixelFormatBayerBG10:
+                case VmbPixelFormatBayerGR12:
+                case VmbPixelFormatBayerRG12:
+                case VmbPixelFormatBayerGB12:
+                case VmbPixelFormatBayerBG12:
+                case VmbPixelFormatBayerGR16:
+                case VmbPixelFormatBayerRG16:
+                case VmbPixelFormatBayerGB16:
+                case VmbPixelFormatBayerBG16:
+                    return 2;
+                case VmbPixelFormatRgb8:
+                case VmbPixelFormatBgr8:
+                    return 3;
+                case VmbPixelFormatRgba8:
+                case VmbPixelFormatBgra8:
+                    return 4;
+                case VmbPixelFormatRgb16:
+                    return 6;
+                default:
+                    return 0;
+                }
+            }
 
-            private:
-                ImageFormats(bool littleEndian)
-                    : QtImageFormat(littleEndian ? QImage::Format_RGB32 : QImage::Format_RGBX8888),
-                    VmbTransformFormat(littleEndian ? VmbPixelFormatBgra8 : VmbPixelFormatRgba8)
+            /**
+             * \brief copy every decimation-th pixel of every decimation-th
+             *        row of a frame; Bayer frames are decimated in 2x2 tiles
+             *        to keep the color pattern
+             * \param[out] data the pixels of the decimated frame
+             * \param[out] decimated a copy of the frame referring to data
+             * \return false, if the pixel format is not supported or the
+             *         image data exceeds the buffer of the frame
+             */
+            bool Decimate(VmbFrame_t const& frame, unsigned const decimation, std::vector<unsigned char>& data, VmbFrame_t& decimated)
+            {
+                size_t const bytesPerPixel = GetBytesPerPixel(frame.pixelFormat);
+                VmbUint32_t const tile = IsBayer(frame.pixelFormat) ? 2 : 1;
+                VmbUint32_t const step = tile * decimation;
+                VmbUint32_t const width = frame.width / step * tile;
+                VmbUint32_t const height = frame.height / step * tile;
+                if (bytesPerPixel == 0 || width == 0 || height == 0
+                    || frame.buffer == nullptr || frame.imageData == nullptr)
                 {
+                    return false;
                 }
-            };
 
-            static const ImageFormats ConversionFormats{};//用于保存转换所需的图像格式。它在编译时初始化，并使用默认构造函数 ImageFormats()
+                auto const buffer = static_cast<unsigned char const*>(frame.buffer);
+                size_t const sourceStride = frame.width * bytesPerPixel;
+                if (frame.imageData < buffer
+                    || static_cast<size_t>(frame.imageData - buffer) + sourceStride * frame.height > frame.bufferSize)
+                {
+                    return false;
+                }
+
+                size_t const targetStride = width * bytesPerPixel;
+                size_t const tileSize = tile * bytesPerPixel;
+                data.resize(targetStride * height);
+
+                for (VmbUint32_t y = 0; y != height; ++y)
+                {
+                    unsigned char const* source = frame.imageData + (y / tile * step + y % tile) * sourceStride;
+                    unsigned char* target = data.data() + y * targetStride;
+                    for (VmbUint32_t x = 0; x != width; x += tile)
+                    {
+                        std::memcpy(target, source, tileSize);
+                        target += tileSize;
+                        source += step * bytesPerPixel;
+                    }
+                }
+
+                decimated = frame;
+                decimated.buffer = data.data();
+                decimated.bufferSize = static_cast<VmbUint32_t>(data.size());
+                decimated.imageData = data.data();
+                decimated.width = width;
+                decimated.height = height;
+                return true;
+            }
+        }
+
+        VmbPixelFormat_t ImageTranscoder::GetTargetPixelFormat() noexcept
+        {
+            return TransformFormat;
+        }
+
+        ImageTranscoder::Statistics ImageTranscoder::GetStatistics() const noexcept
+        /* 读取统计计数器；计数器只使用原子操作更新，可以在任意线程中调用（例如GUI定时刷新统计信息）。 */
+        {
+            Statistics result;
+            result.m_framesConverted = m_framesConverted.Get();
+            result.m_framesDropped = m_framesDropped.Get();
+            result.m_conversionTime = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(m_conversionTime.GetSum()));
+            result.m_queueDepth = static_cast<VmbUint32_t>((std::max)(m_queueDepth.Get(), VmbInt64_t(0)));
+            result.m_framesSkipped = m_framesSkipped.Get();
+            result.m_qualityChanges = m_qualityChanges.Get();
+            result.m_qualityLevel = m_qualityLevel.load(std::memory_order_relaxed);
+            result.m_qualityLevels = m_reportedLevels.load(std::memory_order_relaxed);
+            return result;
+        }
+
+        void ImageTranscoder::SetAdaptiveQuality(AdaptiveQualitySettings const& settings)
+        /* 设置自适应预览质量；只能在转码器停止时调用。
+        启用时，按 QualityLadder 生成质量等级（抽帧间隔、降采样倍数、快速去马赛克），
+        降采样倍数限制为 m_maxDecimation，限制后与前一等级相同的等级被省略。 */
+        {
+            if (settings.m_targetLatency <= std::chrono::milliseconds::zero())
+            {
+                throw VmbException("the target latency needs to be positive", VmbErrorBadParameter);
+            }
+            if (!(settings.m_maxDropRate >= 0.0 && settings.m_maxDropRate <= 1.0))
+            {
+                throw VmbException("the maximum drop rate needs to be in [0, 1]", VmbErrorBadParameter);
+            }
+            if (settings.m_maxDecimation == 0)
+            {
+                throw VmbException("the maximum decimation needs to be at least 1", VmbErrorBadParameter);
+            }
+            if (settings.m_window <= std::chrono::milliseconds::zero() || settings.m_stableWindows == 0)
+            {
+                throw VmbException("the measurement window and the number of stable windows need to be positive", VmbErrorBadParameter);
+            }
+
+            std::vector<QualityLevel> levels;
+            if (settings.m_enabled)
+            {
+                for (auto level : QualityLadder)
+                {
+                    level.m_decimation = (std::min)(level.m_decimation, settings.m_maxDecimation);
+                    if (levels.empty()
+                        || levels.back().m_frameInterval != level.m_frameInterval
+                        || levels.back().m_decimation != level.m_decimation
+                        || levels.back().m_fastDebayer != level.m_fastDebayer)
+                    {
+                        levels.push_back(level);
+                    }
+                }
+            }
+            else
+            {
+                levels.push_back(QualityLadder[0]);
+            }
+
+            std::lock_guard<std::mutex> lock(m_inputMutex);
+            if (!m_terminated)
+            {
+                throw VmbException("the adaptive quality cannot be changed while the transcoder is running");
+            }
+            m_adaptiveSettings = settings;
+            m_levels = std::move(levels);
+            m_qualityLevel = 0;
+            m_reportedLevels = settings.m_enabled ? static_cast<unsigned>(m_levels.size()) : 0;
         }
 
         void ImageTranscoder::TranscodeImage(TransformationTask& task)
         //用于执行图像转码的操作
         {
-            VmbFrame_t const& frame = task.m_frame;//获取任务中的帧信息 
+            ASYNCHRONOUSGRAB_TRACE_SCOPE("TranscodeImage", task.m_frame.frameID);
+
+            auto const start = Clock::now();
+            QualityLevel const level = m_levels[m_qualityLevel.load(std::memory_order_relaxed)];
 
-            Image const source(task.m_frame);//使用帧信息创建一个 Image 对象 source，作为转码的源图像。
+            /* 质量等级要求降采样时，先把降采样后的像素复制到 m_decimatedData，转换这个较小的图像；
+            不支持的像素格式（例如打包格式）按原尺寸转换。 */
+            VmbFrame_t decimated;
+            VmbFrame_t const* frame = &task.m_frame;
+            if (level.m_decimation > 1)
+            {
+                ASYNCHRONOUSGRAB_TRACE_SCOPE("Decimate", task.m_frame.frameID);
+                if (Decimate(task.m_frame, level.m_decimation, m_decimatedData, decimated))
+                {
+                    frame = &decimated;
+                }
+            }
+
+            Image const source(*frame);//使用帧信息创建一个 Image 对象 source，作为转码的源图像。
 
             // allocate new image, if necessary
             if (!m_transformTarget)
             {
-                m_transformTarget.reset(new Image(ConversionFormats.VmbTransformFormat));
-                /* 没有目标图像对象，就分配一个新的 Image 对象，并使用转换格式 ConversionFormats.VmbTransformFormat 进行初始化。 */
+                m_transformTarget.reset(new Image(TransformFormat));
+                /* 没有目标图像对象，就分配一个新的 Image 对象，并使用转换格式 TransformFormat 进行初始化。 */
             }
 
-            m_transformTarget->Convert(source);//将源图像转换为目标图像。
+            {
+                ASYNCHRONOUSGRAB_TRACE_SCOPE("VmbImageTransform", task.m_frame.frameID);
+                auto const conversionStart = Clock::now();
+                auto const cpuTimeStart = GetThreadCpuTime();
+                if (m_adaptiveSettings.m_enabled && IsBayer(frame->pixelFormat))
+                {
+                    m_transformTarget->Convert(source, level.m_fastDebayer ? static_cast<VmbDebayerMode_t>(VmbDebayerMode2x2) : m_adaptiveSettings.m_debayerMode);
+                }
+                else
+                {
+                    m_transformTarget->Convert(source);//将源图像转换为目标图像。
+                }
+                m_conversionCpuNanoseconds.fetch_add(static_cast<VmbUint64_t>((GetThreadCpuTime() - cpuTimeStart).count()), std::memory_order_relaxed);
+                m_conversionTime.Observe(std::chrono::duration<double>(Clock::now() - conversionStart).count());
+                m_framesConverted.Increment();
+            }
 
-            /* 使用目标图像的数据、宽度、高度、每行字节数和Qt图像格式，创建一个 QImage 对象 qImage。 */
-            QImage qImage(m_transformTarget->GetData(),
-                          m_transformTarget->GetWidth(),
-                          m_transformTarget->GetHeight(),
-                          m_transformTarget->GetBytesPerLine(),
-                          ConversionFormats.QtImageFormat);
+            /* 将转换结果交给 AcquisitionManager，由其转发给 ConvertedFrameSink（例如GUI中生成并缩放QPixmap）。
+            降采样时传递描述降采样后图像的帧，使帧的宽高与图像一致。 */
+            m_acquisitionManager.ConvertedFrameReceived(*m_transformTarget, *frame);
 
-            /* 使用 QPixmap::fromImage() 将 qImage 转换为 QPixmap 对象 pixmap，使用 Qt::ImageConversionFlag::ColorOnly 进行颜色转换。 */
-            QPixmap pixmap = QPixmap::fromImage(qImage, Qt::ImageConversionFlag::ColorOnly);
+            if (m_adaptiveSettings.m_enabled)
+            {
+                auto const now = Clock::now();
+                UpdateQuality(now, now - start, now - task.m_posted);
+            }
+        }
 
-            QSize size;
-           /* 获取输出大小 size
-           通过加锁访问 m_sizeMutex。 */
+        void ImageTranscoder::UpdateQuality(Clock::time_point const now, Clock::duration const busyTime, Clock::duration const latency)
+        /* 自适应质量控制器，每个测量窗口（m_window）结束时评估一次：
+        平均延迟（从 PostImage 到交给接收者）超过目标或丢帧率超过上限时，立即降低一级质量；
+        只有连续 m_stableWindows 个窗口的延迟低于目标的一半、丢帧率低于上限的四分之一，
+        并且按降采样面积和去马赛克开销预测的更高一级的线程占用率低于 RaiseUtilization 时，才提高一级质量（滞后）。
+        提高后的第一个窗口就必须再次降低时，所需的稳定窗口数加倍，避免在两个等级之间来回切换。 */
+        {
+            ++m_windowConverted;
+            m_windowBusyTime += busyTime;
+            m_windowLatency += latency;
+
+            if (now - m_windowStart < m_adaptiveSettings.m_window)
+            {
+                return;
+            }
+
+            VmbUint64_t const framesDropped = m_framesDropped.Get();
+            VmbUint64_t const framesSkipped = m_framesSkipped.Get();
+            double const converted = static_cast<double>(m_windowConverted);
+            double const dropped = static_cast<double>(framesDropped - m_windowDroppedBase);
+            double const skipped = static_cast<double>(framesSkipped - m_windowSkippedBase);
+            double const elapsed = std::chrono::duration<double>(now - m_windowStart).count();
+
+            double const averageLatency = std::chrono::duration<double>(m_windowLatency).count() / converted;
+            double const dropRate = dropped / (converted + dropped);
+            double const targetLatency = std::chrono::duration<double>(m_adaptiveSettings.m_targetLatency).count();
+
+            unsigned const current = m_qualityLevel.load(std::memory_order_relaxed);
+            unsigned next = current;
+
+            if (averageLatency > targetLatency || dropRate > m_adaptiveSettings.m_maxDropRate)
             {
-                std::lock_guard<std::mutex> lock(m_sizeMutex);
-                size = m_outputSize;
+                if (current + 1 < m_levels.size())
+                {
+                    next = current + 1;
+                }
+                if (m_windowsSinceRaise == 1)
+                {
+                    m_requiredStableWindows = (std::min)(m_requiredStableWindows * 2, MaxStableWindows);
+                }
+                m_windowsSinceRaise = 0;
+                m_stableWindows = 0;
             }
-            /* 将经过缩放后的 pixmap 作为参数传递给该函数，使用 Qt::AspectRatioMode::KeepAspectRatio 保持宽高比。 */
-            m_acquisitionManager.ConvertedFrameReceived(pixmap.scaled(size, Qt::AspectRatioMode::KeepAspectRatio));
+            else
+            {
+                if (m_windowsSinceRaise != 0 && ++m_windowsSinceRaise > m_requiredStableWindows)
+                {
+                    // the raised level held; forget the failed attempts
+                    m_requiredStableWindows = m_adaptiveSettings.m_stableWindows;
+                    m_windowsSinceRaise = 0;
+                }
+
+                if (current != 0
+                    && averageLatency < targetLatency * RaiseLatencyFraction
+                    && dropRate <= m_adaptiveSettings.m_maxDropRate * RaiseDropRateFraction)
+                {
+                    QualityLevel const& from = m_levels[current];
+                    QualityLevel const& to = m_levels[current - 1];
+                    double const area = static_cast<double>(from.m_decimation) / to.m_decimation;
+                    double const debayerCost = (from.m_fastDebayer && !to.m_fastDebayer) ? FullDebayerCost : 1.0;
+                    double const cost = std::chrono::duration<double>(m_windowBusyTime).count() / converted * area * area * debayerCost;
+                    double const arrivalRate = (converted + dropped + skipped) / elapsed;
+
+                    if (cost * arrivalRate / to.m_frameInterval < RaiseUtilization)
+                    {
+                        if (++m_stableWindows >= m_requiredStableWindows)
+                        {
+                            next = current - 1;
+                            m_stableWindows = 0;
+                            m_windowsSinceRaise = 1;
+                        }
+                    }
+                    else
+                    {
+                        m_stableWindows = 0;
+                    }
+                }
+                else
+                {
+                    m_stableWindows = 0;
+                }
+            }
+
+            if (next != current)
+            {
+                m_qualityLevel = next;
+                m_qualityLevelGauge.Set(next);
+                m_qualityChanges.Increment();
+            }
+
+            m_windowStart = now;
+            m_windowConverted = 0;
+            m_windowDroppedBase = framesDropped;
+            m_windowSkippedBase = framesSkipped;
+            m_windowBusyTime = Clock::duration::zero();
+            m_windowLatency = Clock::duration::zero();
         }
 
         void ImageTranscoder::TranscodeLoop(ImageTranscoder& transcoder)
@@ -301,7 +690,8 @@ namespace VmbC
         ImageTranscoder::TransformationTask::TransformationTask(VmbHandle_t const streamHandle, VmbFrameCallback callback, VmbFrame_t const& frame)
             : m_streamHandle(streamHandle),
             m_callback(callback),
-            m_frame(frame)
+            m_frame(frame),
+            m_posted(Clock::now())
         /* 用于创建一个图像转码任务对象。
         它接收一个流处理句柄 streamHandle、回调函数 callback 和帧信息 frame 作为参数。
         在构造函数中，它将这些参数分别赋值给对应的成员变量 m_streamHandle、m_callback 和 m_frame */
@@ -310,12 +700,12 @@ namespace VmbC
 
         ImageTranscoder::TransformationTask::~TransformationTask()
         /* 
-        负责清理图像转码任务对象。如果任务没有被取消（m_canceled 为 false），则调用 VmbCaptureFrameQueue 函数将帧重新排队到流处理中，以便后续的处理。
+        负责清理图像转码任务对象。如果任务没有被取消（m_canceled 为 false），则将帧重新排队到流处理中（对于回放的帧，交还给其FrameQueue），以便后续的处理。
          */
         {
             if (!m_canceled)
             {
-                VmbCaptureFrameQueue(m_streamHandle, &m_frame, m_callback);
+                QueueFrame(m_streamHandle, &m_frame, m_callback);
             }
         }
     }
@@ -17,36 +17,163 @@
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  *
  * \brief Definition of a class responsible converting VmbC image data to
- *        QPixmap in a background thread
+ *        a displayable pixel format in a background thread
  */
 
 #ifndef ASYNCHRONOUSGRAB_C_IMAGE_TRANSCODER_H
 #define ASYNCHRONOUSGRAB_C_IMAGE_TRANSCODER_H
 
+#include <atomic>
+#include <chrono>
 #include <condition_variable>
 #include <memory>
 #include <mutex>
 #include <thread>
-
-#include <QSize>
+#include <vector>
 
 #include <VmbC/VmbC.h>
+#include <VmbImageTransform/VmbTransformTypes.h>
 
 namespace VmbC
 {
     namespace Examples
     {
         class AcquisitionManager;
+        class Counter;
+        class Gauge;
+        class Histogram;
         class Image;
+        class MetricsRegistry;
 
         /**
          * \brief Class responsible converting VmbC image data to
-         *        QPixmap in a background thread
+         *        a displayable pixel format in a background thread
          */
         class ImageTranscoder
         {
         public:
-            ImageTranscoder(AcquisitionManager& manager);
+            using Clock = std::chrono::steady_clock;
+
+            /**
+             * \brief counters of the transcoder; the values accumulate over
+             *        the lifetime of the transcoder
+             */
+            struct Statistics
+            {
+                /**
+                 * \brief number of frames converted successfully
+                 */
+                VmbUint64_t m_framesConverted;
+
+                /**
+                 * \brief number of frames replaced by a newer frame before
+                 *        the conversion started
+                 */
+                VmbUint64_t m_framesDropped;
+
+                /**
+                 * \brief total time spent converting frames 
+                 */
+                Clock::duration m_conversionTime;
+
+                /**
+                 * \brief number of frames currently waiting for or in
+                 *        conversion; at most 2
+                 */
+                VmbUint32_t m_queueDepth;
+
+                /**
+                 * \brief number of frames left out by the frame interval of
+                 *        the quality level
+                 */
+                VmbUint64_t m_framesSkipped;
+
+                /**
+                 * \brief number of changes of the quality level
+                 */
+                VmbUint64_t m_qualityChanges;
+
+                /**
+                 * \brief the current quality level, 0 being the best, and
+                 *        the number of levels; 0 levels, if the adaptive
+                 *        quality is disabled
+                 */
+                ///@{
+                unsigned m_qualityLevel;
+                unsigned m_qualityLevels;
+                ///@}
+            };
+
+            /**
+             * \brief a step of the preview quality
+             */
+            struct QualityLevel
+            {
+                /**
+                 * \brief only every m_frameInterval-th frame is converted
+                 */
+                unsigned m_frameInterval;
+
+                /**
+                 * \brief only every m_decimation-th pixel, or Bayer tile, of
+                 *        every m_decimation-th row is converted
+                 */
+                unsigned m_decimation;
+
+                /**
+                 * \brief demosaic with VmbDebayerMode2x2 instead of
+                 *        AdaptiveQualitySettings::m_debayerMode
+                 */
+                bool m_fastDebayer;
+            };
+
+            /**
+             * \brief settings of the controller adapting the quality to the
+             *        load, see SetAdaptiveQuality
+             */
+            struct AdaptiveQualitySettings
+            {
+                bool m_enabled { false };
+
+                /**
+                 * \brief the maximum average time from PostImage until the
+                 *        converted frame was passed to the sinks
+                 */
+                std::chrono::milliseconds m_targetLatency { 100 };
+
+                /**
+                 * \brief the maximum fraction of the frames replaced before
+                 *        their conversion started
+                 */
+                double m_maxDropRate { 0.1 };
+
+                /**
+                 * \brief the coarsest decimation; 1 keeps the size of the
+                 *        converted images
+                 */
+                unsigned m_maxDecimation { 4 };
+
+                /**
+                 * \brief the demosaicing of Bayer frames at the best quality
+                 */
+                VmbDebayerMode_t m_debayerMode { VmbDebayerMode3x3 };
+
+                /**
+                 * \brief the interval of the load measurements
+                 */
+                std::chrono::milliseconds m_window { 500 };
+
+                /**
+                 * \brief the number of measurements without pressure
+                 *        required before the quality is raised again
+                 */
+                unsigned m_stableWindows { 4 };
+            };
+
+            /**
+             * \param[in] metrics the registry to add the metrics of the transcoder to
+             */
+            ImageTranscoder(AcquisitionManager& manager, MetricsRegistry& metrics);
             ~ImageTranscoder();
 
             /**
@@ -66,20 +193,37 @@ namespace VmbC
             void Stop() noexcept;
 
             /**
-             * \brief update the size of the QPixmaps to produce
+             * \brief the pixel format the frames are converted to; Bgra8 or
+             *        Rgba8 depending on the byte order of the system
              */
-            void SetOutputSize(QSize size);
-        private:
+            static VmbPixelFormat_t GetTargetPixelFormat() noexcept;
+
             /**
-             * \brief size of QPixmaps to produce 
+             * \brief read the counters; may be called from any thread
              */
-            QSize m_outputSize;
+            Statistics GetStatistics() const noexcept;
 
             /**
-             * \brief mutex for guarding access to m_outputSize 
+             * \brief lower the quality of the conversions in steps, if the
+             *        frames wait too long or too many of them are dropped,
+             *        and raise it again once there is room; only while the
+             *        transcoder is stopped. All converted frame sinks receive
+             *        the images of the current level, so this is for sinks
+             *        that only display the frames
+             * \throws VmbException, if the transcoder is running or the
+             *                      settings are invalid
              */
-            std::mutex m_sizeMutex;
+            void SetAdaptiveQuality(AdaptiveQualitySettings const& settings);
 
+            /**
+             * \brief get the parameters of a quality level
+             * \param[in] level a level less than Statistics::m_qualityLevels
+             */
+            QualityLevel GetQualityLevel(unsigned level) const noexcept
+            {
+                return m_levels[level];
+            }
+        private:
             /**
              * \brief object holding all required info about a desired
              *        conversion 
@@ -90,6 +234,11 @@ namespace VmbC
                 VmbFrameCallback m_callback;
                 VmbFrame_t const& m_frame;
 
+                /**
+                 * \brief the time PostImage was called
+                 */
+                Clock::time_point m_posted;
+
                 /**
                  * \brief set to true to prevent reenqueuing the frame after
                  *        the conversion 
@@ -117,6 +266,15 @@ namespace VmbC
              */ 
             void TranscodeImage(TransformationTask& task);
 
+            /**
+             * \brief add a conversion to the current load measurement and
+             *        change the quality level at the end of a window
+             * \param[in] busyTime the time spent converting the frame and in
+             *                     the sinks
+             * \param[in] latency the time since PostImage
+             */
+            void UpdateQuality(Clock::time_point now, Clock::duration busyTime, Clock::duration latency);
+
             /**
              * \brief the object to notify about the conversion results 
              */
@@ -149,6 +307,95 @@ namespace VmbC
              */
             bool m_terminated { true };
 
+            /**
+             * \name Metrics
+             * \brief metrics owned by the registry passed to the constructor
+             *        updated without locking
+             */
+            ///@{
+            Counter& m_framesConverted;
+            Counter& m_framesDropped;
+            Histogram& m_conversionTime;
+            Gauge& m_queueDepth;
+            Counter& m_framesSkipped;
+            Counter& m_qualityChanges;
+            Gauge& m_qualityLevelGauge;
+            ///@}
+
+            /**
+             * \brief only changed while the transcoder is stopped
+             */
+            ///@{
+            AdaptiveQualitySettings m_adaptiveSettings;
+
+            /**
+             * \brief the quality levels from the best to the cheapest;
+             *        only the best one, if the adaptive quality is disabled
+             */
+            std::vector<QualityLevel> m_levels;
+            ///@}
+
+            /**
+             * \brief the index of the current level of m_levels; changed by
+             *        the background thread
+             */
+            std::atomic<unsigned> m_qualityLevel { 0 };
+
+            /**
+             * \brief the number of quality levels reported in the statistics
+             */
+            std::atomic<unsigned> m_reportedLevels { 0 };
+
+            /**
+             * \brief the frames posted since the last converted one while the
+             *        level skips frames; guarded by m_inputMutex
+             */
+            unsigned m_framesSinceConverted { 0 };
+
+            /**
+             * \name Load measurement of the current window; only used by the
+             *        background thread
+             */
+            ///@{
+            Clock::time_point m_windowStart;
+            VmbUint64_t m_windowConverted { 0 };
+
+            /**
+             * \brief the drop and skip counters at m_windowStart
+             */
+            ///@{
+            VmbUint64_t m_windowDroppedBase { 0 };
+            VmbUint64_t m_windowSkippedBase { 0 };
+            ///@}
+            Clock::duration m_windowBusyTime {};
+            Clock::duration m_windowLatency {};
+
+            /**
+             * \brief the windows without pressure in a row and the number
+             *        required for raising the quality; doubled whenever a
+             *        raised level has to be left again right away
+             */
+            ///@{
+            unsigned m_stableWindows { 0 };
+            unsigned m_requiredStableWindows { 0 };
+            ///@}
+
+            /**
+             * \brief the number of windows since the quality was raised;
+             *        0 if it was not raised since the last reduction
+             */
+            unsigned m_windowsSinceRaise { 0 };
+            ///@}
+
+            /**
+             * \brief the decimated frame data converted instead of the frame
+             */
+            std::vector<unsigned char> m_decimatedData;
+            /**
+             * \brief cpu time of the background thread spent converting frames
+             */
+            std::atomic<VmbUint64_t> m_conversionCpuNanoseconds { 0 };
+
             /**
              * \brief the background thread 
              */
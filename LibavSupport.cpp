@@ -0,0 +1,110 @@
+/**
+ * \date 2023
+ * \copyright Allied Vision Technologies.  All Rights Reserved.
+ *
+ * \copyright Redistribution of this file, in original or modified form, without
+ *            prior written consent of Allied Vision Technologies is prohibited.
+ *
+ * \warning THIS SOFTWARE IS PROVIDED BY THE AUTHOR "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF TITLE,
+ * NON-INFRINGEMENT, MERCHANTABILITY AND FITNESS FOR A PARTICULAR  PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \brief Implementation of ::VmbC::Examples::LibavSupport
+ */
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+
+#include "Image.h"
+#include "LibavSupport.h"
+#include "VmbException.h"
+
+#ifdef ASYNCHRONOUSGRAB_HAVE_LIBAV
+extern "C"
+{
+#include <libavutil/error.h>
+}
+#endif
+
+namespace VmbC
+{
+    namespace Examples
+    {
+        namespace LibavSupport
+        {
+            size_t GetBytesPerPixel(VmbPixelFormat_t const pixelFormat) noexcept
+            {
+                switch (pixelFormat)
+                {
+                case VmbPixelFormatBgra8:
+                case VmbPixelFormatRgba8:
+                    return 4;
+                case VmbPixelFormatMono8:
+                    return 1;
+                default:
+                    return 0;
+                }
+            }
+
+            void CopyImage(Image const& image, size_t const bytesPerPixel, std::vector<unsigned char>& data)
+            {
+                size_t const rowSize = bytesPerPixel * static_cast<size_t>(image.GetWidth());
+                data.resize(rowSize * static_cast<size_t>(image.GetHeight()));
+                for (int y = 0; y != image.GetHeight(); ++y)
+                {
+                    std::memcpy(data.data() + y * rowSize, image.GetData() + y * static_cast<size_t>(image.GetBytesPerLine()), rowSize);
+                }
+            }
+
+            void GetScaledSize(int const width, int const height, int const maxWidth, int const maxHeight, int& scaledWidth, int& scaledHeight) noexcept
+            {
+                double scale = 1.0;
+                if (maxWidth > 0)
+                {
+                    scale = (std::min)(scale, static_cast<double>(maxWidth) / width);
+                }
+                if (maxHeight > 0)
+                {
+                    scale = (std::min)(scale, static_cast<double>(maxHeight) / height);
+                }
+                scaledWidth = (std::max)(static_cast<int>(width * scale) & ~1, 2);
+                scaledHeight = (std::max)(static_cast<int>(height * scale) & ~1, 2);
+            }
+
+#ifdef ASYNCHRONOUSGRAB_HAVE_LIBAV
+            void Check(int const result, char const* const operation)
+            {
+                if (result < 0)
+                {
+                    char text[AV_ERROR_MAX_STRING_SIZE] = {};
+                    av_strerror(result, text, sizeof(text));
+                    throw VmbException(std::string(operation) + " failed: " + text);
+                }
+            }
+
+            AVPixelFormat GetAvPixelFormat(VmbPixelFormat_t const pixelFormat) noexcept
+            {
+                switch (pixelFormat)
+                {
+                case VmbPixelFormatBgra8:
+                    return AV_PIX_FMT_BGRA;
+                case VmbPixelFormatRgba8:
+                    return AV_PIX_FMT_RGBA;
+                case VmbPixelFormatMono8:
+                    return AV_PIX_FMT_GRAY8;
+                default:
+                    return AV_PIX_FMT_NONE;
+                }
+            }
+#endif
+        }
+    }
+}
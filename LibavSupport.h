@@ -0,0 +1,88 @@
+/**
+ * \date 2023
+ * \copyright Allied Vision Technologies.  All Rights Reserved.
+ *
+ * \copyright Redistribution of this file, in original or modified form, without
+ *            prior written consent of Allied Vision Technologies is prohibited.
+ *
+ * \warning THIS SOFTWARE IS PROVIDED BY THE AUTHOR "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF TITLE,
+ * NON-INFRINGEMENT, MERCHANTABILITY AND FITNESS FOR A PARTICULAR  PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \brief Definition of helpers for encoding the converted images with libav
+ */
+
+#ifndef ASYNCHRONOUSGRAB_C_LIBAV_SUPPORT_H
+#define ASYNCHRONOUSGRAB_C_LIBAV_SUPPORT_H
+
+#include <cstddef>
+#include <vector>
+
+#include <VmbC/VmbC.h>
+
+#ifdef ASYNCHRONOUSGRAB_HAVE_LIBAV
+extern "C"
+{
+#include <libavutil/pixfmt.h>
+}
+#endif
+
+namespace VmbC
+{
+    namespace Examples
+    {
+        class Image;
+
+        /**
+         * \brief Helpers shared by the sinks encoding the converted images
+         *        with libavcodec, i.e. VideoEncoderSink and
+         *        MjpegPreviewServer
+         */
+        namespace LibavSupport
+        {
+            /**
+             * \return the size of a pixel of the converted images supported;
+             *         0 for other formats
+             */
+            size_t GetBytesPerPixel(VmbPixelFormat_t pixelFormat) noexcept;
+
+            /**
+             * \brief copy the pixels of an image without the padding of its
+             *        rows
+             * \param[in] bytesPerPixel the result of GetBytesPerPixel for the
+             *                          format of the image; not 0
+             */
+            void CopyImage(Image const& image, size_t bytesPerPixel, std::vector<unsigned char>& data);
+
+            /**
+             * \brief scale a size down to fit into maxWidth x maxHeight keeping
+             *        the aspect ratio, rounded down to even values as required
+             *        by YUV 4:2:0; values of 0 or less do not limit the size
+             */
+            void GetScaledSize(int width, int height, int maxWidth, int maxHeight, int& scaledWidth, int& scaledHeight) noexcept;
+
+#ifdef ASYNCHRONOUSGRAB_HAVE_LIBAV
+            /**
+             * \throws VmbException containing the libav error message, if
+             *                      result is negative
+             */
+            void Check(int result, char const* operation);
+
+            /**
+             * \return AV_PIX_FMT_NONE for formats not supported by
+             *         GetBytesPerPixel
+             */
+            AVPixelFormat GetAvPixelFormat(VmbPixelFormat_t pixelFormat) noexcept;
+#endif
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,679 @@
+/**
+ * \date 2023
+ * \copyright Allied Vision Technologies.  All Rights Reserved.
+ *
+ * \copyright Redistribution of this file, in original or modified form, without
+ *            prior written consent of Allied Vision Technologies is prohibited.
+ *
+ * \warning THIS SOFTWARE IS PROVIDED BY THE AUTHOR "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF TITLE,
+ * NON-INFRINGEMENT, MERCHANTABILITY AND FITNESS FOR A PARTICULAR  PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \brief Implementation of ::VmbC::Examples::LosslessCodec
+ */
+
+#include <cstring>
+
+#include "LosslessCodec.h"
+#include "VmbException.h"
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace VmbC
+{
+    namespace Examples
+    {
+        namespace
+        {
+            enum class Packing
+            {
+                /**
+                 * \brief one byte per sample
+                 */
+                Bits8,
+
+                /**
+                 * \brief two bytes per sample, little endian
+                 */
+                Bits16,
+
+                /**
+                 * \brief two 12 bit samples in three bytes, GigE Vision layout
+                 */
+                Packed12,
+
+                /**
+                 * \brief two 12 bit samples in three bytes, PFNC layout
+                 */
+                P12
+            };
+
+            struct Layout
+            {
+                Packing m_packing;
+
+                /**
+                 * \brief the number of samples between horizontally adjacent
+                 *        samples of the same colour
+                 */
+                unsigned m_step;
+
+                /**
+                 * \brief the number of rows between vertically adjacent
+                 *        samples of the same colour
+                 */
+                unsigned m_rowStep;
+
+                /**
+                 * \brief the number of samples per pixel
+                 */
+                unsigned m_channels;
+            };
+
+            /**
+             * \brief the number of leading zero bits of a unary code, from
+             *        which on the sample is stored uncoded
+             */
+            constexpr unsigned EscapeLength = 24;
+
+            /**
+             * \brief the maximum number of colour contexts: the channels of a
+             *        RGBA pixel or the four pixels of a Bayer tile
+             */
+            constexpr unsigned MaxContexts = 4;
+
+            /**
+             * \brief the size of the header of the compressed data storing the
+             *        size of the bit stream
+             */
+            constexpr size_t StreamSizeField = sizeof(VmbUint64_t);
+
+            bool GetLayout(VmbPixelFormat_t const pixelFormat, Layout& layout) noexcept
+            {
+                switch (pixelFormat)
+                {
+                case VmbPixelFormatMono8:
+                    layout = Layout { Packing::Bits8, 1, 1, 1 };
+                    return true;
+                case VmbPixelFormatMono10:
+                case VmbPixelFormatMono12:
+                case VmbPixelFormatMono14:
+                case VmbPixelFormatMono16:
+                    layout = Layout { Packing::Bits16, 1, 1, 1 };
+                    return true;
+                case VmbPixelFormatMono12Packed:
+                    layout = Layout { Packing::Packed12, 1, 1, 1 };
+                    return true;
+                case VmbPixelFormatMono12p:
+                    layout = Layout { Packing::P12, 1, 1, 1 };
+                    return true;
+                case VmbPixelFormatBayerGR8:
+                case VmbPixelFormatBayerRG8:
+                case VmbPixelFormatBayerGB8:
+                case VmbPixelFormatBayerBG8:
+                    layout = Layout { Packing::Bits8, 2, 2, 1 };
+                    return true;
+                case VmbPixelFormatBayerGR10:
+                case VmbPixelFormatBayerRG10:
+                case VmbPixelFormatBayerGB10:
+                case VmbPixelFormatBayerBG10:
+                case VmbPixelFormatBayerGR12:
+                case VmbPixelFormatBayerRG12:
+                case VmbPixelFormatBayerGB12:
+                case VmbPixelFormatBayerBG12:
+                case VmbPixelFormatBayerGR16:
+                case VmbPixelFormatBayerRG16:
+                case VmbPixelFormatBayerGB16:
+                case VmbPixelFormatBayerBG16:
+                    layout = Layout { Packing::Bits16, 2, 2, 1 };
+                    return true;
+                case VmbPixelFormatBayerGR12Packed:
+                case VmbPixelFormatBayerRG12Packed:
+                case VmbPixelFormatBayerGB12Packed:
+                case VmbPixelFormatBayerBG12Packed:
+                    layout = Layout { Packing::Packed12, 2, 2, 1 };
+                    return true;
+                case VmbPixelFormatBayerGR12p:
+                case VmbPixelFormatBayerRG12p:
+                case VmbPixelFormatBayerGB12p:
+                case VmbPixelFormatBayerBG12p:
+                    layout = Layout { Packing::P12, 2, 2, 1 };
+                    return true;
+                case VmbPixelFormatRgb8:
+                case VmbPixelFormatBgr8:
+                    layout = Layout { Packing::Bits8, 3, 1, 3 };
+                    return true;
+                case VmbPixelFormatRgba8:
+                case VmbPixelFormatBgra8:
+                    layout = Layout { Packing::Bits8, 4, 1, 4 };
+                    return true;
+                case VmbPixelFormatRgb16:
+                    layout = Layout { Packing::Bits16, 3, 1, 3 };
+                    return true;
+                default:
+                    return false;
+                }
+            }
+
+            unsigned GetSampleBits(Packing const packing) noexcept
+            {
+                switch (packing)
+                {
+                case Packing::Bits8:
+                    return 8;
+                case Packing::Bits16:
+                    return 16;
+                default:
+                    return 12;
+                }
+            }
+
+            /**
+             * \return the number of bytes of a row; 0, if the row cannot be
+             *         stored in the packing
+             */
+            size_t GetRowSize(Packing const packing, size_t const samples) noexcept
+            {
+                switch (packing)
+                {
+                case Packing::Bits8:
+                    return samples;
+                case Packing::Bits16:
+                    return samples * 2;
+                default:
+                    return (samples % 2 == 0) ? samples / 2 * 3 : 0;
+                }
+            }
+
+            void LoadRow(Packing const packing, VmbUint8_t const* source, VmbUint16_t* const samples, size_t const count) noexcept
+            {
+                switch (packing)
+                {
+                case Packing::Bits8:
+                    for (size_t i = 0; i != count; ++i)
+                    {
+                        samples[i] = source[i];
+                    }
+                    break;
+                case Packing::Bits16:
+                    for (size_t i = 0; i != count; ++i, source += 2)
+                    {
+                        samples[i] = static_cast<VmbUint16_t>(source[0] | (source[1] << 8));
+                    }
+                    break;
+                case Packing::Packed12:
+                    for (size_t i = 0; i != count; i += 2, source += 3)
+                    {
+                        samples[i] = static_cast<VmbUint16_t>((source[0] << 4) | (source[1] & 0x0F));
+                        samples[i + 1] = static_cast<VmbUint16_t>((source[2] << 4) | (source[1] >> 4));
+                    }
+                    break;
+                case Packing::P12:
+                    for (size_t i = 0; i != count; i += 2, source += 3)
+                    {
+                        samples[i] = static_cast<VmbUint16_t>(source[0] | ((source[1] & 0x0F) << 8));
+                        samples[i + 1] = static_cast<VmbUint16_t>((source[1] >> 4) | (source[2] << 4));
+                    }
+                    break;
+                }
+            }
+
+            void StoreRow(Packing const packing, VmbUint16_t const* const samples, VmbUint8_t* target, size_t const count) noexcept
+            {
+                switch (packing)
+                {
+                case Packing::Bits8:
+                    for (size_t i = 0; i != count; ++i)
+                    {
+                        target[i] = static_cast<VmbUint8_t>(samples[i]);
+                    }
+                    break;
+                case Packing::Bits16:
+                    for (size_t i = 0; i != count; ++i, target += 2)
+                    {
+                        target[0] = static_cast<VmbUint8_t>(samples[i]);
+                        target[1] = static_cast<VmbUint8_t>(samples[i] >> 8);
+                    }
+                    break;
+                case Packing::Packed12:
+                    for (size_t i = 0; i != count; i += 2, target += 3)
+                    {
+                        target[0] = static_cast<VmbUint8_t>(samples[i] >> 4);
+                        target[1] = static_cast<VmbUint8_t>((samples[i] & 0x0F) | ((samples[i + 1] & 0x0F) << 4));
+                        target[2] = static_cast<VmbUint8_t>(samples[i + 1] >> 4);
+                    }
+                    break;
+                case Packing::P12:
+                    for (size_t i = 0; i != count; i += 2, target += 3)
+                    {
+                        target[0] = static_cast<VmbUint8_t>(samples[i]);
+                        target[1] = static_cast<VmbUint8_t>(((samples[i] >> 8) & 0x0F) | ((samples[i + 1] & 0x0F) << 4));
+                        target[2] = static_cast<VmbUint8_t>(samples[i + 1] >> 4);
+                    }
+                    break;
+                }
+            }
+
+            /**
+             * \brief median edge detector: predicts an edge from the left or
+             *        upper neighbour, a gradient otherwise
+             */
+            inline int Predict(int const left, int const up, int const upLeft) noexcept
+            {
+                int const low = (left < up) ? left : up;
+                int const high = (left < up) ? up : left;
+                if (upLeft >= high)
+                {
+                    return low;
+                }
+                if (upLeft <= low)
+                {
+                    return high;
+                }
+                return left + up - upLeft;
+            }
+
+            /**
+             * \brief the running mean of the mapped residuals of one colour
+             */
+            struct Context
+            {
+                VmbUint32_t m_sum { 4 };
+                VmbUint32_t m_count { 1 };
+
+                unsigned GetParameter(unsigned const maxParameter) const noexcept
+                {
+                    unsigned k = 0;
+                    while ((m_count << k) < m_sum && k < maxParameter)
+                    {
+                        ++k;
+                    }
+                    return k;
+                }
+
+                void Update(VmbUint32_t const value) noexcept
+                {
+                    m_sum += value;
+                    if (++m_count == 64)
+                    {
+                        m_sum >>= 1;
+                        m_count >>= 1;
+                    }
+                }
+            };
+
+            class BitWriter
+            {
+            public:
+                BitWriter(unsigned char* const begin, unsigned char* const end) noexcept
+                    : m_begin(begin), m_pos(begin), m_end(end)
+                {
+                }
+
+                /**
+                 * \brief append the count least significant bits of value,
+                 *        preceded by zeros if count exceeds 32; count must not
+                 *        exceed 56; ignored after an overflow
+                 */
+                void Put(VmbUint32_t const value, unsigned const count) noexcept
+                {
+                    if (m_overflow)
+                    {
+                        // m_bitCount is not reduced anymore
+                        return;
+                    }
+                    m_bits = (m_bits << count) | value;
+                    m_bitCount += count;
+                    while (m_bitCount >= 8)
+                    {
+                        m_bitCount -= 8;
+                        if (m_pos == m_end)
+                        {
+                            m_overflow = true;
+                            return;
+                        }
+                        *m_pos++ = static_cast<unsigned char>(m_bits >> m_bitCount);
+                    }
+                }
+
+                /**
+                 * \return the size of the stream; 0 on overflow
+                 */
+                size_t Finish() noexcept
+                {
+                    if (m_overflow)
+                    {
+                        return 0;
+                    }
+                    if (m_bitCount != 0)
+                    {
+                        Put(0, 8 - m_bitCount);
+                    }
+                    return m_overflow ? 0 : static_cast<size_t>(m_pos - m_begin);
+                }
+
+                bool HasOverflow() const noexcept
+                {
+                    return m_overflow;
+                }
+            private:
+                unsigned char* const m_begin;
+                unsigned char* m_pos;
+                unsigned char* const m_end;
+                VmbUint64_t m_bits { 0 };
+                unsigned m_bitCount { 0 };
+                bool m_overflow { false };
+            };
+
+            class BitReader
+            {
+            public:
+                BitReader(unsigned char const* const begin, size_t const size) noexcept
+                    : m_pos(begin), m_end(begin + size), m_size(size)
+                {
+                    Fill();
+                }
+
+                /**
+                 * \return the number of leading zero bits available, at most 57
+                 */
+                unsigned CountZeros() noexcept
+                {
+                    Fill();
+                    if (m_bits == 0)
+                    {
+                        return 64;
+                    }
+#ifdef _MSC_VER
+                    unsigned long index;
+                    _BitScanReverse64(&index, m_bits);
+                    return 63 - static_cast<unsigned>(index);
+#else
+                    return static_cast<unsigned>(__builtin_clzll(m_bits));
+#endif
+                }
+
+                void Skip(unsigned const count) noexcept
+                {
+                    m_bits <<= count;
+                    m_bitCount -= count;
+                }
+
+                /**
+                 * \brief read count bits; count must not exceed 32
+                 */
+                VmbUint32_t Get(unsigned const count) noexcept
+                {
+                    if (count == 0)
+                    {
+                        return 0;
+                    }
+                    Fill();
+                    VmbUint32_t const value = static_cast<VmbUint32_t>(m_bits >> (64 - count));
+                    Skip(count);
+                    return value;
+                }
+
+                /**
+                 * \return true, if more bits were read than the stream contains
+                 */
+                bool IsOverrun() const noexcept
+                {
+                    return m_read * 8 - m_bitCount > m_size * 8;
+                }
+            private:
+                unsigned char const* m_pos;
+                unsigned char const* const m_end;
+                size_t const m_size;
+
+                /**
+                 * \brief the bytes loaded including zeros past the end
+                 */
+                size_t m_read { 0 };
+
+                /**
+                 * \brief the bits available, most significant bit first
+                 */
+                VmbUint64_t m_bits { 0 };
+                unsigned m_bitCount { 0 };
+
+                void Fill() noexcept
+                {
+                    while (m_bitCount <= 56)
+                    {
+                        VmbUint64_t const byte = (m_pos != m_end) ? *m_pos++ : 0;
+                        m_bits |= byte << (56 - m_bitCount);
+                        m_bitCount += 8;
+                        ++m_read;
+                    }
+                }
+            };
+
+            /**
+             * \brief the state shared by encoder and decoder: the prediction
+             *        and the residual mapping
+             */
+            struct Coder
+            {
+                Layout m_layout;
+                VmbUint32_t m_mask;
+                int m_half;
+                unsigned m_bits;
+                Context m_contexts[2 * MaxContexts];
+
+                Coder(Layout const& layout) noexcept
+                    : m_layout(layout),
+                    m_mask((VmbUint32_t(1) << GetSampleBits(layout.m_packing)) - 1),
+                    m_half(1 << (GetSampleBits(layout.m_packing) - 1)),
+                    m_bits(GetSampleBits(layout.m_packing))
+                {
+                }
+
+                int GetPrediction(VmbUint16_t const* const row, VmbUint16_t const* const up, size_t const x) const noexcept
+                {
+                    size_t const step = m_layout.m_step;
+                    if (up == nullptr)
+                    {
+                        return (x >= step) ? row[x - step] : 0;
+                    }
+                    if (x < step)
+                    {
+                        return up[x];
+                    }
+                    return Predict(row[x - step], up[x], up[x - step]);
+                }
+
+                /**
+                 * \brief get the contexts of a row, indexed by the position
+                 *        modulo the step
+                 */
+                Context* GetRowContexts(size_t const y) noexcept
+                {
+                    return m_contexts + ((m_layout.m_rowStep == 2) ? (y & 1) * m_layout.m_step : 0);
+                }
+            };
+        }
+
+        bool LosslessCodec::IsSupported(VmbPixelFormat_t const pixelFormat, VmbUint32_t const width) noexcept
+        {
+            Layout layout;
+            return GetLayout(pixelFormat, layout) && width != 0 && GetRowSize(layout.m_packing, size_t(width) * layout.m_channels) != 0;
+        }
+
+        size_t LosslessCodec::Compress(VmbFrame_t const& frame, std::vector<unsigned char>& output)
+        /* 逐行把样本解包为16位整数（8位、16位小端以及两种12位打包格式），用同色的左、上、左上相邻样本
+        （Bayer格式相隔两个像素和两行，RGB格式相隔一个像素的通道数）做中值边缘预测，残差按样本位数取模后映射为非负数，
+        再用按颜色自适应参数的Golomb-Rice码写入位流；残差过大时写入转义码和原始值。
+        帧缓冲区中图像之外的字节（例如块数据）原样附加在位流之后。压缩后不小于原始大小时返回0，由调用者原样保存。 */
+        {
+            Layout layout;
+            if (frame.buffer == nullptr || frame.height == 0 || !GetLayout(frame.pixelFormat, layout))
+            {
+                return 0;
+            }
+
+            auto const buffer = static_cast<VmbUint8_t const*>(frame.buffer);
+            size_t const samples = size_t(frame.width) * layout.m_channels;
+            size_t const rowSize = GetRowSize(layout.m_packing, samples);
+            if (rowSize == 0)
+            {
+                return 0;
+            }
+            size_t const imageOffset = (frame.imageData == nullptr) ? 0 : static_cast<size_t>(frame.imageData - buffer);
+            size_t const imageSize = rowSize * frame.height;
+            size_t const bufferSize = frame.bufferSize;
+            if (imageOffset > bufferSize || imageSize > bufferSize - imageOffset)
+            {
+                return 0;
+            }
+            size_t const extraSize = bufferSize - imageSize;
+            if (StreamSizeField + extraSize >= bufferSize)
+            {
+                return 0;
+            }
+
+            if (output.size() < bufferSize)
+            {
+                output.resize(bufferSize);
+            }
+            m_rows.resize(samples * 3);
+
+            Coder coder(layout);
+            BitWriter writer(output.data() + StreamSizeField, output.data() + bufferSize - extraSize);
+            for (size_t y = 0; y != frame.height && !writer.HasOverflow(); ++y)
+            {
+                VmbUint16_t* const row = m_rows.data() + (y % 3) * samples;
+                VmbUint16_t const* const up = (y >= layout.m_rowStep) ? m_rows.data() + ((y - layout.m_rowStep) % 3) * samples : nullptr;
+                LoadRow(layout.m_packing, buffer + imageOffset + y * rowSize, row, samples);
+
+                Context* const contexts = coder.GetRowContexts(y);
+                size_t channel = 0;
+                for (size_t x = 0; x != samples; ++x)
+                {
+                    int residual = static_cast<int>((row[x] - coder.GetPrediction(row, up, x)) & coder.m_mask);
+                    if (residual >= coder.m_half)
+                    {
+                        residual -= static_cast<int>(coder.m_mask) + 1;
+                    }
+                    VmbUint32_t const value = (residual >= 0) ? VmbUint32_t(residual) << 1 : (VmbUint32_t(-residual) << 1) - 1;
+
+                    Context& context = contexts[channel];
+                    channel = (channel + 1 == layout.m_step) ? 0 : channel + 1;
+                    unsigned const k = context.GetParameter(coder.m_bits);
+                    VmbUint32_t const quotient = value >> k;
+                    if (quotient < EscapeLength)
+                    {
+                        // the unary quotient terminated by a one followed by the k low bits
+                        writer.Put((VmbUint32_t(1) << k) | (value & ((VmbUint32_t(1) << k) - 1)), quotient + 1 + k);
+                    }
+                    else
+                    {
+                        writer.Put(0, EscapeLength);
+                        writer.Put(value, coder.m_bits);
+                    }
+                    context.Update(value);
+                }
+            }
+
+            size_t const streamSize = writer.Finish();
+            if (streamSize == 0)
+            {
+                return 0;
+            }
+
+            VmbUint64_t const storedStreamSize = streamSize;
+            std::memcpy(output.data(), &storedStreamSize, StreamSizeField);
+            unsigned char* const extra = output.data() + StreamSizeField + streamSize;
+            std::memcpy(extra, buffer, imageOffset);
+            std::memcpy(extra + imageOffset, buffer + imageOffset + imageSize, bufferSize - imageOffset - imageSize);
+            return StreamSizeField + streamSize + extraSize;
+        }
+
+        void LosslessCodec::Decompress(unsigned char const* const data, size_t const size, VmbFrame_t const& target)
+        /* Compress的逆过程：用相同的预测和自适应参数从位流中恢复样本，逐行打包写入目标缓冲区，
+        然后复制图像之外的字节。数据大小与帧的描述不符或位流被截断时抛出异常。 */
+        {
+            Layout layout;
+            if (target.buffer == nullptr || !GetLayout(target.pixelFormat, layout))
+            {
+                throw VmbException("unsupported format of a compressed frame", VmbErrorInvalidValue);
+            }
+
+            auto const buffer = static_cast<VmbUint8_t*>(target.buffer);
+            size_t const samples = size_t(target.width) * layout.m_channels;
+            size_t const rowSize = GetRowSize(layout.m_packing, samples);
+            size_t const imageOffset = (target.imageData == nullptr) ? 0 : static_cast<size_t>(target.imageData - buffer);
+            size_t const imageSize = rowSize * target.height;
+            size_t const bufferSize = target.bufferSize;
+
+            VmbUint64_t streamSize = 0;
+            if (size >= StreamSizeField)
+            {
+                std::memcpy(&streamSize, data, StreamSizeField);
+            }
+            if (rowSize == 0
+                || imageOffset > bufferSize
+                || imageSize > bufferSize - imageOffset
+                || size < StreamSizeField
+                || streamSize > size - StreamSizeField
+                || size - StreamSizeField - streamSize != bufferSize - imageSize)
+            {
+                throw VmbException("compressed frame does not match its header", VmbErrorInvalidValue);
+            }
+
+            m_rows.resize(samples * 3);
+
+            Coder coder(layout);
+            BitReader reader(data + StreamSizeField, static_cast<size_t>(streamSize));
+            for (size_t y = 0; y != target.height; ++y)
+            {
+                VmbUint16_t* const row = m_rows.data() + (y % 3) * samples;
+                VmbUint16_t const* const up = (y >= layout.m_rowStep) ? m_rows.data() + ((y - layout.m_rowStep) % 3) * samples : nullptr;
+
+                Context* const contexts = coder.GetRowContexts(y);
+                size_t channel = 0;
+                for (size_t x = 0; x != samples; ++x)
+                {
+                    Context& context = contexts[channel];
+                    channel = (channel + 1 == layout.m_step) ? 0 : channel + 1;
+                    unsigned const k = context.GetParameter(coder.m_bits);
+                    unsigned const zeros = reader.CountZeros();
+                    VmbUint32_t value;
+                    if (zeros >= EscapeLength)
+                    {
+                        reader.Skip(EscapeLength);
+                        value = reader.Get(coder.m_bits);
+                    }
+                    else
+                    {
+                        reader.Skip(zeros + 1);
+                        value = (VmbUint32_t(zeros) << k) | reader.Get(k);
+                    }
+                    context.Update(value);
+
+                    int const residual = (value & 1) ? -static_cast<int>((value + 1) >> 1) : static_cast<int>(value >> 1);
+                    row[x] = static_cast<VmbUint16_t>((coder.GetPrediction(row, up, x) + residual) & static_cast<int>(coder.m_mask));
+                }
+                StoreRow(layout.m_packing, row, buffer + imageOffset + y * rowSize, samples);
+            }
+
+            if (reader.IsOverrun())
+            {
+                throw VmbException("compressed frame is truncated", VmbErrorInvalidValue);
+            }
+
+            unsigned char const* const extra = data + StreamSizeField + streamSize;
+            std::memcpy(buffer, extra, imageOffset);
+            std::memcpy(buffer + imageOffset + imageSize, extra + imageOffset, bufferSize - imageOffset - imageSize);
+        }
+    }
+}
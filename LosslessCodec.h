@@ -0,0 +1,84 @@
+/**
+ * \date 2023
+ * \copyright Allied Vision Technologies.  All Rights Reserved.
+ *
+ * \copyright Redistribution of this file, in original or modified form, without
+ *            prior written consent of Allied Vision Technologies is prohibited.
+ *
+ * \warning THIS SOFTWARE IS PROVIDED BY THE AUTHOR "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF TITLE,
+ * NON-INFRINGEMENT, MERCHANTABILITY AND FITNESS FOR A PARTICULAR  PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \brief Definition of a lossless codec for raw sensor data
+ */
+
+#ifndef ASYNCHRONOUSGRAB_C_LOSSLESS_CODEC_H
+#define ASYNCHRONOUSGRAB_C_LOSSLESS_CODEC_H
+
+#include <cstddef>
+#include <vector>
+
+#include <VmbC/VmbC.h>
+
+namespace VmbC
+{
+    namespace Examples
+    {
+        /**
+         * \brief Lossless compression of raw sensor data.
+         *
+         * Each sample is predicted from its left, upper and upper left
+         * neighbours of the same colour (the median edge detector of
+         * LOCO-I), i.e. with a distance of two pixels for Bayer patterns
+         * and of one pixel for the channels of interleaved RGB data. The
+         * residuals are coded with Golomb-Rice codes adapting to the mean
+         * residual of each colour. 8 and 16 bit samples as well as the
+         * 12 bit packed layouts (GigE Vision "Packed" and PFNC "p") are
+         * supported; the bytes of the frame buffer outside of the image,
+         * e.g. chunk data, are stored unmodified.
+         *
+         * An object keeps scratch rows reused for every frame and may only
+         * be used by one thread at a time.
+         */
+        class LosslessCodec
+        {
+        public:
+            /**
+             * \return true, if frames of the given format and width can be
+             *         compressed
+             */
+            static bool IsSupported(VmbPixelFormat_t pixelFormat, VmbUint32_t width) noexcept;
+
+            /**
+             * \brief compress the buffer of a frame
+             * \param[out] output receives the compressed data; only grows
+             * \return the size of the compressed data; 0, if the format is
+             *         not supported or the data does not get smaller
+             */
+            size_t Compress(VmbFrame_t const& frame, std::vector<unsigned char>& output);
+
+            /**
+             * \brief restore a frame buffer compressed by Compress
+             * \param[in] target the frame the data was compressed from with
+             *                   buffer, bufferSize and imageData referring
+             *                   to the memory to write to
+             * \throws VmbException, if the data is corrupt
+             */
+            void Decompress(unsigned char const* data, size_t size, VmbFrame_t const& target);
+        private:
+            /**
+             * \brief the samples of the current and the preceding rows
+             */
+            std::vector<VmbUint16_t> m_rows;
+        };
+    }
+}
+
+#endif
@@ -0,0 +1,212 @@
+/**
+ * \date 2023
+ * \copyright Allied Vision Technologies.  All Rights Reserved.
+ *
+ * \copyright Redistribution of this file, in original or modified form, without
+ *            prior written consent of Allied Vision Technologies is prohibited.
+ *
+ * \warning THIS SOFTWARE IS PROVIDED BY THE AUTHOR "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF TITLE,
+ * NON-INFRINGEMENT, MERCHANTABILITY AND FITNESS FOR A PARTICULAR  PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \brief Implementation of ::VmbC::Examples::MetricsRegistry
+ */
+
+#include <algorithm>
+#include <limits>
+#include <locale>
+#include <ostream>
+
+#include "MetricsRegistry.h"
+#include "VmbException.h"
+
+namespace VmbC
+{
+    namespace Examples
+    {
+        namespace
+        {
+            char const* GetTypeName(MetricsRegistry::Type type) noexcept
+            {
+                switch (type)
+                {
+                case MetricsRegistry::Type::Counter:
+                    return "counter";
+                case MetricsRegistry::Type::Gauge:
+                    return "gauge";
+                default:
+                    return "histogram";
+                }
+            }
+
+            /**
+             * \brief write a floating point value using the notation
+             *        understood by Prometheus
+             */
+            void WriteValue(std::ostream& out, double value)
+            {
+                if (value == std::numeric_limits<double>::infinity())
+                {
+                    out << "+Inf";
+                }
+                else
+                {
+                    out << value;
+                }
+            }
+        }
+
+        void Counter::Write(std::ostream& out, std::string const& name) const
+        {
+            out << name << ' ' << Get() << '\n';
+        }
+
+        void Gauge::Write(std::ostream& out, std::string const& name) const
+        {
+            out << name << ' ' << Get() << '\n';
+        }
+
+        Histogram::Histogram(std::vector<double> upperBounds)
+            : m_upperBounds(std::move(upperBounds)),
+            m_bucketCounts(new std::atomic<VmbUint64_t>[m_upperBounds.size() + 1])
+        /* 直方图的桶边界在构造时固定，之后 Observe 只对对应桶的计数器和总和做原子操作。 */
+        {
+            if (!std::is_sorted(m_upperBounds.begin(), m_upperBounds.end()))
+            {
+                throw VmbException("histogram bucket bounds need to be in ascending order");
+            }
+            for (size_t i = 0; i <= m_upperBounds.size(); ++i)
+            {
+                m_bucketCounts[i].store(0, std::memory_order_relaxed);
+            }
+        }
+
+        void Histogram::Observe(double const value) noexcept
+        /* 记录一个观测值：通过二分查找确定所在的桶，原子地增加桶计数；
+        总和使用 compare_exchange 循环累加，因此不需要加锁。 */
+        {
+            auto const bucket = std::lower_bound(m_upperBounds.begin(), m_upperBounds.end(), value) - m_upperBounds.begin();
+            m_bucketCounts[bucket].fetch_add(1, std::memory_order_relaxed);
+
+            double sum = m_sum.load(std::memory_order_relaxed);
+            while (!m_sum.compare_exchange_weak(sum, sum + value, std::memory_order_relaxed))
+            {
+            }
+        }
+
+        VmbUint64_t Histogram::GetCount() const noexcept
+        {
+            VmbUint64_t count = 0;
+            for (size_t i = 0; i <= m_upperBounds.size(); ++i)
+            {
+                count += m_bucketCounts[i].load(std::memory_order_relaxed);
+            }
+            return count;
+        }
+
+        void Histogram::Write(std::ostream& out, std::string const& name) const
+        /* Prometheus 的直方图桶是累积的：每个 le 桶包含所有不超过该上界的观测值，
+        最后的 +Inf 桶等于观测值总数（_count）。 */
+        {
+            VmbUint64_t cumulative = 0;
+            for (size_t i = 0; i <= m_upperBounds.size(); ++i)
+            {
+                cumulative += m_bucketCounts[i].load(std::memory_order_relaxed);
+                out << name << "_bucket{le=\"";
+                WriteValue(out, (i < m_upperBounds.size()) ? m_upperBounds[i] : std::numeric_limits<double>::infinity());
+                out << "\"} " << cumulative << '\n';
+            }
+            out << name << "_sum ";
+            WriteValue(out, GetSum());
+            out << '\n' << name << "_count " << cumulative << '\n';
+        }
+
+        std::vector<double> Histogram::ExponentialBuckets(double const start, double const factor, size_t const count)
+        {
+            std::vector<double> result;
+            result.reserve(count);
+            double bound = start;
+            for (size_t i = 0; i < count; ++i)
+            {
+                result.push_back(bound);
+                bound *= factor;
+            }
+            return result;
+        }
+
+        CallbackMetric::CallbackMetric(std::function<double()> callback)
+            : m_callback(std::move(callback))
+        {
+        }
+
+        void CallbackMetric::Write(std::ostream& out, std::string const& name) const
+        {
+            out << name << ' ';
+            WriteValue(out, m_callback());
+            out << '\n';
+        }
+
+        Counter& MetricsRegistry::AddCounter(std::string name, std::string help)
+        {
+            return static_cast<Counter&>(Add(std::move(name), std::move(help), Type::Counter, std::unique_ptr<Metric>(new Counter())));
+        }
+
+        Gauge& MetricsRegistry::AddGauge(std::string name, std::string help)
+        {
+            return static_cast<Gauge&>(Add(std::move(name), std::move(help), Type::Gauge, std::unique_ptr<Metric>(new Gauge())));
+        }
+
+        Histogram& MetricsRegistry::AddHistogram(std::string name, std::string help, std::vector<double> upperBounds)
+        {
+            return static_cast<Histogram&>(Add(std::move(name), std::move(help), Type::Histogram,
+                                               std::unique_ptr<Metric>(new Histogram(std::move(upperBounds)))));
+        }
+
+        void MetricsRegistry::AddCallback(std::string name, std::string help, Type type, std::function<double()> callback)
+        {
+            Add(std::move(name), std::move(help), type, std::unique_ptr<Metric>(new CallbackMetric(std::move(callback))));
+        }
+
+        Metric& MetricsRegistry::Add(std::string name, std::string help, Type type, std::unique_ptr<Metric> metric)
+        /* 注册新的指标。指标对象由注册表持有且不会被删除，因此返回的引用在注册表的整个生命周期内有效，
+        更新指标的代码可以保存该引用并在不加锁的情况下使用。 */
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            auto const pos = std::find_if(m_entries.begin(), m_entries.end(), [&name](Entry const& entry) { return entry.m_name == name; });
+            if (pos != m_entries.end())
+            {
+                throw VmbException("metric " + name + " registered multiple times");
+            }
+
+            Metric& result = *metric;
+            m_entries.push_back(Entry{ std::move(name), std::move(help), type, std::move(metric) });
+            return result;
+        }
+
+        void MetricsRegistry::Write(std::ostream& out) const
+        /* 按照 Prometheus 文本格式输出所有指标（HELP、TYPE 和样本行）。
+        输出的耗时只取决于指标数量，与帧率无关。 */
+        {
+            std::locale const previousLocale = out.imbue(std::locale::classic());
+            auto const previousPrecision = out.precision(std::numeric_limits<double>::digits10);
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+            for (auto const& entry : m_entries)
+            {
+                out << "# HELP " << entry.m_name << ' ' << entry.m_help << '\n'
+                    << "# TYPE " << entry.m_name << ' ' << GetTypeName(entry.m_type) << '\n';
+                entry.m_metric->Write(out, entry.m_name);
+            }
+
+            out.precision(previousPrecision);
+            out.imbue(previousLocale);
+        }
+    }
+}
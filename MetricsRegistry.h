@@ -0,0 +1,230 @@
+/**
+ * \date 2023
+ * \copyright Allied Vision Technologies.  All Rights Reserved.
+ *
+ * \copyright Redistribution of this file, in original or modified form, without
+ *            prior written consent of Allied Vision Technologies is prohibited.
+ *
+ * \warning THIS SOFTWARE IS PROVIDED BY THE AUTHOR "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF TITLE,
+ * NON-INFRINGEMENT, MERCHANTABILITY AND FITNESS FOR A PARTICULAR  PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \brief Definition of a registry of counters, gauges and histograms that
+ *        can be written in the Prometheus text format
+ */
+
+#ifndef ASYNCHRONOUSGRAB_C_METRICS_REGISTRY_H
+#define ASYNCHRONOUSGRAB_C_METRICS_REGISTRY_H
+
+#include <atomic>
+#include <functional>
+#include <iosfwd>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <VmbC/VmbC.h>
+
+namespace VmbC
+{
+    namespace Examples
+    {
+        /**
+         * \brief base class of all metrics known to a MetricsRegistry
+         */
+        class Metric
+        {
+        public:
+            virtual ~Metric() = default;
+
+            /**
+             * \brief write the samples of the metric in the Prometheus text format
+             */
+            virtual void Write(std::ostream& out, std::string const& name) const = 0;
+        };
+
+        /**
+         * \brief a value that only increases; updates are lock-free
+         */
+        class Counter : public Metric
+        {
+        public:
+            void Increment(VmbUint64_t value = 1) noexcept
+            {
+                m_value.fetch_add(value, std::memory_order_relaxed);
+            }
+
+            VmbUint64_t Get() const noexcept
+            {
+                return m_value.load(std::memory_order_relaxed);
+            }
+
+            void Write(std::ostream& out, std::string const& name) const override;
+        private:
+            std::atomic<VmbUint64_t> m_value { 0 };
+        };
+
+        /**
+         * \brief a value that may increase and decrease; updates are lock-free
+         */
+        class Gauge : public Metric
+        {
+        public:
+            void Set(VmbInt64_t value) noexcept
+            {
+                m_value.store(value, std::memory_order_relaxed);
+            }
+
+            void Add(VmbInt64_t value) noexcept
+            {
+                m_value.fetch_add(value, std::memory_order_relaxed);
+            }
+
+            VmbInt64_t Get() const noexcept
+            {
+                return m_value.load(std::memory_order_relaxed);
+            }
+
+            void Write(std::ostream& out, std::string const& name) const override;
+        private:
+            std::atomic<VmbInt64_t> m_value { 0 };
+        };
+
+        /**
+         * \brief counts observed values in buckets with fixed upper bounds;
+         *        updates are lock-free
+         */
+        class Histogram : public Metric
+        {
+        public:
+            /**
+             * \param[in] upperBounds the inclusive upper bounds of the buckets in
+             *                        ascending order; a bucket for values
+             *                        exceeding the last bound is added
+             */
+            Histogram(std::vector<double> upperBounds);
+
+            void Observe(double value) noexcept;
+
+            /**
+             * \brief get the number of observed values
+             */
+            VmbUint64_t GetCount() const noexcept;
+
+            /**
+             * \brief get the sum of all observed values
+             */
+            double GetSum() const noexcept
+            {
+                return m_sum.load(std::memory_order_relaxed);
+            }
+
+            void Write(std::ostream& out, std::string const& name) const override;
+
+            /**
+             * \brief create bucket bounds start, start * factor, start * factor^2, ...
+             */
+            static std::vector<double> ExponentialBuckets(double start, double factor, size_t count);
+        private:
+            std::vector<double> m_upperBounds;
+
+            /**
+             * \brief the number of values per bucket; one more element than
+             *        m_upperBounds
+             */
+            std::unique_ptr<std::atomic<VmbUint64_t>[]> m_bucketCounts;
+
+            std::atomic<double> m_sum { 0.0 };
+        };
+
+        /**
+         * \brief a value calculated by a function when the metrics are
+         *        written, e.g. the resident set size of the process
+         */
+        class CallbackMetric : public Metric
+        {
+        public:
+            CallbackMetric(std::function<double()> callback);
+
+            void Write(std::ostream& out, std::string const& name) const override;
+        private:
+            std::function<double()> m_callback;
+        };
+
+        /**
+         * \brief A collection of named metrics that can be written in the
+         *        Prometheus text exposition format.
+         *
+         * Metrics are registered once, usually during construction of the
+         * object updating them, and live as long as the registry. Updating the
+         * metrics does not require any locking; writing them takes time
+         * proportional to the number of metrics independent of the number of
+         * updates.
+         */
+        class MetricsRegistry
+        {
+        public:
+            enum class Type
+            {
+                Counter,
+                Gauge,
+                Histogram,
+            };
+
+            MetricsRegistry() = default;
+
+            MetricsRegistry(MetricsRegistry const&) = delete;
+            MetricsRegistry& operator=(MetricsRegistry const&) = delete;
+
+            /**
+             * \brief register a counter; by convention the name ends with "_total"
+             */
+            Counter& AddCounter(std::string name, std::string help);
+
+            Gauge& AddGauge(std::string name, std::string help);
+
+            Histogram& AddHistogram(std::string name, std::string help, std::vector<double> upperBounds);
+
+            /**
+             * \brief register a metric whose value is calculated by callback
+             *        every time the metrics are written
+             */
+            void AddCallback(std::string name, std::string help, Type type, std::function<double()> callback);
+
+            /**
+             * \brief write all metrics in the Prometheus text exposition format
+             */
+            void Write(std::ostream& out) const;
+        private:
+            struct Entry
+            {
+                std::string m_name;
+                std::string m_help;
+                Type m_type;
+                std::unique_ptr<Metric> m_metric;
+            };
+
+            /**
+             * \brief add a new metric; throws a VmbException, if the name is in use
+             */
+            Metric& Add(std::string name, std::string help, Type type, std::unique_ptr<Metric> metric);
+
+            /**
+             * \brief guards the list of metrics, not the values
+             */
+            mutable std::mutex m_mutex;
+
+            std::vector<Entry> m_entries;
+        };
+    }
+}
+
+#endif
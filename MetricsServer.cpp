@@ -0,0 +1,53 @@
+/**
+ * \date 2023
+ * \copyright Allied Vision Technologies.  All Rights Reserved.
+ *
+ * \copyright Redistribution of this file, in original or modified form, without
+ *            prior written consent of Allied Vision Technologies is prohibited.
+ *
+ * \warning THIS SOFTWARE IS PROVIDED BY THE AUTHOR "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF TITLE,
+ * NON-INFRINGEMENT, MERCHANTABILITY AND FITNESS FOR A PARTICULAR  PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \brief Implementation of ::VmbC::Examples::MetricsServer
+ */
+
+#include <sstream>
+
+#include "MetricsRegistry.h"
+#include "MetricsServer.h"
+
+namespace VmbC
+{
+    namespace Examples
+    {
+        MetricsServer::MetricsServer(MetricsRegistry const& registry, VmbUint16_t const port)
+            : m_registry(registry),
+            m_server(port, [this](HttpServer::Request const& request, HttpServer::Response& response) { HandleRequest(request, response); })
+        {
+        }
+
+        void MetricsServer::HandleRequest(HttpServer::Request const& request, HttpServer::Response& response) const
+        /* 只响应 /metrics 路径，以 Prometheus 文本格式（版本0.0.4）返回注册表中的所有指标。 */
+        {
+            if (request.m_path != "/metrics")
+            {
+                response.m_status = 404;
+                response.m_body = "only /metrics is available\n";
+                return;
+            }
+
+            std::ostringstream body;
+            m_registry.Write(body);
+            response.m_contentType = "text/plain; version=0.0.4; charset=utf-8";
+            response.m_body = body.str();
+        }
+    }
+}
@@ -0,0 +1,67 @@
+/**
+ * \date 2023
+ * \copyright Allied Vision Technologies.  All Rights Reserved.
+ *
+ * \copyright Redistribution of this file, in original or modified form, without
+ *            prior written consent of Allied Vision Technologies is prohibited.
+ *
+ * \warning THIS SOFTWARE IS PROVIDED BY THE AUTHOR "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF TITLE,
+ * NON-INFRINGEMENT, MERCHANTABILITY AND FITNESS FOR A PARTICULAR  PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \brief Definition of the HTTP endpoint serving the metrics of a MetricsRegistry
+ */
+
+#ifndef ASYNCHRONOUSGRAB_C_METRICS_SERVER_H
+#define ASYNCHRONOUSGRAB_C_METRICS_SERVER_H
+
+#include <VmbC/VmbC.h>
+
+#include "HttpServer.h"
+
+namespace VmbC
+{
+    namespace Examples
+    {
+        class MetricsRegistry;
+
+        /**
+         * \brief Serves the metrics of a registry in the Prometheus text
+         *        format at http://127.0.0.1:<port>/metrics
+         */
+        class MetricsServer
+        {
+        public:
+            /**
+             * \brief the port used, if no port is configured
+             */
+            static constexpr VmbUint16_t DefaultPort = 9464;
+
+            /**
+             * \param[in] registry the metrics to serve; needs to outlive this object
+             * \param[in] port the port to listen on; 0 chooses a free port
+             * \throws VmbException, if the port cannot be bound
+             */
+            MetricsServer(MetricsRegistry const& registry, VmbUint16_t port = DefaultPort);
+
+            VmbUint16_t GetPort() const noexcept
+            {
+                return m_server.GetPort();
+            }
+        private:
+            MetricsRegistry const& m_registry;
+            HttpServer m_server;
+
+            void HandleRequest(HttpServer::Request const& request, HttpServer::Response& response) const;
+        };
+    }
+}
+
+#endif
@@ -0,0 +1,591 @@
+/**
+ * \date 2023
+ * \copyright Allied Vision Technologies.  All Rights Reserved.
+ *
+ * \copyright Redistribution of this file, in original or modified form, without
+ *            prior written consent of Allied Vision Technologies is prohibited.
+ *
+ * \warning THIS SOFTWARE IS PROVIDED BY THE AUTHOR "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF TITLE,
+ * NON-INFRINGEMENT, MERCHANTABILITY AND FITNESS FOR A PARTICULAR  PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \brief Implementation of ::VmbC::Examples::MjpegPreviewServer
+ */
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+
+#include "Image.h"
+#include "LibavSupport.h"
+#include "MjpegPreviewServer.h"
+#include "Tracing.h"
+#include "VmbException.h"
+
+#ifdef ASYNCHRONOUSGRAB_HAVE_LIBAV
+extern "C"
+{
+#include <libavcodec/avcodec.h>
+#include <libavutil/imgutils.h>
+#include <libswscale/swscale.h>
+}
+#endif
+
+namespace VmbC
+{
+    namespace Examples
+    {
+        namespace
+        {
+            /**
+             * \brief interval for checking, if the server should stop or a
+             *        client waiting for a JPEG disconnected
+             */
+            constexpr std::chrono::milliseconds StopCheckInterval { 100 };
+
+            /**
+             * \brief time a request of /snapshot.jpg waits for a JPEG
+             */
+            constexpr std::chrono::milliseconds SnapshotTimeout { 2000 };
+
+            /**
+             * \brief the minimum time between two adjustments of the rate
+             *        control; the data rate is measured over this interval
+             */
+            constexpr std::chrono::milliseconds AdaptationInterval { 500 };
+
+            /**
+             * \brief the quality or the frame rate is only raised, if the data
+             *        rate is below this fraction of the target, which prevents
+             *        oscillating between two settings
+             */
+            constexpr double RaiseThreshold = 0.7;
+
+            /**
+             * \brief the factor the frame rate is raised by per adjustment
+             */
+            constexpr double FrameRateStep = 1.25;
+
+            constexpr char const* Boundary = "AsynchronousGrabFrame";
+
+            MjpegPreviewServer::Clock::rep GetFrameInterval(double const frameRate) noexcept
+            {
+                return std::chrono::duration_cast<MjpegPreviewServer::Clock::duration>(std::chrono::duration<double>(1.0 / frameRate)).count();
+            }
+        }
+
+#ifdef ASYNCHRONOUSGRAB_HAVE_LIBAV
+        using LibavSupport::Check;
+        using LibavSupport::GetAvPixelFormat;
+        using LibavSupport::GetScaledSize;
+#endif
+        using LibavSupport::CopyImage;
+        using LibavSupport::GetBytesPerPixel;
+
+#ifdef ASYNCHRONOUSGRAB_HAVE_LIBAV
+        struct MjpegPreviewServer::Encoder
+        {
+            AVCodecContext* m_codec { nullptr };
+            SwsContext* m_scaler { nullptr };
+            AVFrame* m_frame { nullptr };
+            AVPacket* m_packet { nullptr };
+
+            /**
+             * \brief the images the encoder was created for
+             */
+            int m_sourceWidth { 0 };
+            int m_sourceHeight { 0 };
+            VmbPixelFormat_t m_sourceFormat { VmbPixelFormatLast };
+
+            ~Encoder()
+            {
+                sws_freeContext(m_scaler);
+                av_frame_free(&m_frame);
+                av_packet_free(&m_packet);
+                avcodec_free_context(&m_codec);
+            }
+        };
+#else
+        struct MjpegPreviewServer::Encoder
+        {
+        };
+#endif
+
+        bool MjpegPreviewServer::IsAvailable() noexcept
+        {
+#ifdef ASYNCHRONOUSGRAB_HAVE_LIBAV
+            return true;
+#else
+            return false;
+#endif
+        }
+
+        MjpegPreviewServer::MjpegPreviewServer(Settings const& settings)
+            : m_settings(settings),
+            m_slots(2),
+            m_encoder(new Encoder),
+            m_frameRate(settings.m_maxFrameRate),
+            m_quantizer(settings.m_minQuantizer),
+            m_frameInterval(GetFrameInterval(settings.m_maxFrameRate)),
+            m_reportedFrameRate(settings.m_maxFrameRate),
+            m_reportedQuantizer(settings.m_minQuantizer)
+        /* 两个图像槽足够：一个正在编码，一个等待编码；编码器忙时新帧直接丢弃。
+        预览从最高帧率和最好质量开始，由 AdaptRate 根据实际数据率调整。线程在最后启动，因为它们会立即使用其他成员。 */
+        {
+            if (!IsAvailable())
+            {
+                throw VmbException("built without libavcodec; define ASYNCHRONOUSGRAB_HAVE_LIBAV to serve a preview", VmbErrorNotSupported);
+            }
+            if (!(settings.m_bandwidth > 0) || !(settings.m_minFrameRate > 0) || settings.m_maxFrameRate < settings.m_minFrameRate)
+            {
+                throw VmbException("the bandwidth and the frame rates of the preview need to be positive", VmbErrorBadParameter);
+            }
+            if (settings.m_minQuantizer < 1 || settings.m_maxQuantizer > 31 || settings.m_maxQuantizer < settings.m_minQuantizer)
+            {
+                throw VmbException("the quantizer range of the preview needs to be within [1, 31]", VmbErrorBadParameter);
+            }
+
+            m_freeSlots = { 1, 0 };
+            m_server.reset(new ConnectionServer(settings.m_port,
+                                                [this](Socket const& connection, std::atomic<bool> const&) { ServeClient(connection); },
+                                                "MjpegPreview server"));
+            m_encoderThread = std::thread(&MjpegPreviewServer::Encode, this);
+        }
+
+        MjpegPreviewServer::~MjpegPreviewServer()
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_stop = true;
+            }
+            m_condition.notify_all();
+            m_jpegCondition.notify_all();
+            m_server.reset();
+            m_encoderThread.join();
+        }
+
+        void MjpegPreviewServer::ConvertedFrameReceived(Image const& image, VmbFrame_t const& frame)
+        /* 在转码线程中调用：没有客户端时什么都不做。按当前预览帧率跳过多余的帧（不复制），帧的时间表按帧间隔递增，
+        因此输入帧率不是预览帧率的整数倍时平均帧率仍然准确；长时间没有接受帧（例如没有客户端）后时间表从当前时间重新开始。
+        然后把图像复制到空闲槽中；编码器忙时丢弃该帧，从不等待编码线程。 */
+        {
+            if (m_activeClients.load(std::memory_order_relaxed) == 0)
+            {
+                return;
+            }
+            if (m_failed.load(std::memory_order_relaxed))
+            {
+                ++m_framesDropped;
+                return;
+            }
+
+            auto const now = Clock::now();
+            Clock::duration const interval(m_frameInterval.load(std::memory_order_relaxed));
+            if (now < m_nextFrameTime)
+            {
+                ++m_framesSkipped;
+                return;
+            }
+
+            size_t const bytesPerPixel = GetBytesPerPixel(image.GetPixelFormat());
+            size_t index;
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                if (m_freeSlots.empty() || bytesPerPixel == 0 || m_stop)
+                {
+                    ++m_framesDropped;
+                    return;
+                }
+                index = m_freeSlots.back();
+                m_freeSlots.pop_back();
+            }
+            m_nextFrameTime = (now - m_nextFrameTime > interval) ? now + interval : m_nextFrameTime + interval;
+
+            ASYNCHRONOUSGRAB_TRACE_SCOPE("CopyPreviewFrame", frame.frameID);
+            Slot& slot = m_slots[index];
+            slot.m_width = image.GetWidth();
+            slot.m_height = image.GetHeight();
+            slot.m_pixelFormat = image.GetPixelFormat();
+            slot.m_frameId = frame.frameID;
+            CopyImage(image, bytesPerPixel, slot.m_data);
+
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_queuedSlots.push_back(index);
+            }
+            m_condition.notify_one();
+        }
+
+        MjpegPreviewServer::Statistics MjpegPreviewServer::GetStatistics() const
+        {
+            Statistics statistics;
+            statistics.m_framesEncoded = m_framesEncoded.load(std::memory_order_relaxed);
+            statistics.m_framesSkipped = m_framesSkipped.load(std::memory_order_relaxed);
+            statistics.m_framesDropped = m_framesDropped.load(std::memory_order_relaxed);
+            statistics.m_clients = m_clients.load(std::memory_order_relaxed);
+            statistics.m_framesSent = m_framesSent.load(std::memory_order_relaxed);
+            statistics.m_framesSkippedByClients = m_framesSkippedByClients.load(std::memory_order_relaxed);
+            statistics.m_bytesSent = m_bytesSent.load(std::memory_order_relaxed);
+            statistics.m_frameRate = m_reportedFrameRate.load(std::memory_order_relaxed);
+            statistics.m_quantizer = m_reportedQuantizer.load(std::memory_order_relaxed);
+            statistics.m_averageFrameSize = m_reportedFrameSize.load(std::memory_order_relaxed);
+            if (statistics.m_framesEncoded != 0)
+            {
+                statistics.m_averageEncodeTime = Clock::duration(m_encodeTime.load(std::memory_order_relaxed) / static_cast<Clock::rep>(statistics.m_framesEncoded));
+            }
+            std::lock_guard<std::mutex> lock(m_mutex);
+            statistics.m_error = m_error;
+            return statistics;
+        }
+
+        void MjpegPreviewServer::Encode()
+        /* 编码线程：每帧只编码一次，结果作为不可修改的共享对象替换 m_latest，所有客户端线程发送同一份数据，
+        仍在发送旧JPEG的客户端继续持有旧对象的引用。出错后不再编码，之后的帧被丢弃。 */
+        {
+            ASYNCHRONOUSGRAB_TRACE_THREAD_NAME("MjpegPreview");
+
+            m_intervalStart = Clock::now();
+            while (true)
+            {
+                size_t index;
+                {
+                    std::unique_lock<std::mutex> lock(m_mutex);
+                    m_condition.wait(lock, [this]() { return m_stop || !m_queuedSlots.empty(); });
+                    if (m_stop)
+                    {
+                        break;
+                    }
+                    index = m_queuedSlots.front();
+                    m_queuedSlots.pop_front();
+                }
+
+                if (!m_failed.load(std::memory_order_relaxed))
+                {
+                    Slot const& slot = m_slots[index];
+                    ASYNCHRONOUSGRAB_TRACE_SCOPE("EncodePreviewFrame", slot.m_frameId);
+                    auto const start = Clock::now();
+                    try
+                    {
+                        auto jpeg = std::make_shared<Jpeg>();
+                        EncodeSlot(slot, jpeg->m_data);
+                        jpeg->m_sequence = ++m_framesEncoded;
+                        m_encodeTime += (Clock::now() - start).count();
+                        AdaptRate(jpeg->m_data.size());
+                        {
+                            std::lock_guard<std::mutex> lock(m_mutex);
+                            m_latest = std::move(jpeg);
+                        }
+                        m_jpegCondition.notify_all();
+                    }
+                    catch (VmbException const& ex)
+                    {
+                        std::lock_guard<std::mutex> lock(m_mutex);
+                        m_error = ex.what();
+                        m_failed = true;
+                    }
+                }
+
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_freeSlots.push_back(index);
+            }
+            m_encoder.reset();
+        }
+
+        void MjpegPreviewServer::AdaptRate(size_t const jpegSize)
+        /* 每个 AdaptationInterval 按实际发送的数据量计算数据率（而不是用设定帧率估算，因为相机可能比设定帧率慢）。
+        超过目标时先提高量化系数（降低质量），量化系数已到上限时按超出比例降低帧率；
+        低于目标的 RaiseThreshold 时按相反顺序恢复：先提高帧率，再逐级降低量化系数。 */
+        {
+            m_intervalBytes += jpegSize;
+            ++m_intervalFrames;
+            auto const now = Clock::now();
+            if (now - m_intervalStart < AdaptationInterval)
+            {
+                return;
+            }
+
+            double const seconds = std::chrono::duration<double>(now - m_intervalStart).count();
+            double const dataRate = m_intervalBytes / seconds;
+            double const frameRate = m_intervalFrames / seconds;
+            m_reportedFrameSize.store(static_cast<double>(m_intervalBytes) / m_intervalFrames, std::memory_order_relaxed);
+            m_intervalStart = now;
+            m_intervalBytes = 0;
+            m_intervalFrames = 0;
+
+            if (dataRate > m_settings.m_bandwidth)
+            {
+                if (m_quantizer < m_settings.m_maxQuantizer)
+                {
+                    m_quantizer = (std::min)(m_quantizer + (std::max)(m_quantizer / 4, 1), m_settings.m_maxQuantizer);
+                }
+                else
+                {
+                    m_frameRate = (std::max)((std::min)(m_frameRate, frameRate) * m_settings.m_bandwidth / dataRate, m_settings.m_minFrameRate);
+                }
+            }
+            else if (dataRate < m_settings.m_bandwidth * RaiseThreshold)
+            {
+                if (m_frameRate < m_settings.m_maxFrameRate)
+                {
+                    m_frameRate = (std::min)(m_frameRate * FrameRateStep, m_settings.m_maxFrameRate);
+                }
+                else if (m_quantizer > m_settings.m_minQuantizer)
+                {
+                    --m_quantizer;
+                }
+            }
+
+            m_frameInterval.store(GetFrameInterval(m_frameRate), std::memory_order_relaxed);
+            m_reportedFrameRate.store(m_frameRate, std::memory_order_relaxed);
+            m_reportedQuantizer.store(m_quantizer, std::memory_order_relaxed);
+        }
+
+#ifdef ASYNCHRONOUSGRAB_HAVE_LIBAV
+        void MjpegPreviewServer::OpenEncoder(Slot const& slot)
+        /* 输出大小由 GetScaledSize 按 m_maxWidth/m_maxHeight 计算。
+        AV_CODEC_FLAG_QSCALE 使编码器使用每帧的 quality，因此改变量化系数不需要重新创建编码器。 */
+        {
+            AVPixelFormat const sourceFormat = GetAvPixelFormat(slot.m_pixelFormat);
+            if (sourceFormat == AV_PIX_FMT_NONE)
+            {
+                throw VmbException("unsupported pixel format of the converted images", VmbErrorNotSupported);
+            }
+
+            int width;
+            int height;
+            GetScaledSize(slot.m_width, slot.m_height, m_settings.m_maxWidth, m_settings.m_maxHeight, width, height);
+
+            AVCodec const* const codec = avcodec_find_encoder(AV_CODEC_ID_MJPEG);
+            if (codec == nullptr)
+            {
+                throw VmbException("the MJPEG encoder is not available in the libavcodec used", VmbErrorNotSupported);
+            }
+
+            m_encoder.reset(new Encoder);
+            Encoder& encoder = *m_encoder;
+            encoder.m_codec = avcodec_alloc_context3(codec);
+            encoder.m_frame = av_frame_alloc();
+            encoder.m_packet = av_packet_alloc();
+            if (encoder.m_codec == nullptr || encoder.m_frame == nullptr || encoder.m_packet == nullptr)
+            {
+                throw VmbException("unable to allocate the encoder", VmbErrorResources);
+            }
+
+            AVCodecContext& context = *encoder.m_codec;
+            context.width = width;
+            context.height = height;
+            context.pix_fmt = AV_PIX_FMT_YUVJ420P;
+            context.color_range = AVCOL_RANGE_JPEG;
+            context.time_base = av_inv_q(av_d2q(m_settings.m_maxFrameRate, 100000));
+            context.flags |= AV_CODEC_FLAG_QSCALE;
+            context.global_quality = m_quantizer * FF_QP2LAMBDA;
+            Check(avcodec_open2(encoder.m_codec, codec, nullptr), "avcodec_open2");
+
+            encoder.m_scaler = sws_getContext(slot.m_width, slot.m_height, sourceFormat, width, height, context.pix_fmt,
+                                              SWS_AREA, nullptr, nullptr, nullptr);
+            if (encoder.m_scaler == nullptr)
+            {
+                throw VmbException("unable to create the scaler", VmbErrorResources);
+            }
+            encoder.m_sourceWidth = slot.m_width;
+            encoder.m_sourceHeight = slot.m_height;
+            encoder.m_sourceFormat = slot.m_pixelFormat;
+
+            encoder.m_frame->format = context.pix_fmt;
+            encoder.m_frame->width = width;
+            encoder.m_frame->height = height;
+            Check(av_frame_get_buffer(encoder.m_frame, 0), "av_frame_get_buffer");
+        }
+
+        void MjpegPreviewServer::EncodeSlot(Slot const& slot, std::vector<unsigned char>& jpeg)
+        /* 图像大小或格式改变（例如切换相机）时重新创建编码器，而不是像视频文件那样报错。 */
+        {
+            if (m_encoder->m_codec == nullptr
+                || slot.m_width != m_encoder->m_sourceWidth
+                || slot.m_height != m_encoder->m_sourceHeight
+                || slot.m_pixelFormat != m_encoder->m_sourceFormat)
+            {
+                OpenEncoder(slot);
+            }
+            Encoder& encoder = *m_encoder;
+
+            Check(av_frame_make_writable(encoder.m_frame), "av_frame_make_writable");
+            uint8_t const* const source[] = { slot.m_data.data() };
+            int const sourceStride[] = { static_cast<int>(slot.m_data.size() / static_cast<size_t>(slot.m_height)) };
+            sws_scale(encoder.m_scaler, source, sourceStride, 0, slot.m_height, encoder.m_frame->data, encoder.m_frame->linesize);
+            encoder.m_frame->pts = static_cast<int64_t>(m_framesEncoded.load(std::memory_order_relaxed));
+            encoder.m_frame->quality = m_quantizer * FF_QP2LAMBDA;
+
+            Check(avcodec_send_frame(encoder.m_codec, encoder.m_frame), "avcodec_send_frame");
+            while (true)
+            {
+                int const result = avcodec_receive_packet(encoder.m_codec, encoder.m_packet);
+                if (result == AVERROR(EAGAIN) || result == AVERROR_EOF)
+                {
+                    break;
+                }
+                Check(result, "avcodec_receive_packet");
+                jpeg.insert(jpeg.end(), encoder.m_packet->data, encoder.m_packet->data + encoder.m_packet->size);
+                av_packet_unref(encoder.m_packet);
+            }
+        }
+#else
+        void MjpegPreviewServer::OpenEncoder(Slot const&)
+        {
+            throw VmbException("built without libavcodec", VmbErrorNotSupported);
+        }
+
+        void MjpegPreviewServer::EncodeSlot(Slot const&, std::vector<unsigned char>&)
+        {
+            throw VmbException("built without libavcodec", VmbErrorNotSupported);
+        }
+#endif
+
+        void MjpegPreviewServer::ServeClient(Socket const& connection)
+        /* 读取请求并根据路径发送流或单张JPEG。发送超时使不再接收数据的客户端在 m_sendTimeout 后断开，
+        不会无限期地占用线程。 */
+        {
+            ASYNCHRONOUSGRAB_TRACE_THREAD_NAME("MjpegPreview client");
+
+            connection.SetSendTimeout(m_settings.m_sendTimeout);
+
+            HttpServer::Request request;
+            HttpServer::Response response;
+            bool streamed = false;
+            if (!HttpServer::ReadRequest(connection, request))
+            {
+                response.m_status = 400;
+            }
+            else if (request.m_method != "GET")
+            {
+                response.m_status = 405;
+            }
+            else
+            {
+                std::string const path = request.m_path.substr(0, request.m_path.find('?'));
+                if (path == "/" || path == "/stream")
+                {
+                    if (m_clients.load(std::memory_order_relaxed) < m_settings.m_maxClients)
+                    {
+                        Stream(connection);
+                        streamed = true;
+                    }
+                    else
+                    {
+                        response.m_status = 503;
+                        response.m_body = "too many clients";
+                    }
+                }
+                else if (path == "/snapshot.jpg")
+                {
+                    VmbUint64_t sequence;
+                    {
+                        std::lock_guard<std::mutex> lock(m_mutex);
+                        sequence = m_latest ? m_latest->m_sequence : 0;
+                    }
+                    ++m_activeClients;
+                    auto const jpeg = WaitForJpeg(sequence, SnapshotTimeout);
+                    --m_activeClients;
+                    if (jpeg)
+                    {
+                        response.m_contentType = "image/jpeg";
+                        response.m_body.assign(jpeg->m_data.begin(), jpeg->m_data.end());
+                        ++m_framesSent;
+                        m_bytesSent += jpeg->m_data.size();
+                    }
+                    else
+                    {
+                        response.m_status = 503;
+                        response.m_body = "no frame received";
+                    }
+                }
+                else
+                {
+                    response.m_status = 404;
+                }
+            }
+            if (!streamed)
+            {
+                HttpServer::SendResponse(connection, response);
+            }
+        }
+
+        void MjpegPreviewServer::Stream(Socket const& connection)
+        /* 每次只发送最新的JPEG：发送期间编码的帧被这个客户端跳过并计数，其他客户端不受影响。
+        等待新帧时检查连接是否已被客户端关闭，以便在没有帧时也能及时释放线程。 */
+        {
+            std::string const header = std::string("HTTP/1.1 200 OK\r\n")
+                + "Content-Type: multipart/x-mixed-replace; boundary=" + Boundary + "\r\n"
+                + "Cache-Control: no-cache, no-store\r\n"
+                + "Connection: close\r\n"
+                + "\r\n";
+            if (!connection.SendAll(header.data(), header.size()))
+            {
+                return;
+            }
+
+            VmbUint64_t sequence;
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                sequence = m_latest ? m_latest->m_sequence : 0;
+            }
+
+            ++m_clients;
+            ++m_activeClients;
+            while (true)
+            {
+                auto const jpeg = WaitForJpeg(sequence, StopCheckInterval);
+                if (!jpeg)
+                {
+                    char buffer[256];
+                    if (m_stop || (connection.WaitReadable(std::chrono::milliseconds(0)) && connection.Receive(buffer, sizeof(buffer)) <= 0))
+                    {
+                        break;
+                    }
+                    continue;
+                }
+                if (sequence != 0)
+                {
+                    m_framesSkippedByClients += jpeg->m_sequence - sequence - 1;
+                }
+                sequence = jpeg->m_sequence;
+
+                std::string const partHeader = std::string("--") + Boundary + "\r\n"
+                    + "Content-Type: image/jpeg\r\n"
+                    + "Content-Length: " + std::to_string(jpeg->m_data.size()) + "\r\n"
+                    + "\r\n";
+                if (!connection.SendAll(partHeader.data(), partHeader.size())
+                    || !connection.SendAll(jpeg->m_data.data(), jpeg->m_data.size())
+                    || !connection.SendAll("\r\n", 2))
+                {
+                    break;
+                }
+                ++m_framesSent;
+                m_bytesSent += partHeader.size() + jpeg->m_data.size() + 2;
+            }
+            --m_activeClients;
+            --m_clients;
+        }
+
+        std::shared_ptr<MjpegPreviewServer::Jpeg const> MjpegPreviewServer::WaitForJpeg(VmbUint64_t const sequence, std::chrono::milliseconds const timeout)
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            bool const available = m_jpegCondition.wait_for(lock, timeout, [this, sequence]()
+                {
+                    return m_stop || (m_latest && m_latest->m_sequence > sequence);
+                });
+            if (!available || m_stop)
+            {
+                return nullptr;
+            }
+            return m_latest;
+        }
+    }
+}
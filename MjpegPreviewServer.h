@@ -0,0 +1,365 @@
+/**
+ * \date 2023
+ * \copyright Allied Vision Technologies.  All Rights Reserved.
+ *
+ * \copyright Redistribution of this file, in original or modified form, without
+ *            prior written consent of Allied Vision Technologies is prohibited.
+ *
+ * \warning THIS SOFTWARE IS PROVIDED BY THE AUTHOR "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF TITLE,
+ * NON-INFRINGEMENT, MERCHANTABILITY AND FITNESS FOR A PARTICULAR  PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \brief Definition of an HTTP server streaming a JPEG preview of the frames
+ */
+
+#ifndef ASYNCHRONOUSGRAB_C_MJPEG_PREVIEW_SERVER_H
+#define ASYNCHRONOUSGRAB_C_MJPEG_PREVIEW_SERVER_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <VmbC/VmbC.h>
+
+#include "ConnectionServer.h"
+#include "FrameSink.h"
+#include "HttpServer.h"
+#include "Socket.h"
+
+namespace VmbC
+{
+    namespace Examples
+    {
+        /**
+         * \brief Serves a scaled-down JPEG preview of the converted frames
+         *        as `multipart/x-mixed-replace` stream on a port of the
+         *        loopback interface, e.g. for browsers or
+         *        `curl http://127.0.0.1:8090/stream`.
+         *
+         * ConvertedFrameReceived only copies the image into a free slot of a
+         * small queue and drops the frame, if the encoder is busy. An encoder
+         * thread scales the image down with libswscale and encodes it once
+         * with the MJPEG encoder of libavcodec; all clients are sent the same
+         * JPEG data. No frames are encoded while no client is connected.
+         *
+         * Every client is served by its own thread sending only the most
+         * recent JPEG; frames encoded while a client is still sending the
+         * previous one are skipped for this client only, so a slow client
+         * neither delays the encoder nor the other clients.
+         *
+         * The quantizer of the JPEG encoder and the frame rate are adapted to
+         * keep the data rate of the stream below m_bandwidth: the quality is
+         * reduced first, the frame rate only at the worst quality; they are
+         * raised again in the reverse order once the data rate falls clearly
+         * below the target.
+         *
+         * Paths served:
+         * - `/` or `/stream`: the multipart stream
+         * - `/snapshot.jpg`: the next JPEG encoded
+         *
+         * Only available if built with libavcodec and libswscale
+         * (ASYNCHRONOUSGRAB_HAVE_LIBAV).
+         */
+        class MjpegPreviewServer : public ConvertedFrameSink
+        {
+        public:
+            using Clock = std::chrono::steady_clock;
+
+            static constexpr VmbUint16_t DefaultPort = 8090;
+
+            struct Settings
+            {
+                /**
+                 * \brief the port to listen on; 0 chooses a free port
+                 */
+                VmbUint16_t m_port { DefaultPort };
+
+                /**
+                 * \brief the maximum size of the preview; larger images are
+                 *        scaled down keeping the aspect ratio
+                 */
+                ///@{
+                int m_maxWidth { 640 };
+                int m_maxHeight { 480 };
+                ///@}
+
+                /**
+                 * \brief the target data rate of the stream sent to each
+                 *        client in bytes per second
+                 */
+                double m_bandwidth { 2e6 };
+
+                /**
+                 * \brief the range of the frame rate of the stream
+                 */
+                ///@{
+                double m_maxFrameRate { 15.0 };
+                double m_minFrameRate { 1.0 };
+                ///@}
+
+                /**
+                 * \brief the range of the JPEG quantizer scale; lower values
+                 *        result in a higher quality and larger frames
+                 */
+                ///@{
+                int m_minQuantizer { 2 };
+                int m_maxQuantizer { 24 };
+                ///@}
+
+                /**
+                 * \brief the maximum number of clients served at the same time
+                 */
+                unsigned m_maxClients { 8 };
+
+                /**
+                 * \brief clients not receiving data for this time are disconnected
+                 */
+                std::chrono::milliseconds m_sendTimeout { 5000 };
+            };
+
+            struct Statistics
+            {
+                VmbUint64_t m_framesEncoded { 0 };
+
+                /**
+                 * \brief frames not encoded to reduce the frame rate
+                 */
+                VmbUint64_t m_framesSkipped { 0 };
+
+                /**
+                 * \brief frames dropped, because the encoder was busy
+                 */
+                VmbUint64_t m_framesDropped { 0 };
+
+                /**
+                 * \brief the number of clients currently connected
+                 */
+                unsigned m_clients { 0 };
+
+                /**
+                 * \brief JPEGs sent and skipped summed over all clients
+                 */
+                ///@{
+                VmbUint64_t m_framesSent { 0 };
+                VmbUint64_t m_framesSkippedByClients { 0 };
+                ///@}
+                VmbUint64_t m_bytesSent { 0 };
+
+                /**
+                 * \brief the current settings of the rate control
+                 */
+                ///@{
+                double m_frameRate { 0.0 };
+                int m_quantizer { 0 };
+                ///@}
+
+                /**
+                 * \brief the average size of the recent JPEGs in bytes
+                 */
+                double m_averageFrameSize { 0.0 };
+                Clock::duration m_averageEncodeTime {};
+
+                /**
+                 * \brief the error stopping the encoder; empty, if none occurred
+                 */
+                std::string m_error;
+            };
+
+            /**
+             * \return true, if the server was built with libavcodec
+             */
+            static bool IsAvailable() noexcept;
+
+            /**
+             * \brief start listening and the encoder thread
+             * \throws VmbException, if the server is not available, the
+             *                      settings are invalid or the port cannot
+             *                      be bound
+             */
+            MjpegPreviewServer(Settings const& settings);
+
+            /**
+             * \brief disconnects the clients and stops the threads
+             */
+            ~MjpegPreviewServer();
+
+            MjpegPreviewServer(MjpegPreviewServer const&) = delete;
+            MjpegPreviewServer& operator=(MjpegPreviewServer const&) = delete;
+
+            void ConvertedFrameReceived(Image const& image, VmbFrame_t const& frame) override;
+
+            VmbUint16_t GetPort() const noexcept
+            {
+                return m_server->GetPort();
+            }
+
+            Statistics GetStatistics() const;
+        private:
+            /**
+             * \brief the libav objects of the encoder; defined in the
+             *        implementation to keep the libav headers private
+             */
+            struct Encoder;
+
+            struct Slot
+            {
+                std::vector<unsigned char> m_data;
+                int m_width { 0 };
+                int m_height { 0 };
+                VmbPixelFormat_t m_pixelFormat { VmbPixelFormatLast };
+                VmbUint64_t m_frameId { 0 };
+            };
+
+            /**
+             * \brief a JPEG shared by all clients
+             */
+            struct Jpeg
+            {
+                std::vector<unsigned char> m_data;
+
+                /**
+                 * \brief consecutive number of the JPEG starting at 1
+                 */
+                VmbUint64_t m_sequence { 0 };
+            };
+
+            Settings const m_settings;
+
+            std::vector<Slot> m_slots;
+
+            mutable std::mutex m_mutex;
+            std::condition_variable m_condition;
+
+            /**
+             * \name State guarded by m_mutex
+             */
+            ///@{
+            std::vector<size_t> m_freeSlots;
+            std::deque<size_t> m_queuedSlots;
+            std::shared_ptr<Jpeg const> m_latest;
+            std::string m_error;
+            ///@}
+
+            /**
+             * \brief set while holding m_mutex to wake the waiting threads
+             */
+            std::atomic<bool> m_stop { false };
+
+            /**
+             * \brief notified when m_latest is replaced or m_stop is set
+             */
+            std::condition_variable m_jpegCondition;
+
+            /**
+             * \name State of the conversion thread
+             */
+            ///@{
+            Clock::time_point m_nextFrameTime;
+            ///@}
+
+            /**
+             * \name State of the encoder thread
+             */
+            ///@{
+            std::unique_ptr<Encoder> m_encoder;
+            double m_frameRate;
+            int m_quantizer;
+
+            // the JPEGs encoded since the rate was adapted last
+            Clock::time_point m_intervalStart;
+            size_t m_intervalBytes { 0 };
+            unsigned m_intervalFrames { 0 };
+            ///@}
+
+            /**
+             * \brief the minimum time between two frames encoded; written by
+             *        the encoder thread
+             */
+            std::atomic<Clock::rep> m_frameInterval;
+
+            /**
+             * \brief the number of clients waiting for JPEGs; no frames are
+             *        encoded while it is 0
+             */
+            std::atomic<unsigned> m_activeClients { 0 };
+
+            std::atomic<bool> m_failed { false };
+            std::atomic<VmbUint64_t> m_framesEncoded { 0 };
+            std::atomic<VmbUint64_t> m_framesSkipped { 0 };
+            std::atomic<VmbUint64_t> m_framesDropped { 0 };
+            std::atomic<VmbUint64_t> m_framesSent { 0 };
+            std::atomic<VmbUint64_t> m_framesSkippedByClients { 0 };
+            std::atomic<VmbUint64_t> m_bytesSent { 0 };
+            std::atomic<Clock::rep> m_encodeTime { 0 };
+            std::atomic<unsigned> m_clients { 0 };
+
+            /**
+             * \brief copies of the rate control state for GetStatistics
+             */
+            ///@{
+            std::atomic<double> m_reportedFrameRate;
+            std::atomic<int> m_reportedQuantizer;
+            std::atomic<double> m_reportedFrameSize { 0.0 };
+            ///@}
+
+            std::thread m_encoderThread;
+
+            /**
+             * \brief serves the HTTP connections; created last
+             */
+            std::unique_ptr<ConnectionServer> m_server;
+
+            void Encode();
+
+            /**
+             * \brief create the scaler and the codec for the size of an image
+             * \throws VmbException, if libav reports an error
+             */
+            void OpenEncoder(Slot const& slot);
+
+            /**
+             * \brief scale and encode an image
+             * \throws VmbException, if libav reports an error
+             */
+            void EncodeSlot(Slot const& slot, std::vector<unsigned char>& jpeg);
+
+            /**
+             * \brief adjust the quantizer and the frame rate to the size of
+             *        the JPEG encoded last
+             */
+            void AdaptRate(size_t jpegSize);
+
+            /**
+             * \brief answer the request of a connection
+             */
+            void ServeClient(Socket const& connection);
+
+            /**
+             * \brief send the JPEGs as multipart stream until the client
+             *        disconnects or the server is destroyed
+             */
+            void Stream(Socket const& connection);
+
+            /**
+             * \brief wait for a JPEG newer than the one with the sequence number
+             * \return null, if the server is stopped or the timeout expired
+             */
+            std::shared_ptr<Jpeg const> WaitForJpeg(VmbUint64_t sequence, std::chrono::milliseconds timeout);
+        };
+    }
+}
+
+#endif
@@ -52,5 +52,9 @@ namespace VmbC
         void ModuleData::Visitor::Visit(VmbTransportLayerInfo_t const& data)
         {
         }
+
+        void ModuleData::Visitor::Visit(PlaybackInfo const& data)
+        {
+        }
     } // namespace Examples
 } // namespace VmbC
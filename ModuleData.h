@@ -26,7 +26,7 @@
 
 #include <VmbC/VmbC.h>
 
-class MainWindow;
+#include "PlaybackCamera.h"
 
 namespace VmbC
 {
@@ -34,6 +34,15 @@ namespace VmbC
     {
         class ApiController;
 
+        /**
+         * \brief a recording that can be selected instead of a camera
+         */
+        struct PlaybackInfo
+        {
+            std::string m_displayName;
+            PlaybackCamera::Settings m_settings;
+        };
+
         class ModuleData
         {
         public:
@@ -47,6 +56,8 @@ namespace VmbC
                 virtual void Visit(VmbInterfaceInfo_t const& data);
 
                 virtual void Visit(VmbTransportLayerInfo_t const& data);
+
+                virtual void Visit(PlaybackInfo const& data);
             };
 
             virtual ~ModuleData() = default; //返回指向父模块数据的指针。
@@ -108,6 +119,7 @@ namespace VmbC
         using CameraData = ModuleDataImpl<VmbCameraInfo_t>;
         using InterfaceData = ModuleDataImpl<VmbInterfaceInfo_t>;
         using TlData = ModuleDataImpl<VmbTransportLayerInfo_t>;
+        using PlaybackData = ModuleDataImpl<PlaybackInfo>;
 
     } // namespace Examples
 } // namespace VmbC
@@ -47,17 +47,14 @@ namespace VmbC
         ModuleTreeModel::ModuleTreeModel(std::vector<std::unique_ptr<ModuleData>>&& moduleData)
         /*brief： 
         构造函数接受一个右值引用的 std::vector<std::unique_ptr<ModuleData>> 参数 moduleData，并根据该参数初始化模型的数据。
-        首先，通过 reserve 分配足够的内存空间，然后使用移动语义将 moduleData 中的元素转移至 m_data。
+        首先，使用移动语义将 moduleData 中的元素转移至 m_data。
         接下来，创建一个映射表 mapping，将每个 ModuleData 对象与包含它的 Item 对象进行关联。
         然后，初始化每个 Item 对象的父项和子项列表，设置相应的父项和索引值。 */
         {
-            m_data.reserve(moduleData.size());
-
             for (auto& md : moduleData)
             {
                 m_data.emplace_back(std::move(md));
             }
-            m_data.shrink_to_fit();
             
             // create mapping for ModuleData to Item containing it
             std::unordered_map<ModuleData*, Item*> mapping;
@@ -207,6 +204,21 @@ namespace VmbC
             return flags;
         }
 
+        QModelIndex ModuleTreeModel::AddTopLevelModule(std::unique_ptr<ModuleData>&& module)
+        /* 在顶层末尾插入一项（例如回放的录制文件）。m_data 是 deque，在末尾添加元素不会移动已有的 Item，
+        因此已有模型索引中保存的指针仍然有效。 */
+        {
+            int const row = static_cast<int>(m_pseudoRoot.m_children.size());
+            beginInsertRows(QModelIndex(), row, row);
+            m_data.emplace_back(std::move(module));
+            Item& item = m_data.back();
+            item.m_parent = &m_pseudoRoot;
+            item.m_indexInParent = m_pseudoRoot.m_children.size();
+            m_pseudoRoot.m_children.push_back(&item);
+            endInsertRows();
+            return createIndex(row, 0, &item);
+        }
+
         ModuleData const* ModuleTreeModel::GetModule(QModelIndex const& modelIndex)
         /* 根据给定的模型索引返回关联的 ModuleData 对象指针。
         如果模型索引无效，则返回 nullptr。
@@ -236,6 +248,20 @@ namespace VmbC
             }
         }
 
+        void ModuleTreeModel::DataRetrievalVisitor::Visit(PlaybackInfo const& data)
+        /* 对于回放的录制文件，显示名称为 "Playback (文件名)"，工具提示为完整路径。 */
+        {
+            switch (m_role)
+            {
+            case Qt::ItemDataRole::DisplayRole:
+                m_result = QString("Playback (") + QString::fromStdString(data.m_displayName) + QString(")");
+                break;
+            case Qt::ItemDataRole::ToolTipRole:
+                m_result = QString::fromStdString(data.m_settings.m_fileName);
+                break;
+            }
+        }
+
         void ModuleTreeModel::DataRetrievalVisitor::Visit(VmbInterfaceInfo_t const& data)
         /* 根据角色的不同，执行不同的操作：
         当角色为Qt::ItemDataRole::DisplayRole时，将data.interfaceName作为结果。 */
@@ -281,5 +307,11 @@ namespace VmbC
         {
             m_flags |= (Qt::ItemFlag::ItemNeverHasChildren | Qt::ItemFlag::ItemIsSelectable);
         }
+
+        void ModuleTreeModel::FlagUpdateVisitor::Visit(PlaybackInfo const& data)
+        /* 回放的录制文件和相机一样可以被选中。 */
+        {
+            m_flags |= (Qt::ItemFlag::ItemNeverHasChildren | Qt::ItemFlag::ItemIsSelectable);
+        }
 } // namespace Examples
 } // namespace VmbC
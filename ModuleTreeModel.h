@@ -22,6 +22,7 @@
 #ifndef ASYNCHRONOUSGRAB_C_MODULE_TREE_MODEL_H
 #define ASYNCHRONOUSGRAB_C_MODULE_TREE_MODEL_H
 
+#include <deque>
 #include <string>
 #include <memory>
 #include <vector>
@@ -54,6 +55,13 @@ namespace VmbC
              * \return a pointer to the module data object or null, if the index is invalid
              */
             static ModuleData const* GetModule(QModelIndex const& modelIndex);
+
+            /**
+             * \brief add a module without parent, e.g. a recording, after the
+             *        existing top level items
+             * \return the model index of the new item
+             */
+            QModelIndex AddTopLevelModule(std::unique_ptr<ModuleData>&& module);
         private:
             struct DataRetrievalVisitor : ModuleData::Visitor
             {
@@ -67,6 +75,7 @@ namespace VmbC
                 void Visit(VmbInterfaceInfo_t const& data) override;
 
                 void Visit(VmbTransportLayerInfo_t const& data) override;
+                void Visit(PlaybackInfo const& data) override;
             };
 
             struct FlagUpdateVisitor : ModuleData::Visitor
@@ -108,9 +117,11 @@ namespace VmbC
             Item m_pseudoRoot;
 
             /**
-             * \brief a list of all items of the module  
+             * \brief a list of all items of the module; a deque to keep the
+             *        items referenced by the model indices in place when
+             *        adding items
              */
-            std::vector<Item> m_data;
+            std::deque<Item> m_data;
         };
     } // namespace Examples
 } // namespace VmbC
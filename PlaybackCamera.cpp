@@ -0,0 +1,202 @@
+/**
+ * \date 2023
+ * \copyright Allied Vision Technologies.  All Rights Reserved.
+ *
+ * \copyright Redistribution of this file, in original or modified form, without
+ *            prior written consent of Allied Vision Technologies is prohibited.
+ *
+ * \warning THIS SOFTWARE IS PROVIDED BY THE AUTHOR "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF TITLE,
+ * NON-INFRINGEMENT, MERCHANTABILITY AND FITNESS FOR A PARTICULAR  PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \brief Implementation of ::VmbC::Examples::PlaybackCamera
+ */
+
+#include <algorithm>
+#include <cstring>
+
+#include "PlaybackCamera.h"
+#include "Tracing.h"
+#include "VmbException.h"
+
+namespace VmbC
+{
+    namespace Examples
+    {
+        PlaybackCamera::PlaybackCamera(Settings const& settings, VmbFrameCallback const callback, void* const context, size_t const frameCount)
+            : m_settings(settings),
+            m_reader(settings.m_fileName),
+            m_callback(callback),
+            m_frames((std::max)(frameCount, size_t(1))),
+            m_buffers(m_frames.size()),
+            m_metadata(m_frames.size())
+        /* 映射录制文件并准备固定数量的帧槽（与真实相机的帧缓冲区数量相同），然后启动回放线程。
+        帧的context[0]与真实相机的帧相同，context[FrameQueueContextIndex]指向本对象，处理后的帧通过QueueFrame归还；
+        context[FrameMetadataContextIndex]指向帧槽的元数据，回放时填入录制的元数据。 */
+        {
+            if (m_reader.GetFrameCount() == 0)
+            {
+                throw VmbException(settings.m_fileName + " does not contain any frames");
+            }
+            if (settings.m_timing == Timing::FixedRate && !(settings.m_frameRate > 0))
+            {
+                throw VmbException("the playback frame rate needs to be positive", VmbErrorBadParameter);
+            }
+
+            m_freeFrames.reserve(m_frames.size());
+            for (size_t slot = 0; slot != m_frames.size(); ++slot)
+            {
+                auto& frame = m_frames[slot];
+                std::memset(&frame, 0, sizeof(frame));
+                frame.context[0] = context;
+                SetFrameQueue(frame, this);
+                // remember the slot to find it in QueueFrame
+                frame.context[FrameQueueContextIndex + 1] = reinterpret_cast<void*>(slot);
+                SetFrameMetadata(frame, &m_metadata[slot]);
+                m_freeFrames.push_back(slot);
+            }
+
+            m_thread = std::thread(&PlaybackCamera::Play, this);
+        }
+
+        PlaybackCamera::~PlaybackCamera()
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_stop = true;
+            }
+            m_condition.notify_all();
+            m_thread.join();
+        }
+
+        void PlaybackCamera::QueueFrame(VmbFrame_t const& frame) noexcept
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_freeFrames.push_back(reinterpret_cast<size_t>(frame.context[FrameQueueContextIndex + 1]));
+            }
+            m_condition.notify_all();
+        }
+
+        bool PlaybackCamera::WaitUntil(Clock::time_point const time)
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_condition.wait_until(lock, time, [this, time]() { return m_stop || Clock::now() >= time; });
+            return !m_stop;
+        }
+
+        bool PlaybackCamera::AcquireFrame(size_t& slot, bool const wait)
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            if (wait)
+            {
+                m_condition.wait(lock, [this]() { return m_stop || !m_freeFrames.empty(); });
+            }
+            if (m_stop || m_freeFrames.empty())
+            {
+                return false;
+            }
+            slot = m_freeFrames.back();
+            m_freeFrames.pop_back();
+            return true;
+        }
+
+        void PlaybackCamera::Play()
+        /* 回放线程：按选定的时序计算每一帧的交付时间并等待，然后把下一帧放入空闲的帧槽并调用帧回调。
+        原始时序按录制的时间戳间隔交付（时间戳频率可配置），固定帧率按固定间隔交付；
+        这两种模式下没有空闲帧槽时跳过该帧，与相机没有可用缓冲区时的行为相同。尽快模式则等待帧槽归还。
+        未压缩的帧数据直接引用映射的文件，压缩的帧解码到帧槽自己的缓冲区中；在当前帧之前 m_readAhead 帧的范围内提前通知操作系统读取，
+        因此磁盘读取在后台进行，不会阻塞帧的交付。循环回放时重新开始计时。 */
+        {
+            ASYNCHRONOUSGRAB_TRACE_THREAD_NAME("PlaybackCamera");
+
+            size_t const frameCount = m_reader.GetFrameCount();
+            size_t const readAhead = (std::max)(m_settings.m_readAhead, size_t(2));
+            std::chrono::duration<double> const frameInterval(m_settings.m_timing == Timing::FixedRate ? 1.0 / m_settings.m_frameRate : 0.0);
+
+            bool running = true;
+            while (running)
+            {
+                auto const start = Clock::now();
+                auto const firstTimestamp = m_reader.GetIndexEntry(0).m_timestamp;
+                m_reader.Prefetch(0, readAhead);
+                size_t prefetchedUntil = readAhead;
+
+                for (size_t index = 0; running && index != frameCount; ++index)
+                {
+                    if (index + readAhead / 2 >= prefetchedUntil)
+                    {
+                        m_reader.Prefetch(prefetchedUntil, readAhead);
+                        prefetchedUntil += readAhead;
+                    }
+
+                    Clock::time_point due = start;
+                    switch (m_settings.m_timing)
+                    {
+                    case Timing::Original:
+                    {
+                        auto const timestamp = m_reader.GetIndexEntry(index).m_timestamp;
+                        double const seconds = (timestamp > firstTimestamp)
+                            ? static_cast<double>(timestamp - firstTimestamp) / m_settings.m_timestampFrequency
+                            : 0.0;
+                        due += std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(seconds));
+                        break;
+                    }
+                    case Timing::FixedRate:
+                        due += std::chrono::duration_cast<Clock::duration>(frameInterval * static_cast<double>(index));
+                        break;
+                    case Timing::AsFastAsPossible:
+                        break;
+                    }
+
+                    if (m_settings.m_timing != Timing::AsFastAsPossible && !WaitUntil(due))
+                    {
+                        running = false;
+                        break;
+                    }
+
+                    size_t slot;
+                    if (!AcquireFrame(slot, m_settings.m_timing == Timing::AsFastAsPossible))
+                    {
+                        std::lock_guard<std::mutex> lock(m_mutex);
+                        running = !m_stop;
+                        if (running)
+                        {
+                            m_framesSkipped.fetch_add(1, std::memory_order_relaxed);
+                        }
+                        continue;
+                    }
+
+                    VmbFrame_t recorded;
+                    try
+                    {
+                        recorded = m_reader.GetFrame(index, m_buffers[slot]);
+                        m_metadata[slot] = m_reader.GetMetadata(index);
+                    }
+                    catch (VmbException const&)
+                    {
+                        // the index references a damaged record
+                        m_framesSkipped.fetch_add(1, std::memory_order_relaxed);
+                        QueueFrame(m_frames[slot]);
+                        continue;
+                    }
+
+                    // keep the context values of the slot
+                    auto& frame = m_frames[slot];
+                    std::memcpy(recorded.context, frame.context, sizeof(recorded.context));
+                    frame = recorded;
+
+                    m_callback(nullptr, static_cast<VmbHandle_t>(this), &frame);
+                }
+                running = running && m_settings.m_loop;
+            }
+        }
+    }
+}
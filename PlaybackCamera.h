@@ -0,0 +1,202 @@
+/**
+ * \date 2023
+ * \copyright Allied Vision Technologies.  All Rights Reserved.
+ *
+ * \copyright Redistribution of this file, in original or modified form, without
+ *            prior written consent of Allied Vision Technologies is prohibited.
+ *
+ * \warning THIS SOFTWARE IS PROVIDED BY THE AUTHOR "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF TITLE,
+ * NON-INFRINGEMENT, MERCHANTABILITY AND FITNESS FOR A PARTICULAR  PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \brief Definition of a virtual camera replaying a recording
+ */
+
+#ifndef ASYNCHRONOUSGRAB_C_PLAYBACK_CAMERA_H
+#define ASYNCHRONOUSGRAB_C_PLAYBACK_CAMERA_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <VmbC/VmbC.h>
+
+#include "FrameQueue.h"
+#include "RecordingReader.h"
+
+namespace VmbC
+{
+    namespace Examples
+    {
+        /**
+         * \brief Replays a recording written by RecordingSink through a frame
+         *        callback as if the frames were delivered by a camera.
+         *
+         * Uncompressed frames reference the memory mapped recording directly,
+         * compressed frames are restored into a buffer per slot; a fixed
+         * number of frame slots is handed out and returned via FrameQueue,
+         * like the buffers announced to a real camera. The records ahead of
+         * the current frame are prefetched so the file is read in the
+         * background.
+         */
+        class PlaybackCamera : public FrameQueue
+        {
+        public:
+            using Clock = std::chrono::steady_clock;
+
+            enum class Timing
+            {
+                /**
+                 * \brief reproduce the intervals of the recorded timestamps;
+                 *        frames are skipped, if no frame slot is available
+                 */
+                Original,
+
+                /**
+                 * \brief deliver the frames at Settings::m_frameRate; frames
+                 *        are skipped, if no frame slot is available
+                 */
+                FixedRate,
+
+                /**
+                 * \brief deliver the next frame as soon as a frame slot is
+                 *        available
+                 */
+                AsFastAsPossible,
+            };
+
+            struct Settings
+            {
+                std::string m_fileName;
+                Timing m_timing { Timing::Original };
+
+                /**
+                 * \brief the frame rate used with Timing::FixedRate
+                 */
+                double m_frameRate { 30.0 };
+
+                /**
+                 * \brief the number of timestamp ticks per second used with
+                 *        Timing::Original
+                 */
+                double m_timestampFrequency { 1e9 };
+
+                /**
+                 * \brief restart at the first frame after the last one
+                 */
+                bool m_loop { true };
+
+                /**
+                 * \brief the number of frames read ahead of the current frame
+                 */
+                size_t m_readAhead { 32 };
+            };
+
+            /**
+             * \brief map the recording and start delivering frames
+             * \param[in] callback the function receiving the frames; called
+             *                     with a null camera handle and this object
+             *                     as stream handle
+             * \param[in] context the value of VmbFrame_t::context[0] of the frames
+             * \param[in] frameCount the number of frame slots
+             * \throws VmbException, if the recording cannot be opened or is empty
+             */
+            PlaybackCamera(Settings const& settings, VmbFrameCallback callback, void* context, size_t frameCount);
+
+            /**
+             * \brief stops delivering frames; the frames delivered must not
+             *        be used after the object is destroyed
+             */
+            ~PlaybackCamera();
+
+            PlaybackCamera(PlaybackCamera const&) = delete;
+            PlaybackCamera& operator=(PlaybackCamera const&) = delete;
+
+            void QueueFrame(VmbFrame_t const& frame) noexcept override;
+
+            RecordingReader const& GetReader() const noexcept
+            {
+                return m_reader;
+            }
+
+            /**
+             * \brief the number of frames not delivered because no frame slot
+             *        was available in time
+             */
+            VmbUint64_t GetFramesSkipped() const noexcept
+            {
+                return m_framesSkipped.load(std::memory_order_relaxed);
+            }
+        private:
+            Settings const m_settings;
+            RecordingReader m_reader;
+            VmbFrameCallback const m_callback;
+
+            /**
+             * \brief the frame slots; only accessed by the playback thread
+             *        while not in m_freeFrames
+             */
+            std::vector<VmbFrame_t> m_frames;
+
+            /**
+             * \brief the buffers compressed frames of the slots are restored
+             *        into; accessed like m_frames
+             */
+            std::vector<std::vector<unsigned char>> m_buffers;
+
+            /**
+             * \brief the recorded metadata of the frames of the slots;
+             *        accessed like m_frames
+             */
+            std::vector<FrameMetadata> m_metadata;
+
+            /**
+             * \brief indices of the frame slots available; guarded by m_mutex
+             */
+            std::vector<size_t> m_freeFrames;
+
+            std::mutex m_mutex;
+
+            /**
+             * \brief notified when a frame slot is returned or the playback is stopped
+             */
+            std::condition_variable m_condition;
+
+            /**
+             * \brief guarded by m_mutex
+             */
+            bool m_stop { false };
+
+            std::atomic<VmbUint64_t> m_framesSkipped { 0 };
+            std::thread m_thread;
+
+            void Play();
+
+            /**
+             * \brief wait until a given time or the playback is stopped
+             * \return false, if the playback was stopped
+             */
+            bool WaitUntil(Clock::time_point time);
+
+            /**
+             * \brief take a free frame slot
+             * \param[in] wait if true, wait until a slot is returned
+             * \return false, if no slot is available or the playback was stopped
+             */
+            bool AcquireFrame(size_t& slot, bool wait);
+        };
+    }
+}
+
+#endif
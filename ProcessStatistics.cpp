@@ -0,0 +1,127 @@
+/**
+ * \date 2023
+ * \copyright Allied Vision Technologies.  All Rights Reserved.
+ *
+ * \copyright Redistribution of this file, in original or modified form, without
+ *            prior written consent of Allied Vision Technologies is prohibited.
+ *
+ * \warning THIS SOFTWARE IS PROVIDED BY THE AUTHOR "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF TITLE,
+ * NON-INFRINGEMENT, MERCHANTABILITY AND FITNESS FOR A PARTICULAR  PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \brief Implementation of the functions declared in ProcessStatistics.h
+ */
+
+#include "ProcessStatistics.h"
+
+#ifdef _WIN32
+#include <Windows.h>
+#include <Psapi.h>
+#else
+#include <cstdio>
+#include <ctime>
+#include <sys/resource.h>
+#include <unistd.h>
+#endif
+
+namespace VmbC
+{
+    namespace Examples
+    {
+        size_t GetResidentSetSize() noexcept
+        /* 获取当前进程占用的物理内存大小（Windows上为工作集大小），失败时返回0。 */
+        {
+#ifdef _WIN32
+            PROCESS_MEMORY_COUNTERS counters;
+            if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+            {
+                return 0;
+            }
+            return static_cast<size_t>(counters.WorkingSetSize);
+#else
+            // second value of /proc/self/statm is the resident set size in pages
+            std::FILE* file = std::fopen("/proc/self/statm", "r");
+            if (file == nullptr)
+            {
+                return 0;
+            }
+            unsigned long size = 0;
+            unsigned long resident = 0;
+            int const read = std::fscanf(file, "%lu %lu", &size, &resident);
+            std::fclose(file);
+            if (read != 2)
+            {
+                return 0;
+            }
+            return static_cast<size_t>(resident) * static_cast<size_t>(sysconf(_SC_PAGESIZE));
+#endif
+        }
+
+        std::chrono::microseconds GetProcessCpuTime() noexcept
+        /* 获取当前进程所有线程累计使用的CPU时间（用户态+内核态）。 */
+        {
+#ifdef _WIN32
+            FILETIME creationTime;
+            FILETIME exitTime;
+            FILETIME kernelTime;
+            FILETIME userTime;
+            if (!GetProcessTimes(GetCurrentProcess(), &creationTime, &exitTime, &kernelTime, &userTime))
+            {
+                return std::chrono::microseconds(0);
+            }
+            auto toTicks = [](FILETIME const& time)
+            {
+                return (static_cast<unsigned long long>(time.dwHighDateTime) << 32) | time.dwLowDateTime;
+            };
+            // FILETIME uses units of 100 ns
+            return std::chrono::microseconds((toTicks(kernelTime) + toTicks(userTime)) / 10);
+#else
+            rusage usage;
+            if (getrusage(RUSAGE_SELF, &usage) != 0)
+            {
+                return std::chrono::microseconds(0);
+            }
+            auto toMicroseconds = [](timeval const& time)
+            {
+                return static_cast<long long>(time.tv_sec) * 1000000 + time.tv_usec;
+            };
+            return std::chrono::microseconds(toMicroseconds(usage.ru_utime) + toMicroseconds(usage.ru_stime));
+#endif
+        }
+
+        std::chrono::nanoseconds GetThreadCpuTime() noexcept
+        /* 获取调用线程累计使用的CPU时间（用户态+内核态），例如用于统计转码线程的CPU时间。 */
+        {
+#ifdef _WIN32
+            FILETIME creationTime;
+            FILETIME exitTime;
+            FILETIME kernelTime;
+            FILETIME userTime;
+            if (!GetThreadTimes(GetCurrentThread(), &creationTime, &exitTime, &kernelTime, &userTime))
+            {
+                return std::chrono::nanoseconds(0);
+            }
+            auto toTicks = [](FILETIME const& time)
+            {
+                return (static_cast<unsigned long long>(time.dwHighDateTime) << 32) | time.dwLowDateTime;
+            };
+            // FILETIME uses units of 100 ns
+            return std::chrono::nanoseconds((toTicks(kernelTime) + toTicks(userTime)) * 100);
+#else
+            timespec time;
+            if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &time) != 0)
+            {
+                return std::chrono::nanoseconds(0);
+            }
+            return std::chrono::nanoseconds(static_cast<long long>(time.tv_sec) * 1000000000 + time.tv_nsec);
+#endif
+        }
+    }
+}
@@ -0,0 +1,55 @@
+/**
+ * \date 2023
+ * \copyright Allied Vision Technologies.  All Rights Reserved.
+ *
+ * \copyright Redistribution of this file, in original or modified form, without
+ *            prior written consent of Allied Vision Technologies is prohibited.
+ *
+ * \warning THIS SOFTWARE IS PROVIDED BY THE AUTHOR "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF TITLE,
+ * NON-INFRINGEMENT, MERCHANTABILITY AND FITNESS FOR A PARTICULAR  PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \brief Functions for querying resource usage of the current process
+ */
+
+#ifndef ASYNCHRONOUSGRAB_C_PROCESS_STATISTICS_H
+#define ASYNCHRONOUSGRAB_C_PROCESS_STATISTICS_H
+
+#include <chrono>
+#include <cstddef>
+
+namespace VmbC
+{
+    namespace Examples
+    {
+        /**
+         * \brief get the size of the memory of the current process currently
+         *        held in RAM (working set on Windows)
+         * \return the size in bytes or 0, if the size could not be determined
+         */
+        size_t GetResidentSetSize() noexcept;
+
+        /**
+         * \brief get the cpu time (user + kernel) used by all threads of the
+         *        current process so far
+         */
+        std::chrono::microseconds GetProcessCpuTime() noexcept;
+
+        /**
+         * \brief get the cpu time (user + kernel) used by the calling thread so far
+         * 
+         * On Windows the value is only updated with every scheduler tick, so
+         * only sums over many short intervals are meaningful.
+         */
+        std::chrono::nanoseconds GetThreadCpuTime() noexcept;
+    }
+}
+
+#endif
@@ -0,0 +1,78 @@
+/**
+ * \date 2023
+ * \copyright Allied Vision Technologies.  All Rights Reserved.
+ *
+ * \copyright Redistribution of this file, in original or modified form, without
+ *            prior written consent of Allied Vision Technologies is prohibited.
+ *
+ * \warning THIS SOFTWARE IS PROVIDED BY THE AUTHOR "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF TITLE,
+ * NON-INFRINGEMENT, MERCHANTABILITY AND FITNESS FOR A PARTICULAR  PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \brief Layout of the frames written to a pipe by RawPipeSink
+ */
+
+#ifndef ASYNCHRONOUSGRAB_C_RAW_PIPE_FORMAT_H
+#define ASYNCHRONOUSGRAB_C_RAW_PIPE_FORMAT_H
+
+#include <VmbC/VmbC.h>
+
+namespace VmbC
+{
+    namespace Examples
+    {
+        /**
+         * \brief Layout of the data written by RawPipeSink with
+         *        RawPipeSink::Format::Framed.
+         *
+         * Every frame is a FrameHeader immediately followed by
+         * FrameHeader::m_imageSize bytes of image data without padding
+         * between the lines; there is no header for the stream, so a reader
+         * may start with any frame. Chunk data is not included. All values
+         * are stored in the byte order of the writing system.
+         *
+         * With RawPipeSink::Format::RawVideo only the image data is written,
+         * e.g. for `ffmpeg -f rawvideo`.
+         */
+        namespace RawPipeFormat
+        {
+            /**
+             * \brief magic value of a FrameHeader; "VFRM"
+             */
+            constexpr VmbUint32_t FrameMagic = 0x4D524656;
+
+            struct FrameHeader
+            {
+                VmbUint32_t m_magic;
+
+                /**
+                 * \brief the size of the FrameHeader; newer versions may
+                 *        append members
+                 */
+                VmbUint32_t m_headerSize;
+                VmbUint64_t m_frameId;
+                VmbUint64_t m_timestamp;
+                VmbUint32_t m_pixelFormat;
+                VmbUint32_t m_width;
+                VmbUint32_t m_height;
+                VmbUint32_t m_imageSize;
+
+                /**
+                 * \brief the number of frames the sink dropped since the
+                 *        previous frame written
+                 */
+                VmbUint32_t m_framesDropped;
+                VmbUint32_t m_reserved;
+            };
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,645 @@
+/**
+ * \date 2023
+ * \copyright Allied Vision Technologies.  All Rights Reserved.
+ *
+ * \copyright Redistribution of this file, in original or modified form, without
+ *            prior written consent of Allied Vision Technologies is prohibited.
+ *
+ * \warning THIS SOFTWARE IS PROVIDED BY THE AUTHOR "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF TITLE,
+ * NON-INFRINGEMENT, MERCHANTABILITY AND FITNESS FOR A PARTICULAR  PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \brief Implementation of ::VmbC::Examples::RawPipeSink
+ */
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <new>
+
+#include "FrameCopy.h"
+#include "RawPipeSink.h"
+#include "Tracing.h"
+#include "VmbException.h"
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <csignal>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sys/ioctl.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+namespace VmbC
+{
+    namespace Examples
+    {
+        namespace
+        {
+            /**
+             * \brief interval for checking, if the sink should stop or a
+             *        reader opened the named pipe
+             */
+            constexpr std::chrono::milliseconds StopCheckInterval { 100 };
+
+            /**
+             * \brief interval for checking, if the reader consumed the
+             *        spliced slots
+             */
+            constexpr std::chrono::milliseconds SpliceCheckInterval { 1 };
+
+            /**
+             * \brief the time the reader may take to consume the spliced
+             *        slots before the sink is destroyed
+             */
+            constexpr std::chrono::milliseconds DrainTimeout { 1000 };
+
+            /**
+             * \brief the pipe size requested, so a frame needs fewer writes
+             */
+            constexpr int PipeSize = 1 << 20;
+
+            bool IsStandardOutput(std::string const& path) noexcept
+            {
+                return path == "-";
+            }
+
+            /**
+             * \brief the size of the image data of a frame without chunk data
+             */
+            size_t GetImageSize(VmbFrame_t const& frame) noexcept
+            {
+                // bits 16 to 23 of the pixel format hold the bits per pixel
+                size_t const bitsPerPixel = (frame.pixelFormat >> 16) & 0xFF;
+                return (bitsPerPixel * frame.width * frame.height + 7) / 8;
+            }
+        }
+
+        RawPipeSink::RawPipeSink(Settings const& settings)
+            : m_settings(settings),
+            m_slots(settings.m_slotCount)
+        /* 命名管道不存在时创建它，并在析构时删除；打开管道要等到读取者出现，因此在写线程中进行，不阻塞调用者。 */
+        {
+            if (settings.m_path.empty() || settings.m_slotCount == 0)
+            {
+                throw VmbException("the path and the slot count of the pipe need to be set", VmbErrorBadParameter);
+            }
+#ifndef _WIN32
+            if (!IsStandardOutput(settings.m_path))
+            {
+                struct stat info;
+                if (stat(settings.m_path.c_str(), &info) != 0)
+                {
+                    if (mkfifo(settings.m_path.c_str(), 0644) != 0)
+                    {
+                        throw VmbException("unable to create the named pipe " + settings.m_path + ": " + std::strerror(errno));
+                    }
+                    m_pipeCreated = true;
+                }
+                else if (!S_ISFIFO(info.st_mode))
+                {
+                    throw VmbException(settings.m_path + " is no named pipe", VmbErrorBadParameter);
+                }
+            }
+#endif
+
+            m_freeSlots.reserve(settings.m_slotCount);
+            for (size_t slot = settings.m_slotCount; slot != 0; --slot)
+            {
+                m_freeSlots.push_back(slot - 1);
+            }
+            m_thread = std::thread(&RawPipeSink::WriteFrames, this);
+        }
+
+        RawPipeSink::~RawPipeSink()
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_stop = true;
+            }
+            m_queueCondition.notify_all();
+            m_slotCondition.notify_all();
+            m_thread.join();
+#ifndef _WIN32
+            if (m_pipeCreated)
+            {
+                unlink(m_settings.m_path.c_str());
+            }
+#endif
+        }
+
+        void RawPipeSink::FrameReceived(VmbFrame_t const& frame)
+        /* 在VmbC回调线程中调用：只复制图像数据（不含块数据）到空闲槽，转换和写入都在写线程中进行。
+        没有空闲槽时按 m_fullPolicy 丢弃该帧或等待写线程释放槽；没有读取者时总是丢弃。 */
+        {
+            ++m_framesReceived;
+            size_t index;
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                if (m_freeSlots.empty() && m_settings.m_fullPolicy == FullPolicy::Block && m_readerConnected && !m_stop)
+                {
+                    ASYNCHRONOUSGRAB_TRACE_SCOPE("WaitForPipeSlot", frame.frameID);
+                    auto const start = Clock::now();
+                    m_slotCondition.wait(lock, [this]()
+                                         {
+                                             return !m_freeSlots.empty() || !m_readerConnected || m_stop;
+                                         });
+                    m_blockedTime += (Clock::now() - start).count();
+                }
+                if (m_freeSlots.empty() || !m_readerConnected || m_stop)
+                {
+                    ++m_framesDropped;
+                    ++m_framesDroppedSinceQueued;
+                    return;
+                }
+                index = m_freeSlots.back();
+                m_freeSlots.pop_back();
+            }
+
+            Slot& slot = m_slots[index];
+            auto const buffer = static_cast<VmbUint8_t const*>(frame.buffer);
+            size_t const imageOffset = (frame.imageData == nullptr) ? 0 : static_cast<size_t>(frame.imageData - buffer);
+            size_t const size = (std::min)(GetImageSize(frame), size_t(frame.bufferSize) - (std::min)(imageOffset, size_t(frame.bufferSize)));
+            bool const copied = CopyToSlot(slot.m_buffer, buffer + imageOffset, size);
+            slot.m_frame = frame;
+            slot.m_frame.buffer = slot.m_buffer.GetData();
+            slot.m_frame.bufferSize = static_cast<VmbUint32_t>(size);
+            slot.m_frame.imageData = slot.m_buffer.GetData();
+            std::fill(std::begin(slot.m_frame.context), std::end(slot.m_frame.context), nullptr);
+
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                if (!copied)
+                {
+                    ++m_framesDropped;
+                    ++m_framesDroppedSinceQueued;
+                    m_freeSlots.push_back(index);
+                    return;
+                }
+                slot.m_framesDropped = m_framesDroppedSinceQueued;
+                m_framesDroppedSinceQueued = 0;
+                m_queuedSlots.push_back(index);
+            }
+            m_queueCondition.notify_one();
+        }
+
+        RawPipeSink::Statistics RawPipeSink::GetStatistics() const
+        {
+            Statistics statistics;
+            statistics.m_framesReceived = m_framesReceived.load(std::memory_order_relaxed);
+            statistics.m_framesWritten = m_framesWritten.load(std::memory_order_relaxed);
+            statistics.m_framesDropped = m_framesDropped.load(std::memory_order_relaxed);
+            statistics.m_framesSkipped = m_framesSkipped.load(std::memory_order_relaxed);
+            statistics.m_bytesWritten = m_bytesWritten.load(std::memory_order_relaxed);
+            statistics.m_blockedTime = Clock::duration(m_blockedTime.load(std::memory_order_relaxed));
+            statistics.m_vmsplice = m_vmsplice;
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+            statistics.m_readerConnected = m_readerConnected;
+            statistics.m_pixelFormat = m_pixelFormat;
+            statistics.m_width = m_width;
+            statistics.m_height = m_height;
+            statistics.m_error = m_error;
+            return statistics;
+        }
+
+        void RawPipeSink::WriteFrames()
+        /* 写线程：没有读取者时以 StopCheckInterval 为间隔尝试打开输出。每帧用一次 writev 写入帧头和图像；
+        vmsplice 只把槽的页面放入管道，槽要等读取者读完（管道中剩余的字节数不再覆盖它）才能重用，
+        因此有拼接中的槽时以 SpliceCheckInterval 检查。命名管道的读取者断开时关闭管道并等待下一个读取者；
+        标准输出被关闭或出现其他错误时停止写入，之后的帧都被丢弃。 */
+        {
+            ASYNCHRONOUSGRAB_TRACE_THREAD_NAME("RawPipe writer");
+#ifndef _WIN32
+            // a write to a pipe without reader raises SIGPIPE for this thread; it is taken from the pending signals below
+            sigset_t pipeSignal;
+            sigemptyset(&pipeSignal);
+            sigaddset(&pipeSignal, SIGPIPE);
+            pthread_sigmask(SIG_BLOCK, &pipeSignal, nullptr);
+#endif
+
+            std::deque<SplicedSlot> spliced;
+            VmbUint64_t position = 0;
+
+            // frames skipped by this thread since the last frame written
+            VmbUint32_t framesSkipped = 0;
+            while (!m_stop)
+            {
+                if (!m_readerConnected)
+                {
+                    if (!Open())
+                    {
+                        std::unique_lock<std::mutex> lock(m_mutex);
+                        if (!m_error.empty())
+                        {
+                            break;
+                        }
+                        m_queueCondition.wait_for(lock, StopCheckInterval, [this]() { return m_stop.load(); });
+                        continue;
+                    }
+                    position = 0;
+                }
+
+                ReleaseConsumed(spliced, position);
+                size_t index;
+                {
+                    std::unique_lock<std::mutex> lock(m_mutex);
+                    m_queueCondition.wait_for(lock, spliced.empty() ? StopCheckInterval : SpliceCheckInterval, [this]()
+                                              {
+                                                  return m_stop || !m_queuedSlots.empty();
+                                              });
+                    if (m_stop || m_queuedSlots.empty())
+                    {
+                        continue;
+                    }
+                    index = m_queuedSlots.front();
+                    m_queuedSlots.pop_front();
+                }
+
+                Slot& slot = m_slots[index];
+                unsigned char const* data;
+                size_t size;
+                if (!Prepare(slot, data, size))
+                {
+                    ++m_framesSkipped;
+                    ++framesSkipped;
+                    FreeSlot(index);
+                    continue;
+                }
+                slot.m_header.m_framesDropped = slot.m_framesDropped + framesSkipped;
+
+                bool const framed = (m_settings.m_format == Format::Framed);
+                size_t const headerSize = framed ? sizeof(slot.m_header) : 0;
+                bool const splice = m_vmsplice;
+                bool written;
+                {
+                    ASYNCHRONOUSGRAB_TRACE_SCOPE("WritePipeFrame", slot.m_frame.frameID);
+                    written = WriteAll(&slot.m_header, headerSize, data, size, splice);
+                }
+                if (written)
+                {
+                    position += headerSize + size;
+                    ++m_framesWritten;
+                    framesSkipped = 0;
+                    if (splice)
+                    {
+                        spliced.push_back(SplicedSlot { index, position });
+                    }
+                    else
+                    {
+                        FreeSlot(index);
+                    }
+                    continue;
+                }
+
+                if (m_stop)
+                {
+                    break;
+                }
+                int const writeError = errno;
+                // closing the pipe without reader discards the spliced pages
+                Close();
+                ++m_framesDropped;
+                FreeSlot(index);
+                for (auto const& entry : spliced)
+                {
+                    FreeSlot(entry.m_slot);
+                }
+                spliced.clear();
+                bool failed;
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    m_readerConnected = false;
+                    // a named pipe is opened again for the next reader
+                    failed = IsStandardOutput(m_settings.m_path) || writeError != EPIPE;
+                    if (failed)
+                    {
+                        m_error = std::string("writing to ") + (IsStandardOutput(m_settings.m_path) ? "the standard output" : m_settings.m_path)
+                            + " failed: " + std::strerror(writeError);
+                        m_framesDropped += m_queuedSlots.size();
+                        m_freeSlots.insert(m_freeSlots.end(), m_queuedSlots.begin(), m_queuedSlots.end());
+                        m_queuedSlots.clear();
+                    }
+                }
+                m_slotCondition.notify_all();
+                if (failed)
+                {
+                    break;
+                }
+            }
+
+#ifndef _WIN32
+            // the memory of the slots needs to stay untouched until the reader consumed the spliced pages
+            auto const drainDeadline = Clock::now() + DrainTimeout;
+            int pending = 0;
+            while (m_vmsplice && Clock::now() < drainDeadline && ioctl(m_file, FIONREAD, &pending) == 0 && pending != 0)
+            {
+                std::this_thread::sleep_for(SpliceCheckInterval);
+            }
+#endif
+            Close();
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_readerConnected = false;
+            }
+            m_slotCondition.notify_all();
+        }
+
+        bool RawPipeSink::Open()
+        /* 命名管道以非阻塞方式打开，没有读取者时返回失败（ENXIO）。标准输出是管道时也设为非阻塞，
+        这样写线程在读取者很慢时仍能及时响应停止；其他类型的标准输出（文件、终端）保持阻塞写入。
+        只有输出是管道并且能查询管道中剩余的字节数（FIONREAD）时才使用 vmsplice。 */
+        {
+            bool pipe = false;
+#ifdef _WIN32
+            if (IsStandardOutput(m_settings.m_path))
+            {
+                m_file = GetStdHandle(STD_OUTPUT_HANDLE);
+                if (m_file == nullptr || m_file == INVALID_HANDLE_VALUE)
+                {
+                    m_file = nullptr;
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    m_error = "no standard output";
+                    return false;
+                }
+            }
+            else
+            {
+                HANDLE const file = CreateFileA(m_settings.m_path.c_str(), GENERIC_WRITE, 0, nullptr, OPEN_EXISTING, 0, nullptr);
+                if (file == INVALID_HANDLE_VALUE)
+                {
+                    return false;
+                }
+                m_file = file;
+            }
+#else
+            if (IsStandardOutput(m_settings.m_path))
+            {
+                m_file = STDOUT_FILENO;
+                struct stat info;
+                if (fstat(m_file, &info) == 0 && S_ISFIFO(info.st_mode))
+                {
+                    m_stdoutFlags = fcntl(m_file, F_GETFL);
+                    if (m_stdoutFlags != -1)
+                    {
+                        fcntl(m_file, F_SETFL, m_stdoutFlags | O_NONBLOCK);
+                    }
+                    pipe = true;
+                }
+            }
+            else
+            {
+                int const file = open(m_settings.m_path.c_str(), O_WRONLY | O_NONBLOCK | O_CLOEXEC);
+                if (file < 0)
+                {
+                    if (errno != ENXIO)
+                    {
+                        std::lock_guard<std::mutex> lock(m_mutex);
+                        m_error = "unable to open " + m_settings.m_path + ": " + std::strerror(errno);
+                    }
+                    return false;
+                }
+                m_file = file;
+                pipe = true;
+            }
+            if (pipe)
+            {
+#ifdef F_SETPIPE_SZ
+                fcntl(m_file, F_SETPIPE_SZ, PipeSize);
+#endif
+                int pending = 0;
+                pipe = (ioctl(m_file, FIONREAD, &pending) == 0);
+            }
+#endif
+            m_vmsplice = m_settings.m_vmsplice && pipe;
+
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_readerConnected = true;
+            }
+            return true;
+        }
+
+        void RawPipeSink::Close() noexcept
+        {
+#ifdef _WIN32
+            if (m_file != nullptr && !IsStandardOutput(m_settings.m_path))
+            {
+                CloseHandle(m_file);
+            }
+            m_file = nullptr;
+#else
+            if (m_file == STDOUT_FILENO)
+            {
+                if (m_stdoutFlags != -1)
+                {
+                    fcntl(m_file, F_SETFL, m_stdoutFlags);
+                    m_stdoutFlags = -1;
+                }
+            }
+            else if (m_file >= 0)
+            {
+                close(m_file);
+            }
+            m_file = -1;
+#endif
+            m_vmsplice = false;
+        }
+
+        bool RawPipeSink::Prepare(Slot& slot, unsigned char const*& data, size_t& size)
+        /* 请求的像素格式与帧相同时直接写入槽中的数据；否则转换到槽自己的目标图像，
+        这样拼接到管道中的转换结果在读取者读完之前也不会被下一帧覆盖。
+        RawVideo格式没有帧头，读取者只知道第一帧的尺寸，所以尺寸或像素格式不同的帧被跳过。 */
+        {
+            VmbFrame_t const& frame = slot.m_frame;
+            VmbPixelFormat_t pixelFormat = frame.pixelFormat;
+            if (m_settings.m_pixelFormat == VmbPixelFormatLast || m_settings.m_pixelFormat == frame.pixelFormat)
+            {
+                data = slot.m_buffer.GetData();
+                size = frame.bufferSize;
+            }
+            else
+            {
+                try
+                {
+                    if (!slot.m_converted)
+                    {
+                        slot.m_converted.reset(new Image(m_settings.m_pixelFormat));
+                    }
+                    Image const source(frame);
+                    slot.m_converted->Convert(source);
+                }
+                catch (VmbException const&)
+                {
+                    return false;
+                }
+                catch (std::bad_alloc const&)
+                {
+                    return false;
+                }
+                data = slot.m_converted->GetData();
+                size = static_cast<size_t>(slot.m_converted->GetBytesPerLine()) * static_cast<size_t>(slot.m_converted->GetHeight());
+                pixelFormat = m_settings.m_pixelFormat;
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                if (m_settings.m_format == Format::RawVideo && m_width != 0
+                    && (m_width != frame.width || m_height != frame.height || m_pixelFormat != pixelFormat))
+                {
+                    return false;
+                }
+                m_pixelFormat = pixelFormat;
+                m_width = frame.width;
+                m_height = frame.height;
+            }
+
+            auto& header = slot.m_header;
+            header.m_magic = RawPipeFormat::FrameMagic;
+            header.m_headerSize = sizeof(header);
+            header.m_frameId = frame.frameID;
+            header.m_timestamp = frame.timestamp;
+            header.m_pixelFormat = pixelFormat;
+            header.m_width = frame.width;
+            header.m_height = frame.height;
+            header.m_imageSize = static_cast<VmbUint32_t>(size);
+            header.m_framesDropped = 0;
+            header.m_reserved = 0;
+            return true;
+        }
+
+        bool RawPipeSink::WriteAll(void const* const header, size_t const headerSize, void const* const data, size_t const size, bool const splice)
+        /* 帧头和图像作为两个iovec一起写入，读取者通常一次读到完整的帧。管道满时写入返回 EAGAIN，
+        等待管道可写，期间检查是否应停止。 */
+        {
+#ifdef _WIN32
+            (void) splice;
+            for (auto const& part : { std::make_pair(header, headerSize), std::make_pair(data, size) })
+            {
+                auto pos = static_cast<char const*>(part.first);
+                for (size_t remaining = part.second; remaining != 0;)
+                {
+                    DWORD written = 0;
+                    DWORD const chunk = static_cast<DWORD>((std::min)(remaining, size_t(1) << 30));
+                    if (!WriteFile(m_file, pos, chunk, &written, nullptr) || written == 0)
+                    {
+                        errno = EPIPE;
+                        return false;
+                    }
+                    pos += written;
+                    remaining -= written;
+                    m_bytesWritten += written;
+                }
+            }
+            return true;
+#else
+            iovec vectors[2];
+            int count = 0;
+            if (headerSize != 0)
+            {
+                vectors[count++] = iovec { const_cast<void*>(header), headerSize };
+            }
+            if (size != 0)
+            {
+                vectors[count++] = iovec { const_cast<void*>(data), size };
+            }
+
+            iovec* pos = vectors;
+            while (count != 0)
+            {
+                ssize_t const written = splice
+                    ? vmsplice(m_file, pos, static_cast<unsigned long>(count), SPLICE_F_NONBLOCK)
+                    : writev(m_file, pos, count);
+                if (written < 0)
+                {
+                    if (errno == EINTR)
+                    {
+                        continue;
+                    }
+                    if (errno == EAGAIN)
+                    {
+                        pollfd descriptor { m_file, POLLOUT, 0 };
+                        poll(&descriptor, 1, static_cast<int>(StopCheckInterval.count()));
+                        if (m_stop)
+                        {
+                            return false;
+                        }
+                        continue;
+                    }
+                    if (errno == EPIPE)
+                    {
+                        // take the SIGPIPE raised by the write, which is blocked for this thread
+                        sigset_t pipeSignal;
+                        sigemptyset(&pipeSignal);
+                        sigaddset(&pipeSignal, SIGPIPE);
+                        timespec const noWait {};
+                        sigtimedwait(&pipeSignal, nullptr, &noWait);
+                        errno = EPIPE;
+                    }
+                    return false;
+                }
+
+                m_bytesWritten += static_cast<VmbUint64_t>(written);
+                size_t remaining = static_cast<size_t>(written);
+                while (count != 0 && remaining >= pos->iov_len)
+                {
+                    remaining -= pos->iov_len;
+                    ++pos;
+                    --count;
+                }
+                if (count != 0)
+                {
+                    pos->iov_base = static_cast<char*>(pos->iov_base) + remaining;
+                    pos->iov_len -= remaining;
+                }
+            }
+            return true;
+#endif
+        }
+
+        void RawPipeSink::ReleaseConsumed(std::deque<SplicedSlot>& spliced, VmbUint64_t const position)
+        {
+#ifndef _WIN32
+            if (spliced.empty())
+            {
+                return;
+            }
+            int pending = 0;
+            if (ioctl(m_file, FIONREAD, &pending) != 0)
+            {
+                return;
+            }
+            VmbUint64_t const consumed = position - static_cast<VmbUint64_t>(pending);
+            while (!spliced.empty() && spliced.front().m_end <= consumed)
+            {
+                FreeSlot(spliced.front().m_slot);
+                spliced.pop_front();
+            }
+#else
+            (void) spliced;
+            (void) position;
+#endif
+        }
+
+        void RawPipeSink::FreeSlot(size_t const slot)
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_freeSlots.push_back(slot);
+            }
+            m_slotCondition.notify_one();
+        }
+    }
+}
@@ -0,0 +1,334 @@
+/**
+ * \date 2023
+ * \copyright Allied Vision Technologies.  All Rights Reserved.
+ *
+ * \copyright Redistribution of this file, in original or modified form, without
+ *            prior written consent of Allied Vision Technologies is prohibited.
+ *
+ * \warning THIS SOFTWARE IS PROVIDED BY THE AUTHOR "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF TITLE,
+ * NON-INFRINGEMENT, MERCHANTABILITY AND FITNESS FOR A PARTICULAR  PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \brief Definition of a sink writing the raw frames to a pipe
+ */
+
+#ifndef ASYNCHRONOUSGRAB_C_RAW_PIPE_SINK_H
+#define ASYNCHRONOUSGRAB_C_RAW_PIPE_SINK_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <VmbC/VmbC.h>
+
+#include "AlignedBuffer.h"
+#include "FrameSink.h"
+#include "Image.h"
+#include "RawPipeFormat.h"
+
+namespace VmbC
+{
+    namespace Examples
+    {
+        /**
+         * \brief Writes the image data of the raw frames to the standard
+         *        output or a named pipe, e.g. for ffmpeg or other programs
+         *        reading from a pipe.
+         *
+         * FrameReceived copies the image data into a free slot of a fixed
+         * pool; a writer thread converts it to m_pixelFormat with
+         * Image::Convert, if requested, and writes the header and the image
+         * with a single writev call. If the output is a pipe on Linux, the
+         * pages of the slot are spliced into the pipe with vmsplice instead
+         * of copied; the slot is reused after the reader consumed them.
+         *
+         * If no slot is free, because the reader is slower than the camera,
+         * the frame is dropped (FullPolicy::Drop) or the VmbC callback
+         * thread waits for a slot (FullPolicy::Block), which makes the
+         * camera lose frames instead. While no reader is connected to a
+         * named pipe, the frames are dropped in both cases; a reader
+         * disconnecting from a named pipe is replaced by the next one
+         * opening it.
+         */
+        class RawPipeSink : public RawFrameSink
+        {
+        public:
+            using Clock = std::chrono::steady_clock;
+
+            enum class Format
+            {
+                /**
+                 * \brief the image data only; all frames need the size of
+                 *        the first one, frames of a different size are
+                 *        skipped
+                 */
+                RawVideo,
+
+                /**
+                 * \brief a RawPipeFormat::FrameHeader before the image data
+                 *        of every frame
+                 */
+                Framed
+            };
+
+            enum class FullPolicy
+            {
+                Drop,
+                Block
+            };
+
+            struct Settings
+            {
+                /**
+                 * \brief "-" for the standard output, otherwise the path of
+                 *        a named pipe, which is created, if it does not
+                 *        exist; on Windows a pipe like \\.\pipe\name created
+                 *        by the reader
+                 */
+                std::string m_path;
+                Format m_format { Format::Framed };
+
+                /**
+                 * \brief the pixel format written; VmbPixelFormatLast writes
+                 *        the frames unconverted
+                 */
+                VmbPixelFormat_t m_pixelFormat { VmbPixelFormatLast };
+                FullPolicy m_fullPolicy { FullPolicy::Drop };
+                size_t m_slotCount { 8 };
+
+                /**
+                 * \brief splice the slots into pipes instead of copying them
+                 */
+                bool m_vmsplice { true };
+            };
+
+            struct Statistics
+            {
+                VmbUint64_t m_framesReceived { 0 };
+                VmbUint64_t m_framesWritten { 0 };
+
+                /**
+                 * \brief frames not written, because no slot was free or no
+                 *        reader was connected
+                 */
+                VmbUint64_t m_framesDropped { 0 };
+
+                /**
+                 * \brief frames not written, because the conversion failed
+                 *        or their size differed from the first one written
+                 *        as RawVideo
+                 */
+                VmbUint64_t m_framesSkipped { 0 };
+                VmbUint64_t m_bytesWritten { 0 };
+
+                /**
+                 * \brief the total time FrameReceived waited for a free slot
+                 */
+                Clock::duration m_blockedTime {};
+
+                bool m_readerConnected { false };
+
+                /**
+                 * \brief true, while the slots are spliced into the pipe
+                 */
+                bool m_vmsplice { false };
+
+                /**
+                 * \brief the format of the last frame written, e.g. for the
+                 *        arguments of a rawvideo reader; 0, if no frame was
+                 *        written yet
+                 */
+                ///@{
+                VmbPixelFormat_t m_pixelFormat { 0 };
+                VmbUint32_t m_width { 0 };
+                VmbUint32_t m_height { 0 };
+                ///@}
+
+                /**
+                 * \brief the reason writing stopped; empty, if no error occurred
+                 */
+                std::string m_error;
+            };
+
+            /**
+             * \brief create the named pipe, if necessary, and start the
+             *        writer thread, which waits for a reader
+             * \throws VmbException, if the settings are invalid or the
+             *                      named pipe cannot be created
+             */
+            RawPipeSink(Settings const& settings);
+
+            /**
+             * \brief stops writing; frames not written yet are discarded
+             */
+            ~RawPipeSink();
+
+            RawPipeSink(RawPipeSink const&) = delete;
+            RawPipeSink& operator=(RawPipeSink const&) = delete;
+
+            void FrameReceived(VmbFrame_t const& frame) override;
+
+            Statistics GetStatistics() const;
+        private:
+            struct Slot
+            {
+                AlignedBuffer m_buffer;
+
+                /**
+                 * \brief the frame with buffer and imageData pointing to
+                 *        m_buffer holding the image data only
+                 */
+                VmbFrame_t m_frame {};
+
+                /**
+                 * \brief the target of the conversion; created on first use
+                 */
+                std::unique_ptr<Image> m_converted;
+                RawPipeFormat::FrameHeader m_header {};
+
+                /**
+                 * \brief frames dropped before this one was queued
+                 */
+                VmbUint32_t m_framesDropped { 0 };
+            };
+
+            /**
+             * \brief a slot spliced into the pipe; only accessed by the
+             *        writer thread
+             */
+            struct SplicedSlot
+            {
+                size_t m_slot;
+
+                /**
+                 * \brief the output position after the last byte of the slot
+                 */
+                VmbUint64_t m_end;
+            };
+
+            Settings const m_settings;
+
+            std::vector<Slot> m_slots;
+
+            mutable std::mutex m_mutex;
+
+            /**
+             * \brief notified when frames are queued or m_stop is set
+             */
+            std::condition_variable m_queueCondition;
+
+            /**
+             * \brief notified when slots are freed, the reader disconnected
+             *        or m_stop is set
+             */
+            std::condition_variable m_slotCondition;
+
+            /**
+             * \name State guarded by m_mutex
+             */
+            ///@{
+            std::vector<size_t> m_freeSlots;
+            std::deque<size_t> m_queuedSlots;
+
+            /**
+             * \brief frames dropped since the last frame queued
+             */
+            VmbUint32_t m_framesDroppedSinceQueued { 0 };
+            VmbPixelFormat_t m_pixelFormat { 0 };
+            VmbUint32_t m_width { 0 };
+            VmbUint32_t m_height { 0 };
+            std::string m_error;
+            ///@}
+
+            std::atomic<bool> m_stop { false };
+            std::atomic<bool> m_readerConnected { false };
+            std::atomic<bool> m_vmsplice { false };
+            std::atomic<VmbUint64_t> m_framesReceived { 0 };
+            std::atomic<VmbUint64_t> m_framesWritten { 0 };
+            std::atomic<VmbUint64_t> m_framesDropped { 0 };
+            std::atomic<VmbUint64_t> m_framesSkipped { 0 };
+            std::atomic<VmbUint64_t> m_bytesWritten { 0 };
+            std::atomic<Clock::rep> m_blockedTime { 0 };
+
+            /**
+             * \brief true, if the named pipe was created by the sink and is
+             *        removed by the destructor
+             */
+            bool m_pipeCreated { false };
+
+            /**
+             * \brief the output; only accessed by the writer thread
+             */
+#ifdef _WIN32
+            void* m_file { nullptr };
+#else
+            int m_file { -1 };
+
+            /**
+             * \brief the file status flags of the standard output before
+             *        O_NONBLOCK was set
+             */
+            int m_stdoutFlags { -1 };
+#endif
+
+            std::thread m_thread;
+
+            /**
+             * \brief open the output and write the queued frames until m_stop
+             *        is set
+             */
+            void WriteFrames();
+
+            /**
+             * \brief open the output; for named pipes fails until a reader
+             *        opened the pipe
+             */
+            bool Open();
+
+            void Close() noexcept;
+
+            /**
+             * \brief convert the frame of a slot, if requested, and describe
+             *        the image data to write
+             * \return false, if the frame is skipped
+             */
+            bool Prepare(Slot& slot, unsigned char const*& data, size_t& size);
+
+            /**
+             * \brief write data completely
+             * \param[in] splice splice the data into the pipe instead of
+             *                   copying it
+             * \return false, if the reader disconnected or an error occurred
+             */
+            bool WriteAll(void const* header, size_t headerSize, void const* data, size_t size, bool splice);
+
+            /**
+             * \brief free the spliced slots whose data the reader consumed
+             * \param[in] position the output position after the last byte
+             *                     written
+             */
+            void ReleaseConsumed(std::deque<SplicedSlot>& spliced, VmbUint64_t position);
+
+            /**
+             * \brief return a slot to the pool and wake FrameReceived
+             */
+            void FreeSlot(size_t slot);
+        };
+    }
+}
+
+#endif
@@ -0,0 +1,299 @@
+/**
+ * \date 2023
+ * \copyright Allied Vision Technologies.  All Rights Reserved.
+ *
+ * \copyright Redistribution of this file, in original or modified form, without
+ *            prior written consent of Allied Vision Technologies is prohibited.
+ *
+ * \warning THIS SOFTWARE IS PROVIDED BY THE AUTHOR "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF TITLE,
+ * NON-INFRINGEMENT, MERCHANTABILITY AND FITNESS FOR A PARTICULAR  PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \brief Implementation of ::VmbC::Examples::RecordingBrowser
+ */
+
+#include <algorithm>
+#include <new>
+
+#include "ImageTranscoder.h"
+#include "RecordingBrowser.h"
+#include "Tracing.h"
+#include "VmbException.h"
+
+namespace VmbC
+{
+    namespace Examples
+    {
+        RecordingBrowser::RecordingBrowser(Settings const& settings, Renderer& renderer)
+            : m_reader(settings.m_fileName),
+            m_renderer(renderer),
+            m_prefetchRadius((std::max)(settings.m_prefetchRadius, size_t(4))),
+            m_memoryBudget(settings.m_memoryBudget),
+            m_converted(ImageTranscoder::GetTargetPixelFormat())
+        {
+            if (m_reader.GetFrameCount() == 0)
+            {
+                throw VmbException(settings.m_fileName + " does not contain any frames");
+            }
+            m_thread = std::thread(&RecordingBrowser::PrefetchLoop, this);
+        }
+
+        RecordingBrowser::~RecordingBrowser()
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_stop = true;
+            }
+            m_condition.notify_all();
+            m_thread.join();
+        }
+
+        std::shared_ptr<RecordingBrowser::RenderedFrame const> RecordingBrowser::Seek(size_t const index, int const direction)
+        /* 移动光标并唤醒后台线程，后台线程随后首先渲染光标处的帧，再按移动方向预取周围的帧。
+        如果光标处的帧已在缓存中，则直接返回并标记为最近使用；否则返回空指针，渲染完成后通过 Renderer::CursorFrameReady 通知。 */
+        {
+            std::shared_ptr<RenderedFrame const> result;
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_cursor = (std::min)(index, m_reader.GetFrameCount() - 1);
+                if (direction != 0)
+                {
+                    m_direction = (direction < 0) ? -1 : 1;
+                }
+                ++m_requestCount;
+
+                auto const pos = m_cache.find(m_cursor);
+                if (pos == m_cache.end())
+                {
+                    ++m_statistics.m_cacheMisses;
+                }
+                else
+                {
+                    ++m_statistics.m_cacheHits;
+                    m_lru.splice(m_lru.begin(), m_lru, pos->second);
+                    result = pos->second->m_frame;
+                }
+            }
+            m_condition.notify_all();
+            return result;
+        }
+
+        std::shared_ptr<RecordingBrowser::RenderedFrame const> RecordingBrowser::GetCachedFrame(size_t const index)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            auto const pos = m_cache.find(index);
+            if (pos == m_cache.end())
+            {
+                return nullptr;
+            }
+            m_lru.splice(m_lru.begin(), m_lru, pos->second);
+            return pos->second->m_frame;
+        }
+
+        void RecordingBrowser::Invalidate()
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_lru.clear();
+                m_cache.clear();
+                m_cachedBytes = 0;
+                ++m_generation;
+                ++m_requestCount;
+            }
+            m_condition.notify_all();
+        }
+
+        void RecordingBrowser::SetMemoryBudget(size_t const memoryBudget)
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_memoryBudget = memoryBudget;
+                EvictFrames();
+                ++m_requestCount;
+            }
+            m_condition.notify_all();
+        }
+
+        RecordingBrowser::Statistics RecordingBrowser::GetStatistics() const
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            Statistics result = m_statistics;
+            result.m_cachedFrames = m_lru.size();
+            result.m_cachedBytes = m_cachedBytes;
+            result.m_memoryBudget = m_memoryBudget;
+            return result;
+        }
+
+        bool RecordingBrowser::IsInWindow(size_t const index) const noexcept
+        {
+            size_t const behind = m_prefetchRadius / 4;
+            size_t const before = (m_direction < 0) ? m_prefetchRadius : behind;
+            size_t const after = (m_direction < 0) ? behind : m_prefetchRadius;
+            return (index + before >= m_cursor) && (index <= m_cursor + after);
+        }
+
+        bool RecordingBrowser::FindNextFrame(size_t& index) const
+        /* 按优先级遍历预取窗口：先是光标处的帧，然后沿移动方向依次向前，每前进四帧在反方向上增加一帧。
+        返回第一个不在缓存中的帧。窗口中已缓存的帧加上预计的下一帧大小超过内存预算时停止，
+        这样窗口中的帧不会因为预取更远的帧而被淘汰；光标处的帧总是会被渲染。 */
+        {
+            size_t const frameCount = m_reader.GetFrameCount();
+            size_t const estimatedSize = m_lru.empty() ? 0 : m_cachedBytes / m_lru.size();
+            size_t windowBytes = 0;
+
+            auto const check = [&](size_t const candidate, bool& found) -> bool
+            {
+                auto const pos = m_cache.find(candidate);
+                if (pos == m_cache.end())
+                {
+                    if (candidate != m_cursor && windowBytes + estimatedSize > m_memoryBudget)
+                    {
+                        return false;
+                    }
+                    index = candidate;
+                    found = true;
+                    return false;
+                }
+                if (pos->second->m_frame)
+                {
+                    windowBytes += pos->second->m_frame->GetSize();
+                }
+                return true;
+            };
+
+            bool found = false;
+            if (!check(m_cursor, found))
+            {
+                return found;
+            }
+
+            for (size_t step = 1; step <= m_prefetchRadius; ++step)
+            {
+                size_t const ahead = (m_direction < 0) ? m_cursor - step : m_cursor + step;
+                if ((m_direction < 0) ? (step <= m_cursor) : (ahead < frameCount))
+                {
+                    if (!check(ahead, found))
+                    {
+                        return found;
+                    }
+                }
+
+                if (step % 4 == 0)
+                {
+                    size_t const distance = step / 4;
+                    size_t const behind = (m_direction < 0) ? m_cursor + distance : m_cursor - distance;
+                    if ((m_direction < 0) ? (behind < frameCount) : (distance <= m_cursor))
+                    {
+                        if (!check(behind, found))
+                        {
+                            return found;
+                        }
+                    }
+                }
+            }
+            return false;
+        }
+
+        void RecordingBrowser::Insert(size_t const index, std::shared_ptr<RenderedFrame const> frame)
+        {
+            size_t const size = frame ? frame->GetSize() : 0;
+            m_lru.push_front(CacheEntry { index, std::move(frame) });
+            m_cache[index] = m_lru.begin();
+            m_cachedBytes += size;
+            EvictFrames();
+        }
+
+        void RecordingBrowser::EvictFrames()
+        /* 从最久未使用的一端开始淘汰帧，直到满足内存预算；当前预取窗口中的帧不会被淘汰。 */
+        {
+            auto pos = m_lru.end();
+            while (m_cachedBytes > m_memoryBudget && pos != m_lru.begin())
+            {
+                --pos;
+                if (!IsInWindow(pos->m_index))
+                {
+                    m_cachedBytes -= pos->m_frame ? pos->m_frame->GetSize() : 0;
+                    m_cache.erase(pos->m_index);
+                    pos = m_lru.erase(pos);
+                }
+            }
+        }
+
+        void RecordingBrowser::PrefetchLoop()
+        /* 后台线程：光标移动后先提示操作系统读取窗口内记录的原始数据，然后逐帧取出窗口中尚未缓存的帧，
+        在不持有锁的情况下转换为显示格式并交给 Renderer（例如缩放到显示大小），再放入缓存。
+        渲染期间缓存被清空（Invalidate）时丢弃结果。损坏的记录以空帧缓存，避免反复读取。
+        窗口已完整缓存或内存预算用完时，等待光标、预算或缓存的下一次变化。 */
+        {
+            ASYNCHRONOUSGRAB_TRACE_THREAD_NAME("RecordingBrowser");
+
+            size_t const frameCount = m_reader.GetFrameCount();
+            size_t prefetchedCursor = frameCount;
+
+            std::unique_lock<std::mutex> lock(m_mutex);
+            while (!m_stop)
+            {
+                if (m_cursor != prefetchedCursor)
+                {
+                    prefetchedCursor = m_cursor;
+                    size_t const first = (m_direction < 0) ? prefetchedCursor - (std::min)(prefetchedCursor, m_prefetchRadius) : prefetchedCursor;
+                    lock.unlock();
+                    m_reader.Prefetch(first, m_prefetchRadius + 1);
+                    lock.lock();
+                    continue;
+                }
+
+                size_t index;
+                if (!FindNextFrame(index))
+                {
+                    auto const requestCount = m_requestCount;
+                    m_condition.wait(lock, [this, requestCount]() { return m_stop || m_requestCount != requestCount; });
+                    continue;
+                }
+
+                auto const generation = m_generation;
+                lock.unlock();
+
+                std::shared_ptr<RenderedFrame const> frame;
+                {
+                    ASYNCHRONOUSGRAB_TRACE_SCOPE("RenderRecordedFrame", index);
+                    try
+                    {
+                        VmbFrame_t const recorded = m_reader.GetFrame(index, m_decompressed);
+                        Image const source(recorded);
+                        m_converted.Convert(source);
+                        frame = m_renderer.Render(m_converted, recorded);
+                    }
+                    catch (VmbException const&)
+                    {
+                        // cache the damaged frame as null frame
+                    }
+                    catch (std::bad_alloc const&)
+                    {
+                    }
+                }
+
+                lock.lock();
+                if (generation != m_generation || m_cache.count(index) != 0)
+                {
+                    continue;
+                }
+                ++m_statistics.m_framesRendered;
+                Insert(index, std::move(frame));
+                if (index == m_cursor)
+                {
+                    lock.unlock();
+                    m_renderer.CursorFrameReady(index);
+                    lock.lock();
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,249 @@
+/**
+ * \date 2023
+ * \copyright Allied Vision Technologies.  All Rights Reserved.
+ *
+ * \copyright Redistribution of this file, in original or modified form, without
+ *            prior written consent of Allied Vision Technologies is prohibited.
+ *
+ * \warning THIS SOFTWARE IS PROVIDED BY THE AUTHOR "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF TITLE,
+ * NON-INFRINGEMENT, MERCHANTABILITY AND FITNESS FOR A PARTICULAR  PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \brief Definition of random access to the frames of a recording with a prefetching cache
+ */
+
+#ifndef ASYNCHRONOUSGRAB_C_RECORDING_BROWSER_H
+#define ASYNCHRONOUSGRAB_C_RECORDING_BROWSER_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <VmbC/VmbC.h>
+
+#include "Image.h"
+#include "RecordingReader.h"
+
+namespace VmbC
+{
+    namespace Examples
+    {
+        /**
+         * \brief Random access to the frames of a recording for scrubbing
+         *        through it, e.g. with a timeline slider.
+         *
+         * The frames around a cursor are converted and passed to a Renderer
+         * by a background thread; the results, e.g. images scaled to the
+         * display size, are kept in a least recently used cache limited by
+         * a memory budget. Moving the cursor returns the cached frame if
+         * available; otherwise the frame is rendered before any other frame
+         * and the Renderer is notified.
+         */
+        class RecordingBrowser
+        {
+        public:
+            struct Settings
+            {
+                std::string m_fileName;
+
+                /**
+                 * \brief the maximum number of bytes of the rendered frames
+                 *        kept in the cache
+                 */
+                size_t m_memoryBudget { size_t(256) << 20 };
+
+                /**
+                 * \brief the number of frames rendered ahead of the cursor in
+                 *        the direction of movement; a quarter of this is
+                 *        rendered in the opposite direction
+                 */
+                size_t m_prefetchRadius { 48 };
+            };
+
+            /**
+             * \brief the result of Renderer::Render
+             */
+            class RenderedFrame
+            {
+            public:
+                virtual ~RenderedFrame() = default;
+
+                /**
+                 * \brief the number of bytes accounted to the memory budget
+                 */
+                virtual size_t GetSize() const noexcept = 0;
+            };
+
+            class Renderer
+            {
+            public:
+                virtual ~Renderer() = default;
+
+                /**
+                 * \brief create the cached representation of a frame;
+                 *        called from the background thread
+                 * \param[in] image the frame converted to ImageTranscoder::GetTargetPixelFormat();
+                 *                  only valid until the function returns
+                 */
+                virtual std::shared_ptr<RenderedFrame const> Render(Image const& image, VmbFrame_t const& frame) = 0;
+
+                /**
+                 * \brief called from the background thread after the frame
+                 *        at the cursor was added to the cache
+                 */
+                virtual void CursorFrameReady(size_t index) = 0;
+            };
+
+            struct Statistics
+            {
+                VmbUint64_t m_cacheHits { 0 };
+                VmbUint64_t m_cacheMisses { 0 };
+                VmbUint64_t m_framesRendered { 0 };
+                size_t m_cachedFrames { 0 };
+                size_t m_cachedBytes { 0 };
+                size_t m_memoryBudget { 0 };
+            };
+
+            /**
+             * \brief map the recording and start the background thread
+             * \throws VmbException, if the recording cannot be opened or is empty
+             */
+            RecordingBrowser(Settings const& settings, Renderer& renderer);
+
+            ~RecordingBrowser();
+
+            RecordingBrowser(RecordingBrowser const&) = delete;
+            RecordingBrowser& operator=(RecordingBrowser const&) = delete;
+
+            RecordingReader const& GetReader() const noexcept
+            {
+                return m_reader;
+            }
+
+            /**
+             * \brief move the cursor
+             * \param[in] direction the direction of the movement; positive
+             *                      for forward, negative for backward
+             * \return the frame at index, if cached; null otherwise
+             */
+            std::shared_ptr<RenderedFrame const> Seek(size_t index, int direction);
+
+            /**
+             * \brief get a frame without moving the cursor
+             * \return null, if the frame is not cached
+             */
+            std::shared_ptr<RenderedFrame const> GetCachedFrame(size_t index);
+
+            /**
+             * \brief discard all cached frames, e.g. after the display size
+             *        changed
+             */
+            void Invalidate();
+
+            void SetMemoryBudget(size_t memoryBudget);
+
+            Statistics GetStatistics() const;
+        private:
+            struct CacheEntry
+            {
+                size_t m_index;
+                std::shared_ptr<RenderedFrame const> m_frame;
+            };
+
+            using LruList = std::list<CacheEntry>;
+
+            RecordingReader m_reader;
+            Renderer& m_renderer;
+            size_t const m_prefetchRadius;
+
+            mutable std::mutex m_mutex;
+            std::condition_variable m_condition;
+
+            /**
+             * \name State guarded by m_mutex
+             */
+            ///@{
+            size_t m_cursor { 0 };
+            int m_direction { 1 };
+
+            /**
+             * \brief incremented by Invalidate; frames rendered for an older
+             *        generation are discarded
+             */
+            VmbUint64_t m_generation { 0 };
+
+            /**
+             * \brief incremented whenever the cursor, the budget or the cache
+             *        changes to restart the search for frames to render
+             */
+            VmbUint64_t m_requestCount { 0 };
+
+            /**
+             * \brief the most recently used frame first
+             */
+            LruList m_lru;
+            std::unordered_map<size_t, LruList::iterator> m_cache;
+            size_t m_cachedBytes { 0 };
+            size_t m_memoryBudget;
+            Statistics m_statistics;
+            bool m_stop { false };
+            ///@}
+
+            /**
+             * \brief the conversion target; only used by the background thread
+             */
+            Image m_converted;
+
+            /**
+             * \brief the buffer compressed frames are restored into; only
+             *        used by the background thread
+             */
+            std::vector<unsigned char> m_decompressed;
+
+            std::thread m_thread;
+
+            void PrefetchLoop();
+
+            /**
+             * \brief find the next frame of the prefetch window that is not
+             *        cached, starting at the cursor; requires m_mutex
+             * \return false, if the window is complete or does not fit into
+             *         the memory budget
+             */
+            bool FindNextFrame(size_t& index) const;
+
+            /**
+             * \return true, if index is part of the current prefetch window;
+             *         requires m_mutex
+             */
+            bool IsInWindow(size_t index) const noexcept;
+
+            /**
+             * \brief add a frame as most recently used and evict the least
+             *        recently used frames outside of the prefetch window
+             *        until the budget is met; requires m_mutex
+             */
+            void Insert(size_t index, std::shared_ptr<RenderedFrame const> frame);
+
+            /**
+             * \brief requires m_mutex
+             */
+            void EvictFrames();
+        };
+    }
+}
+
+#endif
@@ -0,0 +1,256 @@
+/**
+ * \date 2023
+ * \copyright Allied Vision Technologies.  All Rights Reserved.
+ *
+ * \copyright Redistribution of this file, in original or modified form, without
+ *            prior written consent of Allied Vision Technologies is prohibited.
+ *
+ * \warning THIS SOFTWARE IS PROVIDED BY THE AUTHOR "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF TITLE,
+ * NON-INFRINGEMENT, MERCHANTABILITY AND FITNESS FOR A PARTICULAR  PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \brief Definition of the layout of raw frame recordings
+ */
+
+#ifndef ASYNCHRONOUSGRAB_C_RECORDING_FORMAT_H
+#define ASYNCHRONOUSGRAB_C_RECORDING_FORMAT_H
+
+#include <cstddef>
+
+#include <VmbC/VmbC.h>
+
+#include "FrameMetadata.h"
+
+namespace VmbC
+{
+    namespace Examples
+    {
+        /**
+         * \brief Layout of the files written by RecordingSink.
+         *
+         * A file starts with a FileHeader block followed by frame records.
+         * Every record starts at a multiple of BlockSize with a RecordHeader;
+         * the frame buffer is stored at RecordHeader::m_payloadOffset. When
+         * the recording is finished, an index block is appended after the
+         * last record and FileHeader::m_indexOffset is set. Files without a
+         * valid index, e.g. after a crash, can be indexed by walking the
+         * records from the first block until the first invalid record. All
+         * values are stored in the byte order of the recording system.
+         *
+         * The frame buffer of a record may be compressed with LosslessCodec;
+         * version 1 files only contain uncompressed records. The metadata
+         * of the frames was added to the zeroed space after the record
+         * header without changing the version; in older files no metadata
+         * field is valid.
+         */
+        namespace RecordingFormat
+        {
+            /**
+             * \brief alignment of file offsets and sizes required for
+             *        unbuffered io
+             */
+            constexpr size_t BlockSize = 4096;
+
+            /**
+             * \brief offset of the frame buffer from the start of a record
+             */
+            constexpr VmbUint32_t PayloadOffset = 256;
+
+            constexpr char FileMagic[8] = { 'V', 'M', 'B', 'R', 'E', 'C', '\0', '\0' };
+
+            constexpr VmbUint32_t FileVersion = 2;
+
+            /**
+             * \brief the oldest version of the files that can be read
+             */
+            constexpr VmbUint32_t MinFileVersion = 1;
+
+            /**
+             * \brief values of RecordHeader::m_compression
+             */
+            enum Compression : VmbUint32_t
+            {
+                CompressionNone = 0,
+
+                /**
+                 * \brief compressed by LosslessCodec
+                 */
+                CompressionLossless = 1
+            };
+
+            /**
+             * \brief magic value of records containing a frame; "FRAM"
+             */
+            constexpr VmbUint32_t RecordMagic = 0x4D415246;
+
+            /**
+             * \brief magic value of space in the staging ring that is not
+             *        part of the file; "PAD "
+             */
+            constexpr VmbUint32_t PaddingMagic = 0x20444150;
+
+            /**
+             * \brief magic value of the index block; "INDX"
+             */
+            constexpr VmbUint32_t IndexMagic = 0x58444E49;
+
+            /**
+             * \brief the capacity of the strings of the FileHeader including
+             *        the terminating 0
+             */
+            ///@{
+            constexpr size_t CameraIdSize = 256;
+            constexpr size_t CameraNameSize = 128;
+            constexpr size_t ModelNameSize = 128;
+            constexpr size_t SerialNumberSize = 64;
+            ///@}
+
+            struct FileHeader
+            {
+                char m_magic[8];
+                VmbUint32_t m_version;
+                VmbUint32_t m_blockSize;
+                VmbUint32_t m_payloadOffset;
+                VmbUint32_t m_reserved;
+
+                /**
+                 * \brief the offset of the IndexHeader; 0, if the recording
+                 *        was not finished
+                 */
+                VmbUint64_t m_indexOffset;
+
+                /**
+                 * \brief the number of frames in the index
+                 */
+                VmbUint64_t m_frameCount;
+
+                /**
+                 * \brief the pixel format of the first frame recorded
+                 */
+                VmbUint32_t m_pixelFormat;
+                VmbUint32_t m_reserved2;
+
+                /**
+                 * \brief 0-terminated information about the camera
+                 */
+                ///@{
+                char m_cameraId[CameraIdSize];
+                char m_cameraName[CameraNameSize];
+                char m_modelName[ModelNameSize];
+                char m_serialNumber[SerialNumberSize];
+                ///@}
+            };
+
+            struct RecordHeader
+            {
+                VmbUint32_t m_magic;
+
+                /**
+                 * \brief offset of the frame buffer from the start of the record
+                 */
+                VmbUint32_t m_payloadOffset;
+
+                /**
+                 * \brief size of the whole record including the padding to
+                 *        the next multiple of BlockSize
+                 */
+                VmbUint64_t m_recordSize;
+
+                /**
+                 * \brief size of the data stored at m_payloadOffset; differs
+                 *        from m_bufferSize for compressed records
+                 */
+                VmbUint64_t m_payloadSize;
+
+                VmbUint64_t m_frameId;
+                VmbUint64_t m_timestamp;
+                VmbUint32_t m_width;
+                VmbUint32_t m_height;
+                VmbUint32_t m_offsetX;
+                VmbUint32_t m_offsetY;
+                VmbUint32_t m_pixelFormat;
+                VmbInt32_t m_receiveStatus;
+                VmbUint32_t m_receiveFlags;
+
+                /**
+                 * \brief offset of VmbFrame_t::imageData from the start of the
+                 *        frame buffer
+                 */
+                VmbUint32_t m_imageOffset;
+
+                /**
+                 * \brief a value of Compression
+                 */
+                VmbUint32_t m_compression;
+                VmbUint32_t m_reserved;
+
+                /**
+                 * \brief size of the frame buffer; 0 in version 1 files, where
+                 *        it equals m_payloadSize
+                 */
+                VmbUint64_t m_bufferSize;
+
+                /**
+                 * \brief the metadata of the frame; m_fields is 0, if it had
+                 *        none
+                 */
+                FrameMetadata m_metadata;
+            };
+
+            /**
+             * \brief the start of the index block; followed by
+             *        IndexHeader::m_entryCount entries
+             */
+            struct IndexHeader
+            {
+                VmbUint32_t m_magic;
+                VmbUint32_t m_entrySize;
+                VmbUint64_t m_entryCount;
+            };
+
+            /**
+             * \brief the location of a frame record; the entries are in
+             *        recording order
+             */
+            struct IndexEntry
+            {
+                VmbUint64_t m_frameId;
+                VmbUint64_t m_timestamp;
+
+                /**
+                 * \brief the file offset of the RecordHeader
+                 */
+                VmbUint64_t m_offset;
+            };
+
+            static_assert(sizeof(FileHeader) <= BlockSize, "file header exceeds the first block");
+            static_assert(sizeof(RecordHeader) <= PayloadOffset, "record header overlaps the payload");
+
+            /**
+             * \brief get the size of the record storing a frame buffer of a
+             *        given size
+             */
+            constexpr VmbUint64_t GetRecordSize(VmbUint64_t payloadSize) noexcept
+            {
+                return (PayloadOffset + payloadSize + BlockSize - 1) / BlockSize * BlockSize;
+            }
+
+            /**
+             * \brief get the size of the index block for a given number of frames
+             */
+            constexpr VmbUint64_t GetIndexSize(VmbUint64_t frameCount) noexcept
+            {
+                return (sizeof(IndexHeader) + frameCount * sizeof(IndexEntry) + BlockSize - 1) / BlockSize * BlockSize;
+            }
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,365 @@
+/**
+ * \date 2023
+ * \copyright Allied Vision Technologies.  All Rights Reserved.
+ *
+ * \copyright Redistribution of this file, in original or modified form, without
+ *            prior written consent of Allied Vision Technologies is prohibited.
+ *
+ * \warning THIS SOFTWARE IS PROVIDED BY THE AUTHOR "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF TITLE,
+ * NON-INFRINGEMENT, MERCHANTABILITY AND FITNESS FOR A PARTICULAR  PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \brief Implementation of ::VmbC::Examples::RecordingReader
+ */
+
+#include <algorithm>
+#include <cstring>
+
+#include "LosslessCodec.h"
+#include "RecordingReader.h"
+#include "VmbException.h"
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace VmbC
+{
+    namespace Examples
+    {
+        namespace
+        {
+            VmbUint64_t GetBufferSize(RecordingFormat::RecordHeader const& record) noexcept
+            {
+                return (record.m_bufferSize == 0) ? record.m_payloadSize : record.m_bufferSize;
+            }
+
+            /**
+             * \brief describe the frame of a record with the buffer members
+             *        referring to a given buffer
+             */
+            VmbFrame_t GetRecordedFrame(RecordingFormat::RecordHeader const& record, unsigned char* const buffer) noexcept
+            {
+                VmbFrame_t frame;
+                std::memset(&frame, 0, sizeof(frame));
+                frame.buffer = buffer;
+                frame.bufferSize = static_cast<VmbUint32_t>(GetBufferSize(record));
+                frame.imageData = buffer + record.m_imageOffset;
+                frame.receiveStatus = record.m_receiveStatus;
+                frame.receiveFlags = record.m_receiveFlags;
+                frame.frameID = record.m_frameId;
+                frame.timestamp = record.m_timestamp;
+                frame.width = record.m_width;
+                frame.height = record.m_height;
+                frame.offsetX = record.m_offsetX;
+                frame.offsetY = record.m_offsetY;
+                frame.pixelFormat = record.m_pixelFormat;
+                return frame;
+            }
+        }
+
+        RecordingReader::RecordingReader(std::string const& fileName)
+        /* 以只读方式把整个文件映射到内存。返回的帧直接引用映射的数据，不复制，页面在第一次访问时由操作系统读入。
+        检查文件头后优先使用文件中保存的索引；索引缺失或无效（录制被中断）时，通过遍历记录重建索引。 */
+        {
+#ifdef _WIN32
+            m_file = CreateFileA(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+            if (m_file == INVALID_HANDLE_VALUE)
+            {
+                m_file = nullptr;
+                throw VmbException("unable to open " + fileName);
+            }
+            LARGE_INTEGER size;
+            if (!GetFileSizeEx(m_file, &size))
+            {
+                Unmap();
+                throw VmbException("unable to determine the size of " + fileName);
+            }
+            m_fileSize = static_cast<VmbUint64_t>(size.QuadPart);
+            if (m_fileSize >= RecordingFormat::BlockSize)
+            {
+                m_mapping = CreateFileMappingA(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+                if (m_mapping != nullptr)
+                {
+                    m_data = static_cast<unsigned char const*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+                }
+            }
+#else
+            int const file = open(fileName.c_str(), O_RDONLY | O_CLOEXEC);
+            if (file < 0)
+            {
+                throw VmbException("unable to open " + fileName + ": " + std::strerror(errno));
+            }
+            struct stat status;
+            if (fstat(file, &status) == 0)
+            {
+                m_fileSize = static_cast<VmbUint64_t>(status.st_size);
+            }
+            if (m_fileSize >= RecordingFormat::BlockSize)
+            {
+                void* const data = mmap(nullptr, static_cast<size_t>(m_fileSize), PROT_READ, MAP_SHARED, file, 0);
+                if (data != MAP_FAILED)
+                {
+                    m_data = static_cast<unsigned char const*>(data);
+                }
+            }
+            close(file); // the mapping keeps the file open
+#endif
+            if (m_data == nullptr)
+            {
+                Unmap();
+                throw VmbException("unable to map " + fileName);
+            }
+
+            auto const& header = GetFileHeader();
+            if (std::memcmp(header.m_magic, RecordingFormat::FileMagic, sizeof(header.m_magic)) != 0
+                || header.m_version < RecordingFormat::MinFileVersion
+                || header.m_version > RecordingFormat::FileVersion
+                || header.m_blockSize != RecordingFormat::BlockSize
+                || header.m_payloadOffset != RecordingFormat::PayloadOffset)
+            {
+                Unmap();
+                throw VmbException(fileName + " is not a supported recording");
+            }
+
+            if (!UseStoredIndex())
+            {
+                RebuildIndex();
+            }
+        }
+
+        RecordingReader::~RecordingReader()
+        {
+            Unmap();
+        }
+
+        void RecordingReader::Unmap() noexcept
+        {
+#ifdef _WIN32
+            if (m_data != nullptr)
+            {
+                UnmapViewOfFile(m_data);
+            }
+            if (m_mapping != nullptr)
+            {
+                CloseHandle(m_mapping);
+            }
+            if (m_file != nullptr)
+            {
+                CloseHandle(m_file);
+            }
+            m_mapping = nullptr;
+            m_file = nullptr;
+#else
+            if (m_data != nullptr)
+            {
+                munmap(const_cast<unsigned char*>(m_data), static_cast<size_t>(m_fileSize));
+            }
+#endif
+            m_data = nullptr;
+        }
+
+        bool RecordingReader::UseStoredIndex() noexcept
+        /* 只有索引完全位于文件内、魔数和条目大小正确，并且首尾条目指向有效记录时才使用文件中的索引。 */
+        {
+            auto const& header = GetFileHeader();
+            VmbUint64_t const indexOffset = header.m_indexOffset;
+            if (indexOffset < RecordingFormat::BlockSize
+                || indexOffset % RecordingFormat::BlockSize != 0
+                || indexOffset > m_fileSize - sizeof(RecordingFormat::IndexHeader))
+            {
+                return false;
+            }
+
+            auto const& indexHeader = *reinterpret_cast<RecordingFormat::IndexHeader const*>(m_data + indexOffset);
+            VmbUint64_t const available = (m_fileSize - indexOffset - sizeof(RecordingFormat::IndexHeader)) / sizeof(RecordingFormat::IndexEntry);
+            if (indexHeader.m_magic != RecordingFormat::IndexMagic
+                || indexHeader.m_entrySize != sizeof(RecordingFormat::IndexEntry)
+                || indexHeader.m_entryCount != header.m_frameCount
+                || indexHeader.m_entryCount > available)
+            {
+                return false;
+            }
+
+            auto const entries = reinterpret_cast<RecordingFormat::IndexEntry const*>(m_data + indexOffset + sizeof(RecordingFormat::IndexHeader));
+            size_t const count = static_cast<size_t>(indexHeader.m_entryCount);
+            if (count != 0 && (GetRecord(entries[0].m_offset) == nullptr || GetRecord(entries[count - 1].m_offset) == nullptr))
+            {
+                return false;
+            }
+
+            m_index = entries;
+            m_frameCount = count;
+            return true;
+        }
+
+        void RecordingReader::RebuildIndex()
+        /* 从第一个记录开始按 m_recordSize 逐个遍历，跳过环形缓冲区留下的PAD记录（正常情况下不会写入文件），
+        在第一个不完整或无效的记录处停止；之后的数据（例如崩溃时被截断的记录或预分配的空白区域）被忽略。 */
+        {
+            m_indexRebuilt = true;
+            m_rebuiltIndex.clear();
+
+            VmbUint64_t offset = RecordingFormat::BlockSize;
+            while (true)
+            {
+                if (offset <= m_fileSize - RecordingFormat::PayloadOffset)
+                {
+                    auto const& header = *reinterpret_cast<RecordingFormat::RecordHeader const*>(m_data + offset);
+                    if (header.m_magic == RecordingFormat::PaddingMagic
+                        && header.m_recordSize != 0
+                        && header.m_recordSize % RecordingFormat::BlockSize == 0
+                        && header.m_recordSize <= m_fileSize - offset)
+                    {
+                        offset += header.m_recordSize;
+                        continue;
+                    }
+                }
+
+                auto const record = GetRecord(offset);
+                if (record == nullptr)
+                {
+                    break;
+                }
+                m_rebuiltIndex.push_back(RecordingFormat::IndexEntry { record->m_frameId, record->m_timestamp, offset });
+                offset += record->m_recordSize;
+            }
+
+            m_index = m_rebuiltIndex.data();
+            m_frameCount = m_rebuiltIndex.size();
+        }
+
+        RecordingFormat::RecordHeader const* RecordingReader::GetRecord(VmbUint64_t const offset) const noexcept
+        {
+            if (offset % RecordingFormat::BlockSize != 0 || offset > m_fileSize - RecordingFormat::PayloadOffset)
+            {
+                return nullptr;
+            }
+            auto const record = reinterpret_cast<RecordingFormat::RecordHeader const*>(m_data + offset);
+            if (record->m_magic != RecordingFormat::RecordMagic
+                || record->m_payloadOffset != RecordingFormat::PayloadOffset
+                || record->m_recordSize != RecordingFormat::GetRecordSize(record->m_payloadSize)
+                || record->m_recordSize > m_fileSize - offset
+                || record->m_compression > RecordingFormat::CompressionLossless
+                || (record->m_compression == RecordingFormat::CompressionNone && GetBufferSize(*record) != record->m_payloadSize)
+                || GetBufferSize(*record) > VmbUint32_t(~0u)
+                || record->m_imageOffset > GetBufferSize(*record))
+            {
+                return nullptr;
+            }
+            return record;
+        }
+
+        RecordingFormat::RecordHeader const& RecordingReader::GetValidRecord(size_t const index) const
+        {
+            if (index >= m_frameCount)
+            {
+                throw VmbException("frame index out of range", VmbErrorBadParameter);
+            }
+
+            auto const record = GetRecord(m_index[index].m_offset);
+            if (record == nullptr)
+            {
+                throw VmbException("invalid frame record in the index", VmbErrorInvalidValue);
+            }
+            return *record;
+        }
+
+        bool RecordingReader::IsCompressed(size_t const index) const
+        {
+            return GetValidRecord(index).m_compression != RecordingFormat::CompressionNone;
+        }
+
+        VmbFrame_t RecordingReader::GetFrame(size_t const index) const
+        {
+            auto const& record = GetValidRecord(index);
+            if (record.m_compression != RecordingFormat::CompressionNone)
+            {
+                throw VmbException("the frame record is compressed", VmbErrorInvalidValue);
+            }
+            return GetRecordedFrame(record, const_cast<unsigned char*>(reinterpret_cast<unsigned char const*>(&record) + record.m_payloadOffset));
+        }
+
+        FrameMetadata RecordingReader::GetMetadata(size_t const index) const
+        {
+            return GetValidRecord(index).m_metadata;
+        }
+
+        VmbFrame_t RecordingReader::GetFrame(size_t const index, std::vector<unsigned char>& buffer) const
+        /* 未压缩的记录与GetFrame(index)相同，直接引用映射的数据；压缩的记录解码到调用者提供的缓冲区中，
+        缓冲区只在需要时增大，因此逐帧读取时可以重复使用而不重新分配。 */
+        {
+            auto const& record = GetValidRecord(index);
+            auto const payload = reinterpret_cast<unsigned char const*>(&record) + record.m_payloadOffset;
+            if (record.m_compression == RecordingFormat::CompressionNone)
+            {
+                return GetRecordedFrame(record, const_cast<unsigned char*>(payload));
+            }
+
+            size_t const bufferSize = static_cast<size_t>(GetBufferSize(record));
+            if (buffer.size() < bufferSize)
+            {
+                buffer.resize(bufferSize);
+            }
+            VmbFrame_t const frame = GetRecordedFrame(record, buffer.data());
+            LosslessCodec codec;
+            codec.Decompress(payload, static_cast<size_t>(record.m_payloadSize), frame);
+            return frame;
+        }
+
+        size_t RecordingReader::FindFrameId(VmbUint64_t const frameId) const noexcept
+        {
+            auto const end = m_index + m_frameCount;
+            auto const pos = std::lower_bound(m_index, end, frameId,
+                                              [](RecordingFormat::IndexEntry const& entry, VmbUint64_t id) { return entry.m_frameId < id; });
+            return (pos != end && pos->m_frameId == frameId) ? static_cast<size_t>(pos - m_index) : m_frameCount;
+        }
+
+        size_t RecordingReader::FindTimestamp(VmbUint64_t const timestamp) const noexcept
+        {
+            auto const end = m_index + m_frameCount;
+            auto const pos = std::upper_bound(m_index, end, timestamp,
+                                              [](VmbUint64_t time, RecordingFormat::IndexEntry const& entry) { return time < entry.m_timestamp; });
+            return (pos == m_index) ? 0 : static_cast<size_t>(pos - m_index) - 1;
+        }
+
+        void RecordingReader::Prefetch(size_t const firstIndex, size_t const count) const noexcept
+        /* 通知操作系统提前读取一段帧记录（Linux上使用 madvise(MADV_WILLNEED)，Windows上使用 PrefetchVirtualMemory），
+        读取在后台进行，不阻塞调用者。 */
+        {
+            if (firstIndex >= m_frameCount || count == 0)
+            {
+                return;
+            }
+            size_t const lastIndex = (std::min)(firstIndex + count, m_frameCount) - 1;
+            auto const lastRecord = GetRecord(m_index[lastIndex].m_offset);
+            VmbUint64_t const begin = m_index[firstIndex].m_offset;
+            VmbUint64_t const end = m_index[lastIndex].m_offset + (lastRecord == nullptr ? RecordingFormat::BlockSize : lastRecord->m_recordSize);
+            if (end <= begin)
+            {
+                return;
+            }
+#ifdef _WIN32
+            WIN32_MEMORY_RANGE_ENTRY range;
+            range.VirtualAddress = const_cast<unsigned char*>(m_data + begin);
+            range.NumberOfBytes = static_cast<SIZE_T>(end - begin);
+            PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+#else
+            madvise(const_cast<unsigned char*>(m_data + begin), static_cast<size_t>(end - begin), MADV_WILLNEED);
+#endif
+        }
+    }
+}
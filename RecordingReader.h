@@ -0,0 +1,189 @@
+/**
+ * \date 2023
+ * \copyright Allied Vision Technologies.  All Rights Reserved.
+ *
+ * \copyright Redistribution of this file, in original or modified form, without
+ *            prior written consent of Allied Vision Technologies is prohibited.
+ *
+ * \warning THIS SOFTWARE IS PROVIDED BY THE AUTHOR "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF TITLE,
+ * NON-INFRINGEMENT, MERCHANTABILITY AND FITNESS FOR A PARTICULAR  PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \brief Definition of a reader for recordings written by RecordingSink
+ */
+
+#ifndef ASYNCHRONOUSGRAB_C_RECORDING_READER_H
+#define ASYNCHRONOUSGRAB_C_RECORDING_READER_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include <VmbC/VmbC.h>
+
+#include "RecordingFormat.h"
+
+namespace VmbC
+{
+    namespace Examples
+    {
+        /**
+         * \brief Read-only access to a file written by RecordingSink.
+         *
+         * The file is mapped into memory; the uncompressed frames returned
+         * reference the mapped data directly and can be wrapped in an Image
+         * without copying. If the file does not contain a valid index, e.g.
+         * because the recording was interrupted, the index is rebuilt from the
+         * records preceding the first incomplete record.
+         *
+         * Lookups by frame ID or timestamp use a binary search and rely on
+         * the values increasing within the recording, which is the case for
+         * the frames of a single acquisition.
+         */
+        class RecordingReader
+        {
+        public:
+            /**
+             * \brief map a recording
+             * \throws VmbException, if the file cannot be mapped or is not a recording
+             */
+            RecordingReader(std::string const& fileName);
+
+            ~RecordingReader();
+
+            RecordingReader(RecordingReader const&) = delete;
+            RecordingReader& operator=(RecordingReader const&) = delete;
+
+            RecordingFormat::FileHeader const& GetFileHeader() const noexcept
+            {
+                return *reinterpret_cast<RecordingFormat::FileHeader const*>(m_data);
+            }
+
+            size_t GetFrameCount() const noexcept
+            {
+                return m_frameCount;
+            }
+
+            /**
+             * \return true, if the index stored in the file was missing or
+             *         invalid and was rebuilt from the records
+             */
+            bool IsIndexRebuilt() const noexcept
+            {
+                return m_indexRebuilt;
+            }
+
+            RecordingFormat::IndexEntry const& GetIndexEntry(size_t index) const noexcept
+            {
+                return m_index[index];
+            }
+
+            /**
+             * \return true, if the frame buffer of a record is stored compressed
+             * \throws VmbException, if index is out of range
+             */
+            bool IsCompressed(size_t index) const;
+
+            /**
+             * \brief get an uncompressed frame referencing the mapped data;
+             *        valid for the lifetime of this object
+             *
+             * The context members of the frame are null.
+             *
+             * \throws VmbException, if index is out of range or the record is
+             *                      compressed
+             */
+            VmbFrame_t GetFrame(size_t index) const;
+
+            /**
+             * \brief get a frame, decompressing it if necessary
+             *
+             * Uncompressed frames reference the mapped data; compressed frames
+             * are restored into buffer, which is enlarged if required and
+             * needs to be kept as long as the frame is in use.
+             *
+             * \throws VmbException, if index is out of range or the record is
+             *                      damaged
+             */
+            VmbFrame_t GetFrame(size_t index, std::vector<unsigned char>& buffer) const;
+
+            /**
+             * \brief get the metadata recorded with a frame; m_fields is 0
+             *        for frames without metadata
+             * \throws VmbException, if index is out of range
+             */
+            FrameMetadata GetMetadata(size_t index) const;
+
+            /**
+             * \brief get the index of the frame with a given frame ID
+             * \return GetFrameCount(), if the frame is not part of the recording
+             */
+            size_t FindFrameId(VmbUint64_t frameId) const noexcept;
+
+            /**
+             * \brief get the index of the last frame with a timestamp less
+             *        than or equal to a given timestamp, i.e. the frame
+             *        visible at that time
+             * \return 0, if the timestamp precedes the first frame
+             */
+            size_t FindTimestamp(VmbUint64_t timestamp) const noexcept;
+
+            /**
+             * \brief hint the operating system to read the records of a range
+             *        of frames in the background
+             */
+            void Prefetch(size_t firstIndex, size_t count) const noexcept;
+        private:
+            unsigned char const* m_data { nullptr };
+            VmbUint64_t m_fileSize { 0 };
+
+#ifdef _WIN32
+            void* m_file { nullptr };
+            void* m_mapping { nullptr };
+#endif
+
+            /**
+             * \brief the index in use; points either into the mapped data or
+             *        to m_rebuiltIndex
+             */
+            RecordingFormat::IndexEntry const* m_index { nullptr };
+            size_t m_frameCount { 0 };
+            bool m_indexRebuilt { false };
+
+            std::vector<RecordingFormat::IndexEntry> m_rebuiltIndex;
+
+            /**
+             * \return true, if the index stored in the file can be used
+             */
+            bool UseStoredIndex() noexcept;
+
+            /**
+             * \brief create the index from the valid records
+             */
+            void RebuildIndex();
+
+            /**
+             * \return a pointer to the record at offset, if the offset
+             *         points to a complete record; null otherwise
+             */
+            RecordingFormat::RecordHeader const* GetRecord(VmbUint64_t offset) const noexcept;
+
+            /**
+             * \throws VmbException, if index is out of range or the index
+             *                      entry does not refer to a valid record
+             */
+            RecordingFormat::RecordHeader const& GetValidRecord(size_t index) const;
+
+            void Unmap() noexcept;
+        };
+    }
+}
+
+#endif
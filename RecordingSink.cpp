@@ -0,0 +1,638 @@
+/**
+ * \date 2023
+ * \copyright Allied Vision Technologies.  All Rights Reserved.
+ *
+ * \copyright Redistribution of this file, in original or modified form, without
+ *            prior written consent of Allied Vision Technologies is prohibited.
+ *
+ * \warning THIS SOFTWARE IS PROVIDED BY THE AUTHOR "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF TITLE,
+ * NON-INFRINGEMENT, MERCHANTABILITY AND FITNESS FOR A PARTICULAR  PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \brief Implementation of ::VmbC::Examples::RecordingSink
+ */
+
+#include <algorithm>
+#include <cstring>
+#include <new>
+
+#include "LosslessCodec.h"
+#include "RecordingFormat.h"
+#include "RecordingSink.h"
+#include "Tracing.h"
+#include "VmbException.h"
+
+namespace VmbC
+{
+    namespace Examples
+    {
+        namespace
+        {
+            /**
+             * \brief the token of the write of the file header; segment
+             *        tokens are ring positions after at least one record
+             */
+            constexpr VmbUint64_t FileHeaderToken = 0;
+
+            /**
+             * \brief the token of the write of the index
+             */
+            constexpr VmbUint64_t IndexToken = ~VmbUint64_t(0);
+
+            template<size_t N>
+            void CopyString(char (&target)[N], std::string const& source) noexcept
+            {
+                size_t const length = (std::min)(source.size(), N - 1);
+                std::memcpy(target, source.data(), length);
+                target[length] = '\0';
+            }
+        }
+
+        RecordingSink::RecordingSink(Settings const& settings)
+            : m_fileName(settings.m_fileName),
+            m_maxWriteSize(AlignedBuffer::AlignUp((std::max)(settings.m_maxWriteSize, RecordingFormat::BlockSize), RecordingFormat::BlockSize)),
+            m_ring(settings.m_ringSize, RecordingFormat::BlockSize),
+            m_fileHeader(RecordingFormat::BlockSize, RecordingFormat::BlockSize),
+            m_writer(settings.m_fileName, settings.m_preallocationSize, settings.m_queueDepth),
+            m_writeCompleted(settings.m_writeCompleted),
+            m_startTime(Clock::now())
+        /* 预先分配暂存环形缓冲区（按块对齐，可直接用于无缓冲写入），创建文件，
+        提交文件头的写操作，然后启动写入线程。文件头在m_fileHeader中保存到写入完成为止。 */
+        {
+            std::memset(m_fileHeader.GetData(), 0, m_fileHeader.GetSize());
+            auto& header = *reinterpret_cast<RecordingFormat::FileHeader*>(m_fileHeader.GetData());
+            std::memcpy(header.m_magic, RecordingFormat::FileMagic, sizeof(header.m_magic));
+            header.m_version = RecordingFormat::FileVersion;
+            header.m_blockSize = static_cast<VmbUint32_t>(RecordingFormat::BlockSize);
+            header.m_payloadOffset = RecordingFormat::PayloadOffset;
+            header.m_pixelFormat = VmbPixelFormatLast;
+            CopyString(header.m_cameraId, settings.m_cameraId);
+            CopyString(header.m_cameraName, settings.m_cameraName);
+            CopyString(header.m_modelName, settings.m_modelName);
+            CopyString(header.m_serialNumber, settings.m_serialNumber);
+
+            m_writer.Write(m_fileHeader.GetData(), m_fileHeader.GetSize(), 0, FileHeaderToken);
+            m_fileOffset = m_fileHeader.GetSize();
+
+            if (settings.m_compressionThreads != 0)
+            {
+                m_compressionSlots.resize((std::max)(settings.m_compressionQueueSize, size_t(settings.m_compressionThreads)));
+                for (size_t slot = 0; slot != m_compressionSlots.size(); ++slot)
+                {
+                    m_freeSlots.push_back(slot);
+                }
+            }
+
+            m_thread = std::thread(&RecordingSink::WriteFrames, this);
+            for (unsigned i = 0; i != settings.m_compressionThreads; ++i)
+            {
+                m_compressionThreads.emplace_back(&RecordingSink::CompressFrames, this);
+            }
+        }
+
+        RecordingSink::~RecordingSink()
+        {
+            Stop();
+        }
+
+        void RecordingSink::FrameReceived(VmbFrame_t const& frame)
+        /* 在VmbC回调线程中调用：只把帧复制到环形缓冲区（或压缩队列），不等待磁盘，返回后帧就可以重新入队。 */
+        {
+            ASYNCHRONOUSGRAB_TRACE_SCOPE("RecordFrame", frame.frameID);
+
+            if (!m_compressionSlots.empty())
+            {
+                QueueCompression(frame);
+                return;
+            }
+            AppendRecord(frame, frame.buffer, frame.bufferSize, RecordingFormat::CompressionNone);
+        }
+
+        void RecordingSink::AppendRecord(VmbFrame_t const& frame, void const* const payload, size_t const payloadSize, RecordingFormat::Compression const compression)
+        /* 记录总是连续存放；如果缓冲区末尾放不下，就用一个PAD记录填满末尾，从缓冲区开头继续。
+        缓冲区空间不足时丢弃该帧并计数，而不是阻塞采集。 */
+        {
+            VmbUint64_t const recordSize = RecordingFormat::GetRecordSize(payloadSize);
+            size_t const ringSize = m_ring.GetSize();
+
+            VmbUint64_t writePosition = m_writePosition.load(std::memory_order_relaxed); // only written by one thread at a time
+            VmbUint64_t const releasePosition = m_releasePosition.load(std::memory_order_acquire);
+
+            size_t ringOffset = static_cast<size_t>(writePosition % ringSize);
+            VmbUint64_t const paddingSize = (ringOffset + recordSize > ringSize) ? ringSize - ringOffset : 0;
+            VmbUint64_t const used = writePosition + paddingSize + recordSize - releasePosition;
+            if (m_stop.load(std::memory_order_relaxed) || recordSize > ringSize || used > ringSize)
+            {
+                m_framesDropped.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+
+            if (paddingSize != 0)
+            {
+                auto& padding = *reinterpret_cast<RecordingFormat::RecordHeader*>(m_ring.GetData() + ringOffset);
+                std::memset(&padding, 0, sizeof(padding));
+                padding.m_magic = RecordingFormat::PaddingMagic;
+                padding.m_recordSize = paddingSize;
+                writePosition += paddingSize;
+                ringOffset = 0;
+            }
+
+            unsigned char* const record = m_ring.GetData() + ringOffset;
+            std::memset(record, 0, RecordingFormat::PayloadOffset);
+            auto& header = *reinterpret_cast<RecordingFormat::RecordHeader*>(record);
+            header.m_magic = RecordingFormat::RecordMagic;
+            header.m_payloadOffset = RecordingFormat::PayloadOffset;
+            header.m_recordSize = recordSize;
+            header.m_payloadSize = payloadSize;
+            header.m_frameId = frame.frameID;
+            header.m_timestamp = frame.timestamp;
+            header.m_width = frame.width;
+            header.m_height = frame.height;
+            header.m_offsetX = frame.offsetX;
+            header.m_offsetY = frame.offsetY;
+            header.m_pixelFormat = frame.pixelFormat;
+            header.m_receiveStatus = frame.receiveStatus;
+            header.m_receiveFlags = frame.receiveFlags;
+            header.m_imageOffset = (frame.imageData == nullptr)
+                ? 0
+                : static_cast<VmbUint32_t>(frame.imageData - static_cast<VmbUint8_t const*>(frame.buffer));
+            header.m_compression = compression;
+            header.m_bufferSize = frame.bufferSize;
+            if (auto const metadata = GetFrameMetadata(frame))
+            {
+                header.m_metadata = *metadata;
+            }
+
+            std::memcpy(record + RecordingFormat::PayloadOffset, payload, payloadSize);
+            // zero the padding up to the end of the record to avoid writing stale ring contents
+            std::memset(record + RecordingFormat::PayloadOffset + payloadSize, 0,
+                        static_cast<size_t>(recordSize - RecordingFormat::PayloadOffset - payloadSize));
+
+            // sequentially consistent together with m_writerIdle: either the writer sees the record or the record sees the waiting writer
+            m_writePosition.store(writePosition + recordSize);
+            m_framesRecorded.fetch_add(1, std::memory_order_relaxed);
+
+            size_t const usedSize = static_cast<size_t>(used);
+            if (usedSize > m_ringHighWaterMark.load(std::memory_order_relaxed))
+            {
+                m_ringHighWaterMark.store(usedSize, std::memory_order_relaxed);
+            }
+
+            if (m_writerIdle.load())
+            {
+                // the writer checked the position before waiting under the lock, so taking it here avoids a lost notification
+                std::lock_guard<std::mutex> lock(m_mutex);
+            }
+            m_dataAvailable.notify_one();
+        }
+
+        bool RecordingSink::WaitForSpace(VmbUint32_t const bufferSize)
+        {
+            VmbUint64_t const recordSize = RecordingFormat::GetRecordSize(bufferSize);
+            if (m_compressionSlots.empty())
+            {
+                return WaitForRingSpace(recordSize);
+            }
+
+            // the record of a compressed frame is never larger than the uncompressed one
+            if (recordSize > m_ring.GetSize())
+            {
+                return false;
+            }
+            std::unique_lock<std::mutex> lock(m_compressionMutex);
+            m_compressionCondition.wait(lock, [this]() { return m_stopCompression || !m_freeSlots.empty(); });
+            return !m_stopCompression;
+        }
+
+        bool RecordingSink::WaitForRingSpace(VmbUint64_t const recordSize)
+        /* 与AppendRecord使用相同的计算（包括缓冲区末尾的PAD记录），但空间不足时等待写入线程释放空间而不是丢弃帧。
+        写入线程释放空间时会通知，但不持有锁，因此最多等待10ms后重新检查。 */
+        {
+            size_t const ringSize = m_ring.GetSize();
+            if (recordSize > ringSize)
+            {
+                return false;
+            }
+
+            std::unique_lock<std::mutex> lock(m_mutex);
+            while (!m_stop)
+            {
+                VmbUint64_t const writePosition = m_writePosition.load(std::memory_order_relaxed);
+                size_t const ringOffset = static_cast<size_t>(writePosition % ringSize);
+                VmbUint64_t const paddingSize = (ringOffset + recordSize > ringSize) ? ringSize - ringOffset : 0;
+                if (writePosition + paddingSize + recordSize - m_releasePosition.load(std::memory_order_acquire) <= ringSize)
+                {
+                    return true;
+                }
+                m_spaceAvailable.wait_for(lock, std::chrono::milliseconds(10));
+            }
+            return false;
+        }
+
+        void RecordingSink::QueueCompression(VmbFrame_t const& frame)
+        /* 取一个空闲的压缩槽，在不持有锁的情况下把帧复制进去（槽的缓冲区只在需要时增大），然后按接收顺序编号并放入队列。
+        没有空闲槽（压缩线程跟不上）或帧在未压缩时也放不进环形缓冲区时丢弃该帧。 */
+        {
+            size_t slot;
+            {
+                std::lock_guard<std::mutex> lock(m_compressionMutex);
+                if (m_stopCompression || m_freeSlots.empty() || RecordingFormat::GetRecordSize(frame.bufferSize) > m_ring.GetSize())
+                {
+                    m_framesDropped.fetch_add(1, std::memory_order_relaxed);
+                    return;
+                }
+                slot = m_freeSlots.back();
+                m_freeSlots.pop_back();
+            }
+
+            auto& entry = m_compressionSlots[slot];
+            auto const buffer = static_cast<VmbUint8_t const*>(frame.buffer);
+            try
+            {
+                if (entry.m_input.size() < frame.bufferSize)
+                {
+                    entry.m_input.resize(frame.bufferSize);
+                }
+            }
+            catch (std::bad_alloc const&)
+            {
+                std::lock_guard<std::mutex> lock(m_compressionMutex);
+                m_freeSlots.push_back(slot);
+                m_framesDropped.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+            std::memcpy(entry.m_input.data(), buffer, frame.bufferSize);
+            entry.m_frame = frame;
+            entry.m_frame.buffer = entry.m_input.data();
+            entry.m_frame.imageData = (frame.imageData == nullptr) ? nullptr : entry.m_input.data() + (frame.imageData - buffer);
+            // the metadata of the frame is overwritten once the buffer is requeued
+            std::memset(entry.m_frame.context, 0, sizeof(entry.m_frame.context));
+            if (auto const metadata = GetFrameMetadata(frame))
+            {
+                entry.m_metadata = *metadata;
+                SetFrameMetadata(entry.m_frame, &entry.m_metadata);
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(m_compressionMutex);
+                entry.m_sequence = m_nextSequence++;
+                entry.m_done = false;
+                m_queuedSlots.push_back(slot);
+            }
+            m_compressionCondition.notify_all();
+        }
+
+        void RecordingSink::CompressFrames()
+        /* 压缩线程：从队列中取出帧，在不持有锁的情况下压缩（每个线程有自己的LosslessCodec），按像素格式累计统计，
+        然后把按接收顺序排在最前面的已压缩帧加入环形缓冲区。停止时先处理完队列中剩余的帧再退出。 */
+        {
+            ASYNCHRONOUSGRAB_TRACE_THREAD_NAME("RecordingCompression");
+
+            LosslessCodec codec;
+            std::unique_lock<std::mutex> lock(m_compressionMutex);
+            while (true)
+            {
+                m_compressionCondition.wait(lock, [this]() { return m_stopCompression || !m_queuedSlots.empty(); });
+                if (m_queuedSlots.empty())
+                {
+                    break;
+                }
+                size_t const slot = m_queuedSlots.front();
+                m_queuedSlots.pop_front();
+                lock.unlock();
+
+                auto& entry = m_compressionSlots[slot];
+                auto const start = Clock::now();
+                {
+                    ASYNCHRONOUSGRAB_TRACE_SCOPE("CompressFrame", entry.m_frame.frameID);
+                    try
+                    {
+                        entry.m_outputSize = codec.Compress(entry.m_frame, entry.m_output);
+                    }
+                    catch (std::bad_alloc const&)
+                    {
+                        entry.m_outputSize = 0;
+                    }
+                }
+                auto const duration = Clock::now() - start;
+
+                lock.lock();
+                auto& totals = m_compressionTotals[entry.m_frame.pixelFormat];
+                ++totals.m_frames;
+                totals.m_inputBytes += entry.m_frame.bufferSize;
+                totals.m_outputBytes += (entry.m_outputSize != 0) ? entry.m_outputSize : entry.m_frame.bufferSize;
+                totals.m_duration += duration;
+                if (entry.m_outputSize == 0)
+                {
+                    ++totals.m_framesUncompressed;
+                }
+                entry.m_done = true;
+                lock.unlock();
+
+                CommitFrames();
+                lock.lock();
+            }
+        }
+
+        void RecordingSink::CommitFrames()
+        /* 帧可能以任意顺序完成压缩，但必须按接收顺序写入文件：持有m_commitMutex的线程依次把序号等于
+        m_commitSequence的已完成帧加入环形缓冲区，缓冲区已满时等待写入线程释放空间，然后归还该槽。
+        其他线程完成压缩后也会调用本函数，因此不会遗漏在检查之后才完成的帧。 */
+        {
+            std::lock_guard<std::mutex> commitLock(m_commitMutex);
+            while (true)
+            {
+                size_t slot = m_compressionSlots.size();
+                {
+                    std::lock_guard<std::mutex> lock(m_compressionMutex);
+                    for (size_t i = 0; i != m_compressionSlots.size(); ++i)
+                    {
+                        if (m_compressionSlots[i].m_done && m_compressionSlots[i].m_sequence == m_commitSequence)
+                        {
+                            slot = i;
+                            break;
+                        }
+                    }
+                }
+                if (slot == m_compressionSlots.size())
+                {
+                    return;
+                }
+
+                auto& entry = m_compressionSlots[slot];
+                if (entry.m_outputSize != 0)
+                {
+                    WaitForRingSpace(RecordingFormat::GetRecordSize(entry.m_outputSize));
+                    AppendRecord(entry.m_frame, entry.m_output.data(), entry.m_outputSize, RecordingFormat::CompressionLossless);
+                }
+                else
+                {
+                    WaitForRingSpace(RecordingFormat::GetRecordSize(entry.m_frame.bufferSize));
+                    AppendRecord(entry.m_frame, entry.m_input.data(), entry.m_frame.bufferSize, RecordingFormat::CompressionNone);
+                }
+
+                {
+                    std::lock_guard<std::mutex> lock(m_compressionMutex);
+                    entry.m_done = false;
+                    ++m_commitSequence;
+                    m_freeSlots.push_back(slot);
+                }
+                m_compressionCondition.notify_all();
+            }
+        }
+
+        void RecordingSink::Stop()
+        /* 停止接收新帧，等待压缩线程处理完队列中的帧，再等待写入线程把环形缓冲区中剩余的记录写完，然后把文件截断到实际大小。 */
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_compressionMutex);
+                m_stopCompression = true;
+            }
+            m_compressionCondition.notify_all();
+            for (auto& thread : m_compressionThreads)
+            {
+                if (thread.joinable())
+                {
+                    thread.join();
+                }
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_stop = true;
+            }
+            m_dataAvailable.notify_all();
+            if (m_thread.joinable())
+            {
+                m_thread.join();
+                VmbUint64_t const indexSize = WriteIndex();
+                if (!m_writer.Finish(m_fileOffset + indexSize))
+                {
+                    m_writeFailed = true;
+                }
+            }
+        }
+
+        RecordingSink::Statistics RecordingSink::GetStatistics() const
+        {
+            Statistics result;
+            result.m_framesRecorded = m_framesRecorded.load(std::memory_order_relaxed);
+            result.m_framesDropped = m_framesDropped.load(std::memory_order_relaxed);
+            result.m_bytesWritten = m_bytesWritten.load(std::memory_order_relaxed);
+            result.m_ringSize = m_ring.GetSize();
+            result.m_ringHighWaterMark = m_ringHighWaterMark.load(std::memory_order_relaxed);
+            result.m_writeFailed = m_writeFailed.load(std::memory_order_relaxed);
+            result.m_usesIoUring = m_writer.UsesIoUring();
+            result.m_usesDirectIo = m_writer.UsesDirectIo();
+
+            auto const seconds = std::chrono::duration<double>(Clock::duration(m_writeDuration.load(std::memory_order_relaxed))).count();
+            if (seconds > 0)
+            {
+                result.m_megabytesPerSecond = static_cast<double>(result.m_bytesWritten) / (1024.0 * 1024.0) / seconds;
+            }
+
+            result.m_compressionThreads = static_cast<unsigned>(m_compressionThreads.size());
+            std::lock_guard<std::mutex> lock(m_compressionMutex);
+            for (auto const& totals : m_compressionTotals)
+            {
+                CompressionStatistics format;
+                format.m_pixelFormat = totals.first;
+                format.m_frames = totals.second.m_frames;
+                format.m_framesUncompressed = totals.second.m_framesUncompressed;
+                format.m_inputBytes = totals.second.m_inputBytes;
+                format.m_outputBytes = totals.second.m_outputBytes;
+                if (format.m_outputBytes != 0)
+                {
+                    format.m_ratio = static_cast<double>(format.m_inputBytes) / static_cast<double>(format.m_outputBytes);
+                }
+                auto const compressionSeconds = std::chrono::duration<double>(totals.second.m_duration).count();
+                if (compressionSeconds > 0)
+                {
+                    format.m_megabytesPerSecond = static_cast<double>(format.m_inputBytes) / (1024.0 * 1024.0) / compressionSeconds;
+                }
+                result.m_compression.push_back(format);
+            }
+            return result;
+        }
+
+        void RecordingSink::WriteFrames()
+        /* 写入线程：把环形缓冲区中已填充的部分提交给DirectFileWriter；
+        没有新数据时先等待进行中的写操作完成，全部完成后在条件变量上等待新的记录，空闲时（例如延时摄影的两次拍摄之间）不会周期性唤醒。
+        停止时写完所有剩余记录并等待所有写操作完成后退出。 */
+        {
+            ASYNCHRONOUSGRAB_TRACE_THREAD_NAME("RecordingWriter");
+
+            DirectFileWriter::Completion completion;
+            while (true)
+            {
+                bool const stop = m_stop.load(std::memory_order_acquire);
+                // read the write position after the stop flag to write every frame copied before stopping
+                VmbUint64_t const writePosition = m_writePosition.load(std::memory_order_acquire);
+
+                while (m_writer.PopCompletion(completion, false))
+                {
+                    Complete(completion);
+                }
+
+                if (SubmitRecords(writePosition))
+                {
+                    continue;
+                }
+
+                if (m_writer.GetPendingCount() != 0)
+                {
+                    if (m_writer.PopCompletion(completion, true))
+                    {
+                        Complete(completion);
+                    }
+                }
+                else if (stop)
+                {
+                    break;
+                }
+                else
+                {
+                    std::unique_lock<std::mutex> lock(m_mutex);
+                    m_writerIdle.store(true);
+                    m_dataAvailable.wait(lock, [this]() { return m_stop || m_writePosition.load() != m_submitPosition; });
+                    m_writerIdle.store(false, std::memory_order_relaxed);
+                }
+            }
+        }
+
+        bool RecordingSink::SubmitRecords(VmbUint64_t const writePosition)
+        /* 从m_submitPosition开始收集连续的记录，直到达到m_maxWriteSize或缓冲区末尾，然后提交一次写操作。
+        PAD记录不写入文件，只作为已完成的段加入队列，以便按顺序释放缓冲区空间。 */
+        {
+            size_t const ringSize = m_ring.GetSize();
+            VmbUint64_t const begin = m_submitPosition;
+            VmbUint64_t end = begin;
+
+            while (end != writePosition)
+            {
+                auto const& header = *reinterpret_cast<RecordingFormat::RecordHeader const*>(m_ring.GetData() + end % ringSize);
+                if (header.m_magic == RecordingFormat::PaddingMagic)
+                {
+                    if (end != begin)
+                    {
+                        break;
+                    }
+                    end += header.m_recordSize;
+                    m_submitPosition = end;
+                    m_segments.push_back(Segment { end, 0, true, Clock::time_point() });
+                    Complete(DirectFileWriter::Completion { end, true });
+                    return true;
+                }
+                if (end != begin && end - begin + header.m_recordSize > m_maxWriteSize)
+                {
+                    break;
+                }
+                if (m_index.empty())
+                {
+                    m_pixelFormat = header.m_pixelFormat;
+                }
+                m_index.push_back(RecordingFormat::IndexEntry { header.m_frameId, header.m_timestamp, m_fileOffset + (end - begin) });
+                end += header.m_recordSize;
+                if (end % ringSize == 0)
+                {
+                    break;
+                }
+            }
+
+            if (end == begin)
+            {
+                return false;
+            }
+
+            size_t const size = static_cast<size_t>(end - begin);
+            m_segments.push_back(Segment { end, size, false, Clock::now() });
+            m_submitPosition = end;
+            m_writer.Write(m_ring.GetData() + begin % ringSize, size, m_fileOffset, end);
+            m_fileOffset += size;
+            return true;
+        }
+
+        void RecordingSink::Complete(DirectFileWriter::Completion const& completion)
+        {
+            if (!completion.m_success)
+            {
+                m_writeFailed = true;
+            }
+            if (completion.m_token == FileHeaderToken || completion.m_token == IndexToken)
+            {
+                return;
+            }
+
+            auto const segment = std::find_if(m_segments.begin(), m_segments.end(),
+                                              [&completion](Segment const& s) { return s.m_end == completion.m_token; });
+            if (segment == m_segments.end())
+            {
+                return;
+            }
+            segment->m_done = true;
+            if (completion.m_success)
+            {
+                auto const now = Clock::now();
+                m_bytesWritten.fetch_add(segment->m_size, std::memory_order_relaxed);
+                m_writeDuration.store((now - m_startTime).count(), std::memory_order_relaxed);
+                if (m_writeCompleted && segment->m_size != 0)
+                {
+                    m_writeCompleted(now - segment->m_submitTime, static_cast<size_t>(segment->m_size));
+                }
+            }
+
+            VmbUint64_t released = m_releasePosition.load(std::memory_order_relaxed);
+            while (!m_segments.empty() && m_segments.front().m_done)
+            {
+                released = m_segments.front().m_end;
+                m_segments.pop_front();
+            }
+            m_releasePosition.store(released, std::memory_order_release);
+            m_spaceAvailable.notify_all();
+        }
+
+        VmbUint64_t RecordingSink::WriteIndex()
+        /* 录制结束后在最后一个记录之后追加索引（帧ID、时间戳、记录在文件中的偏移量），
+        然后重写文件头，写入索引位置、帧数和像素格式。只有在文件头更新之后索引才有效，
+        因此在此之前中断的录制可以通过从头遍历记录来重建索引（见RecordingReader）。 */
+        {
+            VmbUint64_t const indexSize = RecordingFormat::GetIndexSize(m_index.size());
+            AlignedBuffer index(static_cast<size_t>(indexSize), RecordingFormat::BlockSize);
+            std::memset(index.GetData(), 0, index.GetSize());
+
+            auto& indexHeader = *reinterpret_cast<RecordingFormat::IndexHeader*>(index.GetData());
+            indexHeader.m_magic = RecordingFormat::IndexMagic;
+            indexHeader.m_entrySize = sizeof(RecordingFormat::IndexEntry);
+            indexHeader.m_entryCount = m_index.size();
+            if (!m_index.empty())
+            {
+                std::memcpy(index.GetData() + sizeof(RecordingFormat::IndexHeader), m_index.data(), m_index.size() * sizeof(RecordingFormat::IndexEntry));
+            }
+
+            DirectFileWriter::Completion completion;
+            m_writer.Write(index.GetData(), index.GetSize(), m_fileOffset, IndexToken);
+            while (m_writer.PopCompletion(completion, true))
+            {
+                Complete(completion);
+            }
+
+            auto& fileHeader = *reinterpret_cast<RecordingFormat::FileHeader*>(m_fileHeader.GetData());
+            fileHeader.m_indexOffset = m_fileOffset;
+            fileHeader.m_frameCount = m_index.size();
+            fileHeader.m_pixelFormat = m_pixelFormat;
+            m_writer.Write(m_fileHeader.GetData(), m_fileHeader.GetSize(), 0, FileHeaderToken);
+            while (m_writer.PopCompletion(completion, true))
+            {
+                Complete(completion);
+            }
+            return indexSize;
+        }
+    }
+}
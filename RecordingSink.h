@@ -0,0 +1,418 @@
+/**
+ * \date 2023
+ * \copyright Allied Vision Technologies.  All Rights Reserved.
+ *
+ * \copyright Redistribution of this file, in original or modified form, without
+ *            prior written consent of Allied Vision Technologies is prohibited.
+ *
+ * \warning THIS SOFTWARE IS PROVIDED BY THE AUTHOR "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF TITLE,
+ * NON-INFRINGEMENT, MERCHANTABILITY AND FITNESS FOR A PARTICULAR  PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \brief Definition of a sink recording the raw frames to a file
+ */
+
+#ifndef ASYNCHRONOUSGRAB_C_RECORDING_SINK_H
+#define ASYNCHRONOUSGRAB_C_RECORDING_SINK_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <VmbC/VmbC.h>
+
+#include "AlignedBuffer.h"
+#include "DirectFileWriter.h"
+#include "FrameMetadata.h"
+#include "FrameSink.h"
+#include "RecordingFormat.h"
+
+namespace VmbC
+{
+    namespace Examples
+    {
+        /**
+         * \brief Records the unconverted frame buffers losslessly to a file
+         *        in RecordingFormat.
+         *
+         * FrameReceived copies the frame into a preallocated staging ring
+         * and returns immediately, so the frame is requeued without waiting
+         * for the disk. A writer thread submits contiguous parts of the ring
+         * to a DirectFileWriter. Frames that do not fit into the ring are
+         * dropped and counted.
+         *
+         * Optionally a pool of threads compresses the frames with
+         * LosslessCodec before they are added to the ring, in the order
+         * received. FrameReceived then only copies the frame into a free
+         * slot of the compression queue; frames arriving while all slots
+         * are in use are dropped.
+         */
+        class RecordingSink : public RawFrameSink
+        {
+        public:
+            using Clock = std::chrono::steady_clock;
+
+            struct Settings
+            {
+                std::string m_fileName;
+
+                /**
+                 * \brief the camera information stored in the file header;
+                 *        truncated to the capacity of the header fields
+                 */
+                ///@{
+                std::string m_cameraId;
+                std::string m_cameraName;
+                std::string m_modelName;
+                std::string m_serialNumber;
+                ///@}
+
+                /**
+                 * \brief the size of the staging ring; limits the data
+                 *        buffered while the disk is slower than the camera
+                 */
+                size_t m_ringSize { size_t(256) << 20 };
+
+                /**
+                 * \brief the maximum size of a single write; larger records
+                 *        are written on their own
+                 */
+                size_t m_maxWriteSize { size_t(8) << 20 };
+
+                /**
+                 * \brief the maximum number of writes in flight
+                 */
+                unsigned m_queueDepth { 4 };
+
+                /**
+                 * \brief the size the file is extended by in advance
+                 */
+                VmbUint64_t m_preallocationSize { VmbUint64_t(4) << 30 };
+
+                /**
+                 * \brief the number of threads compressing the frames; 0 to
+                 *        store the frames uncompressed
+                 */
+                unsigned m_compressionThreads { 0 };
+
+                /**
+                 * \brief the number of frames buffered for the compression
+                 *        threads
+                 */
+                size_t m_compressionQueueSize { 16 };
+
+                /**
+                 * \brief called from the writer thread after each write of
+                 *        records finished with the time since its submission
+                 *        and its size; may be empty
+                 */
+                std::function<void(Clock::duration latency, size_t size)> m_writeCompleted;
+            };
+
+            /**
+             * \brief the compression results of the frames of one pixel format
+             */
+            struct CompressionStatistics
+            {
+                VmbPixelFormat_t m_pixelFormat { VmbPixelFormatLast };
+                VmbUint64_t m_frames { 0 };
+
+                /**
+                 * \brief frames stored uncompressed, because the format is not
+                 *        supported or the data did not get smaller
+                 */
+                VmbUint64_t m_framesUncompressed { 0 };
+                VmbUint64_t m_inputBytes { 0 };
+                VmbUint64_t m_outputBytes { 0 };
+
+                /**
+                 * \brief m_inputBytes divided by m_outputBytes
+                 */
+                double m_ratio { 0 };
+
+                /**
+                 * \brief the input rate of a single compression thread
+                 */
+                double m_megabytesPerSecond { 0 };
+            };
+
+            struct Statistics
+            {
+                VmbUint64_t m_framesRecorded { 0 };
+                VmbUint64_t m_framesDropped { 0 };
+                VmbUint64_t m_bytesWritten { 0 };
+                size_t m_ringSize { 0 };
+
+                /**
+                 * \brief the maximum number of bytes occupied in the ring
+                 */
+                size_t m_ringHighWaterMark { 0 };
+
+                /**
+                 * \brief the average write rate since the start of the recording
+                 */
+                double m_megabytesPerSecond { 0 };
+                bool m_writeFailed { false };
+                bool m_usesIoUring { false };
+                bool m_usesDirectIo { false };
+                unsigned m_compressionThreads { 0 };
+
+                /**
+                 * \brief one entry per pixel format recorded; empty without
+                 *        compression
+                 */
+                std::vector<CompressionStatistics> m_compression;
+            };
+
+            /**
+             * \brief create the file and start the writer thread
+             * \throws VmbException, if the file or the ring cannot be created
+             */
+            RecordingSink(Settings const& settings);
+
+            /**
+             * \brief calls Stop
+             */
+            ~RecordingSink();
+
+            RecordingSink(RecordingSink const&) = delete;
+            RecordingSink& operator=(RecordingSink const&) = delete;
+
+            void FrameReceived(VmbFrame_t const& frame) override;
+
+            /**
+             * \brief wait until a frame with a given buffer size fits into the
+             *        ring or, with compression, a slot of the compression
+             *        queue is free; for producers that must not drop frames,
+             *        e.g. when copying frames kept in memory to the file
+             *
+             * Must be called from the thread calling FrameReceived.
+             *
+             * \return false, if the sink is stopped or the frame is larger
+             *         than the ring
+             */
+            bool WaitForSpace(VmbUint32_t bufferSize);
+
+            /**
+             * \brief compress the frames queued, write the frames remaining in
+             *        the ring, stop the writer thread, append the index and
+             *        truncate the file to its final size
+             *
+             * The sink needs to be removed from the AcquisitionManager first.
+             */
+            void Stop();
+
+            Statistics GetStatistics() const;
+
+            std::string const& GetFileName() const noexcept
+            {
+                return m_fileName;
+            }
+        private:
+            /**
+             * \brief a part of the ring passed to the writer
+             */
+            struct Segment
+            {
+                /**
+                 * \brief the ring position after the segment
+                 */
+                VmbUint64_t m_end;
+
+                /**
+                 * \brief the number of bytes written to the file; 0 for padding
+                 */
+                VmbUint64_t m_size;
+                bool m_done;
+                Clock::time_point m_submitTime;
+            };
+
+            /**
+             * \brief a frame buffered for compression
+             */
+            struct CompressionSlot
+            {
+                /**
+                 * \brief the frame with the buffer members referring to m_input
+                 *        and the metadata referring to m_metadata
+                 */
+                VmbFrame_t m_frame;
+                FrameMetadata m_metadata {};
+                std::vector<unsigned char> m_input;
+                std::vector<unsigned char> m_output;
+
+                /**
+                 * \brief the size of the compressed data; 0 to store m_input
+                 */
+                size_t m_outputSize { 0 };
+
+                /**
+                 * \brief the position of the frame in the order received
+                 */
+                VmbUint64_t m_sequence { 0 };
+                bool m_done { false };
+            };
+
+            struct CompressionTotals
+            {
+                VmbUint64_t m_frames { 0 };
+                VmbUint64_t m_framesUncompressed { 0 };
+                VmbUint64_t m_inputBytes { 0 };
+                VmbUint64_t m_outputBytes { 0 };
+                Clock::duration m_duration {};
+            };
+
+            std::string m_fileName;
+            size_t m_maxWriteSize;
+            AlignedBuffer m_ring;
+            AlignedBuffer m_fileHeader;
+            DirectFileWriter m_writer;
+            std::function<void(Clock::duration, size_t)> m_writeCompleted;
+
+            /**
+             * \brief the positions in the ring, counted in bytes since the start
+             */
+            ///@{
+            std::atomic<VmbUint64_t> m_writePosition { 0 };
+            std::atomic<VmbUint64_t> m_releasePosition { 0 };
+            ///@}
+
+            std::atomic<VmbUint64_t> m_framesRecorded { 0 };
+            std::atomic<VmbUint64_t> m_framesDropped { 0 };
+            std::atomic<VmbUint64_t> m_bytesWritten { 0 };
+            std::atomic<size_t> m_ringHighWaterMark { 0 };
+            std::atomic<bool> m_writeFailed { false };
+
+            Clock::time_point const m_startTime;
+            std::atomic<Clock::rep> m_writeDuration { 0 };
+
+            /**
+             * \brief members only used by the writer thread
+             */
+            ///@{
+            VmbUint64_t m_submitPosition { 0 };
+            VmbUint64_t m_fileOffset { 0 };
+            std::deque<Segment> m_segments;
+            std::vector<RecordingFormat::IndexEntry> m_index;
+            VmbUint32_t m_pixelFormat { VmbPixelFormatLast };
+            ///@}
+
+            std::mutex m_mutex;
+            std::condition_variable m_dataAvailable;
+
+            /**
+             * \brief set by the writer thread while it waits for data without
+             *        a timeout; only then new records need to lock m_mutex
+             *        for the notification
+             */
+            std::atomic<bool> m_writerIdle { false };
+
+            /**
+             * \brief notified by the writer thread when space in the ring is released
+             */
+            std::condition_variable m_spaceAvailable;
+            std::atomic<bool> m_stop { false };
+            std::thread m_thread;
+
+            /**
+             * \brief the compression queue; empty without compression
+             */
+            std::vector<CompressionSlot> m_compressionSlots;
+
+            mutable std::mutex m_compressionMutex;
+
+            /**
+             * \brief notified when a frame is queued for compression, a slot
+             *        is freed or the compression is stopped
+             */
+            std::condition_variable m_compressionCondition;
+
+            /**
+             * \name State guarded by m_compressionMutex
+             */
+            ///@{
+            std::vector<size_t> m_freeSlots;
+            std::deque<size_t> m_queuedSlots;
+            VmbUint64_t m_nextSequence { 0 };
+
+            /**
+             * \brief the sequence number of the next frame added to the ring
+             */
+            VmbUint64_t m_commitSequence { 0 };
+            bool m_stopCompression { false };
+            std::map<VmbPixelFormat_t, CompressionTotals> m_compressionTotals;
+            ///@}
+
+            /**
+             * \brief serializes adding compressed frames to the ring
+             */
+            std::mutex m_commitMutex;
+            std::vector<std::thread> m_compressionThreads;
+
+            /**
+             * \brief copy a frame into the ring; the frame is dropped, if the
+             *        ring is full; only one thread may call this at a time
+             * \param[in] payload the data stored in the record; either the
+             *                    frame buffer or the compressed frame buffer
+             */
+            void AppendRecord(VmbFrame_t const& frame, void const* payload, size_t payloadSize, RecordingFormat::Compression compression);
+
+            /**
+             * \brief wait until a record of a given size fits into the ring
+             * \return false, if the sink is stopped or the record is larger
+             *         than the ring
+             */
+            bool WaitForRingSpace(VmbUint64_t recordSize);
+
+            /**
+             * \brief copy a frame into a free slot of the compression queue
+             */
+            void QueueCompression(VmbFrame_t const& frame);
+
+            void CompressFrames();
+
+            /**
+             * \brief add the compressed frames to the ring that are next in
+             *        the order received
+             */
+            void CommitFrames();
+
+            void WriteFrames();
+
+            /**
+             * \brief pass the next contiguous records of the ring to the writer
+             * \return false, if no records are available
+             */
+            bool SubmitRecords(VmbUint64_t writePosition);
+
+            /**
+             * \brief process a completion and release finished segments in order
+             */
+            void Complete(DirectFileWriter::Completion const& completion);
+
+            /**
+             * \brief append the index after the last record and update the
+             *        file header; called after the writer thread finished
+             * \return the size of the index block
+             */
+            VmbUint64_t WriteIndex();
+        };
+    }
+}
+
+#endif
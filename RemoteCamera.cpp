@@ -0,0 +1,142 @@
+/**
+ * \date 2023
+ * \copyright Allied Vision Technologies.  All Rights Reserved.
+ *
+ * \copyright Redistribution of this file, in original or modified form, without
+ *            prior written consent of Allied Vision Technologies is prohibited.
+ *
+ * \warning THIS SOFTWARE IS PROVIDED BY THE AUTHOR "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF TITLE,
+ * NON-INFRINGEMENT, MERCHANTABILITY AND FITNESS FOR A PARTICULAR  PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \brief Implementation of ::VmbC::Examples::RemoteCamera
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+#include "RemoteCamera.h"
+#include "Tracing.h"
+
+namespace VmbC
+{
+    namespace Examples
+    {
+        namespace
+        {
+            /**
+             * \brief interval for checking, if the object is destroyed, while
+             *        no frame is published
+             */
+            constexpr std::chrono::milliseconds StopCheckInterval { 100 };
+        }
+
+        RemoteCamera::RemoteCamera(Settings const& settings, VmbFrameCallback const callback, void* const context, size_t const frameCount)
+            : m_settings(settings),
+            m_reader(settings.m_name),
+            m_callback(callback),
+            m_frames((std::max)(frameCount, size_t(1))),
+            m_references(m_frames.size()),
+            m_metadata(m_frames.size())
+        /* 映射共享内存并准备固定数量的帧槽，然后启动接收线程。与PlaybackCamera相同，帧的context[0]与真实相机的帧相同，
+        context[FrameQueueContextIndex]指向本对象，处理后的帧通过QueueFrame归还，此时才释放共享内存中的帧引用；
+        context[FrameMetadataContextIndex]指向帧槽的元数据，即导出进程随帧发布的元数据。 */
+        {
+            m_freeFrames.reserve(m_frames.size());
+            for (size_t slot = 0; slot != m_frames.size(); ++slot)
+            {
+                auto& frame = m_frames[slot];
+                std::memset(&frame, 0, sizeof(frame));
+                frame.context[0] = context;
+                SetFrameQueue(frame, this);
+                // remember the slot to find it in QueueFrame
+                frame.context[FrameQueueContextIndex + 1] = reinterpret_cast<void*>(slot);
+                SetFrameMetadata(frame, &m_metadata[slot]);
+                m_freeFrames.push_back(slot);
+            }
+
+            m_thread = std::thread(&RemoteCamera::Receive, this);
+        }
+
+        RemoteCamera::~RemoteCamera()
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_stop = true;
+            }
+            m_condition.notify_all();
+            m_thread.join();
+        }
+
+        void RemoteCamera::QueueFrame(VmbFrame_t const& frame) noexcept
+        /* 释放帧槽持有的共享内存引用，使导出进程可以把缓冲区重新交给相机，然后归还帧槽。 */
+        {
+            auto const slot = reinterpret_cast<size_t>(frame.context[FrameQueueContextIndex + 1]);
+            m_references[slot].Release();
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_freeFrames.push_back(slot);
+            }
+            m_condition.notify_all();
+        }
+
+        bool RemoteCamera::AcquireFrame(size_t& slot)
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_condition.wait(lock, [this]() { return m_stop || !m_freeFrames.empty(); });
+            if (m_stop)
+            {
+                return false;
+            }
+            slot = m_freeFrames.back();
+            m_freeFrames.pop_back();
+            return true;
+        }
+
+        void RemoteCamera::Receive()
+        /* 接收线程：等待空闲的帧槽，再等待导出进程发布的下一帧并把它交给帧回调。
+        所有帧槽都在使用中时不读取新的帧，落后太多的帧由SharedFrameReader跳过，因此处理慢的客户端只会丢帧，不会让相机缺少缓冲区。
+        导出进程停止采集后调用可选的m_closed回调并结束线程。 */
+        {
+            ASYNCHRONOUSGRAB_TRACE_THREAD_NAME("RemoteCamera");
+
+            size_t slot;
+            while (AcquireFrame(slot))
+            {
+                auto& reference = m_references[slot];
+                if (!m_reader.WaitForFrame(reference, StopCheckInterval))
+                {
+                    QueueFrame(m_frames[slot]);
+                    if (m_reader.IsClosed())
+                    {
+                        m_closed.store(true, std::memory_order_release);
+                        if (m_settings.m_closed)
+                        {
+                            m_settings.m_closed();
+                        }
+                        return;
+                    }
+                    continue;
+                }
+                m_framesSkipped.store(m_reader.GetFramesSkipped(), std::memory_order_relaxed);
+
+                // keep the context values of the slot
+                auto& frame = m_frames[slot];
+                VmbFrame_t received = reference.GetFrame();
+                std::memcpy(received.context, frame.context, sizeof(received.context));
+                frame = received;
+                m_metadata[slot] = reference.GetMetadata();
+
+                m_callback(nullptr, static_cast<VmbHandle_t>(this), &frame);
+            }
+        }
+    }
+}
@@ -0,0 +1,168 @@
+/**
+ * \date 2023
+ * \copyright Allied Vision Technologies.  All Rights Reserved.
+ *
+ * \copyright Redistribution of this file, in original or modified form, without
+ *            prior written consent of Allied Vision Technologies is prohibited.
+ *
+ * \warning THIS SOFTWARE IS PROVIDED BY THE AUTHOR "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF TITLE,
+ * NON-INFRINGEMENT, MERCHANTABILITY AND FITNESS FOR A PARTICULAR  PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \brief Definition of a frame source reading the frames another process exports via shared memory
+ */
+
+#ifndef ASYNCHRONOUSGRAB_C_REMOTE_CAMERA_H
+#define ASYNCHRONOUSGRAB_C_REMOTE_CAMERA_H
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <VmbC/VmbC.h>
+
+#include "FrameQueue.h"
+#include "SharedFrameReader.h"
+
+namespace VmbC
+{
+    namespace Examples
+    {
+        /**
+         * \brief Delivers the frames another process exports via
+         *        SharedFrameExport, e.g. AcquisitionDaemon, through a frame
+         *        callback as if they were delivered by a camera.
+         *
+         * The frames reference the shared memory directly. Only a few frame
+         * slots are handed out, since every frame held keeps a buffer of the
+         * camera of the other process from being requeued; frames published
+         * while all slots are in use are skipped by the reader.
+         */
+        class RemoteCamera : public FrameQueue
+        {
+        public:
+            struct Settings
+            {
+                /**
+                 * \brief the name of the shared memory region
+                 */
+                std::string m_name;
+
+                /**
+                 * \brief called by the receiving thread after the exporting
+                 *        process stopped the acquisition; optional
+                 */
+                std::function<void()> m_closed;
+            };
+
+            /**
+             * \brief the default number of frame slots
+             */
+            static constexpr size_t DefaultFrameCount = 3;
+
+            /**
+             * \brief attach to the region and start delivering frames
+             * \param[in] callback the function receiving the frames; called
+             *                     with a null camera handle and this object
+             *                     as stream handle
+             * \param[in] context the value of VmbFrame_t::context[0] of the frames
+             * \param[in] frameCount the number of frame slots
+             * \throws VmbException, if the region cannot be opened
+             */
+            RemoteCamera(Settings const& settings, VmbFrameCallback callback, void* context, size_t frameCount = DefaultFrameCount);
+
+            /**
+             * \brief stops delivering frames and detaches; the frames
+             *        delivered must not be used after the object is destroyed
+             */
+            ~RemoteCamera();
+
+            RemoteCamera(RemoteCamera const&) = delete;
+            RemoteCamera& operator=(RemoteCamera const&) = delete;
+
+            void QueueFrame(VmbFrame_t const& frame) noexcept override;
+
+            /**
+             * \return true, if the exporting process stopped the acquisition
+             */
+            bool IsClosed() const noexcept
+            {
+                return m_closed.load(std::memory_order_acquire);
+            }
+
+            /**
+             * \brief the number of frames published, but not delivered
+             */
+            VmbUint64_t GetFramesSkipped() const noexcept
+            {
+                return m_framesSkipped.load(std::memory_order_relaxed);
+            }
+        private:
+            Settings const m_settings;
+            SharedFrameReader m_reader;
+            VmbFrameCallback const m_callback;
+
+            /**
+             * \brief the frame slots; only accessed by the receiving thread
+             *        while not in m_freeFrames
+             */
+            std::vector<VmbFrame_t> m_frames;
+
+            /**
+             * \brief the references keeping the frames of the slots in the
+             *        shared memory; accessed like m_frames; destroyed before
+             *        m_reader
+             */
+            std::vector<SharedFrameReader::FrameReference> m_references;
+
+            /**
+             * \brief the metadata of the frames of the slots; accessed like
+             *        m_frames
+             */
+            std::vector<FrameMetadata> m_metadata;
+
+            /**
+             * \brief indices of the frame slots available; guarded by m_mutex
+             */
+            std::vector<size_t> m_freeFrames;
+
+            std::mutex m_mutex;
+
+            /**
+             * \brief notified when a frame slot is returned or the object is
+             *        destroyed
+             */
+            std::condition_variable m_condition;
+
+            /**
+             * \brief guarded by m_mutex
+             */
+            bool m_stop { false };
+
+            std::atomic<bool> m_closed { false };
+            std::atomic<VmbUint64_t> m_framesSkipped { 0 };
+            std::thread m_thread;
+
+            void Receive();
+
+            /**
+             * \brief wait for a free frame slot
+             * \return false, if the object is destroyed
+             */
+            bool AcquireFrame(size_t& slot);
+        };
+    }
+}
+
+#endif
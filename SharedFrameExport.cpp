@@ -0,0 +1,286 @@
+/**
+ * \date 2023
+ * \copyright Allied Vision Technologies.  All Rights Reserved.
+ *
+ * \copyright Redistribution of this file, in original or modified form, without
+ *            prior written consent of Allied Vision Technologies is prohibited.
+ *
+ * \warning THIS SOFTWARE IS PROVIDED BY THE AUTHOR "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF TITLE,
+ * NON-INFRINGEMENT, MERCHANTABILITY AND FITNESS FOR A PARTICULAR  PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \brief Implementation of ::VmbC::Examples::SharedFrameExport
+ */
+
+#include <algorithm>
+#include <cstring>
+
+#include "AlignedBuffer.h"
+#include "SharedFrameExport.h"
+#include "Tracing.h"
+#include "VmbException.h"
+
+namespace VmbC
+{
+    namespace Examples
+    {
+        using namespace SharedFrameFormat;
+
+        SharedFrameExport::SharedFrameExport(Settings const& settings, VmbUint32_t const slotCount, size_t const bufferSize, size_t const bufferAlignment)
+            : m_name(settings.m_name),
+            m_readerTimeout(settings.m_readerTimeout),
+            m_retainedFrames((std::min)(settings.m_retainedFrames, (slotCount > 2) ? slotCount - 2 : 0)),
+            m_slotCount(slotCount),
+            m_pending(slotCount)
+        /* 缓冲区按页对齐（VmbC要求的对齐更大时按该对齐），区域的起始地址由mmap按页对齐，因此偏移量对齐即可。
+        所有槽的状态从第0代、0个引用开始，第一次Publish把代数加1。
+        保留的帧数最多为槽数减2，否则所有缓冲区都被保留，相机没有缓冲区可以填充，也就不会再有释放保留帧的QueueFrame调用。 */
+        {
+            size_t const alignment = (std::max)(BufferAlignment, bufferAlignment);
+            m_slotSize = AlignedBuffer::AlignUp(bufferSize, alignment);
+            m_dataOffset = AlignedBuffer::AlignUp(GetSlotOffset(slotCount), alignment);
+            m_memory.Create(m_name, m_dataOffset + m_slotSize * slotCount);
+
+            m_header = reinterpret_cast<Header*>(m_memory.GetData());
+            std::memcpy(m_header->m_magic, Magic, sizeof(Magic));
+            m_header->m_version = Version;
+            m_header->m_ringSize = RingSize;
+            m_header->m_slotCount = slotCount;
+            m_header->m_slotSize = m_slotSize;
+            m_header->m_dataOffset = m_dataOffset;
+            m_header->m_state.store(StateActive, std::memory_order_release);
+        }
+
+        SharedFrameExport::~SharedFrameExport()
+        {
+            Stop();
+        }
+
+        void* SharedFrameExport::GetBuffer(VmbUint32_t const slot) const noexcept
+        {
+            return m_memory.GetData() + m_dataOffset + m_slotSize * slot;
+        }
+
+        Slot& SharedFrameExport::GetSlot(VmbUint32_t const slot) const noexcept
+        {
+            return *reinterpret_cast<Slot*>(m_memory.GetData() + GetSlotOffset(slot));
+        }
+
+        VmbUint32_t SharedFrameExport::GetSlotIndex(VmbFrame_t const& frame) const noexcept
+        {
+            auto const buffer = static_cast<unsigned char const*>(frame.buffer);
+            auto const data = m_memory.GetData() + m_dataOffset;
+            if (buffer < data || buffer >= data + m_slotSize * m_slotCount)
+            {
+                return m_slotCount;
+            }
+            return static_cast<VmbUint32_t>(static_cast<size_t>(buffer - data) / m_slotSize);
+        }
+
+        void SharedFrameExport::Start(VmbHandle_t const streamHandle, VmbFrameCallback const callback)
+        {
+            m_streamHandle = streamHandle;
+            m_callback = callback;
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_stopThread = false;
+            }
+            m_stopped = false;
+            m_thread = std::thread(&SharedFrameExport::ReclaimFrames, this);
+        }
+
+        void SharedFrameExport::Stop() noexcept
+        /* 停止后不再重新入队：采集随后停止，VmbC会撤销所有帧。把状态设为关闭并唤醒等待的读取者，使它们结束等待。 */
+        {
+            m_stopped = true;
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_stopThread = true;
+            }
+            if (m_header != nullptr)
+            {
+                m_header->m_state.store(StateClosed, std::memory_order_release);
+                m_header->m_publishCount.fetch_add(1, std::memory_order_release);
+                SharedMemory::WakeAll(m_header->m_publishCount);
+                m_header->m_releaseCount.fetch_add(1, std::memory_order_release);
+                SharedMemory::WakeAll(m_header->m_releaseCount);
+            }
+            if (m_thread.joinable())
+            {
+                m_thread.join();
+            }
+        }
+
+        void SharedFrameExport::Publish(VmbFrame_t const& frame) noexcept
+        /* 在帧回调中调用：槽的代数加1并为采集流程持有一个引用，然后按顺序锁（seqlock）的方式写入描述符：
+        先把序号清零，写入各字段后再写入新的序号。最后更新头中的序号并且只在有读取者时调用futex唤醒，避免没有读取者时的系统调用。 */
+        {
+            VmbUint32_t const slot = GetSlotIndex(frame);
+            if (slot == m_slotCount || m_stopped.load(std::memory_order_relaxed))
+            {
+                return;
+            }
+            ASYNCHRONOUSGRAB_TRACE_SCOPE("PublishSharedFrame", frame.frameID);
+
+            auto& state = GetSlot(slot).m_state;
+            VmbUint32_t const generation = GetGeneration(state.load(std::memory_order_relaxed)) + 1;
+            state.store(MakeState(generation, 1), std::memory_order_release);
+
+            VmbUint64_t const sequence = m_framesPublished.fetch_add(1, std::memory_order_relaxed) + 1;
+            auto& descriptor = *reinterpret_cast<Descriptor*>(m_memory.GetData() + GetDescriptorOffset(static_cast<VmbUint32_t>((sequence - 1) % RingSize)));
+            descriptor.m_sequence.store(0, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            descriptor.m_frameId = frame.frameID;
+            descriptor.m_timestamp = frame.timestamp;
+            descriptor.m_publishTime = static_cast<VmbUint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch()).count());
+            descriptor.m_bufferOffset = m_dataOffset + m_slotSize * slot;
+            descriptor.m_bufferSize = frame.bufferSize;
+            descriptor.m_imageOffset = (frame.imageData == nullptr) ? 0 : static_cast<VmbUint32_t>(frame.imageData - static_cast<VmbUint8_t const*>(frame.buffer));
+            descriptor.m_slot = slot;
+            descriptor.m_generation = generation;
+            descriptor.m_pixelFormat = frame.pixelFormat;
+            descriptor.m_width = frame.width;
+            descriptor.m_height = frame.height;
+            descriptor.m_offsetX = frame.offsetX;
+            descriptor.m_offsetY = frame.offsetY;
+            descriptor.m_receiveStatus = frame.receiveStatus;
+            descriptor.m_receiveFlags = frame.receiveFlags;
+            auto const metadata = GetFrameMetadata(frame);
+            descriptor.m_metadata = (metadata == nullptr) ? FrameMetadata {} : *metadata;
+            descriptor.m_sequence.store(sequence, std::memory_order_release);
+
+            m_header->m_sequence.store(sequence, std::memory_order_release);
+            m_header->m_publishCount.fetch_add(1, std::memory_order_release);
+            if (m_header->m_readerCount.load(std::memory_order_relaxed) != 0)
+            {
+                SharedMemory::WakeAll(m_header->m_publishCount);
+            }
+        }
+
+        void SharedFrameExport::QueueFrame(VmbFrame_t const& frame) noexcept
+        /* 采集流程（转码器或回调）处理完帧后调用：释放流程持有的引用；没有读取者引用时立即重新入队，
+        否则记录下来，由后台线程在最后一个读取者释放后重新入队。
+        有读取者时最近的 m_retainedFrames 帧先保留流程的引用，较新的帧处理完后才释放最早的帧；
+        流程不转换帧时帧在发布后立即归还，否则读取者几乎来不及取得引用。 */
+        {
+            VmbUint32_t const slot = GetSlotIndex(frame);
+            if (slot == m_slotCount || m_stopped.load(std::memory_order_relaxed))
+            {
+                return;
+            }
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_retained.push_back(&frame);
+            ReleaseRetained((m_header->m_readerCount.load(std::memory_order_relaxed) != 0) ? m_retainedFrames : 0);
+        }
+
+        void SharedFrameExport::ReleaseRetained(size_t const retainedFrames) noexcept
+        {
+            while (m_retained.size() > retainedFrames)
+            {
+                auto const released = m_retained.front();
+                m_retained.pop_front();
+                VmbUint32_t const releasedSlot = GetSlotIndex(*released);
+                m_pending[releasedSlot] = PendingFrame { released, Clock::now() };
+                GetSlot(releasedSlot).m_state.fetch_sub(1, std::memory_order_acq_rel);
+                if (!TryRequeue(releasedSlot, false))
+                {
+                    m_framesHeld.fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+        }
+
+        bool SharedFrameExport::TryRequeue(VmbUint32_t const slot, bool const force) noexcept
+        /* 只有在引用数为0时才能把状态从当前代数换成下一代（CAS），此后读取者持有的旧描述符的代数不再匹配，无法再取得引用；
+        CAS失败说明读取者刚刚取得了引用，它释放时会再次唤醒后台线程。强制回收时不考虑引用数，旧读取者的释放操作因代数不匹配而被忽略。 */
+        {
+            auto& pending = m_pending[slot];
+            if (pending.m_frame == nullptr)
+            {
+                return false;
+            }
+
+            auto& state = GetSlot(slot).m_state;
+            VmbUint64_t current = state.load(std::memory_order_acquire);
+            if (!force)
+            {
+                if (GetReferences(current) != 0
+                    || !state.compare_exchange_strong(current, MakeState(GetGeneration(current) + 1, 0), std::memory_order_acq_rel))
+                {
+                    return false;
+                }
+            }
+            else
+            {
+                state.store(MakeState(GetGeneration(current) + 1, 0), std::memory_order_release);
+                m_framesReclaimed.fetch_add(1, std::memory_order_relaxed);
+            }
+
+            VmbFrame_t const* const frame = pending.m_frame;
+            pending.m_frame = nullptr;
+            VmbCaptureFrameQueue(m_streamHandle, frame, m_callback);
+            return true;
+        }
+
+        void SharedFrameExport::ReclaimFrames()
+        /* 后台线程：在头中的释放计数上等待（futex），被唤醒后检查所有等待读取者的帧；超过m_readerTimeout的帧强制回收。
+        有帧在等待时最多等待到最早的超时时间，否则每秒检查一次。
+        最后一个读取者断开后释放保留的帧，否则它们要等到下一次QueueFrame才被释放，而所有缓冲区都被占用时不会再有新帧。 */
+        {
+            ASYNCHRONOUSGRAB_TRACE_THREAD_NAME("SharedFrameReclaim");
+
+            while (true)
+            {
+                VmbUint32_t const releaseCount = m_header->m_releaseCount.load(std::memory_order_acquire);
+                auto timeout = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::seconds(1));
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    if (m_stopThread)
+                    {
+                        break;
+                    }
+                    if (m_header->m_readerCount.load(std::memory_order_relaxed) == 0)
+                    {
+                        ReleaseRetained(0);
+                    }
+                    auto const now = Clock::now();
+                    for (VmbUint32_t slot = 0; slot != m_slotCount; ++slot)
+                    {
+                        auto const& pending = m_pending[slot];
+                        if (pending.m_frame == nullptr)
+                        {
+                            continue;
+                        }
+                        bool const expired = now - pending.m_since >= m_readerTimeout;
+                        if (!TryRequeue(slot, expired) && m_pending[slot].m_frame != nullptr)
+                        {
+                            auto const remaining = std::chrono::duration_cast<std::chrono::milliseconds>(pending.m_since + m_readerTimeout - now);
+                            timeout = (std::min)(timeout, remaining + std::chrono::milliseconds(1));
+                        }
+                    }
+                }
+                SharedMemory::Wait(m_header->m_releaseCount, releaseCount, timeout);
+            }
+        }
+
+        SharedFrameExport::Statistics SharedFrameExport::GetStatistics() const noexcept
+        {
+            Statistics result;
+            result.m_framesPublished = m_framesPublished.load(std::memory_order_relaxed);
+            result.m_framesHeld = m_framesHeld.load(std::memory_order_relaxed);
+            result.m_framesReclaimed = m_framesReclaimed.load(std::memory_order_relaxed);
+            result.m_readers = m_header->m_readerCount.load(std::memory_order_relaxed);
+            std::lock_guard<std::mutex> lock(m_mutex);
+            result.m_framesWaiting = static_cast<VmbUint32_t>(std::count_if(m_pending.begin(), m_pending.end(),
+                                                                            [](PendingFrame const& pending) { return pending.m_frame != nullptr; }));
+            return result;
+        }
+    }
+}
@@ -0,0 +1,237 @@
+/**
+ * \date 2023
+ * \copyright Allied Vision Technologies.  All Rights Reserved.
+ *
+ * \copyright Redistribution of this file, in original or modified form, without
+ *            prior written consent of Allied Vision Technologies is prohibited.
+ *
+ * \warning THIS SOFTWARE IS PROVIDED BY THE AUTHOR "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF TITLE,
+ * NON-INFRINGEMENT, MERCHANTABILITY AND FITNESS FOR A PARTICULAR  PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \brief Definition of the zero-copy export of frames via shared memory
+ */
+
+#ifndef ASYNCHRONOUSGRAB_C_SHARED_FRAME_EXPORT_H
+#define ASYNCHRONOUSGRAB_C_SHARED_FRAME_EXPORT_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <VmbC/VmbC.h>
+
+#include "FrameQueue.h"
+#include "SharedFrameFormat.h"
+#include "SharedMemory.h"
+
+namespace VmbC
+{
+    namespace Examples
+    {
+        /**
+         * \brief Provides the frame buffers of an acquisition in a named
+         *        shared memory region to other processes without copying.
+         *
+         * The buffers announced to VmbC are allocated in the region (see
+         * SharedFrameFormat). Publish describes a frame received in the
+         * descriptor ring before it is passed to the pipeline; the frames
+         * are returned via the FrameQueue interface, which hands the buffer
+         * back to VmbCaptureFrameQueue only after every reader released it.
+         * Buffers of frames still referenced are requeued by a background
+         * thread woken up by the readers, or forcibly after a timeout to
+         * survive readers that crashed while holding a frame.
+         */
+        class SharedFrameExport : public FrameQueue
+        {
+        public:
+            using Clock = std::chrono::steady_clock;
+
+            struct Settings
+            {
+                /**
+                 * \brief the name of the shared memory region
+                 */
+                std::string m_name { "/AsynchronousGrabFrames" };
+
+                /**
+                 * \brief the maximum time readers may hold a frame after the
+                 *        acquisition pipeline finished with it
+                 */
+                Clock::duration m_readerTimeout { std::chrono::seconds(1) };
+
+                /**
+                 * \brief the number of frames finished by the pipeline that
+                 *        are kept from being requeued while readers are
+                 *        attached, giving the readers time to take a
+                 *        reference; needed if the pipeline returns the frames
+                 *        immediately, e.g. without conversion; limited to the
+                 *        number of frame buffers minus 2
+                 */
+                VmbUint32_t m_retainedFrames { 0 };
+            };
+
+            struct Statistics
+            {
+                VmbUint64_t m_framesPublished { 0 };
+
+                /**
+                 * \brief frames requeued only after a reader released them
+                 */
+                VmbUint64_t m_framesHeld { 0 };
+
+                /**
+                 * \brief frames requeued after m_readerTimeout although
+                 *        readers still referenced them
+                 */
+                VmbUint64_t m_framesReclaimed { 0 };
+
+                /**
+                 * \brief the frames currently waiting for readers
+                 */
+                VmbUint32_t m_framesWaiting { 0 };
+                VmbUint32_t m_readers { 0 };
+            };
+
+            /**
+             * \brief create the region with a frame buffer per slot
+             * \throws VmbException, if the region cannot be created
+             */
+            SharedFrameExport(Settings const& settings, VmbUint32_t slotCount, size_t bufferSize, size_t bufferAlignment);
+
+            /**
+             * \brief calls Stop; removes the name of the region, but readers
+             *        keep their mapping
+             */
+            ~SharedFrameExport();
+
+            SharedFrameExport(SharedFrameExport const&) = delete;
+            SharedFrameExport& operator=(SharedFrameExport const&) = delete;
+
+            /**
+             * \brief get the frame buffer of a slot to announce to VmbC
+             */
+            void* GetBuffer(VmbUint32_t slot) const noexcept;
+
+            /**
+             * \brief start requeuing frames released by readers
+             * \param[in] streamHandle the handle and the callback passed to
+             *                         VmbCaptureFrameQueue
+             */
+            void Start(VmbHandle_t streamHandle, VmbFrameCallback callback);
+
+            /**
+             * \brief stop publishing and requeuing frames and notify the
+             *        readers; call before stopping the acquisition
+             */
+            void Stop() noexcept;
+
+            /**
+             * \brief describe a frame received in one of the buffers of the
+             *        region to the readers; called from the frame callback
+             */
+            void Publish(VmbFrame_t const& frame) noexcept;
+
+            /**
+             * \brief release the reference of the acquisition pipeline and
+             *        requeue the frame, if no reader references it
+             */
+            void QueueFrame(VmbFrame_t const& frame) noexcept override;
+
+            Statistics GetStatistics() const noexcept;
+
+            std::string const& GetName() const noexcept
+            {
+                return m_name;
+            }
+        private:
+            /**
+             * \brief a frame finished by the pipeline, but still referenced
+             *        by readers
+             */
+            struct PendingFrame
+            {
+                VmbFrame_t const* m_frame { nullptr };
+                Clock::time_point m_since;
+            };
+
+            std::string m_name;
+            Clock::duration m_readerTimeout;
+            VmbUint32_t m_retainedFrames;
+            SharedMemory m_memory;
+            SharedFrameFormat::Header* m_header { nullptr };
+            VmbUint32_t m_slotCount;
+            size_t m_slotSize;
+            size_t m_dataOffset;
+
+            VmbHandle_t m_streamHandle { nullptr };
+            VmbFrameCallback m_callback { nullptr };
+
+            std::atomic<bool> m_stopped { true };
+            std::atomic<VmbUint64_t> m_framesPublished { 0 };
+            std::atomic<VmbUint64_t> m_framesHeld { 0 };
+            std::atomic<VmbUint64_t> m_framesReclaimed { 0 };
+
+            mutable std::mutex m_mutex;
+
+            /**
+             * \name State guarded by m_mutex
+             */
+            ///@{
+            std::vector<PendingFrame> m_pending;
+
+            /**
+             * \brief the frames finished by the pipeline, but still retained
+             *        in the order they were finished; the reference of the
+             *        pipeline is held until they leave this queue
+             */
+            std::deque<VmbFrame_t const*> m_retained;
+            bool m_stopThread { false };
+            ///@}
+
+            std::thread m_thread;
+
+            SharedFrameFormat::Slot& GetSlot(VmbUint32_t slot) const noexcept;
+
+            /**
+             * \return the slot of a frame buffer; m_slotCount, if the buffer
+             *         is not part of the region
+             */
+            VmbUint32_t GetSlotIndex(VmbFrame_t const& frame) const noexcept;
+
+            /**
+             * \brief requeue the pending frame of a slot, if no reader
+             *        references it; m_mutex needs to be locked
+             * \param[in] force requeue even if readers reference it
+             * \return true, if the frame was requeued
+             */
+            bool TryRequeue(VmbUint32_t slot, bool force) noexcept;
+
+            /**
+             * \brief release the reference of the pipeline to the oldest
+             *        retained frames until at most retainedFrames are left;
+             *        m_mutex needs to be locked
+             */
+            void ReleaseRetained(size_t retainedFrames) noexcept;
+
+            /**
+             * \brief the thread requeuing frames released by readers
+             */
+            void ReclaimFrames();
+        };
+    }
+}
+
+#endif
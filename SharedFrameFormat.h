@@ -0,0 +1,243 @@
+/**
+ * \date 2023
+ * \copyright Allied Vision Technologies.  All Rights Reserved.
+ *
+ * \copyright Redistribution of this file, in original or modified form, without
+ *            prior written consent of Allied Vision Technologies is prohibited.
+ *
+ * \warning THIS SOFTWARE IS PROVIDED BY THE AUTHOR "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF TITLE,
+ * NON-INFRINGEMENT, MERCHANTABILITY AND FITNESS FOR A PARTICULAR  PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \brief Layout of the shared memory frame export
+ */
+
+#ifndef ASYNCHRONOUSGRAB_C_SHARED_FRAME_FORMAT_H
+#define ASYNCHRONOUSGRAB_C_SHARED_FRAME_FORMAT_H
+
+#include <atomic>
+#include <cstddef>
+
+#include <VmbC/VmbC.h>
+
+#include "FrameMetadata.h"
+
+namespace VmbC
+{
+    namespace Examples
+    {
+        /**
+         * \brief Layout of the shared memory region written by
+         *        SharedFrameExport and read by SharedFrameReader.
+         *
+         * The region starts with a Header followed by RingSize descriptors,
+         * one Slot per frame buffer and the frame buffers themselves
+         * starting at Header::m_dataOffset, each Header::m_slotSize bytes
+         * apart. The frame buffers are the buffers announced to VmbC, i.e.
+         * the camera writes directly into the region.
+         *
+         * Every frame received is described by the next descriptor of the
+         * ring; a descriptor is valid while its m_sequence equals the
+         * number of the publication (1 based) before and after reading the
+         * other members. Header::m_sequence is set to that number and
+         * Header::m_publishCount is incremented and woken up after each
+         * publication.
+         *
+         * Slot::m_state holds a generation in the upper and the number of
+         * references in the lower 32 bits. A reader takes a reference by
+         * incrementing the state only while the generation matches the one
+         * of the descriptor, and releases it by decrementing it under the
+         * same condition. The writer holds one reference while the frame is
+         * processed by the acquisition pipeline; the frame buffer is handed
+         * back to the camera after the last reference was released, which
+         * increments the generation. Readers releasing the last reference
+         * increment and wake up Header::m_releaseCount.
+         */
+        namespace SharedFrameFormat
+        {
+            constexpr char Magic[8] = { 'V', 'M', 'B', 'S', 'H', 'M', '\0', '\0' };
+
+            constexpr VmbUint32_t Version = 2;
+
+            /**
+             * \brief the number of descriptors; a reader needs to read a
+             *        descriptor before RingSize more frames are published
+             */
+            constexpr VmbUint32_t RingSize = 64;
+
+            /**
+             * \brief alignment of the frame buffers
+             */
+            constexpr size_t BufferAlignment = 4096;
+
+            /**
+             * \brief values of Header::m_state
+             */
+            enum State : VmbUint32_t
+            {
+                StateActive = 1,
+
+                /**
+                 * \brief the acquisition stopped; no frames are published
+                 *        anymore
+                 */
+                StateClosed = 2
+            };
+
+            struct Header
+            {
+                char m_magic[8];
+                VmbUint32_t m_version;
+                VmbUint32_t m_ringSize;
+                VmbUint32_t m_slotCount;
+                VmbUint32_t m_reserved;
+
+                /**
+                 * \brief the distance between two frame buffers
+                 */
+                VmbUint64_t m_slotSize;
+
+                /**
+                 * \brief the offset of the first frame buffer from the start
+                 *        of the region
+                 */
+                VmbUint64_t m_dataOffset;
+
+                /**
+                 * \brief the number of frames published, i.e. the sequence
+                 *        of the last descriptor written
+                 */
+                std::atomic<VmbUint64_t> m_sequence;
+
+                /**
+                 * \brief a State value
+                 */
+                std::atomic<VmbUint32_t> m_state;
+
+                /**
+                 * \brief the lower 32 bits of m_sequence updated after it;
+                 *        futex word readers wait on
+                 */
+                std::atomic<VmbUint32_t> m_publishCount;
+
+                /**
+                 * \brief incremented by readers releasing the last reference
+                 *        of a frame; futex word the writer waits on
+                 */
+                std::atomic<VmbUint32_t> m_releaseCount;
+
+                /**
+                 * \brief the number of readers attached
+                 */
+                std::atomic<VmbUint32_t> m_readerCount;
+            };
+
+            struct Descriptor
+            {
+                /**
+                 * \brief the number of the publication; 0 while the
+                 *        descriptor is written
+                 */
+                std::atomic<VmbUint64_t> m_sequence;
+                VmbUint64_t m_frameId;
+
+                /**
+                 * \brief the timestamp of the camera
+                 */
+                VmbUint64_t m_timestamp;
+
+                /**
+                 * \brief std::chrono::steady_clock of the writer in
+                 *        nanoseconds at the publication; CLOCK_MONOTONIC on
+                 *        Linux, i.e. comparable across processes
+                 */
+                VmbUint64_t m_publishTime;
+
+                /**
+                 * \brief the offset of the frame buffer from the start of the
+                 *        region
+                 */
+                VmbUint64_t m_bufferOffset;
+                VmbUint32_t m_bufferSize;
+
+                /**
+                 * \brief the offset of the image data from the start of the
+                 *        frame buffer
+                 */
+                VmbUint32_t m_imageOffset;
+                VmbUint32_t m_slot;
+
+                /**
+                 * \brief the generation of the slot while the frame is valid
+                 */
+                VmbUint32_t m_generation;
+                VmbUint32_t m_pixelFormat;
+                VmbUint32_t m_width;
+                VmbUint32_t m_height;
+                VmbUint32_t m_offsetX;
+                VmbUint32_t m_offsetY;
+                VmbInt32_t m_receiveStatus;
+                VmbUint32_t m_receiveFlags;
+                VmbUint32_t m_reserved;
+
+                /**
+                 * \brief the metadata of the frame; m_fields is 0, if it has
+                 *        none
+                 */
+                FrameMetadata m_metadata;
+            };
+
+            struct Slot
+            {
+                /**
+                 * \brief the generation and the references of the frame
+                 */
+                std::atomic<VmbUint64_t> m_state;
+                VmbUint64_t m_reserved[7];
+            };
+
+            static_assert(sizeof(std::atomic<VmbUint64_t>) == sizeof(VmbUint64_t), "shared atomics must not contain a lock");
+            static_assert(sizeof(Header) == 64, "unexpected padding of the header");
+            static_assert(sizeof(Slot) == 64, "slots are separate cache lines");
+
+            constexpr VmbUint64_t MakeState(VmbUint32_t generation, VmbUint32_t references) noexcept
+            {
+                return (VmbUint64_t(generation) << 32) | references;
+            }
+
+            constexpr VmbUint32_t GetGeneration(VmbUint64_t state) noexcept
+            {
+                return static_cast<VmbUint32_t>(state >> 32);
+            }
+
+            constexpr VmbUint32_t GetReferences(VmbUint64_t state) noexcept
+            {
+                return static_cast<VmbUint32_t>(state);
+            }
+
+            constexpr size_t GetDescriptorOffset(VmbUint32_t index) noexcept
+            {
+                return sizeof(Header) + size_t(index) * sizeof(Descriptor);
+            }
+
+            constexpr size_t GetSlotOffset(VmbUint32_t slot) noexcept
+            {
+                return GetDescriptorOffset(RingSize) + size_t(slot) * sizeof(Slot);
+            }
+
+            constexpr size_t GetDataOffset(VmbUint32_t slotCount) noexcept
+            {
+                return (GetSlotOffset(slotCount) + BufferAlignment - 1) / BufferAlignment * BufferAlignment;
+            }
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,217 @@
+/**
+ * \date 2023
+ * \copyright Allied Vision Technologies.  All Rights Reserved.
+ *
+ * \copyright Redistribution of this file, in original or modified form, without
+ *            prior written consent of Allied Vision Technologies is prohibited.
+ *
+ * \warning THIS SOFTWARE IS PROVIDED BY THE AUTHOR "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF TITLE,
+ * NON-INFRINGEMENT, MERCHANTABILITY AND FITNESS FOR A PARTICULAR  PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \brief Implementation of ::VmbC::Examples::SharedFrameReader
+ */
+
+#include <cstring>
+#include <utility>
+
+#include "SharedFrameReader.h"
+#include "VmbException.h"
+
+namespace VmbC
+{
+    namespace Examples
+    {
+        using namespace SharedFrameFormat;
+
+        SharedFrameReader::FrameReference::~FrameReference()
+        {
+            Release();
+        }
+
+        SharedFrameReader::FrameReference::FrameReference(FrameReference&& other) noexcept
+            : m_frame(other.m_frame),
+            m_metadata(other.m_metadata),
+            m_publishTime(other.m_publishTime),
+            m_slot(other.m_slot),
+            m_header(other.m_header),
+            m_generation(other.m_generation)
+        {
+            other.m_slot = nullptr;
+        }
+
+        SharedFrameReader::FrameReference& SharedFrameReader::FrameReference::operator=(FrameReference&& other) noexcept
+        {
+            if (this != &other)
+            {
+                Release();
+                m_frame = other.m_frame;
+                m_metadata = other.m_metadata;
+                m_publishTime = other.m_publishTime;
+                m_slot = other.m_slot;
+                m_header = other.m_header;
+                m_generation = other.m_generation;
+                other.m_slot = nullptr;
+            }
+            return *this;
+        }
+
+        void SharedFrameReader::FrameReference::Release() noexcept
+        /* 只在代数仍然匹配时减少引用数（写入进程可能已经强制回收了该帧）；释放最后一个引用时增加头中的释放计数并唤醒写入进程。 */
+        {
+            if (m_slot == nullptr)
+            {
+                return;
+            }
+
+            auto& state = m_slot->m_state;
+            VmbUint64_t current = state.load(std::memory_order_relaxed);
+            while (GetGeneration(current) == m_generation && GetReferences(current) != 0)
+            {
+                if (state.compare_exchange_weak(current, current - 1, std::memory_order_acq_rel))
+                {
+                    if (GetReferences(current) == 1)
+                    {
+                        m_header->m_releaseCount.fetch_add(1, std::memory_order_release);
+                        SharedMemory::WakeAll(m_header->m_releaseCount);
+                    }
+                    break;
+                }
+            }
+            m_slot = nullptr;
+        }
+
+        SharedFrameReader::SharedFrameReader(std::string const& name)
+        {
+            m_memory.Open(name);
+            if (m_memory.GetSize() < sizeof(Header))
+            {
+                throw VmbException("Shared memory " + name + " is too small");
+            }
+            m_header = reinterpret_cast<Header*>(m_memory.GetData());
+            if (std::memcmp(m_header->m_magic, Magic, sizeof(Magic)) != 0 || m_header->m_version != Version || m_header->m_ringSize != RingSize
+                || m_memory.GetSize() < m_header->m_dataOffset + m_header->m_slotSize * m_header->m_slotCount
+                || m_header->m_dataOffset < GetSlotOffset(m_header->m_slotCount))
+            {
+                throw VmbException("Shared memory " + name + " does not contain exported frames");
+            }
+            m_header->m_readerCount.fetch_add(1, std::memory_order_relaxed);
+            m_nextSequence = m_header->m_sequence.load(std::memory_order_acquire) + 1;
+        }
+
+        SharedFrameReader::~SharedFrameReader()
+        {
+            m_header->m_readerCount.fetch_sub(1, std::memory_order_relaxed);
+        }
+
+        bool SharedFrameReader::IsClosed() const noexcept
+        {
+            return m_header->m_state.load(std::memory_order_acquire) == StateClosed;
+        }
+
+        bool SharedFrameReader::TryAcquire(VmbUint64_t const sequence, FrameReference& frame) noexcept
+        /* 按顺序锁读取描述符：读取前后的序号都必须等于所需的序号，否则描述符正在被覆盖。
+        然后只在槽的代数仍等于描述符中的代数时增加引用数，之后写入进程在引用释放之前不会把缓冲区交还给相机。 */
+        {
+            auto const& descriptor = *reinterpret_cast<Descriptor const*>(m_memory.GetData() + GetDescriptorOffset(static_cast<VmbUint32_t>((sequence - 1) % RingSize)));
+            if (descriptor.m_sequence.load(std::memory_order_acquire) != sequence)
+            {
+                return false;
+            }
+            VmbUint64_t const frameId = descriptor.m_frameId;
+            VmbUint64_t const timestamp = descriptor.m_timestamp;
+            VmbUint64_t const publishTime = descriptor.m_publishTime;
+            VmbUint64_t const bufferOffset = descriptor.m_bufferOffset;
+            VmbUint32_t const bufferSize = descriptor.m_bufferSize;
+            VmbUint32_t const imageOffset = descriptor.m_imageOffset;
+            VmbUint32_t const slot = descriptor.m_slot;
+            VmbUint32_t const generation = descriptor.m_generation;
+            VmbUint32_t const pixelFormat = descriptor.m_pixelFormat;
+            VmbUint32_t const width = descriptor.m_width;
+            VmbUint32_t const height = descriptor.m_height;
+            VmbUint32_t const offsetX = descriptor.m_offsetX;
+            VmbUint32_t const offsetY = descriptor.m_offsetY;
+            VmbInt32_t const receiveStatus = descriptor.m_receiveStatus;
+            VmbUint32_t const receiveFlags = descriptor.m_receiveFlags;
+            FrameMetadata const metadata = descriptor.m_metadata;
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (descriptor.m_sequence.load(std::memory_order_relaxed) != sequence
+                || slot >= m_header->m_slotCount || bufferOffset + bufferSize > m_memory.GetSize() || imageOffset > bufferSize)
+            {
+                return false;
+            }
+
+            auto& state = reinterpret_cast<Slot*>(m_memory.GetData() + GetSlotOffset(slot))->m_state;
+            VmbUint64_t current = state.load(std::memory_order_relaxed);
+            do
+            {
+                if (GetGeneration(current) != generation)
+                {
+                    return false;
+                }
+            } while (!state.compare_exchange_weak(current, current + 1, std::memory_order_acq_rel));
+
+            frame.Release();
+            std::memset(&frame.m_frame, 0, sizeof(frame.m_frame));
+            frame.m_frame.buffer = m_memory.GetData() + bufferOffset;
+            frame.m_frame.bufferSize = bufferSize;
+            frame.m_frame.imageData = m_memory.GetData() + bufferOffset + imageOffset;
+            frame.m_frame.frameID = frameId;
+            frame.m_frame.timestamp = timestamp;
+            frame.m_frame.pixelFormat = pixelFormat;
+            frame.m_frame.width = width;
+            frame.m_frame.height = height;
+            frame.m_frame.offsetX = offsetX;
+            frame.m_frame.offsetY = offsetY;
+            frame.m_frame.receiveStatus = receiveStatus;
+            frame.m_frame.receiveFlags = receiveFlags;
+            frame.m_metadata = metadata;
+            frame.m_publishTime = Clock::time_point(std::chrono::duration_cast<Clock::duration>(std::chrono::nanoseconds(publishTime)));
+            frame.m_slot = reinterpret_cast<Slot*>(m_memory.GetData() + GetSlotOffset(slot));
+            frame.m_header = m_header;
+            frame.m_generation = generation;
+            return true;
+        }
+
+        bool SharedFrameReader::WaitForFrame(FrameReference& frame, std::chrono::milliseconds const timeout)
+        /* 先读取futex字再检查序号，这样在两者之间发布的帧会使等待立即返回，不会错过通知。
+        落后超过描述符环大小的帧已被覆盖，直接跳到环中最旧的帧并计入跳过的帧数。 */
+        {
+            frame.Release();
+            auto const deadline = Clock::now() + timeout;
+            while (true)
+            {
+                VmbUint32_t const publishCount = m_header->m_publishCount.load(std::memory_order_acquire);
+                VmbUint64_t const latest = m_header->m_sequence.load(std::memory_order_acquire);
+                while (m_nextSequence <= latest)
+                {
+                    if (latest - m_nextSequence >= RingSize)
+                    {
+                        m_framesSkipped += latest - m_nextSequence + 1 - RingSize;
+                        m_nextSequence = latest + 1 - RingSize;
+                    }
+                    if (TryAcquire(m_nextSequence++, frame))
+                    {
+                        return true;
+                    }
+                    ++m_framesSkipped;
+                }
+
+                auto const now = Clock::now();
+                if (IsClosed() || now >= deadline)
+                {
+                    return false;
+                }
+                SharedMemory::Wait(m_header->m_publishCount, publishCount,
+                                   std::chrono::duration_cast<std::chrono::milliseconds>(deadline - now) + std::chrono::milliseconds(1));
+            }
+        }
+    }
+}
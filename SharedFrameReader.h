@@ -0,0 +1,173 @@
+/**
+ * \date 2023
+ * \copyright Allied Vision Technologies.  All Rights Reserved.
+ *
+ * \copyright Redistribution of this file, in original or modified form, without
+ *            prior written consent of Allied Vision Technologies is prohibited.
+ *
+ * \warning THIS SOFTWARE IS PROVIDED BY THE AUTHOR "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF TITLE,
+ * NON-INFRINGEMENT, MERCHANTABILITY AND FITNESS FOR A PARTICULAR  PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \brief Definition of a reader of the frames exported via shared memory
+ */
+
+#ifndef ASYNCHRONOUSGRAB_C_SHARED_FRAME_READER_H
+#define ASYNCHRONOUSGRAB_C_SHARED_FRAME_READER_H
+
+#include <chrono>
+#include <string>
+
+#include <VmbC/VmbC.h>
+
+#include "SharedFrameFormat.h"
+#include "SharedMemory.h"
+
+namespace VmbC
+{
+    namespace Examples
+    {
+        /**
+         * \brief Maps the frames exported by SharedFrameExport of another
+         *        process without copying them.
+         *
+         * The frames are returned in the order published. A reader lagging
+         * behind by more than SharedFrameFormat::RingSize frames or trying
+         * to take a frame whose buffer was already handed back to the
+         * camera skips the frame. A frame referenced by a reader is not
+         * overwritten until the reader releases it, but the camera runs
+         * out of buffers, if frames are held for long; the writer reclaims
+         * frames held longer than its reader timeout.
+         *
+         * An object may only be used by one thread at a time.
+         */
+        class SharedFrameReader
+        {
+        public:
+            using Clock = std::chrono::steady_clock;
+
+            /**
+             * \brief a reference to a frame in the shared memory released on
+             *        destruction
+             */
+            class FrameReference
+            {
+            public:
+                FrameReference() noexcept = default;
+                ~FrameReference();
+
+                FrameReference(FrameReference const&) = delete;
+                FrameReference& operator=(FrameReference const&) = delete;
+
+                FrameReference(FrameReference&& other) noexcept;
+                FrameReference& operator=(FrameReference&& other) noexcept;
+
+                /**
+                 * \brief the frame with buffer and imageData pointing into the
+                 *        shared memory; the context members are null
+                 */
+                VmbFrame_t const& GetFrame() const noexcept
+                {
+                    return m_frame;
+                }
+
+                /**
+                 * \brief the metadata published with the frame
+                 */
+                FrameMetadata const& GetMetadata() const noexcept
+                {
+                    return m_metadata;
+                }
+
+                /**
+                 * \brief the time the writer published the frame
+                 */
+                Clock::time_point GetPublishTime() const noexcept
+                {
+                    return m_publishTime;
+                }
+
+                bool IsValid() const noexcept
+                {
+                    return m_slot != nullptr;
+                }
+
+                /**
+                 * \brief release the frame before the destruction
+                 */
+                void Release() noexcept;
+            private:
+                friend class SharedFrameReader;
+
+                VmbFrame_t m_frame {};
+                FrameMetadata m_metadata {};
+                Clock::time_point m_publishTime;
+                SharedFrameFormat::Slot* m_slot { nullptr };
+                SharedFrameFormat::Header* m_header { nullptr };
+                VmbUint32_t m_generation { 0 };
+            };
+
+            /**
+             * \brief map the region and attach as reader; only frames
+             *        published afterwards are returned
+             * \throws VmbException, if the region does not exist or has an
+             *                      unknown format
+             */
+            SharedFrameReader(std::string const& name);
+
+            /**
+             * \brief detaches; frames still referenced need to be released
+             *        before
+             */
+            ~SharedFrameReader();
+
+            SharedFrameReader(SharedFrameReader const&) = delete;
+            SharedFrameReader& operator=(SharedFrameReader const&) = delete;
+
+            /**
+             * \brief wait for the next frame and take a reference to it; a
+             *        frame referenced by the object passed is released first
+             * \return false, if no frame was published before the timeout
+             *         or the export was stopped
+             */
+            bool WaitForFrame(FrameReference& frame, std::chrono::milliseconds timeout);
+
+            /**
+             * \return true, if the writer stopped the export
+             */
+            bool IsClosed() const noexcept;
+
+            /**
+             * \brief the number of frames published, but not returned
+             */
+            VmbUint64_t GetFramesSkipped() const noexcept
+            {
+                return m_framesSkipped;
+            }
+        private:
+            SharedMemory m_memory;
+            SharedFrameFormat::Header* m_header { nullptr };
+
+            /**
+             * \brief the sequence of the next frame to return
+             */
+            VmbUint64_t m_nextSequence { 1 };
+            VmbUint64_t m_framesSkipped { 0 };
+
+            /**
+             * \brief take a reference to the frame with the given sequence
+             * \return false, if the descriptor or the buffer was reused
+             */
+            bool TryAcquire(VmbUint64_t sequence, FrameReference& frame) noexcept;
+        };
+    }
+}
+
+#endif
@@ -0,0 +1,200 @@
+/**
+ * \date 2023
+ * \copyright Allied Vision Technologies.  All Rights Reserved.
+ *
+ * \copyright Redistribution of this file, in original or modified form, without
+ *            prior written consent of Allied Vision Technologies is prohibited.
+ *
+ * \warning THIS SOFTWARE IS PROVIDED BY THE AUTHOR "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF TITLE,
+ * NON-INFRINGEMENT, MERCHANTABILITY AND FITNESS FOR A PARTICULAR  PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \brief Implementation of ::VmbC::Examples::SharedMemory
+ */
+
+#include <climits>
+#include <cstring>
+#include <thread>
+
+#include "SharedMemory.h"
+#include "VmbException.h"
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <time.h>
+#endif
+
+namespace VmbC
+{
+    namespace Examples
+    {
+        SharedMemory::~SharedMemory()
+        {
+            Close();
+        }
+
+        void SharedMemory::Close() noexcept
+        {
+#ifdef _WIN32
+            if (m_data != nullptr)
+            {
+                UnmapViewOfFile(m_data);
+            }
+            if (m_mapping != nullptr)
+            {
+                CloseHandle(m_mapping);
+            }
+            m_mapping = nullptr;
+#else
+            if (m_data != nullptr)
+            {
+                munmap(m_data, m_size);
+            }
+            if (m_owner)
+            {
+                shm_unlink(m_name.c_str());
+            }
+#endif
+            m_data = nullptr;
+            m_size = 0;
+            m_owner = false;
+        }
+
+        void SharedMemory::Create(std::string const& name, size_t const size)
+        /* POSIX：先删除同名的旧区域（例如崩溃的进程留下的），创建后用ftruncate设置大小，新的页面内容为0。
+        Windows：创建由页面文件支持的命名文件映射，只要有进程打开它就一直存在。 */
+        {
+            Close();
+#ifdef _WIN32
+            std::string const mappingName = "Local\\" + name;
+            m_mapping = CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE,
+                                           static_cast<DWORD>(static_cast<VmbUint64_t>(size) >> 32), static_cast<DWORD>(size),
+                                           mappingName.c_str());
+            if (m_mapping == nullptr)
+            {
+                throw VmbException("Unable to create shared memory " + name);
+            }
+            m_data = static_cast<unsigned char*>(MapViewOfFile(m_mapping, FILE_MAP_ALL_ACCESS, 0, 0, size));
+            if (m_data == nullptr)
+            {
+                Close();
+                throw VmbException("Unable to map shared memory " + name);
+            }
+#else
+            shm_unlink(name.c_str());
+            int const fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+            if (fd < 0)
+            {
+                throw VmbException("Unable to create shared memory " + name + ": " + std::strerror(errno));
+            }
+            if (ftruncate(fd, static_cast<off_t>(size)) != 0)
+            {
+                int const error = errno;
+                close(fd);
+                shm_unlink(name.c_str());
+                throw VmbException("Unable to allocate shared memory " + name + ": " + std::strerror(error));
+            }
+            void* const data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            close(fd);
+            if (data == MAP_FAILED)
+            {
+                shm_unlink(name.c_str());
+                throw VmbException("Unable to map shared memory " + name);
+            }
+            m_data = static_cast<unsigned char*>(data);
+#endif
+            m_name = name;
+            m_size = size;
+            m_owner = true;
+        }
+
+        void SharedMemory::Open(std::string const& name)
+        {
+            Close();
+#ifdef _WIN32
+            std::string const mappingName = "Local\\" + name;
+            m_mapping = OpenFileMappingA(FILE_MAP_ALL_ACCESS, FALSE, mappingName.c_str());
+            if (m_mapping == nullptr)
+            {
+                throw VmbException("Unable to open shared memory " + name);
+            }
+            m_data = static_cast<unsigned char*>(MapViewOfFile(m_mapping, FILE_MAP_ALL_ACCESS, 0, 0, 0));
+            MEMORY_BASIC_INFORMATION info;
+            if (m_data == nullptr || VirtualQuery(m_data, &info, sizeof(info)) == 0)
+            {
+                Close();
+                throw VmbException("Unable to map shared memory " + name);
+            }
+            m_size = info.RegionSize;
+#else
+            int const fd = shm_open(name.c_str(), O_RDWR, 0);
+            if (fd < 0)
+            {
+                throw VmbException("Unable to open shared memory " + name + ": " + std::strerror(errno));
+            }
+            struct stat status;
+            if (fstat(fd, &status) != 0 || status.st_size <= 0)
+            {
+                close(fd);
+                throw VmbException("Unable to query the size of shared memory " + name);
+            }
+            size_t const size = static_cast<size_t>(status.st_size);
+            void* const data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            close(fd);
+            if (data == MAP_FAILED)
+            {
+                throw VmbException("Unable to map shared memory " + name);
+            }
+            m_data = static_cast<unsigned char*>(data);
+            m_size = size;
+#endif
+            m_name = name;
+        }
+
+        void SharedMemory::Wait(std::atomic<VmbUint32_t>& word, VmbUint32_t const value, std::chrono::milliseconds const timeout) noexcept
+        /* Linux：在共享映射上使用非私有的FUTEX_WAIT，其他进程修改该字之后调用WakeAll即可唤醒；值已经改变时立即返回。
+        其他系统没有跨进程的等价机制，每毫秒检查一次该字。 */
+        {
+#ifdef __linux__
+            static_assert(sizeof(std::atomic<VmbUint32_t>) == sizeof(VmbUint32_t), "futex word must be a plain 32 bit integer");
+            struct timespec relative;
+            relative.tv_sec = static_cast<time_t>(timeout.count() / 1000);
+            relative.tv_nsec = static_cast<long>(timeout.count() % 1000) * 1000000;
+            syscall(SYS_futex, reinterpret_cast<VmbUint32_t*>(&word), FUTEX_WAIT, value, &relative, nullptr, 0);
+#else
+            auto const end = std::chrono::steady_clock::now() + timeout;
+            while (word.load(std::memory_order_acquire) == value && std::chrono::steady_clock::now() < end)
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+#endif
+        }
+
+        void SharedMemory::WakeAll(std::atomic<VmbUint32_t>& word) noexcept
+        {
+#ifdef __linux__
+            syscall(SYS_futex, reinterpret_cast<VmbUint32_t*>(&word), FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+#else
+            (void)word;
+#endif
+        }
+    }
+}
@@ -0,0 +1,111 @@
+/**
+ * \date 2023
+ * \copyright Allied Vision Technologies.  All Rights Reserved.
+ *
+ * \copyright Redistribution of this file, in original or modified form, without
+ *            prior written consent of Allied Vision Technologies is prohibited.
+ *
+ * \warning THIS SOFTWARE IS PROVIDED BY THE AUTHOR "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF TITLE,
+ * NON-INFRINGEMENT, MERCHANTABILITY AND FITNESS FOR A PARTICULAR  PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \brief Definition of a named shared memory region
+ */
+
+#ifndef ASYNCHRONOUSGRAB_C_SHARED_MEMORY_H
+#define ASYNCHRONOUSGRAB_C_SHARED_MEMORY_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <string>
+
+#include <VmbC/VmbC.h>
+
+namespace VmbC
+{
+    namespace Examples
+    {
+        /**
+         * \brief A named shared memory region mapped into the address space
+         *        of the process hiding the differences between POSIX shared
+         *        memory and Windows file mappings
+         *
+         * Also provides waiting for and waking up waiters on a 32 bit word
+         * in the region across processes: via futex on Linux, elsewhere by
+         * polling the word every millisecond.
+         */
+        class SharedMemory
+        {
+        public:
+            SharedMemory() noexcept = default;
+
+            /**
+             * \brief unmaps the region; the creator also removes the name
+             */
+            ~SharedMemory();
+
+            SharedMemory(SharedMemory const&) = delete;
+            SharedMemory& operator=(SharedMemory const&) = delete;
+
+            /**
+             * \brief create and map a zero-initialized region; an existing
+             *        region with the same name is replaced
+             * \param[in] name the name of the region, e.g. "/AsynchronousGrab"
+             * \throws VmbException, if the region cannot be created
+             */
+            void Create(std::string const& name, size_t size);
+
+            /**
+             * \brief map the complete region created by another process
+             * \throws VmbException, if the region does not exist
+             */
+            void Open(std::string const& name);
+
+            unsigned char* GetData() const noexcept
+            {
+                return m_data;
+            }
+
+            size_t GetSize() const noexcept
+            {
+                return m_size;
+            }
+
+            /**
+             * \brief wait until the word does not contain a value anymore, it
+             *        is woken up or the timeout expires; spurious wakeups are
+             *        possible
+             */
+            static void Wait(std::atomic<VmbUint32_t>& word, VmbUint32_t value, std::chrono::milliseconds timeout) noexcept;
+
+            /**
+             * \brief wake up all threads of all processes waiting on the word
+             */
+            static void WakeAll(std::atomic<VmbUint32_t>& word) noexcept;
+        private:
+            std::string m_name;
+            unsigned char* m_data { nullptr };
+            size_t m_size { 0 };
+
+            /**
+             * \brief true, if this object created the region
+             */
+            bool m_owner { false };
+#ifdef _WIN32
+            void* m_mapping { nullptr };
+#endif
+
+            void Close() noexcept;
+        };
+    }
+}
+
+#endif
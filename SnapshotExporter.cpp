@@ -0,0 +1,528 @@
+/**
+ * \date 2023
+ * \copyright Allied Vision Technologies.  All Rights Reserved.
+ *
+ * \copyright Redistribution of this file, in original or modified form, without
+ *            prior written consent of Allied Vision Technologies is prohibited.
+ *
+ * \warning THIS SOFTWARE IS PROVIDED BY THE AUTHOR "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF TITLE,
+ * NON-INFRINGEMENT, MERCHANTABILITY AND FITNESS FOR A PARTICULAR  PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \brief Implementation of ::VmbC::Examples::SnapshotExporter
+ */
+
+#include <algorithm>
+#include <cstring>
+#include <ctime>
+#include <new>
+
+#include "Image.h"
+#include "SnapshotExporter.h"
+#include "Tracing.h"
+#include "VmbException.h"
+
+namespace VmbC
+{
+    namespace Examples
+    {
+        namespace
+        {
+            enum class Packing
+            {
+                Grey8,
+                Grey16,
+                Packed12,
+                P12,
+                Rgb8,
+                Bgr8,
+                Rgba8,
+                Bgra8,
+                Rgb16,
+                Unsupported
+            };
+
+            struct SourceLayout
+            {
+                Packing m_packing;
+                unsigned m_significantBits;
+                bool m_bayer;
+            };
+
+            SourceLayout GetSourceLayout(VmbPixelFormat_t const pixelFormat) noexcept
+            {
+                switch (pixelFormat)
+                {
+                case VmbPixelFormatMono8:
+                    return { Packing::Grey8, 8, false };
+                case VmbPixelFormatMono10:
+                    return { Packing::Grey16, 10, false };
+                case VmbPixelFormatMono12:
+                    return { Packing::Grey16, 12, false };
+                case VmbPixelFormatMono14:
+                    return { Packing::Grey16, 14, false };
+                case VmbPixelFormatMono16:
+                    return { Packing::Grey16, 16, false };
+                case VmbPixelFormatMono12Packed:
+                    return { Packing::Packed12, 12, false };
+                case VmbPixelFormatMono12p:
+                    return { Packing::P12, 12, false };
+                case VmbPixelFormatBayerGR8:
+                case VmbPixelFormatBayerRG8:
+                case VmbPixelFormatBayerGB8:
+                case VmbPixelFormatBayerBG8:
+                    return { Packing::Grey8, 8, true };
+                case VmbPixelFormatBayerGR10:
+                case VmbPixelFormatBayerRG10:
+                case VmbPixelFormatBayerGB10:
+                case VmbPixelFormatBayerBG10:
+                    return { Packing::Grey16, 10, true };
+                case VmbPixelFormatBayerGR12:
+                case VmbPixelFormatBayerRG12:
+                case VmbPixelFormatBayerGB12:
+                case VmbPixelFormatBayerBG12:
+                    return { Packing::Grey16, 12, true };
+                case VmbPixelFormatBayerGR16:
+                case VmbPixelFormatBayerRG16:
+                case VmbPixelFormatBayerGB16:
+                case VmbPixelFormatBayerBG16:
+                    return { Packing::Grey16, 16, true };
+                case VmbPixelFormatBayerGR12Packed:
+                case VmbPixelFormatBayerRG12Packed:
+                case VmbPixelFormatBayerGB12Packed:
+                case VmbPixelFormatBayerBG12Packed:
+                    return { Packing::Packed12, 12, true };
+                case VmbPixelFormatBayerGR12p:
+                case VmbPixelFormatBayerRG12p:
+                case VmbPixelFormatBayerGB12p:
+                case VmbPixelFormatBayerBG12p:
+                    return { Packing::P12, 12, true };
+                case VmbPixelFormatRgb8:
+                    return { Packing::Rgb8, 8, false };
+                case VmbPixelFormatBgr8:
+                    return { Packing::Bgr8, 8, false };
+                case VmbPixelFormatRgba8:
+                    return { Packing::Rgba8, 8, false };
+                case VmbPixelFormatBgra8:
+                    return { Packing::Bgra8, 8, false };
+                case VmbPixelFormatRgb16:
+                    return { Packing::Rgb16, 16, false };
+                default:
+                    return { Packing::Unsupported, 8, false };
+                }
+            }
+
+            size_t GetSourceRowSize(Packing const packing, size_t const width) noexcept
+            {
+                switch (packing)
+                {
+                case Packing::Grey8:
+                    return width;
+                case Packing::Grey16:
+                    return 2 * width;
+                case Packing::Packed12:
+                case Packing::P12:
+                    return (3 * width + 1) / 2;
+                case Packing::Rgb8:
+                case Packing::Bgr8:
+                    return 3 * width;
+                case Packing::Rgba8:
+                case Packing::Bgra8:
+                    return 4 * width;
+                case Packing::Rgb16:
+                    return 6 * width;
+                default:
+                    return 0;
+                }
+            }
+
+            /**
+             * \brief copy a row into the raster; 16 bit samples are shifted
+             *        to the most significant bit
+             */
+            void ConvertRow(SourceLayout const& layout, unsigned char const* source, unsigned char* const target, size_t const width) noexcept
+            {
+                unsigned const shift = 16 - layout.m_significantBits;
+                auto const store = [target, shift](size_t index, unsigned sample)
+                {
+                    VmbUint16_t const value = static_cast<VmbUint16_t>(sample << shift);
+                    std::memcpy(target + 2 * index, &value, sizeof(value));
+                };
+
+                switch (layout.m_packing)
+                {
+                case Packing::Grey8:
+                    std::memcpy(target, source, width);
+                    break;
+                case Packing::Grey16:
+                case Packing::Rgb16:
+                    for (size_t i = 0, count = (layout.m_packing == Packing::Rgb16) ? 3 * width : width; i != count; ++i, source += 2)
+                    {
+                        store(i, source[0] | (source[1] << 8));
+                    }
+                    break;
+                case Packing::Packed12:
+                    for (size_t i = 0; i < width; i += 2, source += 3)
+                    {
+                        store(i, (source[0] << 4) | (source[1] & 0x0F));
+                        if (i + 1 != width)
+                        {
+                            store(i + 1, (source[2] << 4) | (source[1] >> 4));
+                        }
+                    }
+                    break;
+                case Packing::P12:
+                    for (size_t i = 0; i < width; i += 2, source += 3)
+                    {
+                        store(i, source[0] | ((source[1] & 0x0F) << 8));
+                        if (i + 1 != width)
+                        {
+                            store(i + 1, (source[1] >> 4) | (source[2] << 4));
+                        }
+                    }
+                    break;
+                case Packing::Rgb8:
+                    std::memcpy(target, source, 3 * width);
+                    break;
+                case Packing::Bgr8:
+                case Packing::Rgba8:
+                case Packing::Bgra8:
+                    {
+                        bool const swap = (layout.m_packing != Packing::Rgba8);
+                        size_t const step = (layout.m_packing == Packing::Bgr8) ? 3 : 4;
+                        for (size_t i = 0; i != width; ++i, source += step)
+                        {
+                            target[3 * i] = source[swap ? 2 : 0];
+                            target[3 * i + 1] = source[1];
+                            target[3 * i + 2] = source[swap ? 0 : 2];
+                        }
+                    }
+                    break;
+                default:
+                    break;
+                }
+            }
+
+            void ToRaster(VmbFrame_t const& frame, SourceLayout const& layout, ImageFile::Raster& raster)
+            /* 保留完整位深度：Mono/Bayer的10～16位（包括12位打包格式）解包为16位样本并左对齐到最高位，
+               有效位数写入文件（PNG的sBIT块）；Bayer帧保存为未插值的原始马赛克灰度图像。 */
+            {
+                size_t const rowSize = GetSourceRowSize(layout.m_packing, frame.width);
+                unsigned char const* const buffer = static_cast<unsigned char const*>(frame.buffer);
+                unsigned char const* const image = static_cast<unsigned char const*>(frame.imageData);
+                if (image < buffer || static_cast<size_t>(image - buffer) + rowSize * frame.height > frame.bufferSize)
+                {
+                    throw VmbException("the frame buffer does not contain the complete image", VmbErrorInvalidValue);
+                }
+
+                bool const colour = (layout.m_packing == Packing::Rgb8 || layout.m_packing == Packing::Bgr8
+                                     || layout.m_packing == Packing::Rgba8 || layout.m_packing == Packing::Bgra8
+                                     || layout.m_packing == Packing::Rgb16);
+                raster.m_width = frame.width;
+                raster.m_height = frame.height;
+                raster.m_channels = colour ? 3 : 1;
+                raster.m_bitsPerSample = (layout.m_significantBits > 8) ? 16 : 8;
+                raster.m_significantBits = layout.m_significantBits;
+                raster.m_data.resize(raster.GetRowSize() * raster.m_height);
+
+                for (VmbUint32_t y = 0; y != frame.height; ++y)
+                {
+                    ConvertRow(layout, image + y * rowSize, raster.m_data.data() + y * raster.GetRowSize(), frame.width);
+                }
+            }
+
+            void ToEightBitRaster(VmbFrame_t const& frame, SourceLayout const& layout, ImageFile::Raster& raster)
+            {
+                bool const grey = !layout.m_bayer
+                    && (layout.m_packing == Packing::Grey8 || layout.m_packing == Packing::Grey16
+                        || layout.m_packing == Packing::Packed12 || layout.m_packing == Packing::P12);
+                Image const source(frame);
+                Image target(grey ? VmbPixelFormatMono8 : VmbPixelFormatRgb8);
+                target.Convert(source);
+
+                raster.m_width = static_cast<VmbUint32_t>(target.GetWidth());
+                raster.m_height = static_cast<VmbUint32_t>(target.GetHeight());
+                raster.m_channels = grey ? 1 : 3;
+                raster.m_bitsPerSample = 8;
+                raster.m_significantBits = 8;
+                size_t const rowSize = raster.GetRowSize();
+                raster.m_data.resize(rowSize * raster.m_height);
+                for (VmbUint32_t y = 0; y != raster.m_height; ++y)
+                {
+                    std::memcpy(raster.m_data.data() + y * rowSize, target.GetData() + y * static_cast<size_t>(target.GetBytesPerLine()), rowSize);
+                }
+            }
+
+            /**
+             * \brief format the local time for file names
+             */
+            std::string GetRequestTime()
+            {
+                std::time_t const now = std::time(nullptr);
+                std::tm local;
+#ifdef _WIN32
+                localtime_s(&local, &now);
+#else
+                localtime_r(&now, &local);
+#endif
+                char text[32];
+                std::strftime(text, sizeof(text), "%Y%m%d_%H%M%S", &local);
+                return text;
+            }
+        }
+
+        SnapshotExporter::SnapshotExporter(Settings const& settings)
+            : m_settings(settings),
+            m_recent(settings.m_recentFrames)
+        {
+            for (unsigned i = 0; i != (std::max)(settings.m_threads, 1u); ++i)
+            {
+                m_threads.emplace_back(&SnapshotExporter::Encode, this);
+            }
+        }
+
+        SnapshotExporter::~SnapshotExporter()
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_stop = true;
+                m_backlog -= m_reservations.size();
+                m_reservations.clear();
+                m_reserved.store(0, std::memory_order_release);
+            }
+            m_condition.notify_all();
+            for (auto& thread : m_threads)
+            {
+                thread.join();
+            }
+        }
+
+        void SnapshotExporter::FrameReceived(VmbFrame_t const& frame)
+        /* 帧回调线程中：没有预留的截图请求时只读取一个原子变量后立即返回（保留最近帧时另外复制一次帧）。
+           有预留时复制帧缓冲区（重用已保存帧的缓冲区），复制在锁外进行，转换和写文件由编码线程完成。 */
+        {
+            if (frame.receiveStatus != VmbFrameStatusComplete)
+            {
+                return;
+            }
+
+            if (!m_recent.empty())
+            {
+                std::lock_guard<std::mutex> lock(m_recentMutex);
+                CopyFrame(frame, m_recent[m_recentNext]);
+                m_recentNext = (m_recentNext + 1) % m_recent.size();
+                m_recentCount = (std::min)(m_recentCount + 1, m_recent.size());
+            }
+
+            if (m_reserved.load(std::memory_order_acquire) == 0)
+            {
+                return;
+            }
+
+            ASYNCHRONOUSGRAB_TRACE_SCOPE("CopySnapshot", frame.frameID);
+            Job job;
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                if (m_reservations.empty())
+                {
+                    return;
+                }
+                job.m_requestTime = std::move(m_reservations.front());
+                m_reservations.pop_front();
+                m_reserved.store(m_reservations.size(), std::memory_order_release);
+                job.m_buffer = TakeBuffer();
+            }
+            try
+            {
+                CopyFrame(frame, job);
+            }
+            catch (std::bad_alloc const&)
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                --m_backlog;
+                ++m_framesFailed;
+                return;
+            }
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_queue.push_back(std::move(job));
+            }
+            m_condition.notify_one();
+        }
+
+        size_t SnapshotExporter::Capture(size_t const count)
+        {
+            std::string const requestTime = GetRequestTime();
+            std::lock_guard<std::mutex> lock(m_mutex);
+            size_t const accepted = (std::min)(count, m_settings.m_queueSize - (std::min)(m_backlog, m_settings.m_queueSize));
+            m_reservations.insert(m_reservations.end(), accepted, requestTime);
+            m_backlog += accepted;
+            m_reserved.store(m_reservations.size(), std::memory_order_release);
+            m_framesRejected += count - accepted;
+            return accepted;
+        }
+
+        size_t SnapshotExporter::CaptureRecent(size_t const count)
+        /* 按从旧到新的顺序复制保留的最近帧；持有m_recentMutex期间帧回调中保留最近帧的复制会等待，
+           因此只在GUI线程中请求时短暂发生。 */
+        {
+            std::string const requestTime = GetRequestTime();
+            std::vector<Job> jobs;
+            {
+                std::lock_guard<std::mutex> recentLock(m_recentMutex);
+                size_t const requested = (std::min)(count, m_recentCount);
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    size_t const accepted = (std::min)(requested, m_settings.m_queueSize - (std::min)(m_backlog, m_settings.m_queueSize));
+                    m_backlog += accepted;
+                    m_framesRejected += requested - accepted;
+                    jobs.resize(accepted);
+                    for (auto& job : jobs)
+                    {
+                        job.m_buffer = TakeBuffer();
+                    }
+                }
+                for (size_t i = 0; i != jobs.size(); ++i)
+                {
+                    Job const& recent = m_recent[(m_recentNext + m_recent.size() - jobs.size() + i) % m_recent.size()];
+                    CopyFrame(recent.m_frame, jobs[i]);
+                    jobs[i].m_requestTime = requestTime;
+                }
+            }
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                for (auto& job : jobs)
+                {
+                    m_queue.push_back(std::move(job));
+                }
+            }
+            m_condition.notify_all();
+            return jobs.size();
+        }
+
+        SnapshotExporter::Statistics SnapshotExporter::GetStatistics() const
+        {
+            Statistics statistics;
+            statistics.m_framesSaved = m_framesSaved.load(std::memory_order_relaxed);
+            statistics.m_framesFailed = m_framesFailed.load(std::memory_order_relaxed);
+            statistics.m_framesRejected = m_framesRejected.load(std::memory_order_relaxed);
+            statistics.m_queueSize = m_settings.m_queueSize;
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                statistics.m_backlog = m_backlog;
+            }
+            VmbUint64_t const encoded = statistics.m_framesSaved + statistics.m_framesFailed;
+            if (encoded != 0)
+            {
+                statistics.m_averageEncodeTime = Clock::duration(m_encodeTime.load(std::memory_order_relaxed) / static_cast<Clock::rep>(encoded));
+            }
+            return statistics;
+        }
+
+        void SnapshotExporter::CopyFrame(VmbFrame_t const& frame, Job& job)
+        {
+            unsigned char const* const buffer = static_cast<unsigned char const*>(frame.buffer);
+            job.m_buffer.assign(buffer, buffer + frame.bufferSize);
+            job.m_frame = frame;
+            job.m_frame.buffer = job.m_buffer.data();
+            job.m_frame.imageData = job.m_buffer.data() + (static_cast<unsigned char const*>(frame.imageData) - buffer);
+        }
+
+        std::vector<unsigned char> SnapshotExporter::TakeBuffer()
+        {
+            std::vector<unsigned char> buffer;
+            if (!m_freeBuffers.empty())
+            {
+                buffer = std::move(m_freeBuffers.back());
+                m_freeBuffers.pop_back();
+            }
+            return buffer;
+        }
+
+        void SnapshotExporter::Encode()
+        {
+            ASYNCHRONOUSGRAB_TRACE_THREAD_NAME("SnapshotEncoder");
+
+            ImageFile::Raster raster;
+            while (true)
+            {
+                Job job;
+                {
+                    std::unique_lock<std::mutex> lock(m_mutex);
+                    m_condition.wait(lock, [this]() { return m_stop || !m_queue.empty(); });
+                    if (m_queue.empty())
+                    {
+                        return;
+                    }
+                    job = std::move(m_queue.front());
+                    m_queue.pop_front();
+                }
+
+                Result result;
+                result.m_frameId = job.m_frame.frameID;
+                auto const start = Clock::now();
+                try
+                {
+                    ASYNCHRONOUSGRAB_TRACE_SCOPE("EncodeSnapshot", job.m_frame.frameID);
+                    result.m_fileName = Save(job, raster);
+                    result.m_success = true;
+                    ++m_framesSaved;
+                }
+                catch (VmbException const& ex)
+                {
+                    result.m_error = ex.what();
+                    ++m_framesFailed;
+                }
+                catch (std::bad_alloc const&)
+                {
+                    result.m_error = "not enough memory to convert the frame";
+                    ++m_framesFailed;
+                }
+                m_encodeTime += (Clock::now() - start).count();
+
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    --m_backlog;
+                    if (m_freeBuffers.size() < m_settings.m_queueSize)
+                    {
+                        m_freeBuffers.push_back(std::move(job.m_buffer));
+                    }
+                }
+                if (m_settings.m_finished)
+                {
+                    m_settings.m_finished(result);
+                }
+            }
+        }
+
+        std::string SnapshotExporter::Save(Job const& job, ImageFile::Raster& raster)
+        {
+            std::string fileName = m_settings.m_directory;
+            if (!fileName.empty() && fileName.back() != '/' && fileName.back() != '\\')
+            {
+                fileName += '/';
+            }
+            fileName += m_settings.m_prefix + '_' + job.m_requestTime + '_' + std::to_string(job.m_frame.frameID)
+                + ImageFile::GetExtension(m_settings.m_format);
+
+            SourceLayout const layout = GetSourceLayout(job.m_frame.pixelFormat);
+            if (m_settings.m_eightBit || layout.m_packing == Packing::Unsupported)
+            {
+                ToEightBitRaster(job.m_frame, layout, raster);
+            }
+            else
+            {
+                ToRaster(job.m_frame, layout, raster);
+            }
+            ImageFile::Write(fileName, raster, m_settings.m_format);
+            return fileName;
+        }
+    }
+}
@@ -0,0 +1,261 @@
+/**
+ * \date 2023
+ * \copyright Allied Vision Technologies.  All Rights Reserved.
+ *
+ * \copyright Redistribution of this file, in original or modified form, without
+ *            prior written consent of Allied Vision Technologies is prohibited.
+ *
+ * \warning THIS SOFTWARE IS PROVIDED BY THE AUTHOR "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF TITLE,
+ * NON-INFRINGEMENT, MERCHANTABILITY AND FITNESS FOR A PARTICULAR  PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \brief Definition of a sink saving raw frames as PNG or TIFF files
+ */
+
+#ifndef ASYNCHRONOUSGRAB_C_SNAPSHOT_EXPORTER_H
+#define ASYNCHRONOUSGRAB_C_SNAPSHOT_EXPORTER_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <VmbC/VmbC.h>
+
+#include "FrameSink.h"
+#include "ImageFile.h"
+
+namespace VmbC
+{
+    namespace Examples
+    {
+        /**
+         * \brief Saves raw frames as still images at full resolution and bit
+         *        depth in background threads.
+         *
+         * Capture reserves places in a bounded queue for the next complete
+         * frames; the frame callback only copies a frame if a place is
+         * reserved and returns immediately otherwise. Optionally copies of
+         * the most recent frames are kept for CaptureRecent. Encoder
+         * threads convert the frames to 8 or 16 bit grey or RGB samples
+         * and write PNG or TIFF files; Bayer frames are saved as the raw
+         * mosaic unless 8 bit output is selected.
+         */
+        class SnapshotExporter : public RawFrameSink
+        {
+        public:
+            using Clock = std::chrono::steady_clock;
+
+            struct Result
+            {
+                std::string m_fileName;
+                VmbUint64_t m_frameId { 0 };
+                bool m_success { false };
+
+                /**
+                 * \brief the reason for a failure
+                 */
+                std::string m_error;
+            };
+
+            struct Settings
+            {
+                /**
+                 * \brief the directory the files are written to; empty for
+                 *        the working directory
+                 */
+                std::string m_directory;
+
+                /**
+                 * \brief the start of the file names, followed by the time of
+                 *        the capture request and the frame id
+                 */
+                std::string m_prefix { "Snapshot" };
+                ImageFile::Format m_format { ImageFile::Format::Tiff };
+
+                /**
+                 * \brief convert the frames to Mono8 or Rgb8 using
+                 *        VmbImageTransform instead of keeping the bit depth
+                 */
+                bool m_eightBit { false };
+
+                /**
+                 * \brief the number of encoder threads
+                 */
+                unsigned m_threads { 2 };
+
+                /**
+                 * \brief the maximum number of frames reserved, waiting or
+                 *        being encoded; limits the memory used
+                 */
+                size_t m_queueSize { 8 };
+
+                /**
+                 * \brief the number of most recent frames kept for
+                 *        CaptureRecent; 0 to not copy frames unless requested
+                 */
+                size_t m_recentFrames { 0 };
+
+                /**
+                 * \brief called from an encoder thread after each file; may
+                 *        be empty
+                 */
+                std::function<void(Result const&)> m_finished;
+            };
+
+            struct Statistics
+            {
+                VmbUint64_t m_framesSaved { 0 };
+                VmbUint64_t m_framesFailed { 0 };
+
+                /**
+                 * \brief frames requested while the queue was full
+                 */
+                VmbUint64_t m_framesRejected { 0 };
+
+                /**
+                 * \brief frames reserved, waiting or being encoded
+                 */
+                size_t m_backlog { 0 };
+                size_t m_queueSize { 0 };
+                Clock::duration m_averageEncodeTime {};
+
+                bool IsBacklogged() const noexcept
+                {
+                    return m_backlog >= m_queueSize;
+                }
+            };
+
+            /**
+             * \brief start the encoder threads
+             */
+            SnapshotExporter(Settings const& settings);
+
+            /**
+             * \brief writes the frames already copied and stops the encoder
+             *        threads; unfulfilled reservations are discarded
+             */
+            ~SnapshotExporter();
+
+            SnapshotExporter(SnapshotExporter const&) = delete;
+            SnapshotExporter& operator=(SnapshotExporter const&) = delete;
+
+            void FrameReceived(VmbFrame_t const& frame) override;
+
+            /**
+             * \brief save the next complete frames received
+             * \return the number of frames reserved; less than requested, if
+             *         the queue is backlogged
+             */
+            size_t Capture(size_t count = 1);
+
+            /**
+             * \brief save up to count of the most recent frames kept
+             * \return the number of frames queued; limited by the frames
+             *         kept and the free places in the queue
+             */
+            size_t CaptureRecent(size_t count);
+
+            Statistics GetStatistics() const;
+        private:
+            struct Job
+            {
+                /**
+                 * \brief the frame with the buffer members referring to m_buffer
+                 */
+                VmbFrame_t m_frame;
+                std::vector<unsigned char> m_buffer;
+
+                /**
+                 * \brief the local time of the request formatted for the file name
+                 */
+                std::string m_requestTime;
+            };
+
+            Settings const m_settings;
+
+            mutable std::mutex m_mutex;
+            std::condition_variable m_condition;
+
+            /**
+             * \name State guarded by m_mutex
+             */
+            ///@{
+            std::deque<Job> m_queue;
+
+            /**
+             * \brief the request times of the frames reserved by Capture
+             */
+            std::deque<std::string> m_reservations;
+
+            /**
+             * \brief the frames reserved, queued or being encoded
+             */
+            size_t m_backlog { 0 };
+
+            /**
+             * \brief buffers of saved frames reused for new copies
+             */
+            std::vector<std::vector<unsigned char>> m_freeBuffers;
+            bool m_stop { false };
+            ///@}
+
+            /**
+             * \brief the number of entries of m_reservations; allows the
+             *        frame callback to return without locking
+             */
+            std::atomic<size_t> m_reserved { 0 };
+
+            std::mutex m_recentMutex;
+
+            /**
+             * \name State guarded by m_recentMutex
+             */
+            ///@{
+            std::vector<Job> m_recent;
+            size_t m_recentNext { 0 };
+            size_t m_recentCount { 0 };
+            ///@}
+
+            std::atomic<VmbUint64_t> m_framesSaved { 0 };
+            std::atomic<VmbUint64_t> m_framesFailed { 0 };
+            std::atomic<VmbUint64_t> m_framesRejected { 0 };
+            std::atomic<Clock::rep> m_encodeTime { 0 };
+
+            std::vector<std::thread> m_threads;
+
+            /**
+             * \brief copy a frame into a job, reusing the buffer of the job
+             */
+            static void CopyFrame(VmbFrame_t const& frame, Job& job);
+
+            /**
+             * \brief get a buffer for a new copy; requires m_mutex
+             */
+            std::vector<unsigned char> TakeBuffer();
+
+            void Encode();
+
+            /**
+             * \brief write the file of a job
+             * \throws VmbException, if the frame cannot be converted or written
+             */
+            std::string Save(Job const& job, ImageFile::Raster& raster);
+        };
+    }
+}
+
+#endif
@@ -0,0 +1,394 @@
+/**
+ * \date 2023
+ * \copyright Allied Vision Technologies.  All Rights Reserved.
+ *
+ * \copyright Redistribution of this file, in original or modified form, without
+ *            prior written consent of Allied Vision Technologies is prohibited.
+ *
+ * \warning THIS SOFTWARE IS PROVIDED BY THE AUTHOR "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF TITLE,
+ * NON-INFRINGEMENT, MERCHANTABILITY AND FITNESS FOR A PARTICULAR  PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \brief Implementation of ::VmbC::Examples::Socket
+ */
+
+#include <string>
+#include <utility>
+
+#include "Socket.h"
+#include "VmbException.h"
+
+#ifdef _WIN32
+#include <WinSock2.h>
+#include <WS2tcpip.h>
+#pragma comment(lib, "Ws2_32.lib")
+#else
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+#endif
+
+#ifdef __linux__
+#include <linux/errqueue.h>
+#endif
+
+namespace VmbC
+{
+    namespace Examples
+    {
+        namespace
+        {
+#ifdef _WIN32
+            /**
+             * \brief initializes Winsock for the lifetime of the process
+             */
+            struct WinsockLifetime
+            {
+                WinsockLifetime()
+                {
+                    WSADATA data;
+                    WSAStartup(MAKEWORD(2, 2), &data);
+                }
+
+                ~WinsockLifetime()
+                {
+                    WSACleanup();
+                }
+            };
+
+            void InitializeSocketLibrary()
+            {
+                static WinsockLifetime lifetime;
+            }
+
+            void CloseSocketHandle(Socket::Handle handle) noexcept
+            {
+                closesocket(static_cast<SOCKET>(handle));
+            }
+
+            constexpr int SendFlags = 0;
+#else
+            void InitializeSocketLibrary()
+            {
+            }
+
+            void CloseSocketHandle(Socket::Handle handle) noexcept
+            {
+                close(handle);
+            }
+
+            // report a closed connection via the return value instead of SIGPIPE
+            constexpr int SendFlags = MSG_NOSIGNAL;
+#endif
+
+            sockaddr_in MakeAddress(VmbUint16_t port, bool loopbackOnly) noexcept
+            {
+                sockaddr_in address {};
+                address.sin_family = AF_INET;
+                address.sin_port = htons(port);
+                address.sin_addr.s_addr = htonl(loopbackOnly ? INADDR_LOOPBACK : INADDR_ANY);
+                return address;
+            }
+
+            void SetTimeoutOption(Socket::Handle const handle, int const option, std::chrono::milliseconds const timeout) noexcept
+            {
+#ifdef _WIN32
+                DWORD const value = static_cast<DWORD>(timeout.count());
+#else
+                timeval value {};
+                value.tv_sec = static_cast<time_t>(timeout.count() / 1000);
+                value.tv_usec = static_cast<suseconds_t>((timeout.count() % 1000) * 1000);
+#endif
+                setsockopt(handle, SOL_SOCKET, option, reinterpret_cast<char const*>(&value), sizeof(value));
+            }
+
+            Socket CreateTcpSocket()
+            {
+                InitializeSocketLibrary();
+                Socket result(static_cast<Socket::Handle>(socket(AF_INET, SOCK_STREAM, IPPROTO_TCP)));
+                if (!result.IsValid())
+                {
+                    throw VmbException("unable to create socket");
+                }
+                return result;
+            }
+        }
+
+#ifdef _WIN32
+        Socket::Handle const Socket::InvalidHandle = static_cast<Socket::Handle>(INVALID_SOCKET);
+#else
+        Socket::Handle const Socket::InvalidHandle = -1;
+#endif
+
+        Socket::Socket() noexcept
+            : m_handle(InvalidHandle)
+        {
+        }
+
+        Socket::Socket(Handle handle) noexcept
+            : m_handle(handle)
+        {
+        }
+
+        Socket::~Socket()
+        {
+            Close();
+        }
+
+        Socket::Socket(Socket&& other) noexcept
+            : m_handle(other.m_handle)
+        {
+            other.m_handle = InvalidHandle;
+        }
+
+        Socket& Socket::operator=(Socket&& other) noexcept
+        {
+            std::swap(m_handle, other.m_handle);
+            return *this;
+        }
+
+        Socket Socket::Listen(VmbUint16_t const port, bool const loopbackOnly)
+        /* 创建监听套接字；默认只绑定到 127.0.0.1，这样服务只能从本机访问。
+        端口为0时由操作系统选择空闲端口，可以通过 GetLocalPort 查询。 */
+        {
+            Socket result = CreateTcpSocket();
+
+            int const reuse = 1;
+            setsockopt(result.m_handle, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<char const*>(&reuse), sizeof(reuse));
+
+            sockaddr_in const address = MakeAddress(port, loopbackOnly);
+            if (bind(result.m_handle, reinterpret_cast<sockaddr const*>(&address), sizeof(address)) != 0)
+            {
+                throw VmbException("unable to bind to port " + std::to_string(port));
+            }
+            if (listen(result.m_handle, SOMAXCONN) != 0)
+            {
+                throw VmbException("unable to listen on port " + std::to_string(port));
+            }
+            return result;
+        }
+
+        Socket Socket::ConnectLocal(VmbUint16_t const port)
+        {
+            Socket result = CreateTcpSocket();
+            sockaddr_in const address = MakeAddress(port, true);
+            if (connect(result.m_handle, reinterpret_cast<sockaddr const*>(&address), sizeof(address)) != 0)
+            {
+                throw VmbException("unable to connect to port " + std::to_string(port));
+            }
+            return result;
+        }
+
+        Socket Socket::Connect(std::string const& host, VmbUint16_t const port)
+        /* 通过 getaddrinfo 解析主机名（只使用IPv4），依次尝试解析出的地址。 */
+        {
+            InitializeSocketLibrary();
+
+            addrinfo hints {};
+            hints.ai_family = AF_INET;
+            hints.ai_socktype = SOCK_STREAM;
+            hints.ai_protocol = IPPROTO_TCP;
+            addrinfo* addresses = nullptr;
+            if (getaddrinfo(host.c_str(), std::to_string(port).c_str(), &hints, &addresses) != 0 || addresses == nullptr)
+            {
+                throw VmbException("unable to resolve the host " + host);
+            }
+
+            Socket result;
+            for (addrinfo const* address = addresses; address != nullptr; address = address->ai_next)
+            {
+                Socket candidate = CreateTcpSocket();
+                if (connect(candidate.m_handle, address->ai_addr, static_cast<int>(address->ai_addrlen)) == 0)
+                {
+                    result = std::move(candidate);
+                    break;
+                }
+            }
+            freeaddrinfo(addresses);
+
+            if (!result.IsValid())
+            {
+                throw VmbException("unable to connect to " + host + ":" + std::to_string(port));
+            }
+            return result;
+        }
+
+        VmbUint16_t Socket::GetLocalPort() const
+        {
+            sockaddr_in address {};
+            socklen_t length = sizeof(address);
+            if (getsockname(m_handle, reinterpret_cast<sockaddr*>(&address), &length) != 0)
+            {
+                throw VmbException("unable to query the port of a socket");
+            }
+            return ntohs(address.sin_port);
+        }
+
+        std::string Socket::GetPeerName() const
+        {
+            sockaddr_in address {};
+            socklen_t length = sizeof(address);
+            if (getpeername(m_handle, reinterpret_cast<sockaddr*>(&address), &length) != 0)
+            {
+                return "?";
+            }
+            char text[INET_ADDRSTRLEN] = {};
+            inet_ntop(AF_INET, &address.sin_addr, text, sizeof(text));
+            return std::string(text) + ":" + std::to_string(ntohs(address.sin_port));
+        }
+
+        bool Socket::WaitReadable(std::chrono::milliseconds const timeout) const noexcept
+        {
+#ifdef _WIN32
+            WSAPOLLFD pollInfo {};
+            pollInfo.fd = static_cast<SOCKET>(m_handle);
+            pollInfo.events = POLLRDNORM;
+            return WSAPoll(&pollInfo, 1, static_cast<INT>(timeout.count())) > 0;
+#else
+            pollfd pollInfo {};
+            pollInfo.fd = m_handle;
+            pollInfo.events = POLLIN;
+            // POLLERR alone may only signal MSG_ZEROCOPY completions in the error queue; recv would block
+            return poll(&pollInfo, 1, static_cast<int>(timeout.count())) > 0 && (pollInfo.revents & (POLLIN | POLLHUP)) != 0;
+#endif
+        }
+
+        Socket Socket::Accept() const noexcept
+        {
+            return Socket(static_cast<Handle>(accept(m_handle, nullptr, nullptr)));
+        }
+
+        void Socket::SetReceiveTimeout(std::chrono::milliseconds const timeout) const noexcept
+        {
+            SetTimeoutOption(m_handle, SO_RCVTIMEO, timeout);
+        }
+
+        void Socket::SetSendTimeout(std::chrono::milliseconds const timeout) const noexcept
+        {
+            SetTimeoutOption(m_handle, SO_SNDTIMEO, timeout);
+        }
+
+        void Socket::SetNoDelay() const noexcept
+        {
+            int const enable = 1;
+            setsockopt(m_handle, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<char const*>(&enable), sizeof(enable));
+        }
+
+        bool Socket::SendAll(void const* const data, size_t size) const noexcept
+        {
+            auto pos = static_cast<char const*>(data);
+            while (size != 0)
+            {
+                auto const sent = send(m_handle, pos, static_cast<int>(size), SendFlags);
+                if (sent <= 0)
+                {
+                    return false;
+                }
+                pos += sent;
+                size -= static_cast<size_t>(sent);
+            }
+            return true;
+        }
+
+        long Socket::Receive(void* const buffer, size_t const size) const noexcept
+        {
+            return static_cast<long>(recv(m_handle, static_cast<char*>(buffer), static_cast<int>(size), 0));
+        }
+
+        bool Socket::ReceiveAll(void* const buffer, size_t const size) const noexcept
+        {
+            auto pos = static_cast<char*>(buffer);
+            for (size_t remaining = size; remaining != 0;)
+            {
+                auto const received = Receive(pos, remaining);
+                if (received <= 0)
+                {
+                    return false;
+                }
+                pos += received;
+                remaining -= static_cast<size_t>(received);
+            }
+            return true;
+        }
+
+        bool Socket::EnableZeroCopy() const noexcept
+        {
+#if defined(__linux__) && defined(SO_ZEROCOPY)
+            int const enable = 1;
+            return setsockopt(m_handle, SOL_SOCKET, SO_ZEROCOPY, &enable, sizeof(enable)) == 0;
+#else
+            return false;
+#endif
+        }
+
+        long Socket::SendZeroCopy(void const* const data, size_t const size) const noexcept
+        {
+#if defined(__linux__) && defined(MSG_ZEROCOPY)
+            return static_cast<long>(send(m_handle, data, size, SendFlags | MSG_ZEROCOPY));
+#else
+            return static_cast<long>(send(m_handle, static_cast<char const*>(data), static_cast<int>(size), SendFlags));
+#endif
+        }
+
+        bool Socket::ReceiveZeroCopyCompletion(VmbUint32_t& last, bool& copied, std::chrono::milliseconds const timeout) const noexcept
+        /* 完成通知通过套接字的错误队列传递（POLLERR），每个通知包含一段连续的调用编号 [ee_info, ee_data]。
+        回环接口上内核总是复制数据，此时 ee_code 为 SO_EE_CODE_ZEROCOPY_COPIED。 */
+        {
+#if defined(__linux__) && defined(SO_EE_ORIGIN_ZEROCOPY)
+            pollfd pollInfo {};
+            pollInfo.fd = m_handle;
+            pollInfo.events = 0;
+            if (poll(&pollInfo, 1, static_cast<int>(timeout.count())) <= 0 || (pollInfo.revents & POLLERR) == 0)
+            {
+                return false;
+            }
+
+            char control[128];
+            msghdr message {};
+            message.msg_control = control;
+            message.msg_controllen = sizeof(control);
+            if (recvmsg(m_handle, &message, MSG_ERRQUEUE | MSG_DONTWAIT) < 0)
+            {
+                return false;
+            }
+            for (cmsghdr* header = CMSG_FIRSTHDR(&message); header != nullptr; header = CMSG_NXTHDR(&message, header))
+            {
+                auto const error = reinterpret_cast<sock_extended_err const*>(CMSG_DATA(header));
+                if (error->ee_errno == 0 && error->ee_origin == SO_EE_ORIGIN_ZEROCOPY)
+                {
+                    last = error->ee_data;
+                    copied = (error->ee_code & SO_EE_CODE_ZEROCOPY_COPIED) != 0;
+                    return true;
+                }
+            }
+            return false;
+#else
+            (void)last;
+            (void)copied;
+            (void)timeout;
+            return false;
+#endif
+        }
+
+        void Socket::Close() noexcept
+        {
+            if (m_handle != InvalidHandle)
+            {
+                CloseSocketHandle(m_handle);
+                m_handle = InvalidHandle;
+            }
+        }
+    }
+}
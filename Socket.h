@@ -0,0 +1,187 @@
+/**
+ * \date 2023
+ * \copyright Allied Vision Technologies.  All Rights Reserved.
+ *
+ * \copyright Redistribution of this file, in original or modified form, without
+ *            prior written consent of Allied Vision Technologies is prohibited.
+ *
+ * \warning THIS SOFTWARE IS PROVIDED BY THE AUTHOR "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF TITLE,
+ * NON-INFRINGEMENT, MERCHANTABILITY AND FITNESS FOR A PARTICULAR  PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \brief Definition of a minimal wrapper for TCP sockets
+ */
+
+#ifndef ASYNCHRONOUSGRAB_C_SOCKET_H
+#define ASYNCHRONOUSGRAB_C_SOCKET_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include <VmbC/VmbC.h>
+
+namespace VmbC
+{
+    namespace Examples
+    {
+        /**
+         * \brief Owner of a TCP socket handle hiding the differences between
+         *        Winsock and POSIX sockets
+         */
+        class Socket
+        {
+        public:
+#ifdef _WIN32
+            using Handle = std::uintptr_t;
+#else
+            using Handle = int;
+#endif
+            static Handle const InvalidHandle;
+
+            Socket() noexcept;
+            explicit Socket(Handle handle) noexcept;
+            ~Socket();
+
+            Socket(Socket const&) = delete;
+            Socket& operator=(Socket const&) = delete;
+
+            Socket(Socket&& other) noexcept;
+            Socket& operator=(Socket&& other) noexcept;
+
+            /**
+             * \brief create a socket listening for connections
+             * \param[in] port the port to listen on; 0 chooses a free port
+             * \param[in] loopbackOnly if true, only connections from the local
+             *                         host are accepted
+             * \throws VmbException, if the port cannot be bound
+             */
+            static Socket Listen(VmbUint16_t port, bool loopbackOnly = true);
+
+            /**
+             * \brief connect to a port of the local host
+             * \throws VmbException, if the connection cannot be established
+             */
+            static Socket ConnectLocal(VmbUint16_t port);
+
+            /**
+             * \brief connect to a port of a host
+             * \param[in] host the name or the IPv4 address of the host
+             * \throws VmbException, if the connection cannot be established
+             */
+            static Socket Connect(std::string const& host, VmbUint16_t port);
+
+            bool IsValid() const noexcept
+            {
+                return m_handle != InvalidHandle;
+            }
+
+            Handle GetHandle() const noexcept
+            {
+                return m_handle;
+            }
+
+            /**
+             * \brief get the port the socket is bound to
+             */
+            VmbUint16_t GetLocalPort() const;
+
+            /**
+             * \brief get the address and the port of the peer of a
+             *        connection as text
+             */
+            std::string GetPeerName() const;
+
+            /**
+             * \brief wait until data or a connection is available for reading
+             * \return true, if the socket is readable before the timeout elapsed
+             */
+            bool WaitReadable(std::chrono::milliseconds timeout) const noexcept;
+
+            /**
+             * \brief accept a connection of a listening socket
+             * \return an invalid socket on failure
+             */
+            Socket Accept() const noexcept;
+
+            /**
+             * \brief limit the time Receive blocks
+             */
+            void SetReceiveTimeout(std::chrono::milliseconds timeout) const noexcept;
+
+            /**
+             * \brief limit the time SendAll blocks, while the peer does not
+             *        receive; SendAll fails after the timeout
+             */
+            void SetSendTimeout(std::chrono::milliseconds timeout) const noexcept;
+
+            /**
+             * \brief send small writes immediately instead of waiting for
+             *        the acknowledgement of the previous data (TCP_NODELAY)
+             */
+            void SetNoDelay() const noexcept;
+
+            /**
+             * \brief send the whole buffer blocking as long as required
+             * \return false, if the connection was closed or an error occured
+             */
+            bool SendAll(void const* data, size_t size) const noexcept;
+
+            /**
+             * \brief receive up to size bytes
+             * \return the number of bytes received; 0 if the connection was
+             *         closed; negative on error or timeout
+             */
+            long Receive(void* buffer, size_t size) const noexcept;
+
+            /**
+             * \brief receive exactly size bytes
+             * \return false, if the connection was closed, an error occured
+             *         or the receive timeout elapsed before
+             */
+            bool ReceiveAll(void* buffer, size_t size) const noexcept;
+
+            /**
+             * \brief allow SendZeroCopy to send from the buffers of the
+             *        caller without copying them (SO_ZEROCOPY, Linux only)
+             * \return false, if not supported by the system
+             */
+            bool EnableZeroCopy() const noexcept;
+
+            /**
+             * \brief send a part of a buffer with MSG_ZEROCOPY; the data must
+             *        not be modified until ReceiveZeroCopyCompletion reports
+             *        the call completed. Calls sending data are numbered
+             *        consecutively starting at 0.
+             * \return the number of bytes sent; 0 or negative on error or
+             *         timeout
+             */
+            long SendZeroCopy(void const* data, size_t size) const noexcept;
+
+            /**
+             * \brief read a completion notification of SendZeroCopy calls
+             * \param[out] last the number of the last call completed; the
+             *                  calls complete in order
+             * \param[out] copied true, if the kernel copied the data anyway,
+             *                    e.g. for connections of the loopback interface
+             * \return false, if no notification was received before the
+             *         timeout elapsed
+             */
+            bool ReceiveZeroCopyCompletion(VmbUint32_t& last, bool& copied, std::chrono::milliseconds timeout) const noexcept;
+
+            void Close() noexcept;
+        private:
+            Handle m_handle;
+        };
+    }
+}
+
+#endif
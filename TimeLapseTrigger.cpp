@@ -0,0 +1,204 @@
+/**
+ * \date 2023
+ * \copyright Allied Vision Technologies.  All Rights Reserved.
+ *
+ * \copyright Redistribution of this file, in original or modified form, without
+ *            prior written consent of Allied Vision Technologies is prohibited.
+ *
+ * \warning THIS SOFTWARE IS PROVIDED BY THE AUTHOR "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF TITLE,
+ * NON-INFRINGEMENT, MERCHANTABILITY AND FITNESS FOR A PARTICULAR  PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \brief Implementation of ::VmbC::Examples::TimeLapseTrigger
+ */
+
+#include "ProcessStatistics.h"
+#include "TimeLapseTrigger.h"
+#include "Tracing.h"
+#include "VmbException.h"
+
+namespace VmbC
+{
+    namespace Examples
+    {
+        namespace
+        {
+            std::string GetEnumFeature(VmbHandle_t const handle, char const* const name)
+            {
+                char const* value = nullptr;
+                VmbError_t const error = VmbFeatureEnumGet(handle, name, &value);
+                if (error != VmbErrorSuccess)
+                {
+                    throw VmbException::ForOperation(error, std::string("VmbFeatureEnumGet(") + name + ")");
+                }
+                return (value == nullptr) ? std::string() : value;
+            }
+
+            void SetEnumFeature(VmbHandle_t const handle, char const* const name, std::string const& value)
+            {
+                VmbError_t const error = VmbFeatureEnumSet(handle, name, value.c_str());
+                if (error != VmbErrorSuccess)
+                {
+                    throw VmbException::ForOperation(error, std::string("VmbFeatureEnumSet(") + name + ", " + value + ")");
+                }
+            }
+        }
+
+        TimeLapseTrigger::~TimeLapseTrigger()
+        {
+            Stop();
+        }
+
+        void TimeLapseTrigger::Configure(VmbHandle_t const cameraHandle)
+        /* 先读取触发相关特征的当前值以便恢复，再把帧开始触发切换为软件触发。
+        失败时恢复已修改的特征并抛出异常，采集不会以自由运行模式开始。 */
+        {
+            if (!IsEnabled())
+            {
+                return;
+            }
+
+            m_previousSelector = GetEnumFeature(cameraHandle, "TriggerSelector");
+            SetEnumFeature(cameraHandle, "TriggerSelector", "FrameStart");
+            m_cameraHandle = cameraHandle;
+            try
+            {
+                m_previousSource = GetEnumFeature(cameraHandle, "TriggerSource");
+                m_previousMode = GetEnumFeature(cameraHandle, "TriggerMode");
+                SetEnumFeature(cameraHandle, "TriggerSource", "Software");
+                SetEnumFeature(cameraHandle, "TriggerMode", "On");
+            }
+            catch (VmbException const&)
+            {
+                Restore();
+                throw;
+            }
+        }
+
+        void TimeLapseTrigger::Start()
+        {
+            if (m_cameraHandle == nullptr)
+            {
+                return;
+            }
+
+            Stop();
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_stop = false;
+            }
+            m_triggers = 0;
+            m_triggerFailures = 0;
+            m_idleTime = 0;
+            m_idleCpuTime = 0;
+            m_thread = std::thread(&TimeLapseTrigger::Trigger, this);
+        }
+
+        void TimeLapseTrigger::Stop() noexcept
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_stop = true;
+            }
+            m_condition.notify_all();
+            if (m_thread.joinable())
+            {
+                m_thread.join();
+            }
+        }
+
+        void TimeLapseTrigger::Restore() noexcept
+        /* 按与Configure相反的顺序恢复；TriggerSource和TriggerMode属于FrameStart选择器，因此最后恢复选择器。 */
+        {
+            if (m_cameraHandle == nullptr)
+            {
+                return;
+            }
+
+            if (!m_previousMode.empty())
+            {
+                VmbFeatureEnumSet(m_cameraHandle, "TriggerMode", m_previousMode.c_str()); // errors ignored on purpose
+            }
+            if (!m_previousSource.empty())
+            {
+                VmbFeatureEnumSet(m_cameraHandle, "TriggerSource", m_previousSource.c_str());
+            }
+            VmbFeatureEnumSet(m_cameraHandle, "TriggerSelector", m_previousSelector.c_str());
+            m_previousSelector.clear();
+            m_previousSource.clear();
+            m_previousMode.clear();
+            m_cameraHandle = nullptr;
+        }
+
+        TimeLapseTrigger::Statistics TimeLapseTrigger::GetStatistics() const noexcept
+        {
+            Statistics statistics;
+            statistics.m_interval = m_interval;
+            statistics.m_triggers = m_triggers.load(std::memory_order_relaxed);
+            statistics.m_triggerFailures = m_triggerFailures.load(std::memory_order_relaxed);
+            statistics.m_idleTime = Clock::duration(m_idleTime.load(std::memory_order_relaxed));
+            statistics.m_idleCpuTime = std::chrono::microseconds(m_idleCpuTime.load(std::memory_order_relaxed));
+            double const idleSeconds = std::chrono::duration<double>(statistics.m_idleTime).count();
+            if (idleSeconds > 0)
+            {
+                statistics.m_idleCpuPercent = 100.0 * std::chrono::duration<double>(statistics.m_idleCpuTime).count() / idleSeconds;
+            }
+            return statistics;
+        }
+
+        void TimeLapseTrigger::Trigger()
+        /* 触发时间按开始时间加整数倍间隔计算，不会累积误差；处理落后超过一个间隔时跳过错过的触发。
+        每个间隔唤醒两次：在间隔中点开始测量、在下一次触发前结束测量，此时前一帧的转换和写入通常已经完成，
+        因此测得的是空闲时整个进程的CPU占用。 */
+        {
+            ASYNCHRONOUSGRAB_TRACE_THREAD_NAME("TimeLapseTrigger");
+
+            auto next = Clock::now();
+            while (true)
+            {
+                ASYNCHRONOUSGRAB_TRACE_SCOPE("TriggerSoftware", m_triggers.load(std::memory_order_relaxed));
+                if (VmbFeatureCommandRun(m_cameraHandle, "TriggerSoftware") == VmbErrorSuccess)
+                {
+                    ++m_triggers;
+                }
+                else
+                {
+                    ++m_triggerFailures;
+                }
+
+                auto const now = Clock::now();
+                do
+                {
+                    next += m_interval;
+                } while (next <= now);
+
+                auto const idleStart = next - m_interval / 2;
+                if (!WaitUntil(idleStart))
+                {
+                    return;
+                }
+                auto const idleWallStart = Clock::now();
+                auto const idleCpuStart = GetProcessCpuTime();
+                if (!WaitUntil(next))
+                {
+                    return;
+                }
+                m_idleCpuTime += (GetProcessCpuTime() - idleCpuStart).count();
+                m_idleTime += (Clock::now() - idleWallStart).count();
+            }
+        }
+
+        bool TimeLapseTrigger::WaitUntil(Clock::time_point const time)
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            return !m_condition.wait_until(lock, time, [this]() { return m_stop; });
+        }
+    }
+}
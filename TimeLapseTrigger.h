@@ -0,0 +1,170 @@
+/**
+ * \date 2023
+ * \copyright Allied Vision Technologies.  All Rights Reserved.
+ *
+ * \copyright Redistribution of this file, in original or modified form, without
+ *            prior written consent of Allied Vision Technologies is prohibited.
+ *
+ * \warning THIS SOFTWARE IS PROVIDED BY THE AUTHOR "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF TITLE,
+ * NON-INFRINGEMENT, MERCHANTABILITY AND FITNESS FOR A PARTICULAR  PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \brief Definition of the software trigger of the time-lapse mode
+ */
+
+#ifndef ASYNCHRONOUSGRAB_C_TIME_LAPSE_TRIGGER_H
+#define ASYNCHRONOUSGRAB_C_TIME_LAPSE_TRIGGER_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include <VmbC/VmbC.h>
+
+namespace VmbC
+{
+    namespace Examples
+    {
+        /**
+         * \brief Acquires single frames at a fixed interval by switching the
+         *        camera to software triggering.
+         *
+         * Configure sets TriggerSelector=FrameStart, TriggerSource=Software
+         * and TriggerMode=On before the acquisition is started; a thread
+         * then executes TriggerSoftware at the interval without drifting.
+         * Since the camera only delivers the triggered frames, the frame
+         * callback, the transcoder and the sinks only wake up for these.
+         *
+         * The process cpu time is sampled halfway between two triggers and
+         * right before the next one to measure the cpu usage while idle.
+         */
+        class TimeLapseTrigger
+        {
+        public:
+            using Clock = std::chrono::steady_clock;
+
+            struct Statistics
+            {
+                Clock::duration m_interval {};
+                VmbUint64_t m_triggers { 0 };
+                VmbUint64_t m_triggerFailures { 0 };
+
+                /**
+                 * \brief the wall time measured in the second halves of the
+                 *        intervals and the process cpu time used meanwhile
+                 */
+                ///@{
+                Clock::duration m_idleTime {};
+                std::chrono::microseconds m_idleCpuTime {};
+                ///@}
+
+                /**
+                 * \brief m_idleCpuTime relative to m_idleTime in percent of
+                 *        one core
+                 */
+                double m_idleCpuPercent { 0 };
+            };
+
+            TimeLapseTrigger() = default;
+
+            /**
+             * \brief stops the trigger thread; the camera settings need to
+             *        be restored before
+             */
+            ~TimeLapseTrigger();
+
+            TimeLapseTrigger(TimeLapseTrigger const&) = delete;
+            TimeLapseTrigger& operator=(TimeLapseTrigger const&) = delete;
+
+            /**
+             * \brief set the interval used for the next acquisition; zero to
+             *        let the camera run freely
+             */
+            void SetInterval(Clock::duration interval) noexcept
+            {
+                m_interval = interval;
+            }
+
+            Clock::duration GetInterval() const noexcept
+            {
+                return m_interval;
+            }
+
+            bool IsEnabled() const noexcept
+            {
+                return m_interval > Clock::duration::zero();
+            }
+
+            /**
+             * \brief switch the camera to software triggering; does nothing,
+             *        if not enabled
+             * \throws VmbException, if the camera does not support software
+             *                      triggering
+             */
+            void Configure(VmbHandle_t cameraHandle);
+
+            /**
+             * \brief start triggering after the acquisition was started
+             */
+            void Start();
+
+            /**
+             * \brief stop triggering; call before stopping the acquisition
+             */
+            void Stop() noexcept;
+
+            /**
+             * \brief restore the trigger settings changed by Configure
+             */
+            void Restore() noexcept;
+
+            Statistics GetStatistics() const noexcept;
+        private:
+            Clock::duration m_interval {};
+
+            /**
+             * \brief the camera configured; null, if not configured
+             */
+            VmbHandle_t m_cameraHandle { nullptr };
+
+            /**
+             * \brief the values of the trigger features before Configure
+             */
+            ///@{
+            std::string m_previousSelector;
+            std::string m_previousSource;
+            std::string m_previousMode;
+            ///@}
+
+            std::mutex m_mutex;
+            std::condition_variable m_condition;
+            bool m_stop { false };
+            std::thread m_thread;
+
+            std::atomic<VmbUint64_t> m_triggers { 0 };
+            std::atomic<VmbUint64_t> m_triggerFailures { 0 };
+            std::atomic<Clock::rep> m_idleTime { 0 };
+            std::atomic<std::chrono::microseconds::rep> m_idleCpuTime { 0 };
+
+            void Trigger();
+
+            /**
+             * \brief wait until a point in time or until Stop is called
+             * \return false, if stopped
+             */
+            bool WaitUntil(Clock::time_point time);
+        };
+    }
+}
+
+#endif
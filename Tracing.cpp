@@ -0,0 +1,303 @@
+/**
+ * \date 2023
+ * \copyright Allied Vision Technologies.  All Rights Reserved.
+ *
+ * \copyright Redistribution of this file, in original or modified form, without
+ *            prior written consent of Allied Vision Technologies is prohibited.
+ *
+ * \warning THIS SOFTWARE IS PROVIDED BY THE AUTHOR "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF TITLE,
+ * NON-INFRINGEMENT, MERCHANTABILITY AND FITNESS FOR A PARTICULAR  PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \brief Implementation of ::VmbC::Examples::Tracing
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <vector>
+
+#include "Tracing.h"
+
+namespace VmbC
+{
+    namespace Examples
+    {
+        namespace Tracing
+        {
+            namespace
+            {
+                /**
+                 * \brief the maximum number of buffers kept for threads that
+                 *        already terminated
+                 */
+                constexpr size_t MaxThreadBuffers = 64;
+
+                struct Event
+                {
+                    char const* m_name;
+                    std::uint64_t m_frameId;
+                    Clock::rep m_begin;
+                    Clock::rep m_duration;
+                };
+
+                /**
+                 * \brief ring buffer written by a single thread 
+                 */
+                struct ThreadBuffer
+                {
+                    std::unique_ptr<Event[]> m_events { new Event[EventsPerThread] };
+
+                    /**
+                     * \brief the number of events written so far; the event
+                     *        n is stored at index n % EventsPerThread
+                     */
+                    std::atomic<std::uint64_t> m_written { 0 };
+
+                    std::atomic<char const*> m_threadName { nullptr };
+
+                    /**
+                     * \brief the id used as tid in the trace; guarded by the registry mutex
+                     */
+                    unsigned m_threadId { 0 };
+
+                    /**
+                     * \brief true, while the buffer is assigned to a running
+                     *        thread; guarded by the registry mutex
+                     */
+                    bool m_inUse { false };
+                };
+
+                struct Registry
+                {
+                    std::mutex m_mutex;
+                    std::vector<std::unique_ptr<ThreadBuffer>> m_buffers;
+                    unsigned m_nextThreadId { 1 };
+                    Clock::time_point const m_epoch { Clock::now() };
+
+                    ThreadBuffer* Acquire()
+                    /* 为新线程分配环形缓冲区：未超过上限时新建，否则重用已结束线程的缓冲区。 */
+                    {
+                        std::lock_guard<std::mutex> lock(m_mutex);
+
+                        ThreadBuffer* buffer = nullptr;
+                        if (m_buffers.size() >= MaxThreadBuffers)
+                        {
+                            auto const pos = std::find_if(m_buffers.begin(), m_buffers.end(),
+                                                          [](std::unique_ptr<ThreadBuffer> const& b) { return !b->m_inUse; });
+                            if (pos != m_buffers.end())
+                            {
+                                buffer = pos->get();
+                                buffer->m_written.store(0, std::memory_order_relaxed);
+                                buffer->m_threadName.store(nullptr, std::memory_order_relaxed);
+                            }
+                        }
+
+                        if (buffer == nullptr)
+                        {
+                            m_buffers.emplace_back(new ThreadBuffer());
+                            buffer = m_buffers.back().get();
+                        }
+
+                        buffer->m_inUse = true;
+                        buffer->m_threadId = m_nextThreadId++;
+                        return buffer;
+                    }
+
+                    void Release(ThreadBuffer* buffer)
+                    {
+                        std::lock_guard<std::mutex> lock(m_mutex);
+                        buffer->m_inUse = false;
+                    }
+                };
+
+                /**
+                 * \brief intentionally never destroyed, since threads may
+                 *        terminate during the static destruction
+                 */
+                Registry& GetRegistry()
+                {
+                    static Registry* const registry = new Registry();
+                    return *registry;
+                }
+
+                /**
+                 * \brief assigns a buffer to the thread on first use and
+                 *        releases it on thread termination
+                 */
+                class ThreadBufferHolder
+                {
+                public:
+                    ~ThreadBufferHolder()
+                    {
+                        if (m_buffer != nullptr)
+                        {
+                            GetRegistry().Release(m_buffer);
+                        }
+                    }
+
+                    ThreadBuffer& Get()
+                    {
+                        if (m_buffer == nullptr)
+                        {
+                            m_buffer = GetRegistry().Acquire();
+                        }
+                        return *m_buffer;
+                    }
+                private:
+                    ThreadBuffer* m_buffer { nullptr };
+                };
+
+                thread_local ThreadBufferHolder t_threadBuffer;
+
+                std::atomic<bool> g_enabled { true };
+
+                void WriteJsonString(std::ostream& out, char const* str)
+                {
+                    out << '"';
+                    for (; *str != '\0'; ++str)
+                    {
+                        if (*str == '"' || *str == '\\')
+                        {
+                            out << '\\';
+                        }
+                        out << *str;
+                    }
+                    out << '"';
+                }
+
+                double ToMicroseconds(Clock::rep ticks)
+                {
+                    return std::chrono::duration<double, std::micro>(Clock::duration(ticks)).count();
+                }
+            }
+
+            void SetEnabled(bool enabled) noexcept
+            {
+                g_enabled.store(enabled, std::memory_order_relaxed);
+            }
+
+            bool IsEnabled() noexcept
+            {
+                return g_enabled.load(std::memory_order_relaxed);
+            }
+
+            void SetThreadName(char const* name) noexcept
+            {
+                t_threadBuffer.Get().m_threadName.store(name, std::memory_order_release);
+            }
+
+            void RecordComplete(char const* name, std::uint64_t frameId, Clock::time_point begin, Clock::time_point end) noexcept
+            /* 将事件写入当前线程的环形缓冲区；只有写入线程修改缓冲区，因此不需要加锁。 */
+            {
+                if (!IsEnabled())
+                {
+                    return;
+                }
+
+                auto& buffer = t_threadBuffer.Get();
+                auto const index = buffer.m_written.load(std::memory_order_relaxed);
+                buffer.m_events[index % EventsPerThread] = Event
+                {
+                    name,
+                    frameId,
+                    (begin - GetRegistry().m_epoch).count(),
+                    (end - begin).count()
+                };
+                buffer.m_written.store(index + 1, std::memory_order_release);
+            }
+
+            void WriteChromeTrace(std::ostream& out)
+            /* 
+            brief：以Chrome trace event JSON格式输出所有线程缓冲区中的事件
+            读取期间可能被写入线程覆盖的事件会被丢弃。
+             */
+            {
+                auto& registry = GetRegistry();
+                std::lock_guard<std::mutex> lock(registry.m_mutex);
+
+                out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+                out << std::fixed << std::setprecision(3);
+
+                bool first = true;
+                auto separator = [&first, &out]()
+                {
+                    if (!first)
+                    {
+                        out << ",\n";
+                    }
+                    first = false;
+                };
+
+                std::vector<Event> events;
+                for (auto const& buffer : registry.m_buffers)
+                {
+                    auto const written = buffer->m_written.load(std::memory_order_acquire);
+                    auto begin = (written > EventsPerThread) ? written - EventsPerThread : 0;
+
+                    events.clear();
+                    for (auto index = begin; index != written; ++index)
+                    {
+                        events.push_back(buffer->m_events[index % EventsPerThread]);
+                    }
+
+                    // skip events overwritten while copying
+                    auto const writtenAfterCopy = buffer->m_written.load(std::memory_order_acquire);
+                    if (writtenAfterCopy > EventsPerThread && writtenAfterCopy - EventsPerThread > begin)
+                    {
+                        auto const overwritten = (std::min)(writtenAfterCopy - EventsPerThread - begin, static_cast<std::uint64_t>(events.size()));
+                        events.erase(events.begin(), events.begin() + static_cast<std::ptrdiff_t>(overwritten));
+                    }
+
+                    if (auto const threadName = buffer->m_threadName.load(std::memory_order_acquire))
+                    {
+                        separator();
+                        out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->m_threadId
+                            << ",\"args\":{\"name\":";
+                        WriteJsonString(out, threadName);
+                        out << "}}";
+                    }
+
+                    for (auto const& event : events)
+                    {
+                        separator();
+                        out << "{\"name\":";
+                        WriteJsonString(out, event.m_name);
+                        out << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->m_threadId
+                            << ",\"ts\":" << ToMicroseconds(event.m_begin)
+                            << ",\"dur\":" << ToMicroseconds(event.m_duration);
+                        if (event.m_frameId != NoFrame)
+                        {
+                            out << ",\"args\":{\"frameID\":" << event.m_frameId << '}';
+                        }
+                        out << '}';
+                    }
+                }
+
+                out << "]}\n";
+            }
+
+            bool WriteChromeTrace(char const* fileName)
+            {
+                std::ofstream file(fileName);
+                if (!file)
+                {
+                    return false;
+                }
+                WriteChromeTrace(file);
+                return static_cast<bool>(file);
+            }
+        }
+    }
+}
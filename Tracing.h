@@ -0,0 +1,175 @@
+/**
+ * \date 2023
+ * \copyright Allied Vision Technologies.  All Rights Reserved.
+ *
+ * \copyright Redistribution of this file, in original or modified form, without
+ *            prior written consent of Allied Vision Technologies is prohibited.
+ *
+ * \warning THIS SOFTWARE IS PROVIDED BY THE AUTHOR "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF TITLE,
+ * NON-INFRINGEMENT, MERCHANTABILITY AND FITNESS FOR A PARTICULAR  PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \brief Definition of the functionality used for tracing the time spent
+ *        in the stages of the frame pipeline
+ */
+
+#ifndef ASYNCHRONOUSGRAB_C_TRACING_H
+#define ASYNCHRONOUSGRAB_C_TRACING_H
+
+#include <chrono>
+#include <cstdint>
+#include <iosfwd>
+
+/**
+ * \brief set to 0 to remove all tracing code at compile time 
+ */
+#ifndef ASYNCHRONOUSGRAB_ENABLE_TRACING
+#define ASYNCHRONOUSGRAB_ENABLE_TRACING 1
+#endif
+
+namespace VmbC
+{
+    namespace Examples
+    {
+        /**
+         * \brief Low overhead recording of the time spent in the stages of the
+         *        pipeline.
+         *
+         * Every thread writes to its own ring buffer, so recording an event
+         * does not require any locking. Only the most recent events of each
+         * thread are kept and can be written as Chrome trace event JSON that
+         * can be opened in chrome://tracing or https://ui.perfetto.dev.
+         *
+         * Use the ASYNCHRONOUSGRAB_TRACE_* macros instead of calling the
+         * functions directly to allow for removing the tracing at compile time.
+         */
+        namespace Tracing
+        {
+            using Clock = std::chrono::steady_clock;
+
+            /**
+             * \brief the number of events kept per thread 
+             */
+            constexpr size_t EventsPerThread = 16384;
+
+            /**
+             * \brief value used for events not related to a frame 
+             */
+            constexpr std::uint64_t NoFrame = ~std::uint64_t(0);
+
+            /**
+             * \brief enable/disable the recording at runtime; enabled by default
+             */
+            void SetEnabled(bool enabled) noexcept;
+
+            bool IsEnabled() noexcept;
+
+            /**
+             * \brief set the name displayed for the calling thread in the trace 
+             * \param[in] name a string literal
+             */
+            void SetThreadName(char const* name) noexcept;
+
+            /**
+             * \brief record an event that started at begin and ended at end
+             * \param[in] name a string literal naming the stage
+             */
+            void RecordComplete(char const* name, std::uint64_t frameId, Clock::time_point begin, Clock::time_point end) noexcept;
+
+            /**
+             * \brief write the events currently held in the ring buffers in the
+             *        Chrome trace event format
+             */
+            void WriteChromeTrace(std::ostream& out);
+
+            /**
+             * \brief write the trace to a file
+             * \return true, if the file was written successfully
+             */
+            bool WriteChromeTrace(char const* fileName);
+
+            /**
+             * \brief records the lifetime of the object as an event 
+             */
+            class Scope
+            {
+            public:
+                Scope(char const* name, std::uint64_t frameId) noexcept
+                    : m_name(IsEnabled() ? name : nullptr),
+                    m_frameId(frameId)
+                {
+                    if (m_name != nullptr)
+                    {
+                        m_begin = Clock::now();
+                    }
+                }
+
+                ~Scope()
+                {
+                    if (m_name != nullptr)
+                    {
+                        RecordComplete(m_name, m_frameId, m_begin, Clock::now());
+                    }
+                }
+
+                Scope(Scope const&) = delete;
+                Scope& operator=(Scope const&) = delete;
+
+                /**
+                 * \brief update the frame id, if it's only known after the start of the scope
+                 */
+                void SetFrameId(std::uint64_t frameId) noexcept
+                {
+                    m_frameId = frameId;
+                }
+            private:
+                char const* m_name;
+                std::uint64_t m_frameId;
+                Clock::time_point m_begin;
+            };
+        }
+    }
+}
+
+#define ASYNCHRONOUSGRAB_TRACE_CONCAT_IMPL(a, b) a##b
+#define ASYNCHRONOUSGRAB_TRACE_CONCAT(a, b) ASYNCHRONOUSGRAB_TRACE_CONCAT_IMPL(a, b)
+
+#if ASYNCHRONOUSGRAB_ENABLE_TRACING
+
+/**
+ * \brief record the time until the end of the enclosing scope
+ */
+#define ASYNCHRONOUSGRAB_TRACE_SCOPE(name, frameId) \
+    ::VmbC::Examples::Tracing::Scope ASYNCHRONOUSGRAB_TRACE_CONCAT(traceScope, __LINE__)((name), (frameId))
+
+/**
+ * \brief record a named scope that can be referred to by ASYNCHRONOUSGRAB_TRACE_SET_FRAME
+ */
+#define ASYNCHRONOUSGRAB_TRACE_NAMED_SCOPE(variable, name) \
+    ::VmbC::Examples::Tracing::Scope variable((name), ::VmbC::Examples::Tracing::NoFrame)
+
+#define ASYNCHRONOUSGRAB_TRACE_SET_FRAME(variable, frameId) (variable).SetFrameId(frameId)
+
+#define ASYNCHRONOUSGRAB_TRACE_COMPLETE(name, frameId, begin, end) \
+    ::VmbC::Examples::Tracing::RecordComplete((name), (frameId), (begin), (end))
+
+#define ASYNCHRONOUSGRAB_TRACE_THREAD_NAME(name) ::VmbC::Examples::Tracing::SetThreadName(name)
+
+#else
+
+#define ASYNCHRONOUSGRAB_TRACE_SCOPE(name, frameId) static_cast<void>(0)
+#define ASYNCHRONOUSGRAB_TRACE_NAMED_SCOPE(variable, name) static_cast<void>(0)
+#define ASYNCHRONOUSGRAB_TRACE_SET_FRAME(variable, frameId) static_cast<void>(0)
+#define ASYNCHRONOUSGRAB_TRACE_COMPLETE(name, frameId, begin, end) static_cast<void>(0)
+#define ASYNCHRONOUSGRAB_TRACE_THREAD_NAME(name) static_cast<void>(0)
+
+#endif
+
+#endif
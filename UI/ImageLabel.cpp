@@ -25,6 +25,8 @@
 
 =============================================================================*/
 
+#include <QFontDatabase>
+#include <QPainter>
 #include <QResizeEvent>
 
 #include "UI/ImageLabel.h"
@@ -44,3 +46,39 @@ void ImageLabel::resizeEvent(QResizeEvent* event)
     QLabel::resizeEvent(event);
     emit sizeChanged(event->size());
 }
+
+void ImageLabel::SetOverlayText(QString const& text)
+/* 设置绘制在图像左上角的覆盖文本（例如统计信息），空文本表示不绘制覆盖层。
+只有文本发生变化时才请求重绘。 */
+{
+    if (text != m_overlayText)
+    {
+        m_overlayText = text;
+        update();
+    }
+}
+
+void ImageLabel::paintEvent(QPaintEvent* event)
+/* 先由 QLabel 绘制图像，然后在左上角绘制半透明背景和覆盖文本。
+覆盖文本使用等宽字体，这样数值变化时各列保持对齐。 */
+{
+    QLabel::paintEvent(event);
+
+    if (m_overlayText.isEmpty())
+    {
+        return;
+    }
+
+    QPainter painter(this);
+    painter.setFont(QFontDatabase::systemFont(QFontDatabase::FixedFont));
+
+    int const margin = 6;
+    QRect const textRect = painter.fontMetrics().boundingRect(QRect(0, 0, width(), height()),
+                                                              Qt::AlignLeft | Qt::AlignTop,
+                                                              m_overlayText);
+    QRect const background = textRect.translated(2 * margin, 2 * margin).adjusted(-margin, -margin, margin, margin);
+
+    painter.fillRect(background, QColor(0, 0, 0, 160));
+    painter.setPen(Qt::white);
+    painter.drawText(textRect.translated(2 * margin, 2 * margin), Qt::AlignLeft | Qt::AlignTop, m_overlayText);
+}
@@ -24,6 +24,7 @@
 
 #include <QLabel>
 #include <QSize>
+#include <QString>
 
 /**
  * \brief Widget for displaying a the images received from a camera.
@@ -34,11 +35,27 @@ class ImageLabel : public QLabel
     Q_OBJECT
 public:
     ImageLabel(QWidget* parent = 0, Qt::WindowFlags flags = Qt::Widget);
+
+    /**
+     * \brief set the text painted on top of the image in the upper left
+     *        corner; an empty text removes the overlay
+     */
+    void SetOverlayText(QString const& text);
 protected:
     /**
      * \brief adds sizeChanged signal emission to QLabel::resizeEvent
      */
     void resizeEvent(QResizeEvent* event) override;
+
+    /**
+     * \brief paints the overlay text on top of the content of the QLabel
+     */
+    void paintEvent(QPaintEvent* event) override;
+private:
+    /**
+     * \brief the text painted on top of the image 
+     */
+    QString m_overlayText;
 signals:
     /**
      * \brief signal triggered during the resize event
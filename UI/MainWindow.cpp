@@ -27,16 +27,31 @@
 =============================================================================*/
 
 #include <algorithm>
+#include <limits>
 
+#include <QDateTime>
+#include <QFileDialog>
+#include <QFileInfo>
+#include <QInputDialog>
 #include <QItemSelection>
+#include <QKeySequence>
 #include <QPixmap>
+#include <QShortcut>
+#include <QSignalBlocker>
+#include <QTimer>
 
 #include "ui_AsynchronousGrabGui.h"
 
+#include "DaemonClient.h"
 #include "Image.h"
 #include "LogEntryListModel.h"
 #include "MainWindow.h"
+#include "MetricsServer.h"
 #include "ModuleTreeModel.h"
+#include "RecordingBrowser.h"
+#include "RecordingReader.h"
+#include "RecordingSink.h"
+#include "Tracing.h"
 #include "VmbException.h"
 
 #include <QTreeWidgetItem>
@@ -57,110 +72,870 @@ namespace Text
         return "Stop Acquisition";
     }
 
+    QString StartRecording()
+    {
+        return "Start Recording";
+    }
+
+    QString StopRecording()
+    {
+        return "Stop Recording";
+    }
+
+    QString RecordingFileName()
+    {
+        return "AsynchronousGrabRecording_" + QDateTime::currentDateTime().toString("yyyyMMdd_hhmmss") + ".vmbrec";
+    }
+
+    QString ReviewRecording()
+    {
+        return "Review Recording...";
+    }
+
+    QString CloseReview()
+    {
+        return "Close Review";
+    }
+
+    QString Play()
+    {
+        return "Play";
+    }
+
+    QString Pause()
+    {
+        return "Pause";
+    }
+
+    QString HistoryFileName()
+    {
+        return "AsynchronousGrabHistory_" + QDateTime::currentDateTime().toString("yyyyMMdd_hhmmss") + ".vmbrec";
+    }
+
     QString WindowTitleStartupError()
     {
         return "Vmb C AsynchronousGrab API Version";
     }
 
-    QString WindowTitle(std::string const& vmbCVersion)
+    QString WindowTitle(std::string const& vmbCVersion)
+    {
+        return QString::fromStdString("Vmb C AsynchronousGrab API Version " + vmbCVersion);
+    }
+
+    QString VideoFileName(char const* extension)
+    {
+        return "AsynchronousGrabVideo_" + QDateTime::currentDateTime().toString("yyyyMMdd_hhmmss") + extension;
+    }
+
+    QString TraceFileName()
+    {
+        return "AsynchronousGrabTrace_" + QDateTime::currentDateTime().toString("yyyyMMdd_hhmmss") + ".json";
+    }
+
+    QString Rate(VmbUint64_t count, double seconds)
+    {
+        return QString("%1 fps").arg(seconds > 0 ? count / seconds : 0.0, 7, 'f', 1);
+    }
+
+    QString Milliseconds(std::chrono::steady_clock::duration duration)
+    {
+        return QString("%1 ms").arg(std::chrono::duration<double, std::milli>(duration).count(), 7, 'f', 2);
+    }
+}
+
+namespace
+{
+    /**
+     * \brief interval for updating the statistics overlay
+     */
+    constexpr int StatisticsUpdateIntervalMs = 500;
+
+    /**
+     * \brief interval for advancing the position of a reviewed recording
+     *        while playing
+     */
+    constexpr int ReviewUpdateIntervalMs = 15;
+
+    /**
+     * \brief the number of timestamp ticks per second of the reviewed
+     *        recordings; matches PlaybackCamera::Settings
+     */
+    constexpr double ReviewTimestampFrequency = 1e9;
+
+    /**
+     * \brief the playback speeds selectable for reviewing a recording
+     */
+    constexpr double ReviewSpeeds[] = { -4.0, -1.0, 0.25, 0.5, 1.0, 2.0, 4.0, 8.0, 16.0 };
+    constexpr int DefaultReviewSpeedIndex = 4;
+
+    /**
+     * \brief the order the raw frame sinks are served in the frame callback;
+     *        the recording first, the network outputs last
+     */
+    ///@{
+    constexpr int RecordingSinkPriority = 100;
+    constexpr int HistorySinkPriority = 80;
+    constexpr int SnapshotSinkPriority = 60;
+    constexpr int WorkQueueSinkPriority = 40;
+    constexpr int FrameStreamSinkPriority = 20;
+    ///@}
+}
+
+namespace
+{
+    struct SelectableCheckVisitor : VmbC::Examples::ModuleData::Visitor
+    {
+        bool m_selectable { false };
+
+        void Visit(VmbCameraInfo_t const&) override
+        {
+            m_selectable = true;
+        }
+
+        void Visit(VmbC::Examples::PlaybackInfo const&) override
+        {
+            m_selectable = true;
+        }
+    };
+
+    struct CameraInfoRetrievalVisitor : VmbC::Examples::ModuleData::Visitor
+    {
+        VmbCameraInfo_t const* m_info { nullptr };
+
+        void Visit(VmbCameraInfo_t const& info) override
+        {
+            m_info = &info;
+        }
+    };
+
+    struct PlaybackInfoRetrievalVisitor : VmbC::Examples::ModuleData::Visitor
+    {
+        VmbC::Examples::PlaybackInfo const* m_info { nullptr };
+
+        void Visit(VmbC::Examples::PlaybackInfo const& info) override
+        {
+            m_info = &info;
+        }
+    };
+
+    /**
+     * \brief the settings of a raw frame sink called directly in the frame
+     *        callback; all sinks of the window copy the frames into queues of
+     *        their own without waiting
+     */
+    VmbC::Examples::FrameSinkGraph::EdgeSettings DirectSink(char const* name, int priority)
+    {
+        VmbC::Examples::FrameSinkGraph::EdgeSettings settings;
+        settings.m_name = name;
+        settings.m_priority = priority;
+        return settings;
+    }
+
+    void ShowReviewFrame(ImageLabel& label, std::shared_ptr<VmbC::Examples::RecordingBrowser::RenderedFrame const> const& frame)
+    {
+        if (frame)
+        {
+            label.setPixmap(QPixmap::fromImage(static_cast<ReviewFrameRenderer::Frame const&>(*frame).m_image));
+        }
+    }
+
+    VmbC::Examples::ModuleData const* GetSelectedModule(QTreeView const& tree)
+    {
+        auto selectionModel = tree.selectionModel();
+        if (selectionModel->hasSelection())
+        {
+            auto selection = selectionModel->selectedRows();
+            if (!selection.isEmpty())
+            {
+                return VmbC::Examples::ModuleTreeModel::GetModule(selection.at(0));
+            }
+        }
+        return nullptr;
+    }
+}
+
+MainWindow::MainWindow(QWidget* parent, Qt::WindowFlags flags)
+    : QMainWindow(parent, flags),
+    m_ui(new Gui()),
+    m_statisticsTimer(new QTimer(this)),
+    m_frameSink(*this),
+    m_acquisitionManager(m_frameSink),
+    m_reviewRenderer(*this),
+    m_reviewMemoryBudget(VmbC::Examples::RecordingBrowser::Settings().m_memoryBudget),
+    m_reviewTimer(new QTimer(this)),
+    m_log(new LogEntryListModel())
+{
+    m_ui->setupUi(this);
+    SetupLogView();
+
+    ASYNCHRONOUSGRAB_TRACE_THREAD_NAME("GUI");
+    QObject::connect(new QShortcut(QKeySequence(Qt::Key_F12), this), &QShortcut::activated, this, &MainWindow::WriteTrace);
+
+    m_statisticsTimer->setInterval(StatisticsUpdateIntervalMs);
+    QObject::connect(m_statisticsTimer, &QTimer::timeout, this, &MainWindow::UpdateStatistics);
+    QObject::connect(new QShortcut(QKeySequence(Qt::Key_F3), this), &QShortcut::activated, this, &MainWindow::ToggleStatistics);
+
+    m_reviewTimer->setInterval(ReviewUpdateIntervalMs);
+    QObject::connect(m_reviewTimer, &QTimer::timeout, this, &MainWindow::AdvanceReview);
+    QObject::connect(this, &MainWindow::ReviewFrameAvailable, this, &MainWindow::DisplayReviewFrame, Qt::ConnectionType::QueuedConnection);
+
+    try
+    {
+        m_apiController.reset(new ApiController());
+    }
+    catch (VmbException const& ex)
+    {
+        Log(ex);
+    }
+
+    if (m_apiController)
+    {
+        SetupUi(*(m_apiController.get()));
+        SetupCameraTree();
+        m_frameSink.SetOutputSize(m_ui->m_renderLabel->size());
+        m_reviewRenderer.SetOutputSize(m_ui->m_renderLabel->size());
+        QObject::connect(m_ui->m_renderLabel, &ImageLabel::sizeChanged, this, &MainWindow::ImageLabelSizeChanged);
+    }
+    else
+    {
+        setWindowTitle(Text::WindowTitleStartupError());
+    }
+}
+
+VmbCameraInfo_t const* MainWindow::GetSelectedCamera() const
+{
+    CameraInfoRetrievalVisitor visitor;
+    if (auto const module = GetSelectedModule(*m_ui->m_cameraSelectionTree))
+    {
+        module->Accept(visitor);
+    }
+    return visitor.m_info;
+}
+
+VmbC::Examples::PlaybackInfo const* MainWindow::GetSelectedPlayback() const
+{
+    PlaybackInfoRetrievalVisitor visitor;
+    if (auto const module = GetSelectedModule(*m_ui->m_cameraSelectionTree))
+    {
+        module->Accept(visitor);
+    }
+    return visitor.m_info;
+}
+
+void MainWindow::StartStopClicked()
+{
+    if (m_acquisitionManager.IsAcquisitionActive())
+    {
+        StopAcquisition();
+    }
+    else if (auto const cameraInfo = GetSelectedCamera())
+    {
+        StartAcquisition(*cameraInfo);
+    }
+    else if (auto const playbackInfo = GetSelectedPlayback())
+    {
+        StartPlayback(*playbackInfo);
+    }
+}
+
+void MainWindow::OpenRecordingClicked()
+/* 选择录制文件和回放时序，检查文件能否打开，然后把它作为可选择的项添加到相机树中并选中。
+回放本身在点击“Start Acquisition”时开始，与真实相机相同。 */
+{
+    QString const fileName = QFileDialog::getOpenFileName(this, "Open Recording", QString(), "Recordings (*.vmbrec)");
+    if (fileName.isEmpty())
+    {
+        return;
+    }
+
+    using VmbC::Examples::PlaybackCamera;
+    QStringList const timings { "Original timing", "Fixed frame rate", "As fast as possible" };
+    bool ok = false;
+    QString const timing = QInputDialog::getItem(this, "Playback", "Timing", timings, 0, false, &ok);
+    if (!ok)
+    {
+        return;
+    }
+
+    VmbC::Examples::PlaybackInfo info;
+    info.m_displayName = QFileInfo(fileName).fileName().toStdString();
+    info.m_settings.m_fileName = fileName.toLocal8Bit().constData();
+    switch (timings.indexOf(timing))
+    {
+    case 1:
+        info.m_settings.m_timing = PlaybackCamera::Timing::FixedRate;
+        info.m_settings.m_frameRate = QInputDialog::getDouble(this, "Playback", "Frames per second", 30.0, 0.1, 10000.0, 1, &ok);
+        if (!ok)
+        {
+            return;
+        }
+        info.m_displayName += QString(", %1 fps").arg(info.m_settings.m_frameRate).toStdString();
+        break;
+    case 2:
+        info.m_settings.m_timing = PlaybackCamera::Timing::AsFastAsPossible;
+        info.m_displayName += ", as fast as possible";
+        break;
+    default:
+        info.m_settings.m_timing = PlaybackCamera::Timing::Original;
+        break;
+    }
+
+    try
+    {
+        VmbC::Examples::RecordingReader const reader(info.m_settings.m_fileName);
+        Log("Recording " + info.m_settings.m_fileName + ": " + std::to_string(reader.GetFrameCount()) + " frames"
+            + (reader.IsIndexRebuilt() ? " (index rebuilt)" : ""));
+    }
+    catch (VmbException const& ex)
+    {
+        Log(ex);
+        return;
+    }
+
+    auto model = static_cast<VmbC::Examples::ModuleTreeModel*>(m_ui->m_cameraSelectionTree->model());
+    QModelIndex const index = model->AddTopLevelModule(std::unique_ptr<VmbC::Examples::ModuleData>(new VmbC::Examples::PlaybackData(info)));
+    m_ui->m_cameraSelectionTree->selectionModel()->select(index, QItemSelectionModel::ClearAndSelect | QItemSelectionModel::Rows);
+}
+
+void MainWindow::ReviewClicked()
+/* 打开录制文件进行逐帧查看，或关闭当前查看的录制。
+查看不经过采集流水线：RecordingBrowser 在后台线程中转换并缩放光标周围的帧，GUI只显示缓存中的图像。
+正在进行的采集或回放会先停止，因为两者使用同一个渲染控件。 */
+{
+    if (m_recordingBrowser)
+    {
+        CloseReview();
+        return;
+    }
+
+    QString const fileName = QFileDialog::getOpenFileName(this, "Review Recording", QString(), "Recordings (*.vmbrec)");
+    if (fileName.isEmpty())
+    {
+        return;
+    }
+
+    if (m_acquisitionManager.IsAcquisitionActive())
+    {
+        StopAcquisition();
+    }
+
+    try
+    {
+        VmbC::Examples::RecordingBrowser::Settings settings;
+        settings.m_fileName = fileName.toLocal8Bit().constData();
+        settings.m_memoryBudget = m_reviewMemoryBudget;
+        m_recordingBrowser.reset(new VmbC::Examples::RecordingBrowser(settings, m_reviewRenderer));
+    }
+    catch (VmbException const& ex)
+    {
+        Log(ex);
+        return;
+    }
+
+    auto const& reader = m_recordingBrowser->GetReader();
+    Log("Reviewing " + fileName.toStdString() + ": " + std::to_string(reader.GetFrameCount()) + " frames"
+        + (reader.IsIndexRebuilt() ? " (index rebuilt)" : ""));
+
+    {
+        QSignalBlocker blocker(m_ui->m_reviewSlider);
+        m_ui->m_reviewSlider->setRange(0, static_cast<int>((std::min)(reader.GetFrameCount() - 1, size_t(std::numeric_limits<int>::max()))));
+    }
+    m_ui->m_reviewControls->setVisible(true);
+    m_ui->m_reviewButton->setText(Text::CloseReview());
+    SeekReview(0, 1);
+}
+
+void MainWindow::CloseReview()
+{
+    if (!m_recordingBrowser)
+    {
+        return;
+    }
+
+    m_reviewTimer->stop();
+    m_ui->m_reviewPlayButton->setText(Text::Play());
+    m_recordingBrowser.reset();
+    m_ui->m_reviewControls->setVisible(false);
+    m_ui->m_reviewButton->setText(Text::ReviewRecording());
+    m_ui->m_renderLabel->setPixmap(QPixmap());
+}
+
+void MainWindow::SeekReview(size_t index, int direction)
+{
+    auto const& reader = m_recordingBrowser->GetReader();
+    m_reviewPosition = index;
+    {
+        QSignalBlocker blocker(m_ui->m_reviewSlider);
+        m_ui->m_reviewSlider->setValue(static_cast<int>(index));
+    }
+
+    auto const& entry = reader.GetIndexEntry(index);
+    auto const firstTimestamp = reader.GetIndexEntry(0).m_timestamp;
+    m_ui->m_reviewPositionLabel->setText(QString("%1 / %2  ID %3  %4 s")
+                                         .arg(index + 1)
+                                         .arg(reader.GetFrameCount())
+                                         .arg(entry.m_frameId)
+                                         .arg(entry.m_timestamp > firstTimestamp ? (entry.m_timestamp - firstTimestamp) / ReviewTimestampFrequency : 0.0, 0, 'f', 3));
+
+    ShowReviewFrame(*m_ui->m_renderLabel, m_recordingBrowser->Seek(index, direction));
+}
+
+void MainWindow::RestartReviewClock()
+{
+    m_reviewClockStart = std::chrono::steady_clock::now();
+    m_reviewTimestampStart = m_recordingBrowser->GetReader().GetIndexEntry(m_reviewPosition).m_timestamp;
+}
+
+void MainWindow::ReviewSliderChanged(int value)
+{
+    if (!m_recordingBrowser)
+    {
+        return;
+    }
+    size_t const index = static_cast<size_t>(value);
+    SeekReview(index, (index < m_reviewPosition) ? -1 : 1);
+    if (m_reviewTimer->isActive())
+    {
+        RestartReviewClock();
+    }
+}
+
+void MainWindow::ReviewStepBackwardClicked()
+{
+    if (m_recordingBrowser && m_reviewPosition != 0)
+    {
+        m_reviewTimer->stop();
+        m_ui->m_reviewPlayButton->setText(Text::Play());
+        SeekReview(m_reviewPosition - 1, -1);
+    }
+}
+
+void MainWindow::ReviewStepForwardClicked()
+{
+    if (m_recordingBrowser && m_reviewPosition + 1 < m_recordingBrowser->GetReader().GetFrameCount())
+    {
+        m_reviewTimer->stop();
+        m_ui->m_reviewPlayButton->setText(Text::Play());
+        SeekReview(m_reviewPosition + 1, 1);
+    }
+}
+
+void MainWindow::ReviewPlayClicked()
+{
+    if (!m_recordingBrowser)
+    {
+        return;
+    }
+
+    if (m_reviewTimer->isActive())
+    {
+        m_reviewTimer->stop();
+        m_ui->m_reviewPlayButton->setText(Text::Play());
+        return;
+    }
+
+    // restart at the other end, if playing towards the end of the recording already reached
+    double const speed = m_ui->m_reviewSpeedBox->currentData().toDouble();
+    size_t const lastIndex = m_recordingBrowser->GetReader().GetFrameCount() - 1;
+    if (speed > 0 && m_reviewPosition == lastIndex)
+    {
+        SeekReview(0, 1);
+    }
+    else if (speed < 0 && m_reviewPosition == 0)
+    {
+        SeekReview(lastIndex, -1);
+    }
+
+    RestartReviewClock();
+    m_reviewTimer->start();
+    m_ui->m_reviewPlayButton->setText(Text::Pause());
+}
+
+void MainWindow::ReviewSpeedChanged()
+{
+    if (m_recordingBrowser && m_reviewTimer->isActive())
+    {
+        RestartReviewClock();
+    }
+}
+
+void MainWindow::AdvanceReview()
+/* 播放时定时调用：根据经过的时间和选定的速度计算当前应显示的录制时间戳，并通过索引（二分查找）找到该时刻可见的帧。
+只有位置变化时才移动光标；光标处的帧尚未缓存时保持显示上一帧，因此渲染跟不上时会跳过帧而不是减慢播放。
+到达录制的开头或结尾时停止播放。 */
+{
+    if (!m_recordingBrowser)
+    {
+        m_reviewTimer->stop();
+        return;
+    }
+
+    auto const& reader = m_recordingBrowser->GetReader();
+    double const speed = m_ui->m_reviewSpeedBox->currentData().toDouble();
+    double const elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - m_reviewClockStart).count();
+    double const timestamp = static_cast<double>(m_reviewTimestampStart) + elapsed * speed * ReviewTimestampFrequency;
+    size_t const lastIndex = reader.GetFrameCount() - 1;
+
+    size_t index;
+    bool finished;
+    if (timestamp <= static_cast<double>(reader.GetIndexEntry(0).m_timestamp))
+    {
+        index = 0;
+        finished = (speed < 0);
+    }
+    else
+    {
+        index = reader.FindTimestamp(static_cast<VmbUint64_t>(timestamp));
+        finished = (speed > 0 && index == lastIndex);
+    }
+
+    if (index != m_reviewPosition)
+    {
+        SeekReview(index, (speed < 0) ? -1 : 1);
+    }
+
+    if (finished)
+    {
+        m_reviewTimer->stop();
+        m_ui->m_reviewPlayButton->setText(Text::Play());
+    }
+}
+
+void MainWindow::DisplayReviewFrame()
+{
+    if (m_recordingBrowser)
+    {
+        ShowReviewFrame(*m_ui->m_renderLabel, m_recordingBrowser->GetCachedFrame(m_reviewPosition));
+    }
+}
+
+void MainWindow::ReviewFrameReady()
+{
+    emit ReviewFrameAvailable();
+}
+
+void MainWindow::SetReviewMemoryBudget(size_t bytes)
+{
+    m_reviewMemoryBudget = bytes;
+    if (m_recordingBrowser)
+    {
+        m_recordingBrowser->SetMemoryBudget(bytes);
+    }
+}
+
+void MainWindow::SetRecordingCompression(unsigned const threads)
+{
+    m_recordingCompressionThreads = threads;
+}
+
+void MainWindow::RecordClicked()
+{
+    if (m_recordingSink)
+    {
+        StopRecording();
+        return;
+    }
+
+    QString const fileName = QFileDialog::getSaveFileName(this, "Record Frames", Text::RecordingFileName(), "Recordings (*.vmbrec)");
+    if (fileName.isEmpty() || !m_acquisitionManager.IsAcquisitionActive())
+    {
+        return;
+    }
+
+    try
+    {
+        m_recordingSink.reset(new VmbC::Examples::RecordingSink(GetRecordingSettings(fileName)));
+        m_acquisitionManager.AddRawFrameSink(*m_recordingSink, DirectSink("recording", RecordingSinkPriority));
+    }
+    catch (VmbException const& ex)
+    {
+        m_recordingSink.reset();
+        Log(ex);
+        return;
+    }
+
+    Log("Recording to " + m_recordingSink->GetFileName());
+    m_ui->m_recordButton->setText(Text::StopRecording());
+}
+
+VmbC::Examples::RecordingSink::Settings MainWindow::GetRecordingSettings(QString const& fileName) const
+{
+    VmbC::Examples::RecordingSink::Settings settings;
+    settings.m_fileName = fileName.toLocal8Bit().constData();
+    settings.m_compressionThreads = m_recordingCompressionThreads;
+    if (auto const cameraInfo = GetSelectedCamera())
+    {
+        auto const toString = [](char const* value) { return std::string(value == nullptr ? "" : value); };
+        settings.m_cameraId = toString(cameraInfo->cameraIdString);
+        settings.m_cameraName = toString(cameraInfo->cameraName);
+        settings.m_modelName = toString(cameraInfo->modelName);
+        settings.m_serialNumber = toString(cameraInfo->serialString);
+    }
+    return settings;
+}
+
+void MainWindow::EnableHistory(VmbC::Examples::HistoryBuffer::Settings const& settings, std::chrono::steady_clock::duration postTriggerDuration)
+{
+    if (m_historyBuffer)
+    {
+        m_acquisitionManager.RemoveRawFrameSink(*m_historyBuffer);
+        m_historyBuffer.reset();
+    }
+
+    try
+    {
+        m_historyBuffer.reset(new VmbC::Examples::HistoryBuffer(settings));
+        m_acquisitionManager.AddRawFrameSink(*m_historyBuffer, DirectSink("history", HistorySinkPriority));
+    }
+    catch (VmbException const& ex)
+    {
+        m_historyBuffer.reset();
+        Log(ex);
+        return;
+    }
+    m_historyPostTriggerDuration = postTriggerDuration;
+
+    Log(QString("Keeping up to %1 s / %2 MiB of frames in memory")
+        .arg(std::chrono::duration<double>(settings.m_duration).count(), 0, 'f', 1)
+        .arg(m_historyBuffer->GetStatistics().m_capacity >> 20)
+        .toStdString());
+    m_ui->m_saveHistoryButton->setEnabled(true);
+}
+
+void MainWindow::SaveHistoryClicked()
+/* 不弹出对话框，直接在工作目录中写入文件，以便在发现缺陷时立即保存。
+转存在后台线程中进行，不会暂停采集；完成后通过 HistoryDumpFinished 信号在GUI线程中输出日志。 */
+{
+    if (!m_historyBuffer)
+    {
+        return;
+    }
+
+    VmbC::Examples::HistoryBuffer::DumpSettings settings;
+    settings.m_recording = GetRecordingSettings(Text::HistoryFileName());
+    settings.m_postTriggerDuration = m_historyPostTriggerDuration;
+    settings.m_finished = [this](VmbC::Examples::HistoryBuffer::DumpResult const& result)
+    {
+        emit HistoryDumpFinished(QString("History saved to %1: %2 frames%3")
+                                 .arg(QString::fromLocal8Bit(result.m_fileName.c_str()))
+                                 .arg(result.m_framesWritten)
+                                 .arg(result.m_writeFailed ? ", writing failed; the file is incomplete" : ""));
+    };
+
+    try
+    {
+        m_historyBuffer->Dump(settings);
+    }
+    catch (VmbException const& ex)
+    {
+        Log(ex);
+        return;
+    }
+    Log("Saving history to " + settings.m_recording.m_fileName);
+}
+
+void MainWindow::EnableSnapshots(VmbC::Examples::SnapshotExporter::Settings settings, size_t framesPerClick)
+{
+    if (m_snapshotExporter)
+    {
+        m_acquisitionManager.RemoveRawFrameSink(*m_snapshotExporter);
+        m_snapshotExporter.reset();
+    }
+
+    settings.m_prefix = "AsynchronousGrabSnapshot";
+    settings.m_finished = [this](VmbC::Examples::SnapshotExporter::Result const& result)
     {
-        return QString::fromStdString("Vmb C AsynchronousGrab API Version " + vmbCVersion);
-    }
+        emit SnapshotSaved(result.m_success
+                           ? QString("Snapshot of frame %1 saved to %2").arg(result.m_frameId).arg(QString::fromLocal8Bit(result.m_fileName.c_str()))
+                           : QString("Saving frame %1 failed: %2").arg(result.m_frameId).arg(QString::fromStdString(result.m_error)));
+    };
+    m_snapshotExporter.reset(new VmbC::Examples::SnapshotExporter(settings));
+    m_acquisitionManager.AddRawFrameSink(*m_snapshotExporter, DirectSink("snapshots", SnapshotSinkPriority));
+    m_snapshotFrames = (std::max)(framesPerClick, size_t(1));
+    m_snapshotRecent = (settings.m_recentFrames != 0);
+    m_ui->m_snapshotButton->setEnabled(m_acquisitionManager.IsAcquisitionActive());
 }
 
-namespace
+void MainWindow::SnapshotClicked()
+/* 只在编码队列中预留位置（或复制保留的最近帧），转换和写文件在编码线程中进行，GUI线程和转码线程不会等待；
+队列已满时在日志中说明只接受了多少帧。 */
 {
-    struct SelectableCheckVisitor : VmbC::Examples::ModuleData::Visitor
+    if (!m_snapshotExporter)
     {
-        bool m_selectable { false };
+        return;
+    }
 
-        void Visit(VmbCameraInfo_t const&) override
-        {
-            m_selectable = true;
-        }
-    };
+    size_t const accepted = m_snapshotRecent
+        ? m_snapshotExporter->CaptureRecent(m_snapshotFrames)
+        : m_snapshotExporter->Capture(m_snapshotFrames);
+    if (accepted < m_snapshotFrames)
+    {
+        Log(QString("Snapshot queue backlogged: %1 of %2 frames accepted").arg(accepted).arg(m_snapshotFrames).toStdString());
+    }
+}
 
-    struct CameraInfoRetrievalVisitor : VmbC::Examples::ModuleData::Visitor
+void MainWindow::EnableVideoArchive(VmbC::Examples::VideoEncoderSink::Settings const& settings)
+{
+    if (!VmbC::Examples::VideoEncoderSink::IsAvailable())
     {
-        VmbCameraInfo_t const* m_info { nullptr };
+        Log("Video encoding is not available; the program was built without libavcodec");
+        return;
+    }
+    m_videoSettings = settings;
+    m_videoArchiveEnabled = true;
+    Log(QString("Encoding videos at %1 fps").arg(settings.m_frameRate, 0, 'f', 1).toStdString());
+}
 
-        void Visit(VmbCameraInfo_t const& info) override
-        {
-            m_info = &info;
-        }
-    };
+void MainWindow::SetTimeLapseInterval(std::chrono::steady_clock::duration interval)
+{
+    m_acquisitionManager.SetTimeLapseInterval(interval);
+    Log(QString("Time-lapse: triggering a frame every %1 s").arg(std::chrono::duration<double>(interval).count(), 0, 'f', 1).toStdString());
 }
 
-MainWindow::MainWindow(QWidget* parent, Qt::WindowFlags flags)
-    : QMainWindow(parent, flags),
-    m_ui(new Gui()),
-    m_acquisitionManager(*this),
-    m_log(new LogEntryListModel())
+void MainWindow::EnableSharedFrameExport(VmbC::Examples::SharedFrameExport::Settings const& settings)
 {
-    m_ui->setupUi(this);
-    SetupLogView();
+    m_acquisitionManager.EnableSharedFrameExport(settings);
+    Log("Exporting the frames of camera acquisitions via shared memory " + settings.m_name);
+}
+
+void MainWindow::EnableChunkMetadata(VmbUint32_t const fields)
+{
+    m_acquisitionManager.SetChunkMetadata(fields);
+    Log("Reading the chunk metadata of the frames");
+}
 
+void MainWindow::EnableAdaptivePreview(VmbC::Examples::ImageTranscoder::AdaptiveQualitySettings settings)
+/* 视频编码器与显示接收同一转换结果，抽帧、降采样和快速去马赛克都会降低存档的质量，因此启用视频存档时不使用自适应预览。 */
+{
+    if (m_videoArchiveEnabled)
+    {
+        Log("The adaptive preview is not used while the video archive is enabled");
+        return;
+    }
     try
     {
-        m_apiController.reset(new ApiController(*this));
+        m_acquisitionManager.SetAdaptivePreview(settings);
     }
     catch (VmbException const& ex)
     {
         Log(ex);
+        return;
     }
+    Log(QString("Adapting the preview quality to a latency of %1 ms").arg(settings.m_targetLatency.count()).toStdString());
+}
 
-    if (m_apiController)
+void MainWindow::AttachToDaemon(VmbUint16_t const port)
+{
+    m_daemonPort = port;
+    Log(QString("Acquiring via the acquisition daemon at 127.0.0.1:%1").arg(port).toStdString());
+}
+
+void MainWindow::StartVideo()
+/* 每次开始采集时在工作目录中创建新的视频文件；编码器只接收转换后的帧，复制到队列中后立即返回，不会延迟帧重新入队。 */
+{
+    if (!m_videoArchiveEnabled)
     {
-        SetupUi(*(m_apiController.get()));
-        SetupCameraTree();
-        m_acquisitionManager.SetOutputSize(m_ui->m_renderLabel->size());
-        QObject::connect(m_ui->m_renderLabel, &ImageLabel::sizeChanged, this, &MainWindow::ImageLabelSizeChanged);
+        return;
     }
-    else
+
+    auto settings = m_videoSettings;
+    settings.m_fileName = Text::VideoFileName(VmbC::Examples::VideoEncoderSink::GetExtension(settings.m_codec)).toStdString();
+    try
     {
-        setWindowTitle(Text::WindowTitleStartupError());
+        m_videoEncoderSink.reset(new VmbC::Examples::VideoEncoderSink(settings));
+    }
+    catch (VmbException const& ex)
+    {
+        Log(ex);
+        return;
     }
+    m_acquisitionManager.AddConvertedFrameSink(*m_videoEncoderSink);
+    Log("Encoding video to " + settings.m_fileName);
 }
 
-void MainWindow::StartStopClicked()
+void MainWindow::StopVideo()
 {
-    if (m_acquisitionManager.IsAcquisitionActive())
+    if (!m_videoEncoderSink)
     {
-        StopAcquisition();
+        return;
     }
-    else
+
+    m_acquisitionManager.RemoveConvertedFrameSink(*m_videoEncoderSink);
+    m_videoEncoderSink->Stop();
+    auto const statistics = m_videoEncoderSink->GetStatistics();
+    Log(QString("Video %1 completed: %2 frames, %3 MiB, %4 skipped for the frame rate, %5 dropped, %6 per frame%7")
+        .arg(QString::fromStdString(m_videoEncoderSink->GetFileName()))
+        .arg(statistics.m_framesEncoded)
+        .arg(statistics.m_bytesWritten / (1024.0 * 1024.0), 0, 'f', 1)
+        .arg(statistics.m_framesSkipped)
+        .arg(statistics.m_framesDropped)
+        .arg(Text::Milliseconds(statistics.m_averageEncodeTime))
+        .arg(statistics.m_error.empty() ? QString() : ", error: " + QString::fromStdString(statistics.m_error))
+        .toStdString());
+    m_videoEncoderSink.reset();
+}
+
+void MainWindow::StopRecording()
+/* 先把RecordingSink从AcquisitionManager中移除，保证之后不会再有帧写入环形缓冲区，
+然后等待剩余的帧写入文件，并在日志中输出写入速率和环形缓冲区的最高占用量，用于判断缓冲区大小是否足够；
+启用压缩时还按像素格式输出压缩比和每个线程的压缩速率。 */
+{
+    if (!m_recordingSink)
     {
-        auto selectionModel = m_ui->m_cameraSelectionTree->selectionModel();
-        if (selectionModel->hasSelection())
-        {
-            auto selection = selectionModel->selectedRows();
-            if (!selection.isEmpty())
-            {
-                auto modelData = VmbC::Examples::ModuleTreeModel::GetModule(selection.at(0));
-                if (modelData != nullptr)
-                {
-                    CameraInfoRetrievalVisitor visitor;
-                    modelData->Accept(visitor);
-                    
-                    if (visitor.m_info != nullptr)
-                    {
-                        StartAcquisition(*(visitor.m_info));
-                    }
-                }
-            }
-        }
+        return;
     }
 
+    m_acquisitionManager.RemoveRawFrameSink(*m_recordingSink);
+    m_recordingSink->Stop();
+    auto const statistics = m_recordingSink->GetStatistics();
+
+    constexpr double MiB = 1024.0 * 1024.0;
+    Log(QString("Recording stopped: %1 frames, %2 MiB at %3 MB/s, %4 dropped, ring high-water %5 of %6 MiB (%7%8)")
+        .arg(statistics.m_framesRecorded)
+        .arg(statistics.m_bytesWritten / MiB, 0, 'f', 1)
+        .arg(statistics.m_megabytesPerSecond, 0, 'f', 1)
+        .arg(statistics.m_framesDropped)
+        .arg(statistics.m_ringHighWaterMark / MiB, 0, 'f', 1)
+        .arg(statistics.m_ringSize / MiB, 0, 'f', 1)
+        .arg(statistics.m_usesIoUring ? "io_uring" : "synchronous writes")
+        .arg(statistics.m_usesDirectIo ? ", unbuffered" : "")
+        .toStdString());
+    for (auto const& format : statistics.m_compression)
+    {
+        Log(QString("Compressed pixel format 0x%1: %2 frames, ratio %3, %4 MB/s per thread on %5 threads, %6 frames stored uncompressed")
+            .arg(format.m_pixelFormat, 8, 16, QChar('0'))
+            .arg(format.m_frames)
+            .arg(format.m_ratio, 0, 'f', 2)
+            .arg(format.m_megabytesPerSecond, 0, 'f', 1)
+            .arg(statistics.m_compressionThreads)
+            .arg(format.m_framesUncompressed)
+            .toStdString());
+    }
+    if (statistics.m_writeFailed)
+    {
+        Log("Writing " + m_recordingSink->GetFileName() + " failed; the recording is incomplete");
+    }
+
+    m_recordingSink.reset();
+    m_ui->m_recordButton->setText(Text::StartRecording());
 }
 
 void MainWindow::ImageLabelSizeChanged(QSize newSize)
 {
-    m_acquisitionManager.SetOutputSize(newSize);
+    m_frameSink.SetOutputSize(newSize);
+    m_reviewRenderer.SetOutputSize(newSize);
+    if (m_recordingBrowser)
+    {
+        // the cached images were scaled to the old size
+        m_recordingBrowser->Invalidate();
+    }
 }
 
 void MainWindow::RenderImage()
 {
     QPixmap pixmap;
+    VmbUint64_t frameId;
+    std::chrono::steady_clock::time_point queuedTime;
     {
         std::lock_guard<std::mutex> lock(m_imageSynchronizer);
 
@@ -168,6 +943,9 @@ void MainWindow::RenderImage()
         {
             m_renderingRequired = false;
             std::swap(pixmap, m_queuedImage);
+            frameId = m_queuedFrameId;
+            queuedTime = m_queuedTime;
+            m_displayedMetadata = m_queuedMetadata;
         }
         else
         {
@@ -175,7 +953,368 @@ void MainWindow::RenderImage()
         }
     }
 
+    ASYNCHRONOUSGRAB_TRACE_COMPLETE("WaitForGuiThread", frameId, queuedTime, std::chrono::steady_clock::now());
+    ASYNCHRONOUSGRAB_TRACE_SCOPE("RenderImage", frameId);
     m_ui->m_renderLabel->setPixmap(pixmap);
+
+    ++m_imagesDisplayed;
+    if (m_statisticsTimer->isActive())
+    {
+        std::chrono::steady_clock::time_point receiveTime;
+        if (m_acquisitionManager.GetReceiveTime(frameId, receiveTime))
+        {
+            auto const latency = std::chrono::steady_clock::now() - receiveTime;
+            m_latencySum += latency;
+            m_latencyMax = (std::max)(m_latencyMax, latency);
+            ++m_latencySamples;
+        }
+    }
+}
+
+void MainWindow::StartMetricsServer(VmbUint16_t port)
+{
+    try
+    {
+        m_metricsServer.reset(new VmbC::Examples::MetricsServer(m_acquisitionManager.GetMetrics(), port));
+        Log("Metrics available at http://127.0.0.1:" + std::to_string(m_metricsServer->GetPort()) + "/metrics");
+    }
+    catch (VmbException const& ex)
+    {
+        Log(ex);
+    }
+}
+
+void MainWindow::StartPreviewServer(VmbC::Examples::MjpegPreviewServer::Settings const& settings)
+{
+    if (!VmbC::Examples::MjpegPreviewServer::IsAvailable())
+    {
+        Log("The preview server is not available; the program was built without libavcodec");
+        return;
+    }
+    try
+    {
+        m_previewServer.reset(new VmbC::Examples::MjpegPreviewServer(settings));
+        m_acquisitionManager.AddConvertedFrameSink(*m_previewServer);
+        Log("Preview available at http://127.0.0.1:" + std::to_string(m_previewServer->GetPort()) + "/stream");
+    }
+    catch (VmbException const& ex)
+    {
+        m_previewServer.reset();
+        Log(ex);
+    }
+}
+
+void MainWindow::StartFrameStreamServer(VmbC::Examples::FrameStreamServer::Settings const& settings)
+{
+    try
+    {
+        m_frameStreamServer.reset(new VmbC::Examples::FrameStreamServer(settings));
+        m_acquisitionManager.AddRawFrameSink(*m_frameStreamServer, DirectSink("stream", FrameStreamSinkPriority));
+        Log("Sending the frames to subscribers of port " + std::to_string(m_frameStreamServer->GetPort()));
+    }
+    catch (VmbException const& ex)
+    {
+        m_frameStreamServer.reset();
+        Log(ex);
+    }
+}
+
+void MainWindow::StartWorkQueueServer(VmbC::Examples::WorkQueueServer::Settings const& settings)
+{
+    try
+    {
+        m_workQueueServer.reset(new VmbC::Examples::WorkQueueServer(settings, nullptr));
+        m_acquisitionManager.AddRawFrameSink(*m_workQueueServer, DirectSink("workers", WorkQueueSinkPriority));
+        Log("Distributing the frames to workers of port " + std::to_string(m_workQueueServer->GetPort()));
+    }
+    catch (VmbException const& ex)
+    {
+        m_workQueueServer.reset();
+        Log(ex);
+    }
+}
+
+void MainWindow::ToggleStatistics()
+{
+    if (m_statisticsTimer->isActive())
+    {
+        m_statisticsTimer->stop();
+        m_ui->m_renderLabel->SetOverlayText(QString());
+    }
+    else
+    {
+        ResetStatistics();
+        m_statisticsTimer->start();
+        UpdateStatistics();
+    }
+}
+
+void MainWindow::ResetStatistics()
+{
+    m_lastStatistics = m_acquisitionManager.GetStatistics();
+    m_lastStatisticsTime = std::chrono::steady_clock::now();
+    m_lastImagesDisplayed = m_imagesDisplayed;
+    m_latencySum = {};
+    m_latencyMax = {};
+    m_latencySamples = 0;
+}
+
+void MainWindow::UpdateStatistics()
+/* 以固定的低频率（StatisticsUpdateIntervalMs）读取 AcquisitionManager 和 ImageTranscoder 的无锁计数器，
+根据与上一次读取的差值计算帧率、平均转码时间以及从接收帧到显示的延迟，并更新渲染控件上的覆盖文本。
+帧回调和转码线程只更新原子计数器，因此显示统计信息不会在每一帧上产生额外的内存分配。 */
+{
+    auto const now = std::chrono::steady_clock::now();
+    auto const statistics = m_acquisitionManager.GetStatistics();
+    double const seconds = std::chrono::duration<double>(now - m_lastStatisticsTime).count();
+
+    VmbUint64_t imagesReplaced;
+    {
+        std::lock_guard<std::mutex> lock(m_imageSynchronizer);
+        imagesReplaced = m_imagesReplaced;
+    }
+
+    auto const& transcoder = statistics.m_transcoder;
+    auto const& lastTranscoder = m_lastStatistics.m_transcoder;
+    auto const conversions = transcoder.m_framesConverted - lastTranscoder.m_framesConverted;
+
+    QString text;
+    text += QString("Camera    %1  incomplete %2  missing %3\n")
+        .arg(Text::Rate(statistics.m_framesReceived - m_lastStatistics.m_framesReceived, seconds))
+        .arg(statistics.m_framesIncomplete)
+        .arg(statistics.m_framesMissing);
+    text += QString("Converted %1  dropped %2\n")
+        .arg(Text::Rate(conversions, seconds))
+        .arg(transcoder.m_framesDropped);
+    text += QString("Displayed %1  dropped %2\n")
+        .arg(Text::Rate(m_imagesDisplayed - m_lastImagesDisplayed, seconds))
+        .arg(imagesReplaced);
+    text += QString("Transcode %1  queue depth %2\n")
+        .arg(Text::Milliseconds(conversions == 0 ? std::chrono::steady_clock::duration{}
+                                                 : (transcoder.m_conversionTime - lastTranscoder.m_conversionTime) / static_cast<std::chrono::steady_clock::rep>(conversions)))
+        .arg(transcoder.m_queueDepth);
+    text += QString("Latency   %1  max %2")
+        .arg(Text::Milliseconds(m_latencySamples == 0 ? std::chrono::steady_clock::duration{} : m_latencySum / m_latencySamples))
+        .arg(Text::Milliseconds(m_latencyMax));
+    if (transcoder.m_qualityLevels != 0)
+    {
+        auto const level = m_acquisitionManager.GetPreviewQualityLevel(transcoder.m_qualityLevel);
+        text += QString("\nQuality   level %1/%2  every %3  1/%4 size  %5 demosaic  skipped %6  changes %7")
+            .arg(transcoder.m_qualityLevel)
+            .arg(transcoder.m_qualityLevels - 1)
+            .arg(level.m_frameInterval)
+            .arg(level.m_decimation)
+            .arg(level.m_fastDebayer ? "2x2" : "full")
+            .arg(transcoder.m_framesSkipped)
+            .arg(transcoder.m_qualityChanges);
+    }
+    if (m_recordingSink)
+    {
+        auto const recording = m_recordingSink->GetStatistics();
+        text += QString("\nRecording %1 MB/s  ring high-water %2%  dropped %3")
+            .arg(recording.m_megabytesPerSecond, 7, 'f', 1)
+            .arg(recording.m_ringSize == 0 ? 0 : 100 * recording.m_ringHighWaterMark / recording.m_ringSize)
+            .arg(recording.m_framesDropped);
+        for (auto const& format : recording.m_compression)
+        {
+            text += QString("  0x%1 x%2")
+                .arg(format.m_pixelFormat, 8, 16, QChar('0'))
+                .arg(format.m_ratio, 0, 'f', 2);
+        }
+    }
+    if (m_historyBuffer)
+    {
+        auto const history = m_historyBuffer->GetStatistics();
+        text += QString("\nHistory   %1 frames  %2 s  %3 of %4 MiB  dropped %5%6")
+            .arg(history.m_framesInHistory)
+            .arg(std::chrono::duration<double>(history.m_historyDuration).count(), 0, 'f', 1)
+            .arg(history.m_bytesInHistory / (1024.0 * 1024.0), 0, 'f', 1)
+            .arg(history.m_capacity / (1024.0 * 1024.0), 0, 'f', 1)
+            .arg(history.m_framesDropped)
+            .arg(history.m_dumping ? "  saving" : "");
+    }
+    if (m_snapshotExporter)
+    {
+        auto const snapshots = m_snapshotExporter->GetStatistics();
+        text += QString("\nSnapshots saved %1  failed %2  rejected %3  queue %4/%5%6  encode %7")
+            .arg(snapshots.m_framesSaved)
+            .arg(snapshots.m_framesFailed)
+            .arg(snapshots.m_framesRejected)
+            .arg(snapshots.m_backlog)
+            .arg(snapshots.m_queueSize)
+            .arg(snapshots.IsBacklogged() ? " (backlogged)" : "")
+            .arg(Text::Milliseconds(snapshots.m_averageEncodeTime));
+    }
+    if (m_videoEncoderSink)
+    {
+        auto const video = m_videoEncoderSink->GetStatistics();
+        text += QString("\nVideo     %1 frames  %2 MiB  skipped %3  dropped %4  queue %5  encode %6%7")
+            .arg(video.m_framesEncoded)
+            .arg(video.m_bytesWritten / (1024.0 * 1024.0), 0, 'f', 1)
+            .arg(video.m_framesSkipped)
+            .arg(video.m_framesDropped)
+            .arg(video.m_queueDepth)
+            .arg(Text::Milliseconds(video.m_averageEncodeTime))
+            .arg(video.m_error.empty() ? "" : "  failed");
+    }
+    if (m_previewServer)
+    {
+        auto const preview = m_previewServer->GetStatistics();
+        text += QString("\nPreview   %1 clients  %2 frames  %3 fps  q %4  %5 KiB  skipped %6  dropped %7  client skips %8%9")
+            .arg(preview.m_clients)
+            .arg(preview.m_framesEncoded)
+            .arg(preview.m_frameRate, 0, 'f', 1)
+            .arg(preview.m_quantizer)
+            .arg(preview.m_averageFrameSize / 1024.0, 0, 'f', 1)
+            .arg(preview.m_framesSkipped)
+            .arg(preview.m_framesDropped)
+            .arg(preview.m_framesSkippedByClients)
+            .arg(preview.m_error.empty() ? "" : "  failed");
+    }
+    if (m_frameStreamServer)
+    {
+        auto const stream = m_frameStreamServer->GetStatistics();
+        double throughput = 0.0;
+        VmbC::Examples::FrameStreamServer::Clock::duration maxLag {};
+        VmbUint64_t subscriberDrops = 0;
+        for (auto const& subscriber : stream.m_subscribers)
+        {
+            throughput += subscriber.m_throughput;
+            maxLag = (std::max)(maxLag, subscriber.m_lag);
+            subscriberDrops += subscriber.m_framesDropped;
+        }
+        text += QString("\nStream    %1 subscribers  %2 frames  dropped %3  subscriber drops %4  %5 MiB/s  max lag %6")
+            .arg(stream.m_subscribers.size())
+            .arg(stream.m_framesReceived)
+            .arg(stream.m_framesDropped)
+            .arg(subscriberDrops)
+            .arg(throughput / (1024.0 * 1024.0), 0, 'f', 1)
+            .arg(Text::Milliseconds(maxLag));
+    }
+    if (m_workQueueServer)
+    {
+        auto const work = m_workQueueServer->GetStatistics();
+        double resultRate = 0.0;
+        for (auto const& worker : work.m_workers)
+        {
+            resultRate += worker.m_resultRate;
+        }
+        text += QString("\nWorkers   %1 workers  %2 frames  dropped %3  queued %4  pending %5  lost %6  %7 results/s")
+            .arg(work.m_workers.size())
+            .arg(work.m_framesReceived)
+            .arg(work.m_framesDropped)
+            .arg(work.m_framesQueued)
+            .arg(work.m_pendingResults)
+            .arg(work.m_framesLost)
+            .arg(resultRate, 0, 'f', 1);
+    }
+    auto const sinks = m_acquisitionManager.GetRawSinkStatistics();
+    if (!sinks.m_edges.empty())
+    {
+        text += QString("\nSinks   ");
+        for (auto const& edge : sinks.m_edges)
+        {
+            text += QString("  %1 %2 ms")
+                .arg(QString::fromStdString(edge.m_name))
+                .arg(std::chrono::duration<double, std::milli>(edge.m_averageDeliveryTime).count(), 0, 'f', 2);
+            if (edge.m_queueDepth != 0)
+            {
+                text += QString(" queued %1/%2 dropped %3 evicted %4")
+                    .arg(edge.m_framesQueued)
+                    .arg(edge.m_queueDepth)
+                    .arg(edge.m_framesDropped)
+                    .arg(edge.m_framesEvicted);
+            }
+        }
+    }
+    VmbC::Examples::SharedFrameExport::Statistics sharedExport;
+    if (m_acquisitionManager.GetSharedExportStatistics(sharedExport))
+    {
+        text += QString("\nShared    %1 frames  readers %2  held %3  reclaimed %4  waiting %5")
+            .arg(sharedExport.m_framesPublished)
+            .arg(sharedExport.m_readers)
+            .arg(sharedExport.m_framesHeld)
+            .arg(sharedExport.m_framesReclaimed)
+            .arg(sharedExport.m_framesWaiting);
+    }
+    auto const timeLapse = m_acquisitionManager.GetTimeLapseStatistics();
+    if (timeLapse.m_triggers != 0)
+    {
+        text += QString("\nTimeLapse every %1 s  triggers %2  failed %3  idle cpu %4%")
+            .arg(std::chrono::duration<double>(timeLapse.m_interval).count(), 0, 'f', 1)
+            .arg(timeLapse.m_triggers)
+            .arg(timeLapse.m_triggerFailures)
+            .arg(timeLapse.m_idleCpuPercent, 0, 'f', 2);
+    }
+    if (m_recordingBrowser)
+    {
+        auto const review = m_recordingBrowser->GetStatistics();
+        auto const lookups = review.m_cacheHits + review.m_cacheMisses;
+        text += QString("\nReview    cache %1 of %2 MiB  %3 frames  hits %4%")
+            .arg(review.m_cachedBytes / (1024.0 * 1024.0), 0, 'f', 1)
+            .arg(review.m_memoryBudget / (1024.0 * 1024.0), 0, 'f', 1)
+            .arg(review.m_cachedFrames)
+            .arg(lookups == 0 ? 0 : 100 * review.m_cacheHits / lookups);
+    }
+    if (m_acquisitionManager.GetChunkMetadataFields() != 0 || m_displayedMetadata.m_fields != 0)
+    {
+        using VmbC::Examples::MetadataExposureTime;
+        using VmbC::Examples::MetadataGain;
+        using VmbC::Examples::MetadataLineStatus;
+        using VmbC::Examples::MetadataFrameId;
+        using VmbC::Examples::MetadataTimestamp;
+        using VmbC::Examples::MetadataCounter;
+
+        auto const& metadata = m_displayedMetadata;
+        text += QString("\nMetadata");
+        if (metadata.m_fields & MetadataExposureTime)
+        {
+            text += QString("  exposure %1 us").arg(metadata.m_exposureTime, 0, 'f', 1);
+        }
+        if (metadata.m_fields & MetadataGain)
+        {
+            text += QString("  gain %1 dB").arg(metadata.m_gain, 0, 'f', 1);
+        }
+        if (metadata.m_fields & MetadataLineStatus)
+        {
+            text += QString("  lines 0x%1").arg(metadata.m_lineStatus, 0, 16);
+        }
+        if (metadata.m_fields & MetadataFrameId)
+        {
+            text += QString("  frame %1").arg(metadata.m_frameId);
+        }
+        if (metadata.m_fields & MetadataTimestamp)
+        {
+            text += QString("  timestamp %1").arg(metadata.m_timestamp);
+        }
+        if (metadata.m_fields & MetadataCounter)
+        {
+            text += QString("  counter %1").arg(metadata.m_counter);
+        }
+        text += QString("  without metadata %1").arg(statistics.m_framesWithoutMetadata);
+    }
+
+    m_ui->m_renderLabel->SetOverlayText(text);
+
+    m_lastStatistics = statistics;
+    m_lastStatisticsTime = now;
+    m_lastImagesDisplayed = m_imagesDisplayed;
+    m_latencySum = {};
+    m_latencyMax = {};
+    m_latencySamples = 0;
+}
+
+void MainWindow::WriteTrace()
+{
+    QString const fileName = Text::TraceFileName();
+    if (VmbC::Examples::Tracing::WriteChromeTrace(fileName.toLocal8Bit().constData()))
+    {
+        Log("Trace written to " + fileName.toStdString());
+    }
+    else
+    {
+        Log("Unable to write trace to " + fileName.toStdString());
+    }
 }
 
 void MainWindow::SetupUi(VmbC::Examples::ApiController& controller)
@@ -183,6 +1322,33 @@ void MainWindow::SetupUi(VmbC::Examples::ApiController& controller)
     setWindowTitle(Text::WindowTitle(m_apiController->GetVersion()));
     
     QObject::connect(m_ui->m_acquisitionStartStopButton, &QPushButton::clicked, this, &MainWindow::StartStopClicked);
+    QObject::connect(m_ui->m_recordButton, &QPushButton::clicked, this, &MainWindow::RecordClicked);
+    QObject::connect(m_ui->m_openRecordingButton, &QPushButton::clicked, this, &MainWindow::OpenRecordingClicked);
+    m_ui->m_openRecordingButton->setEnabled(true);
+
+    QObject::connect(m_ui->m_saveHistoryButton, &QPushButton::clicked, this, &MainWindow::SaveHistoryClicked);
+    QObject::connect(this, &MainWindow::HistoryDumpFinished, this, [this](QString const& message) { Log(message.toStdString()); }, Qt::ConnectionType::QueuedConnection);
+    QObject::connect(m_ui->m_snapshotButton, &QPushButton::clicked, this, &MainWindow::SnapshotClicked);
+    QObject::connect(this, &MainWindow::SnapshotSaved, this, [this](QString const& message) { Log(message.toStdString()); }, Qt::ConnectionType::QueuedConnection);
+    QObject::connect(this, &MainWindow::RemoteAcquisitionClosed, this, [this]() {
+        if (m_daemonClient && m_acquisitionManager.IsRemoteClosed())
+        {
+            Log("The acquisition daemon stopped the acquisition");
+            StopAcquisition();
+        }
+    }, Qt::ConnectionType::QueuedConnection);
+    QObject::connect(m_ui->m_reviewButton, &QPushButton::clicked, this, &MainWindow::ReviewClicked);
+    m_ui->m_reviewButton->setEnabled(true);
+    QObject::connect(m_ui->m_reviewSlider, &QSlider::valueChanged, this, &MainWindow::ReviewSliderChanged);
+    QObject::connect(m_ui->m_reviewStepBackwardButton, &QToolButton::clicked, this, &MainWindow::ReviewStepBackwardClicked);
+    QObject::connect(m_ui->m_reviewStepForwardButton, &QToolButton::clicked, this, &MainWindow::ReviewStepForwardClicked);
+    QObject::connect(m_ui->m_reviewPlayButton, &QToolButton::clicked, this, &MainWindow::ReviewPlayClicked);
+    for (double const speed : ReviewSpeeds)
+    {
+        m_ui->m_reviewSpeedBox->addItem(QString("%1x").arg(speed), speed);
+    }
+    m_ui->m_reviewSpeedBox->setCurrentIndex(DefaultReviewSpeedIndex);
+    QObject::connect(m_ui->m_reviewSpeedBox, static_cast<void (QComboBox::*)(int)>(&QComboBox::currentIndexChanged), this, &MainWindow::ReviewSpeedChanged);
     QObject::connect(this, &MainWindow::ImageReady, this, static_cast<void (MainWindow::*)()>(&MainWindow::RenderImage), Qt::ConnectionType::QueuedConnection);
 }
 
@@ -195,31 +1361,112 @@ void MainWindow::SetupLogView()
 
 void MainWindow::StartAcquisition(VmbCameraInfo_t const& cameraInfo)
 {
-    bool success = false;
-
+    if (m_daemonPort != 0)
+    {
+        AttachToAcquisition(cameraInfo);
+        return;
+    }
+    CloseReview();
     try
     {
         m_acquisitionManager.StartAcquisition(cameraInfo);
-        success = true;
     }
     catch (VmbException const& ex)
     {
         Log(ex);
+        return;
+    }
+    AcquisitionStarted("Acquisition Started");
+}
+
+void MainWindow::AttachToAcquisition(VmbCameraInfo_t const& cameraInfo)
+/* 由守护进程打开相机并把帧导出到共享内存，本进程只映射这些帧并自己转换、显示，因此窗口关闭或崩溃不会中断采集，
+多个窗口可以同时观看同一台相机。守护进程停止采集时，接收线程通过 RemoteAcquisitionClosed 信号通知GUI线程。 */
+{
+    CloseReview();
+    std::string sharedMemory;
+    try
+    {
+        m_daemonClient.reset(new VmbC::Examples::DaemonClient(m_daemonPort));
+        VmbC::Examples::RemoteCamera::Settings settings;
+        settings.m_name = m_daemonClient->Start(cameraInfo.cameraIdString);
+        settings.m_closed = [this]() { emit RemoteAcquisitionClosed(); };
+        sharedMemory = settings.m_name;
+        m_acquisitionManager.StartRemote(settings);
+    }
+    catch (VmbException const& ex)
+    {
+        m_daemonClient.reset();
+        Log(ex);
+        return;
+    }
+    AcquisitionStarted(std::string("Attached to the acquisition of ") + cameraInfo.cameraIdString + " via " + sharedMemory);
+}
+
+void MainWindow::StartPlayback(VmbC::Examples::PlaybackInfo const& playbackInfo)
+{
+    CloseReview();
+    try
+    {
+        m_acquisitionManager.StartPlayback(playbackInfo.m_settings);
+    }
+    catch (VmbException const& ex)
+    {
+        Log(ex);
+        return;
     }
+    AcquisitionStarted("Playback of " + playbackInfo.m_settings.m_fileName + " Started");
+}
 
-    if (success)
+void MainWindow::AcquisitionStarted(std::string const& message)
+{
     {
-        Log("Acquisition Started");
-        // update button text
-        m_ui->m_acquisitionStartStopButton->setText(Text::StopAcquisition());
+        std::lock_guard<std::mutex> lock(m_imageSynchronizer);
+        m_imagesReplaced = 0;
+    }
+    ResetStatistics();
+    if (m_historyBuffer)
+    {
+        // don't mix the frames of different acquisitions
+        m_historyBuffer->Clear();
     }
+
+    Log(message);
+    // update button text
+    m_ui->m_acquisitionStartStopButton->setText(Text::StopAcquisition());
+    m_ui->m_recordButton->setEnabled(true);
+    m_ui->m_snapshotButton->setEnabled(m_snapshotExporter != nullptr);
+    StartVideo();
 }
 
 void MainWindow::StopAcquisition()
 {
+    StopRecording();
+    StopVideo();
+    m_ui->m_recordButton->setEnabled(false);
+    m_ui->m_snapshotButton->setEnabled(false);
     m_acquisitionManager.StopAcquisition();
 
-    Log("Acquisition Stopped");
+    if (m_daemonClient)
+    {
+        // the acquisition of the daemon keeps running for the other clients
+        m_daemonClient.reset();
+        Log("Detached from the acquisition daemon");
+    }
+    else
+    {
+        Log("Acquisition Stopped");
+    }
+    auto const timeLapse = m_acquisitionManager.GetTimeLapseStatistics();
+    if (timeLapse.m_triggers != 0)
+    {
+        Log(QString("Time-lapse: %1 triggers, %2 failed, %3 ms cpu in %4 s idle (%5%)")
+            .arg(timeLapse.m_triggers)
+            .arg(timeLapse.m_triggerFailures)
+            .arg(timeLapse.m_idleCpuTime.count() / 1000.0, 0, 'f', 1)
+            .arg(std::chrono::duration<double>(timeLapse.m_idleTime).count(), 0, 'f', 1)
+            .arg(timeLapse.m_idleCpuPercent, 0, 'f', 3).toStdString());
+    }
 
     auto& button = *(m_ui->m_acquisitionStartStopButton);
 
@@ -250,10 +1497,39 @@ void MainWindow::CameraSelected(QItemSelection const& newSelection)
 MainWindow::~MainWindow()
 {
     QObject::disconnect(m_ui->m_renderLabel, &ImageLabel::sizeChanged, this, &MainWindow::ImageLabelSizeChanged);
+    CloseReview();
+    StopRecording();
+    StopVideo();
     m_acquisitionManager.StopAcquisition();
+    m_daemonClient.reset();
+    if (m_historyBuffer)
+    {
+        m_acquisitionManager.RemoveRawFrameSink(*m_historyBuffer);
+        m_historyBuffer.reset();
+    }
+    if (m_snapshotExporter)
+    {
+        m_acquisitionManager.RemoveRawFrameSink(*m_snapshotExporter);
+        m_snapshotExporter.reset();
+    }
+    if (m_previewServer)
+    {
+        m_acquisitionManager.RemoveConvertedFrameSink(*m_previewServer);
+        m_previewServer.reset();
+    }
+    if (m_frameStreamServer)
+    {
+        m_acquisitionManager.RemoveRawFrameSink(*m_frameStreamServer);
+        m_frameStreamServer.reset();
+    }
+    if (m_workQueueServer)
+    {
+        m_acquisitionManager.RemoveRawFrameSink(*m_workQueueServer);
+        m_workQueueServer.reset();
+    }
 }
 
-void MainWindow::RenderImage(QPixmap image)
+void MainWindow::RenderImage(QPixmap image, VmbUint64_t frameId, VmbC::Examples::FrameMetadata const& metadata)
 {
     bool notify = false;
 
@@ -261,12 +1537,19 @@ void MainWindow::RenderImage(QPixmap image)
         std::lock_guard<std::mutex> lock(m_imageSynchronizer);
 
         m_queuedImage = std::move(image);
+        m_queuedFrameId = frameId;
+        m_queuedMetadata = metadata;
+        m_queuedTime = std::chrono::steady_clock::now();
         
         if (!m_renderingRequired)
         {
             notify = true;
             m_renderingRequired = true;
         }
+        else
+        {
+            ++m_imagesReplaced;
+        }
     }
 
     if (notify)
@@ -22,6 +22,7 @@
 #ifndef ASYNCHRONOUSGRAB_C_MAIN_WINDOW_H
 #define ASYNCHRONOUSGRAB_C_MAIN_WINDOW_H
 
+#include <chrono>
 #include <memory>
 #include <mutex>
 
@@ -32,7 +33,15 @@
 
 #include "ApiController.h"
 #include "AcquisitionManager.h"
+#include "HistoryBuffer.h"
+#include "SnapshotExporter.h"
+#include "FrameStreamServer.h"
+#include "MjpegPreviewServer.h"
+#include "VideoEncoderSink.h"
+#include "WorkQueueServer.h"
 #include "support/NotNull.h"
+#include "UI/PixmapFrameSink.h"
+#include "UI/ReviewFrameRenderer.h"
 
 using VmbC::Examples::ApiController;
 
@@ -40,6 +49,7 @@ QT_BEGIN_NAMESPACE
 
 class QListView;
 class QItemSelection;
+class QTimer;
 class QTreeView;
 
 namespace Ui
@@ -54,8 +64,13 @@ namespace VmbC
     namespace Examples
     {
         class ApiController;
+        class DaemonClient;
         class Image;
         class LogEntryListModel;
+        class MetricsServer;
+        struct PlaybackInfo;
+        class RecordingBrowser;
+        class RecordingSink;
         class VmbException;
     }
 }
@@ -74,8 +89,112 @@ public:
 
     /**
      * \brief Asynchonously schedule rendering of image 
+     * \param[in] frameId the id of the frame the image was created from
+     * \param[in] metadata the metadata of the frame; shown in the
+     *                     statistics overlay
      */
-    void RenderImage(QPixmap image);
+    void RenderImage(QPixmap image, VmbUint64_t frameId, VmbC::Examples::FrameMetadata const& metadata);
+
+    /**
+     * \brief serve the metrics of the acquisition on a port of the loopback
+     *        interface; failures are logged
+     */
+    void StartMetricsServer(VmbUint16_t port);
+
+    /**
+     * \brief stream a JPEG preview of the converted frames over HTTP on a
+     *        port of the loopback interface; failures are logged
+     */
+    void StartPreviewServer(VmbC::Examples::MjpegPreviewServer::Settings const& settings);
+
+    /**
+     * \brief send the raw frames to the subscribers connecting to a TCP
+     *        port; failures are logged
+     */
+    void StartFrameStreamServer(VmbC::Examples::FrameStreamServer::Settings const& settings);
+
+    /**
+     * \brief distribute the raw frames to the workers connecting to a TCP
+     *        port; failures are logged
+     */
+    void StartWorkQueueServer(VmbC::Examples::WorkQueueServer::Settings const& settings);
+
+    /**
+     * \brief set the memory used for caching the frames of a reviewed
+     *        recording
+     */
+    void SetReviewMemoryBudget(size_t bytes);
+
+    /**
+     * \brief set the number of threads compressing the frames of new
+     *        recordings; 0 to record uncompressed
+     */
+    void SetRecordingCompression(unsigned threads);
+
+    /**
+     * \brief keep the most recent raw frames in memory to be able to save
+     *        them with the "Save History" button; failures are logged
+     * \param[in] postTriggerDuration the time after clicking the button the
+     *                                frames received are added to the file
+     */
+    void EnableHistory(VmbC::Examples::HistoryBuffer::Settings const& settings, std::chrono::steady_clock::duration postTriggerDuration);
+
+    /**
+     * \brief enable the "Save Snapshot" button saving raw frames as image
+     *        files in the background
+     * \param[in] framesPerClick the number of frames saved per click; taken
+     *                           from the recent frames kept, if
+     *                           settings.m_recentFrames is not 0
+     */
+    void EnableSnapshots(VmbC::Examples::SnapshotExporter::Settings settings, size_t framesPerClick);
+
+    /**
+     * \brief encode the converted frames of every acquisition to a video
+     *        file in the working directory; the file name of the settings
+     *        is ignored
+     */
+    void EnableVideoArchive(VmbC::Examples::VideoEncoderSink::Settings const& settings);
+
+    /**
+     * \brief acquire a single frame per interval via software triggering
+     *        instead of letting the camera run freely
+     */
+    void SetTimeLapseInterval(std::chrono::steady_clock::duration interval);
+
+    /**
+     * \brief allocate the frame buffers of the acquisitions in shared memory
+     *        for other processes to read the raw frames without copying
+     */
+    void EnableSharedFrameExport(VmbC::Examples::SharedFrameExport::Settings const& settings);
+
+    /**
+     * \brief activate the chunk mode of the cameras and show the metadata of
+     *        the displayed frame; recordings and exported frames carry it, too
+     * \param[in] fields the MetadataField values to read
+     */
+    void EnableChunkMetadata(VmbUint32_t fields);
+
+    /**
+     * \brief lower the quality of the preview in steps, if the conversion
+     *        cannot keep up, and raise it again once there is room; not
+     *        used, if the video archive was enabled before, since the
+     *        encoder receives the same images
+     */
+    void EnableAdaptivePreview(VmbC::Examples::ImageTranscoder::AdaptiveQualitySettings settings);
+
+    /**
+     * \brief let the acquisition daemon listening on a port of the loopback
+     *        interface acquire from the cameras instead of opening them in
+     *        this process; stopping the acquisition or closing the window
+     *        only detaches from the daemon
+     */
+    void AttachToDaemon(VmbUint16_t port);
+
+    /**
+     * \brief Asynchronously schedule displaying the frame at the review
+     *        cursor; called from the background thread of the recording browser
+     */
+    void ReviewFrameReady();
 private:
     using Gui = Ui::AsynchronousGrabGui;
 
@@ -96,17 +215,187 @@ private:
      */
     QPixmap m_queuedImage;
 
+    /**
+     * \brief the id of the frame m_queuedImage was created from 
+     */
+    VmbUint64_t m_queuedFrameId { 0 };
+
+    /**
+     * \brief the metadata of the frame m_queuedImage was created from
+     */
+    VmbC::Examples::FrameMetadata m_queuedMetadata {};
+
+    /**
+     * \brief the time m_queuedImage was passed to RenderImage; used for
+     *        tracing the time spent waiting for the gui thread 
+     */
+    std::chrono::steady_clock::time_point m_queuedTime;
+
+    /**
+     * \brief number of images replaced by RenderImage before the gui thread
+     *        displayed them; guarded by m_imageSynchronizer
+     */
+    VmbUint64_t m_imagesReplaced { 0 };
+
     /**
      * \brief mutex for synchonizing access to m_queuedImage
      */
     std::mutex m_imageSynchronizer;
 
+    /**
+     * \brief timer triggering the update of the statistics overlay; only
+     *        running while the overlay is visible
+     */
+    QTimer* m_statisticsTimer;
+
+    /**
+     * \brief the statistics of the acquisition at the last update of the
+     *        overlay
+     */
+    VmbC::Examples::AcquisitionManager::Statistics m_lastStatistics {};
+
+    /**
+     * \brief the time of the last update of the statistics overlay 
+     */
+    std::chrono::steady_clock::time_point m_lastStatisticsTime;
+
+    /**
+     * \name Display statistics
+     * \brief counters updated by the gui thread when rendering images
+     */
+    ///@{
+    VmbUint64_t m_imagesDisplayed { 0 };
+    VmbUint64_t m_lastImagesDisplayed { 0 };
+    std::chrono::steady_clock::duration m_latencySum {};
+    std::chrono::steady_clock::duration m_latencyMax {};
+    unsigned m_latencySamples { 0 };
+
+    /**
+     * \brief the metadata of the image displayed last
+     */
+    VmbC::Examples::FrameMetadata m_displayedMetadata {};
+    ///@}
+
+    /**
+     * \brief Object creating the QPixmaps passed to RenderImage from the
+     *        converted frames
+     */
+    PixmapFrameSink m_frameSink;
+
     /**
      * \brief Object for managing the acquisition; this includes the transfer
      *        of converted images to this object
      */
     VmbC::Examples::AcquisitionManager m_acquisitionManager;
 
+    /**
+     * \brief the port of the acquisition daemon; 0, if the cameras are
+     *        opened by this process
+     */
+    VmbUint16_t m_daemonPort { 0 };
+
+    /**
+     * \brief the connection to the daemon while attached to its acquisition
+     */
+    std::unique_ptr<VmbC::Examples::DaemonClient> m_daemonClient;
+
+    /**
+     * \brief the server providing the metrics of m_acquisitionManager; null,
+     *        if not enabled
+     */
+    std::unique_ptr<VmbC::Examples::MetricsServer> m_metricsServer;
+
+    /**
+     * \brief the server streaming the preview; registered as converted
+     *        frame sink for the lifetime of the window; null, if not enabled
+     */
+    std::unique_ptr<VmbC::Examples::MjpegPreviewServer> m_previewServer;
+
+    /**
+     * \brief the server sending the raw frames to subscribers; registered as
+     *        raw frame sink for the lifetime of the window; null, if not enabled
+     */
+    std::unique_ptr<VmbC::Examples::FrameStreamServer> m_frameStreamServer;
+
+    /**
+     * \brief the server distributing the raw frames to workers; the results
+     *        are handled by the workers themselves; registered as raw frame
+     *        sink for the lifetime of the window; null, if not enabled
+     */
+    std::unique_ptr<VmbC::Examples::WorkQueueServer> m_workQueueServer;
+
+    /**
+     * \brief the sink writing the raw frames to a file; null, if not recording
+     */
+    std::unique_ptr<VmbC::Examples::RecordingSink> m_recordingSink;
+
+    unsigned m_recordingCompressionThreads { 0 };
+
+    /**
+     * \brief the recent frames kept in memory; null, if not enabled
+     */
+    std::unique_ptr<VmbC::Examples::HistoryBuffer> m_historyBuffer;
+
+    std::chrono::steady_clock::duration m_historyPostTriggerDuration {};
+
+    /**
+     * \brief the sink saving snapshots; null, if not enabled
+     */
+    std::unique_ptr<VmbC::Examples::SnapshotExporter> m_snapshotExporter;
+
+    size_t m_snapshotFrames { 1 };
+
+    /**
+     * \brief save the most recent frames instead of the next ones
+     */
+    bool m_snapshotRecent { false };
+
+    /**
+     * \brief the settings of the videos; the codec is used, if
+     *        m_videoArchiveEnabled is set
+     */
+    VmbC::Examples::VideoEncoderSink::Settings m_videoSettings;
+
+    bool m_videoArchiveEnabled { false };
+
+    /**
+     * \brief the sink encoding the video of the current acquisition; null,
+     *        if not enabled or the encoder could not be created
+     */
+    std::unique_ptr<VmbC::Examples::VideoEncoderSink> m_videoEncoderSink;
+
+    /**
+     * \brief Object creating the images of the reviewed recording
+     */
+    ReviewFrameRenderer m_reviewRenderer;
+
+    /**
+     * \brief random access to the reviewed recording; null, if no recording
+     *        is reviewed
+     */
+    std::unique_ptr<VmbC::Examples::RecordingBrowser> m_recordingBrowser;
+
+    size_t m_reviewMemoryBudget;
+
+    /**
+     * \brief the index of the reviewed frame
+     */
+    size_t m_reviewPosition { 0 };
+
+    /**
+     * \brief timer advancing the review position while playing
+     */
+    QTimer* m_reviewTimer;
+
+    /**
+     * \brief the time and the recorded timestamp the playback of the
+     *        reviewed recording is timed from
+     */
+    ///@{
+    std::chrono::steady_clock::time_point m_reviewClockStart;
+    VmbUint64_t m_reviewTimestampStart { 0 };
+    ///@}
+
     /**
      * \brief the model used for the QTableView to display log messages.
      */
@@ -141,16 +430,100 @@ private:
      */
     void SetupLogView();
 
+    /**
+     * \brief get the camera selected in the camera tree
+     * \return null, if no camera is selected
+     */
+    VmbCameraInfo_t const* GetSelectedCamera() const;
+
+    /**
+     * \brief get the recording selected in the camera tree
+     * \return null, if no recording is selected
+     */
+    VmbC::Examples::PlaybackInfo const* GetSelectedPlayback() const;
+
     /**
      * \brief start the acquisition for a given camera
      */
     void StartAcquisition(VmbCameraInfo_t const& cameraInfo);
 
+    /**
+     * \brief let the daemon start the acquisition of a camera and process
+     *        the frames it exports
+     */
+    void AttachToAcquisition(VmbCameraInfo_t const& cameraInfo);
+
+    /**
+     * \brief start replaying a recording instead of acquiring from a camera
+     */
+    void StartPlayback(VmbC::Examples::PlaybackInfo const& playbackInfo);
+
+    /**
+     * \brief reset the statistics and update the buttons after the
+     *        acquisition or playback was started successfully
+     */
+    void AcquisitionStarted(std::string const& message);
+
     /**
      * \brief stop the acquistion 
      */
     void StopAcquisition();
 
+    /**
+     * \brief get the settings for recording to a file including the
+     *        information about the selected camera
+     */
+    VmbC::Examples::RecordingSink::Settings GetRecordingSettings(QString const& fileName) const;
+
+    /**
+     * \brief write the remaining frames of the recording, close the file and
+     *        log the statistics of the recording
+     */
+    void StopRecording();
+
+    /**
+     * \brief create a video encoder sink for the acquisition started, if
+     *        enabled; failures are logged
+     */
+    void StartVideo();
+
+    /**
+     * \brief complete the video file and log the statistics of the encoder
+     */
+    void StopVideo();
+
+    /**
+     * \brief stop reviewing a recording and hide the review controls
+     */
+    void CloseReview();
+
+    /**
+     * \brief move the review cursor and display the frame, if it is cached
+     * \param[in] direction the direction of the movement used for prefetching
+     */
+    void SeekReview(size_t index, int direction);
+
+    /**
+     * \brief time the playback of the reviewed recording from the current
+     *        position
+     */
+    void RestartReviewClock();
+
+    /**
+     * \brief Write the pipeline trace to a file in the working directory
+     */
+    void WriteTrace();
+
+    /**
+     * \brief show or hide the statistics overlay on the render view
+     */
+    void ToggleStatistics();
+
+    /**
+     * \brief reset the values the statistics overlay is calculated from
+     */
+    void ResetStatistics();
+
 private slots:
 
     /**
@@ -163,6 +536,53 @@ private slots:
      */
     void StartStopClicked();
 
+    /**
+     * \brief Slot for clicks of the start / stop recording button
+     */
+    void RecordClicked();
+
+    /**
+     * \brief Slot for clicks of the button writing the frames kept in memory
+     *        to a file
+     */
+    void SaveHistoryClicked();
+
+    /**
+     * \brief Slot for clicks of the button saving frames as image files
+     */
+    void SnapshotClicked();
+
+    /**
+     * \brief Slot for clicks of the button adding a recording to the camera tree
+     */
+    void OpenRecordingClicked();
+
+    /**
+     * \brief Slot for clicks of the button opening / closing a recording for review
+     */
+    void ReviewClicked();
+
+    /**
+     * \brief Slots of the review controls
+     */
+    ///@{
+    void ReviewSliderChanged(int value);
+    void ReviewStepBackwardClicked();
+    void ReviewStepForwardClicked();
+    void ReviewPlayClicked();
+    void ReviewSpeedChanged();
+    ///@}
+
+    /**
+     * \brief Slot for the periodic update of the review position while playing
+     */
+    void AdvanceReview();
+
+    /**
+     * \brief Slot displaying the frame at the review cursor, if it is cached
+     */
+    void DisplayReviewFrame();
+
     /**
      * \brief Slot for the size changes of the label used for rendering the images
      */
@@ -174,12 +594,40 @@ private slots:
      * Thread affinity with this object required
      */
     void RenderImage();
+
+    /**
+     * \brief Slot for the periodic update of the statistics overlay
+     */
+    void UpdateStatistics();
 signals:
     /**
      * \brief signal emitted from a background thread to notify the gui about
      *        a new image being available for rendering
      */
     void ImageReady();
+
+    /**
+     * \brief signal emitted from a background thread to notify the gui about
+     *        the frame at the review cursor being available
+     */
+    void ReviewFrameAvailable();
+
+    /**
+     * \brief signal emitted from a background thread after the history was
+     *        written to a file
+     */
+    void HistoryDumpFinished(QString message);
+
+    /**
+     * \brief signal emitted from an encoder thread after a snapshot was saved
+     */
+    void SnapshotSaved(QString message);
+
+    /**
+     * \brief signal emitted from the thread receiving the frames of the
+     *        daemon after the daemon stopped the acquisition
+     */
+    void RemoteAcquisitionClosed();
 };
 
 #endif // ASYNCHRONOUSGRAB_C_MAIN_WINDOW_H
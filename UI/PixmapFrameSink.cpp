@@ -0,0 +1,94 @@
+/*=============================================================================
+  Copyright (C) 2012 - 2023 Allied Vision Technologies.  All Rights Reserved.
+
+  Redistribution of this file, in original or modified form, without
+  prior written consent of Allied Vision Technologies is prohibited.
+
+-------------------------------------------------------------------------------
+
+  File:        PixmapFrameSink.cpp
+
+  Description: Implementation of PixmapFrameSink.
+
+
+-------------------------------------------------------------------------------
+
+  THIS SOFTWARE IS PROVIDED BY THE AUTHOR "AS IS" AND ANY EXPRESS OR IMPLIED
+  WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF TITLE,
+  NON-INFRINGEMENT, MERCHANTABILITY AND FITNESS FOR A PARTICULAR  PURPOSE ARE
+  DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+  INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+  AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+  TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+=============================================================================*/
+
+#include <QImage>
+#include <QPixmap>
+
+#include "Image.h"
+#include "Tracing.h"
+#include "UI/MainWindow.h"
+#include "UI/PixmapFrameSink.h"
+
+namespace
+{
+    /**
+     * \brief get the QImage format with the same memory layout as the
+     *        given pixel format produced by ImageTranscoder 
+     */
+    QImage::Format GetQtImageFormat(VmbPixelFormat_t pixelFormat)
+    {
+        return (pixelFormat == VmbPixelFormatBgra8) ? QImage::Format_RGB32 : QImage::Format_RGBX8888;
+    }
+}
+
+PixmapFrameSink::PixmapFrameSink(MainWindow& renderWindow)
+    : m_renderWindow(renderWindow)
+{
+}
+
+void PixmapFrameSink::SetOutputSize(QSize size)
+/* 用于设置输出图像的大小。
+它使用互斥锁保护共享的输出大小变量，将新的大小值存储在 m_outputSize 成员变量中。 
+*/
+{
+    std::lock_guard<std::mutex> lock(m_sizeMutex);
+    m_outputSize = size;
+}
+
+void PixmapFrameSink::ConvertedFrameReceived(VmbC::Examples::Image const& image, VmbFrame_t const& frame)
+/* 在转换线程中调用：将转换后的图像包装为 QImage（不复制数据），生成 QPixmap 并按输出大小缩放后交给窗口渲染。 */
+{
+    /* 使用目标图像的数据、宽度、高度、每行字节数和Qt图像格式，创建一个 QImage 对象 qImage。 */
+    QImage qImage(image.GetData(),
+                  image.GetWidth(),
+                  image.GetHeight(),
+                  image.GetBytesPerLine(),
+                  GetQtImageFormat(image.GetPixelFormat()));
+
+    /* 使用 QPixmap::fromImage() 将 qImage 转换为 QPixmap 对象 pixmap，使用 Qt::ImageConversionFlag::ColorOnly 进行颜色转换。 */
+    QPixmap pixmap;
+    {
+        ASYNCHRONOUSGRAB_TRACE_SCOPE("QPixmap::fromImage", frame.frameID);
+        pixmap = QPixmap::fromImage(qImage, Qt::ImageConversionFlag::ColorOnly);
+    }
+
+    QSize size;
+    {
+        std::lock_guard<std::mutex> lock(m_sizeMutex);
+        size = m_outputSize;
+    }
+
+    QPixmap scaled;
+    {
+        ASYNCHRONOUSGRAB_TRACE_SCOPE("QPixmap::scaled", frame.frameID);
+        scaled = pixmap.scaled(size, Qt::AspectRatioMode::KeepAspectRatio);
+    }
+    /* 将经过缩放后的 pixmap 作为参数传递给该函数，使用 Qt::AspectRatioMode::KeepAspectRatio 保持宽高比。 */
+    auto const metadata = VmbC::Examples::GetFrameMetadata(frame);
+    m_renderWindow.RenderImage(std::move(scaled), frame.frameID, (metadata == nullptr) ? VmbC::Examples::FrameMetadata {} : *metadata);
+}
@@ -0,0 +1,62 @@
+/**
+ * \date 2023
+ * \copyright Allied Vision Technologies.  All Rights Reserved.
+ *
+ * \copyright Redistribution of this file, in original or modified form, without
+ *            prior written consent of Allied Vision Technologies is prohibited.
+ *
+ * \warning THIS SOFTWARE IS PROVIDED BY THE AUTHOR "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF TITLE,
+ * NON-INFRINGEMENT, MERCHANTABILITY AND FITNESS FOR A PARTICULAR  PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \brief Definition of the sink turning converted frames into QPixmaps
+ */
+
+#ifndef ASYNCHRONOUSGRAB_C_PIXMAP_FRAME_SINK_H
+#define ASYNCHRONOUSGRAB_C_PIXMAP_FRAME_SINK_H
+
+#include <mutex>
+
+#include <QSize>
+
+#include "FrameSink.h"
+
+class MainWindow;
+
+/**
+ * \brief Creates QPixmaps of the desired size from the converted frames and
+ *        passes them to the window
+ */
+class PixmapFrameSink : public VmbC::Examples::ConvertedFrameSink
+{
+public:
+    PixmapFrameSink(MainWindow& renderWindow);
+
+    /**
+     * \brief update the size of the QPixmaps to produce
+     */
+    void SetOutputSize(QSize size);
+
+    void ConvertedFrameReceived(VmbC::Examples::Image const& image, VmbFrame_t const& frame) override;
+private:
+    MainWindow& m_renderWindow;
+
+    /**
+     * \brief size of QPixmaps to produce 
+     */
+    QSize m_outputSize;
+
+    /**
+     * \brief mutex for guarding access to m_outputSize 
+     */
+    std::mutex m_sizeMutex;
+};
+
+#endif
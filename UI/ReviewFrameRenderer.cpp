@@ -0,0 +1,87 @@
+/*=============================================================================
+  Copyright (C) 2012 - 2023 Allied Vision Technologies.  All Rights Reserved.
+
+  Redistribution of this file, in original or modified form, without
+  prior written consent of Allied Vision Technologies is prohibited.
+
+-------------------------------------------------------------------------------
+
+  File:        ReviewFrameRenderer.cpp
+
+  Description: Implementation of ReviewFrameRenderer.
+
+
+-------------------------------------------------------------------------------
+
+  THIS SOFTWARE IS PROVIDED BY THE AUTHOR "AS IS" AND ANY EXPRESS OR IMPLIED
+  WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF TITLE,
+  NON-INFRINGEMENT, MERCHANTABILITY AND FITNESS FOR A PARTICULAR  PURPOSE ARE
+  DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+  INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+  AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+  TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+=============================================================================*/
+
+#include "Image.h"
+#include "UI/MainWindow.h"
+#include "UI/ReviewFrameRenderer.h"
+
+size_t ReviewFrameRenderer::Frame::GetSize() const noexcept
+{
+    return static_cast<size_t>(m_image.bytesPerLine()) * static_cast<size_t>(m_image.height());
+}
+
+ReviewFrameRenderer::ReviewFrameRenderer(MainWindow& renderWindow)
+    : m_renderWindow(renderWindow)
+{
+}
+
+void ReviewFrameRenderer::SetOutputSize(QSize size)
+{
+    std::lock_guard<std::mutex> lock(m_sizeMutex);
+    m_outputSize = size;
+}
+
+std::shared_ptr<VmbC::Examples::RecordingBrowser::RenderedFrame const> ReviewFrameRenderer::Render(VmbC::Examples::Image const& image, VmbFrame_t const& frame)
+/* 在 RecordingBrowser 的后台线程中调用：把转换后的图像包装为 QImage（不复制数据），平滑缩放到显示大小后放入缓存。
+缓存的是缩放后的 QImage 而不是 QPixmap，因为 QPixmap 只能在GUI线程中安全使用；显示时再在GUI线程中生成 QPixmap。
+缩放结果与源图像大小相同时 QImage 仍引用转换缓冲区，因此需要显式复制。 */
+{
+    QImage const qImage(image.GetData(),
+                        image.GetWidth(),
+                        image.GetHeight(),
+                        image.GetBytesPerLine(),
+                        (image.GetPixelFormat() == VmbPixelFormatBgra8) ? QImage::Format_RGB32 : QImage::Format_RGBX8888);
+
+    QSize size;
+    {
+        std::lock_guard<std::mutex> lock(m_sizeMutex);
+        size = m_outputSize;
+    }
+
+    auto result = std::make_shared<Frame>();
+    result->m_frameId = frame.frameID;
+    result->m_timestamp = frame.timestamp;
+    if (size.isEmpty() || size == qImage.size())
+    {
+        result->m_image = qImage.copy();
+    }
+    else
+    {
+        result->m_image = qImage.scaled(size, Qt::AspectRatioMode::KeepAspectRatio, Qt::TransformationMode::SmoothTransformation);
+        if (result->m_image.constBits() == qImage.constBits())
+        {
+            result->m_image = qImage.copy();
+        }
+    }
+    return result;
+}
+
+void ReviewFrameRenderer::CursorFrameReady(size_t)
+{
+    m_renderWindow.ReviewFrameReady();
+}
@@ -0,0 +1,79 @@
+/**
+ * \date 2023
+ * \copyright Allied Vision Technologies.  All Rights Reserved.
+ *
+ * \copyright Redistribution of this file, in original or modified form, without
+ *            prior written consent of Allied Vision Technologies is prohibited.
+ *
+ * \warning THIS SOFTWARE IS PROVIDED BY THE AUTHOR "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF TITLE,
+ * NON-INFRINGEMENT, MERCHANTABILITY AND FITNESS FOR A PARTICULAR  PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \brief Definition of the renderer creating display sized images of recorded frames
+ */
+
+#ifndef ASYNCHRONOUSGRAB_C_REVIEW_FRAME_RENDERER_H
+#define ASYNCHRONOUSGRAB_C_REVIEW_FRAME_RENDERER_H
+
+#include <mutex>
+
+#include <QImage>
+#include <QSize>
+
+#include "RecordingBrowser.h"
+
+class MainWindow;
+
+/**
+ * \brief Creates QImages of the display size from the frames of a recording
+ *        for the cache of RecordingBrowser and notifies the window about the
+ *        frame at the cursor
+ */
+class ReviewFrameRenderer : public VmbC::Examples::RecordingBrowser::Renderer
+{
+public:
+    /**
+     * \brief the cached representation of a recorded frame
+     */
+    struct Frame : VmbC::Examples::RecordingBrowser::RenderedFrame
+    {
+        QImage m_image;
+        VmbUint64_t m_frameId { 0 };
+        VmbUint64_t m_timestamp { 0 };
+
+        size_t GetSize() const noexcept override;
+    };
+
+    ReviewFrameRenderer(MainWindow& renderWindow);
+
+    /**
+     * \brief update the size of the QImages to produce; the frames cached
+     *        need to be invalidated afterwards
+     */
+    void SetOutputSize(QSize size);
+
+    std::shared_ptr<VmbC::Examples::RecordingBrowser::RenderedFrame const> Render(VmbC::Examples::Image const& image, VmbFrame_t const& frame) override;
+
+    void CursorFrameReady(size_t index) override;
+private:
+    MainWindow& m_renderWindow;
+
+    /**
+     * \brief size of QImages to produce
+     */
+    QSize m_outputSize;
+
+    /**
+     * \brief mutex for guarding access to m_outputSize
+     */
+    std::mutex m_sizeMutex;
+};
+
+#endif
@@ -0,0 +1,436 @@
+/**
+ * \date 2023
+ * \copyright Allied Vision Technologies.  All Rights Reserved.
+ *
+ * \copyright Redistribution of this file, in original or modified form, without
+ *            prior written consent of Allied Vision Technologies is prohibited.
+ *
+ * \warning THIS SOFTWARE IS PROVIDED BY THE AUTHOR "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF TITLE,
+ * NON-INFRINGEMENT, MERCHANTABILITY AND FITNESS FOR A PARTICULAR  PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \brief Implementation of ::VmbC::Examples::VideoEncoderSink
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "Image.h"
+#include "LibavSupport.h"
+#include "Tracing.h"
+#include "VideoEncoderSink.h"
+#include "VmbException.h"
+
+#ifdef ASYNCHRONOUSGRAB_HAVE_LIBAV
+extern "C"
+{
+#include <libavcodec/avcodec.h>
+#include <libavformat/avformat.h>
+#include <libavutil/imgutils.h>
+#include <libavutil/opt.h>
+#include <libswscale/swscale.h>
+}
+#endif
+
+namespace VmbC
+{
+    namespace Examples
+    {
+#ifdef ASYNCHRONOUSGRAB_HAVE_LIBAV
+        using LibavSupport::Check;
+        using LibavSupport::GetAvPixelFormat;
+        using LibavSupport::GetScaledSize;
+#endif
+        using LibavSupport::CopyImage;
+        using LibavSupport::GetBytesPerPixel;
+
+#ifdef ASYNCHRONOUSGRAB_HAVE_LIBAV
+        struct VideoEncoderSink::Output
+        {
+            AVFormatContext* m_format { nullptr };
+            AVCodecContext* m_codec { nullptr };
+            AVStream* m_stream { nullptr };
+            SwsContext* m_scaler { nullptr };
+            AVFrame* m_frame { nullptr };
+            AVPacket* m_packet { nullptr };
+
+            /**
+             * \brief the size of the images the scaler was created for
+             */
+            int m_sourceWidth { 0 };
+            int m_sourceHeight { 0 };
+
+            ~Output()
+            {
+                sws_freeContext(m_scaler);
+                av_frame_free(&m_frame);
+                av_packet_free(&m_packet);
+                avcodec_free_context(&m_codec);
+                if (m_format != nullptr)
+                {
+                    if ((m_format->oformat->flags & AVFMT_NOFILE) == 0)
+                    {
+                        avio_closep(&m_format->pb);
+                    }
+                    avformat_free_context(m_format);
+                }
+            }
+        };
+#else
+        struct VideoEncoderSink::Output
+        {
+        };
+#endif
+
+        bool VideoEncoderSink::IsAvailable() noexcept
+        {
+#ifdef ASYNCHRONOUSGRAB_HAVE_LIBAV
+            return true;
+#else
+            return false;
+#endif
+        }
+
+        char const* VideoEncoderSink::GetExtension(Codec const codec) noexcept
+        {
+            // FFV1 is not supported by the mp4 muxer of all libavformat versions
+            return (codec == Codec::Ffv1) ? ".mkv" : ".mp4";
+        }
+
+        VideoEncoderSink::VideoEncoderSink(Settings const& settings)
+            : m_settings(settings),
+            m_slots((std::max)(settings.m_queueSize, size_t(1))),
+            m_output(new Output)
+        {
+            if (!IsAvailable())
+            {
+                throw VmbException("built without libavcodec; define ASYNCHRONOUSGRAB_HAVE_LIBAV to encode videos", VmbErrorNotSupported);
+            }
+            if (!(settings.m_frameRate > 0))
+            {
+                throw VmbException("the frame rate of the video needs to be positive", VmbErrorBadParameter);
+            }
+
+            for (size_t i = m_slots.size(); i != 0; --i)
+            {
+                m_freeSlots.push_back(i - 1);
+            }
+            m_encoderThread = std::thread(&VideoEncoderSink::Encode, this);
+        }
+
+        VideoEncoderSink::~VideoEncoderSink()
+        {
+            Stop();
+        }
+
+        void VideoEncoderSink::ConvertedFrameReceived(Image const& image, VmbFrame_t const& frame)
+        /* 在转码线程中调用：先按输出帧率跳过多余的帧（不复制），然后把图像复制到空闲槽中；没有空闲槽（编码器跟不上）时丢弃该帧并计数，
+        从不等待编码线程，因此帧总能立即重新入队。显示时间戳按距第一帧的时间以帧周期为单位计算。 */
+        {
+            if (m_failed.load(std::memory_order_relaxed))
+            {
+                ++m_framesDropped;
+                return;
+            }
+
+            auto const now = Clock::now();
+            if (!m_started)
+            {
+                m_started = true;
+                m_startTime = now;
+            }
+            auto const pts = static_cast<VmbInt64_t>(std::chrono::duration<double>(now - m_startTime).count() * m_settings.m_frameRate);
+            if (pts <= m_lastPts)
+            {
+                ++m_framesSkipped;
+                return;
+            }
+
+            size_t const bytesPerPixel = GetBytesPerPixel(image.GetPixelFormat());
+            size_t index;
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                if (m_freeSlots.empty() || bytesPerPixel == 0 || m_stop)
+                {
+                    ++m_framesDropped;
+                    return;
+                }
+                index = m_freeSlots.back();
+                m_freeSlots.pop_back();
+            }
+
+            ASYNCHRONOUSGRAB_TRACE_SCOPE("CopyVideoFrame", frame.frameID);
+            Slot& slot = m_slots[index];
+            slot.m_width = image.GetWidth();
+            slot.m_height = image.GetHeight();
+            slot.m_pixelFormat = image.GetPixelFormat();
+            slot.m_frameId = frame.frameID;
+            slot.m_pts = pts;
+            CopyImage(image, bytesPerPixel, slot.m_data);
+            m_lastPts = pts;
+
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_queuedSlots.push_back(index);
+            }
+            m_condition.notify_one();
+        }
+
+        void VideoEncoderSink::Stop() noexcept
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_stop = true;
+            }
+            m_condition.notify_all();
+            if (m_encoderThread.joinable())
+            {
+                m_encoderThread.join();
+            }
+        }
+
+        VideoEncoderSink::Statistics VideoEncoderSink::GetStatistics() const
+        {
+            Statistics statistics;
+            statistics.m_framesEncoded = m_framesEncoded.load(std::memory_order_relaxed);
+            statistics.m_framesSkipped = m_framesSkipped.load(std::memory_order_relaxed);
+            statistics.m_framesDropped = m_framesDropped.load(std::memory_order_relaxed);
+            statistics.m_bytesWritten = m_bytesWritten.load(std::memory_order_relaxed);
+            if (statistics.m_framesEncoded != 0)
+            {
+                statistics.m_averageEncodeTime = Clock::duration(m_encodeTime.load(std::memory_order_relaxed) / static_cast<Clock::rep>(statistics.m_framesEncoded));
+            }
+            std::lock_guard<std::mutex> lock(m_mutex);
+            statistics.m_queueDepth = m_queuedSlots.size();
+            statistics.m_error = m_error;
+            return statistics;
+        }
+
+        void VideoEncoderSink::Encode()
+        /* 编码线程：按接收顺序编码队列中的图像，编码后把槽归还到空闲列表。停止时先编码剩余的图像，
+        然后清空编码器中缓存的帧（B帧、多线程编码的延迟）并写入文件尾。出错后不再编码，之后的帧被丢弃。 */
+        {
+            ASYNCHRONOUSGRAB_TRACE_THREAD_NAME("VideoEncoder");
+
+            auto const fail = [this](VmbException const& ex)
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_error = ex.what();
+                m_failed = true;
+            };
+
+            while (true)
+            {
+                size_t index;
+                {
+                    std::unique_lock<std::mutex> lock(m_mutex);
+                    m_condition.wait(lock, [this]() { return m_stop || !m_queuedSlots.empty(); });
+                    if (m_queuedSlots.empty())
+                    {
+                        break;
+                    }
+                    index = m_queuedSlots.front();
+                    m_queuedSlots.pop_front();
+                }
+
+                if (!m_failed.load(std::memory_order_relaxed))
+                {
+                    Slot const& slot = m_slots[index];
+                    ASYNCHRONOUSGRAB_TRACE_SCOPE("EncodeVideoFrame", slot.m_frameId);
+                    auto const start = Clock::now();
+                    try
+                    {
+                        EncodeSlot(&slot);
+                        ++m_framesEncoded;
+                        m_encodeTime += (Clock::now() - start).count();
+                    }
+                    catch (VmbException const& ex)
+                    {
+                        fail(ex);
+                    }
+                }
+
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_freeSlots.push_back(index);
+            }
+
+            if (!m_failed.load(std::memory_order_relaxed))
+            {
+                try
+                {
+                    EncodeSlot(nullptr);
+                }
+                catch (VmbException const& ex)
+                {
+                    fail(ex);
+                }
+            }
+            // close the file even after an error to keep the frames encoded
+            m_output.reset();
+        }
+
+#ifdef ASYNCHRONOUSGRAB_HAVE_LIBAV
+        void VideoEncoderSink::Open(Slot const& slot)
+        /* 输出大小按 m_maxWidth/m_maxHeight 等比例缩小并取偶数（YUV 4:2:0要求）。H.264/H.265优先使用libx264/libx265，
+        以CRF控制质量；FFV1使用版本3（支持多线程切片）无损保存RGB。时间基准为输出帧周期。 */
+        {
+            Output& output = *m_output;
+            AVPixelFormat const sourceFormat = GetAvPixelFormat(slot.m_pixelFormat);
+            if (sourceFormat == AV_PIX_FMT_NONE)
+            {
+                throw VmbException("unsupported pixel format of the converted images", VmbErrorNotSupported);
+            }
+
+            int width;
+            int height;
+            GetScaledSize(slot.m_width, slot.m_height, m_settings.m_maxWidth, m_settings.m_maxHeight, width, height);
+
+            AVCodec const* codec = nullptr;
+            switch (m_settings.m_codec)
+            {
+            case Codec::H264:
+                codec = avcodec_find_encoder_by_name("libx264");
+                codec = (codec != nullptr) ? codec : avcodec_find_encoder(AV_CODEC_ID_H264);
+                break;
+            case Codec::H265:
+                codec = avcodec_find_encoder_by_name("libx265");
+                codec = (codec != nullptr) ? codec : avcodec_find_encoder(AV_CODEC_ID_HEVC);
+                break;
+            case Codec::Ffv1:
+                codec = avcodec_find_encoder(AV_CODEC_ID_FFV1);
+                break;
+            }
+            if (codec == nullptr)
+            {
+                throw VmbException("the encoder is not available in the libavcodec used", VmbErrorNotSupported);
+            }
+
+            Check(avformat_alloc_output_context2(&output.m_format, nullptr, nullptr, m_settings.m_fileName.c_str()), "avformat_alloc_output_context2");
+            output.m_stream = avformat_new_stream(output.m_format, nullptr);
+            output.m_codec = avcodec_alloc_context3(codec);
+            output.m_frame = av_frame_alloc();
+            output.m_packet = av_packet_alloc();
+            if (output.m_stream == nullptr || output.m_codec == nullptr || output.m_frame == nullptr || output.m_packet == nullptr)
+            {
+                throw VmbException("unable to allocate the encoder", VmbErrorResources);
+            }
+
+            AVRational const frameRate = av_d2q(m_settings.m_frameRate, 100000);
+            AVCodecContext& context = *output.m_codec;
+            context.width = width;
+            context.height = height;
+            context.pix_fmt = (m_settings.m_codec == Codec::Ffv1) ? AV_PIX_FMT_BGR0 : AV_PIX_FMT_YUV420P;
+            context.time_base = av_inv_q(frameRate);
+            context.framerate = frameRate;
+            context.gop_size = (std::max)(static_cast<int>(m_settings.m_frameRate * 10), 1);
+            context.thread_count = static_cast<int>(m_settings.m_threads);
+            context.thread_type = FF_THREAD_FRAME | FF_THREAD_SLICE;
+            if ((output.m_format->oformat->flags & AVFMT_GLOBALHEADER) != 0)
+            {
+                context.flags |= AV_CODEC_FLAG_GLOBAL_HEADER;
+            }
+
+            AVDictionary* options = nullptr;
+            if (m_settings.m_codec == Codec::Ffv1)
+            {
+                av_dict_set(&options, "level", "3", 0);
+                av_dict_set(&options, "slicecrc", "1", 0);
+            }
+            else
+            {
+                av_dict_set_int(&options, "crf", m_settings.m_crf, 0);
+            }
+            int const openResult = avcodec_open2(output.m_codec, codec, &options);
+            av_dict_free(&options);
+            Check(openResult, "avcodec_open2");
+
+            Check(avcodec_parameters_from_context(output.m_stream->codecpar, output.m_codec), "avcodec_parameters_from_context");
+            output.m_stream->time_base = context.time_base;
+            if ((output.m_format->oformat->flags & AVFMT_NOFILE) == 0)
+            {
+                Check(avio_open(&output.m_format->pb, m_settings.m_fileName.c_str(), AVIO_FLAG_WRITE), "avio_open");
+            }
+            Check(avformat_write_header(output.m_format, nullptr), "avformat_write_header");
+
+            output.m_scaler = sws_getContext(slot.m_width, slot.m_height, sourceFormat, width, height, context.pix_fmt,
+                                             SWS_AREA, nullptr, nullptr, nullptr);
+            if (output.m_scaler == nullptr)
+            {
+                throw VmbException("unable to create the scaler", VmbErrorResources);
+            }
+            output.m_sourceWidth = slot.m_width;
+            output.m_sourceHeight = slot.m_height;
+
+            output.m_frame->format = context.pix_fmt;
+            output.m_frame->width = width;
+            output.m_frame->height = height;
+            Check(av_frame_get_buffer(output.m_frame, 0), "av_frame_get_buffer");
+        }
+
+        void VideoEncoderSink::EncodeSlot(Slot const* const slot)
+        {
+            Output& output = *m_output;
+            if (slot != nullptr)
+            {
+                if (output.m_codec == nullptr)
+                {
+                    Open(*slot);
+                }
+                if (slot->m_width != output.m_sourceWidth || slot->m_height != output.m_sourceHeight)
+                {
+                    throw VmbException("the image size changed while encoding", VmbErrorInvalidValue);
+                }
+
+                Check(av_frame_make_writable(output.m_frame), "av_frame_make_writable");
+                uint8_t const* const source[] = { slot->m_data.data() };
+                int const sourceStride[] = { static_cast<int>(slot->m_data.size() / static_cast<size_t>(slot->m_height)) };
+                sws_scale(output.m_scaler, source, sourceStride, 0, slot->m_height, output.m_frame->data, output.m_frame->linesize);
+                output.m_frame->pts = slot->m_pts;
+            }
+            else if (output.m_codec == nullptr)
+            {
+                // no frame was received
+                return;
+            }
+
+            Check(avcodec_send_frame(output.m_codec, (slot != nullptr) ? output.m_frame : nullptr), "avcodec_send_frame");
+            while (true)
+            {
+                int const result = avcodec_receive_packet(output.m_codec, output.m_packet);
+                if (result == AVERROR(EAGAIN) || result == AVERROR_EOF)
+                {
+                    break;
+                }
+                Check(result, "avcodec_receive_packet");
+                av_packet_rescale_ts(output.m_packet, output.m_codec->time_base, output.m_stream->time_base);
+                output.m_packet->stream_index = output.m_stream->index;
+                m_bytesWritten += static_cast<VmbUint64_t>(output.m_packet->size);
+                Check(av_interleaved_write_frame(output.m_format, output.m_packet), "av_interleaved_write_frame");
+            }
+
+            if (slot == nullptr)
+            {
+                Check(av_write_trailer(output.m_format), "av_write_trailer");
+            }
+        }
+#else
+        void VideoEncoderSink::Open(Slot const&)
+        {
+            throw VmbException("built without libavcodec", VmbErrorNotSupported);
+        }
+
+        void VideoEncoderSink::EncodeSlot(Slot const*)
+        {
+            throw VmbException("built without libavcodec", VmbErrorNotSupported);
+        }
+#endif
+    }
+}
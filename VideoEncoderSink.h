@@ -0,0 +1,252 @@
+/**
+ * \date 2023
+ * \copyright Allied Vision Technologies.  All Rights Reserved.
+ *
+ * \copyright Redistribution of this file, in original or modified form, without
+ *            prior written consent of Allied Vision Technologies is prohibited.
+ *
+ * \warning THIS SOFTWARE IS PROVIDED BY THE AUTHOR "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF TITLE,
+ * NON-INFRINGEMENT, MERCHANTABILITY AND FITNESS FOR A PARTICULAR  PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \brief Definition of a sink encoding the converted frames to a video file
+ */
+
+#ifndef ASYNCHRONOUSGRAB_C_VIDEO_ENCODER_SINK_H
+#define ASYNCHRONOUSGRAB_C_VIDEO_ENCODER_SINK_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <VmbC/VmbC.h>
+
+#include "FrameSink.h"
+
+namespace VmbC
+{
+    namespace Examples
+    {
+        /**
+         * \brief Encodes the converted frames to a video file using the
+         *        software encoders of libavcodec.
+         *
+         * ConvertedFrameReceived is called from the conversion thread and
+         * only copies the image into a free slot of a bounded queue; frames
+         * arriving while all slots are in use are dropped, so the frame is
+         * always requeued without waiting for the encoder. Frames arriving
+         * faster than the output frame rate are skipped before being copied.
+         * An encoder thread converts the images to YUV 4:2:0 (H.264, H.265)
+         * or RGB (FFV1) with libswscale, which also reduces the resolution,
+         * and passes them to the codec, which uses its own worker threads.
+         *
+         * Only available if built with libavcodec, libavformat and
+         * libswscale (ASYNCHRONOUSGRAB_HAVE_LIBAV).
+         */
+        class VideoEncoderSink : public ConvertedFrameSink
+        {
+        public:
+            using Clock = std::chrono::steady_clock;
+
+            enum class Codec
+            {
+                H264,
+                H265,
+                Ffv1
+            };
+
+            struct Settings
+            {
+                /**
+                 * \brief the output file; the container is chosen by the
+                 *        extension, see GetExtension
+                 */
+                std::string m_fileName;
+                Codec m_codec { Codec::H264 };
+
+                /**
+                 * \brief the frame rate of the video; frames arriving faster
+                 *        are skipped
+                 */
+                double m_frameRate { 25.0 };
+
+                /**
+                 * \brief the maximum size of the video; larger images are
+                 *        scaled down keeping the aspect ratio; 0 for no limit
+                 */
+                ///@{
+                int m_maxWidth { 0 };
+                int m_maxHeight { 0 };
+                ///@}
+
+                /**
+                 * \brief the number of threads used by the codec; 0 to let
+                 *        the codec choose
+                 */
+                unsigned m_threads { 0 };
+
+                /**
+                 * \brief the constant rate factor of H.264 and H.265; lower
+                 *        values result in a higher quality and bitrate
+                 */
+                int m_crf { 23 };
+
+                /**
+                 * \brief the number of images buffered for the encoder thread
+                 */
+                size_t m_queueSize { 4 };
+            };
+
+            struct Statistics
+            {
+                VmbUint64_t m_framesEncoded { 0 };
+
+                /**
+                 * \brief frames not encoded to reduce the frame rate
+                 */
+                VmbUint64_t m_framesSkipped { 0 };
+
+                /**
+                 * \brief frames dropped, because the queue was full
+                 */
+                VmbUint64_t m_framesDropped { 0 };
+                VmbUint64_t m_bytesWritten { 0 };
+                Clock::duration m_averageEncodeTime {};
+                size_t m_queueDepth { 0 };
+
+                /**
+                 * \brief the error stopping the encoder; empty, if none occurred
+                 */
+                std::string m_error;
+            };
+
+            /**
+             * \return true, if the sink was built with libavcodec
+             */
+            static bool IsAvailable() noexcept;
+
+            /**
+             * \return the file extension including the dot used for a codec
+             */
+            static char const* GetExtension(Codec codec) noexcept;
+
+            /**
+             * \brief starts the encoder thread; the file is created when the
+             *        first frame is received, since the size is not known before
+             * \throws VmbException, if the sink is not available or the
+             *                      settings are invalid
+             */
+            VideoEncoderSink(Settings const& settings);
+
+            /**
+             * \brief calls Stop
+             */
+            ~VideoEncoderSink();
+
+            VideoEncoderSink(VideoEncoderSink const&) = delete;
+            VideoEncoderSink& operator=(VideoEncoderSink const&) = delete;
+
+            void ConvertedFrameReceived(Image const& image, VmbFrame_t const& frame) override;
+
+            /**
+             * \brief encode the images queued, flush the codec and complete
+             *        the file
+             */
+            void Stop() noexcept;
+
+            Statistics GetStatistics() const;
+
+            std::string const& GetFileName() const noexcept
+            {
+                return m_settings.m_fileName;
+            }
+        private:
+            /**
+             * \brief the libav objects of the output; defined in the
+             *        implementation to keep the libav headers private
+             */
+            struct Output;
+
+            struct Slot
+            {
+                std::vector<unsigned char> m_data;
+                int m_width { 0 };
+                int m_height { 0 };
+                VmbPixelFormat_t m_pixelFormat { VmbPixelFormatLast };
+                VmbUint64_t m_frameId { 0 };
+
+                /**
+                 * \brief the presentation time in units of the frame period
+                 */
+                VmbInt64_t m_pts { 0 };
+            };
+
+            Settings const m_settings;
+
+            std::vector<Slot> m_slots;
+
+            mutable std::mutex m_mutex;
+            std::condition_variable m_condition;
+
+            /**
+             * \name State guarded by m_mutex
+             */
+            ///@{
+            std::vector<size_t> m_freeSlots;
+            std::deque<size_t> m_queuedSlots;
+            bool m_stop { false };
+            std::string m_error;
+            ///@}
+
+            /**
+             * \name State of the conversion thread
+             */
+            ///@{
+            bool m_started { false };
+            Clock::time_point m_startTime;
+            VmbInt64_t m_lastPts { -1 };
+            ///@}
+
+            std::atomic<bool> m_failed { false };
+            std::atomic<VmbUint64_t> m_framesEncoded { 0 };
+            std::atomic<VmbUint64_t> m_framesSkipped { 0 };
+            std::atomic<VmbUint64_t> m_framesDropped { 0 };
+            std::atomic<VmbUint64_t> m_bytesWritten { 0 };
+            std::atomic<Clock::rep> m_encodeTime { 0 };
+
+            std::unique_ptr<Output> m_output;
+
+            std::thread m_encoderThread;
+
+            void Encode();
+
+            /**
+             * \brief create the file and the codec for the size of the first image
+             * \throws VmbException, if libav reports an error
+             */
+            void Open(Slot const& slot);
+
+            /**
+             * \brief pass an image to the codec; nullptr to flush the codec
+             * \throws VmbException, if libav reports an error
+             */
+            void EncodeSlot(Slot const* slot);
+        };
+    }
+}
+
+#endif
@@ -0,0 +1,88 @@
+/**
+ * \date 2023
+ * \copyright Allied Vision Technologies.  All Rights Reserved.
+ *
+ * \copyright Redistribution of this file, in original or modified form, without
+ *            prior written consent of Allied Vision Technologies is prohibited.
+ *
+ * \warning THIS SOFTWARE IS PROVIDED BY THE AUTHOR "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF TITLE,
+ * NON-INFRINGEMENT, MERCHANTABILITY AND FITNESS FOR A PARTICULAR  PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \brief Layout of the data exchanged between the work queue and its workers
+ */
+
+#ifndef ASYNCHRONOUSGRAB_C_WORK_QUEUE_FORMAT_H
+#define ASYNCHRONOUSGRAB_C_WORK_QUEUE_FORMAT_H
+
+#include <VmbC/VmbC.h>
+
+#include "FrameStreamFormat.h"
+
+namespace VmbC
+{
+    namespace Examples
+    {
+        /**
+         * \brief Layout of the data exchanged by WorkQueueServer and its
+         *        workers.
+         *
+         * The server sends the same data as FrameStreamServer, but starts
+         * with a FrameStreamFormat::StreamHeader containing WorkQueueFormat::Magic
+         * and sends each frame to a single worker only. A worker sends
+         * WorkerMessage structs: a Credits message grants the server the
+         * number of frames the worker accepts in addition to the frames in
+         * progress; a Result message followed by m_resultSize bytes returns
+         * the result of a frame and with it the credit the frame used. The
+         * server only sends frames the worker granted credits for. All values
+         * are stored in the byte order of the sending system.
+         */
+        namespace WorkQueueFormat
+        {
+            constexpr char Magic[8] = { 'V', 'M', 'B', 'W', 'O', 'R', 'K', '\0' };
+
+            constexpr VmbUint32_t Version = 1;
+
+            /**
+             * \brief magic value of a WorkerMessage; "WMSG"
+             */
+            constexpr VmbUint32_t MessageMagic = 0x47534D57;
+
+            /**
+             * \brief values of WorkerMessage::m_type
+             */
+            enum MessageType : VmbUint32_t
+            {
+                MessageCredits = 1,
+                MessageResult = 2
+            };
+
+            struct WorkerMessage
+            {
+                VmbUint32_t m_magic;
+
+                VmbUint32_t m_type;
+
+                /**
+                 * \brief the frame the result belongs to
+                 */
+                VmbUint64_t m_frameId;
+
+                /**
+                 * \brief the credits granted by a Credits message
+                 */
+                VmbUint32_t m_credits;
+                VmbUint32_t m_resultSize;
+            };
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,449 @@
+/**
+ * \date 2023
+ * \copyright Allied Vision Technologies.  All Rights Reserved.
+ *
+ * \copyright Redistribution of this file, in original or modified form, without
+ *            prior written consent of Allied Vision Technologies is prohibited.
+ *
+ * \warning THIS SOFTWARE IS PROVIDED BY THE AUTHOR "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF TITLE,
+ * NON-INFRINGEMENT, MERCHANTABILITY AND FITNESS FOR A PARTICULAR  PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \brief Implementation of ::VmbC::Examples::WorkQueueServer
+ */
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+
+#include "FrameCopy.h"
+#include "Tracing.h"
+#include "VmbException.h"
+#include "WorkQueueFormat.h"
+#include "WorkQueueServer.h"
+
+namespace VmbC
+{
+    namespace Examples
+    {
+        namespace
+        {
+            /**
+             * \brief interval for checking, if the server should stop or a
+             *        worker was closed
+             */
+            constexpr std::chrono::milliseconds StopCheckInterval { 100 };
+        }
+
+        WorkQueueServer::WorkQueueServer(Settings const& settings, ResultSink* const resultSink)
+            : m_settings(settings),
+            m_resultSink(resultSink),
+            m_slots(settings.m_slotCount),
+            m_listenSocket(Socket::Listen(settings.m_port, settings.m_loopbackOnly)),
+            m_port(m_listenSocket.GetLocalPort())
+        /* 槽的缓冲区在第一次使用时按帧大小分配。线程在最后启动，因为它们会立即使用其他成员。 */
+        {
+            if (settings.m_slotCount == 0 || settings.m_maxPendingResults == 0 || settings.m_maxWorkers == 0)
+            {
+                throw VmbException("the slot count, the pending results and the number of workers of the work queue need to be positive", VmbErrorBadParameter);
+            }
+
+            m_freeSlots.reserve(settings.m_slotCount);
+            for (size_t slot = settings.m_slotCount; slot != 0; --slot)
+            {
+                m_freeSlots.push_back(slot - 1);
+            }
+            m_deliveryThread = std::thread(&WorkQueueServer::DeliverResults, this);
+            m_serverThread = std::thread(&WorkQueueServer::Serve, this);
+        }
+
+        WorkQueueServer::~WorkQueueServer()
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_stop = true;
+            }
+            m_workCondition.notify_all();
+            m_resultCondition.notify_all();
+            m_serverThread.join();
+            m_deliveryThread.join();
+        }
+
+        void WorkQueueServer::FrameReceived(VmbFrame_t const& frame)
+        /* 在VmbC回调线程中调用：没有未关闭的工作进程时什么都不做；复制期间最后一个工作进程关闭时丢弃该帧。没有空闲槽（所有工作进程都忙且队列已满）
+        或等待结果的帧太多（例如某个工作进程停止响应）时丢弃该帧，从不等待工作进程。
+        复制在锁外进行；帧在复制完成后才作为任务排队，任务的序号就是结果的交付顺序。 */
+        {
+            size_t index;
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                if (m_openWorkers == 0 || m_stop)
+                {
+                    return;
+                }
+                ++m_framesReceived;
+                if (m_freeSlots.empty() || m_jobs.size() >= m_settings.m_maxPendingResults)
+                {
+                    ++m_framesDropped;
+                    return;
+                }
+                index = m_freeSlots.back();
+                m_freeSlots.pop_back();
+            }
+
+            ASYNCHRONOUSGRAB_TRACE_SCOPE("CopyWorkFrame", frame.frameID);
+            Slot& slot = m_slots[index];
+            bool const copied = CopyToSlot(slot.m_buffer, frame.buffer, frame.bufferSize);
+            FrameStreamFormat::FillFrameHeader(slot.m_header, frame);
+
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                if (!copied || m_openWorkers == 0)
+                {
+                    ++m_framesDropped;
+                    m_freeSlots.push_back(index);
+                    return;
+                }
+                slot.m_sequence = m_firstSequence + m_jobs.size();
+                m_jobs.emplace_back();
+                m_jobs.back().m_frameId = frame.frameID;
+                m_queuedSlots.push_back(index);
+            }
+            m_workCondition.notify_all();
+        }
+
+        WorkQueueServer::Statistics WorkQueueServer::GetStatistics() const
+        {
+            Statistics statistics;
+            statistics.m_framesReceived = m_framesReceived.load(std::memory_order_relaxed);
+            statistics.m_framesDropped = m_framesDropped.load(std::memory_order_relaxed);
+            statistics.m_resultsDelivered = m_resultsDelivered.load(std::memory_order_relaxed);
+            statistics.m_framesLost = m_framesLost.load(std::memory_order_relaxed);
+
+            auto const now = Clock::now();
+            std::lock_guard<std::mutex> lock(m_mutex);
+            statistics.m_framesQueued = m_queuedSlots.size();
+            statistics.m_pendingResults = m_jobs.size();
+            for (auto const& worker : m_workers)
+            {
+                if (worker.m_closed)
+                {
+                    continue;
+                }
+                WorkerStatistics entry;
+                entry.m_peer = worker.m_peer;
+                entry.m_credits = worker.m_credits;
+                entry.m_framesInProgress = worker.m_jobs.size();
+                entry.m_framesSent = worker.m_framesSent;
+                entry.m_results = worker.m_results;
+                double const connectedTime = std::chrono::duration<double>(now - worker.m_connected).count();
+                if (connectedTime > 0)
+                {
+                    entry.m_resultRate = static_cast<double>(worker.m_results) / connectedTime;
+                }
+                if (worker.m_results != 0)
+                {
+                    entry.m_averageTurnaround = worker.m_turnaroundSum / static_cast<Clock::rep>(worker.m_results);
+                }
+                statistics.m_workers.push_back(std::move(entry));
+            }
+            return statistics;
+        }
+
+        void WorkQueueServer::Serve()
+        /* 后台线程：以 StopCheckInterval 为间隔等待新的工作进程，每个工作进程由一个发送线程和一个接收线程服务。
+        与FrameStreamServer相同，已结束的工作进程在锁内移出列表，在锁外等待其线程结束。 */
+        {
+            ASYNCHRONOUSGRAB_TRACE_THREAD_NAME("WorkQueue server");
+
+            while (!m_stop)
+            {
+                std::list<Worker> finished;
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    for (auto pos = m_workers.begin(); pos != m_workers.end();)
+                    {
+                        auto const next = std::next(pos);
+                        if (pos->m_runningThreads.load(std::memory_order_acquire) == 0)
+                        {
+                            finished.splice(finished.end(), m_workers, pos);
+                        }
+                        pos = next;
+                    }
+                }
+                for (auto& worker : finished)
+                {
+                    worker.m_sendThread.join();
+                    worker.m_receiveThread.join();
+                }
+
+                if (!m_listenSocket.WaitReadable(StopCheckInterval))
+                {
+                    continue;
+                }
+
+                Socket connection = m_listenSocket.Accept();
+                if (!connection.IsValid())
+                {
+                    continue;
+                }
+                connection.SetSendTimeout(m_settings.m_sendTimeout);
+                connection.SetReceiveTimeout(m_settings.m_sendTimeout);
+                connection.SetNoDelay();
+
+                std::lock_guard<std::mutex> lock(m_mutex);
+                if (m_workers.size() >= m_settings.m_maxWorkers)
+                {
+                    continue;
+                }
+                m_workers.emplace_back();
+                auto& worker = m_workers.back();
+                worker.m_peer = connection.GetPeerName();
+                worker.m_connection = std::move(connection);
+                worker.m_connected = Clock::now();
+                ++m_openWorkers;
+                worker.m_sendThread = std::thread(&WorkQueueServer::SendFrames, this, std::ref(worker));
+                worker.m_receiveThread = std::thread(&WorkQueueServer::ReceiveMessages, this, std::ref(worker));
+            }
+
+            for (auto& worker : m_workers)
+            {
+                worker.m_sendThread.join();
+                worker.m_receiveThread.join();
+            }
+            m_workers.clear();
+        }
+
+        void WorkQueueServer::SendFrames(Worker& worker)
+        /* 工作进程有剩余信用且有排队的帧时取出最早的帧，因此先有空闲信用的工作进程得到下一帧，
+        处理快的工作进程归还信用快，自然得到更多的帧。任务在发送前就记入工作进程，
+        这样即使结果在发送返回之前到达也能找到对应的任务。槽在发送完成后释放。 */
+        {
+            ASYNCHRONOUSGRAB_TRACE_THREAD_NAME("WorkQueue sender");
+
+            auto const& connection = worker.m_connection;
+            FrameStreamFormat::StreamHeader streamHeader {};
+            std::memcpy(streamHeader.m_magic, WorkQueueFormat::Magic, sizeof(streamHeader.m_magic));
+            streamHeader.m_version = WorkQueueFormat::Version;
+            streamHeader.m_frameHeaderSize = sizeof(FrameStreamFormat::FrameHeader);
+            bool connected = connection.SendAll(&streamHeader, sizeof(streamHeader));
+
+            std::unique_lock<std::mutex> lock(m_mutex);
+            while (connected)
+            {
+                m_workCondition.wait(lock, [this, &worker]()
+                                     {
+                                         return m_stop || worker.m_closed || (worker.m_credits != 0 && !m_queuedSlots.empty());
+                                     });
+                if (m_stop || worker.m_closed)
+                {
+                    break;
+                }
+
+                size_t const index = m_queuedSlots.front();
+                m_queuedSlots.pop_front();
+                Slot const& slot = m_slots[index];
+                Job& job = m_jobs[static_cast<size_t>(slot.m_sequence - m_firstSequence)];
+                job.m_sent = true;
+                job.m_sendTime = Clock::now();
+                --worker.m_credits;
+                worker.m_jobs.push_back(SentJob{ slot.m_sequence, job.m_frameId });
+                ++worker.m_framesSent;
+                lock.unlock();
+
+                {
+                    ASYNCHRONOUSGRAB_TRACE_SCOPE("SendWorkFrame", slot.m_header.m_frameId);
+                    connected = connection.SendAll(&slot.m_header, sizeof(slot.m_header))
+                        && connection.SendAll(slot.m_buffer.GetData(), static_cast<size_t>(slot.m_header.m_bufferSize));
+                }
+
+                lock.lock();
+                m_freeSlots.push_back(index);
+            }
+
+            CloseWorker(worker);
+            worker.m_runningThreads.fetch_sub(1, std::memory_order_release);
+        }
+
+        void WorkQueueServer::ReceiveMessages(Worker& worker)
+        /* 信用消息增加工作进程的信用；结果消息归还其帧占用的信用并完成任务。
+        结果按帧ID对应到发送给该工作进程的任务，包括已作为丢失交付的任务（超时），因此乱序或迟到的结果不会被其他任务占用；
+        已丢失的任务的结果被丢弃，只归还信用。格式错误的消息断开工作进程。 */
+        {
+            ASYNCHRONOUSGRAB_TRACE_THREAD_NAME("WorkQueue receiver");
+
+            auto const& connection = worker.m_connection;
+            WorkQueueFormat::WorkerMessage message;
+            std::vector<unsigned char> result;
+            while (true)
+            {
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    if (m_stop || worker.m_closed)
+                    {
+                        break;
+                    }
+                }
+                if (!connection.WaitReadable(StopCheckInterval))
+                {
+                    continue;
+                }
+
+                if (!connection.ReceiveAll(&message, sizeof(message)) || message.m_magic != WorkQueueFormat::MessageMagic)
+                {
+                    break;
+                }
+                if (message.m_type == WorkQueueFormat::MessageCredits)
+                {
+                    {
+                        std::lock_guard<std::mutex> lock(m_mutex);
+                        worker.m_credits += message.m_credits;
+                    }
+                    m_workCondition.notify_all();
+                    continue;
+                }
+                if (message.m_type != WorkQueueFormat::MessageResult || message.m_resultSize > m_settings.m_maxResultSize)
+                {
+                    break;
+                }
+
+                result.resize(message.m_resultSize);
+                if (!connection.ReceiveAll(result.data(), result.size()))
+                {
+                    break;
+                }
+
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    auto const now = Clock::now();
+                    for (auto pos = worker.m_jobs.begin(); pos != worker.m_jobs.end(); ++pos)
+                    {
+                        if (pos->m_frameId != message.m_frameId)
+                        {
+                            continue;
+                        }
+                        VmbUint64_t const sequence = pos->m_sequence;
+                        if (sequence >= m_firstSequence)
+                        {
+                            worker.m_turnaroundSum += now - m_jobs[static_cast<size_t>(sequence - m_firstSequence)].m_sendTime;
+                            FinishJob(sequence, &result);
+                        }
+                        worker.m_jobs.erase(pos);
+                        ++worker.m_credits;
+                        ++worker.m_results;
+                        break;
+                    }
+                }
+                m_workCondition.notify_all();
+            }
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+            CloseWorker(worker);
+            worker.m_runningThreads.fetch_sub(1, std::memory_order_release);
+        }
+
+        void WorkQueueServer::DeliverResults()
+        /* 交付线程：按序号依次交付已完成的任务，回调在锁外进行，不阻塞发送和接收线程。
+        最早的任务已发送但超过 m_resultTimeout 仍没有结果时作为丢失交付，
+        其工作进程保留这个任务占用的信用，因此不再响应的工作进程不会继续得到帧。 */
+        {
+            ASYNCHRONOUSGRAB_TRACE_THREAD_NAME("WorkQueue delivery");
+
+            std::unique_lock<std::mutex> lock(m_mutex);
+            while (!m_stop)
+            {
+                if (m_jobs.empty() || !m_jobs.front().m_finished)
+                {
+                    if (!m_jobs.empty() && m_jobs.front().m_sent)
+                    {
+                        auto const deadline = m_jobs.front().m_sendTime + m_settings.m_resultTimeout;
+                        if (Clock::now() >= deadline)
+                        {
+                            FinishJob(m_firstSequence, nullptr);
+                            continue;
+                        }
+                        m_resultCondition.wait_until(lock, (std::min)(deadline, Clock::now() + StopCheckInterval));
+                    }
+                    else
+                    {
+                        m_resultCondition.wait_for(lock, StopCheckInterval);
+                    }
+                    continue;
+                }
+
+                Job job = std::move(m_jobs.front());
+                m_jobs.pop_front();
+                ++m_firstSequence;
+                lock.unlock();
+
+                if (job.m_lost)
+                {
+                    ++m_framesLost;
+                }
+                else
+                {
+                    ++m_resultsDelivered;
+                }
+                if (m_resultSink != nullptr)
+                {
+                    m_resultSink->ResultReceived(job.m_frameId, job.m_result, job.m_lost);
+                }
+                lock.lock();
+            }
+        }
+
+        void WorkQueueServer::CloseWorker(Worker& worker)
+        /* 关闭最后一个工作进程时，还未发送的任务不会再有工作进程接收，作为丢失交付并释放其槽，
+        这样交付不会停在这些任务上，之后连接的工作进程也不会收到这些过时的帧。 */
+        {
+            if (worker.m_closed)
+            {
+                return;
+            }
+            worker.m_closed = true;
+            worker.m_credits = 0;
+            for (auto const& job : worker.m_jobs)
+            {
+                FinishJob(job.m_sequence, nullptr);
+            }
+            worker.m_jobs.clear();
+            if (--m_openWorkers == 0)
+            {
+                for (auto const index : m_queuedSlots)
+                {
+                    FinishJob(m_slots[index].m_sequence, nullptr);
+                    m_freeSlots.push_back(index);
+                }
+                m_queuedSlots.clear();
+            }
+            m_workCondition.notify_all();
+        }
+
+        void WorkQueueServer::FinishJob(VmbUint64_t const sequence, std::vector<unsigned char>* const result)
+        {
+            if (sequence < m_firstSequence)
+            {
+                return;
+            }
+            Job& job = m_jobs[static_cast<size_t>(sequence - m_firstSequence)];
+            if (job.m_finished)
+            {
+                return;
+            }
+            job.m_finished = true;
+            job.m_lost = (result == nullptr);
+            if (result != nullptr)
+            {
+                job.m_result.swap(*result);
+            }
+            m_resultCondition.notify_one();
+        }
+    }
+}
@@ -0,0 +1,389 @@
+/**
+ * \date 2023
+ * \copyright Allied Vision Technologies.  All Rights Reserved.
+ *
+ * \copyright Redistribution of this file, in original or modified form, without
+ *            prior written consent of Allied Vision Technologies is prohibited.
+ *
+ * \warning THIS SOFTWARE IS PROVIDED BY THE AUTHOR "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF TITLE,
+ * NON-INFRINGEMENT, MERCHANTABILITY AND FITNESS FOR A PARTICULAR  PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \brief Definition of a server distributing the raw frames to a pool of workers
+ */
+
+#ifndef ASYNCHRONOUSGRAB_C_WORK_QUEUE_SERVER_H
+#define ASYNCHRONOUSGRAB_C_WORK_QUEUE_SERVER_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <list>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <VmbC/VmbC.h>
+
+#include "AlignedBuffer.h"
+#include "FrameSink.h"
+#include "FrameStreamFormat.h"
+#include "Socket.h"
+
+namespace VmbC
+{
+    namespace Examples
+    {
+        /**
+         * \brief Distributes the raw frames of an acquisition to a pool of
+         *        worker processes connected via TCP, e.g. using
+         *        WorkQueueWorker, and collects their results; see
+         *        WorkQueueFormat for the protocol.
+         *
+         * Unlike FrameStreamServer, every frame is sent to exactly one
+         * worker. Workers grant credits for the number of frames they accept
+         * at a time; FrameReceived copies the frame into a free slot of a
+         * fixed pool and the next worker with a credit left takes it, so
+         * faster workers receive more frames. If no slot is free, because
+         * all workers are busy, the frame is dropped; the VmbC callback
+         * thread never waits for the workers.
+         *
+         * The results are passed to the ResultSink in the order the frames
+         * were received, regardless of the order the workers finish them.
+         * Frames of workers disconnecting or not returning a result within
+         * m_resultTimeout are reported as lost, so a failing worker does not
+         * stop the delivery of the later results.
+         */
+        class WorkQueueServer : public RawFrameSink
+        {
+        public:
+            using Clock = std::chrono::steady_clock;
+
+            static constexpr VmbUint16_t DefaultPort = 5563;
+
+            /**
+             * \brief Receiver of the results of the workers
+             */
+            class ResultSink
+            {
+            public:
+                virtual ~ResultSink() = default;
+
+                /**
+                 * \brief called by a thread of the server in the order the
+                 *        frames were received
+                 * \param[in] frameId the frame the result belongs to
+                 * \param[in] data the result of the worker; only valid until
+                 *                 the function returns
+                 * \param[in] lost true, if the worker of the frame
+                 *                 disconnected or timed out; data is empty
+                 */
+                virtual void ResultReceived(VmbUint64_t frameId, std::vector<unsigned char> const& data, bool lost) = 0;
+            };
+
+            struct Settings
+            {
+                /**
+                 * \brief the port to listen on; 0 chooses a free port
+                 */
+                VmbUint16_t m_port { DefaultPort };
+
+                /**
+                 * \brief if false, workers of other hosts are accepted
+                 */
+                bool m_loopbackOnly { true };
+
+                /**
+                 * \brief the number of frames waiting for a worker
+                 */
+                size_t m_slotCount { 16 };
+
+                /**
+                 * \brief the maximum number of frames waiting for their result
+                 *        or for the results of earlier frames; further
+                 *        frames are dropped
+                 */
+                size_t m_maxPendingResults { 256 };
+
+                /**
+                 * \brief frames without result after this time are reported
+                 *        as lost
+                 */
+                std::chrono::milliseconds m_resultTimeout { 10000 };
+
+                /**
+                 * \brief the maximum size of a result; workers sending larger
+                 *        results are disconnected
+                 */
+                size_t m_maxResultSize { 16 << 20 };
+
+                unsigned m_maxWorkers { 64 };
+
+                /**
+                 * \brief workers not receiving data for this time are
+                 *        disconnected
+                 */
+                std::chrono::milliseconds m_sendTimeout { 5000 };
+            };
+
+            struct WorkerStatistics
+            {
+                /**
+                 * \brief address and port of the worker
+                 */
+                std::string m_peer;
+
+                /**
+                 * \brief the credits left and the frames in progress
+                 */
+                ///@{
+                unsigned m_credits { 0 };
+                size_t m_framesInProgress { 0 };
+                ///@}
+                VmbUint64_t m_framesSent { 0 };
+                VmbUint64_t m_results { 0 };
+
+                /**
+                 * \brief the average number of results per second since the
+                 *        worker connected
+                 */
+                double m_resultRate { 0.0 };
+
+                /**
+                 * \brief the average time from sending a frame until its result
+                 *        was received
+                 */
+                Clock::duration m_averageTurnaround {};
+            };
+
+            struct Statistics
+            {
+                VmbUint64_t m_framesReceived { 0 };
+
+                /**
+                 * \brief frames not distributed, because no slot was free or
+                 *        too many results were pending
+                 */
+                VmbUint64_t m_framesDropped { 0 };
+                VmbUint64_t m_resultsDelivered { 0 };
+
+                /**
+                 * \brief frames reported as lost
+                 */
+                VmbUint64_t m_framesLost { 0 };
+
+                /**
+                 * \brief frames waiting for a worker
+                 */
+                size_t m_framesQueued { 0 };
+
+                /**
+                 * \brief frames waiting for their result or for the results
+                 *        of earlier frames
+                 */
+                size_t m_pendingResults { 0 };
+                std::vector<WorkerStatistics> m_workers;
+            };
+
+            /**
+             * \brief start listening for workers
+             * \param[in] resultSink the receiver of the results; may be null,
+             *                       if the results are not needed
+             * \throws VmbException, if the settings are invalid or the port
+             *                      cannot be bound
+             */
+            WorkQueueServer(Settings const& settings, ResultSink* resultSink);
+
+            /**
+             * \brief disconnects the workers; results not delivered yet are
+             *        discarded
+             */
+            ~WorkQueueServer();
+
+            WorkQueueServer(WorkQueueServer const&) = delete;
+            WorkQueueServer& operator=(WorkQueueServer const&) = delete;
+
+            void FrameReceived(VmbFrame_t const& frame) override;
+
+            VmbUint16_t GetPort() const noexcept
+            {
+                return m_port;
+            }
+
+            Statistics GetStatistics() const;
+        private:
+            struct Slot
+            {
+                AlignedBuffer m_buffer;
+                FrameStreamFormat::FrameHeader m_header {};
+
+                /**
+                 * \brief the sequence number of the job of the frame
+                 */
+                VmbUint64_t m_sequence { 0 };
+            };
+
+            /**
+             * \brief a frame distributed, in the order received
+             */
+            struct Job
+            {
+                VmbUint64_t m_frameId { 0 };
+                bool m_sent { false };
+                bool m_finished { false };
+                bool m_lost { false };
+                Clock::time_point m_sendTime;
+                std::vector<unsigned char> m_result;
+            };
+
+            /**
+             * \brief a job sent to a worker
+             */
+            struct SentJob
+            {
+                VmbUint64_t m_sequence;
+
+                /**
+                 * \brief the frame ID the result refers to; also needed
+                 *        after the job was delivered as lost
+                 */
+                VmbUint64_t m_frameId;
+            };
+
+            struct Worker
+            {
+                Socket m_connection;
+                std::string m_peer;
+                Clock::time_point m_connected;
+                std::thread m_sendThread;
+                std::thread m_receiveThread;
+
+                /**
+                 * \brief the number of the two threads still running
+                 */
+                std::atomic<unsigned> m_runningThreads { 2 };
+
+                /**
+                 * \name State guarded by m_mutex of the server
+                 */
+                ///@{
+                /**
+                 * \brief set, if one of the threads stopped; the other one
+                 *        stops, too
+                 */
+                bool m_closed { false };
+                unsigned m_credits { 0 };
+
+                /**
+                 * \brief the jobs sent to the worker without a result yet,
+                 *        including the ones delivered as lost
+                 */
+                std::deque<SentJob> m_jobs;
+                VmbUint64_t m_framesSent { 0 };
+                VmbUint64_t m_results { 0 };
+                Clock::duration m_turnaroundSum {};
+                ///@}
+            };
+
+            Settings const m_settings;
+            ResultSink* const m_resultSink;
+
+            std::vector<Slot> m_slots;
+
+            mutable std::mutex m_mutex;
+
+            /**
+             * \brief notified when frames are queued, credits are granted,
+             *        a worker is closed or m_stop is set
+             */
+            std::condition_variable m_workCondition;
+
+            /**
+             * \brief notified when a job is finished or m_stop is set
+             */
+            std::condition_variable m_resultCondition;
+
+            /**
+             * \name State guarded by m_mutex
+             */
+            ///@{
+            std::vector<size_t> m_freeSlots;
+
+            /**
+             * \brief the slots waiting for a worker
+             */
+            std::deque<size_t> m_queuedSlots;
+
+            /**
+             * \brief the jobs not delivered yet; m_jobs[i] has the sequence
+             *        number m_firstSequence + i
+             */
+            std::deque<Job> m_jobs;
+            VmbUint64_t m_firstSequence { 0 };
+
+            std::list<Worker> m_workers;
+
+            /**
+             * \brief the workers in m_workers not closed yet; frames are
+             *        only queued while there is one
+             */
+            unsigned m_openWorkers { 0 };
+            ///@}
+
+            std::atomic<bool> m_stop { false };
+            std::atomic<VmbUint64_t> m_framesReceived { 0 };
+            std::atomic<VmbUint64_t> m_framesDropped { 0 };
+            std::atomic<VmbUint64_t> m_resultsDelivered { 0 };
+            std::atomic<VmbUint64_t> m_framesLost { 0 };
+
+            Socket m_listenSocket;
+            VmbUint16_t m_port;
+            std::thread m_serverThread;
+            std::thread m_deliveryThread;
+
+            /**
+             * \brief accept workers and join the threads of the closed ones
+             */
+            void Serve();
+
+            /**
+             * \brief send queued frames while the worker has credits left
+             */
+            void SendFrames(Worker& worker);
+
+            /**
+             * \brief read the credits and the results sent by a worker
+             */
+            void ReceiveMessages(Worker& worker);
+
+            /**
+             * \brief pass the finished jobs to m_resultSink in order
+             */
+            void DeliverResults();
+
+            /**
+             * \brief mark the jobs of a worker lost and stop its threads;
+             *        the queued jobs, too, if it was the last open worker;
+             *        m_mutex needs to be locked
+             */
+            void CloseWorker(Worker& worker);
+
+            /**
+             * \brief finish a job; m_mutex needs to be locked
+             */
+            void FinishJob(VmbUint64_t sequence, std::vector<unsigned char>* result);
+        };
+    }
+}
+
+#endif
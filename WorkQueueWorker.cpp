@@ -0,0 +1,63 @@
+/**
+ * \date 2023
+ * \copyright Allied Vision Technologies.  All Rights Reserved.
+ *
+ * \copyright Redistribution of this file, in original or modified form, without
+ *            prior written consent of Allied Vision Technologies is prohibited.
+ *
+ * \warning THIS SOFTWARE IS PROVIDED BY THE AUTHOR "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF TITLE,
+ * NON-INFRINGEMENT, MERCHANTABILITY AND FITNESS FOR A PARTICULAR  PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \brief Implementation of ::VmbC::Examples::WorkQueueWorker
+ */
+
+#include "VmbException.h"
+#include "WorkQueueFormat.h"
+#include "WorkQueueWorker.h"
+
+namespace VmbC
+{
+    namespace Examples
+    {
+        WorkQueueWorker::WorkQueueWorker(std::string const& host, VmbUint16_t const port, unsigned const credits)
+            : FrameStreamClient(host, port, WorkQueueFormat::Magic, WorkQueueFormat::Version)
+        /* 结果消息很小，关闭Nagle算法，否则消息头之后的结果数据要等待服务器的确认，延迟归还信用。 */
+        {
+            GetConnection().SetNoDelay();
+            GrantCredits(credits);
+        }
+
+        void WorkQueueWorker::GrantCredits(unsigned const credits)
+        {
+            WorkQueueFormat::WorkerMessage message {};
+            message.m_magic = WorkQueueFormat::MessageMagic;
+            message.m_type = WorkQueueFormat::MessageCredits;
+            message.m_credits = credits;
+            if (!GetConnection().SendAll(&message, sizeof(message)))
+            {
+                throw VmbException("the connection to the work queue was lost");
+            }
+        }
+
+        void WorkQueueWorker::SendResult(VmbUint64_t const frameId, void const* const data, size_t const size)
+        {
+            WorkQueueFormat::WorkerMessage message {};
+            message.m_magic = WorkQueueFormat::MessageMagic;
+            message.m_type = WorkQueueFormat::MessageResult;
+            message.m_frameId = frameId;
+            message.m_resultSize = static_cast<VmbUint32_t>(size);
+            if (!GetConnection().SendAll(&message, sizeof(message)) || (size != 0 && !GetConnection().SendAll(data, size)))
+            {
+                throw VmbException("the connection to the work queue was lost");
+            }
+        }
+    }
+}
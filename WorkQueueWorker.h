@@ -0,0 +1,73 @@
+/**
+ * \date 2023
+ * \copyright Allied Vision Technologies.  All Rights Reserved.
+ *
+ * \copyright Redistribution of this file, in original or modified form, without
+ *            prior written consent of Allied Vision Technologies is prohibited.
+ *
+ * \warning THIS SOFTWARE IS PROVIDED BY THE AUTHOR "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF TITLE,
+ * NON-INFRINGEMENT, MERCHANTABILITY AND FITNESS FOR A PARTICULAR  PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \brief Definition of a worker processing frames of a WorkQueueServer
+ */
+
+#ifndef ASYNCHRONOUSGRAB_C_WORK_QUEUE_WORKER_H
+#define ASYNCHRONOUSGRAB_C_WORK_QUEUE_WORKER_H
+
+#include <cstddef>
+#include <string>
+
+#include <VmbC/VmbC.h>
+
+#include "FrameStreamClient.h"
+
+namespace VmbC
+{
+    namespace Examples
+    {
+        /**
+         * \brief Worker of a WorkQueueServer, e.g. a process running an
+         *        inspection algorithm on another host.
+         *
+         * The frames are read like the frames of a FrameStreamServer; the
+         * server sends no more frames than the credits granted, and every
+         * result sent returns the credit of its frame. Granting more than
+         * one credit lets the next frame arrive while the current one is
+         * processed.
+         *
+         * An object may only be used by one thread at a time.
+         */
+        class WorkQueueWorker : public FrameStreamClient
+        {
+        public:
+            /**
+             * \brief connect to a server and grant the initial credits
+             * \throws VmbException, if the server cannot be reached or is
+             *                      no work queue
+             */
+            WorkQueueWorker(std::string const& host, VmbUint16_t port, unsigned credits);
+
+            /**
+             * \brief allow the server to send more frames at a time
+             * \throws VmbException, if the connection was lost
+             */
+            void GrantCredits(unsigned credits);
+
+            /**
+             * \brief return the result of a frame read before
+             * \throws VmbException, if the connection was lost
+             */
+            void SendResult(VmbUint64_t frameId, void const* data, size_t size);
+        };
+    }
+}
+
+#endif
@@ -19,15 +19,248 @@
  * \brief Entry point of the Asynchronous Grab Qt example using the VmbC API
  */
 
+#include <algorithm>
+
 #include <QApplication>
+#include <QCommandLineParser>
 #include <QMessageBox>
 
 #include "UI/MainWindow.h"
 
+namespace
+{
+    /**
+     * \brief show an error about the command line
+     * \return the exit code of the application
+     */
+    int ReportUsageError(QString const& message)
+    {
+        QMessageBox::critical(nullptr, QApplication::applicationName(), message);
+        return 1;
+    }
+}
+
 int main(int argc, char* argv[])
 {
     QApplication application(argc, argv);
+
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    QCommandLineOption const metricsPortOption("metrics-port",
+                                               "Serve Prometheus metrics at http://127.0.0.1:<port>/metrics.",
+                                               "port");
+    parser.addOption(metricsPortOption);
+    QCommandLineOption const reviewCacheOption("review-cache",
+                                               "Memory used for caching the frames of a reviewed recording (default 256).",
+                                               "MiB");
+    parser.addOption(reviewCacheOption);
+    QCommandLineOption const historySecondsOption("history-seconds",
+                                                  "Keep the raw frames of the last <seconds> in memory for \"Save History\".",
+                                                  "seconds");
+    parser.addOption(historySecondsOption);
+    QCommandLineOption const historySizeOption("history-size",
+                                               "Memory allocated for the frames kept for \"Save History\" (default 1024).",
+                                               "MiB");
+    parser.addOption(historySizeOption);
+    QCommandLineOption const historyPostTriggerOption("history-post-seconds",
+                                                      "Seconds of frames added to the file after clicking \"Save History\" (default 5).",
+                                                      "seconds");
+    parser.addOption(historyPostTriggerOption);
+    QCommandLineOption const recordCompressionOption("record-compression",
+                                                     "Compress recorded frames losslessly with <threads> threads (default 0, uncompressed).",
+                                                     "threads");
+    parser.addOption(recordCompressionOption);
+    QCommandLineOption const snapshotFormatOption("snapshot-format",
+                                                  "File format of \"Save Snapshot\": tiff (default) or png.",
+                                                  "format");
+    parser.addOption(snapshotFormatOption);
+    QCommandLineOption const snapshot8BitOption("snapshot-8bit",
+                                                "Convert snapshots to Mono8/Rgb8 instead of keeping the bit depth of the sensor.");
+    parser.addOption(snapshot8BitOption);
+    QCommandLineOption const snapshotFramesOption("snapshot-frames",
+                                                  "Number of frames saved per click of \"Save Snapshot\" (default 1).",
+                                                  "count");
+    parser.addOption(snapshotFramesOption);
+    QCommandLineOption const snapshotRecentOption("snapshot-recent",
+                                                  "Keep copies of the last <count> frames and save these instead of the next frames.",
+                                                  "count");
+    parser.addOption(snapshotRecentOption);
+    QCommandLineOption const videoCodecOption("video-codec",
+                                              "Encode the converted frames of each acquisition to a video: h264, h265 or ffv1.",
+                                              "codec");
+    parser.addOption(videoCodecOption);
+    QCommandLineOption const videoFpsOption("video-fps",
+                                            "Frame rate of the videos; faster frames are skipped (default 25).",
+                                            "fps");
+    parser.addOption(videoFpsOption);
+    QCommandLineOption const videoSizeOption("video-max-size",
+                                             "Scale the videos down to fit into <width>x<height>.",
+                                             "size");
+    parser.addOption(videoSizeOption);
+    QCommandLineOption const videoThreadsOption("video-threads",
+                                                "Number of encoder threads (default 0, chosen by the codec).",
+                                                "threads");
+    parser.addOption(videoThreadsOption);
+    QCommandLineOption const timeLapseOption("time-lapse",
+                                             "Trigger a single frame every <seconds> via software trigger.",
+                                             "seconds");
+    parser.addOption(timeLapseOption);
+    QCommandLineOption const sharedMemoryOption("shared-memory",
+                                                "Allocate the frame buffers in the shared memory <name> for other processes (e.g. /AsynchronousGrabFrames).",
+                                                "name");
+    parser.addOption(sharedMemoryOption);
+    QCommandLineOption const attachOption("attach",
+                                          "Let the acquisition daemon listening on <port> acquire and only display its frames.",
+                                          "port");
+    parser.addOption(attachOption);
+    QCommandLineOption const previewPortOption("preview-port",
+                                               "Stream a JPEG preview at http://127.0.0.1:<port>/stream (0 chooses a free port).",
+                                               "port");
+    parser.addOption(previewPortOption);
+    QCommandLineOption const previewBandwidthOption("preview-bandwidth",
+                                                    "Target data rate of the preview per client in KiB/s (default 2000).",
+                                                    "KiB/s");
+    parser.addOption(previewBandwidthOption);
+    QCommandLineOption const streamPortOption("stream-port",
+                                              "Send the raw frames to the subscribers connecting to TCP <port> (0 chooses a free port).",
+                                              "port");
+    parser.addOption(streamPortOption);
+    QCommandLineOption const streamAnyHostOption("stream-any-host",
+                                                 "Accept subscribers of other hosts instead of the local host only.");
+    parser.addOption(streamAnyHostOption);
+    QCommandLineOption const workPortOption("work-port",
+                                            "Distribute the raw frames to the workers connecting to TCP <port> (0 chooses a free port).",
+                                            "port");
+    parser.addOption(workPortOption);
+    QCommandLineOption const workAnyHostOption("work-any-host",
+                                               "Accept workers of other hosts instead of the local host only.");
+    parser.addOption(workAnyHostOption);
+    QCommandLineOption const chunkMetadataOption("chunk-metadata",
+                                                 "Activate the chunk mode and show, record and export exposure time, gain, line status, frame ID, timestamp and counter of every frame.");
+    parser.addOption(chunkMetadataOption);
+    QCommandLineOption const adaptivePreviewOption("adaptive-preview",
+                                                   "Skip frames, decimate and demosaic faster under load to keep the display latency below <ms>.",
+                                                   "ms");
+    parser.addOption(adaptivePreviewOption);
+    parser.process(application);
+
+    QString const snapshotFormat = parser.value(snapshotFormatOption).toLower();
+    if (parser.isSet(snapshotFormatOption) && snapshotFormat != "png" && snapshotFormat != "tiff")
+    {
+        return ReportUsageError("Unknown snapshot format \"" + parser.value(snapshotFormatOption) + "\"; use tiff or png.");
+    }
+    QString const videoCodec = parser.value(videoCodecOption).toLower();
+    if (parser.isSet(videoCodecOption) && videoCodec != "h264" && videoCodec != "h265" && videoCodec != "hevc" && videoCodec != "ffv1")
+    {
+        return ReportUsageError("Unknown video codec \"" + parser.value(videoCodecOption) + "\"; use h264, h265 or ffv1.");
+    }
+
     MainWindow mainWindow;
+    if (parser.isSet(metricsPortOption))
+    {
+        mainWindow.StartMetricsServer(static_cast<VmbUint16_t>(parser.value(metricsPortOption).toUShort()));
+    }
+    if (parser.isSet(reviewCacheOption))
+    {
+        mainWindow.SetReviewMemoryBudget(static_cast<size_t>(parser.value(reviewCacheOption).toUInt()) << 20);
+    }
+    if (parser.isSet(recordCompressionOption))
+    {
+        mainWindow.SetRecordingCompression(parser.value(recordCompressionOption).toUInt());
+    }
+    if (parser.isSet(historySecondsOption) || parser.isSet(historySizeOption))
+    {
+        VmbC::Examples::HistoryBuffer::Settings settings;
+        // without a time limit the history is only limited by its size
+        settings.m_duration = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+            std::chrono::duration<double>(parser.value(historySecondsOption).toDouble()));
+        if (parser.isSet(historySizeOption))
+        {
+            settings.m_capacity = static_cast<size_t>(parser.value(historySizeOption).toUInt()) << 20;
+        }
+        double const postTriggerSeconds = parser.isSet(historyPostTriggerOption) ? parser.value(historyPostTriggerOption).toDouble() : 5.0;
+        mainWindow.EnableHistory(settings, std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(postTriggerSeconds)));
+    }
+    {
+        VmbC::Examples::SnapshotExporter::Settings settings;
+        settings.m_format = (snapshotFormat == "png") ? VmbC::Examples::ImageFile::Format::Png : VmbC::Examples::ImageFile::Format::Tiff;
+        settings.m_eightBit = parser.isSet(snapshot8BitOption);
+        settings.m_recentFrames = parser.value(snapshotRecentOption).toUInt();
+        size_t const framesPerClick = (settings.m_recentFrames != 0)
+            ? settings.m_recentFrames
+            : (std::max)(parser.value(snapshotFramesOption).toUInt(), 1u);
+        settings.m_queueSize = (std::max)(settings.m_queueSize, framesPerClick);
+        mainWindow.EnableSnapshots(settings, framesPerClick);
+    }
+    if (parser.isSet(videoCodecOption))
+    {
+        VmbC::Examples::VideoEncoderSink::Settings settings;
+        settings.m_codec = (videoCodec == "ffv1") ? VmbC::Examples::VideoEncoderSink::Codec::Ffv1
+            : (videoCodec == "h265" || videoCodec == "hevc") ? VmbC::Examples::VideoEncoderSink::Codec::H265
+            : VmbC::Examples::VideoEncoderSink::Codec::H264;
+        if (parser.isSet(videoFpsOption))
+        {
+            settings.m_frameRate = parser.value(videoFpsOption).toDouble();
+        }
+        QStringList const size = parser.value(videoSizeOption).split('x');
+        if (size.size() == 2)
+        {
+            settings.m_maxWidth = size[0].toInt();
+            settings.m_maxHeight = size[1].toInt();
+        }
+        settings.m_threads = parser.value(videoThreadsOption).toUInt();
+        mainWindow.EnableVideoArchive(settings);
+    }
+    if (parser.isSet(adaptivePreviewOption))
+    {
+        VmbC::Examples::ImageTranscoder::AdaptiveQualitySettings settings;
+        settings.m_enabled = true;
+        settings.m_targetLatency = std::chrono::milliseconds((std::max)(parser.value(adaptivePreviewOption).toUInt(), 1u));
+        mainWindow.EnableAdaptivePreview(settings);
+    }
+    if (parser.isSet(timeLapseOption))
+    {
+        mainWindow.SetTimeLapseInterval(std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+            std::chrono::duration<double>(parser.value(timeLapseOption).toDouble())));
+    }
+    if (parser.isSet(sharedMemoryOption))
+    {
+        VmbC::Examples::SharedFrameExport::Settings settings;
+        settings.m_name = parser.value(sharedMemoryOption).toStdString();
+        mainWindow.EnableSharedFrameExport(settings);
+    }
+    if (parser.isSet(chunkMetadataOption))
+    {
+        mainWindow.EnableChunkMetadata(VmbC::Examples::MetadataAll);
+    }
+    if (parser.isSet(attachOption))
+    {
+        mainWindow.AttachToDaemon(static_cast<VmbUint16_t>(parser.value(attachOption).toUShort()));
+    }
+    if (parser.isSet(previewPortOption))
+    {
+        VmbC::Examples::MjpegPreviewServer::Settings settings;
+        settings.m_port = static_cast<VmbUint16_t>(parser.value(previewPortOption).toUShort());
+        if (parser.isSet(previewBandwidthOption))
+        {
+            settings.m_bandwidth = parser.value(previewBandwidthOption).toDouble() * 1024;
+        }
+        mainWindow.StartPreviewServer(settings);
+    }
+    if (parser.isSet(streamPortOption))
+    {
+        VmbC::Examples::FrameStreamServer::Settings settings;
+        settings.m_port = static_cast<VmbUint16_t>(parser.value(streamPortOption).toUShort());
+        settings.m_loopbackOnly = !parser.isSet(streamAnyHostOption);
+        mainWindow.StartFrameStreamServer(settings);
+    }
+    if (parser.isSet(workPortOption))
+    {
+        VmbC::Examples::WorkQueueServer::Settings settings;
+        settings.m_port = static_cast<VmbUint16_t>(parser.value(workPortOption).toUShort());
+        settings.m_loopbackOnly = !parser.isSet(workAnyHostOption);
+        mainWindow.StartWorkQueueServer(settings);
+    }
     mainWindow.show();
     return application.exec();
 }
\ No newline at end of file